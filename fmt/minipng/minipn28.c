@@ -0,0 +1,47 @@
+
+#include <stdio.h>
+#if defined(TARGET_MSDOS)
+#include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
+#include <ctype.h>
+#endif
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#if defined(TARGET_MSDOS)
+#include <dos.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <hw/cpu/cpu.h>
+#include <hw/dos/dos.h>
+#include <hw/vga/vga.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <ext/zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include <fmt/minipng/minipng.h>
+
+/* WARNING: This function will expand bytes to a multiple of 4 pixels rounded up. Allocate your buffer accordingly. */
+void minipng_expand2to8(unsigned char *buf,unsigned int pixels) {
+    if (pixels > 0) {
+        unsigned int bytes = (pixels + 3u) / 4u;
+        unsigned char *w = buf + (bytes * 4u);
+        buf += bytes;
+
+        do {
+            unsigned char pb = *--buf;
+            w -= 4;
+            w[0] = (pb >> 6u) & 0x3u;
+            w[1] = (pb >> 4u) & 0x3u;
+            w[2] = (pb >> 2u) & 0x3u;
+            w[3] = (pb >> 0u) & 0x3u;
+        } while (--bytes != 0u);
+    }
+}
+
@@ -70,12 +70,53 @@ struct minipng_reader {
     unsigned int                ungetch;
 };
 
+/* PNG filter types [https://www.w3.org/TR/PNG/#9Filter-types] */
+#define MINIPNG_FILTER_NONE                 0u
+#define MINIPNG_FILTER_SUB                  1u
+#define MINIPNG_FILTER_UP                   2u
+#define MINIPNG_FILTER_AVERAGE              3u
+#define MINIPNG_FILTER_PAETH                4u
+
+/* minipng_row_reader flags */
+#define MINIPNG_ROW_EXPAND8                 (1u << 0u)  /* 1/2/4-bit pixels come out one byte per pixel */
+
+/* Row at a time decoding with filters undone and Adam7 passes walked in order.
+ * Only the current and previous row are kept. Fields above "internal" describe the
+ * row returned by minipng_row_reader_next() and stay valid until the next call. */
+struct minipng_row_reader {
+    struct minipng_reader*      rdr;
+    unsigned int                flags;
+    unsigned int                bits_per_pixel;
+    unsigned int                bpp;            /* bytes per complete pixel, at least 1 (filter distance) */
+
+    unsigned char*              row;            /* the pixels, packed MSB first if < 8 bits unless MINIPNG_ROW_EXPAND8 */
+    size_t                      rowbytes;       /* of row */
+    uint32_t                    width;          /* pixels in row */
+    uint32_t                    y;              /* image row this is */
+    uint32_t                    x0,dx;          /* pixel n of row goes to image column x0 + (n * dx) */
+    unsigned char               pass;           /* Adam7 pass 1-7, or 0 if not interlaced */
+
+    /* internal */
+    uint32_t                    pass_row;
+    uint32_t                    pass_height;
+    uint32_t                    y0,dy;
+    size_t                      pass_rowbytes;  /* packed, without the filter byte */
+    unsigned char*              cur;            /* filter byte + row */
+    unsigned char*              prev;
+    unsigned char*              expand;
+};
+
 extern const uint8_t minipng_sig[8];
 
 /* WARNING: This function will expand bytes to a multiple of 8 pixels rounded up. Allocate your buffer accordingly. */
 void minipng_expand1to8(unsigned char *buf,unsigned int pixels);
 /* WARNING: This function will expand bytes to a multiple of 2 pixels rounded up. Allocate your buffer accordingly. */
 void minipng_expand4to8(unsigned char *buf,unsigned int pixels);
+/* WARNING: This function will expand bytes to a multiple of 4 pixels rounded up. Allocate your buffer accordingly. */
+void minipng_expand2to8(unsigned char *buf,unsigned int pixels);
+
+int minipng_unfilter_row(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp,unsigned char filter);
+int minipng_unfilter_row_scalar(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp,unsigned char filter);
 
 struct minipng_reader *minipng_reader_open(const char *path);
 int minipng_reader_rewind(struct minipng_reader *rdr);
@@ -86,3 +127,8 @@ int minipng_reader_read_idat(struct minipng_reader *rdr,unsigned char FAR *dst,s
 size_t minipng_rowsize_bytes(struct minipng_reader *rdr);
 void minipng_reader_reset_idat(struct minipng_reader *rdr);
 
+/* call after minipng_reader_parse_head() */
+struct minipng_row_reader *minipng_row_reader_open(struct minipng_reader *rdr,unsigned int flags);
+int minipng_row_reader_next(struct minipng_row_reader *rr);
+void minipng_row_reader_close(struct minipng_row_reader **rr);
+
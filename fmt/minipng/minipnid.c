@@ -36,7 +36,11 @@ int minipng_reader_read_idat(struct minipng_reader *rdr,unsigned char FAR *dst,s
     if (rdr->fd < 0) return -1;
 
     if (rdr->compr == NULL) {
+#if defined(TARGET_MSDOS)
         rdr->compr_size = 1024;
+#else
+        rdr->compr_size = 65536; /* fewer read() calls, memory is not tight on the host */
+#endif
         rdr->compr = malloc(rdr->compr_size);
         if (rdr->compr == NULL) return -1;
 
@@ -0,0 +1,184 @@
+
+#include <stdio.h>
+#if defined(TARGET_MSDOS)
+#include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
+#include <ctype.h>
+#endif
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#if defined(TARGET_MSDOS)
+#include <dos.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <hw/cpu/cpu.h>
+#include <hw/dos/dos.h>
+#include <hw/vga/vga.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <ext/zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include <fmt/minipng/minipng.h>
+
+/* Adam7 [https://www.w3.org/TR/PNG/#8Interlace], passes 1-7. Entry 0 is the whole image. */
+static const unsigned char minipng_adam7_x0[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
+static const unsigned char minipng_adam7_y0[8] = { 0, 0, 0, 4, 0, 2, 0, 1 };
+static const unsigned char minipng_adam7_dx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
+static const unsigned char minipng_adam7_dy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
+
+static unsigned int minipng_channels(unsigned char color_type) {
+    switch (color_type) {
+        case 0: return 1; /* gray */
+        case 2: return 3; /* RGB */
+        case 3: return 1; /* indexed */
+        case 4: return 2; /* gray + alpha */
+        case 6: return 4; /* RGBA */
+        default: break;
+    }
+
+    return 0;
+}
+
+static size_t minipng_packed_bytes(struct minipng_row_reader *rr,uint32_t pixels) {
+    return (size_t)((((unsigned long)pixels * (unsigned long)rr->bits_per_pixel) + 7ul) / 8ul);
+}
+
+struct minipng_row_reader *minipng_row_reader_open(struct minipng_reader *rdr,unsigned int flags) {
+    struct minipng_row_reader *rr;
+    unsigned int channels;
+    size_t rowbytes;
+
+    if (rdr == NULL) return NULL;
+    if (rdr->fd < 0) return NULL;
+    if (rdr->ihdr.width == 0 || rdr->ihdr.height == 0) return NULL;
+    if (rdr->ihdr.filter_method != 0 || rdr->ihdr.interlace_method > 1) return NULL;
+
+    channels = minipng_channels(rdr->ihdr.color_type);
+    if (channels == 0) return NULL;
+
+    switch (rdr->ihdr.bit_depth) {
+        case 1: case 2: case 4:
+            if (channels != 1) return NULL;
+            break;
+        case 8: case 16:
+            break;
+        default:
+            return NULL;
+    }
+
+    rr = calloc(1,sizeof(*rr));
+    if (rr == NULL) return NULL;
+
+    rr->rdr = rdr;
+    rr->flags = flags;
+    rr->bits_per_pixel = channels * rdr->ihdr.bit_depth;
+    rr->bpp = (rr->bits_per_pixel + 7u) / 8u;
+
+    /* the first Adam7 pass with any pixels starts the image, every other pass is narrower */
+    rowbytes = minipng_packed_bytes(rr,rdr->ihdr.width);
+    rr->cur = malloc(1u + rowbytes);
+    rr->prev = malloc(1u + rowbytes);
+    if (rr->cur == NULL || rr->prev == NULL) goto fail;
+
+    if ((flags & MINIPNG_ROW_EXPAND8) && rr->bits_per_pixel < 8u) {
+        rr->expand = malloc((size_t)rdr->ihdr.width + 8u/*expandpad*/);
+        if (rr->expand == NULL) goto fail;
+    }
+
+    /* pass 0 and pass_height 0: the first call starts the first pass (or the whole image) */
+    return rr;
+
+fail:
+    minipng_row_reader_close(&rr);
+    return NULL;
+}
+
+/* Reads, unfilters and (if asked) expands the next row. Returns 1 if there is a row, 0 at the end
+ * of the image, or -1 on error. Rows come in file order, which for Adam7 is pass by pass. */
+int minipng_row_reader_next(struct minipng_row_reader *rr) {
+    const struct minipng_IHDR *ihdr;
+    unsigned char *t;
+    size_t n;
+
+    if (rr == NULL) return -1;
+    ihdr = &rr->rdr->ihdr;
+
+    while (rr->pass_row >= rr->pass_height) {
+        unsigned int p;
+
+        if (!ihdr->interlace_method) { /* not interlaced, the whole image is one pass, pass stays 0 */
+            if (rr->pass_height != 0) return 0;
+            p = 0;
+        }
+        else {
+            if (rr->pass >= 7u) return 0;
+            p = ++rr->pass;
+        }
+
+        rr->x0 = minipng_adam7_x0[p];
+        rr->y0 = minipng_adam7_y0[p];
+        rr->dx = minipng_adam7_dx[p];
+        rr->dy = minipng_adam7_dy[p];
+        rr->width = (ihdr->width > rr->x0) ? ((ihdr->width - rr->x0 + rr->dx - 1u) / rr->dx) : 0u;
+        rr->pass_height = (ihdr->height > rr->y0) ? ((ihdr->height - rr->y0 + rr->dy - 1u) / rr->dy) : 0u;
+        rr->pass_row = 0;
+
+        /* a pass without pixels has no rows at all, not even filter bytes */
+        if (rr->width == 0u) rr->pass_height = 0;
+        if (rr->pass_height == 0u && p == 0u) return 0;
+
+        rr->pass_rowbytes = minipng_packed_bytes(rr,rr->width);
+        memset(rr->prev,0,1u + rr->pass_rowbytes);
+    }
+
+    n = 1u + rr->pass_rowbytes;
+    if ((size_t)minipng_reader_read_idat(rr->rdr,rr->cur,n) != n)
+        return -1;
+    if (minipng_unfilter_row(rr->cur + 1,rr->prev + 1,rr->pass_rowbytes,rr->bpp,rr->cur[0]))
+        return -1;
+
+    rr->y = rr->y0 + (rr->pass_row * rr->dy);
+    rr->pass_row++;
+
+    rr->row = rr->cur + 1;
+    rr->rowbytes = rr->pass_rowbytes;
+
+    /* this row is the one above the next */
+    t = rr->prev;
+    rr->prev = rr->cur;
+    rr->cur = t;
+
+    if (rr->expand != NULL) {
+        memcpy(rr->expand,rr->row,rr->rowbytes);
+        switch (rr->bits_per_pixel) {
+            case 1: minipng_expand1to8(rr->expand,rr->width); break;
+            case 2: minipng_expand2to8(rr->expand,rr->width); break;
+            case 4: minipng_expand4to8(rr->expand,rr->width); break;
+            default: break;
+        }
+
+        rr->row = rr->expand;
+        rr->rowbytes = rr->width;
+    }
+
+    return 1;
+}
+
+void minipng_row_reader_close(struct minipng_row_reader **rr) {
+    if (*rr != NULL) {
+        if ((*rr)->expand != NULL) free((*rr)->expand);
+        if ((*rr)->prev != NULL) free((*rr)->prev);
+        if ((*rr)->cur != NULL) free((*rr)->cur);
+        free(*rr);
+        *rr = NULL;
+    }
+}
+
@@ -0,0 +1,250 @@
+#include <stdio.h>
+#if defined(TARGET_MSDOS)
+#include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
+#include <ctype.h>
+#endif
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#if defined(TARGET_MSDOS)
+#include <dos.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <hw/cpu/cpu.h>
+#include <hw/dos/dos.h>
+#include <hw/vga/vga.h>
+#endif
+
+#if defined(TARGET_MSDOS)
+#include <ext/zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <fmt/minipng/minipng.h>
+
+/* PNG filter reconstruction [https://www.w3.org/TR/PNG/#9Filter-types].
+ * row is the filtered row without the filter type byte, prev the reconstructed row above it
+ * (all zeros for the first row of an image or Adam7 pass). bpp is bytes per complete pixel,
+ * rounded up to 1. Returns 0, or -1 for an unknown filter type. */
+int minipng_unfilter_row_scalar(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp,unsigned char filter) {
+    size_t i;
+
+    switch (filter) {
+        case MINIPNG_FILTER_NONE:
+            break;
+        case MINIPNG_FILTER_SUB:
+            for (i=bpp;i < rowbytes;i++)
+                row[i] += row[i-bpp];
+            break;
+        case MINIPNG_FILTER_UP:
+            for (i=0;i < rowbytes;i++)
+                row[i] += prev[i];
+            break;
+        case MINIPNG_FILTER_AVERAGE:
+            for (i=0;i < bpp && i < rowbytes;i++)
+                row[i] += prev[i] >> 1u;
+            for (;i < rowbytes;i++)
+                row[i] += (unsigned char)(((unsigned int)row[i-bpp] + (unsigned int)prev[i]) >> 1u);
+            break;
+        case MINIPNG_FILTER_PAETH:
+            for (i=0;i < bpp && i < rowbytes;i++)
+                row[i] += prev[i]; /* a = c = 0, so the predictor is b */
+            for (;i < rowbytes;i++) {
+                int a = row[i-bpp],b = prev[i],c = prev[i-bpp];
+                int pa = b - c,pb = a - c,pc = pa + pb;
+
+                /* written so the compiler can use conditional moves, the branches are unpredictable */
+                pa = (pa < 0) ? -pa : pa;
+                pb = (pb < 0) ? -pb : pb;
+                pc = (pc < 0) ? -pc : pc;
+                b = (pb <= pc) ? b : c;
+                row[i] += (unsigned char)((pa <= pb && pa <= pc) ? a : b);
+            }
+            break;
+        default:
+            return -1;
+    }
+
+    return 0;
+}
+
+#if defined(__SSE2__)
+static void minipng_unfilter_up_sse2(unsigned char *row,const unsigned char *prev,size_t rowbytes) {
+    size_t i = 0;
+
+    for (;(i+16) <= rowbytes;i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(row+i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(prev+i));
+        _mm_storeu_si128((__m128i*)(row+i),_mm_add_epi8(x,b));
+    }
+    for (;i < rowbytes;i++)
+        row[i] += prev[i];
+}
+
+/* Sub is a running sum with a stride of bpp. Within 16 bytes that takes log2(16/bpp) shift+add
+ * steps, then the last pixel of the previous 16 bytes is carried in. bpp 1, 2, 4 and 8 only,
+ * so that 16 bytes always hold whole pixels. */
+static void minipng_unfilter_sub_sse2(unsigned char *row,size_t rowbytes,unsigned int bpp) {
+    __m128i carry = _mm_setzero_si128(),x;
+    size_t i = 0;
+
+    for (;(i+16) <= rowbytes;i += 16) {
+        x = _mm_loadu_si128((const __m128i*)(row+i));
+        if (bpp == 1) x = _mm_add_epi8(x,_mm_slli_si128(x,1));
+        if (bpp <= 2) x = _mm_add_epi8(x,_mm_slli_si128(x,2));
+        if (bpp <= 4) x = _mm_add_epi8(x,_mm_slli_si128(x,4));
+        x = _mm_add_epi8(x,_mm_slli_si128(x,8));
+        x = _mm_add_epi8(x,carry);
+        _mm_storeu_si128((__m128i*)(row+i),x);
+
+        if (bpp == 1) {
+            carry = _mm_set1_epi8((char)row[i+15]);
+        }
+        else if (bpp == 2) {
+            carry = _mm_shufflehi_epi16(x,_MM_SHUFFLE(3,3,3,3));
+            carry = _mm_unpackhi_epi64(carry,carry);
+        }
+        else if (bpp == 4) {
+            carry = _mm_shuffle_epi32(x,_MM_SHUFFLE(3,3,3,3));
+        }
+        else {
+            carry = _mm_unpackhi_epi64(x,x);
+        }
+    }
+
+    if (i == 0) i = bpp;
+    for (;i < rowbytes;i++)
+        row[i] += row[i-bpp];
+}
+
+/* Average and Paeth depend on the pixel to the left, so they go one pixel at a time,
+ * but all bytes of the pixel at once (RGB, RGBA, 16-bit gray+alpha, 16-bit RGBA). bpp 3 to 8. */
+static inline __m128i minipng_load_px(const unsigned char *p,unsigned int bpp) {
+    uint32_t t32;
+    uint64_t t;
+
+    if (bpp == 4) {
+        memcpy(&t32,p,4);
+        return _mm_cvtsi32_si128((int)t32);
+    }
+    if (bpp == 3) {
+        t32 = (uint32_t)p[0] | ((uint32_t)p[1] << 8u) | ((uint32_t)p[2] << 16u);
+        return _mm_cvtsi32_si128((int)t32);
+    }
+
+    t = 0;
+    memcpy(&t,p,bpp);
+    return _mm_loadl_epi64((const __m128i*)(&t));
+}
+
+static inline void minipng_store_px(unsigned char *p,__m128i x,unsigned int bpp) {
+    uint32_t t32;
+    uint64_t t;
+
+    if (bpp <= 4) {
+        t32 = (uint32_t)_mm_cvtsi128_si32(x);
+        if (bpp == 4) {
+            memcpy(p,&t32,4);
+        }
+        else {
+            p[0] = (unsigned char)t32;
+            p[1] = (unsigned char)(t32 >> 8u);
+            p[2] = (unsigned char)(t32 >> 16u);
+        }
+        return;
+    }
+
+    _mm_storel_epi64((__m128i*)(&t),x);
+    memcpy(p,&t,bpp);
+}
+
+static void minipng_unfilter_avg_sse2(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp) {
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128(),b,x,avg;
+    size_t i;
+
+    for (i=0;(i+bpp) <= rowbytes;i += bpp) {
+        x = minipng_load_px(row+i,bpp);
+        b = minipng_load_px(prev+i,bpp);
+        /* pavgb rounds up, the filter rounds down */
+        avg = _mm_sub_epi8(_mm_avg_epu8(a,b),_mm_and_si128(_mm_xor_si128(a,b),one));
+        a = _mm_add_epi8(x,avg);
+        minipng_store_px(row+i,a,bpp);
+    }
+}
+
+static void minipng_unfilter_paeth_sse2(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero,b,c = zero,x,pa,pb,pc,smallest,r;
+    size_t i;
+
+    for (i=0;(i+bpp) <= rowbytes;i += bpp) {
+        x = minipng_load_px(row+i,bpp);
+        b = _mm_unpacklo_epi8(minipng_load_px(prev+i,bpp),zero);
+
+        /* in 16 bits: pa = |b-c|, pb = |a-c|, pc = |a+b-2c| */
+        pa = _mm_sub_epi16(b,c);
+        pb = _mm_sub_epi16(a,c);
+        pc = _mm_add_epi16(pa,pb);
+        pa = _mm_max_epi16(pa,_mm_sub_epi16(zero,pa));
+        pb = _mm_max_epi16(pb,_mm_sub_epi16(zero,pb));
+        pc = _mm_max_epi16(pc,_mm_sub_epi16(zero,pc));
+        smallest = _mm_min_epi16(pc,_mm_min_epi16(pa,pb));
+
+        /* ties go to a, then b, then c */
+        r = _mm_cmpeq_epi16(pb,smallest);
+        r = _mm_or_si128(_mm_and_si128(r,b),_mm_andnot_si128(r,c));
+        pa = _mm_cmpeq_epi16(pa,smallest);
+        r = _mm_or_si128(_mm_and_si128(pa,a),_mm_andnot_si128(pa,r));
+
+        x = _mm_add_epi8(x,_mm_packus_epi16(r,r));
+        minipng_store_px(row+i,x,bpp);
+
+        a = _mm_unpacklo_epi8(x,zero);
+        c = b;
+    }
+}
+#endif
+
+/* same as minipng_unfilter_row_scalar(), with SSE2 where it helps */
+int minipng_unfilter_row(unsigned char *row,const unsigned char *prev,size_t rowbytes,unsigned int bpp,unsigned char filter) {
+#if defined(__SSE2__)
+    switch (filter) {
+        case MINIPNG_FILTER_SUB:
+            if (bpp == 1 || bpp == 2 || bpp == 4 || bpp == 8) {
+                minipng_unfilter_sub_sse2(row,rowbytes,bpp);
+                return 0;
+            }
+            break;
+        case MINIPNG_FILTER_UP:
+            minipng_unfilter_up_sse2(row,prev,rowbytes);
+            return 0;
+        case MINIPNG_FILTER_AVERAGE:
+            if (bpp >= 3 && bpp <= 8) {
+                minipng_unfilter_avg_sse2(row,prev,rowbytes,bpp);
+                return 0;
+            }
+            break;
+        case MINIPNG_FILTER_PAETH:
+            if (bpp >= 3 && bpp <= 8) {
+                minipng_unfilter_paeth_sse2(row,prev,rowbytes,bpp);
+                return 0;
+            }
+            break;
+        default:
+            break;
+    }
+#endif
+
+    return minipng_unfilter_row_scalar(row,prev,rowbytes,bpp,filter);
+}
+
@@ -25,6 +25,10 @@
 #include <zlib.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <fmt/minipng/minipng.h>
 
 /* WARNING: This function will expand bytes to a multiple of 8 pixels rounded up. Allocate your buffer accordingly. */
@@ -34,6 +38,43 @@ void minipng_expand1to8(unsigned char *buf,unsigned int pixels) {
         unsigned char *w = buf + (bytes * 8u);
         buf += bytes;
 
+#if defined(__SSE2__)
+        /* 16 bytes in, 128 bytes out. Going backwards the output never lands on input not yet read */
+        {
+            const __m128i bits = _mm_set_epi8(1,2,4,8,16,32,64,(char)128,1,2,4,8,16,32,64,(char)128);
+            const __m128i one = _mm_set1_epi8(1);
+
+            while (bytes >= 16u) {
+                __m128i x,x8,q[4];
+                unsigned int i;
+
+                buf -= 16;
+                w -= 128;
+                bytes -= 16u;
+
+                /* q[n] = input bytes 4n to 4n+3, each repeated 4 times */
+                x = _mm_loadu_si128((const __m128i*)buf);
+                x8 = _mm_unpacklo_epi8(x,x);
+                q[0] = _mm_unpacklo_epi16(x8,x8);
+                q[1] = _mm_unpackhi_epi16(x8,x8);
+                x8 = _mm_unpackhi_epi8(x,x);
+                q[2] = _mm_unpacklo_epi16(x8,x8);
+                q[3] = _mm_unpackhi_epi16(x8,x8);
+
+                for (i=0;i < 4u;i++) {
+                    __m128i lo = _mm_unpacklo_epi32(q[i],q[i]),hi = _mm_unpackhi_epi32(q[i],q[i]);
+
+                    lo = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo,bits),bits),one);
+                    hi = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi,bits),bits),one);
+                    _mm_storeu_si128((__m128i*)(w+(i*32u)),lo);
+                    _mm_storeu_si128((__m128i*)(w+(i*32u)+16u),hi);
+                }
+            }
+
+            if (bytes == 0u) return;
+        }
+#endif
+
         do {
             unsigned char pb = *--buf;
             w -= 8;
@@ -0,0 +1,320 @@
+
+/* minipng row reader test.
+ *
+ * rowtest -selftest            checks the SSE2 unfilter and expand paths against plain C
+ * rowtest <file.png>           decodes through minipng_row_reader, prints the image CRC-32
+ * rowtest -test <gold.txt>     decodes every file listed in gold.txt, compares the CRC-32
+ * rowtest -mkgold <file.png>.. prints the gold.txt lines for the files
+ * rowtest <file.png> -o <raw>  and writes the deinterlaced image, one byte per pixel below 8 bits
+ * rowtest <file.png> -bench n  decodes n times and reports the speed
+ * rowtest -bench               unfilter and expand speed, C against SSE2 */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <zlib.h>
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+#include <fmt/minipng/minipng.h>
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static void expand_ref(unsigned char *dst,const unsigned char *src,unsigned int pixels,unsigned int bits) {
+    unsigned int i;
+
+    for (i=0;i < pixels;i++) {
+        unsigned int bit = i * bits;
+        dst[i] = (src[bit >> 3u] >> (8u - bits - (bit & 7u))) & ((1u << bits) - 1u);
+    }
+}
+
+static int selftest(void) {
+    static unsigned char row[1024],ref[1024],prev[1024],a[1100],b[1100];
+    unsigned int filter,bpp,len,bits,i,iter;
+
+    srand(1);
+    for (iter=0;iter < 20;iter++) {
+        for (filter=0;filter <= 4;filter++) {
+            for (bpp=1;bpp <= 8;bpp++) {
+                for (len=0;len <= 300;len++) {
+                    if ((len % bpp) != 0) continue;
+                    for (i=0;i < len;i++) {
+                        row[i] = ref[i] = (unsigned char)rand();
+                        prev[i] = (unsigned char)rand();
+                    }
+                    if (minipng_unfilter_row(row,prev,len,bpp,filter) ||
+                        minipng_unfilter_row_scalar(ref,prev,len,bpp,filter)) {
+                        fprintf(stderr,"unfilter failed\n");
+                        return 1;
+                    }
+                    if (memcmp(row,ref,len)) {
+                        fprintf(stderr,"unfilter mismatch: filter=%u bpp=%u len=%u\n",filter,bpp,len);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    for (bits=1;bits <= 4;bits *= 2) {
+        for (len=0;len <= 600;len++) {
+            unsigned int bytes = ((len * bits) + 7u) / 8u;
+
+            for (i=0;i < bytes;i++) a[i] = (unsigned char)rand();
+            expand_ref(b,a,len,bits);
+            if (bits == 1) minipng_expand1to8(a,len);
+            else if (bits == 2) minipng_expand2to8(a,len);
+            else minipng_expand4to8(a,len);
+            if (memcmp(a,b,len)) {
+                fprintf(stderr,"expand mismatch: bits=%u pixels=%u\n",bits,len);
+                return 1;
+            }
+        }
+    }
+
+    printf("Self test OK\n");
+    return 0;
+}
+
+/* unfilter and expand speed on 4KB rows, plain C against the SSE2 paths */
+static int kernel_bench(void) {
+    static const char *names[5] = { "none", "sub", "up", "average", "paeth" };
+    static const unsigned int bpps[3] = { 1, 3, 4 };
+    static unsigned char row[4096],prev[4096],buf[4096*8];
+    const unsigned int reps = 20000;
+    unsigned int filter,b,i,pass;
+    double t[2];
+
+    for (i=0;i < sizeof(row);i++) {
+        row[i] = (unsigned char)rand();
+        prev[i] = (unsigned char)rand();
+    }
+
+    printf("%-8s %4s %10s %10s   (MB/s)\n","filter","bpp","C","SSE2");
+    for (filter=1;filter <= 4;filter++) {
+        for (b=0;b < 3;b++) {
+            for (pass=0;pass < 2;pass++) {
+                t[pass] = now();
+                for (i=0;i < reps;i++) {
+                    if (pass == 0) minipng_unfilter_row_scalar(row,prev,sizeof(row),bpps[b],filter);
+                    else minipng_unfilter_row(row,prev,sizeof(row),bpps[b],filter);
+                }
+                t[pass] = now() - t[pass];
+            }
+
+            printf("%-8s %4u %10.1f %10.1f\n",names[filter],bpps[b],
+                (sizeof(row) * (double)reps) / t[0] / 1e6,(sizeof(row) * (double)reps) / t[1] / 1e6);
+        }
+    }
+
+    for (b=1;b <= 4;b *= 2) {
+        const unsigned int pixels = sizeof(buf) / 8u;
+
+        t[0] = now();
+        for (i=0;i < reps;i++) {
+            if (b == 1) minipng_expand1to8(buf,pixels);
+            else if (b == 2) minipng_expand2to8(buf,pixels);
+            else minipng_expand4to8(buf,pixels);
+        }
+        t[0] = now() - t[0];
+
+        printf("expand %u-bit to 8: %.1f Mpixels/s\n",b,((double)pixels * reps) / t[0] / 1e6);
+    }
+
+    return 0;
+}
+
+/* decode the whole image, returns it deinterlaced */
+static unsigned char *decode(const char *path,size_t *size,uint32_t *w,uint32_t *h,unsigned int *bpp_out) {
+    struct minipng_row_reader *rr = NULL;
+    struct minipng_reader *rdr;
+    unsigned char *img = NULL;
+    unsigned int pbytes,pass = 0;
+    size_t stride;
+    int r;
+
+    if ((rdr=minipng_reader_open(path)) == NULL) {
+        fprintf(stderr,"PNG open failed\n");
+        return NULL;
+    }
+    if (minipng_reader_parse_head(rdr)) {
+        fprintf(stderr,"PNG head parse failed\n");
+        goto done;
+    }
+    if ((rr=minipng_row_reader_open(rdr,MINIPNG_ROW_EXPAND8)) == NULL) {
+        fprintf(stderr,"PNG format not supported\n");
+        goto done;
+    }
+
+    pbytes = rr->bpp;
+    stride = (size_t)rdr->ihdr.width * pbytes;
+    *w = rdr->ihdr.width;
+    *h = rdr->ihdr.height;
+    *bpp_out = pbytes;
+    *size = stride * rdr->ihdr.height;
+
+    img = calloc(1,*size);
+    if (img == NULL) goto done;
+
+    while ((r=minipng_row_reader_next(rr)) > 0) {
+        unsigned char *d = img + (rr->y * stride) + (rr->x0 * pbytes);
+        uint32_t x;
+
+        /* 0 if not interlaced, else Adam7 passes 1-7 in order */
+        if (rdr->ihdr.interlace_method ? (rr->pass < 1u || rr->pass > 7u || rr->pass < pass) : (rr->pass != 0u)) {
+            fprintf(stderr,"Row %lu has wrong pass number %u\n",(unsigned long)rr->y,rr->pass);
+            r = -1;
+            break;
+        }
+        pass = rr->pass;
+
+        if (rr->dx == 1) {
+            memcpy(d,rr->row,(size_t)rr->width * pbytes);
+        }
+        else {
+            for (x=0;x < rr->width;x++)
+                memcpy(d + ((size_t)x * rr->dx * pbytes),rr->row + ((size_t)x * pbytes),pbytes);
+        }
+    }
+
+    if (r < 0) {
+        fprintf(stderr,"PNG decode error\n");
+        free(img);
+        img = NULL;
+    }
+
+done:
+    minipng_row_reader_close(&rr);
+    minipng_reader_close(&rdr);
+    return img;
+}
+
+static int image_crc(const char *path,uint32_t *crc) {
+    unsigned int bpp;
+    unsigned char *img;
+    uint32_t w,h;
+    size_t size;
+
+    if ((img=decode(path,&size,&w,&h,&bpp)) == NULL)
+        return 0;
+
+    *crc = (uint32_t)crc32(0,img,(uInt)size);
+    free(img);
+    return 1;
+}
+
+/* one "<file.png> <crc32>" per line, # starts a comment */
+static int run_golden(const char *gold_file) {
+    unsigned int checked = 0,failed = 0;
+    char line[256],name[200];
+    unsigned long want;
+    uint32_t crc = 0;
+    FILE *fp;
+
+    fp = fopen(gold_file,"r");
+    if (fp == NULL) {
+        fprintf(stderr,"Cannot open %s\n",gold_file);
+        return 1;
+    }
+
+    while (fgets(line,sizeof(line),fp) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line,"%199s %lx",name,&want) != 2) continue;
+
+        checked++;
+        if (!image_crc(name,&crc) || crc != (uint32_t)want) {
+            fprintf(stderr,"FAIL: %s crc32=%08lx, expected %08lx\n",name,(unsigned long)crc,want);
+            failed++;
+        }
+    }
+
+    fclose(fp);
+    printf("%u images checked, %u failed\n",checked,failed);
+    return (failed != 0 || checked == 0) ? 1 : 0;
+}
+
+int main(int argc,char **argv) {
+    const char *path = NULL,*out = NULL;
+    unsigned int bench = 0,bpp,i;
+    unsigned char *img;
+    uint32_t w,h;
+    size_t size;
+
+    for (i=1;i < (unsigned int)argc;i++) {
+        if (!strcmp(argv[i],"-selftest"))
+            return selftest();
+        else if (!strcmp(argv[i],"-test") && (i+1) < (unsigned int)argc)
+            return run_golden(argv[i+1]);
+        else if (!strcmp(argv[i],"-mkgold")) {
+            uint32_t crc;
+
+            for (i++;i < (unsigned int)argc;i++) {
+                if (!image_crc(argv[i],&crc)) return 1;
+                printf("%s %08lx\n",argv[i],(unsigned long)crc);
+            }
+            return 0;
+        }
+        else if (!strcmp(argv[i],"-o") && (i+1) < (unsigned int)argc)
+            out = argv[++i];
+        else if (!strcmp(argv[i],"-bench"))
+            bench = ((i+1) < (unsigned int)argc && argv[i+1][0] != '-') ? (unsigned int)atoi(argv[++i]) : 1u;
+        else if (argv[i][0] != '-')
+            path = argv[i];
+        else {
+            fprintf(stderr,"Unknown switch %s\n",argv[i]);
+            return 1;
+        }
+    }
+
+    if (path == NULL && bench > 0)
+        return kernel_bench();
+    if (path == NULL) {
+        fprintf(stderr,"rowtest -selftest | -bench | -test <gold.txt> | -mkgold <file.png>... | <file.png> [-o raw] [-bench n]\n");
+        return 1;
+    }
+
+    if ((img=decode(path,&size,&w,&h,&bpp)) == NULL)
+        return 1;
+
+    printf("%s: %lu x %lu, %u byte(s)/pixel, crc32=%08lx\n",path,(unsigned long)w,(unsigned long)h,bpp,
+        (unsigned long)crc32(0,img,(uInt)size));
+
+    if (out != NULL) {
+        int fd = open(out,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644);
+        if (fd < 0 || write(fd,img,size) != (ssize_t)size) {
+            fprintf(stderr,"Cannot write %s\n",out);
+            return 1;
+        }
+        close(fd);
+    }
+
+    free(img);
+
+    if (bench > 0) {
+        double t = now();
+
+        for (i=0;i < bench;i++) {
+            img = decode(path,&size,&w,&h,&bpp);
+            if (img == NULL) return 1;
+            free(img);
+        }
+
+        t = now() - t;
+        printf("%u decodes in %.3fs, %.1f MB/s of pixels\n",bench,t,((double)size * bench) / t / 1e6);
+    }
+
+    return 0;
+}
@@ -112,7 +112,18 @@ enum {
 #define OMF_RECTYPE_LPUBDEF     (0xB6)
 #define OMF_RECTYPE_LPUBDEF32   (0xB7)
 
-extern char                             omf_temp_str[255+1/*NUL*/];
+#define OMF_RECTYPE_LIBHEAD     (0xF0)
+#define OMF_RECTYPE_LIBEND      (0xF1)
+
+// scratch space for the record parsers. per-thread where supported, so that
+// separate contexts can be parsed in parallel (Linux host linkplus).
+#if defined(LINUX)
+# define OMF_THREAD_LOCAL __thread
+#else
+# define OMF_THREAD_LOCAL
+#endif
+
+extern OMF_THREAD_LOCAL char            omf_temp_str[255+1/*NUL*/];
 
 struct omf_record_t {
     unsigned char           rectype;
@@ -122,6 +133,7 @@ struct omf_record_t {
     size_t                  data_alloc;         // amount of data allocated if data != NULL or amount TO alloc if data == NULL
 
     unsigned long           rec_file_offset;    // file offset of record (~0UL if undefined)
+    unsigned char           data_mapped;        // data points into a memory mapped file (omf_context_map_fd), do not free or write
 };
 
 // this is filled in by a utility function after reading the OMF record from the beginning.
@@ -280,6 +292,9 @@ struct omf_context_t {
     unsigned long                       last_LEDATA_eno;
     unsigned char                       last_LEDATA_hdr;
     char*                               THEADR;
+    const unsigned char*                map_base;       // memory mapped OMF file, if omf_context_map_fd() was used
+    size_t                              map_size;
+    size_t                              map_pos;        // read position within the map
     struct {
         unsigned int                    verbose:1;
     } flags;
@@ -402,6 +417,50 @@ static inline unsigned int omf_lnames_context_get_next_add_index(const struct om
 int omf_context_read_fd(struct omf_context_t * const ctx,int fd);
 int omf_context_next_lib_module_fd(struct omf_context_t * const ctx,int fd);
 
+// memory mapped reading (Linux hosts). records are views into the map, no copying.
+// omf_context_map_fd() returns -1 (errno == ENOSYS) where not supported, use the _fd functions then.
+int omf_context_map_fd(struct omf_context_t * const ctx,int fd);
+void omf_context_unmap(struct omf_context_t * const ctx);
+int omf_context_read_map(struct omf_context_t * const ctx);
+int omf_context_next_lib_module_map(struct omf_context_t * const ctx);
+
+static inline unsigned char omf_context_is_mapped(const struct omf_context_t * const ctx) {
+    return (ctx->map_base != NULL);
+}
+
+// position to read the module (or record) at file offset ofs next, i.e. a module page from the .LIB dictionary
+int omf_context_seek_lib_module_fd(struct omf_context_t * const ctx,int fd,unsigned long ofs);
+int omf_context_seek_lib_module_map(struct omf_context_t * const ctx,unsigned long ofs);
+
+// .LIB dictionary
+#define OMF_LIB_DICT_BLOCK_SIZE         512u
+#define OMF_LIB_DICT_BUCKETS            37u
+
+#define OMF_LIBHEAD_FLAG_CASE_SENSITIVE 0x01u
+
+struct omf_libhead_t {
+    unsigned long                       dict_offset;    // file offset of dictionary
+    unsigned int                        dict_blocks;    // number of 512-byte dictionary blocks
+    unsigned int                        page_size;      // modules are aligned to this
+    unsigned char                       flags;
+};
+
+struct omf_lib_dict_entry_t {
+    const char*                         name;           // NOT NUL terminated
+    unsigned char                       name_len;
+    unsigned int                        page;           // module file offset = page * page_size
+};
+
+struct omf_lib_dict_hash_t {
+    unsigned int                        block,block_delta;
+    unsigned int                        bucket,bucket_delta;
+};
+
+int omf_lib_parse_LIBHEAD(struct omf_libhead_t * const h,struct omf_record_t * const rec);
+int omf_lib_dict_get_entry(struct omf_lib_dict_entry_t * const ent,const unsigned char * const block,const unsigned int bucket);
+void omf_lib_dict_hash(struct omf_lib_dict_hash_t * const h,const char * const name,const unsigned int len,const unsigned int blocks);
+int omf_lib_dict_block_add(unsigned char * const block,const struct omf_lib_dict_hash_t * const h,const char * const name,const unsigned int len,const unsigned int page);
+
 const char *omf_context_get_grpdef_name(const struct omf_context_t * const ctx,unsigned int i);
 const char *omf_context_get_grpdef_name_safe(const struct omf_context_t * const ctx,unsigned int i);
 const char *omf_context_get_segdef_name(const struct omf_context_t * const ctx,unsigned int i);
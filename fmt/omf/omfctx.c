@@ -2,7 +2,7 @@
 #include <fmt/omf/omf.h>
 #include <fmt/omf/omfcstr.h>
 
-char                                    omf_temp_str[255+1/*NUL*/];
+OMF_THREAD_LOCAL char                   omf_temp_str[255+1/*NUL*/];
  
 void omf_context_init(struct omf_context_t * const ctx) {
     omf_fixupps_context_init(&ctx->FIXUPPs);
@@ -20,9 +20,13 @@ void omf_context_init(struct omf_context_t * const ctx) {
     ctx->flags.verbose = 0;
     ctx->library_block_size = 0;
     ctx->THEADR = NULL;
+    ctx->map_base = NULL;
+    ctx->map_size = 0;
+    ctx->map_pos = 0;
 }
 
 void omf_context_free(struct omf_context_t * const ctx) {
+    omf_context_unmap(ctx);
     omf_fixupps_context_free(&ctx->FIXUPPs);
     omf_pubdefs_context_free(&ctx->PUBDEFs);
     omf_extdefs_context_free(&ctx->EXTDEFs);
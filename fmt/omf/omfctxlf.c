@@ -33,3 +33,13 @@ int omf_context_next_lib_module_fd(struct omf_context_t * const ctx,int fd) {
     return 1;
 }
 
+int omf_context_seek_lib_module_fd(struct omf_context_t * const ctx,int fd,unsigned long ofs) {
+    if (lseek(fd,(off_t)ofs,SEEK_SET) != (off_t)ofs)
+        return -1;
+
+    ctx->record.rec_file_offset = ofs;
+    ctx->record.rectype = 0;
+    ctx->record.reclen = 0;
+    return 0;
+}
+
@@ -0,0 +1,190 @@
+
+#include <fmt/omf/omf.h>
+#include <fmt/omf/omfcstr.h>
+
+#if defined(LINUX)
+# include <sys/mman.h>
+#endif
+
+// memory-mapped reading.
+//
+// the whole OBJ/LIB file is mapped read-only and each record read points ctx->record.data
+// directly into the map instead of copying it into the record buffer. the record is then
+// a view (type, length, pointer) and all the omf_record_get_* and omf_context_parse_*
+// functions work on it as-is. record data remains valid until omf_context_unmap().
+//
+// mapped records cannot be written to (data_alloc == 0).
+
+int omf_context_map_fd(struct omf_context_t * const ctx,int fd) {
+#if defined(LINUX)
+    struct stat st;
+    void *p;
+
+    omf_context_unmap(ctx);
+
+    if (fstat(fd,&st) < 0)
+        return -1; // sets errno
+    if (!S_ISREG(st.st_mode) || st.st_size <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    p = mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if (p == MAP_FAILED)
+        return -1; // sets errno
+
+    // records are read front to back
+    madvise(p,(size_t)st.st_size,MADV_SEQUENTIAL);
+
+    // the record buffer, if any, is not needed while reading from the map
+    omf_record_data_free(&ctx->record);
+
+    ctx->map_base = (const unsigned char*)p;
+    ctx->map_size = (size_t)st.st_size;
+    ctx->map_pos = 0;
+    ctx->record.data_mapped = 1;
+    ctx->record.data_alloc = 0;
+    ctx->record.rec_file_offset = 0;
+    return 0;
+#else
+    (void)ctx;
+    (void)fd;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+void omf_context_unmap(struct omf_context_t * const ctx) {
+    if (ctx->map_base != NULL) {
+#if defined(LINUX)
+        munmap((void*)ctx->map_base,ctx->map_size);
+#endif
+        ctx->map_base = NULL;
+        ctx->map_size = 0;
+        ctx->map_pos = 0;
+    }
+
+    if (ctx->record.data_mapped) {
+        omf_record_data_free(&ctx->record);
+        ctx->record.data_alloc = 4096; // back to the default for omf_context_read_fd()
+    }
+}
+
+int omf_context_read_map(struct omf_context_t * const ctx) {
+    const unsigned char *hdr;
+    unsigned char sum = 0;
+    unsigned int i;
+
+    // if the last record was a LIBEND, then stop reading.
+    // non-OMF junk usually follows.
+    if (ctx->record.rectype == 0xF1)
+        return 0;
+
+    // if the last record was a MODEND, then stop reading, make caller move to next module with another function
+    if ((ctx->record.rectype&0xFE) == 0x8A) // 0x8A or 0x8B
+        return 0;
+
+    ctx->last_error = NULL;
+    omf_record_clear(&ctx->record);
+    if (ctx->map_base == NULL || !ctx->record.data_mapped) {
+        ctx->last_error = "OMF file not mapped";
+        errno = EINVAL;
+        return -1;
+    }
+
+    ctx->record.rec_file_offset = ctx->map_pos;
+
+    if ((ctx->map_pos+3) > ctx->map_size)
+        return 0; // EOF
+
+    hdr = ctx->map_base + ctx->map_pos;
+    ctx->record.rectype = hdr[0];
+    ctx->record.reclen = (unsigned short)hdr[1] + ((unsigned short)hdr[2] << 8U); // length (including checksum). byte-wise, hdr is not aligned
+    if (ctx->record.rectype == 0 || ctx->record.reclen == 0)
+        return 0;
+    if ((ctx->map_pos+3+ctx->record.reclen) > ctx->map_size) {
+        ctx->last_error = "Reading OMF record contents failed";
+        errno = EIO;
+        return -1;
+    }
+
+    // the record is a view into the map, no copy
+    ctx->record.data = (unsigned char*)(hdr+3);
+    ctx->map_pos += 3 + ctx->record.reclen;
+
+    /* check checksum */
+    if (ctx->record.data[ctx->record.reclen-1] != 0/*optional*/) {
+        for (i=0;i < 3;i++)
+            sum += hdr[i];
+        for (i=0;i < ctx->record.reclen;i++)
+            sum += ctx->record.data[i];
+
+        if (sum != 0) {
+            ctx->last_error = "Reading OMF record checksum failed";
+            errno = EIO;
+            return -1;
+        }
+    }
+
+    /* remember LIBHEAD block size */
+    if (ctx->record.rectype == 0xF0/*LIBHEAD*/) {
+        if (ctx->library_block_size == 0) {
+            // and the length of the record defines the block size that modules within are aligned by
+            ctx->library_block_size = ctx->record.reclen + 3;
+        }
+        else {
+            ctx->last_error = "LIBHEAD defined again";
+            errno = EIO;
+            return -1;
+        }
+    }
+
+    ctx->record.reclen--; // omit checksum from reclen
+    return 1;
+}
+
+int omf_context_next_lib_module_map(struct omf_context_t * const ctx) {
+    unsigned long ofs;
+
+    // if the last record was a LIBEND, then stop reading.
+    // non-OMF junk usually follows.
+    if (ctx->record.rectype == 0xF1)
+        return 0;
+
+    // if the last record was not a MODEND, then stop reading.
+    if ((ctx->record.rectype&0xFE) != 0x8A) { // Not 0x8A or 0x8B
+        errno = EIO;
+        return -1;
+    }
+
+    // if we don't have a block size, then we cannot advance
+    if (ctx->library_block_size == 0UL)
+        return 0;
+
+    // where does the next block size start?
+    ofs = ctx->record.rec_file_offset + 3 + ctx->record.reclen;
+    ofs += ctx->library_block_size - 1UL;
+    ofs -= ofs % ctx->library_block_size;
+    if (ofs >= ctx->map_size)
+        return 0;
+
+    ctx->map_pos = ofs;
+    ctx->record.rec_file_offset = ofs;
+    ctx->record.rectype = 0;
+    ctx->record.reclen = 0;
+    return 1;
+}
+
+int omf_context_seek_lib_module_map(struct omf_context_t * const ctx,unsigned long ofs) {
+    if (ctx->map_base == NULL || ofs >= ctx->map_size) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ctx->map_pos = ofs;
+    ctx->record.rec_file_offset = ofs;
+    ctx->record.rectype = 0;
+    ctx->record.reclen = 0;
+    return 0;
+}
+
@@ -0,0 +1,130 @@
+
+#include <fmt/omf/omf.h>
+
+// OMF library (.LIB) dictionary.
+//
+// The dictionary follows the LIBEND record, starting on a 512-byte boundary. It is a
+// prime number of 512-byte blocks. Each block starts with 37 bucket bytes, each holding
+// (offset / 2) of an entry within the block or 0 if the bucket is empty. Byte 37 holds
+// (offset / 2) of the free space in the block, or 0xFF if the block is full. Entries
+// are a length-prefixed symbol name followed by the 16-bit page number of the module
+// that defines it, word aligned. Names ending in '!' are module names, not symbols.
+//
+// Where an entry goes is decided by the hash below, with open addressing on collision:
+// next bucket by bucket_delta within the block, next block by block_delta when full.
+
+int omf_lib_parse_LIBHEAD(struct omf_libhead_t * const h,struct omf_record_t * const rec) {
+    if (rec->rectype != OMF_RECTYPE_LIBHEAD)
+        return -1;
+
+    omf_record_lseek(rec,0);
+    if (omf_record_data_available(rec) < 7)
+        return -1;
+
+    h->dict_offset = omf_record_get_dword(rec);
+    h->dict_blocks = omf_record_get_word(rec);
+    h->flags = omf_record_get_byte(rec);
+    h->page_size = rec->reclen + 1u/*checksum*/ + 3u/*header*/;
+    return 0;
+}
+
+int omf_lib_dict_get_entry(struct omf_lib_dict_entry_t * const ent,const unsigned char * const block,const unsigned int bucket) {
+    unsigned int ofs;
+
+    if (bucket >= OMF_LIB_DICT_BUCKETS)
+        return -1;
+
+    ofs = (unsigned int)block[bucket] * 2u;
+    if (ofs == 0)
+        return 0; // empty bucket
+    if (ofs < (OMF_LIB_DICT_BUCKETS+1u) || (ofs + 1u) > OMF_LIB_DICT_BLOCK_SIZE)
+        return -1;
+
+    ent->name_len = block[ofs];
+    ent->name = (const char*)(block + ofs + 1u);
+    if ((ofs + 1u + ent->name_len + 2u) > OMF_LIB_DICT_BLOCK_SIZE)
+        return -1;
+
+    ent->page = (unsigned int)block[ofs + 1u + ent->name_len] + ((unsigned int)block[ofs + 2u + ent->name_len] << 8u);
+    return 1;
+}
+
+static inline unsigned short omf_lib_dict_rol(const unsigned short v) {
+    return (unsigned short)((v << 2u) | (v >> 14u));
+}
+
+static inline unsigned short omf_lib_dict_ror(const unsigned short v) {
+    return (unsigned short)((v >> 2u) | (v << 14u));
+}
+
+void omf_lib_dict_hash(struct omf_lib_dict_hash_t * const h,const char * const name,const unsigned int len,const unsigned int blocks) {
+    const unsigned char *front = (const unsigned char*)name;
+    const unsigned char *back = (const unsigned char*)name + len;
+    unsigned short block_x = (unsigned short)(len | 0x20u),block_d = 0;
+    unsigned short bucket_x = 0,bucket_d = (unsigned short)(len | 0x20u);
+    unsigned int count = len;
+    unsigned char c;
+
+    while (count != 0) {
+        c = *(--back) | 0x20u;
+        bucket_x = omf_lib_dict_ror(bucket_x) ^ c;
+        block_d = omf_lib_dict_rol(block_d) ^ c;
+        if (--count == 0) break;
+
+        c = *(front++) | 0x20u;
+        block_x = omf_lib_dict_rol(block_x) ^ c;
+        bucket_d = omf_lib_dict_ror(bucket_d) ^ c;
+    }
+
+    h->block = block_x % blocks;
+    h->block_delta = block_d % blocks;
+    if (h->block_delta == 0) h->block_delta = 1;
+    h->bucket = bucket_x % OMF_LIB_DICT_BUCKETS;
+    h->bucket_delta = bucket_d % OMF_LIB_DICT_BUCKETS;
+    if (h->bucket_delta == 0) h->bucket_delta = 1;
+}
+
+int omf_lib_dict_block_add(unsigned char * const block,const struct omf_lib_dict_hash_t * const h,const char * const name,const unsigned int len,const unsigned int page) {
+    unsigned int bucket = h->bucket;
+    unsigned int ofs,i;
+
+    if (len == 0 || len > 255)
+        return -1;
+
+    // block full?
+    if (block[OMF_LIB_DICT_BUCKETS] == 0xFF)
+        return 0;
+
+    ofs = (unsigned int)block[OMF_LIB_DICT_BUCKETS] * 2u;
+    if (ofs == 0) ofs = OMF_LIB_DICT_BUCKETS+1u; // fresh block, entries start after the free space byte
+
+    if ((ofs + 1u + len + 2u) > OMF_LIB_DICT_BLOCK_SIZE) {
+        block[OMF_LIB_DICT_BUCKETS] = 0xFF;
+        return 0;
+    }
+
+    for (i=0;i < OMF_LIB_DICT_BUCKETS;i++) {
+        if (block[bucket] == 0) {
+            block[bucket] = (unsigned char)(ofs / 2u);
+            block[ofs] = (unsigned char)len;
+            memcpy(block + ofs + 1u,name,len);
+            block[ofs + 1u + len] = (unsigned char)(page & 0xFFu);
+            block[ofs + 2u + len] = (unsigned char)(page >> 8u);
+
+            ofs = (ofs + 1u + len + 2u + 1u) & (~1u);
+            if (ofs >= (OMF_LIB_DICT_BLOCK_SIZE - 2u)) // 0xFF would mean full
+                block[OMF_LIB_DICT_BUCKETS] = 0xFF;
+            else
+                block[OMF_LIB_DICT_BUCKETS] = (unsigned char)(ofs / 2u);
+
+            return 1;
+        }
+
+        bucket = (bucket + h->bucket_delta) % OMF_LIB_DICT_BUCKETS;
+    }
+
+    // all buckets taken
+    block[OMF_LIB_DICT_BUCKETS] = 0xFF;
+    return 0;
+}
+
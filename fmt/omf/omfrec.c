@@ -11,13 +11,15 @@ void omf_record_init(struct omf_record_t * const rec) {
     rec->data = NULL;
     rec->data_alloc = 4096; // OMF spec says 1024
     rec->rec_file_offset = (~0UL);
+    rec->data_mapped = 0;
 }
 
 void omf_record_data_free(struct omf_record_t * const rec) {
     if (rec->data != NULL) {
-        free(rec->data);
+        if (!rec->data_mapped) free(rec->data);
         rec->data = NULL;
     }
+    rec->data_mapped = 0;
     rec->reclen = 0;
     rec->rectype = 0;
 }
@@ -103,7 +105,8 @@ unsigned char omf_record_get_byte(struct omf_record_t * const rec) {
 static inline unsigned short omf_record_get_word_fast(struct omf_record_t * const rec) {
     unsigned short c;
 
-    c = le16toh(*((uint16_t*)(rec->data + rec->recpos)));
+    /* byte-wise: data may be a view into a memory mapped file, at any alignment */
+    c = (unsigned short)rec->data[rec->recpos] + ((unsigned short)rec->data[rec->recpos+1U] << 8U);
     rec->recpos += 2;
     return c;
 }
@@ -120,7 +123,8 @@ unsigned short omf_record_get_word(struct omf_record_t * const rec) {
 static inline unsigned long omf_record_get_dword_fast(struct omf_record_t * const rec) {
     unsigned long c;
 
-    c = le32toh(*((uint32_t*)(rec->data + rec->recpos)));
+    c = (unsigned long)rec->data[rec->recpos] + ((unsigned long)rec->data[rec->recpos+1U] << 8UL) +
+        ((unsigned long)rec->data[rec->recpos+2U] << 16UL) + ((unsigned long)rec->data[rec->recpos+3U] << 24UL);
     rec->recpos += 4;
     return c;
 }
@@ -56,7 +56,7 @@ final: $(PARTO1_EXE) $(CRAPTN52_EXE) $(MINGAME2_EXE) $(MINGAME3_EXE) $(GAME_COM)
 	# rotozoomer sin (quarter) table
 	@cp sin2048.bin final/sorcwoo.sin
 	# pack it up
-	@bash -c 'cd final && ../dumbpack.pl sorcwoo.pal sorcwoo.sin sorcwoo{1,2,3,4,5,6,7,8,9}.vrl sorcuhhh.vrl sorcbwo{1,2,3,4,5,6,7,8,9}.vrl gmch{1,2,3,4}.pal gmch{1,2,3,4}.vrl gmchm{1,2}.vrl gmch3oco.vrl -- sorcwoo.vrp'
+	@bash -c 'cd final && ../dumbpack.pl -2 sorcwoo.pal sorcwoo.sin sorcwoo{1,2,3,4,5,6,7,8,9}.vrl sorcuhhh.vrl sorcbwo{1,2,3,4,5,6,7,8,9}.vrl gmch{1,2,3,4}.pal gmch{1,2,3,4}.vrl gmchm{1,2}.vrl gmch3oco.vrl -- sorcwoo.vrp'
 	@bash -c 'cd final && rm sorcwoo.pal sorcwoo.sin sorcwoo{1,2,3,4,5,6,7,8,9}.vrl sorcuhhh.vrl sorcbwo{1,2,3,4,5,6,7,8,9}.vrl'
 	@bash -c 'cd final && rm gmch{1,2,3,4}.{vrl,pal} gmchm{1,2}.vrl gmch3oco.vrl'
 	# fonts
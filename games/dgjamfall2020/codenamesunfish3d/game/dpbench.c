@@ -0,0 +1,321 @@
+
+/* WARNING: For host systems only. Loads every entry of the cutscene pack (sorcwoo.vrp) the
+ *          old way (version 1, lseek+read per entry) and through the version 2 reader, checks
+ *          they give the same bytes, then times them. Not part of the game, see makefile. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "dumbpack.h"
+
+#define BENCH_ROUNDS    200
+
+struct bench_ent {
+    unsigned char*      data;
+    uint32_t            size;
+};
+
+static struct bench_ent *ref_ent = NULL;
+static unsigned int ref_count = 0;
+static const char **ref_name = NULL;
+static int cold = 0;
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static unsigned long file_size(const char *path) {
+    struct stat st;
+    if (stat(path,&st)) return 0ul;
+    return (unsigned long)st.st_size;
+}
+
+/* ask the OS to forget the cached file, so the next round reads it from disk again. best effort,
+ * it does nothing on tmpfs and the drive may still have it in its own cache */
+static void drop_cache(const char *path) {
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = open(path,O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+/* the version 1 reader and load_vrl_fd() as they were: offset table, then lseek and read each
+ * entry into its own buffer */
+static int load_v1(const char *path,struct bench_ent *ent,unsigned int *count) {
+    uint32_t *offset = NULL;
+    unsigned int i;
+    uint16_t c;
+    int fd;
+
+    if ((fd=open(path,O_RDONLY)) < 0) return -1;
+    if (read(fd,&c,2) != 2) goto fail;
+    if ((offset=malloc(sizeof(uint32_t) * (c + 1u))) == NULL) goto fail;
+    if (read(fd,offset,sizeof(uint32_t) * (c + 1u)) != (ssize_t)(sizeof(uint32_t) * (c + 1u))) goto fail;
+
+    for (i=0;i < c;i++) {
+        ent[i].size = offset[i+1] - offset[i];
+        if ((ent[i].data=malloc(ent[i].size)) == NULL) goto fail;
+        if (lseek(fd,offset[i],SEEK_SET) != (off_t)offset[i]) goto fail;
+        if (read(fd,ent[i].data,ent[i].size) != (ssize_t)ent[i].size) goto fail;
+    }
+
+    *count = c;
+    free(offset);
+    close(fd);
+    return 0;
+fail:
+    if (offset != NULL) free(offset);
+    close(fd);
+    return -1;
+}
+
+/* version 2, by name, copied (or inflated) into a buffer the caller owns like seqcomm.c does */
+static int load_v2_read(const char *path,struct bench_ent *ent) {
+    struct dumbpack *p;
+    unsigned int i;
+    int x;
+
+    if ((p=dumbpack_open(path)) == NULL) return -1;
+
+    for (i=0;i < ref_count;i++) {
+        if ((x=dumbpack_lookup(p,ref_name[i])) < 0) goto fail;
+        ent[i].size = dumbpack_ent_size(p,(unsigned int)x);
+        if ((ent[i].data=malloc(ent[i].size)) == NULL) goto fail;
+        if (dumbpack_ent_read(p,(unsigned int)x,ent[i].data,ent[i].size)) goto fail;
+    }
+
+    dumbpack_close(&p);
+    return 0;
+fail:
+    dumbpack_close(&p);
+    return -1;
+}
+
+/* version 2, by name, through dumbpack_ent_data(). passes > 1 touches everything again to show
+ * the decoded entries are kept */
+static int load_v2_data(const char *path,const unsigned int passes,const int check) {
+    const unsigned char *d;
+    struct dumbpack *p;
+    unsigned int i,pass;
+    int x;
+
+    if ((p=dumbpack_open(path)) == NULL) return -1;
+
+    for (pass=0;pass < passes;pass++) {
+        for (i=0;i < ref_count;i++) {
+            if ((x=dumbpack_lookup(p,ref_name[i])) < 0) goto fail;
+            if ((d=dumbpack_ent_data(p,(unsigned int)x)) == NULL) goto fail;
+            if (check && (dumbpack_ent_size(p,(unsigned int)x) != ref_ent[i].size || memcmp(d,ref_ent[i].data,ref_ent[i].size))) goto fail;
+        }
+    }
+
+    dumbpack_close(&p);
+    return 0;
+fail:
+    dumbpack_close(&p);
+    return -1;
+}
+
+static void free_ents(struct bench_ent *ent,const unsigned int count) {
+    unsigned int i;
+
+    for (i=0;i < count;i++) {
+        if (ent[i].data != NULL) free(ent[i].data);
+        ent[i].data = NULL;
+    }
+}
+
+static int check_ents(const struct bench_ent *ent) {
+    unsigned int i;
+
+    for (i=0;i < ref_count;i++) {
+        if (ent[i].size != ref_ent[i].size || memcmp(ent[i].data,ref_ent[i].data,ref_ent[i].size))
+            return -1;
+    }
+
+    return 0;
+}
+
+/* entry names are not in version 1, take them from the version 2 pack made from the same files */
+static void free_names(void) {
+    unsigned int i;
+
+    if (ref_name != NULL) {
+        for (i=0;i < ref_count;i++) {
+            if (ref_name[i] != NULL) free((char*)ref_name[i]);
+        }
+        free(ref_name);
+        ref_name = NULL;
+    }
+}
+
+static int get_names(const char *path) {
+    struct dumbpack *p;
+    unsigned int i;
+    const char *n;
+
+    free_names();
+    if ((p=dumbpack_open(path)) == NULL) return -1;
+    if (p->ent_count != ref_count) goto fail;
+    if ((ref_name=calloc(ref_count,sizeof(char*))) == NULL) goto fail;
+
+    for (i=0;i < ref_count;i++) {
+        if ((n=dumbpack_ent_name(p,i)) == NULL) goto fail;
+        if ((ref_name[i]=strdup(n)) == NULL) goto fail;
+        if (dumbpack_lookup(p,n) != (int)i) goto fail;
+    }
+
+    /* not in the pack */
+    if (dumbpack_lookup(p,"nothere.vrl") >= 0) goto fail;
+
+    dumbpack_close(&p);
+    return 0;
+fail:
+    dumbpack_close(&p);
+    return -1;
+}
+
+typedef int (*bench_fn)(const char *path,struct bench_ent *ent);
+
+static int bench_v1(const char *path,struct bench_ent *ent) {
+    unsigned int c;
+    return load_v1(path,ent,&c);
+}
+
+static int bench_v2_data(const char *path,struct bench_ent *ent) {
+    (void)ent;
+    return load_v2_data(path,1,0);
+}
+
+static int bench_v2_data2(const char *path,struct bench_ent *ent) {
+    (void)ent;
+    return load_v2_data(path,2,0);
+}
+
+struct bench_mode {
+    const char*         name;
+    const char*         path;
+    bench_fn            fn;
+};
+
+static const char v1_path[] = "bench1.vrp";
+static const char v2_path[] = "bench2.vrp";
+static const char v2z_path[] = "bench2z.vrp";
+
+static const struct bench_mode bench_modes[] = {
+    {"v1 lseek+read",       v1_path,    bench_v1},
+    {"v2 ent_read",         v2_path,    load_v2_read},
+    {"v2 ent_data (mmap)",  v2_path,    bench_v2_data},
+    {"v2 -z ent_read",      v2z_path,   load_v2_read},
+    {"v2 -z ent_data",      v2z_path,   bench_v2_data},
+    {"v2 -z ent_data x2",   v2z_path,   bench_v2_data2}
+};
+
+#define BENCH_MODES (sizeof(bench_modes) / sizeof(bench_modes[0]))
+
+/* everything has to match what the version 1 pack holds */
+static int check(struct bench_ent *ent) {
+    unsigned int m;
+
+    for (m=0;m < BENCH_MODES;m++) {
+        if (bench_modes[m].fn == bench_v2_data || bench_modes[m].fn == bench_v2_data2) {
+            if (load_v2_data(bench_modes[m].path,2,1))
+                goto fail;
+        }
+        else {
+            if (bench_modes[m].fn(bench_modes[m].path,ent) || check_ents(ent)) {
+                free_ents(ent,ref_count);
+                goto fail;
+            }
+            free_ents(ent,ref_count);
+        }
+    }
+
+    return 0;
+fail:
+    fprintf(stderr,"%s: data differs\n",bench_modes[m].name);
+    return -1;
+}
+
+static int bench(struct bench_ent *ent) {
+    const unsigned int rounds = cold ? 20 : BENCH_ROUNDS;
+    unsigned int m,r;
+    double t0,t1,total;
+
+    printf("pack sizes: v1 %lu, v2 %lu, v2 -z %lu bytes\n",file_size(v1_path),file_size(v2_path),file_size(v2z_path));
+    printf("%-22s %12s\n",cold ? "mode (cold cache)" : "mode","us/load");
+
+    for (m=0;m < BENCH_MODES;m++) {
+        total = 0;
+
+        for (r=0;r < rounds;r++) {
+            if (cold) drop_cache(bench_modes[m].path);
+
+            t0 = bench_time();
+            if (bench_modes[m].fn(bench_modes[m].path,ent)) return -1;
+            t1 = bench_time();
+            total += t1 - t0;
+
+            free_ents(ent,ref_count);
+        }
+
+        printf("%-22s %12.1f\n",bench_modes[m].name,(total * 1000000.0) / rounds);
+    }
+
+    return 0;
+}
+
+int main(int argc,char **argv) {
+    struct bench_ent *ent;
+    int test = 0,i,r = 0;
+
+    for (i=1;i < argc;i++) {
+        if (!strcmp(argv[i],"-test"))
+            test = 1;
+        else if (!strcmp(argv[i],"-cold"))
+            cold = 1;
+        else {
+            fprintf(stderr,"dpbench [-test] [-cold]\n");
+            return 1;
+        }
+    }
+
+    if ((ref_ent=calloc(0xFFFFu,sizeof(struct bench_ent))) == NULL || (ent=calloc(0xFFFFu,sizeof(struct bench_ent))) == NULL)
+        return 1;
+
+    if (load_v1(v1_path,ref_ent,&ref_count) || ref_count == 0) {
+        fprintf(stderr,"Cannot read %s\n",v1_path);
+        r = 1;
+    }
+    else if (get_names(v2_path) || get_names(v2z_path)) {
+        fprintf(stderr,"Entry names or lookup are wrong\n");
+        r = 1;
+    }
+    else if (check(ent)) {
+        r = 1;
+    }
+    else {
+        printf("%u entries, all readers match\n",ref_count);
+        if (!test && bench(ent)) r = 1;
+    }
+
+    free_names();
+    free_ents(ref_ent,ref_count);
+    free(ref_ent);
+    free(ent);
+    return r;
+}
+
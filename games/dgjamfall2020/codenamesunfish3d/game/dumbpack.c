@@ -1,8 +1,22 @@
 
+#if defined(LINUX)
+/* host build, for checking dumbpack.pl output and the load benchmark (see makefile) */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "dumbpack.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdarg.h>
 #include <unistd.h>
 #include <assert.h>
@@ -31,23 +45,166 @@
 #include "dumbpack.h"
 #include "fzlibdec.h"
 #include "fataexit.h"
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+/* keep every table allocation under 64KB for the 16-bit builds */
+#define DUMBPACK_MAX_ENT        (0xFF00u / sizeof(struct dumbpack_ent))
+
+static unsigned char dumbpack_lcase(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') c += (unsigned char)('a' - 'A');
+    return c;
+}
+
+/* FNV-1a, same as dumbpack.pl */
+static uint32_t dumbpack_name_hash(const char *s) {
+    uint32_t h = 0x811C9DC5ul;
+
+    while (*s != 0) {
+        h ^= (uint32_t)dumbpack_lcase((unsigned char)(*s++));
+        h *= 0x01000193ul;
+    }
+
+    return h;
+}
+
+static int dumbpack_name_eq(const char *a,const char *b) {
+    while (*a != 0 && dumbpack_lcase((unsigned char)(*a)) == dumbpack_lcase((unsigned char)(*b))) {
+        a++;
+        b++;
+    }
+
+    return *a == 0 && *b == 0;
+}
+
+static int dumbpack_read_at(struct dumbpack *d,uint32_t ofs,void *buf,uint32_t sz) {
+#if defined(LINUX)
+    if (ofs > d->map_size || sz > (d->map_size - ofs)) return -1;
+    memcpy(buf,d->map+ofs,sz);
+#else
+    if ((unsigned int)sz != sz) return -1;
+    if (lseek(d->fd,ofs,SEEK_SET) != ofs) return -1;
+    if ((unsigned int)read(d->fd,buf,(unsigned int)sz) != (unsigned int)sz) return -1;
+#endif
+    return 0;
+}
+
+#if defined(LINUX)
+static int dumbpack_inflate(unsigned char *buf,uint32_t sz,const unsigned char *src,uint32_t srcsz) {
+    z_stream z;
+    int r = -1;
+
+    memset(&z,0,sizeof(z));
+    z.next_out = buf;
+    z.avail_out = sz;
+    z.next_in = (unsigned char*)src;
+    z.avail_in = srcsz;
+    if (inflateInit2(&z,15/*max window size 32KB*/) != Z_OK) return -1;
+
+    /* everything is in memory, one call does it. Z_BUF_ERROR is fine if only part was asked for */
+    inflate(&z,Z_FINISH);
+    if (z.avail_out == 0) r = 0;
+
+    inflateEnd(&z);
+    return r;
+}
+#endif
+
+static int dumbpack_open_v1(struct dumbpack *d,const unsigned int count) {
+    uint32_t *offset;
+    unsigned int i;
+
+    if (count >= DUMBPACK_MAX_ENT) return -1;
+    if ((offset=malloc(sizeof(uint32_t) * (count + 1))) == NULL) return -1;
+    if ((d->ent=calloc(count + 1,sizeof(struct dumbpack_ent))) == NULL) goto fail;
+    if (dumbpack_read_at(d,2,offset,sizeof(uint32_t) * (count + 1))) goto fail;
+
+    for (i=0;i < count;i++) {
+        if (offset[i+1] < offset[i]) goto fail;
+        d->ent[i].offset = offset[i];
+        d->ent[i].size = d->ent[i].usize = offset[i+1] - offset[i];
+    }
+
+    d->ent_count = count;
+    free(offset);
+    return 0;
+fail:
+    free(offset);
+    return -1;
+}
+
+static int dumbpack_open_v2(struct dumbpack *d) {
+    unsigned char hdr[12];
+    uint32_t names_size;
+    unsigned int count,i;
+    uint32_t ofs;
+
+    if (dumbpack_read_at(d,0,hdr,sizeof(hdr))) return -1;
+    if (memcmp(hdr,"DPK2",4)) return -1;
+
+    count = (unsigned int)hdr[4] + ((unsigned int)hdr[5] << 8u);
+    names_size = (uint32_t)hdr[8] + ((uint32_t)hdr[9] << 8ul) + ((uint32_t)hdr[10] << 16ul) + ((uint32_t)hdr[11] << 24ul);
+    if (count >= DUMBPACK_MAX_ENT || names_size >= 0xFF00ul) return -1;
+
+    if ((d->ent=calloc(count + 1,sizeof(struct dumbpack_ent))) == NULL) return -1;
+    if ((d->by_hash=malloc(sizeof(uint16_t) * (count + 1))) == NULL) return -1;
+    if ((d->names=malloc((unsigned int)names_size + 1)) == NULL) return -1;
+
+    ofs = sizeof(hdr);
+    if (dumbpack_read_at(d,ofs,d->ent,sizeof(struct dumbpack_ent) * count)) return -1;
+    ofs += sizeof(struct dumbpack_ent) * count;
+    if (dumbpack_read_at(d,ofs,d->by_hash,sizeof(uint16_t) * count)) return -1;
+    ofs += sizeof(uint16_t) * count;
+    if (dumbpack_read_at(d,ofs,d->names,names_size)) return -1;
+    d->names[names_size] = 0;
+
+    for (i=0;i < count;i++) {
+        if (d->ent[i].name >= names_size) return -1;
+        if (d->ent[i].flags & ~DUMBPACK_ENT_ZLIB) return -1; /* something newer than this code */
+        if (!(d->ent[i].flags & DUMBPACK_ENT_ZLIB) && d->ent[i].size != d->ent[i].usize) return -1;
+#if defined(LINUX)
+        if (d->ent[i].offset > d->map_size || d->ent[i].size > (d->map_size - d->ent[i].offset)) return -1;
+#endif
+        if (d->by_hash[i] >= count) return -1;
+    }
+
+    d->ent_count = count;
+    return 0;
+}
 
 struct dumbpack *dumbpack_open(const char *path) {
     struct dumbpack *d = calloc(1,sizeof(struct dumbpack));
+    unsigned char sig[2];
 
     if (d != NULL) {
         d->fd = open(path,O_RDONLY | O_BINARY);
         if (d->fd < 0) goto fail;
 
+#if defined(LINUX)
         {
-            uint16_t count;
-            if (read(d->fd,&count,2) != 2) goto fail;
-            d->offset_count = (unsigned int)count;
+            struct stat st;
+            void *p;
+
+            if (fstat(d->fd,&st) || st.st_size < 2 || st.st_size > 0x7FFFFFFFl) goto fail;
+            d->map_size = (uint32_t)st.st_size;
+
+            p = mmap(NULL,d->map_size,PROT_READ,MAP_SHARED,d->fd,0);
+            if (p == MAP_FAILED) goto fail;
+            d->map = (unsigned char*)p;
         }
+#endif
 
-        if (d->offset_count >= (0xFF00u / sizeof(uint32_t))) goto fail;
-        if ((d->offset=malloc(sizeof(uint32_t) * (d->offset_count + 1))) == NULL) goto fail;
-        if (read(d->fd,d->offset,sizeof(uint32_t) * (d->offset_count + 1)) != (sizeof(uint32_t) * (d->offset_count + 1))) goto fail;
+        if (dumbpack_read_at(d,0,sig,2)) goto fail;
+
+        if (sig[0] == 'D' && sig[1] == 'P') {
+            if (dumbpack_open_v2(d)) goto fail;
+        }
+        else {
+            if (dumbpack_open_v1(d,(unsigned int)sig[0] + ((unsigned int)sig[1] << 8u))) goto fail;
+        }
     }
 
     return d;
@@ -57,22 +214,79 @@ fail:
 }
 
 void dumbpack_close(struct dumbpack **d) {
+    unsigned int i;
+
     if (*d != NULL) {
+        if ((*d)->cache != NULL) {
+            for (i=0;i < (*d)->ent_count;i++) {
+                if ((*d)->cache[i] != NULL) free((*d)->cache[i]);
+            }
+            free((*d)->cache);
+            (*d)->cache = NULL;
+        }
+
+#if defined(LINUX)
+        if ((*d)->map != NULL) munmap((*d)->map,(*d)->map_size);
+        (*d)->map = NULL;
+#endif
+
         if ((*d)->fd >= 0) close((*d)->fd);
         (*d)->fd = -1;
 
-        if ((*d)->offset != NULL) free((*d)->offset);
-        (*d)->offset = NULL;
+        if ((*d)->ent != NULL) free((*d)->ent);
+        (*d)->ent = NULL;
+
+        if ((*d)->by_hash != NULL) free((*d)->by_hash);
+        (*d)->by_hash = NULL;
+
+        if ((*d)->names != NULL) free((*d)->names);
+        (*d)->names = NULL;
 
         free(*d);
         *d = NULL;
     }
 }
 
+int dumbpack_lookup(struct dumbpack *p,const char *name) {
+    unsigned int lo,hi,mid,x;
+    uint32_t h;
+
+    if (p == NULL || p->by_hash == NULL) return -1;
+
+    h = dumbpack_name_hash(name);
+    lo = 0;
+    hi = p->ent_count;
+    while (lo < hi) {
+        mid = (lo + hi) >> 1u;
+        if (p->ent[p->by_hash[mid]].hash < h)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    while (lo < p->ent_count && p->ent[x=p->by_hash[lo]].hash == h) {
+        if (dumbpack_name_eq(p->names + p->ent[x].name,name))
+            return (int)x;
+
+        lo++;
+    }
+
+    return -1;
+}
+
+const char *dumbpack_ent_name(struct dumbpack *p,unsigned int x) {
+    if (p != NULL) {
+        if (p->names != NULL && x < p->ent_count)
+            return p->names + p->ent[x].name;
+    }
+
+    return NULL;
+}
+
 uint32_t dumbpack_ent_offset(struct dumbpack *p,unsigned int x) {
     if (p != NULL) {
-        if (p->offset != NULL && x < p->offset_count)
-            return p->offset[x];
+        if (p->ent != NULL && x < p->ent_count && !(p->ent[x].flags & DUMBPACK_ENT_ZLIB))
+            return p->ent[x].offset;
     }
 
     return 0ul;
@@ -80,10 +294,80 @@ uint32_t dumbpack_ent_offset(struct dumbpack *p,unsigned int x) {
 
 uint32_t dumbpack_ent_size(struct dumbpack *p,unsigned int x) {
     if (p != NULL) {
-        if (p->offset != NULL && x < p->offset_count)
-            return p->offset[x+1] - p->offset[x];
+        if (p->ent != NULL && x < p->ent_count)
+            return p->ent[x].usize;
     }
 
     return 0ul;
 }
 
+int dumbpack_ent_read(struct dumbpack *p,unsigned int x,unsigned char *buf,uint32_t sz) {
+    const struct dumbpack_ent *e;
+
+    if (p == NULL || p->ent == NULL || x >= p->ent_count) return -1;
+    e = &(p->ent[x]);
+
+    if (sz > e->usize) return -1;
+    if (sz == 0ul) return 0;
+
+    if (p->cache != NULL && p->cache[x] != NULL) {
+        memcpy(buf,p->cache[x],sz);
+        return 0;
+    }
+
+    if (e->flags & DUMBPACK_ENT_ZLIB) {
+#if defined(LINUX)
+        return dumbpack_inflate(buf,sz,p->map+e->offset,e->size);
+#else
+        if ((unsigned int)sz != sz) return -1;
+        if (lseek(p->fd,e->offset,SEEK_SET) != e->offset) return -1;
+        return file_zlib_decompress(p->fd,buf,(unsigned int)sz,e->size);
+#endif
+    }
+
+    return dumbpack_read_at(p,e->offset,buf,sz);
+}
+
+/* whole entry, uncompressed. On the host build an entry that is not compressed points straight
+ * into the mmap()'d file. Anything else is read and inflated the first time it is asked for,
+ * then kept until dumbpack_ent_uncache() or dumbpack_close(). Do not modify or free it. */
+const unsigned char *dumbpack_ent_data(struct dumbpack *p,unsigned int x) {
+    const struct dumbpack_ent *e;
+    unsigned char *buf;
+
+    if (p == NULL || p->ent == NULL || x >= p->ent_count) return NULL;
+    e = &(p->ent[x]);
+
+#if defined(LINUX)
+    if (!(e->flags & DUMBPACK_ENT_ZLIB))
+        return p->map + e->offset;
+#endif
+
+    if (p->cache == NULL) {
+        if ((p->cache=calloc(p->ent_count,sizeof(unsigned char*))) == NULL)
+            return NULL;
+    }
+
+    if (p->cache[x] != NULL)
+        return p->cache[x];
+
+    if ((size_t)e->usize != e->usize) return NULL;
+    if ((buf=malloc(e->usize != 0ul ? (size_t)e->usize : 1u)) == NULL) return NULL;
+    if (dumbpack_ent_read(p,x,buf,e->usize)) {
+        free(buf);
+        return NULL;
+    }
+
+    p->cache[x] = buf;
+    return buf;
+}
+
+void dumbpack_ent_uncache(struct dumbpack *p,unsigned int x) {
+    if (p != NULL) {
+        if (p->cache != NULL && x < p->ent_count && p->cache[x] != NULL) {
+            free(p->cache[x]);
+            p->cache[x] = NULL;
+        }
+    }
+}
+
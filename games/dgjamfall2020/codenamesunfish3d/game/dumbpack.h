@@ -1,19 +1,57 @@
-
 #ifndef __DUMBPACK_H
 #define __DUMBPACK_H
 
 #include <stdint.h>
 
+/* Version 1: uint16_t count, uint32_t offset[count+1], data. Entries are numbered only.
+ *
+ * Version 2 (dumbpack.pl -2):
+ *
+ *   char       sig[4] = "DPK2"         (a version 1 count that large is rejected, no confusion)
+ *   uint16_t   count
+ *   uint16_t   flags                   (0)
+ *   uint32_t   names_size
+ *   struct     dumbpack_ent[count]     (20 bytes each, little endian)
+ *   uint16_t   by_hash[count]          entry numbers sorted by name hash
+ *   char       names[names_size]       NUL terminated names
+ *   data
+ *
+ * Entries keep the order given to dumbpack.pl so the numbers used by the game stay the same.
+ * Names are compared and hashed (FNV-1a) without regard to ASCII case. */
+
+#define DUMBPACK_ENT_ZLIB       0x0001u     /* stored zlib compressed, usize is the size after inflate */
+
+struct dumbpack_ent {
+    uint32_t            offset;             /* file offset of the stored data */
+    uint32_t            size;               /* stored size */
+    uint32_t            usize;              /* uncompressed size */
+    uint32_t            hash;               /* of the name */
+    uint16_t            name;               /* offset in names[] */
+    uint16_t            flags;
+};
+
 struct dumbpack {
     int                 fd;
-    uint32_t*           offset;
-    unsigned int        offset_count;
+    struct dumbpack_ent*ent;
+    unsigned int        ent_count;
+    uint16_t*           by_hash;            /* version 2 only */
+    char*               names;              /* version 2 only */
+    unsigned char**     cache;              /* per entry, decoded by dumbpack_ent_data() */
+#if defined(LINUX)
+    unsigned char*      map;                /* whole file, mmap()'d */
+    uint32_t            map_size;
+#endif
 };
 
 void dumbpack_close(struct dumbpack **d);
 struct dumbpack *dumbpack_open(const char *path);
-uint32_t dumbpack_ent_offset(struct dumbpack *p,unsigned int x);
-uint32_t dumbpack_ent_size(struct dumbpack *p,unsigned int x);
+int dumbpack_lookup(struct dumbpack *p,const char *name); /* entry number, or -1 */
+const char *dumbpack_ent_name(struct dumbpack *p,unsigned int x); /* NULL if version 1 */
+uint32_t dumbpack_ent_offset(struct dumbpack *p,unsigned int x); /* 0 if compressed, use dumbpack_ent_read() */
+uint32_t dumbpack_ent_size(struct dumbpack *p,unsigned int x); /* uncompressed */
+int dumbpack_ent_read(struct dumbpack *p,unsigned int x,unsigned char *buf,uint32_t sz); /* first sz bytes, 0 if OK */
+const unsigned char *dumbpack_ent_data(struct dumbpack *p,unsigned int x); /* whole entry, see dumbpack.c */
+void dumbpack_ent_uncache(struct dumbpack *p,unsigned int x);
 
 #endif //__DUMBPACK_H
 
@@ -1,11 +1,26 @@
 #!/usr/bin/perl
 # Pack a bunch of files into an extremely simple format single file
-# ./dumbpack.pl [in [in [in [...]]]] -- out
+# ./dumbpack.pl [-2] [-z] [in [in [in [...]]]] -- out
+#
+# -2    write version 2 (named entries with a hash index, see dumbpack.h)
+# -z    version 2: zlib compress entries that get at least 1/8 smaller
+use Compress::Zlib;
+
 my @srcfiles;
 my $dstfile;
+my $v2 = 0;
+my $zlib = 0;
 
 for ($i=0;$i < @ARGV;$i++) {
     last if ($ARGV[$i] eq "--");
+    if ($ARGV[$i] eq "-2") {
+        $v2 = 1;
+        next;
+    }
+    if ($ARGV[$i] eq "-z") {
+        $zlib = 1;
+        next;
+    }
     die "input file does not exist" unless -f $ARGV[$i];
     push(@srcfiles,$ARGV[$i]);
 }
@@ -14,6 +29,87 @@ die "no output file" if ($i == @ARGV); # because it means we never hit the --
 $i++; # skip --
 die "no output file" if ($i == @ARGV);
 $dstfile = $ARGV[$i];
+die "-z needs -2" if ($zlib && !$v2);
+
+# FNV-1a of the lower case name, must match dumbpack_name_hash() in dumbpack.c.
+# 0x01000193 = (1 << 24) + 0x193, split up so the product never needs more than 32+9 bits
+sub name_hash($) {
+    my $h = 0x811C9DC5;
+
+    foreach my $c (unpack("C*",lc($_[0]))) {
+        $h ^= $c;
+        $h = (($h * 0x193) + (($h & 0xFF) << 24)) & 0xFFFFFFFF;
+    }
+
+    return $h;
+}
+
+sub read_file($) {
+    my $buf = '';
+
+    open(IN,"<",$_[0]) || die;
+    binmode(IN);
+    read(IN,$buf,0x100000);
+    close(IN);
+
+    return $buf;
+}
+
+open(OUT,">",$dstfile) || die;
+binmode(OUT);
+
+if ($v2) {
+    my (@data,@usize,@flags,@hash,@nameofs);
+    my $names = '';
+
+    die "too many files" if (@srcfiles >= (0xFF00 / 20));
+
+    for ($i=0;$i < @srcfiles;$i++) {
+        my $buf = read_file($srcfiles[$i]);
+        my $name = $srcfiles[$i];
+        my $flags = 0;
+
+        $name =~ s/^.*\///; # basename
+        push(@usize,length($buf));
+        push(@hash,name_hash($name));
+        push(@nameofs,length($names));
+        $names .= $name."\0";
+
+        if ($zlib && length($buf) >= 64) {
+            my $z = compress($buf,Z_BEST_COMPRESSION);
+            if (defined($z) && length($z) <= (length($buf) - (length($buf) >> 3))) {
+                $buf = $z;
+                $flags |= 0x0001; # DUMBPACK_ENT_ZLIB
+            }
+        }
+
+        push(@flags,$flags);
+        push(@data,$buf);
+    }
+
+    die "names too long" if (length($names) >= 0xFF00);
+
+    my @by_hash = sort { $hash[$a] <=> $hash[$b] || $a <=> $b } (0..$#srcfiles);
+    my $ofs = 12 + (20 * @srcfiles) + (2 * @srcfiles) + length($names);
+
+    print OUT "DPK2";
+    print OUT pack("vvV",scalar(@srcfiles),0,length($names));
+    for ($i=0;$i < @srcfiles;$i++) {
+        print OUT pack("VVVVvv",$ofs,length($data[$i]),$usize[$i],$hash[$i],$nameofs[$i],$flags[$i]);
+        $ofs += length($data[$i]);
+    }
+    for ($i=0;$i < @by_hash;$i++) {
+        print OUT pack("v",$by_hash[$i]);
+    }
+    print OUT $names;
+    for ($i=0;$i < @srcfiles;$i++) {
+        print OUT $data[$i];
+    }
+
+    die "size error" unless tell(OUT) eq $ofs;
+    close(OUT);
+    exit 0;
+}
 
 my @offsets;
 my $ofs = 2 + (4 * (@srcfiles + 1));
@@ -25,9 +121,6 @@ for ($i=0;$i < @srcfiles;$i++) {
 }
 push(@offsets,$ofs);
 
-open(OUT,">",$dstfile) || die;
-binmode(OUT);
-
 print OUT pack("v",scalar(@srcfiles));
 for ($i=0;$i < @offsets;$i++) {
     print OUT pack("V",$offsets[$i]);
@@ -38,11 +131,7 @@ my $buf;
 for ($i=0;$i < @srcfiles;$i++) {
     die "offset $i error" unless tell(OUT) eq $offsets[$i];
 
-    open(IN,"<",$srcfiles[$i]) || die;
-    binmode(IN);
-    read(IN,$buf,0x100000);
-    print OUT $buf;
-    close(IN);
+    print OUT read_file($srcfiles[$i]);
 }
 
 close(OUT);
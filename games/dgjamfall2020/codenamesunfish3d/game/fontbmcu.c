@@ -1,4 +1,11 @@
 
+#if defined(LINUX)
+/* host build, see makefile */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fontbmp.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
@@ -28,6 +35,7 @@
 #include "commtmp.h"
 #include "fzlibdec.h"
 #include "fataexit.h"
+#endif
 
 /* yes, we use unicode (UTF-8) strings here in this DOS application! */
 int font_bmp_unicode_to_chardef(struct font_bmp *fnt,uint32_t c) {
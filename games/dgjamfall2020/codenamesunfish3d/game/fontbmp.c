@@ -1,4 +1,16 @@
 
+#if defined(LINUX)
+/* host build, see makefile */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fmt/minipng/minipng.h>
+
+#include "fontbmp.h"
+#include "fzlibdec.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
@@ -28,6 +40,7 @@
 #include "commtmp.h"
 #include "fzlibdec.h"
 #include "fataexit.h"
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* font handling                                                             */
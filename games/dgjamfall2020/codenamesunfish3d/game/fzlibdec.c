@@ -1,4 +1,15 @@
 
+#if defined(LINUX)
+/* host build, see makefile */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fmt/minipng/minipng.h>
+
+#include "fzlibdec.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
@@ -25,6 +36,7 @@
 #include "unicode.h"
 #include "commtmp.h"
 #include "fzlibdec.h"
+#endif
 
 int file_zlib_decompress(int fd,unsigned char *buf,unsigned int sz,uint32_t srcsz) {
 #define TMP_SZ 1024
@@ -1,9 +1,29 @@
 
 #include <stdint.h>
 
+#if defined(LINUX)
+/* host build (rotzhost.c). Draws into a linear 8bpp buffer instead of VGA memory */
+enum {
+    ROTOZOOM_HOST_REF=0,                                /* column by column, exactly like the DOS asm loop */
+    ROTOZOOM_HOST_SCALAR,                               /* row by row, 4 pixels per store */
+    ROTOZOOM_HOST_AVX2,                                 /* row by row, 8 texels per gather */
+    ROTOZOOM_HOST_MAX
+};
+
+unsigned char *rotozoomer_host_imgalloc(void);          /* 256x256, plus padding for the gather loads */
+void rotozoomer_host_imgfree(unsigned char **img);
+int rotozoomer_host_pngload(unsigned char *img,const char *path,unsigned char *pal/*768 bytes or NULL*/,unsigned char palofs);
+
+unsigned int rotozoomer_host_best(void);
+int rotozoomer_host_select(unsigned int level);         /* 0 if the CPU can't do that level */
+const char *rotozoomer_host_name(unsigned int level);
+
+void rotozoomer_host_effect(unsigned char *dst,unsigned int stride,unsigned int w,unsigned int h,const unsigned char *img,const uint32_t rt);
+#else
 unsigned rotozoomer_imgalloc(void);
 void rotozoomer_imgfree(unsigned *s);
 
 void rotozoomer_fast_effect(unsigned int w,unsigned int h,__segment imgseg,const uint32_t rt);
 int rotozoomerpngload(unsigned rotozoomerimgseg,const char *path,unsigned char palofs);
+#endif
 
@@ -0,0 +1,258 @@
+
+/* WARNING: For host systems only, not for DOS. See rotozoom.h and rotzfx8u.c */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fmt/minipng/minipng.h>
+
+#include "sin2048.h"
+#include "rotozoom.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define ROTOZOOM_HOST_X86_SIMD
+# include <immintrin.h>
+#endif
+
+/* the AVX2 loop gathers 32 bits per texel, the last texel needs 3 more bytes after the image */
+#define ROTOZOOM_HOST_IMG_SIZE      (0x10000u + 4u)
+
+unsigned char *rotozoomer_host_imgalloc(void) {
+    return calloc(1,ROTOZOOM_HOST_IMG_SIZE);
+}
+
+void rotozoomer_host_imgfree(unsigned char **img) {
+    if (*img != NULL) {
+        free(*img);
+        *img = NULL;
+    }
+}
+
+/* same as rotozoomerpngload(), the palette goes to 'pal' instead of the VGA */
+int rotozoomer_host_pngload(unsigned char *img,const char *path,unsigned char *pal,unsigned char palofs) {
+    struct minipng_reader *rdr;
+    unsigned int i;
+
+    if ((rdr=minipng_reader_open(path)) == NULL)
+        return -1;
+
+    if (minipng_reader_parse_head(rdr) || rdr->plte == NULL || rdr->plte_count == 0) {
+        minipng_reader_close(&rdr);
+        return -1;
+    }
+
+    for (i=0;i < 256;i++) {
+        unsigned char *imgptr = img + (i * 256u);
+        if (minipng_reader_read_idat(rdr,imgptr,1) != 1) { /* pad byte */
+            minipng_reader_close(&rdr);
+            return -1;
+        }
+        if (minipng_reader_read_idat(rdr,imgptr,256) != 256) { /* row */
+            minipng_reader_close(&rdr);
+            return -1;
+        }
+    }
+
+    if (pal != NULL) {
+        const unsigned char *p = (const unsigned char*)(rdr->plte);
+        for (i=0;i < rdr->plte_count && (i + palofs) < 256u;i++) {
+            pal[((i + palofs) * 3u) + 0u] = p[(i * 3u) + 0u];
+            pal[((i + palofs) * 3u) + 1u] = p[(i * 3u) + 1u];
+            pal[((i + palofs) * 3u) + 2u] = p[(i * 3u) + 2u];
+        }
+    }
+
+    minipng_reader_close(&rdr);
+    return 0;
+}
+
+/* 8.8 fixed point texture walk, 16 bits wide so it wraps around the 256x256 image the same way
+ * the DX/SI registers do in rotozoomer_fast_effect() */
+struct rotozoom_host_step {
+    uint16_t            sx1,sy1;        /* per 4-pixel column */
+    uint16_t            sx2,sy2;        /* per row */
+    uint16_t            fcx,fcy;        /* upper left corner */
+};
+
+static void rotozoomer_host_step(struct rotozoom_host_step *st,const unsigned int w,const unsigned int h,const uint32_t rt) {
+    // scale, to zoom in and out
+    const int32_t scale = ((int32_t)sin2048fps16_lookup(rt * 5ul) >> 1l) + 0xA000l;
+    // column-step. multiplied 4x because we're rendering only every 4 pixels for smoothness.
+    st->sx1 = (uint16_t)(((((int32_t)cos2048fps16_lookup(rt * 10ul) *  0x400l) >> 15l) * scale) >> 15l);
+    st->sy1 = (uint16_t)(((((int32_t)sin2048fps16_lookup(rt * 10ul) * -0x400l) >> 15l) * scale) >> 15l);
+    // row-step. multiplied by 1.2 (240/200) to compensate for 320x200 non-square pixels. (1.2 * 0x100) = 0x133
+    st->sx2 = (uint16_t)(((((int32_t)cos2048fps16_lookup(rt * 10ul) *  0x133l) >> 15l) * scale) >> 15l);
+    st->sy2 = (uint16_t)(((((int32_t)sin2048fps16_lookup(rt * 10ul) * -0x133l) >> 15l) * scale) >> 15l);
+
+    // make sure rotozoomer is centered on screen
+    st->fcx = (uint16_t)(0u - ((w / 2u / 4u) * st->sx1) - ((h / 2u) * st->sy2));
+    st->fcy = (uint16_t)(0u - ((w / 2u / 4u) * st->sy1) - ((h / 2u) * (uint16_t)(0u - st->sx2)));
+}
+
+static inline unsigned char rotozoomer_host_texel(const unsigned char *img,const uint16_t x,const uint16_t y) {
+    return img[(y & 0xFF00u) + (x >> 8u)];
+}
+
+/* the asm loop as written: one 4-pixel column at a time, top to bottom */
+static void rotozoomer_host_ref(unsigned char *dst,const unsigned int stride,unsigned int w,const unsigned int h,const unsigned char *img,const struct rotozoom_host_step *st) {
+    uint16_t fcx = st->fcx,fcy = st->fcy;
+    uint16_t dx,si;
+    unsigned char *d;
+    unsigned int y;
+
+    while (w >= 4) {
+        dx = fcx;
+        si = fcy;
+        d = dst;
+
+        for (y=0;y < h;y++) {
+            memset(d,rotozoomer_host_texel(img,dx,si),4);
+            d += stride;
+            dx += st->sy2;
+            si -= st->sx2;
+        }
+
+        dst += 4;
+        fcx += st->sx1;
+        fcy += st->sy1;
+        w -= 4;
+    }
+}
+
+/* same texels row by row, so the writes are sequential. the walk is modulo 2^16 either way */
+static void rotozoomer_host_scalar(unsigned char *dst,const unsigned int stride,const unsigned int w,const unsigned int h,const unsigned char *img,const struct rotozoom_host_step *st) {
+    const unsigned int cols = w >> 2u;
+    uint16_t rx = st->fcx,ry = st->fcy;
+    unsigned int y,c;
+    unsigned char *d;
+    uint16_t x,yy;
+    uint32_t t;
+
+    for (y=0;y < h;y++) {
+        d = dst + (y * stride);
+        x = rx;
+        yy = ry;
+        for (c=0;c < cols;c++) {
+            t = (uint32_t)rotozoomer_host_texel(img,x,yy) * 0x01010101ul;
+            memcpy(d,&t,4);
+            d += 4;
+            x += st->sx1;
+            yy += st->sy1;
+        }
+
+        rx += st->sy2;
+        ry -= st->sx2;
+    }
+}
+
+#if defined(ROTOZOOM_HOST_X86_SIMD)
+/* 8 columns (32 pixels) per iteration. 32-bit lanes hold the 16-bit walk, masked back to 16 bits */
+__attribute__((target("avx2")))
+static void rotozoomer_host_avx2(unsigned char *dst,const unsigned int stride,const unsigned int w,const unsigned int h,const unsigned char *img,const struct rotozoom_host_step *st) {
+    const unsigned int cols = w >> 2u;
+    const __m256i lane = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+    const __m256i lx = _mm256_mullo_epi32(lane,_mm256_set1_epi32(st->sx1));
+    const __m256i ly = _mm256_mullo_epi32(lane,_mm256_set1_epi32(st->sy1));
+    const __m256i step_x = _mm256_set1_epi32((int)((8u * st->sx1) & 0xFFFFu));
+    const __m256i step_y = _mm256_set1_epi32((int)((8u * st->sy1) & 0xFFFFu));
+    const __m256i m16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i mhi = _mm256_set1_epi32(0xFF00);
+    const __m256i mlo = _mm256_set1_epi32(0xFF);
+    const __m256i rep = _mm256_set1_epi32(0x01010101);
+    uint16_t rx = st->fcx,ry = st->fcy;
+    unsigned int y,c;
+    unsigned char *d;
+    uint16_t x,yy;
+    uint32_t t;
+
+    for (y=0;y < h;y++) {
+        __m256i vx = _mm256_and_si256(_mm256_add_epi32(_mm256_set1_epi32(rx),lx),m16);
+        __m256i vy = _mm256_and_si256(_mm256_add_epi32(_mm256_set1_epi32(ry),ly),m16);
+
+        d = dst + (y * stride);
+        for (c=0;(c+8u) <= cols;c += 8u) {
+            const __m256i idx = _mm256_or_si256(_mm256_and_si256(vy,mhi),_mm256_srli_epi32(vx,8));
+            __m256i v = _mm256_i32gather_epi32((const int*)img,idx,1);
+
+            v = _mm256_mullo_epi32(_mm256_and_si256(v,mlo),rep);
+            _mm256_storeu_si256((__m256i*)d,v);
+            d += 32;
+
+            vx = _mm256_and_si256(_mm256_add_epi32(vx,step_x),m16);
+            vy = _mm256_and_si256(_mm256_add_epi32(vy,step_y),m16);
+        }
+
+        x = (uint16_t)(rx + (c * st->sx1));
+        yy = (uint16_t)(ry + (c * st->sy1));
+        for (;c < cols;c++) {
+            t = (uint32_t)rotozoomer_host_texel(img,x,yy) * 0x01010101ul;
+            memcpy(d,&t,4);
+            d += 4;
+            x += st->sx1;
+            yy += st->sy1;
+        }
+
+        rx += st->sy2;
+        ry -= st->sx2;
+    }
+}
+#endif
+
+typedef void (*rotozoomer_host_fn)(unsigned char *dst,const unsigned int stride,const unsigned int w,const unsigned int h,const unsigned char *img,const struct rotozoom_host_step *st);
+
+static const char *rotozoomer_host_names[ROTOZOOM_HOST_MAX] = { "ref", "scalar", "avx2" };
+
+static rotozoomer_host_fn rotozoomer_host_cur = NULL;
+
+unsigned int rotozoomer_host_best(void) {
+#if defined(ROTOZOOM_HOST_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return ROTOZOOM_HOST_AVX2;
+#endif
+    return ROTOZOOM_HOST_SCALAR;
+}
+
+int rotozoomer_host_select(unsigned int level) {
+    switch (level) {
+        case ROTOZOOM_HOST_REF:
+            rotozoomer_host_cur = rotozoomer_host_ref;
+            return 1;
+        case ROTOZOOM_HOST_SCALAR:
+            rotozoomer_host_cur = rotozoomer_host_scalar;
+            return 1;
+#if defined(ROTOZOOM_HOST_X86_SIMD)
+        case ROTOZOOM_HOST_AVX2:
+            if (rotozoomer_host_best() < ROTOZOOM_HOST_AVX2) return 0;
+            rotozoomer_host_cur = rotozoomer_host_avx2;
+            return 1;
+#endif
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+const char *rotozoomer_host_name(unsigned int level) {
+    if (level < ROTOZOOM_HOST_MAX)
+        return rotozoomer_host_names[level];
+
+    return "?";
+}
+
+/* dst is the upper left corner of the area, w x h pixels. Like the DOS version only whole 4-pixel
+ * columns are drawn. img must come from rotozoomer_host_imgalloc() */
+void rotozoomer_host_effect(unsigned char *dst,unsigned int stride,unsigned int w,unsigned int h,const unsigned char *img,const uint32_t rt) {
+    struct rotozoom_host_step st;
+
+    if (rotozoomer_host_cur == NULL)
+        rotozoomer_host_select(rotozoomer_host_best());
+
+    rotozoomer_host_step(&st,w,h,rt);
+    rotozoomer_host_cur(dst,stride,w,h,img,&st);
+}
+
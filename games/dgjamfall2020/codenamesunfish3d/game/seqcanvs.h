@@ -44,6 +44,7 @@ enum {
 
 union seqcanvas_layeru_t;
 struct seqcanvas_layer_t;
+struct seqanim_t;
 
 struct seqcanvas_anim_t {
     void                (*anim_callback)(struct seqanim_t *sa,struct seqcanvas_layer_t *ca);
@@ -68,6 +69,9 @@ struct seqcanvas_memsetfill {
 
 struct seqcanvas_rotozoom {
     unsigned                        imgseg;             /* segment containing 256x256 image to rotozoom */
+#if defined(LINUX)
+    const unsigned char*            img;                /* host renderer (seqchost.c): 256x256 image from rotozoomer_host_imgalloc() */
+#endif
     uint32_t                        time_base;          /* counter time base to rotozoom by or (~0ul) if not to automatically rotozoom */
     unsigned int                    h;                  /* how many scanlines */
 };
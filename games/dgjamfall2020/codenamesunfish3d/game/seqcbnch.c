@@ -0,0 +1,329 @@
+
+/* seqanim canvas host renderer benchmark and golden frame test.
+ *
+ * WARNING: For host systems only, not for DOS. See makefile.
+ *
+ * Draws a cutscene-like layer stack (fill, rotozoomer, sorcerer and Mr. Woo VRLs, a line of text
+ * and a bitblt) with every rotozoomer level, checks the frames against seqcgold.txt or each other,
+ * then prints the time spent per layer type. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <hw/vga/vrl1host.h>
+
+#include "vrlimg.h"
+#include "fontbmp.h"
+#include "sin2048.h"
+#include "sorcpack.h"
+#include "rotozoom.h"
+#include "seqcanvs.h"
+#include "seqchost.h"
+
+#define BENCH_FRAMES        240         /* golden frames: every 30th of these */
+#define BENCH_GOLD_EVERY    30
+#define BENCH_TIME_FRAMES   3000
+
+#define BENCH_SORC_FRAMES   9
+#define BENCH_GMCH_FRAMES   4
+
+enum {
+    BL_FILL=0,
+    BL_ROTOZOOM,
+    BL_SORC,
+    BL_GMCH,
+    BL_TEXT,
+    BL_BITBLT,
+    BL_MAX
+};
+
+static struct vrl_image sorc_vrl[BENCH_SORC_FRAMES];
+static struct vrl_image gmch_vrl[BENCH_GMCH_FRAMES];
+static unsigned char *rotozoom_img = NULL;
+static struct font_bmp *font = NULL;
+
+/* the game loads these with seq_com_load_vrl_from_dumbpack(), which needs VGA for the palette */
+static int load_pack_vrl(struct vrl_image *img,const char *name) {
+    unsigned char *buffer;
+    uint32_t sz;
+    int x;
+
+    memset(img,0,sizeof(*img));
+    if ((x=dumbpack_lookup(sorc_pack,name)) < 0) return -1;
+    if ((sz=dumbpack_ent_size(sorc_pack,(unsigned int)x)) < sizeof(struct vrl1_vgax_header)) return -1;
+    if ((buffer=malloc(sz)) == NULL) return -1;
+    if (dumbpack_ent_read(sorc_pack,(unsigned int)x,buffer,sz)) goto fail;
+
+    img->vrl_header = (struct vrl1_vgax_header*)buffer;
+    if (memcmp(img->vrl_header->vrl_sig,"VRL1",4) || memcmp(img->vrl_header->fmt_sig,"VGAX",4)) goto fail;
+    img->vrl_lineoffs = vrl1_host_genlineoffsets(img->vrl_header,buffer+sizeof(*(img->vrl_header)),sz-sizeof(*(img->vrl_header)));
+    if (img->vrl_lineoffs == NULL) goto fail;
+    img->buffer = buffer;
+    img->bufsz = sz;
+    return 0;
+fail:
+    free(buffer);
+    img->vrl_header = NULL;
+    return -1;
+}
+
+static void free_pack_vrl(struct vrl_image *img) {
+    if (img->vrl_lineoffs != NULL) free(img->vrl_lineoffs);
+    if (img->buffer != NULL) free(img->buffer);
+    memset(img,0,sizeof(*img));
+}
+
+static int load_assets(void) {
+    char tmp[32];
+    unsigned int i;
+
+    if (sin2048fps16_open()) {
+        fprintf(stderr,"Cannot load sin table from sorcwoo.vrp\n");
+        return -1;
+    }
+
+    for (i=0;i < BENCH_SORC_FRAMES;i++) {
+        sprintf(tmp,"sorcwoo%u.vrl",i+1u);
+        if (load_pack_vrl(&sorc_vrl[i],tmp)) {
+            fprintf(stderr,"Cannot load %s\n",tmp);
+            return -1;
+        }
+    }
+    for (i=0;i < BENCH_GMCH_FRAMES;i++) {
+        sprintf(tmp,"gmch%u.vrl",i+1u);
+        if (load_pack_vrl(&gmch_vrl[i],tmp)) {
+            fprintf(stderr,"Cannot load %s\n",tmp);
+            return -1;
+        }
+    }
+
+    if ((rotozoom_img=rotozoomer_host_imgalloc()) == NULL)
+        return -1;
+    if (rotozoomer_host_pngload(rotozoom_img,"../devasset/atomicplayboy-256x256.png",NULL,0)) {
+        fprintf(stderr,"Cannot load rotozoomer image\n");
+        return -1;
+    }
+
+    if ((font=font_bmp_load("../devasset/arialfont/arialmed_final.png")) == NULL) {
+        fprintf(stderr,"Cannot load font\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void free_assets(void) {
+    unsigned int i;
+
+    for (i=0;i < BENCH_SORC_FRAMES;i++) free_pack_vrl(&sorc_vrl[i]);
+    for (i=0;i < BENCH_GMCH_FRAMES;i++) free_pack_vrl(&gmch_vrl[i]);
+    rotozoomer_host_imgfree(&rotozoom_img);
+    font_bmp_free(&font);
+    sin2048fps16_free();
+    dumbpack_close(&sorc_pack);
+}
+
+static int scene_init(struct seqanim_t *sa) {
+    static const char msg[] = "Wooooooooo! Hello there!";
+    struct seqcanvas_layer_t *cl;
+    unsigned int i;
+
+    memset(sa,0,sizeof(*sa));
+    sa->canvas_obj_alloc = sa->canvas_obj_count = BL_MAX;
+    if ((sa->canvas_obj=calloc(BL_MAX,sizeof(struct seqcanvas_layer_t))) == NULL)
+        return -1;
+
+    cl = &(sa->canvas_obj[BL_FILL]);
+    cl->what = SEQCL_MSETFILL;
+    cl->rop.msetfill.h = 200;
+    cl->rop.msetfill.c = 0x00;
+
+    cl = &(sa->canvas_obj[BL_ROTOZOOM]);
+    cl->what = SEQCL_ROTOZOOM;
+    cl->rop.rotozoom.img = rotozoom_img;
+    cl->rop.rotozoom.time_base = 0;
+    cl->rop.rotozoom.h = 168;
+
+    cl = &(sa->canvas_obj[BL_SORC]);
+    cl->what = SEQCL_VRL;
+
+    cl = &(sa->canvas_obj[BL_GMCH]);
+    cl->what = SEQCL_VRL;
+    cl->rop.vrl.anim.flags = SEQANF_HFLIP;
+
+    cl = &(sa->canvas_obj[BL_TEXT]);
+    cl->what = SEQCL_TEXT;
+    cl->rop.text.font = font;
+    cl->rop.text.x = 8;
+    cl->rop.text.y = 172;
+    cl->rop.text.color = 0xFF;
+    cl->rop.text.textcdef_length = sizeof(msg) - 1u;
+    if ((cl->rop.text.textcdef=malloc(sizeof(uint16_t) * cl->rop.text.textcdef_length)) == NULL)
+        return -1;
+    for (i=0;i < cl->rop.text.textcdef_length;i++)
+        cl->rop.text.textcdef[i] = (uint16_t)font_bmp_unicode_to_chardef(font,(unsigned char)msg[i]);
+
+    /* copy the top 8 rows of the page to the bottom, as if from an offscreen strip */
+    cl = &(sa->canvas_obj[BL_BITBLT]);
+    cl->what = SEQCL_BITBLT;
+    cl->rop.bitblt.src = 0;
+    cl->rop.bitblt.dst = 192u * 80u;
+    cl->rop.bitblt.length = 80u;
+    cl->rop.bitblt.src_step = 80u;
+    cl->rop.bitblt.dst_step = 80u;
+    cl->rop.bitblt.rows = 8u;
+
+    return 0;
+}
+
+static void scene_free(struct seqanim_t *sa) {
+    if (sa->canvas_obj != NULL) {
+        if (sa->canvas_obj[BL_TEXT].rop.text.textcdef != NULL)
+            free(sa->canvas_obj[BL_TEXT].rop.text.textcdef);
+        free(sa->canvas_obj);
+        sa->canvas_obj = NULL;
+    }
+}
+
+/* 60 frames per second of the 120Hz sequence timer. The sprites walk and animate */
+static void scene_frame(struct seqanim_t *sa,const unsigned int f) {
+    struct seqcanvas_layer_t *cl;
+
+    sa->current_time = f * 2u;
+
+    cl = &(sa->canvas_obj[BL_SORC]);
+    cl->rop.vrl.vrl = &sorc_vrl[(f / 4u) % BENCH_SORC_FRAMES];
+    cl->rop.vrl.x = 20u + (f % 160u);
+    cl->rop.vrl.y = 30u;
+
+    cl = &(sa->canvas_obj[BL_GMCH]);
+    cl->rop.vrl.vrl = &gmch_vrl[(f / 8u) % BENCH_GMCH_FRAMES];
+    cl->rop.vrl.x = 300u - (f % 200u);
+    cl->rop.vrl.y = 60u;
+}
+
+static uint32_t frame_crc(struct seqchost_fb *fb) {
+    return (uint32_t)crc32(0L,seqchost_fb_page(fb),SEQCHOST_WIDTH * SEQCHOST_HEIGHT);
+}
+
+/* crc[] gets BENCH_FRAMES / BENCH_GOLD_EVERY values */
+static int render_gold(struct seqanim_t *sa,struct seqchost_fb *fb,uint32_t *crc) {
+    unsigned int f;
+
+    memset(fb->vram,0,SEQCHOST_VRAM_SIZE);
+    for (f=0;f < BENCH_FRAMES;f++) {
+        scene_frame(sa,f);
+        seqchost_draw(sa,fb);
+        if ((f % BENCH_GOLD_EVERY) == 0u)
+            crc[f / BENCH_GOLD_EVERY] = frame_crc(fb);
+    }
+
+    return 0;
+}
+
+static int load_gold(const char *path,uint32_t *crc) {
+    unsigned int f,n = 0;
+    char line[128];
+    unsigned long c;
+    FILE *fp;
+
+    if ((fp=fopen(path,"r")) == NULL)
+        return -1;
+
+    while (fgets(line,sizeof(line),fp) != NULL) {
+        if (line[0] == '#') continue;
+        if (sscanf(line,"frame %u %lx",&f,&c) != 2) continue;
+        if ((f % BENCH_GOLD_EVERY) != 0u || f >= BENCH_FRAMES) continue;
+        crc[f / BENCH_GOLD_EVERY] = (uint32_t)c;
+        n++;
+    }
+
+    fclose(fp);
+    return (n == (BENCH_FRAMES / BENCH_GOLD_EVERY)) ? 0 : -1;
+}
+
+int main(int argc,char **argv) {
+    uint32_t gold[BENCH_FRAMES / BENCH_GOLD_EVERY],crc[BENCH_FRAMES / BENCH_GOLD_EVERY];
+    const char *gold_path = NULL;
+    struct seqchost_fb fb;
+    struct seqanim_t sa;
+    unsigned int level,i,f;
+    int mkgold = 0,test = 0,r = 0;
+
+    for (i=1;i < (unsigned int)argc;i++) {
+        if (!strcmp(argv[i],"-mkgold")) {
+            mkgold = 1;
+        }
+        else if (!strcmp(argv[i],"-test") && (i+1u) < (unsigned int)argc) {
+            test = 1;
+            gold_path = argv[++i];
+        }
+        else {
+            fprintf(stderr,"seqcbnch [-mkgold | -test seqcgold.txt]\n");
+            return 1;
+        }
+    }
+
+    if (load_assets() || seqchost_fb_init(&fb) || scene_init(&sa)) {
+        free_assets();
+        return 1;
+    }
+
+    /* the reference level is the DOS asm loop as written, the golden frames come from it */
+    rotozoomer_host_select(ROTOZOOM_HOST_REF);
+    render_gold(&sa,&fb,gold);
+
+    if (mkgold) {
+        printf("# golden CRC-32 of seqcbnch frames (320x200 page, every %uth of %u frames)\n",BENCH_GOLD_EVERY,BENCH_FRAMES);
+        printf("# regenerate with: ./seqcbnch -mkgold > seqcgold.txt\n");
+        for (i=0;i < (BENCH_FRAMES / BENCH_GOLD_EVERY);i++)
+            printf("frame %u %08lx\n",i * BENCH_GOLD_EVERY,(unsigned long)gold[i]);
+        goto done;
+    }
+
+    if (test && load_gold(gold_path,gold)) {
+        fprintf(stderr,"Cannot read %s\n",gold_path);
+        r = 1;
+        goto done;
+    }
+
+    for (level=0;level < ROTOZOOM_HOST_MAX;level++) {
+        if (!rotozoomer_host_select(level)) continue;
+
+        render_gold(&sa,&fb,crc);
+        for (i=0;i < (BENCH_FRAMES / BENCH_GOLD_EVERY);i++) {
+            if (crc[i] != gold[i]) {
+                fprintf(stderr,"rotozoomer %s: frame %u is %08lx, expected %08lx\n",rotozoomer_host_name(level),
+                    i * BENCH_GOLD_EVERY,(unsigned long)crc[i],(unsigned long)gold[i]);
+                r = 1;
+            }
+        }
+    }
+
+    if (r != 0) goto done;
+    printf("All rotozoomer levels match the %s frames\n",test ? "golden" : "reference");
+    if (test) goto done;
+
+    for (level=0;level < ROTOZOOM_HOST_MAX;level++) {
+        if (!rotozoomer_host_select(level)) continue;
+
+        seqchost_prof_reset(&fb);
+        for (f=0;f < BENCH_TIME_FRAMES;f++) {
+            scene_frame(&sa,f);
+            seqchost_draw(&sa,&fb);
+        }
+
+        printf("\nrotozoomer %s, %u frames:\n",rotozoomer_host_name(level),BENCH_TIME_FRAMES);
+        seqchost_prof_print(stdout,&fb);
+    }
+
+done:
+    scene_free(&sa);
+    seqchost_fb_free(&fb);
+    free_assets();
+    return r;
+}
+
@@ -0,0 +1,256 @@
+
+/* WARNING: For host systems only, not for DOS. See seqchost.h */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <hw/vga/vrl1host.h>
+
+#include "vrlimg.h"
+#include "fontbmp.h"
+#include "rotozoom.h"
+#include "seqcanvs.h"
+#include "seqchost.h"
+
+struct seqchost_fb *seqchost_cur_fb = NULL;
+
+static const char *seqchost_layer_names[SEQCL_MAX] = {
+    "none",
+    "msetfill",
+    "rotozoom",
+    "vrl",
+    "callback",
+    "text",
+    "bitblt"
+};
+
+static uint64_t seqchost_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+int seqchost_fb_init(struct seqchost_fb *fb) {
+    memset(fb,0,sizeof(*fb));
+    if ((fb->vram=calloc(1,SEQCHOST_VRAM_SIZE)) == NULL)
+        return -1;
+
+    return 0;
+}
+
+void seqchost_fb_free(struct seqchost_fb *fb) {
+    if (fb->vram != NULL) {
+        free(fb->vram);
+        fb->vram = NULL;
+    }
+}
+
+unsigned char *seqchost_fb_page(struct seqchost_fb *fb) {
+    return fb->vram + ((unsigned long)fb->page * 4ul);
+}
+
+void seqchost_prof_reset(struct seqchost_fb *fb) {
+    memset(&(fb->prof),0,sizeof(fb->prof));
+}
+
+void seqchost_prof_print(FILE *fp,const struct seqchost_fb *fb) {
+    const unsigned long frames = fb->prof.frames != 0ul ? fb->prof.frames : 1ul;
+    uint64_t total = 0;
+    unsigned int i;
+
+    fprintf(fp,"%-10s %10s %12s %12s\n","layer","calls","us/call","us/frame");
+    for (i=SEQCL_NONE+1u;i < SEQCL_MAX;i++) {
+        if (fb->prof.calls[i] == 0ul) continue;
+        total += fb->prof.ns[i];
+        fprintf(fp,"%-10s %10lu %12.2f %12.2f\n",seqchost_layer_names[i],fb->prof.calls[i],
+            (double)fb->prof.ns[i] / (1000.0 * (double)fb->prof.calls[i]),
+            (double)fb->prof.ns[i] / (1000.0 * (double)frames));
+    }
+    fprintf(fp,"%-10s %10lu %12s %12.2f\n","total",fb->prof.frames,"",(double)total / (1000.0 * (double)frames));
+}
+
+/* font_bmp_draw_chardef_vga8u() into the linear page. Like the VGA version it does not clip,
+ * x past the right edge lands on the next row the way it would in VGA RAM */
+unsigned int seqchost_draw_chardef(struct seqchost_fb *fb,struct font_bmp *fnt,unsigned int cdef,unsigned int x,unsigned int y,unsigned char color) {
+    unsigned int nx = x;
+
+    if (fnt != NULL) {
+        if (fnt->chardef != NULL && cdef < fnt->chardef_count) {
+            const struct font_bmp_chardef *cdent = fnt->chardef + cdef;
+            x += (unsigned int)((int)cdent->xoffset);
+            y += (unsigned int)((int)cdent->yoffset);
+            nx += (unsigned int)((int)cdent->xadvance);
+            if (x < 640 && y < 400) {
+                const unsigned long dofs = ((unsigned long)fb->page * 4ul) + (y * SEQCHOST_WIDTH) + x;
+                const unsigned char *sp = fnt->fontbmp + (fnt->stride * cdent->y) + (cdent->x >> 3u);
+                unsigned char sm = 0x80u >> (cdent->x & 7u);
+                unsigned int sw = cdent->w,c = 0;
+
+                /* whole glyph inside emulated VRAM, or nothing */
+                if ((dofs + (cdent->h * SEQCHOST_WIDTH) + cdent->w) > SEQCHOST_VRAM_SIZE)
+                    return nx;
+
+                while (sw-- > 0) {
+                    unsigned int sh = cdent->h;
+                    const unsigned char *rsp = sp;
+                    unsigned char *rdp = fb->vram + dofs + c;
+
+                    while (sh-- > 0) {
+                        if ((*rsp) & sm) *rdp = color;
+                        rsp += fnt->stride;
+                        rdp += SEQCHOST_WIDTH;
+                    }
+
+                    c++;
+                    if ((sm >>= 1u) == 0) {
+                        sm = 0x80;
+                        sp++;
+                    }
+                }
+            }
+        }
+    }
+
+    return nx;
+}
+
+static void seqchost_draw_msetfill(struct seqanim_t *sa,struct seqcanvas_layer_t *cl,struct seqchost_fb *fb) {
+    (void)sa;
+
+    if (cl->rop.msetfill.h != 0) {
+        unsigned int h = cl->rop.msetfill.h;
+
+        if (h > SEQCHOST_HEIGHT) h = SEQCHOST_HEIGHT;
+        memset(seqchost_fb_page(fb),cl->rop.msetfill.c,h * SEQCHOST_WIDTH);
+    }
+}
+
+static void seqchost_draw_text(struct seqanim_t *sa,struct seqcanvas_layer_t *cl,struct seqchost_fb *fb) {
+    (void)sa;
+
+    if (cl->rop.text.textcdef != NULL && cl->rop.text.font != NULL) {
+        int x = cl->rop.text.x,y = cl->rop.text.y;
+        unsigned int i;
+
+        for (i=0;i < cl->rop.text.textcdef_length;i++)
+            x = seqchost_draw_chardef(fb,cl->rop.text.font,cl->rop.text.textcdef[i],x,y,cl->rop.text.color);
+    }
+}
+
+static void seqchost_draw_rotozoom(struct seqanim_t *sa,struct seqcanvas_layer_t *cl,struct seqchost_fb *fb) {
+    if (cl->rop.rotozoom.img != NULL && cl->rop.rotozoom.h != 0) {
+        unsigned int h = cl->rop.rotozoom.h;
+
+        if (h > SEQCHOST_HEIGHT) h = SEQCHOST_HEIGHT;
+        rotozoomer_host_effect(seqchost_fb_page(fb),SEQCHOST_WIDTH,SEQCHOST_WIDTH/*width*/,h/*height*/,cl->rop.rotozoom.img,sa->current_time - cl->rop.rotozoom.time_base);
+
+        /* unless time_base == (~0ul) rotozoomer always redraws. uint32_t, unsigned long is wider here */
+        if (cl->rop.rotozoom.time_base != (uint32_t)(~0ul))
+            sa->flags |= SEQAF_REDRAW;
+    }
+}
+
+static void seqchost_draw_vrl(struct seqanim_t *sa,struct seqcanvas_layer_t *cl,struct seqchost_fb *fb) {
+    (void)sa;
+
+    if (cl->rop.vrl.vrl != NULL) {
+        struct vrl_image *vrl = cl->rop.vrl.vrl;
+        struct vrl1_host_fb vfb;
+
+        memset(&vfb,0,sizeof(vfb));
+        vfb.mem = seqchost_fb_page(fb);
+        vfb.width = SEQCHOST_WIDTH;
+        vfb.height = SEQCHOST_HEIGHT;
+        vfb.stride = SEQCHOST_WIDTH;
+
+        if (cl->rop.vrl.anim.flags & SEQANF_HFLIP) {
+            vrl1_host_draw_hflip(&vfb,cl->rop.vrl.x,cl->rop.vrl.y,
+                vrl->vrl_header,
+                vrl->vrl_lineoffs,
+                vrl->buffer+sizeof(*(vrl->vrl_header)),
+                vrl->bufsz-sizeof(*(vrl->vrl_header)));
+        }
+        else {
+            vrl1_host_draw(&vfb,cl->rop.vrl.x,cl->rop.vrl.y,
+                vrl->vrl_header,
+                vrl->vrl_lineoffs,
+                vrl->buffer+sizeof(*(vrl->vrl_header)),
+                vrl->bufsz-sizeof(*(vrl->vrl_header)));
+        }
+    }
+}
+
+/* vga_wm1_mem_block_copy() 4 pixels per planar byte. src is from the start of VRAM, dst from the page.
+ * Offsets wrap at 64KB like they do in the 0xA000 segment */
+static void seqchost_draw_bitblt(struct seqanim_t *sa,struct seqcanvas_layer_t *cl,struct seqchost_fb *fb) {
+    const uint16_t sst = cl->rop.bitblt.src_step;
+    const uint16_t dst = cl->rop.bitblt.dst_step;
+    const unsigned long len = (unsigned long)cl->rop.bitblt.length * 4ul;
+    uint16_t rc = cl->rop.bitblt.rows;
+    uint16_t s = cl->rop.bitblt.src;
+    uint16_t d = cl->rop.bitblt.dst + fb->page;
+
+    (void)sa;
+
+    while (rc-- != 0u) {
+        const unsigned long so = (unsigned long)s * 4ul,dof = (unsigned long)d * 4ul;
+
+        if ((so + len) <= SEQCHOST_VRAM_SIZE && (dof + len) <= SEQCHOST_VRAM_SIZE)
+            memmove(fb->vram + dof,fb->vram + so,len);
+
+        s += sst;
+        d += dst;
+    }
+}
+
+void seqchost_draw(struct seqanim_t *sa,struct seqchost_fb *fb) {
+    struct seqcanvas_layer_t *cl;
+    uint64_t t0;
+    unsigned int i;
+
+    sa->flags &= ~SEQAF_REDRAW;
+    seqchost_cur_fb = fb;
+
+    if (sa->canvas_obj != NULL) {
+        for (i=0;i < sa->canvas_obj_count;i++) {
+            cl = &(sa->canvas_obj[i]);
+            if (cl->what == SEQCL_NONE || cl->what >= SEQCL_MAX)
+                continue;
+
+            t0 = seqchost_time_ns();
+            switch (cl->what) {
+                case SEQCL_MSETFILL:
+                    seqchost_draw_msetfill(sa,cl,fb);
+                    break;
+                case SEQCL_ROTOZOOM:
+                    seqchost_draw_rotozoom(sa,cl,fb);
+                    break;
+                case SEQCL_VRL:
+                    seqchost_draw_vrl(sa,cl,fb);
+                    break;
+                case SEQCL_CALLBACK:
+                    if (cl->rop.callback.fn != NULL)
+                        cl->rop.callback.fn(sa,cl);
+                    break;
+                case SEQCL_TEXT:
+                    seqchost_draw_text(sa,cl,fb);
+                    break;
+                case SEQCL_BITBLT:
+                    seqchost_draw_bitblt(sa,cl,fb);
+                    break;
+                default:
+                    break;
+            }
+
+            fb->prof.ns[cl->what] += seqchost_time_ns() - t0;
+            fb->prof.calls[cl->what]++;
+        }
+    }
+
+    fb->prof.frames++;
+    seqchost_cur_fb = NULL;
+}
+
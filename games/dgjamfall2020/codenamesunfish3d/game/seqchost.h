@@ -0,0 +1,38 @@
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Host (Linux) renderer for the seqanim canvas (see seqanim_draw() in seqcanvs.c). Draws the
+ * same layers into memory instead of VGA RAM, with a time counter per kind of layer.
+ *
+ * VGA RAM is emulated linearly. A planar byte offset as used by unchained 256-color mode
+ * (vga_state.vga_graphics_ram, struct seqcanvas_bitblt) holds pixels (offset*4) to (offset*4)+3,
+ * so a 320x200 page is plain 8bpp with a stride of 320 and BITBLT layers work as they do on VGA. */
+
+#define SEQCHOST_VRAM_SIZE          (0x10000ul * 4ul)
+#define SEQCHOST_WIDTH              320u
+#define SEQCHOST_HEIGHT             200u
+
+struct seqchost_prof {
+    uint64_t                        ns[SEQCL_MAX];      /* time spent drawing, per layer type */
+    unsigned long                   calls[SEQCL_MAX];
+    unsigned long                   frames;             /* seqchost_draw() calls */
+};
+
+struct seqchost_fb {
+    unsigned char*                  vram;               /* SEQCHOST_VRAM_SIZE bytes */
+    uint16_t                        page;               /* planar offset of the page drawn to, like FP_OFF(vga_state.vga_graphics_ram) */
+    struct seqchost_prof            prof;
+};
+
+/* the fb being drawn by seqchost_draw(), for SEQCL_CALLBACK layers */
+extern struct seqchost_fb*          seqchost_cur_fb;
+
+int seqchost_fb_init(struct seqchost_fb *fb);
+void seqchost_fb_free(struct seqchost_fb *fb);
+unsigned char *seqchost_fb_page(struct seqchost_fb *fb);
+void seqchost_prof_reset(struct seqchost_fb *fb);
+void seqchost_prof_print(FILE *fp,const struct seqchost_fb *fb);
+unsigned int seqchost_draw_chardef(struct seqchost_fb *fb,struct font_bmp *fnt,unsigned int cdef,unsigned int x,unsigned int y,unsigned char color);
+void seqchost_draw(struct seqanim_t *sa,struct seqchost_fb *fb);
+
@@ -152,18 +152,12 @@ void seq_com_put_rotozoom(struct seqanim_t *sa,const struct seqanim_event_t *ev)
 }
 
 void seq_com_init_mr_woo(struct seqanim_t *sa,const struct seqanim_event_t *ev) {
-    uint32_t ofs;
-
     (void)sa;
     (void)ev;
 
     if (sorc_pack_open())
         fatal("mr_woo_init");
-    if ((ofs=dumbpack_ent_offset(sorc_pack,0)) == 0ul)
-        fatal("mr_woo_init");
-    if (lseek(sorc_pack->fd,ofs,SEEK_SET) != ofs)
-        fatal("mr_woo_init");
-    if (read(sorc_pack->fd,common_tmp_small,32*3) != (32*3)) // 32 colors
+    if (dumbpack_ent_read(sorc_pack,0,common_tmp_small,32*3)) // 32 colors
         fatal("mr_woo_init");
 
     pal_buf_to_vga(/*offset*/SORC_PAL_OFFSET,/*count*/32,common_tmp_small);
@@ -172,18 +166,24 @@ void seq_com_init_mr_woo(struct seqanim_t *sa,const struct seqanim_event_t *ev)
 }
 
 int seq_com_load_vrl_from_dumbpack(const unsigned vrl_slot,struct dumbpack * const pack,const unsigned packoff,const unsigned char paloff) {
-    uint32_t ofs,sz;
+    unsigned char *buffer;
+    uint32_t sz;
 
     if (vrl_slot >= MAX_VRLIMG)
         fatal("load_vrl_slot out of range");
 
-    if ((ofs=dumbpack_ent_offset(pack,packoff)) == 0ul)
-        return 1;
+    /* entries may be compressed (dumbpack.pl -z), read through dumbpack not the file handle */
     if ((sz=dumbpack_ent_size(pack,packoff)) == 0ul)
         return 1;
-    if (lseek(pack->fd,ofs,SEEK_SET) != ofs)
+    if (sz >= 65535UL)
+        return 1;
+    if ((buffer=malloc((unsigned int)sz)) == NULL)
         return 1;
-    if (load_vrl_fd(&(seq_com_vrl_image[vrl_slot].vrl),pack->fd,sz) != 0)
+    if (dumbpack_ent_read(pack,packoff,buffer,sz)) {
+        free(buffer);
+        return 1;
+    }
+    if (load_vrl_mem(&(seq_com_vrl_image[vrl_slot].vrl),buffer,sz) != 0) /* frees buffer on failure */
         return 1;
 
     vrl_palrebase(
@@ -196,18 +196,14 @@ int seq_com_load_vrl_from_dumbpack(const unsigned vrl_slot,struct dumbpack * con
 }
 
 int seq_com_load_pal_from_dumbpack(const unsigned char pal,struct dumbpack * const pack,const unsigned packoff) {
-    uint32_t ofs,sz;
+    uint32_t sz;
     unsigned int i;
 
-    if ((ofs=dumbpack_ent_offset(pack,packoff)) == 0ul)
-        return 1;
     if ((sz=dumbpack_ent_size(pack,packoff)) == 0ul)
         return 1;
-    if (lseek(pack->fd,ofs,SEEK_SET) != ofs)
-        return 1;
     if (sz > sizeof(common_tmp_small))
         return 1;
-    if (read(pack->fd,common_tmp_small,sz) != sz)
+    if (dumbpack_ent_read(pack,packoff,common_tmp_small,sz))
         return 1;
 
     sz /= 3;
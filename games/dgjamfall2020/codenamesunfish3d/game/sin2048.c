@@ -1,4 +1,12 @@
 
+#if defined(LINUX)
+/* host build, see makefile */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sin2048.h"
+#include "sorcpack.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
@@ -31,6 +39,7 @@
 #include "fzlibdec.h"
 #include "fataexit.h"
 #include "sorcpack.h"
+#endif
 
 uint16_t *sin2048fps16_table = NULL;         // 2048-sample sin(x) quarter wave lookup table (0....0x7FFF)
 
@@ -65,19 +74,18 @@ void sin2048fps16_free(void) {
 int sin2048fps16_open(void) {
     if (sin2048fps16_table == NULL) {
         if (sorc_pack_open() == 0) {
-            uint32_t ofs = dumbpack_ent_offset(sorc_pack,1);
             uint32_t sz = dumbpack_ent_size(sorc_pack,1);
 
-            if (ofs == 0ul || sz < (sizeof(uint16_t) * 2048))
-                return -1;
-
-            if (lseek(sorc_pack->fd,ofs,SEEK_SET) != ofs)
+            if (sz < (sizeof(uint16_t) * 2048))
                 return -1;
 
             if ((sin2048fps16_table=malloc(sizeof(uint16_t) * 2048)) == NULL)
                 return -1;
 
-            read(sorc_pack->fd,sin2048fps16_table,sizeof(uint16_t) * 2048);
+            if (dumbpack_ent_read(sorc_pack,1,(unsigned char*)sin2048fps16_table,sizeof(uint16_t) * 2048)) {
+                sin2048fps16_free();
+                return -1;
+            }
         }
         else {
             return -1;
@@ -1,4 +1,12 @@
 
+#if defined(LINUX)
+/* host build, see makefile */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dumbpack.h"
+#include "sorcpack.h"
+#else
 #include <stdio.h>
 #include <conio.h> /* this is where Open Watcom hides the outp() etc. functions */
 #include <ctype.h>
@@ -32,6 +40,7 @@
 #include "fzlibdec.h"
 #include "fataexit.h"
 #include "sorcpack.h"
+#endif
 
 struct dumbpack *sorc_pack = NULL;
 
@@ -25,10 +25,10 @@
 #include "unicode.h"
 #include "commtmp.h"
 
-int load_vrl_fd(struct vrl_image *img,int fd,unsigned long sz) {
+/* takes ownership of buffer (from malloc()), it is freed if the image is not valid */
+int load_vrl_mem(struct vrl_image *img,unsigned char *buffer,unsigned long sz) {
     struct vrl1_vgax_header *vrl_header;
     vrl1_vgax_offset_t *vrl_lineoffs;
-    unsigned char *buffer = NULL;
     unsigned int bufsz = 0;
 
     {
@@ -36,10 +36,6 @@ int load_vrl_fd(struct vrl_image *img,int fd,unsigned long sz) {
         if (sz >= 65535UL) goto fail;
 
         bufsz = (unsigned int)sz;
-        buffer = malloc(bufsz);
-        if (buffer == NULL) goto fail;
-
-        if ((unsigned int)read(fd,buffer,bufsz) < bufsz) goto fail;
 
         vrl_header = (struct vrl1_vgax_header*)buffer;
         if (memcmp(vrl_header->vrl_sig,"VRL1",4) || memcmp(vrl_header->fmt_sig,"VGAX",4)) goto fail;
@@ -61,3 +57,22 @@ fail:
     return 1;
 }
 
+int load_vrl_fd(struct vrl_image *img,int fd,unsigned long sz) {
+    unsigned char *buffer = NULL;
+    unsigned int bufsz = 0;
+
+    if (sz < sizeof(struct vrl1_vgax_header)) return 1;
+    if (sz >= 65535UL) return 1;
+
+    bufsz = (unsigned int)sz;
+    buffer = malloc(bufsz);
+    if (buffer == NULL) return 1;
+
+    if ((unsigned int)read(fd,buffer,bufsz) < bufsz) {
+        free(buffer);
+        return 1;
+    }
+
+    return load_vrl_mem(img,buffer,sz);
+}
+
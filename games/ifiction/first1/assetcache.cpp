@@ -0,0 +1,504 @@
+
+#if defined(USE_WIN32)
+# include <windows.h>
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(USE_SDL2)
+# if defined(__APPLE__) /* Brew got the headers wrong here */
+#  include <SDL.h>
+# else
+#  include <SDL2/SDL.h>
+# endif
+# define IFE_ASSET_THREAD
+#endif
+
+#include "ifict.h"
+#include "utils.h"
+#include "debug.h"
+#include "fatal.h"
+#include "bitmap.h"
+#include "assetcache.h"
+
+enum {
+	ASSET_QUEUED=0,
+	ASSET_LOADING,		/* being decoded, by the loader thread or IFEAssetGet() */
+	ASSET_READY,
+	ASSET_FAILED
+};
+
+#define ASSET_HASH_SIZE		64u
+
+struct IFEAsset {
+	IFEAsset*		lru_prev;	/* READY and FAILED images, most recently used first */
+	IFEAsset*		lru_next;
+	IFEAsset*		hash_next;
+	IFEAsset*		queue_next;
+	char*			path;
+	uint32_t		hash;
+	uint8_t			bias;
+	unsigned char		state;
+	unsigned int		refs;		/* IFEAssetGet() without IFEAssetRelease(), cannot be freed */
+	unsigned long		bytes;
+	IFEBitmap		bmp;
+
+	IFEAsset();
+	~IFEAsset();
+};
+
+IFEAsset::IFEAsset() : lru_prev(NULL), lru_next(NULL), hash_next(NULL), queue_next(NULL), path(NULL), hash(0), bias(0), state(ASSET_QUEUED), refs(0), bytes(0) {
+}
+
+IFEAsset::~IFEAsset() {
+	if (path != NULL) {
+		free(path);
+		path = NULL;
+	}
+}
+
+static IFEAsset*		asset_hash[ASSET_HASH_SIZE];
+static IFEAsset*		asset_lru_head = NULL;
+static IFEAsset*		asset_lru_tail = NULL;
+static IFEAsset*		asset_queue_head = NULL;
+static IFEAsset*		asset_queue_tail = NULL;
+static IFEAssetStats		asset_stats;
+static bool			asset_init = false;
+static IFEAssetLoadFunc*	asset_load = IFELoadPNG;
+
+#if defined(IFE_ASSET_THREAD)
+static SDL_mutex*		asset_mutex = NULL;
+static SDL_cond*		asset_work = NULL;	/* loader thread waits on this for the queue */
+static SDL_cond*		asset_done = NULL;	/* IFEAssetGet() waits on this for the loader thread */
+static SDL_Thread*		asset_thread = NULL;
+static bool			asset_quit = false;
+#endif
+
+static inline void asset_lock(void) {
+#if defined(IFE_ASSET_THREAD)
+	SDL_LockMutex(asset_mutex);
+#endif
+}
+
+static inline void asset_unlock(void) {
+#if defined(IFE_ASSET_THREAD)
+	SDL_UnlockMutex(asset_mutex);
+#endif
+}
+
+static uint32_t asset_hash_key(const char *path,const uint8_t bias) {
+	uint32_t h = 0x811C9DC5ul; /* FNV-1a */
+
+	while (*path != 0) {
+		h ^= (uint32_t)((unsigned char)(*path++));
+		h *= 0x01000193ul;
+	}
+
+	h ^= (uint32_t)bias;
+	h *= 0x01000193ul;
+	return h;
+}
+
+static IFEAsset *asset_find(const char *path,const uint8_t bias,const uint32_t hash) {
+	IFEAsset *a = asset_hash[hash % ASSET_HASH_SIZE];
+
+	while (a != NULL) {
+		if (a->hash == hash && a->bias == bias && !strcmp(a->path,path))
+			return a;
+
+		a = a->hash_next;
+	}
+
+	return NULL;
+}
+
+static IFEAsset *asset_new(const char *path,const uint8_t bias,const uint32_t hash) {
+	const size_t len = strlen(path);
+	IFEAsset *a = new IFEAsset();
+
+	if ((a->path=(char*)malloc(len + 1u)) == NULL) {
+		delete a;
+		return NULL;
+	}
+
+	memcpy(a->path,path,len + 1u);
+	a->hash = hash;
+	a->bias = bias;
+	a->hash_next = asset_hash[hash % ASSET_HASH_SIZE];
+	asset_hash[hash % ASSET_HASH_SIZE] = a;
+	asset_stats.count++;
+	return a;
+}
+
+static void asset_lru_unlink(IFEAsset *a) {
+	if (a->lru_prev != NULL) a->lru_prev->lru_next = a->lru_next;
+	else if (asset_lru_head == a) asset_lru_head = a->lru_next;
+	if (a->lru_next != NULL) a->lru_next->lru_prev = a->lru_prev;
+	else if (asset_lru_tail == a) asset_lru_tail = a->lru_prev;
+	a->lru_prev = a->lru_next = NULL;
+}
+
+static void asset_lru_front(IFEAsset *a) {
+	if (asset_lru_head == a) return;
+
+	asset_lru_unlink(a);
+	a->lru_next = asset_lru_head;
+	if (asset_lru_head != NULL) asset_lru_head->lru_prev = a;
+	asset_lru_head = a;
+	if (asset_lru_tail == NULL) asset_lru_tail = a;
+}
+
+static void asset_queue_push(IFEAsset *a) {
+	a->queue_next = NULL;
+	if (asset_queue_tail != NULL) asset_queue_tail->queue_next = a;
+	else asset_queue_head = a;
+	asset_queue_tail = a;
+}
+
+static IFEAsset *asset_queue_pop(void) {
+	IFEAsset *a = asset_queue_head;
+
+	if (a != NULL) {
+		asset_queue_head = a->queue_next;
+		if (asset_queue_head == NULL) asset_queue_tail = NULL;
+		a->queue_next = NULL;
+	}
+
+	return a;
+}
+
+static void asset_queue_remove(IFEAsset *a) {
+	IFEAsset *p = NULL,*s = asset_queue_head;
+
+	while (s != NULL && s != a) {
+		p = s;
+		s = s->queue_next;
+	}
+
+	if (s == NULL) return;
+
+	if (p != NULL) p->queue_next = a->queue_next;
+	else asset_queue_head = a->queue_next;
+	if (asset_queue_tail == a) asset_queue_tail = p;
+	a->queue_next = NULL;
+}
+
+/* caller must make sure it is not queued or being decoded */
+static void asset_free(IFEAsset *a) {
+	IFEAsset **pp = &asset_hash[a->hash % ASSET_HASH_SIZE];
+
+	while (*pp != NULL && *pp != a)
+		pp = &((*pp)->hash_next);
+	if (*pp != NULL)
+		*pp = a->hash_next;
+
+	asset_lru_unlink(a);
+	asset_stats.bytes -= a->bytes;
+	asset_stats.count--;
+	delete a;
+}
+
+/* the most recently used image is never evicted, or an image that was just prefetched would be
+ * thrown away again while the ones in use take up the whole cache */
+static void asset_evict(void) {
+	IFEAsset *a = asset_lru_tail,*p;
+
+	while (asset_stats.bytes > asset_stats.max_bytes && a != NULL && a != asset_lru_head) {
+		p = a->lru_prev;
+		if (a->refs == 0) {
+			asset_free(a);
+			asset_stats.evictions++;
+		}
+		a = p;
+	}
+}
+
+/* called without the lock, the entry is ASSET_LOADING and nobody else touches it */
+static bool asset_decode(IFEAsset *a) {
+	if (!asset_load(a->bmp,a->path))
+		return false;
+	if (a->bias != 0 && !a->bmp.bias_subrect(a->bmp.get_subrect(0),a->bias))
+		return false;
+
+	/* the blitter would do this the first time it draws the image, do it here instead */
+	a->bmp.get_opaque_spans();
+	return true;
+}
+
+static void asset_finish(IFEAsset *a,const bool ok) {
+	if (ok) {
+		a->state = ASSET_READY;
+		a->bytes = (unsigned long)a->bmp.alloc;
+		asset_stats.bytes += a->bytes;
+	}
+	else {
+		a->state = ASSET_FAILED;
+		a->bmp.free_storage();
+	}
+
+	asset_lru_front(a);
+	asset_evict();
+
+#if defined(IFE_ASSET_THREAD)
+	SDL_CondBroadcast(asset_done);
+#endif
+}
+
+#if defined(IFE_ASSET_THREAD)
+static int asset_thread_proc(void *arg) {
+	IFEAsset *a;
+	bool ok;
+
+	(void)arg;
+
+	SDL_LockMutex(asset_mutex);
+	while (!asset_quit) {
+		if ((a=asset_queue_pop()) == NULL) {
+			SDL_CondWait(asset_work,asset_mutex);
+			continue;
+		}
+
+		a->state = ASSET_LOADING;
+		SDL_UnlockMutex(asset_mutex);
+		ok = asset_decode(a);
+		SDL_LockMutex(asset_mutex);
+		asset_finish(a,ok);
+	}
+	SDL_UnlockMutex(asset_mutex);
+
+	return 0;
+}
+#endif
+
+bool IFEAssetInit(const unsigned long max_bytes,IFEAssetLoadFunc *load) {
+	if (asset_init)
+		return true;
+
+	asset_load = load;
+	memset(asset_hash,0,sizeof(asset_hash));
+	memset(&asset_stats,0,sizeof(asset_stats));
+	asset_stats.max_bytes = max_bytes;
+
+#if defined(IFE_ASSET_THREAD)
+	asset_quit = false;
+	if ((asset_mutex=SDL_CreateMutex()) == NULL)
+		return false;
+	if ((asset_work=SDL_CreateCond()) == NULL || (asset_done=SDL_CreateCond()) == NULL) {
+		if (asset_work != NULL) SDL_DestroyCond(asset_work);
+		SDL_DestroyMutex(asset_mutex);
+		asset_work = NULL;
+		asset_mutex = NULL;
+		return false;
+	}
+
+	/* if there is no thread, IFEAssetIdle() does the work like the other builds */
+	if ((asset_thread=SDL_CreateThread(asset_thread_proc,"IFEAssetLoader",NULL)) == NULL)
+		IFEDBG("Asset loader thread failed to start, loading when idle instead");
+#endif
+
+	asset_init = true;
+	return true;
+}
+
+void IFEAssetShutdown(void) {
+	IFEAsset *a;
+	unsigned int i;
+
+	if (!asset_init)
+		return;
+
+#if defined(IFE_ASSET_THREAD)
+	if (asset_thread != NULL) {
+		SDL_LockMutex(asset_mutex);
+		asset_quit = true;
+		SDL_CondBroadcast(asset_work);
+		SDL_UnlockMutex(asset_mutex);
+		SDL_WaitThread(asset_thread,NULL);
+		asset_thread = NULL;
+	}
+#endif
+
+	for (i=0;i < ASSET_HASH_SIZE;i++) {
+		while ((a=asset_hash[i]) != NULL) {
+			asset_hash[i] = a->hash_next;
+			delete a;
+		}
+	}
+
+	asset_lru_head = asset_lru_tail = NULL;
+	asset_queue_head = asset_queue_tail = NULL;
+	asset_stats.bytes = 0;
+	asset_stats.count = 0;
+
+#if defined(IFE_ASSET_THREAD)
+	SDL_DestroyCond(asset_done);
+	SDL_DestroyCond(asset_work);
+	SDL_DestroyMutex(asset_mutex);
+	asset_done = asset_work = NULL;
+	asset_mutex = NULL;
+#endif
+
+	asset_init = false;
+}
+
+void IFEAssetPrefetch(const char *path,const uint8_t bias) {
+	const uint32_t hash = asset_hash_key(path,bias);
+	IFEAsset *a;
+
+	if (!asset_init)
+		return;
+
+	asset_lock();
+	if ((a=asset_find(path,bias,hash)) == NULL) {
+		if ((a=asset_new(path,bias,hash)) != NULL) {
+			asset_queue_push(a);
+#if defined(IFE_ASSET_THREAD)
+			SDL_CondSignal(asset_work);
+#endif
+		}
+	}
+	else if (a->state == ASSET_READY) {
+		asset_lru_front(a); /* about to be used, keep it */
+	}
+	asset_unlock();
+}
+
+IFEBitmap *IFEAssetGet(const char *path,const uint8_t bias) {
+	const uint32_t hash = asset_hash_key(path,bias);
+	IFEBitmap *r = NULL;
+	IFEAsset *a;
+	bool ok;
+
+	if (!asset_init)
+		return NULL;
+
+	asset_lock();
+	if ((a=asset_find(path,bias,hash)) == NULL) {
+		if ((a=asset_new(path,bias,hash)) == NULL) {
+			asset_unlock();
+			return NULL;
+		}
+	}
+
+	a->refs++; /* so that nothing evicts it while this waits or decodes */
+	if (a->state == ASSET_QUEUED) {
+		/* decode it now instead of waiting for it to come up in the queue */
+		asset_queue_remove(a);
+		a->state = ASSET_LOADING;
+		asset_stats.misses++;
+		asset_unlock();
+		ok = asset_decode(a);
+		asset_lock();
+		asset_finish(a,ok);
+	}
+	else if (a->state == ASSET_LOADING) {
+		asset_stats.waits++;
+#if defined(IFE_ASSET_THREAD)
+		while (a->state == ASSET_LOADING)
+			SDL_CondWait(asset_done,asset_mutex);
+#endif
+	}
+	else {
+		asset_stats.hits++;
+	}
+
+	if (a->state == ASSET_READY) {
+		asset_lru_front(a);
+		r = &a->bmp;
+	}
+	else {
+		a->refs--;
+	}
+	asset_unlock();
+
+	return r;
+}
+
+IFEBitmap *IFEAssetTryGet(const char *path,const uint8_t bias) {
+	const uint32_t hash = asset_hash_key(path,bias);
+	IFEBitmap *r = NULL;
+	IFEAsset *a;
+
+	if (!asset_init)
+		return NULL;
+
+	asset_lock();
+	if ((a=asset_find(path,bias,hash)) == NULL) {
+		if ((a=asset_new(path,bias,hash)) != NULL) {
+			asset_queue_push(a);
+#if defined(IFE_ASSET_THREAD)
+			SDL_CondSignal(asset_work);
+#endif
+		}
+	}
+	else if (a->state == ASSET_READY) {
+		asset_stats.hits++;
+		asset_lru_front(a);
+		a->refs++;
+		r = &a->bmp;
+	}
+	asset_unlock();
+
+	return r;
+}
+
+void IFEAssetRelease(IFEBitmap *bmp) {
+	IFEAsset *a;
+
+	if (!asset_init || bmp == NULL)
+		return;
+
+	asset_lock();
+	for (a=asset_lru_head;a != NULL;a=a->lru_next) {
+		if (&a->bmp == bmp) {
+			if (a->refs == 0)
+				IFEFatalError("IFEAssetRelease called too many times for %s",a->path);
+
+			a->refs--;
+			if (a->refs == 0)
+				asset_evict();
+
+			break;
+		}
+	}
+	asset_unlock();
+}
+
+void IFEAssetIdle(void) {
+	IFEAsset *a;
+	bool ok;
+
+	if (!asset_init)
+		return;
+#if defined(IFE_ASSET_THREAD)
+	if (asset_thread != NULL)
+		return;
+#endif
+
+	/* one image at a time, so the caller is not held up for too long */
+	asset_lock();
+	if ((a=asset_queue_pop()) != NULL) {
+		a->state = ASSET_LOADING;
+		asset_unlock();
+		ok = asset_decode(a);
+		asset_lock();
+		asset_finish(a,ok);
+	}
+	asset_unlock();
+}
+
+void IFEAssetGetStats(IFEAssetStats &st) {
+	if (!asset_init) {
+		memset(&st,0,sizeof(st));
+		return;
+	}
+
+	asset_lock();
+	st = asset_stats;
+	asset_unlock();
+}
+
@@ -0,0 +1,41 @@
+
+#ifndef IFE_ASSETCACHE_H
+#define IFE_ASSETCACHE_H
+
+#include <stdint.h>
+
+/* decoded image cache. images are keyed by path and palette bias (see IFEBitmap::bias_subrect)
+ * and kept until the cache is over its size limit, then the least recently used images nobody
+ * holds are freed.
+ *
+ * IFEAssetPrefetch() queues an image so that it is already decoded when the game gets to it,
+ * i.e. the next scene's backdrop. The SDL2 build decodes queued images on a loader thread.
+ * Builds without threads (MS-DOS, Windows 3.1) decode one queued image each time
+ * IFEWaitEvent() is called, while the game is idle anyway. */
+struct IFEAssetStats {
+	unsigned long		hits;		/* IFEAssetGet() found it decoded */
+	unsigned long		waits;		/* IFEAssetGet() had to wait for the loader thread */
+	unsigned long		misses;		/* IFEAssetGet() had to decode it itself */
+	unsigned long		evictions;
+	unsigned long		bytes;		/* decoded bitmaps in the cache now */
+	unsigned long		max_bytes;
+	unsigned int		count;		/* images in the cache now, any state */
+};
+
+/* decodes one image file, IFELoadPNG() unless IFEAssetInit() is given another one.
+ * Called from the loader thread, the main thread, or both at once */
+typedef bool IFEAssetLoadFunc(IFEBitmap &bmp,const char *path);
+
+bool IFELoadPNG(IFEBitmap &bmp,const char *path);
+
+bool IFEAssetInit(const unsigned long max_bytes,IFEAssetLoadFunc *load=IFELoadPNG);
+void IFEAssetShutdown(void);
+void IFEAssetPrefetch(const char *path,const uint8_t bias=0);
+IFEBitmap *IFEAssetGet(const char *path,const uint8_t bias=0); /* decoded image or NULL if it failed to load. caller must IFEAssetRelease() */
+IFEBitmap *IFEAssetTryGet(const char *path,const uint8_t bias=0); /* same but NULL if not decoded yet, and queues it */
+void IFEAssetRelease(IFEBitmap *bmp);
+void IFEAssetIdle(void);
+void IFEAssetGetStats(IFEAssetStats &st);
+
+#endif //IFE_ASSETCACHE_H
+
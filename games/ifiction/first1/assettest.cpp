@@ -0,0 +1,305 @@
+/* WARNING: For host systems only. Checks the asset cache (assetcache.cpp): a fixed sequence
+ *          against known results, then a random prefetch/get/release/idle stress run that
+ *          checks every image it gets, both with a stand-in loader. Then the game's PNG
+ *          files, decoded by IFELoadPNG() through the cache and checked against the same
+ *          files loaded directly. Not part of the game. The makefile builds it with
+ *          ThreadSanitizer and AddressSanitizer, with the SDL2 loader thread and without. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include "ifict.h"
+#include "fatal.h"
+#include "debug.h"
+#include "bitmap.h"
+#include "assetcache.h"
+
+/* bitmap.cpp and assetcache.cpp call these, the real ones need a video backend */
+void IFEFatalError(const char *msg,...) {
+	va_list va;
+
+	va_start(va,msg);
+	fprintf(stderr,"Fatal error: ");
+	vfprintf(stderr,msg,va);
+	fprintf(stderr,"\n");
+	va_end(va);
+	exit(127);
+}
+
+void IFEDBG(const char *msg,...) {
+	va_list va;
+
+	va_start(va,msg);
+	fprintf(stderr,"Debug: ");
+	vfprintf(stderr,msg,va);
+	fprintf(stderr,"\n");
+	va_end(va);
+}
+
+/* stand-in loader, no PNG files: the path is the image width, 100 rows, every pixel
+ * (width & 0x7F) + 1. "bad" fails to load. Runs on the loader thread and the main thread at
+ * the same time */
+static unsigned int test_loads = 0;
+
+static bool test_load(IFEBitmap &bmp,const char *path) {
+	unsigned int w;
+
+	if (!strcmp(path,"bad"))
+		return false;
+
+	w = (unsigned int)atoi(path);
+	if (w == 0u || !bmp.alloc_subrects(1) || !bmp.alloc_storage(w,100))
+		return false;
+
+	memset(bmp.bitmap,(int)((w & 0x7Fu) + 1u),bmp.alloc);
+	bmp.width = w;
+	bmp.reset_scissor_rect();
+	{
+		IFEBitmap::subrect &sr = bmp.get_subrect(0);
+		sr.reset();
+		sr.r.x = 0;
+		sr.r.y = 0;
+		sr.r.w = (int)w;
+		sr.r.h = 100;
+	}
+
+	__sync_fetch_and_add(&test_loads,1u);
+	return true;
+}
+
+/* the image must be what test_load() makes for that path, plus the bias */
+static bool test_image_ok(const IFEBitmap *bmp,const char *path,const uint8_t bias) {
+	const unsigned int w = (unsigned int)atoi(path);
+	unsigned int x,y;
+
+	if (bmp == NULL || bmp->width != w || bmp->height != 100u)
+		return false;
+
+	for (y=0;y < bmp->height;y += 33u) {
+		const unsigned char *row = bmp->row(y);
+		for (x=0;x < bmp->width;x += 7u) {
+			if (row[x] != (unsigned char)((w & 0x7Fu) + 1u + bias))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+#define TEST_CHECK(x) do { if (!(x)) { fprintf(stderr,"FAIL line %d: %s\n",__LINE__,#x); return false; } } while (0)
+
+/* fixed sequence, all results known. Cache of 250 x 100 bytes, images of 100 x 100 */
+static bool test_sequence(void) {
+	IFEBitmap *a,*b,*c,*d,*e;
+	IFEAssetStats st;
+	unsigned int i;
+
+	TEST_CHECK(IFEAssetInit(250ul * 100ul,test_load));
+
+	a = IFEAssetGet("100");
+	TEST_CHECK(test_image_ok(a,"100",0));
+	b = IFEAssetGet("100");
+	TEST_CHECK(a == b);
+	c = IFEAssetGet("100",5);
+	TEST_CHECK(c != a && test_image_ok(c,"100",5));
+	IFEAssetGetStats(st);
+	TEST_CHECK(st.hits == 1ul && st.misses == 2ul && test_loads == 2u);
+
+	/* over the limit, but every image is held */
+	d = IFEAssetGet("100",7);
+	TEST_CHECK(test_image_ok(d,"100",7));
+	IFEAssetGetStats(st);
+	TEST_CHECK(st.evictions == 0ul && st.bytes == 30000ul);
+
+	/* c is not the most recently used and nobody holds it now */
+	IFEAssetRelease(c);
+	IFEAssetGetStats(st);
+	TEST_CHECK(st.evictions == 1ul && st.bytes == 20000ul);
+
+	TEST_CHECK(IFEAssetGet("bad") == NULL);
+
+	IFEAssetPrefetch("120");
+	for (i=0;i < 2000u && (e=IFEAssetTryGet("120")) == NULL;i++) {
+		IFEAssetIdle();
+		usleep(1000);
+	}
+	TEST_CHECK(test_image_ok(e,"120",0));
+
+	IFEAssetRelease(e);
+	IFEAssetRelease(a);
+	IFEAssetRelease(b);
+	IFEAssetRelease(d);
+	IFEAssetGetStats(st);
+	TEST_CHECK(st.bytes <= st.max_bytes);
+
+	IFEAssetShutdown();
+	return true;
+}
+
+#define TEST_HELD		4u
+#define TEST_STRESS_OPS		20000u
+
+/* random operations on 12 widths x 2 biases in a cache that holds about 3 of them, so images
+ * are evicted and reloaded all the time, some while the loader thread is decoding them */
+static bool test_stress(void) {
+	IFEBitmap *held[TEST_HELD];
+	char held_path[TEST_HELD][16];
+	uint8_t held_bias[TEST_HELD];
+	IFEAssetStats st;
+	unsigned int i,s;
+	IFEBitmap *b;
+	char path[16];
+	uint8_t bias;
+
+	memset(held,0,sizeof(held));
+	TEST_CHECK(IFEAssetInit(40000ul,test_load));
+
+	srand(3);
+	for (i=0;i < TEST_STRESS_OPS;i++) {
+		sprintf(path,"%u",100u + ((unsigned int)(rand() % 12) * 4u));
+		bias = (uint8_t)(rand() & 1);
+
+		switch (rand() % 4) {
+			case 0:
+				IFEAssetPrefetch(path,bias);
+				break;
+			case 1:
+				s = (unsigned int)rand() % TEST_HELD;
+				if (held[s] != NULL) {
+					TEST_CHECK(test_image_ok(held[s],held_path[s],held_bias[s]));
+					IFEAssetRelease(held[s]);
+				}
+				held[s] = IFEAssetGet(path,bias);
+				strcpy(held_path[s],path);
+				held_bias[s] = bias;
+				TEST_CHECK(test_image_ok(held[s],path,bias));
+				break;
+			case 2:
+				if ((b=IFEAssetTryGet(path,bias)) != NULL) {
+					TEST_CHECK(test_image_ok(b,path,bias));
+					IFEAssetRelease(b);
+				}
+				break;
+			default:
+				IFEAssetIdle();
+				break;
+		}
+	}
+
+	for (s=0;s < TEST_HELD;s++) {
+		if (held[s] != NULL) IFEAssetRelease(held[s]);
+	}
+
+	IFEAssetGetStats(st);
+	printf("Stress: %u ops, %lu hits, %lu waits, %lu misses, %lu evictions, %lu/%lu bytes, %u images at the end\n",
+		TEST_STRESS_OPS,st.hits,st.waits,st.misses,st.evictions,st.bytes,st.max_bytes,st.count);
+	TEST_CHECK(st.bytes <= st.max_bytes);
+
+	IFEAssetShutdown();
+	return true;
+}
+
+static const struct test_png_t {
+	const char*		path;
+	uint8_t			bias;
+} test_pngs[] = {
+	{"test1.png",		0},	/* 8-bit */
+	{"test1.png",		64},
+	{"woo1.png",		0},
+	{"ariarl2.png",		0},	/* 1-bit */
+	{"ariailg.png",		32},
+	{"st_arrow.png",	0},	/* transparent */
+	{"st_wait.png",		16}
+};
+
+/* same size, palette, subrect, pixels, and mask if transparent */
+static bool test_same_image(const IFEBitmap *a,const IFEBitmap &b) {
+	const unsigned int cmpw = (a->image_type == IFEBitmap::IMT_TRANSPARENT_MASK) ? (a->get_transparent_mask_offset() + a->width) : a->width;
+	const IFEBitmap::subrect &asr = a->get_subrect(0),&bsr = b.get_subrect(0);
+	unsigned int y;
+	size_t i;
+
+	if (a->width != b.width || a->height != b.height || a->image_type != b.image_type)
+		return false;
+	if (asr.r.x != bsr.r.x || asr.r.y != bsr.r.y || asr.r.w != bsr.r.w || asr.r.h != bsr.r.h || asr.index_bias != bsr.index_bias)
+		return false;
+	if (a->palette_size != b.palette_size || (a->palette == NULL) != (b.palette == NULL))
+		return false;
+
+	for (i=0;i < a->palette_size;i++) {
+		if (a->palette[i].r != b.palette[i].r || a->palette[i].g != b.palette[i].g || a->palette[i].b != b.palette[i].b)
+			return false;
+	}
+
+	for (y=0;y < a->height;y++) {
+		if (memcmp(a->row(y),b.row(y),cmpw) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+/* the real PNG files, prefetched so that the loader thread (or IFEAssetIdle()) decodes them,
+ * against the same files loaded and biased directly on this thread */
+static bool test_png(void) {
+	const unsigned int count = sizeof(test_pngs) / sizeof(test_pngs[0]);
+	IFEBitmap *b;
+	IFEAssetStats st;
+	unsigned int i,j;
+
+	TEST_CHECK(IFEAssetInit(4ul * 1024ul * 1024ul));
+
+	for (i=0;i < count;i++)
+		IFEAssetPrefetch(test_pngs[i].path,test_pngs[i].bias);
+
+	for (i=0;i < count;i++) {
+		const test_png_t &t = test_pngs[i];
+		IFEBitmap direct;
+
+		for (j=0;j < 5000u && (b=IFEAssetTryGet(t.path,t.bias)) == NULL;j++) {
+			IFEAssetIdle();
+			usleep(1000);
+		}
+		TEST_CHECK(b != NULL);
+
+		TEST_CHECK(IFELoadPNG(direct,t.path));
+		if (t.bias != 0) TEST_CHECK(direct.bias_subrect(direct.get_subrect(0),t.bias));
+		if (!test_same_image(b,direct)) {
+			fprintf(stderr,"%s bias %u from the asset cache differs from IFELoadPNG()\n",t.path,(unsigned int)t.bias);
+			return false;
+		}
+
+		IFEAssetRelease(b);
+	}
+
+	/* IFEAssetTryGet() never decodes, so every one was decoded by the loader thread or IFEAssetIdle() */
+	IFEAssetGetStats(st);
+	TEST_CHECK(st.hits == (unsigned long)count && st.misses == 0ul);
+	printf("PNG: %u images, %lu/%lu bytes\n",count,st.bytes,st.max_bytes);
+
+	IFEAssetShutdown();
+	return true;
+}
+
+int main(int argc,char **argv) {
+	(void)argc;
+	(void)argv;
+
+#if defined(USE_SDL2)
+	printf("Asset cache test, SDL2 loader thread\n");
+#else
+	printf("Asset cache test, no loader thread\n");
+#endif
+
+	if (!test_sequence() || !test_stress() || !test_png()) {
+		fprintf(stderr,"Asset cache test failed\n");
+		return 1;
+	}
+
+	printf("Asset cache test OK\n");
+	return 0;
+}
@@ -15,10 +15,11 @@
 #include "fatal.h"
 #include "bitmap.h"
 
-IFEBitmap::IFEBitmap(enum subclass_t _subclass) : bitmap(NULL), bitmap_first_row(NULL), alloc(0), width(0), height(0), stride(0), subrects(NULL), subrects_alloc(0), palette(NULL), palette_alloc(0), palette_size(0), must_lock(false), is_locked(0), ctrl_palette(true), ctrl_storage(true), ctrl_bias(true), ctrl_subrect(true), scissor(0,0,0,0), subclass(_subclass) {
+IFEBitmap::IFEBitmap(enum subclass_t _subclass) : bitmap(NULL), bitmap_first_row(NULL), alloc(0), width(0), height(0), stride(0), subrects(NULL), subrects_alloc(0), palette(NULL), palette_alloc(0), palette_size(0), must_lock(false), is_locked(0), ctrl_palette(true), ctrl_storage(true), ctrl_bias(true), ctrl_subrect(true), scissor(0,0,0,0), subclass(_subclass), spans(NULL), span_row(NULL), span_skip(0), spans_valid(false) {
 }
 
 IFEBitmap::~IFEBitmap() {
+	free_opaque_spans();
 	free_subrects();
 	free_storage();
 	free_palette();
@@ -148,10 +149,12 @@ bool IFEBitmap::alloc_storage(unsigned int w,unsigned int h,enum image_type_t ne
 	image_type = new_image_type;
 	bitmap_first_row = bitmap; /* our own allocation code does top-down DIBs */
 	reset_scissor_rect();
+	free_opaque_spans();
 	return true;
 }
 
 void IFEBitmap::free_storage(void) {
+	free_opaque_spans();
 	if (bitmap != NULL) {
 		free(bitmap);
 		bitmap = NULL;
@@ -324,6 +327,90 @@ void IFEBitmap::reset_scissor_rect(void) {
 	scissor.h = height;
 }
 
+void IFEBitmap::free_opaque_spans(void) {
+	if (spans != NULL) {
+		free(spans);
+		spans = NULL;
+	}
+	if (span_row != NULL) {
+		free(span_row);
+		span_row = NULL;
+	}
+	spans_valid = false;
+}
+
+/* transparent runs shorter than this are made part of the span around them, a masked blit
+ * of a few transparent pixels costs less than starting another span */
+#define OPAQUE_SPAN_MIN_GAP 8u
+
+bool IFEBitmap::get_opaque_spans(void) {
+	unsigned int x,y,gap,count = 0;
+	const unsigned char *src,*msk;
+	opaque_span *cur;
+	bool pass,in_span;
+
+	if (spans_valid) return true;
+	if (image_type != IMT_TRANSPARENT_MASK || bitmap_first_row == NULL) return false;
+
+	free_opaque_spans();
+	if ((span_row=(uint32_t*)malloc(sizeof(uint32_t) * (height + 1u))) == NULL)
+		return false;
+
+	/* first pass counts, second pass fills in */
+	for (pass=false;;pass=true) {
+		count = 0;
+		for (y=0;y < height;y++) {
+			src = row(y);
+			msk = src + get_transparent_mask_offset();
+			in_span = false;
+			cur = NULL;
+			gap = 0;
+
+			if (pass) span_row[y] = count;
+			for (x=0;x < width;x++) {
+				if (msk[x] == 0xFFu && src[x] == 0u) { /* transparent, (dst AND 0xFF) + 0 == dst */
+					gap++;
+					continue;
+				}
+
+				if (!in_span || gap >= OPAQUE_SPAN_MIN_GAP) {
+					if (pass) {
+						cur = spans + count;
+						cur->x = (uint16_t)x;
+						cur->w = 0;
+						cur->opaque = 1;
+					}
+					in_span = true;
+					count++;
+				}
+				else if (pass && gap != 0u) {
+					cur->w = (uint16_t)(cur->w + gap); /* short transparent gap becomes part of the span */
+					cur->opaque = 0;
+				}
+
+				if (pass) {
+					cur->w++;
+					if (msk[x] != 0x00u) cur->opaque = 0;
+				}
+				gap = 0;
+			}
+		}
+
+		if (pass) break;
+
+		if ((spans=(opaque_span*)malloc(sizeof(opaque_span) * (count + 1u))) == NULL) {
+			free_opaque_spans();
+			return false;
+		}
+	}
+
+	span_row[height] = count;
+	span_skip = width * height;
+	for (x=0;x < count;x++) span_skip -= spans[x].w;
+	spans_valid = true;
+	return true;
+}
+
 /* screen bitmap, you cannot allocate/free palette, storage, subrects, or bias anything
  * because the screen driver manages it. */
 IFEScreenBitmap::IFEScreenBitmap(enum subclass_t _subclass) : IFEBitmap(_subclass) {
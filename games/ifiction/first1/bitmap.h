@@ -29,6 +29,12 @@ public:
 
 		void		reset(void);
 	};
+	/* run of pixels in a row of an IMT_TRANSPARENT_MASK bitmap that is not entirely transparent.
+	 * the blitters skip everything else */
+	struct opaque_span {
+		uint16_t	x,w;
+		uint16_t	opaque;			/* nonzero if every pixel is opaque (mask 0x00), a plain copy will do */
+	};
 public:
 	unsigned char*		bitmap;			/* allocated bitmap */
 	unsigned char*		bitmap_first_row;	/* first row in bitmap to count from, last scanline if upside down DIB in Windows 3.1 (stride < 0) */
@@ -54,6 +60,11 @@ public:
 	enum image_type_t	image_type;
 
 	enum subclass_t		subclass;
+
+	opaque_span*		spans;			/* built on demand by get_opaque_spans() */
+	uint32_t*		span_row;		/* spans of row y are span_row[y] <= i < span_row[y+1] */
+	uint32_t		span_skip;		/* pixels in no span, that a span blit does not touch */
+	bool			spans_valid;
 public:
 	IFEBitmap(enum subclass_t _subclass=SC_BASE);
 	virtual ~IFEBitmap();
@@ -73,6 +84,14 @@ public:
 	virtual bool bias_subrect(subrect &s,uint8_t new_bias); /* bias (add to pixel values) for simple palette remapping */
 	void set_scissor_rect(int x1,int y1,int x2,int y2);
 	void reset_scissor_rect(void);
+	bool get_opaque_spans(void); /* build spans if needed, false if not transparent or out of memory */
+	void free_opaque_spans(void);
+
+	/* anything that changes the pixels or mask of a transparent bitmap must call this.
+	 * the drawing functions do, code that writes to the bitmap directly must do it too */
+	inline void invalidate_opaque_spans(void) {
+		spans_valid = false;
+	}
 
 	inline unsigned int get_transparent_mask_offset(void) const { /* assume IMT_TRANSPARENT_MASK */
 		return (width + 3u) & (~3u); /* at width rounded up to DWORD boundary */
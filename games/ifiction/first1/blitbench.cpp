@@ -0,0 +1,277 @@
+
+/* WARNING: For host systems only. Checks the SSE2/AVX2 and opaque span blit paths against the
+ *          scalar code, then times them. Not part of the game. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "ifict.h"
+#include "fatal.h"
+#include "bitmap.h"
+#include "blitops.h"
+
+/* bitmap.cpp calls this, the real one in fatal.cpp needs a video backend */
+void IFEFatalError(const char *msg,...) {
+	va_list va;
+
+	va_start(va,msg);
+	fprintf(stderr,"Fatal error: ");
+	vfprintf(stderr,msg,va);
+	fprintf(stderr,"\n");
+	va_end(va);
+	exit(127);
+}
+
+struct bench_size {
+	unsigned int		w,h;
+};
+
+static const bench_size bench_sizes[] = {
+	{  16,  16},
+	{  32,  32},
+	{  64,  64},
+	{ 128,  96},
+	{ 320, 200}
+};
+
+#define BENCH_SIZES (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+
+struct bench_shape {
+	const char*		name;
+	double			hole;		/* radius squared of the transparent middle, 0.25 is the outline */
+};
+
+static const bench_shape bench_shapes[] = {
+	{"solid",	0.02},
+	{"ring",	0.20}
+};
+
+#define BENCH_SHAPES (sizeof(bench_shapes) / sizeof(bench_shapes[0]))
+
+static double bench_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/* sprite with an elliptical outline and a transparent hole in the middle, so rows have more than
+ * one span. a small hole is a solid sprite, a large one a thin ring that is mostly transparent
+ * like the glyphs of a font */
+static bool make_sprite(IFEBitmap &bmp,const unsigned int w,const unsigned int h,const double hole) {
+	unsigned int x,y;
+	double dx,dy,d;
+
+	if (!bmp.alloc_storage(w,h,IFEBitmap::IMT_TRANSPARENT_MASK))
+		return false;
+
+	for (y=0;y < h;y++) {
+		unsigned char *src = bmp.row(y);
+		unsigned char *msk = src + bmp.get_transparent_mask_offset();
+
+		for (x=0;x < w;x++) {
+			dx = (((double)x + 0.5) / (double)w) - 0.5;
+			dy = (((double)y + 0.5) / (double)h) - 0.5;
+			d = (dx * dx) + (dy * dy);
+
+			if (d > 0.25 || (d < hole && w >= 32u)) {
+				src[x] = 0x00;
+				msk[x] = 0xFF;
+			}
+			else {
+				src[x] = (unsigned char)(1u + ((unsigned int)rand() % 255u));
+				msk[x] = 0x00;
+			}
+		}
+	}
+
+	bmp.invalidate_opaque_spans();
+	return true;
+}
+
+/* destination, transparent so the mask combine can be checked too */
+static bool make_dest(IFEBitmap &bmp,const unsigned int w,const unsigned int h) {
+	unsigned int x,y;
+
+	if (!bmp.alloc_storage(w,h,IFEBitmap::IMT_TRANSPARENT_MASK))
+		return false;
+
+	for (y=0;y < h;y++) {
+		unsigned char *dst = bmp.row(y);
+		unsigned char *msk = dst + bmp.get_transparent_mask_offset();
+
+		for (x=0;x < w;x++) {
+			if ((rand() & 3) == 0) {
+				dst[x] = 0x00;
+				msk[x] = 0xFF;
+			}
+			else {
+				dst[x] = (unsigned char)rand();
+				msk[x] = 0x00;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void copy_bitmap(IFEBitmap &d,const IFEBitmap &s) {
+	memcpy(d.bitmap,s.bitmap,(size_t)s.stride * (size_t)s.height);
+}
+
+static void blit_rows(IFEBitmap &d,const IFEBitmap &s,const int sx,const int sy,const int w,int h,const bool dmask) {
+	const unsigned char *src = s.row((unsigned int)sy) + sx;
+	const unsigned char *sms = src + s.get_transparent_mask_offset();
+	unsigned char *dst = d.row(0);
+	unsigned char *dms = dst + d.get_transparent_mask_offset();
+
+	while (h > 0) {
+		IFEBlitMaskRow(dst,src,sms,(unsigned int)w);
+		if (dmask) IFEBlitAndRow(dms,sms,(unsigned int)w);
+		dst += d.stride;
+		dms += d.stride;
+		src += s.stride;
+		sms += s.stride;
+		h--;
+	}
+}
+
+static void blit_spans(IFEBitmap &d,IFEBitmap &s,const int sx,const int sy,const int w,const int h,const bool dmask) {
+	unsigned char *dst = d.row(0);
+
+	if (!s.get_opaque_spans()) {
+		fprintf(stderr,"Failed to build opaque spans\n");
+		exit(1);
+	}
+
+	IFEBlitSpans(dst,dmask ? (dst + d.get_transparent_mask_offset()) : NULL,d.stride,s,sx,sy,w,h);
+}
+
+/* every level and the span path must give the same result as the scalar rows, for the whole
+ * sprite and for clipped parts of it */
+static bool check(void) {
+	IFEBitmap spr,dst,ref,out;
+	unsigned int si,level,t;
+	int sx,sy,w,h;
+	bool dmask;
+
+	for (si=0;si < (BENCH_SIZES * BENCH_SHAPES);si++) {
+		const unsigned int sw = bench_sizes[si % BENCH_SIZES].w,sh = bench_sizes[si % BENCH_SIZES].h;
+
+		if (!make_sprite(spr,sw,sh,bench_shapes[si / BENCH_SIZES].hole) || !make_dest(dst,sw,sh) ||
+			!ref.alloc_storage(sw,sh,IFEBitmap::IMT_TRANSPARENT_MASK) ||
+			!out.alloc_storage(sw,sh,IFEBitmap::IMT_TRANSPARENT_MASK))
+			return false;
+
+		for (t=0;t < 200;t++) {
+			if (t == 0) {
+				sx = sy = 0;
+				w = (int)sw;
+				h = (int)sh;
+			}
+			else {
+				sx = rand() % (int)sw;
+				sy = rand() % (int)sh;
+				w = 1 + (rand() % ((int)sw - sx));
+				h = 1 + (rand() % ((int)sh - sy));
+			}
+			dmask = (t & 1) != 0;
+
+			IFEBlitOpsSelect(IFEBLIT_SCALAR);
+			copy_bitmap(ref,dst);
+			blit_rows(ref,spr,sx,sy,w,h,dmask);
+
+			for (level=0;level < IFEBLIT_MAX;level++) {
+				if (!IFEBlitOpsSelect(level)) continue;
+
+				copy_bitmap(out,dst);
+				blit_rows(out,spr,sx,sy,w,h,dmask);
+				if (memcmp(out.bitmap,ref.bitmap,(size_t)ref.stride * (size_t)ref.height)) {
+					fprintf(stderr,"%ux%u %s rows differ from scalar (sx=%d sy=%d w=%d h=%d)\n",
+						sw,sh,IFEBlitOpsName(level),sx,sy,w,h);
+					return false;
+				}
+
+				copy_bitmap(out,dst);
+				blit_spans(out,spr,sx,sy,w,h,dmask);
+				if (memcmp(out.bitmap,ref.bitmap,(size_t)ref.stride * (size_t)ref.height)) {
+					fprintf(stderr,"%ux%u %s spans differ from scalar (sx=%d sy=%d w=%d h=%d)\n",
+						sw,sh,IFEBlitOpsName(level),sx,sy,w,h);
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static void bench(void) {
+	IFEBitmap spr,dst;
+	unsigned int si,level,iter,i,span_count,opaque_count;
+	double t0,t1,rows_mpix,spans_mpix;
+	bool dmask;
+
+	printf("%-14s %-7s %-5s %12s %12s %8s %s\n","sprite","level","dmask","rows Mpix/s","spans Mpix/s","spans","picked");
+	for (si=0;si < (BENCH_SIZES * BENCH_SHAPES);si++) {
+		const unsigned int sw = bench_sizes[si % BENCH_SIZES].w,sh = bench_sizes[si % BENCH_SIZES].h;
+		char tmp[32];
+
+		if (!make_sprite(spr,sw,sh,bench_shapes[si / BENCH_SIZES].hole) || !make_dest(dst,sw,sh) || !spr.get_opaque_spans())
+			return;
+
+		span_count = spr.span_row[sh];
+		for (opaque_count=0,i=0;i < span_count;i++)
+			if (spr.spans[i].opaque) opaque_count++;
+
+		sprintf(tmp,"%s %ux%u",bench_shapes[si / BENCH_SIZES].name,sw,sh);
+
+		for (level=0;level < IFEBLIT_MAX;level++) {
+			if (!IFEBlitOpsSelect(level)) continue;
+
+			for (i=0;i < 2;i++) {
+				dmask = (i != 0);
+
+				/* about 64M pixels per test */
+				t0 = bench_time();
+				for (iter=(64u * 1024u * 1024u) / (sw * sh);iter > 0;iter--)
+					blit_rows(dst,spr,0,0,(int)sw,(int)sh,dmask);
+				t1 = bench_time();
+				rows_mpix = (64.0 * 1024.0 * 1024.0) / ((t1 - t0) * 1000000.0);
+
+				t0 = bench_time();
+				for (iter=(64u * 1024u * 1024u) / (sw * sh);iter > 0;iter--)
+					blit_spans(dst,spr,0,0,(int)sw,(int)sh,dmask);
+				t1 = bench_time();
+				spans_mpix = (64.0 * 1024.0 * 1024.0) / ((t1 - t0) * 1000000.0);
+
+				printf("%-14s %-7s %-5s %12.1f %12.1f %3u/%-4u %s\n",tmp,IFEBlitOpsName(level),dmask ? "yes" : "no",
+					rows_mpix,spans_mpix,opaque_count,span_count,IFEBlitSpansPreferred(spr,dmask) ? "spans" : "rows");
+			}
+		}
+	}
+
+	printf("spans column is opaque/total spans in the sprite, picked is what IFETBitBlt would use\n");
+}
+
+int main(int argc,char **argv) {
+	srand(1);
+
+	printf("Best blit level: %s\n",IFEBlitOpsName(IFEBlitOpsBest()));
+
+	if (!check()) {
+		fprintf(stderr,"Check failed\n");
+		return 1;
+	}
+	printf("All blit paths match scalar\n");
+
+	if (argc > 1 && !strcmp(argv[1],"-test"))
+		return 0;
+
+	bench();
+	return 0;
+}
+
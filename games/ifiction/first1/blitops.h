@@ -0,0 +1,39 @@
+
+#ifndef IFE_BLITOPS_H
+#define IFE_BLITOPS_H
+
+#include <stdint.h>
+
+/* row operations behind IFETBitBlt, done with SSE2 or AVX2 if the compiler can and the CPU has
+ * it (GCC on x86, the SDL2 build), otherwise 32 bits at a time. The choice is made the first
+ * time one of them is called. Opaque copies and fills use memcpy/memset, which the C library
+ * already does as fast as the CPU allows. */
+typedef void ifeblit_mask_t(unsigned char *dst,const unsigned char *src,const unsigned char *msk,unsigned int w); /* dst = (dst AND msk) + src */
+typedef void ifeblit_and_t(unsigned char *dst,const unsigned char *src,unsigned int w); /* dst = dst AND src */
+
+extern ifeblit_mask_t*		IFEBlitMaskRow;
+extern ifeblit_and_t*		IFEBlitAndRow;
+
+enum {
+	IFEBLIT_SCALAR=0,
+	IFEBLIT_SSE2,
+	IFEBLIT_AVX2,
+
+	IFEBLIT_MAX
+};
+
+unsigned int IFEBlitOpsBest(void); /* best level this build and CPU can do */
+bool IFEBlitOpsSelect(const unsigned int level); /* false if not available */
+const char *IFEBlitOpsName(const unsigned int level);
+
+/* true if IFEBlitSpans() is likely faster than the rows for this bitmap, with (dmask) or without
+ * combining the destination mask. spans must be built */
+bool IFEBlitSpansPreferred(const IFEBitmap &sbmp,const bool dmask);
+
+/* transparent blit of a w x h area at sx,sy of an IMT_TRANSPARENT_MASK bitmap, using its opaque
+ * spans so fully transparent runs are skipped. if dms != NULL the destination is transparent too
+ * and its mask is combined. caller has done clipping and locking */
+void IFEBlitSpans(unsigned char *dst,unsigned char *dms,const int dstride,const IFEBitmap &sbmp,const int sx,const int sy,const int w,int h);
+
+#endif //IFE_BLITOPS_H
+
@@ -4,9 +4,9 @@
 #endif
 
 #include <stdio.h>
-#include <assert.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdint.h>
 
@@ -16,20 +16,8 @@
 #include "fatal.h"
 #include "bitmap.h"
 #include "palette.h"
-
-#if defined(TARGET_MSDOS)
-#include <ext/zlib/zlib.h>
-#else
-#include <zlib.h>
-#endif
-
-#ifndef O_BINARY
-#define O_BINARY (0)
-#endif
-
-extern "C" {
-#include <fmt/minipng/minipng.h>
-}
+#include "blitops.h"
+#include "assetcache.h"
 
 ifeapi_t *ifeapi = &ifeapi_default;
 
@@ -76,157 +64,6 @@ IFEcursor_state_t	priv_IFEcursor;
 
 void IFESetCursor(IFEBitmap* new_cursor,size_t sr=0);
 
-/* load one PNG into ONE bitmap, that's it */
-bool IFELoadPNG(IFEBitmap &bmp,const char *path) {
-	bool res = false,transparency = false;
-	struct minipng_reader *rdr = NULL;
-	unsigned int alloc_w;
-	unsigned int i;
-
-	if ((rdr=minipng_reader_open(path)) == NULL)
-		goto done;
-	if (minipng_reader_parse_head(rdr))
-		goto done;
-	if (rdr->ihdr.width > 2048 || rdr->ihdr.width < 1 || rdr->ihdr.height > 2048 || rdr->ihdr.height < 1)
-		goto done;
-	if (rdr->ihdr.color_type != 3) /* PNG_COLOR_TYPE_PALETTE = PNG_COLOR_MASK_COLOR | PNG_COLOR_MASK_PALETTE */
-		goto done;
-
-	if (rdr->trns != NULL && rdr->trns_size != 0) {
-		for (i=0;i < rdr->trns_size;i++) {
-			if (!(rdr->trns[i] & 0x80)) {
-				transparency = true;
-			}
-		}
-	}
-
-	switch (rdr->ihdr.bit_depth) {
-		case 8:
-			alloc_w = rdr->ihdr.width;
-			break;
-		case 4:
-			alloc_w = (rdr->ihdr.width + 1u) & (~1u); /* round up to multiple of 2 */
-			break;
-		case 1:
-			alloc_w = (rdr->ihdr.width + 7u) & (~7u); /* round up to multiple of 8 */
-			break;
-		default:
-			goto done;
-	};
-
-	/* transparency is accomplished by allocating twice the width,
-	 * making the right hand side the mask and the left hand the image */
-
-	if (!bmp.alloc_subrects(1))
-		goto done;
-	if (!bmp.alloc_storage(alloc_w, rdr->ihdr.height, transparency ? IFEBitmap::IMT_TRANSPARENT_MASK : IFEBitmap::IMT_OPAQUE))
-		goto done;
-
-	/* reset bitmap width to what we intended */
-	if (bmp.width < rdr->ihdr.width)
-		goto done;
-
-	bmp.width = rdr->ihdr.width;
-	bmp.reset_scissor_rect();
-
-	if (rdr->ihdr.bit_depth >= 1 && rdr->ihdr.bit_depth <= 8) {
-		if (rdr->plte == NULL)
-			goto done;
-		if (!bmp.alloc_palette(1u << rdr->ihdr.bit_depth))
-			goto done;
-
-		i=0;
-		while (i < bmp.palette_alloc && i < rdr->plte_count) {
-			bmp.palette[i].r = rdr->plte[i].red;
-			bmp.palette[i].g = rdr->plte[i].green;
-			bmp.palette[i].b = rdr->plte[i].blue;
-			i++;
-		}
-		while (i < bmp.palette_alloc) {
-			bmp.palette[i].r = 0;
-			bmp.palette[i].g = 0;
-			bmp.palette[i].b = 0;
-			i++;
-		}
-
-		bmp.palette_size = rdr->plte_count;
-	}
-	else {
-		bmp.free_palette();
-	}
-
-	{
-		IFEBitmap::subrect &sr = bmp.get_subrect(0);
-		sr.reset();
-		sr.r.w = rdr->ihdr.width;
-		sr.r.h = rdr->ihdr.height;
-		sr.r.x = 0;
-		sr.r.y = 0;
-
-		if (rdr->ihdr.bit_depth == 8) {
-			unsigned char *ptr = bmp.bitmap;
-
-			for (i=0;i < bmp.height;i++) {
-				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
-				minipng_reader_read_idat(rdr,ptr,rdr->ihdr.width); /* row */
-				ptr += bmp.stride;
-			}
-		}
-		else if (rdr->ihdr.bit_depth == 4) {
-			unsigned char *ptr = bmp.bitmap;
-
-			for (i=0;i < bmp.height;i++) {
-				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
-				minipng_reader_read_idat(rdr,ptr,(rdr->ihdr.width+1u)/2u); /* row */
-				minipng_expand4to8(ptr,rdr->ihdr.width);
-				ptr += bmp.stride;
-			}
-		}
-		else if (rdr->ihdr.bit_depth == 1) {
-			unsigned char *ptr = bmp.bitmap;
-
-			for (i=0;i < bmp.height;i++) {
-				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
-				minipng_reader_read_idat(rdr,ptr,(rdr->ihdr.width+7u)/8u); /* row */
-				minipng_expand1to8(ptr,rdr->ihdr.width);
-				ptr += bmp.stride;
-			}
-		}
-		else {
-			memset(bmp.bitmap,0,bmp.stride * bmp.height);
-		}
-
-		if (transparency) {
-			/* NTS: Remember the bitmap allocated is twice the width of the PNG, mask starts on right hand side */
-			unsigned int x;
-			unsigned char *ptr = bmp.bitmap;
-			unsigned char *msk = ptr + bmp.get_transparent_mask_offset();
-
-			assert((bmp.get_transparent_mask_offset() + bmp.width) <= abs(bmp.stride));
-
-			for (i=0;i < bmp.height;i++) {
-				for (x=0;x < rdr->ihdr.width;x++) {
-					if (ptr[x] < rdr->trns_size && !(rdr->trns[ptr[x]] & 0x80)) {
-						msk[x] = 0xFF; /* transparent ((dst AND msk) + src) == dst */
-						ptr[x] = 0x00; /* for this to work, make sure src == 0 */
-					}
-					else {
-						msk[x] = 0x00; /* opaque ((dst AND msk) + src) == src */
-					}
-				}
-				ptr += bmp.stride;
-				msk += bmp.stride;
-			}
-		}
-
-		res = true;
-	}
-
-done:
-        minipng_reader_close(&rdr);
-	return res;
-}
-
 void IFEAddScreenUpdate(int x1,int y1,int x2,int y2) {
 	if (x1 < IFEscrbmp->scissor.x)
 		x1 = IFEscrbmp->scissor.x;
@@ -430,6 +267,8 @@ void IFEFillRect(IFEBitmap &dbmp,int x1,int y1,int x2,int y2,const uint8_t color
 						row += dbmp.stride;
 						msk += dbmp.stride;
 					} while ((--dh) > 0);
+
+					dbmp.invalidate_opaque_spans();
 				}
 				break;
 			default:
@@ -473,6 +312,8 @@ void IFETFillRect(IFEBitmap &dbmp,int x1,int y1,int x2,int y2) {
 						row += dbmp.stride;
 						msk += dbmp.stride;
 					} while ((--dh) > 0);
+
+					dbmp.invalidate_opaque_spans();
 				}
 				break;
 			default:
@@ -530,6 +371,8 @@ void IFEBitBlt(IFEBitmap &dbmp,int dx,int dy,int w,int h,int sx,int sy,IFEBitmap
 							sms += sbmp.stride;
 							h--;
 						}
+
+						dbmp.invalidate_opaque_spans();
 					}
 					break;
 				default:
@@ -554,38 +397,6 @@ void IFEBitBlt(IFEBitmap &dbmp,int dx,int dy,int w,int h,int sx,int sy,IFEBitmap
 	}
 }
 
-static inline void memcpyand(unsigned char *dst,const unsigned char *src,unsigned int w) {
-	while (w >= 4) {
-		*((uint32_t*)dst) &= *((uint32_t*)src);
-		dst += 4;
-		src += 4;
-		w -= 4;
-	}
-	while (w > 0) {
-		*dst &= *src;
-		dst++;
-		src++;
-		w--;
-	}
-}
-
-static inline void memcpymask(unsigned char *dst,const unsigned char *src,const unsigned char *msk,unsigned int w) {
-	while (w >= 4) {
-		*((uint32_t*)dst) = (*((uint32_t*)dst) & *((uint32_t*)msk)) + *((uint32_t*)src);
-		dst += 4;
-		msk += 4;
-		src += 4;
-		w -= 4;
-	}
-	while (w > 0) {
-		*dst = (unsigned char)((*dst & *msk) + *src);
-		dst++;
-		msk++;
-		src++;
-		w--;
-	}
-}
-
 void IFETBitBlt(IFEBitmap &dbmp,int dx,int dy,int w,int h,int sx,int sy,IFEBitmap &sbmp) {
 	if (!IFEBitBlt_clipcheck(dx,dy,w,h,sx,sy,(int)sbmp.width,(int)sbmp.height,dbmp.scissor)) return;
 
@@ -603,15 +414,22 @@ void IFETBitBlt(IFEBitmap &dbmp,int dx,int dy,int w,int h,int sx,int sy,IFEBitma
 						unsigned char *dst = dbmp.row(dy) + dx;
 						unsigned char *dms = dst + dbmp.get_transparent_mask_offset();
 
-						while (h > 0) {
-							memcpymask(dst,src,sms,w); /* mask combine pixels given source mask */
-							dst += dbmp.stride; /* NTS: buf_pitch is negative if Windows 3.1 */
-							src += sbmp.stride;
-							memcpyand(dms,sms,w); /* then combine masks */
-							dms += dbmp.stride;
-							sms += sbmp.stride;
-							h--;
+						if (sbmp.get_opaque_spans() && IFEBlitSpansPreferred(sbmp,true)) {
+							IFEBlitSpans(dst,dms,dbmp.stride,sbmp,sx,sy,w,h);
+						}
+						else {
+							while (h > 0) {
+								IFEBlitMaskRow(dst,src,sms,w); /* mask combine pixels given source mask */
+								dst += dbmp.stride; /* NTS: buf_pitch is negative if Windows 3.1 */
+								src += sbmp.stride;
+								IFEBlitAndRow(dms,sms,w); /* then combine masks */
+								dms += dbmp.stride;
+								sms += sbmp.stride;
+								h--;
+							}
 						}
+
+						dbmp.invalidate_opaque_spans();
 					}
 					break;
 				default:
@@ -621,12 +439,17 @@ void IFETBitBlt(IFEBitmap &dbmp,int dx,int dy,int w,int h,int sx,int sy,IFEBitma
 
 						unsigned char *dst = dbmp.row(dy) + dx;
 
-						while (h > 0) {
-							memcpymask(dst,src,msk,w);
-							dst += dbmp.stride; /* NTS: buf_pitch is negative if Windows 3.1 */
-							src += sbmp.stride;
-							msk += sbmp.stride;
-							h--;
+						if (sbmp.get_opaque_spans() && IFEBlitSpansPreferred(sbmp,false)) {
+							IFEBlitSpans(dst,NULL,dbmp.stride,sbmp,sx,sy,w,h);
+						}
+						else {
+							while (h > 0) {
+								IFEBlitMaskRow(dst,src,msk,w);
+								dst += dbmp.stride; /* NTS: buf_pitch is negative if Windows 3.1 */
+								src += sbmp.stride;
+								msk += sbmp.stride;
+								h--;
+							}
 						}
 					}
 					break;
@@ -769,6 +592,7 @@ void IFECheckEvent(void) {
 }
 
 void IFEWaitEvent(const int wait_ms) {
+	IFEAssetIdle();
 	ifeapi->WaitEvent(wait_ms);
 	IFEUpdateCursor();
 	ifeapi->UpdateScreen();
@@ -797,6 +621,261 @@ int PASCAL WinMain(HINSTANCE hInstance,HINSTANCE hPrevInstance/*doesn't mean any
 }
 #endif
 
+/* -bench: time per frame of a few typical redraw patterns, presenting the update region
+ * against presenting the whole screen every frame. The SDL2 build can run this without a
+ * display with SDL_VIDEODRIVER=dummy */
+static const char *IFEBenchNames[] = { "cursor", "sprites", "textline", "full" };
+
+static void IFEBenchSpritePos(const unsigned int i,const unsigned int frame,int &x,int &y) {
+	IFEBitmap &scr = IFEGetScreenBitmap();
+
+	x = (int)(((i * 53u) + (frame * (1u + (i % 3u)))) % (scr.width - 32u));
+	y = (int)(((i * 37u) + (frame * (1u + (i % 2u)))) % (scr.height - 32u));
+}
+
+static void IFEBenchFrame(const unsigned int which,const unsigned int frame) {
+	IFEBitmap &scr = IFEGetScreenBitmap();
+	unsigned int i;
+	int x,y;
+
+	/* the cursor moves in every case */
+	priv_IFEMoveCursor((int)((frame * 7u) % scr.width),(int)((frame * 3u) % scr.height));
+
+	switch (which) {
+		case 1: /* sprites moving around, erase and redraw */
+			IFEHideCursorDrawing(true);
+			for (i=0;i < 12u;i++) {
+				if (frame != 0u) {
+					IFEBenchSpritePos(i,frame-1u,x,y);
+					IFEFillRect(scr,x,y,x+32,y+32,0);
+					IFEAddScreenUpdate(x,y,x+32,y+32);
+				}
+				IFEBenchSpritePos(i,frame,x,y);
+				IFEFillRect(scr,x,y,x+32,y+32,(uint8_t)(16u + i));
+				IFEAddScreenUpdate(x,y,x+32,y+32);
+			}
+			IFEHideCursorDrawing(false);
+			break;
+		case 2: /* one line of text redrawn, i.e. a status line */
+			IFEHideCursorDrawing(true);
+			for (i=0;i < 70u;i++) {
+				x = 40 + (int)(i * 8u);
+				IFEFillRect(scr,x,440,x+8,456,(uint8_t)((i + frame) & 0xFFu));
+			}
+			IFEAddScreenUpdate(40,440,40+(70*8),456);
+			IFEHideCursorDrawing(false);
+			break;
+		case 3: /* everything */
+			IFEHideCursorDrawing(true);
+			IFETestRGBPalettePattern(scr);
+			IFEAddScreenUpdate(0,0,(int)scr.width,(int)scr.height);
+			IFEHideCursorDrawing(false);
+			break;
+		default:
+			break;
+	}
+}
+
+void IFEScreenUpdateBenchmark(void) {
+	const unsigned int cases = sizeof(IFEBenchNames) / sizeof(IFEBenchNames[0]);
+	unsigned int frames[sizeof(IFEBenchNames) / sizeof(IFEBenchNames[0])][2];
+	uint32_t ms[sizeof(IFEBenchNames) / sizeof(IFEBenchNames[0])][2];
+	unsigned int which,mode,frame;
+	uint32_t t;
+
+	ifeapi->InitVideo();
+	ifeapi->SetWindowTitle("Screen update benchmark");
+	IFETestRGBPalette();
+	IFESetCursor(&IFEcursor_arrow);
+	IFEShowCursor(true);
+
+	for (which=0;which < cases;which++) {
+		for (mode=0;mode < 2;mode++) { /* 0 = whole screen, 1 = update region */
+			IFEHideCursorDrawing(true);
+			IFEBlankScreen(IFEGetScreenBitmap());
+			IFEHideCursorDrawing(false);
+			ifeapi->UpdateFullScreen();
+
+			frame = 0;
+			ifeapi->ResetTicks(ifeapi->GetTicks());
+			do {
+				ifeapi->CheckEvents();
+				if (ifeapi->UserWantsToQuit()) IFENormalExit();
+
+				IFEBenchFrame(which,frame++);
+				if (mode == 0)
+					ifeapi->UpdateFullScreen();
+				else
+					ifeapi->UpdateScreen();
+			} while ((t=ifeapi->GetTicks()) < 1000u);
+
+			frames[which][mode] = frame;
+			ms[which][mode] = t;
+		}
+	}
+
+	IFEShowCursor(false);
+	ifeapi->ShutdownVideo();
+	IFEscrbmp = NULL;
+
+	printf("Screen update benchmark, %s\n",ifeapi->name);
+	printf("%-10s %14s %14s\n","case","full us/frame","region us/frame");
+	for (which=0;which < cases;which++) {
+		printf("%-10s %14.1f %14.1f\n",IFEBenchNames[which],
+			((double)ms[which][0] * 1000.0) / (double)frames[which][0],
+			((double)ms[which][1] * 1000.0) / (double)frames[which][1]);
+	}
+}
+
+/* -assetbench: a scripted walk through scenes that each have their own backdrop, timing every
+ * frame. The first pass loads the backdrop with IFELoadPNG() when the scene starts. The second
+ * gets it from the asset cache, which was asked to prefetch it when the scene before started.
+ * The cache is kept smaller than all the backdrops so that it has to evict along the way.
+ * The time between frames should be IFEAssetBenchFrameMs, anything much longer is a hitch.
+ * Frames are timed with GetMicroTicks(), the backdrops here decode in well under a frame on a
+ * modern host so "-assetbench <ms>" adds that much to every load to make the hitch visible.
+ * Both passes load through IFEAssetBenchLoadPNG(), the cache as its loader, so the time is
+ * added the same way whether the main thread or the loader thread does the decoding. */
+struct IFEAssetBenchScene {
+	const char*		path;
+	uint8_t			bias;
+};
+
+static const IFEAssetBenchScene IFEAssetBenchScenes[] = {
+	{"test1.png",		0},
+	{"ariarl2.png",		0},
+	{"woo1.png",		0},
+	{"test1.png",		64},
+	{"ariailg.png",		0},
+	{"ariarlg.png",		0}
+};
+
+static const char *IFEAssetBenchModes[] = { "IFELoadPNG", "asset cache" };
+
+#define IFEAssetBenchFrameMs		16u
+#define IFEAssetBenchSceneFrames	15u
+#define IFEAssetBenchRounds		2u
+
+static uint32_t IFEAssetBenchLoadDelayMs = 0;
+
+/* IFELoadPNG(), then busy for the rest of IFEAssetBenchLoadDelayMs like a slow decoder would be */
+static bool IFEAssetBenchLoadPNG(IFEBitmap &bmp,const char *path) {
+	const uint32_t load_begin = ifeapi->GetMicroTicks();
+	const bool res = IFELoadPNG(bmp,path);
+
+	while ((ifeapi->GetMicroTicks() - load_begin) < (IFEAssetBenchLoadDelayMs * 1000ul)) { }
+
+	return res;
+}
+
+void IFEAssetBenchmark(const uint32_t load_delay_ms) {
+	const unsigned int scenes = sizeof(IFEAssetBenchScenes) / sizeof(IFEAssetBenchScenes[0]);
+	uint32_t max_us[2],switch_us[2],t,begin,prev;
+	double total_us[2];
+	unsigned int late[2],frames[2];
+	unsigned int mode,scene,frame;
+	IFEAssetStats st;
+	IFEBitmap loaded;
+	int x,y,px = 0,py = 0;
+
+	IFEAssetBenchLoadDelayMs = load_delay_ms;
+	if (!IFEAssetInit(512ul * 1024ul,IFEAssetBenchLoadPNG))
+		IFEFatalError("Asset cache init failed");
+
+	ifeapi->InitVideo();
+	ifeapi->SetWindowTitle("Scene switch benchmark");
+
+	for (mode=0;mode < 2;mode++) {
+		IFEBitmap *bmp = NULL;
+
+		max_us[mode] = switch_us[mode] = 0;
+		total_us[mode] = 0;
+		late[mode] = frames[mode] = 0;
+		if (mode == 1) IFEAssetPrefetch(IFEAssetBenchScenes[0].path,IFEAssetBenchScenes[0].bias);
+
+		prev = ifeapi->GetMicroTicks();
+		for (scene=0;scene < (scenes * IFEAssetBenchRounds);scene++) {
+			const IFEAssetBenchScene &sc = IFEAssetBenchScenes[scene % scenes];
+			const IFEAssetBenchScene &next = IFEAssetBenchScenes[(scene + 1u) % scenes];
+
+			for (frame=0;frame < IFEAssetBenchSceneFrames;frame++) {
+				ifeapi->CheckEvents();
+				if (ifeapi->UserWantsToQuit()) IFENormalExit();
+
+				begin = ifeapi->GetMicroTicks();
+				t = begin - prev;
+				prev = begin;
+				if (frames[mode] != 0u) {
+					if (max_us[mode] < t) max_us[mode] = t;
+					if (t > ((IFEAssetBenchFrameMs + (IFEAssetBenchFrameMs / 2u)) * 1000ul)) late[mode]++;
+					total_us[mode] += (double)t;
+				}
+				frames[mode]++;
+
+				if (frame == 0) {
+					if (mode == 0) {
+						if (!IFEAssetBenchLoadPNG(loaded,sc.path))
+							IFEFatalError("Unable to load %s",sc.path);
+						if (sc.bias != 0 && !loaded.bias_subrect(loaded.get_subrect(0),sc.bias))
+							IFEFatalError("Unable to bias %s",sc.path);
+						bmp = &loaded;
+					}
+					else {
+						if (bmp != NULL) IFEAssetRelease(bmp);
+						if ((bmp=IFEAssetGet(sc.path,sc.bias)) == NULL)
+							IFEFatalError("Unable to load %s",sc.path);
+						IFEAssetPrefetch(next.path,next.bias);
+					}
+
+					IFEBlankScreen(IFEGetScreenBitmap());
+					if (bmp->palette != NULL) ifeapi->SetPaletteColors(0,bmp->palette_size,bmp->palette);
+					IFEBitBlt(IFEGetScreenBitmap(),/*dest*/0,0,/*width,height*/bmp->width,bmp->height,/*source*/0,0,*bmp);
+					IFEAddScreenUpdate(0,0,(int)IFEGetScreenBitmap().width,(int)IFEGetScreenBitmap().height);
+				}
+				else {
+					/* something moving over the backdrop */
+					IFEBitBlt(IFEGetScreenBitmap(),/*dest*/px,py,/*width,height*/32,32,/*source*/px,py,*bmp);
+					IFEAddScreenUpdate(px,py,px+32,py+32);
+				}
+
+				x = (int)((frame * 9u) % (bmp->width > 32u ? bmp->width - 32u : 1u));
+				y = (int)((frame * 5u) % (bmp->height > 32u ? bmp->height - 32u : 1u));
+				IFEFillRect(IFEGetScreenBitmap(),x,y,x+32,y+32,(uint8_t)(frame + 1u));
+				IFEAddScreenUpdate(x,y,x+32,y+32);
+				px = x;
+				py = y;
+
+				ifeapi->UpdateScreen();
+				t = ifeapi->GetMicroTicks() - begin;
+				if (frame == 0 && switch_us[mode] < t)
+					switch_us[mode] = t;
+
+				while ((ifeapi->GetMicroTicks() - begin) < (IFEAssetBenchFrameMs * 1000ul))
+					IFEWaitEvent(1);
+			}
+		}
+
+		if (mode == 1 && bmp != NULL) IFEAssetRelease(bmp);
+	}
+
+	IFEAssetGetStats(st);
+	ifeapi->ShutdownVideo();
+	IFEscrbmp = NULL;
+	IFEAssetShutdown();
+
+	printf("Scene switch benchmark, %s, %u scenes, %u ms frames, %lu ms added to every PNG load\n",
+		ifeapi->name,scenes * IFEAssetBenchRounds,IFEAssetBenchFrameMs,(unsigned long)load_delay_ms);
+	printf("%-12s %12s %12s %12s %12s\n","backdrop","avg ms","max ms","late frames","switch ms");
+	for (mode=0;mode < 2;mode++) {
+		printf("%-12s %12.3f %12.3f %12u %12.3f\n",IFEAssetBenchModes[mode],
+			(total_us[mode] / (double)(frames[mode] - 1u)) / 1000.0,(double)max_us[mode] / 1000.0,late[mode],
+			(double)switch_us[mode] / 1000.0);
+	}
+	printf("switch ms is the longest a scene switch frame took to draw, before waiting for the next frame\n");
+	printf("Asset cache: %lu hits, %lu waits, %lu misses, %lu evictions, %lu/%lu bytes at the end\n",
+		st.hits,st.waits,st.misses,st.evictions,st.bytes,st.max_bytes);
+}
+
 int main(int argc,char **argv) {
 	if (!priv_IFEMainInit(argc,argv))
 		return 1;
@@ -811,6 +890,15 @@ int main(int argc,char **argv) {
 		r.offset_y = (short int)(-r.r.h / 2);
 	}
 
+	if (argc > 1 && !strcmp(argv[1],"-bench")) {
+		IFEScreenUpdateBenchmark();
+		return 0;
+	}
+	if (argc > 1 && !strcmp(argv[1],"-assetbench")) {
+		IFEAssetBenchmark(argc > 2 ? (uint32_t)strtoul(argv[2],NULL,0) : 0u);
+		return 0;
+	}
+
 	ifeapi->InitVideo();
 	ifeapi->SetWindowTitle("Testing 123");
 
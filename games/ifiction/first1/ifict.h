@@ -51,6 +51,7 @@ typedef bool ifefunc_SetHostStdCursor_t(const unsigned int id);
 typedef bool ifefunc_ShowHostStdCursor_t(const bool show);
 typedef bool ifefunc_SetWindowTitle_t(const char *msg);
 typedef IFEBitmap *ifefunc_GetScreenBitmap_t(void);
+typedef uint32_t ifefunc_GetMicroTicks_t(void);
 
 struct ifeapi_t {
 	const char*						name;
@@ -78,6 +79,7 @@ struct ifeapi_t {
 	ifefunc_ShowHostStdCursor_t*				ShowHostStdCursor;
 	ifefunc_SetWindowTitle_t*				SetWindowTitle;
 	ifefunc_GetScreenBitmap_t*				GetScreenBitmap; /* after video init, code is expected to call once and cache pointer until video shutdown */
+	ifefunc_GetMicroTicks_t*				GetMicroTicks; /* free running microseconds for timing short intervals, wraps, use differences only */
 };
 
 extern ifeapi_t *ifeapi;
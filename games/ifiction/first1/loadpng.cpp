@@ -0,0 +1,174 @@
+#if defined(USE_WIN32)
+# include <windows.h>
+#endif
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ifict.h"
+#include "bitmap.h"
+#include "assetcache.h"
+
+#if defined(TARGET_MSDOS)
+#include <ext/zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+extern "C" {
+#include <fmt/minipng/minipng.h>
+}
+
+/* load one PNG into ONE bitmap, that's it */
+bool IFELoadPNG(IFEBitmap &bmp,const char *path) {
+	bool res = false,transparency = false;
+	struct minipng_reader *rdr = NULL;
+	unsigned int alloc_w;
+	unsigned int i;
+
+	if ((rdr=minipng_reader_open(path)) == NULL)
+		goto done;
+	if (minipng_reader_parse_head(rdr))
+		goto done;
+	if (rdr->ihdr.width > 2048 || rdr->ihdr.width < 1 || rdr->ihdr.height > 2048 || rdr->ihdr.height < 1)
+		goto done;
+	if (rdr->ihdr.color_type != 3) /* PNG_COLOR_TYPE_PALETTE = PNG_COLOR_MASK_COLOR | PNG_COLOR_MASK_PALETTE */
+		goto done;
+
+	if (rdr->trns != NULL && rdr->trns_size != 0) {
+		for (i=0;i < rdr->trns_size;i++) {
+			if (!(rdr->trns[i] & 0x80)) {
+				transparency = true;
+			}
+		}
+	}
+
+	switch (rdr->ihdr.bit_depth) {
+		case 8:
+			alloc_w = rdr->ihdr.width;
+			break;
+		case 4:
+			alloc_w = (rdr->ihdr.width + 1u) & (~1u); /* round up to multiple of 2 */
+			break;
+		case 1:
+			alloc_w = (rdr->ihdr.width + 7u) & (~7u); /* round up to multiple of 8 */
+			break;
+		default:
+			goto done;
+	};
+
+	/* transparency is accomplished by allocating twice the width,
+	 * making the right hand side the mask and the left hand the image */
+
+	if (!bmp.alloc_subrects(1))
+		goto done;
+	if (!bmp.alloc_storage(alloc_w, rdr->ihdr.height, transparency ? IFEBitmap::IMT_TRANSPARENT_MASK : IFEBitmap::IMT_OPAQUE))
+		goto done;
+
+	/* reset bitmap width to what we intended */
+	if (bmp.width < rdr->ihdr.width)
+		goto done;
+
+	bmp.width = rdr->ihdr.width;
+	bmp.reset_scissor_rect();
+
+	if (rdr->ihdr.bit_depth >= 1 && rdr->ihdr.bit_depth <= 8) {
+		if (rdr->plte == NULL)
+			goto done;
+		if (!bmp.alloc_palette(1u << rdr->ihdr.bit_depth))
+			goto done;
+
+		i=0;
+		while (i < bmp.palette_alloc && i < rdr->plte_count) {
+			bmp.palette[i].r = rdr->plte[i].red;
+			bmp.palette[i].g = rdr->plte[i].green;
+			bmp.palette[i].b = rdr->plte[i].blue;
+			i++;
+		}
+		while (i < bmp.palette_alloc) {
+			bmp.palette[i].r = 0;
+			bmp.palette[i].g = 0;
+			bmp.palette[i].b = 0;
+			i++;
+		}
+
+		bmp.palette_size = rdr->plte_count;
+	}
+	else {
+		bmp.free_palette();
+	}
+
+	{
+		IFEBitmap::subrect &sr = bmp.get_subrect(0);
+		sr.reset();
+		sr.r.w = rdr->ihdr.width;
+		sr.r.h = rdr->ihdr.height;
+		sr.r.x = 0;
+		sr.r.y = 0;
+
+		if (rdr->ihdr.bit_depth == 8) {
+			unsigned char *ptr = bmp.bitmap;
+
+			for (i=0;i < bmp.height;i++) {
+				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
+				minipng_reader_read_idat(rdr,ptr,rdr->ihdr.width); /* row */
+				ptr += bmp.stride;
+			}
+		}
+		else if (rdr->ihdr.bit_depth == 4) {
+			unsigned char *ptr = bmp.bitmap;
+
+			for (i=0;i < bmp.height;i++) {
+				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
+				minipng_reader_read_idat(rdr,ptr,(rdr->ihdr.width+1u)/2u); /* row */
+				minipng_expand4to8(ptr,rdr->ihdr.width);
+				ptr += bmp.stride;
+			}
+		}
+		else if (rdr->ihdr.bit_depth == 1) {
+			unsigned char *ptr = bmp.bitmap;
+
+			for (i=0;i < bmp.height;i++) {
+				minipng_reader_read_idat(rdr,ptr,1); /* pad byte */
+				minipng_reader_read_idat(rdr,ptr,(rdr->ihdr.width+7u)/8u); /* row */
+				minipng_expand1to8(ptr,rdr->ihdr.width);
+				ptr += bmp.stride;
+			}
+		}
+		else {
+			memset(bmp.bitmap,0,bmp.stride * bmp.height);
+		}
+
+		if (transparency) {
+			/* NTS: Remember the bitmap allocated is twice the width of the PNG, mask starts on right hand side */
+			unsigned int x;
+			unsigned char *ptr = bmp.bitmap;
+			unsigned char *msk = ptr + bmp.get_transparent_mask_offset();
+
+			assert((bmp.get_transparent_mask_offset() + bmp.width) <= abs(bmp.stride));
+
+			for (i=0;i < bmp.height;i++) {
+				for (x=0;x < rdr->ihdr.width;x++) {
+					if (ptr[x] < rdr->trns_size && !(rdr->trns[ptr[x]] & 0x80)) {
+						msk[x] = 0xFF; /* transparent ((dst AND msk) + src) == dst */
+						ptr[x] = 0x00; /* for this to work, make sure src == 0 */
+					}
+					else {
+						msk[x] = 0x00; /* opaque ((dst AND msk) + src) == src */
+					}
+				}
+				ptr += bmp.stride;
+				msk += bmp.stride;
+			}
+		}
+
+		res = true;
+	}
+
+done:
+        minipng_reader_close(&rdr);
+	return res;
+}
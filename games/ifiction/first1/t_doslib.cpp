@@ -21,6 +21,7 @@
 #include "debug.h"
 #include "fatal.h"
 #include "palette.h"
+#include "updrgn.h"
 
 static inline bool vesa_ispowerof2(const unsigned int x) {
 	/* NTS:
@@ -46,9 +47,7 @@ bool				opt_nopmwf = false; /* disable VBE 2.0 protected mode window bank switch
 bool				opt_normwf = false; /* disable VBE 1.x real mode window bank switch call */
 
 /* update region management */
-unsigned int			upd_ystep = 8;
-SCR_Rect*			upd_yspan = NULL;
-size_t				upd_yspan_size = 0;
+IFEUpdateRegion			upd_region;
 
 unsigned char*			vesa_non_lfb = NULL;
 unsigned char*			vesa_lfb = NULL; /* video memory, linear framebuffer */
@@ -231,12 +230,16 @@ static void p_SetPaletteColors(const unsigned int first,const unsigned int count
 	}
 }
 
+static void p_UpdatePITCount(void) {
+	uint16_t pit_cur = read_8254(T8254_TIMER_INTERRUPT_TICK);
+	pit_count += (uint32_t)((uint16_t)(pit_prev - pit_cur)); /* 8254 counts DOWN, not UP, typecast to ensure 16-bit rollover */
+	pit_prev = pit_cur;
+}
+
 static uint32_t p_GetTicks(void) {
 	uint32_t w,p;
 	{
-		uint16_t pit_cur = read_8254(T8254_TIMER_INTERRUPT_TICK);
-		pit_count += (uint32_t)((uint16_t)(pit_prev - pit_cur)); /* 8254 counts DOWN, not UP, typecast to ensure 16-bit rollover */
-		pit_prev = pit_cur;
+		p_UpdatePITCount();
 
 		/* convert ticks to milliseconds */
 		w = pit_count / (uint32_t)T8254_REF_CLOCK_HZ;
@@ -252,6 +255,20 @@ static void p_ResetTicks(const uint32_t base) {
 	pit_count -= ((base % (uint32_t)1000ul) * (uint32_t)T8254_REF_CLOCK_HZ) / (uint32_t)1000ul;
 }
 
+/* NTS: Counts from the same pit_count, do not compare values from before and after ResetTicks */
+static uint32_t p_GetMicroTicks(void) {
+	uint32_t w,r;
+
+	p_UpdatePITCount();
+
+	/* convert ticks to microseconds, in steps so that nothing overflows 32 bits */
+	w = pit_count / (uint32_t)T8254_REF_CLOCK_HZ;
+	r = (pit_count % (uint32_t)T8254_REF_CLOCK_HZ) * (uint32_t)1000ul;
+	return (w * (uint32_t)1000000ul) +
+		((r / (uint32_t)T8254_REF_CLOCK_HZ) * (uint32_t)1000ul) +
+		(((r % (uint32_t)T8254_REF_CLOCK_HZ) * (uint32_t)1000ul) / (uint32_t)T8254_REF_CLOCK_HZ);
+}
+
 static void vesa_windowed_memcpy(uint32_t o/*target*/,const unsigned char *src,uint32_t cpy) {
 	const uint32_t win_granularity_mask = ((uint32_t)1u << (uint32_t)vesa_window_shr) - (uint32_t)1;
 	unsigned char *dst;
@@ -284,16 +301,13 @@ static void vesa_windowed_memcpy(uint32_t o/*target*/,const unsigned char *src,u
 }
 
 static void p_UpdateFullScreen(void) {
-	size_t i;
-
 	if (vesa_use_lfb)
 		memcpy(vesa_lfb,vesa_lfb_offscreen,vesa_lfb_map_size);
 	else
 		vesa_windowed_memcpy(0/*target linear vram address*/,vesa_lfb_offscreen,vesa_lfb_map_size);
 
-	/* clear update region list */
-	for (i=0;i < upd_yspan_size;i++)
-		upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
+	/* clear update region */
+	upd_region.clear();
 }
 
 static ifevidinfo_t* p_GetVidInfo(void) {
@@ -582,11 +596,7 @@ static void p_ShutdownVideo(void) {
 		}
 	}
 
-	upd_yspan_size = 0;
-	if (upd_yspan) {
-		free(upd_yspan);
-		upd_yspan = NULL;
-	}
+	upd_region.free_storage();
 	keybirq_unhook();
 	_sti();
 	if (vesa_lfb_offscreen != NULL) {
@@ -606,8 +616,6 @@ static void p_ShutdownVideo(void) {
 }
 
 static void p_InitVideo(void) {
-	size_t i;
-
 	/* IBM PC/AT compatible */
 	/* Find 640x480 256-color mode.
 	 * Linear framebuffer required (we'll support older bank switched stuff later) */
@@ -740,15 +748,8 @@ static void p_InitVideo(void) {
 		ifevidinfo_doslib.buf_pitch = ifevidinfo_doslib.vram_pitch = vesa_lfb_stride;
 		ifevidinfo_doslib.buf_alloc = ifevidinfo_doslib.buf_size = ifevidinfo_doslib.vram_size = vesa_lfb_map_size;
 
-		upd_yspan_size = (ifevidinfo_doslib.height + upd_ystep - 1) / upd_ystep;
-		upd_yspan = (SCR_Rect*)malloc(sizeof(SCR_Rect) * upd_yspan_size);
-		if (upd_yspan == NULL)
-			IFEFatalError("Cannot update yspans");
-
-		for (i=0;i < upd_yspan_size;i++) {
-			upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-			upd_yspan[i].y = (int)(i * upd_ystep);
-		}
+		if (!upd_region.alloc_storage(ifevidinfo_doslib.width,ifevidinfo_doslib.height))
+			IFEFatalError("Cannot allocate update region");
 
 		/* use 8-bit DAC if available */
 		if (vbe_info->capabilities & VBE_CAP_8BIT_DAC) {
@@ -1072,86 +1073,35 @@ void SCR_UpdateWindowSurfaceRect(SCR_Rect *r) {
 	}
 }
 
-void SCR_UpdateWindowSurfaceRects(SCR_Rect *r,size_t count) {
-	size_t i;
-
-	for (i=0;i < count;i++)
-		SCR_UpdateWindowSurfaceRect(r+i);
-}
-
 void p_UpdateScreen(void) {
 #define MAX_RUPD 32
-	SCR_Rect rupd[MAX_RUPD];
-	size_t rupdi=0;
+	iferect_t ur[MAX_RUPD];
 	SCR_Rect r;
-	size_t i;
-
-	/* draw spans as needed, clear them as well */
-	for (i=0;i < upd_yspan_size;) {
-		if (upd_yspan[i].h != 0) { /* update span exists */
-			r = upd_yspan[i];
-			upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-			i++;
-
-			/* combine with rects that have the same horizontal span */
-			while (i < upd_yspan_size && upd_yspan[i].x == r.x && upd_yspan[i].w == r.w) {
-				r.h += upd_yspan[i].h;
-				upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-				i++;
-			}
+	size_t rupdi,i;
 
-			if (rupdi >= MAX_RUPD) {
-				SCR_UpdateWindowSurfaceRects(rupd,rupdi);
-				rupdi = 0;
-			}
-			rupd[rupdi++] = r;
-		}
-		else {
-			i++;
-		}
+	if (upd_region.empty())
+		return;
+
+	/* if most of the screen changed, one straight copy is cheaper than many */
+	if (upd_region.area() >= ((unsigned long)ifevidinfo_doslib.width * (unsigned long)ifevidinfo_doslib.height * 3ul) / 4ul) {
+		p_UpdateFullScreen();
+		return;
 	}
 
-	if (rupdi > 0) {
-		SCR_UpdateWindowSurfaceRects(rupd,rupdi);
+	while ((rupdi=upd_region.get_rects(ur,MAX_RUPD)) != 0) {
+		for (i=0;i < rupdi;i++) {
+			r.x = ur[i].x;
+			r.y = ur[i].y;
+			r.w = ur[i].w;
+			r.h = ur[i].h;
+			SCR_UpdateWindowSurfaceRect(&r);
+		}
 	}
 #undef MAX_RUPD
 }
 
 void p_AddScreenUpdate(int x1,int y1,int x2,int y2) {
-	if (x1 < 0) x1 = 0;
-	if (y1 < 0) y1 = 0;
-
-	if ((unsigned int)x2 > ifevidinfo_doslib.width)
-		x2 = ifevidinfo_doslib.width;
-	if ((unsigned int)y2 > ifevidinfo_doslib.height)
-		y2 = ifevidinfo_doslib.height;
-
-	if (x1 >= x2 || y1 >= y2) return;
-
-	y1 = y1 / (int)upd_ystep;
-	y2 = (y2 + (int)upd_ystep - 1) / (int)upd_ystep;
-
-	if ((size_t)y2 > upd_yspan_size)
-		IFEFatalError("UpdateScreen region bug");
-
-	while ((unsigned int)y1 < (unsigned int)y2) {
-		if (upd_yspan[(size_t)y1].h == 0) {
-			upd_yspan[(size_t)y1].w = x2-x1;
-			upd_yspan[(size_t)y1].h = upd_ystep;
-			upd_yspan[(size_t)y1].x = x1;
-		}
-		else {
-			if (upd_yspan[(size_t)y1].x > x1) {
-				const unsigned int orig_x = upd_yspan[(size_t)y1].x;
-				upd_yspan[(size_t)y1].x = x1;
-				upd_yspan[(size_t)y1].w += orig_x - x1;
-			}
-			if ((upd_yspan[(size_t)y1].x+upd_yspan[(size_t)y1].w) < x2) {
-				upd_yspan[(size_t)y1].w = x2-upd_yspan[(size_t)y1].x;
-			}
-		}
-		y1++;
-	}
+	upd_region.add(x1,y1,x2,y2);
 }
 
 static bool p_SetHostStdCursor(const unsigned int id) {
@@ -1198,7 +1148,8 @@ ifeapi_t ifeapi_doslib = {
 	p_SetHostStdCursor,
 	p_ShowHostStdCursor,
 	p_SetWindowTitle,
-	p_GetScreenBitmap
+	p_GetScreenBitmap,
+	p_GetMicroTicks
 };
 #endif
 
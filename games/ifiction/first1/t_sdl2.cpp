@@ -19,8 +19,7 @@
 #include "debug.h"
 #include "fatal.h"
 #include "palette.h"
-
-#include <vector>
+#include "updrgn.h"
 
 SDL_Window*			sdl_window = NULL;
 SDL_Surface*			sdl_window_surface = NULL;
@@ -47,8 +46,7 @@ SDL_FingerID			touchscreen_finger_lock = no_finger_id;
 SDL_TouchID			touchscreen_touch_lock = no_touch_id;
 
 /* update region management */
-unsigned int			upd_ystep = 8;
-std::vector<SDL_Rect>		upd_yspan;
+IFEUpdateRegion			upd_region;
 
 /* IFEBitmap subclass for the screen */
 class IFESDLBitmap : public IFEScreenBitmap {
@@ -123,18 +121,23 @@ static void p_ResetTicks(const uint32_t base) {
 	sdl_ticks_base += base; /* NTS: Use return value of IFEGetTicks() */
 }
 
-static void p_UpdateFullScreen(void) {
-	size_t i;
+static uint32_t p_GetMicroTicks(void) {
+	const Uint64 c = SDL_GetPerformanceCounter();
+	const Uint64 f = SDL_GetPerformanceFrequency();
+
+	/* split so that c * 1000000 cannot overflow */
+	return uint32_t(((c / f) * Uint64(1000000u)) + (((c % f) * Uint64(1000000u)) / f));
+}
 
+static void p_UpdateFullScreen(void) {
 	if (SDL_BlitSurface(sdl_game_surface,NULL,sdl_window_surface,NULL) != 0)
 		IFEFatalError("Game to window BlitSurface");
 
 	if (SDL_UpdateWindowSurface(sdl_window) != 0)
 		IFEFatalError("Window surface update");
 
-	/* clear update region list */
-	for (i=0;i < upd_yspan.size();i++)
-		upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
+	/* clear update region */
+	upd_region.clear();
 }
 
 static ifevidinfo_t* p_GetVidInfo(void) {
@@ -428,13 +431,11 @@ static void p_ShutdownVideo(void) {
 		SDL_FreeCursor(sdl_cursor_wait);
 		sdl_cursor_wait = NULL;
 	}
-	upd_yspan.clear();
+	upd_region.free_storage();
 	SDL_Quit();
 }
 
 static void p_InitVideo(void) {
-	size_t i;
-
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 		IFEFatalError("SDL2 failed to initialize");
 
@@ -449,11 +450,8 @@ static void p_InitVideo(void) {
 	ifevidinfo_sdl2.width = 640;
 	ifevidinfo_sdl2.height = 480;
 
-	upd_yspan.resize((ifevidinfo_sdl2.height + upd_ystep - 1) / upd_ystep);
-	for (i=0;i < upd_yspan.size();i++) {
-		upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-		upd_yspan[i].y = (int)(i * upd_ystep);
-	}
+	if (!upd_region.alloc_storage(ifevidinfo_sdl2.width,ifevidinfo_sdl2.height))
+		IFEFatalError("SDL2 update region");
 
 	if (sdl_window == NULL && (sdl_window=SDL_CreateWindow("",SDL_WINDOWPOS_CENTERED,SDL_WINDOWPOS_CENTERED,640,480,SDL_WINDOW_SHOWN)) == NULL)
 		IFEFatalError("SDL2 window creation failed");
@@ -529,83 +527,38 @@ IFEMouseEvent *p_GetMouseInput(void) {
 
 void p_UpdateScreen(void) {
 #define MAX_RUPD 32
+	iferect_t ur[MAX_RUPD];
 	SDL_Rect rupd[MAX_RUPD];
-	size_t rupdi=0;
-	SDL_Rect r;
-	size_t i;
-
-	/* draw spans as needed, clear them as well */
-	for (i=0;i < upd_yspan.size();) {
-		if (upd_yspan[i].h != 0) { /* update span exists */
-			r = upd_yspan[i];
-			upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-			i++;
-
-			/* combine with rects that have the same horizontal span */
-			while (i < upd_yspan.size() && upd_yspan[i].x == r.x && upd_yspan[i].w == r.w) {
-				r.h += upd_yspan[i].h;
-				upd_yspan[i].x = upd_yspan[i].w = upd_yspan[i].h = 0;
-				i++;
-			}
+	size_t rupdi,i;
 
-			if (SDL_BlitSurface(sdl_game_surface,&r,sdl_window_surface,&r) != 0)
-				IFEFatalError("Game to window BlitSurface");
+	if (upd_region.empty())
+		return;
+
+	/* if most of the screen changed, one blit is cheaper than many */
+	if (upd_region.area() >= ((unsigned long)ifevidinfo_sdl2.width * (unsigned long)ifevidinfo_sdl2.height * 3ul) / 4ul) {
+		p_UpdateFullScreen();
+		return;
+	}
 
-			if (rupdi >= MAX_RUPD) {
-				if (SDL_UpdateWindowSurfaceRects(sdl_window,rupd,rupdi) != 0)
-					IFEFatalError("Window surface update");
+	while ((rupdi=upd_region.get_rects(ur,MAX_RUPD)) != 0) {
+		for (i=0;i < rupdi;i++) {
+			rupd[i].x = ur[i].x;
+			rupd[i].y = ur[i].y;
+			rupd[i].w = ur[i].w;
+			rupd[i].h = ur[i].h;
 
-				rupdi = 0;
-			}
-			rupd[rupdi++] = r;
-		}
-		else {
-			i++;
+			if (SDL_BlitSurface(sdl_game_surface,&rupd[i],sdl_window_surface,&rupd[i]) != 0)
+				IFEFatalError("Game to window BlitSurface");
 		}
-	}
 
-	if (rupdi > 0) {
-		if (SDL_UpdateWindowSurfaceRects(sdl_window,rupd,rupdi) != 0)
+		if (SDL_UpdateWindowSurfaceRects(sdl_window,rupd,(int)rupdi) != 0)
 			IFEFatalError("Window surface update");
 	}
 #undef MAX_RUPD
 }
 
 void p_AddScreenUpdate(int x1,int y1,int x2,int y2) {
-	if (x1 < 0) x1 = 0;
-	if (y1 < 0) y1 = 0;
-
-	if ((unsigned int)x2 > ifevidinfo_sdl2.width)
-		x2 = ifevidinfo_sdl2.width;
-	if ((unsigned int)y2 > ifevidinfo_sdl2.height)
-		y2 = ifevidinfo_sdl2.height;
-
-	if (x1 >= x2 || y1 >= y2) return;
-
-	y1 = y1 / (int)upd_ystep;
-	y2 = (y2 + (int)upd_ystep - 1) / (int)upd_ystep;
-
-	if ((size_t)y2 > upd_yspan.size())
-		IFEFatalError("UpdateScreen region bug");
-
-	while ((unsigned int)y1 < (unsigned int)y2) {
-		if (upd_yspan[(size_t)y1].h == 0) {
-			upd_yspan[(size_t)y1].w = x2-x1;
-			upd_yspan[(size_t)y1].h = upd_ystep;
-			upd_yspan[(size_t)y1].x = x1;
-		}
-		else {
-			if (upd_yspan[(size_t)y1].x > x1) {
-				const unsigned int orig_x = upd_yspan[(size_t)y1].x;
-				upd_yspan[(size_t)y1].x = x1;
-				upd_yspan[(size_t)y1].w += orig_x - x1;
-			}
-			if ((upd_yspan[(size_t)y1].x+upd_yspan[(size_t)y1].w) < x2) {
-				upd_yspan[(size_t)y1].w = x2-upd_yspan[(size_t)y1].x;
-			}
-		}
-		y1++;
-	}
+	upd_region.add(x1,y1,x2,y2);
 }
 
 static bool p_SetHostStdCursor(const unsigned int id) {
@@ -672,7 +625,8 @@ ifeapi_t ifeapi_sdl2 = {
 	p_SetHostStdCursor,
 	p_ShowHostStdCursor,
 	p_SetWindowTitle,
-	p_GetScreenBitmap
+	p_GetScreenBitmap,
+	p_GetMicroTicks
 };
 
 bool priv_IFEMainInit(int argc,char **argv) {
@@ -196,6 +196,11 @@ static void p_ResetTicks(const uint32_t base) {
 	win32_tick_base += base;
 }
 
+static uint32_t p_GetMicroTicks(void) {
+	/* only millisecond resolution here */
+	return uint32_t(timeGetTime()) * (uint32_t)1000ul;
+}
+
 static void p_DoUpdateFullScreen(HDC useDC=NULL) {
 	if (!is_minimized) {
 		HDC hDC = (useDC != NULL) ? useDC : GetDC(hwndMain);
@@ -583,7 +588,8 @@ ifeapi_t ifeapi_win32 = {
 	p_SetHostStdCursor,
 	p_ShowHostStdCursor,
 	p_SetWindowTitle,
-	p_GetScreenBitmap
+	p_GetScreenBitmap,
+	p_GetMicroTicks
 };
 
 void UpdateWin32ModFlags(void) {
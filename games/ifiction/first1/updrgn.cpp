@@ -0,0 +1,220 @@
+
+#if defined(USE_WIN32)
+# include <windows.h>
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ifict.h"
+#include "utils.h"
+#include "debug.h"
+#include "fatal.h"
+#include "updrgn.h"
+
+IFEUpdateRegion::IFEUpdateRegion() : spans(NULL), count(NULL), width(0), height(0), ymin(0), ymax(0) {
+}
+
+IFEUpdateRegion::~IFEUpdateRegion() {
+	free_storage();
+}
+
+bool IFEUpdateRegion::alloc_storage(unsigned int w,unsigned int h) {
+	free_storage();
+
+	if (w == 0 || h == 0 || w > 0xFFFFu)
+		return false;
+
+	spans = (span*)malloc(sizeof(span) * MaxSpans * h);
+	count = (unsigned char*)malloc(h);
+	if (spans == NULL || count == NULL) {
+		free_storage();
+		return false;
+	}
+
+	memset(count,0,h);
+	width = w;
+	height = h;
+	ymin = ymax = 0;
+	return true;
+}
+
+void IFEUpdateRegion::free_storage(void) {
+	if (spans != NULL) {
+		::free(spans);
+		spans = NULL;
+	}
+	if (count != NULL) {
+		::free(count);
+		count = NULL;
+	}
+
+	width = height = 0;
+	ymin = ymax = 0;
+}
+
+void IFEUpdateRegion::clear(void) {
+	if (ymin < ymax)
+		memset(count+ymin,0,ymax-ymin);
+
+	ymin = ymax = 0;
+}
+
+void IFEUpdateRegion::add_span(const unsigned int y,unsigned int x1,unsigned int x2) {
+	span *s = spans + (y * MaxSpans);
+	span tmp[MaxSpans+1];
+	unsigned int n = count[y],o = 0,i = 0;
+
+	/* spans left of the new one, not close enough to merge */
+	while (i < n && ((unsigned int)s[i].x2 + MergeGap) < x1)
+		tmp[o++] = s[i++];
+
+	/* spans that overlap or nearly touch become part of the new one */
+	while (i < n && (unsigned int)s[i].x1 <= (x2 + MergeGap)) {
+		if (x1 > s[i].x1) x1 = s[i].x1;
+		if (x2 < s[i].x2) x2 = s[i].x2;
+		i++;
+	}
+
+	tmp[o].x1 = (unsigned short)x1;
+	tmp[o].x2 = (unsigned short)x2;
+	o++;
+
+	while (i < n)
+		tmp[o++] = s[i++];
+
+	if (o > MaxSpans) {
+		/* too many, merge the two closest together */
+		unsigned int best = 0,gap,bestgap = ~0u;
+
+		for (i=0;(i+1) < o;i++) {
+			gap = (unsigned int)tmp[i+1].x1 - (unsigned int)tmp[i].x2;
+			if (bestgap > gap) {
+				bestgap = gap;
+				best = i;
+			}
+		}
+
+		tmp[best].x2 = tmp[best+1].x2;
+		for (i=best+1;(i+1) < o;i++)
+			tmp[i] = tmp[i+1];
+
+		o--;
+	}
+
+	memcpy(s,tmp,sizeof(span) * o);
+	count[y] = (unsigned char)o;
+}
+
+void IFEUpdateRegion::add(int x1,int y1,int x2,int y2) {
+	unsigned int y;
+
+	if (spans == NULL) return;
+
+	/* entirely left of or above the screen. checked before the unsigned compares below,
+	 * which would take a negative x2/y2 for a huge one and clip it to the screen edge */
+	if (x2 <= 0 || y2 <= 0) return;
+
+	if (x1 < 0) x1 = 0;
+	if (y1 < 0) y1 = 0;
+	if ((unsigned int)x2 > width) x2 = (int)width;
+	if ((unsigned int)y2 > height) y2 = (int)height;
+	if (x1 >= x2 || y1 >= y2) return;
+
+	for (y=(unsigned int)y1;y < (unsigned int)y2;y++)
+		add_span(y,(unsigned int)x1,(unsigned int)x2);
+
+	if (ymin >= ymax) {
+		ymin = (unsigned int)y1;
+		ymax = (unsigned int)y2;
+	}
+	else {
+		if (ymin > (unsigned int)y1) ymin = (unsigned int)y1;
+		if (ymax < (unsigned int)y2) ymax = (unsigned int)y2;
+	}
+}
+
+/* take a span from scanline y into the rectangle r (which ends at y-1) if the rectangle stays
+ * mostly pixels that need updating. 'covered' is how many of r's pixels do */
+bool IFEUpdateRegion::take_span(const unsigned int y,iferect_t &r,unsigned long &covered) {
+	span *s = spans + (y * MaxSpans);
+	const unsigned int n = count[y];
+	unsigned int i,nx1,nx2,sw;
+	unsigned long narea,ncovered;
+
+	for (i=0;i < n;i++) {
+		if ((unsigned int)s[i].x2 + MergeGap <= (unsigned int)r.x) continue;
+		if ((unsigned int)s[i].x1 >= (unsigned int)(r.x + r.w) + MergeGap) break;
+
+		nx1 = ((unsigned int)r.x < s[i].x1) ? (unsigned int)r.x : s[i].x1;
+		nx2 = ((unsigned int)(r.x + r.w) > s[i].x2) ? (unsigned int)(r.x + r.w) : s[i].x2;
+		sw = (unsigned int)s[i].x2 - (unsigned int)s[i].x1;
+		narea = (unsigned long)(nx2 - nx1) * (unsigned long)(r.h + 1);
+		ncovered = covered + sw;
+
+		if ((narea - ncovered) > ((ncovered / 4ul) + MergeGap))
+			return false;
+
+		r.x = (int)nx1;
+		r.w = (int)(nx2 - nx1);
+		r.h++;
+		covered = ncovered;
+
+		for (;(i+1) < n;i++) s[i] = s[i+1];
+		count[y]--;
+		return true;
+	}
+
+	return false;
+}
+
+size_t IFEUpdateRegion::get_rects(iferect_t *r,size_t max) {
+	unsigned long covered;
+	unsigned int y,i;
+	size_t rc = 0;
+	span *s;
+
+	while (rc < max && ymin < ymax) {
+		if (count[ymin] == 0) {
+			ymin++;
+			continue;
+		}
+
+		s = spans + (ymin * MaxSpans);
+		r[rc].x = s[0].x1;
+		r[rc].y = (int)ymin;
+		r[rc].w = (int)s[0].x2 - (int)s[0].x1;
+		r[rc].h = 1;
+		covered = (unsigned long)r[rc].w;
+
+		for (i=0;(i+1) < count[ymin];i++) s[i] = s[i+1];
+		count[ymin]--;
+
+		for (y=ymin+1;y < ymax && take_span(y,r[rc],covered);y++);
+
+		rc++;
+	}
+
+	if (ymin >= ymax)
+		ymin = ymax = 0;
+
+	return rc;
+}
+
+unsigned long IFEUpdateRegion::area(void) const {
+	unsigned long a = 0;
+	unsigned int y,i;
+	const span *s;
+
+	for (y=ymin;y < ymax;y++) {
+		s = spans + (y * MaxSpans);
+		for (i=0;i < count[y];i++)
+			a += (unsigned long)s[i].x2 - (unsigned long)s[i].x1;
+	}
+
+	return a;
+}
+
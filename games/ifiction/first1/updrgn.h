@@ -0,0 +1,47 @@
+
+#ifndef IFE_UPDRGN_H
+#define IFE_UPDRGN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* screen update region, for backends that present from an offscreen buffer.
+ * each scanline holds a short sorted list of dirty spans. spans that overlap or come within
+ * MergeGap pixels of each other are merged when added, so the cursor undraw + redraw or
+ * overlapping sprite updates turn into one span per scanline. get_rects() then stacks the
+ * spans of consecutive scanlines into rectangles. a rectangle is widened to take in the
+ * next scanline's span as long as that does not add too many pixels that did not change. */
+class IFEUpdateRegion {
+public:
+	enum {
+		MaxSpans = 4,		/* per scanline, beyond that the two closest spans are merged */
+		MergeGap = 16		/* pixels */
+	};
+	struct span {
+		unsigned short	x1,x2;	/* x1 <= x < x2 */
+	};
+public:
+	IFEUpdateRegion();
+	~IFEUpdateRegion();
+public:
+	bool alloc_storage(unsigned int w,unsigned int h);
+	void free_storage(void);
+	void clear(void);
+	void add(int x1,int y1,int x2,int y2); /* update x1 <= x < x2, y1 <= y < y2, clipped to the screen */
+	size_t get_rects(iferect_t *r,size_t max); /* take up to max rects out of the region. 0 if empty */
+	unsigned long area(void) const; /* pixels in the region */
+	inline bool empty(void) const {
+		return ymin >= ymax;
+	}
+private:
+	void add_span(const unsigned int y,unsigned int x1,unsigned int x2);
+	bool take_span(const unsigned int y,iferect_t &r,unsigned long &covered);
+private:
+	span*		spans;		/* MaxSpans per scanline */
+	unsigned char*	count;		/* spans per scanline */
+	unsigned int	width,height;
+	unsigned int	ymin,ymax;	/* scanlines ymin <= y < ymax might have spans */
+};
+
+#endif //IFE_UPDRGN_H
+
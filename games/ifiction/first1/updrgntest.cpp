@@ -0,0 +1,151 @@
+/* WARNING: For host systems only. Checks the screen update region (updrgn.cpp): adds
+ *          random rectangles, some partly or entirely off screen, and checks that the
+ *          rectangles from get_rects() cover every pixel that was added and stay on the
+ *          screen. Also checks more than MaxSpans spans on one scanline, which merges
+ *          spans, and rectangles that are entirely off screen, which must add nothing.
+ *          Not part of the game. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ifict.h"
+#include "updrgn.h"
+
+static const unsigned int scr_w = 320,scr_h = 200;
+
+static unsigned char want[scr_w*scr_h];	/* pixels added */
+static unsigned char got[scr_w*scr_h];	/* pixels covered by get_rects() */
+
+static unsigned int fails = 0;
+
+static void fail(const char *what,const unsigned int trial) {
+	fprintf(stderr,"FAIL: %s (trial %u)\n",what,trial);
+	fails++;
+}
+
+static void add_rect(IFEUpdateRegion &rgn,int x1,int y1,int x2,int y2) {
+	int x,y;
+
+	rgn.add(x1,y1,x2,y2);
+
+	if (x1 < 0) x1 = 0;
+	if (y1 < 0) y1 = 0;
+	if (x2 > (int)scr_w) x2 = (int)scr_w;
+	if (y2 > (int)scr_h) y2 = (int)scr_h;
+
+	for (y=y1;y < y2;y++) {
+		for (x=x1;x < x2;x++)
+			want[(y*scr_w)+x] = 1;
+	}
+}
+
+/* take the rects out a few at a time, the way the backends do, and check them against want[] */
+static void check_region(IFEUpdateRegion &rgn,const unsigned int trial) {
+	unsigned long wanted = 0;
+	unsigned int i,x,y;
+	iferect_t r[3];
+	size_t rc;
+
+	for (i=0;i < (scr_w*scr_h);i++)
+		wanted += want[i];
+
+	if (rgn.area() < wanted)
+		fail("area() less than the pixels added",trial);
+	if (rgn.empty() != (wanted == 0ul))
+		fail("empty() does not match the pixels added",trial);
+
+	memset(got,0,sizeof(got));
+	while ((rc=rgn.get_rects(r,3)) != 0) {
+		for (i=0;i < rc;i++) {
+			if (r[i].x < 0 || r[i].y < 0 || r[i].w <= 0 || r[i].h <= 0 ||
+				(r[i].x + r[i].w) > (int)scr_w || (r[i].y + r[i].h) > (int)scr_h) {
+				fail("rect outside the screen or empty",trial);
+				continue;
+			}
+
+			for (y=(unsigned int)r[i].y;y < (unsigned int)(r[i].y + r[i].h);y++) {
+				for (x=(unsigned int)r[i].x;x < (unsigned int)(r[i].x + r[i].w);x++)
+					got[(y*scr_w)+x] = 1;
+			}
+		}
+	}
+
+	for (i=0;i < (scr_w*scr_h);i++) {
+		if (want[i] && !got[i]) {
+			fail("added pixel not covered by get_rects()",trial);
+			break;
+		}
+	}
+
+	if (!rgn.empty())
+		fail("region not empty after get_rects()",trial);
+
+	memset(want,0,sizeof(want));
+}
+
+int main(int argc,char **argv) {
+	IFEUpdateRegion rgn;
+	unsigned int trial,i,n;
+	int x,y,w,h;
+
+	(void)argc;
+	(void)argv;
+
+	if (!rgn.alloc_storage(scr_w,scr_h)) {
+		fprintf(stderr,"alloc_storage failed\n");
+		return 1;
+	}
+
+	/* entirely off screen, on every side. nothing may be added */
+	memset(want,0,sizeof(want));
+	rgn.add(-50,-50,-10,-10);
+	rgn.add(-10,5,0,8);
+	rgn.add(5,-20,10,-1);
+	rgn.add(5,-20,10,0);
+	rgn.add((int)scr_w,5,(int)scr_w+20,8);
+	rgn.add(5,(int)scr_h,10,(int)scr_h+20);
+	rgn.add(-100000,-100000,-99990,-99990);
+	if (!rgn.empty())
+		fail("off screen rects added to the region",0);
+	check_region(rgn,0);
+
+	/* more than MaxSpans spans on a scanline, too far apart to merge on their own */
+	for (i=0;i < (IFEUpdateRegion::MaxSpans * 3u);i++) {
+		x = (int)(i * (IFEUpdateRegion::MergeGap + 9u));
+		add_rect(rgn,x,10,x+3,12);
+	}
+	for (i=0;i < (IFEUpdateRegion::MaxSpans * 3u);i++) {
+		x = (int)scr_w - 2 - (int)(i * (IFEUpdateRegion::MergeGap + 5u));
+		add_rect(rgn,x,11,x+1,13);
+	}
+	check_region(rgn,0);
+
+	/* random rectangles, some starting off screen or running off it */
+	srand(1);
+	for (trial=1;trial <= 2000;trial++) {
+		n = 1u + ((unsigned int)rand() % 40u);
+		for (i=0;i < n;i++) {
+			x = (rand() % ((int)scr_w + 120)) - 60;
+			y = (rand() % ((int)scr_h + 120)) - 60;
+			/* many narrow and short ones, so that scanlines collect more than MaxSpans spans */
+			w = 1 + (rand() % ((rand() & 1) ? 24 : (int)scr_w));
+			h = 1 + (rand() % ((rand() & 3) ? 8 : (int)scr_h));
+			add_rect(rgn,x,y,x+w,y+h);
+		}
+
+		check_region(rgn,trial);
+		if (fails >= 10) break;
+	}
+
+	rgn.free_storage();
+
+	if (fails != 0) {
+		fprintf(stderr,"FAILED\n");
+		return 1;
+	}
+
+	printf("PASS\n");
+	return 0;
+}
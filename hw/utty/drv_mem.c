@@ -0,0 +1,112 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if !defined(LINUX)
+#include <hw/dos/dos.h>
+#endif
+#include <hw/utty/utty.h>
+
+struct utty_mem_stats_t             utty_mem_stats;
+
+static UTTY_ALPHA_CHAR UTTY_FAR*    utty_mem_buf = NULL;
+static uint8_t                      utty_mem_w,utty_mem_h;
+
+// NTS: offsets advance by 2 per cell on every target, even on PC-98 where a cell is 4 bytes
+static inline UTTY_ALPHA_CHAR UTTY_FAR *_mem_cell(const utty_offset_t ofs) {
+    return utty_mem_buf + ((ofs - utty_offset_getofs(0,0)) >> 1u);
+}
+
+static void utty_mem__update_from_screen(void) {
+    utty_funcs.vram =       (UTTY_ALPHA_PTR)utty_mem_buf;
+    utty_funcs.w =          utty_mem_w;
+    utty_funcs.h =          utty_mem_h;
+    utty_funcs.stride =     utty_mem_w;
+}
+
+static UTTY_ALPHA_CHAR utty_mem__getchar(utty_offset_t ofs) {
+    return *_mem_cell(ofs);
+}
+
+static utty_offset_t utty_mem__setchar(utty_offset_t ofs,UTTY_ALPHA_CHAR ch) {
+    *_mem_cell(ofs) = ch;
+    utty_mem_stats.calls++;
+    utty_mem_stats.cells++;
+    return ofs + (utty_offset_t)2u;
+}
+
+static utty_offset_t utty_mem__getcharblock(utty_offset_t ofs,UTTY_ALPHA_CHAR *chptr,unsigned int count) {
+    UTTY_ALPHA_CHAR UTTY_FAR *p = _mem_cell(ofs);
+    unsigned int i;
+
+    for (i=0;i < count;i++) chptr[i] = p[i];
+    return utty_offset_advance(ofs,count);
+}
+
+static utty_offset_t utty_mem__setcharblock(utty_offset_t ofs,const UTTY_ALPHA_CHAR *chptr,unsigned int count) {
+    UTTY_ALPHA_CHAR UTTY_FAR *p = _mem_cell(ofs);
+    unsigned int i;
+
+    for (i=0;i < count;i++) p[i] = chptr[i];
+    utty_mem_stats.calls++;
+    utty_mem_stats.cells += count;
+    return utty_offset_advance(ofs,count);
+}
+
+static void utty_mem__scroll(utty_offset_t dofs,utty_offset_t sofs,uint8_t w,uint8_t h) {
+    utty_mem_stats.calls++;
+    utty_mem_stats.scrolls++;
+
+    if (dofs != sofs && w != 0u && h != 0u) {
+        UTTY_ALPHA_CHAR UTTY_FAR *dp = _mem_cell(dofs);
+        UTTY_ALPHA_CHAR UTTY_FAR *sp = _mem_cell(sofs);
+        int step = (int)utty_mem_w;
+        unsigned int i;
+
+        if (dofs > sofs) { /* copy bottom up */
+            dp += (h - 1u) * utty_mem_w;
+            sp += (h - 1u) * utty_mem_w;
+            step = -step;
+        }
+
+        utty_mem_stats.cells += (unsigned long)w * h;
+        do {
+            if (dofs > sofs) { for (i=w;i != 0u;) { i--; dp[i] = sp[i]; } }
+            else { for (i=0;i < w;i++) dp[i] = sp[i]; }
+            dp += step; sp += step;
+        } while ((--h) != 0u);
+    }
+}
+
+static void utty_mem__fill(utty_offset_t ofs,unsigned int count,UTTY_ALPHA_CHAR ch) {
+    UTTY_ALPHA_CHAR UTTY_FAR *p = _mem_cell(ofs);
+    unsigned int i;
+
+    for (i=0;i < count;i++) p[i] = ch;
+    utty_mem_stats.calls++;
+    utty_mem_stats.cells += count;
+}
+
+const struct utty_funcs_t utty_funcs_mem_init = {
+    .update_from_screen =               utty_mem__update_from_screen,
+    .getchar =                          utty_mem__getchar,
+    .setchar =                          utty_mem__setchar,
+    .getcharblock =                     utty_mem__getcharblock,
+    .setcharblock =                     utty_mem__setcharblock,
+    .scroll =                           utty_mem__scroll,
+    .fill =                             utty_mem__fill
+};
+
+int utty_init_mem(UTTY_ALPHA_CHAR UTTY_FAR *buf,uint8_t w,uint8_t h) {
+    if (buf == NULL || w == 0u || h == 0u) return 0;
+    utty_mem_buf = buf;
+    utty_mem_w = w;
+    utty_mem_h = h;
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    utty_funcs = utty_funcs_mem_init;
+    utty_funcs.update_from_screen();
+    return 1;
+}
+
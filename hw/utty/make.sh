@@ -10,7 +10,7 @@ doshuge=1 # MS-DOS huge
 
 if [ "$1" == "clean" ]; then
     do_clean
-    rm -fv test.dsk test2.dsk pcjrtest.dsk nul.err tmp.cmd tmp1.cmd tmp2.cmd pcx2vrl pcxsscut vrl2vrs vrsdump vrldbg *.o
+    rm -fv test.dsk test2.dsk pcjrtest.dsk nul.err tmp.cmd tmp1.cmd tmp2.cmd pcx2vrl pcxsscut vrl2vrs vrsdump vrldbg uttybnch *.o
     exit 0
 fi
 
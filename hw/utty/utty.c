@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if !defined(LINUX)
 #include <hw/dos/dos.h>
+#endif
 #include <hw/utty/utty.h>
 
 struct utty_funcs_t                 utty_funcs;
@@ -1,15 +1,22 @@
 
-#include <i86.h>
 #include <stdint.h>
 
-#ifdef TARGET_PC98
+#if defined(LINUX)
+// host build (memory driver, shadow buffer tests). no video hardware, VGA style cells.
+# include <stddef.h>
+#else
+# include <i86.h>
+#endif
+
+#if defined(LINUX)
+#elif defined(TARGET_PC98)
 # include <hw/necpc98/necpc98.h>
 #else
 # include <hw/vga/vga.h>
 # include <hw/vga2/vga2.h>
 #endif
 
-#if TARGET_MSDOS == 32
+#if defined(LINUX) || TARGET_MSDOS == 32
 # define UTTY_FAR
 #else
 # define UTTY_FAR   far
@@ -58,13 +65,15 @@ typedef union {
 /////////////////////////////////////////////////////////////////////////////
 #endif
 
+#if !defined(LINUX)
 static inline UTTY_ALPHA_PTR utty_seg2ptr(const unsigned short s) {
-#if TARGET_MSDOS == 32
+# if TARGET_MSDOS == 32
     return (UTTY_ALPHA_PTR)((unsigned int)s << 4u);
 #else
     return (UTTY_ALPHA_PTR)MK_FP(s,0);
-#endif
+# endif
 }
+#endif
 
 struct utty_funcs_t {
     UTTY_ALPHA_PTR          vram;
@@ -144,8 +153,11 @@ extern UTTY_ALPHA_CHAR              utty_tmp[16];
 # define UTTY_COLOR_WHITE               (7u)
 #endif
 
+// NTS: On the host, offsets are relative to the start of vram
 static inline utty_offset_t utty_offset_getofs(const uint8_t y,const uint8_t x) {
-#if TARGET_MSDOS == 32
+#if defined(LINUX)
+    const unsigned int ofs = 0;
+#elif TARGET_MSDOS == 32
     const unsigned int ofs = (unsigned int)(utty_funcs.vram);
 #else
     const unsigned int ofs = FP_OFF(utty_funcs.vram);
@@ -158,7 +170,9 @@ static inline utty_offset_t utty_offset_advance(const utty_offset_t o,const unsi
 }
 
 static inline UTTY_ALPHA_PTR _utty_ofs_to_ptr(const utty_offset_t o) {
-#if TARGET_MSDOS == 32
+#if defined(LINUX)
+    return (UTTY_ALPHA_PTR)((char*)utty_funcs.vram + o);
+#elif TARGET_MSDOS == 32
     return (UTTY_ALPHA_PTR)(o);
 #else
     return (UTTY_ALPHA_PTR)MK_FP(FP_SEG(utty_funcs.vram),(unsigned int)o);
@@ -166,7 +180,9 @@ static inline UTTY_ALPHA_PTR _utty_ofs_to_ptr(const utty_offset_t o) {
 }
 
 static inline utty_offset_t _utty_ptr_to_ofs(const UTTY_ALPHA_PTR o) {
-#if TARGET_MSDOS == 32
+#if defined(LINUX)
+    return (utty_offset_t)((char*)o - (char*)utty_funcs.vram);
+#elif TARGET_MSDOS == 32
     return (utty_offset_t)(o);
 #else
     return (utty_offset_t)FP_OFF(o);
@@ -197,12 +213,36 @@ unsigned int utty_string2ac_const(UTTY_ALPHA_CHAR *dst,unsigned int dst_max,cons
 utty_offset_t utty_printat(utty_offset_t o,const char **msg,UTTY_ALPHA_CHAR uch);
 utty_offset_t utty_printat_const(utty_offset_t o,const char *msg,UTTY_ALPHA_CHAR uch);
 
-#ifdef TARGET_PC98
+#if defined(LINUX)
+#elif defined(TARGET_PC98)
 int utty_init_pc98(void);
 #else
 int utty_init_vgalib(void);
 #endif
 
+/* memory backed driver. cells are stored w x h in 'buf', not the VRAM layout, and every
+ * call that writes is counted in utty_mem_stats so that tests and benchmarks can see
+ * what a real driver would have been asked to do. drv_mem.c is only built into uttybnch
+ * (makefile), it is not part of the DOS library. */
+struct utty_mem_stats_t {
+    unsigned long           calls;          // setchar, setcharblock, scroll, fill
+    unsigned long           cells;          // cells written, including by scroll
+    unsigned long           scrolls;
+};
+
+extern struct utty_mem_stats_t      utty_mem_stats;
+
+int utty_init_mem(UTTY_ALPHA_CHAR UTTY_FAR *buf,uint8_t w,uint8_t h);
+
+/* shadow buffer. utty_shadow_enable() sits in front of the current driver: reads and writes go
+ * to a copy of the screen in memory and only rows touched since the last flush are compared
+ * against what the driver was last given. utty_shadow_flush() writes the cells that changed,
+ * in runs, and turns consecutive scrolls of the same region into one. Call it when the screen
+ * should be up to date, i.e. once per frame or before waiting for input. */
+int utty_shadow_enable(void);
+void utty_shadow_disable(void);
+void utty_shadow_flush(void);
+
 void utty_con_write(const char *msg);
 void utty_con_poscurs(const uint8_t y,const uint8_t x);
 utty_offset_t utty_con_to_offset(void);
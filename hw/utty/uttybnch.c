@@ -0,0 +1,313 @@
+/* utty shadow buffer test and benchmark against the memory driver.
+ *
+ * WARNING: For host systems only, not for DOS */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <hw/utty/utty.h>
+
+#define SCR_W           80
+#define SCR_H           25
+
+static UTTY_ALPHA_CHAR  screen[SCR_W*SCR_H];
+static uint32_t         rnd_state;
+
+static uint32_t rnd(void) {
+    rnd_state = (rnd_state * 1103515245UL) + 12345UL;
+    return (rnd_state >> 8) & 0xFFFFFFUL;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static uint32_t screen_hash(void) {
+    const unsigned char *p = (const unsigned char*)screen;
+    uint32_t h = 2166136261UL;
+    unsigned int i;
+
+    for (i=0;i < sizeof(screen);i++) h = (h ^ p[i]) * 16777619UL;
+    return h;
+}
+
+static void screen_init(const int shadow) {
+    UTTY_ALPHA_CHAR blank = UTTY_BLANK_CHATTR;
+    unsigned int i;
+
+    for (i=0;i < (SCR_W*SCR_H);i++) screen[i] = blank;
+    utty_init();
+    utty_init_mem(screen,SCR_W,SCR_H);
+    if (shadow && !utty_shadow_enable()) {
+        fprintf(stderr,"Cannot enable shadow buffer\n");
+        exit(1);
+    }
+    utty_con_init();
+    utty_con.refch = blank;
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+}
+
+static void screen_done(const int shadow) {
+    if (shadow) utty_shadow_disable();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+static void random_op(void) {
+    UTTY_ALPHA_CHAR tmp[SCR_W*2],ch;
+    unsigned int x,y,w,h,n,i;
+    char text[96];
+
+    ch.f.ch = (uint8_t)(0x20 + (rnd() % 0x5F));
+    ch.f.at = (uint8_t)(rnd() & 0x7F);
+
+    switch (rnd() % 10) {
+        case 0:
+        case 1:
+            utty_funcs.setchar(utty_offset_getofs(rnd() % SCR_H,rnd() % SCR_W),ch);
+            break;
+        case 2: /* may run over into the next row */
+            y = rnd() % SCR_H; x = rnd() % SCR_W;
+            n = 1 + (rnd() % ((y == (SCR_H-1)) ? (SCR_W - x) : (SCR_W*2 - x)));
+            for (i=0;i < n;i++) { tmp[i] = ch; tmp[i].f.ch = (uint8_t)(0x20 + ((ch.f.ch + i) % 0x5F)); }
+            utty_funcs.setcharblock(utty_offset_getofs(y,x),tmp,n);
+            break;
+        case 3:
+            y = rnd() % SCR_H; x = rnd() % SCR_W;
+            utty_funcs.fill(utty_offset_getofs(y,x),1 + (rnd() % (SCR_W - x)),ch);
+            break;
+        case 4: /* vertical scroll of a random region, up or down */
+            y = rnd() % (SCR_H - 1); h = 2 + (rnd() % (SCR_H - 1 - y));
+            x = rnd() % SCR_W; w = 1 + (rnd() % (SCR_W - x));
+            n = 1 + (rnd() % (h - 1));
+            if (rnd() & 1)
+                utty_funcs.scroll(utty_offset_getofs(y,x),utty_offset_getofs(y+n,x),w,h-n);
+            else
+                utty_funcs.scroll(utty_offset_getofs(y+n,x),utty_offset_getofs(y,x),w,h-n);
+            break;
+        case 5: /* horizontal scroll */
+            y = rnd() % SCR_H; h = 1 + (rnd() % (SCR_H - y));
+            n = 1 + (rnd() % 8);
+            utty_funcs.scroll(utty_offset_getofs(y,0),utty_offset_getofs(y,n),SCR_W-n,h);
+            break;
+        case 6:
+            utty_funcs.getchar(utty_offset_getofs(rnd() % SCR_H,rnd() % SCR_W));
+            break;
+        default: /* console output, line feeds scroll the whole screen */
+            n = rnd() % 90;
+            for (i=0;i < n;i++) text[i] = ((rnd() % 12) == 0) ? '\n' : (char)(0x20 + (rnd() % 0x5F));
+            text[n] = 0;
+            utty_con_write(text);
+            break;
+    }
+}
+
+/* run the same random sequence on the plain driver and through the shadow buffer,
+ * the screen must match at every flush */
+static int test_random(const unsigned int ops,const uint32_t seed) {
+    uint32_t *hashes;
+    unsigned int i,f,flushes = 0;
+
+    hashes = malloc(sizeof(uint32_t) * (ops + 1u));
+    if (hashes == NULL) return 1;
+
+    rnd_state = seed;
+    screen_init(0);
+    for (i=0;i < ops;i++) {
+        random_op();
+        if ((rnd() % 7) == 0) hashes[flushes++] = screen_hash();
+    }
+    hashes[flushes++] = screen_hash();
+    screen_done(0);
+
+    rnd_state = seed;
+    screen_init(1);
+    for (i=0,f=0;i < ops;i++) {
+        random_op();
+        if ((rnd() % 7) == 0) {
+            utty_shadow_flush();
+            if (screen_hash() != hashes[f]) {
+                fprintf(stderr,"FAIL: random seed 0x%08lx: screen differs after op %u (flush %u)\n",(unsigned long)seed,i,f);
+                screen_done(1);
+                free(hashes);
+                return 1;
+            }
+            f++;
+        }
+    }
+    utty_shadow_flush();
+    if (screen_hash() != hashes[f]) {
+        fprintf(stderr,"FAIL: random seed 0x%08lx: screen differs at the end\n",(unsigned long)seed);
+        screen_done(1);
+        free(hashes);
+        return 1;
+    }
+
+    screen_done(1);
+    free(hashes);
+    return 0;
+}
+
+static int expect(const char *what,const unsigned long got,const unsigned long want) {
+    if (got != want) {
+        fprintf(stderr,"FAIL: %s: got %lu, expected %lu\n",what,got,want);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void fill_lines(unsigned int lines) {
+    char tmp[64];
+
+    while (lines-- != 0u) {
+        sprintf(tmp,"\nline %u of text, rnd %lu",lines,(unsigned long)rnd());
+        utty_con_write(tmp);
+    }
+}
+
+static int test_counts(void) {
+    UTTY_ALPHA_CHAR ch = UTTY_BLANK_CHATTR;
+    int fail = 0;
+
+    screen_init(1);
+
+    utty_printat_const(utty_offset_getofs(3,10),"Same text twice",ch);
+    utty_shadow_flush();
+    fail |= expect("first draw, cells",utty_mem_stats.cells,15);
+    fail |= expect("first draw, calls",utty_mem_stats.calls,1);
+
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    utty_printat_const(utty_offset_getofs(3,10),"Same text twice",ch);
+    utty_shadow_flush();
+    fail |= expect("redraw, calls",utty_mem_stats.calls,0);
+
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    utty_printat_const(utty_offset_getofs(3,10),"Same tExt twicE",ch);
+    utty_shadow_flush();
+    fail |= expect("two changes 9 apart, calls",utty_mem_stats.calls,2);
+    fail |= expect("two changes 9 apart, cells",utty_mem_stats.cells,2);
+
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    utty_printat_const(utty_offset_getofs(3,10),"SaMe tExt twicE",ch);
+    utty_shadow_flush();
+    fail |= expect("changes 3 apart, calls",utty_mem_stats.calls,1);
+    fail |= expect("changes 3 apart, cells",utty_mem_stats.cells,1);
+
+    fill_lines(SCR_H);
+    utty_shadow_flush();
+
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    fill_lines(10);
+    utty_shadow_flush();
+    fail |= expect("10 line feeds, scrolls",utty_mem_stats.scrolls,1);
+
+    memset(&utty_mem_stats,0,sizeof(utty_mem_stats));
+    fill_lines(SCR_H + 5);
+    utty_shadow_flush();
+    fail |= expect("30 line feeds, scrolls",utty_mem_stats.scrolls,0);
+
+    screen_done(1);
+    return fail;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+static const char *bench_names[] = { "console", "status", "edit" };
+
+static void bench_frame(const unsigned int which,const unsigned int frame) {
+    UTTY_ALPHA_CHAR ch = UTTY_BLANK_CHATTR;
+    char tmp[96];
+    unsigned int y;
+
+    switch (which) {
+        case 0: /* scrolling console output, screen updated every 8 lines */
+            for (y=0;y < 8;y++) {
+                sprintf(tmp,"\nC:\\DOS\\SUBDIR%04u\\FILE%04u.DAT    %8u bytes  %02u-%02u-93",frame,y,frame*37u+y,(frame%12u)+1u,(y%28u)+1u);
+                utty_con_write(tmp);
+            }
+            break;
+        case 1: /* full screen status display redrawn every frame, a few numbers change */
+            for (y=0;y < SCR_H;y++) {
+                sprintf(tmp,"| %-20s | %10u | %10u | %-30s |",(y & 1) ? "Buffer underruns" : "Bytes transferred",
+                    (y == 3) ? frame : 1000u+y,(y == 7) ? (frame >> 4) : 2000u+y,(y == 0) ? "Status display" : "");
+                utty_printat_const(utty_offset_getofs(y,0),tmp,ch);
+            }
+            break;
+        case 2: /* a few characters typed in the middle of the screen */
+            ch.f.ch = (uint8_t)('a' + (frame % 26u));
+            utty_funcs.setchar(utty_offset_getofs(12,(frame % 60u) + 10u),ch);
+            utty_funcs.setchar(utty_offset_getofs(24,(frame % 60u) + 10u),ch);
+            break;
+    }
+}
+
+static void bench(const double seconds) {
+    unsigned int which,shadow,frames;
+    double t0,t;
+
+    printf("%-8s %-6s %10s %12s %12s %10s\n","case","mode","frames","calls/frame","cells/frame","ns/frame");
+    for (which=0;which < (sizeof(bench_names)/sizeof(bench_names[0]));which++) {
+        for (shadow=0;shadow < 2;shadow++) {
+            screen_init(shadow);
+            frames = 0;
+            t0 = now_seconds();
+            do {
+                for (unsigned int i=0;i < 64;i++) {
+                    bench_frame(which,frames++);
+                    if (shadow) utty_shadow_flush();
+                }
+                t = now_seconds() - t0;
+            } while (t < seconds);
+
+            printf("%-8s %-6s %10u %12.1f %12.1f %10.0f\n",bench_names[which],shadow ? "shadow" : "direct",frames,
+                (double)utty_mem_stats.calls / frames,(double)utty_mem_stats.cells / frames,(t * 1000000000.0) / frames);
+            screen_done(shadow);
+        }
+    }
+}
+
+static void help(void) {
+    fprintf(stderr,"uttybnch [options]\n");
+    fprintf(stderr,"Compare utty driver writes with and without the shadow buffer.\n");
+    fprintf(stderr,"  -test                        Check the shadow buffer against the plain driver\n");
+    fprintf(stderr,"  -t <seconds>                 Benchmark time per case (default 0.25)\n");
+}
+
+int main(int argc,char **argv) {
+    double seconds = 0.25;
+    int test = 0,i;
+
+    for (i=1;i < argc;i++) {
+        if (!strcmp(argv[i],"-test"))
+            test = 1;
+        else if (!strcmp(argv[i],"-t") && (i+1) < argc)
+            seconds = atof(argv[++i]);
+        else {
+            help();
+            return 1;
+        }
+    }
+
+    if (test) {
+        unsigned int s;
+        int fail = 0;
+
+        fail |= test_counts();
+        for (s=0;s < 64 && !fail;s++) fail |= test_random(4000,0x1234u + (s * 0x9E3779B9UL));
+
+        if (fail) return 1;
+        printf("All OK\n");
+        return 0;
+    }
+
+    bench(seconds);
+    return 0;
+}
+
@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if !defined(LINUX)
 #include <hw/dos/dos.h>
+#endif
 #include <hw/utty/utty.h>
 
 struct utty_con_t               utty_con = { .refch = UTTY_BLANK_CHATTR };
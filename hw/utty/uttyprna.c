@@ -2,8 +2,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <assert.h>
 
+#if !defined(LINUX)
 #include <hw/dos/dos.h>
+#endif
 #include <hw/utty/utty.h>
 
 utty_offset_t utty_printat(utty_offset_t o,const char **msg,UTTY_ALPHA_CHAR uch) {
@@ -0,0 +1,320 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if !defined(LINUX)
+#include <hw/dos/dos.h>
+#endif
+#include <hw/utty/utty.h>
+
+/* Shadow buffer in front of the utty driver.
+ *
+ * 'back' is what the screen should look like, every utty_funcs call reads and writes it.
+ * 'front' is what the driver has been given so far. Any cell where the two might differ lies
+ * within its row's dirty span, so the flush only compares those and writes the runs of cells
+ * that actually changed. Runs closer than UTTY_SHADOW_RUN_GAP cells apart are written as one
+ * call, rewriting a few equal cells is cheaper than another trip through the driver.
+ *
+ * Vertical scrolls are done on 'back' right away but held back from the driver. If the next
+ * scroll moves the same region in the same direction the two are merged, so 25 line feeds
+ * between flushes cost the driver one 25 line scroll, or none at all if the region scrolled
+ * out completely. Other scrolls are only done on 'back' and the diff redraws them. */
+
+#define UTTY_SHADOW_RUN_GAP         4u
+
+struct utty_shadow_t {
+    struct utty_funcs_t             dev;            // the driver underneath
+    UTTY_ALPHA_CHAR*                back;
+    UTTY_ALPHA_CHAR*                front;
+    uint8_t*                        dirty_l;        // per row, inclusive. dirty_l > dirty_r if clean
+    uint8_t*                        dirty_r;
+    unsigned int                    cells;          // allocated cells, stride x h
+    utty_offset_t                   base;           // offset of row 0 column 0
+    uint8_t                         enabled;
+
+    uint8_t                         sc_pending;     // scroll not yet given to the driver
+    uint8_t                         sc_up;          // content moves up (line feed) or down
+    uint8_t                         sc_x,sc_w;      // columns
+    uint8_t                         sc_top,sc_rows; // rows of the region, source and destination together
+    uint8_t                         sc_n;           // lines scrolled so far
+};
+
+static struct utty_shadow_t         utty_shadow;
+
+static inline unsigned int _shadow_index(const utty_offset_t ofs) {
+    return (unsigned int)((ofs - utty_shadow.base) >> 1u);
+}
+
+static inline utty_offset_t _shadow_offset(const unsigned int idx) {
+    return utty_shadow.base + ((utty_offset_t)idx << 1u);
+}
+
+static void _shadow_clean(void) {
+    unsigned int y;
+
+    for (y=0;y < utty_funcs.h;y++) {
+        utty_shadow.dirty_l[y] = 0xFFu;
+        utty_shadow.dirty_r[y] = 0x00u;
+    }
+}
+
+static void _shadow_mark(unsigned int idx,unsigned int count) {
+    unsigned int row,col,n;
+
+    while (count != 0u) {
+        row = idx / utty_funcs.stride;
+        col = idx % utty_funcs.stride;
+        if (row >= utty_funcs.h) break;
+
+        n = utty_funcs.stride - col;
+        if (n > count) n = count;
+
+        if (col < utty_funcs.w) {
+            unsigned int r = col + n - 1u;
+            if (r >= utty_funcs.w) r = utty_funcs.w - 1u;
+            if (utty_shadow.dirty_l[row] > col) utty_shadow.dirty_l[row] = (uint8_t)col;
+            if (utty_shadow.dirty_r[row] < r)   utty_shadow.dirty_r[row] = (uint8_t)r;
+        }
+
+        idx += n;
+        count -= n;
+    }
+}
+
+/* copy a w x h block within buf, rows in the order that is safe for the overlap */
+static void _shadow_move(UTTY_ALPHA_CHAR *buf,unsigned int didx,unsigned int sidx,unsigned int w,unsigned int h) {
+    const unsigned int stride = utty_funcs.stride;
+    unsigned int y;
+
+    if (didx > sidx) {
+        for (y=h;y != 0u;) {
+            y--;
+            memmove(buf+didx+(y*stride),buf+sidx+(y*stride),w * sizeof(UTTY_ALPHA_CHAR));
+        }
+    }
+    else {
+        for (y=0;y < h;y++)
+            memmove(buf+didx+(y*stride),buf+sidx+(y*stride),w * sizeof(UTTY_ALPHA_CHAR));
+    }
+}
+
+/* give the pending scroll to the driver, and do the same to 'front' so it stays a copy of the screen */
+static void _shadow_commit_scroll(void) {
+    unsigned int top,src,h;
+
+    if (!utty_shadow.sc_pending) return;
+    utty_shadow.sc_pending = 0;
+
+    if (utty_shadow.sc_n >= utty_shadow.sc_rows) return; /* scrolled out completely, the diff redraws it all */
+    h = utty_shadow.sc_rows - utty_shadow.sc_n;
+
+    if (utty_shadow.sc_up) {
+        top = utty_shadow.sc_top;
+        src = utty_shadow.sc_top + utty_shadow.sc_n;
+    }
+    else {
+        top = utty_shadow.sc_top + utty_shadow.sc_n;
+        src = utty_shadow.sc_top;
+    }
+
+    top = (top * utty_funcs.stride) + utty_shadow.sc_x;
+    src = (src * utty_funcs.stride) + utty_shadow.sc_x;
+    utty_shadow.dev.scroll(_shadow_offset(top),_shadow_offset(src),utty_shadow.sc_w,(uint8_t)h);
+    _shadow_move(utty_shadow.front,top,src,utty_shadow.sc_w,h);
+}
+
+static void utty_shadow__update_from_screen(void) {
+    unsigned int cells;
+
+    utty_shadow.dev.update_from_screen();
+
+    cells = (unsigned int)utty_funcs.stride * utty_funcs.h;
+    if (cells != utty_shadow.cells || utty_shadow.back == NULL) {
+        if (utty_shadow.back != NULL) free(utty_shadow.back);
+        if (utty_shadow.front != NULL) free(utty_shadow.front);
+        if (utty_shadow.dirty_l != NULL) free(utty_shadow.dirty_l);
+        if (utty_shadow.dirty_r != NULL) free(utty_shadow.dirty_r);
+        utty_shadow.back = malloc(sizeof(UTTY_ALPHA_CHAR) * (cells + 1u));
+        utty_shadow.front = malloc(sizeof(UTTY_ALPHA_CHAR) * (cells + 1u));
+        utty_shadow.dirty_l = malloc(utty_funcs.h + 1u);
+        utty_shadow.dirty_r = malloc(utty_funcs.h + 1u);
+        utty_shadow.cells = cells;
+    }
+
+    utty_shadow.sc_pending = 0;
+    if (utty_shadow.back == NULL || utty_shadow.front == NULL || utty_shadow.dirty_l == NULL || utty_shadow.dirty_r == NULL)
+        return;
+
+    utty_shadow.base = utty_offset_getofs(0,0);
+    utty_shadow.dev.getcharblock(utty_shadow.base,utty_shadow.front,cells);
+    memcpy(utty_shadow.back,utty_shadow.front,sizeof(UTTY_ALPHA_CHAR) * cells);
+    _shadow_clean();
+}
+
+static UTTY_ALPHA_CHAR utty_shadow__getchar(utty_offset_t ofs) {
+    return utty_shadow.back[_shadow_index(ofs)];
+}
+
+static utty_offset_t utty_shadow__setchar(utty_offset_t ofs,UTTY_ALPHA_CHAR ch) {
+    const unsigned int idx = _shadow_index(ofs);
+
+    if (utty_shadow.back[idx].raw != ch.raw) {
+        utty_shadow.back[idx] = ch;
+        _shadow_mark(idx,1u);
+    }
+
+    return ofs + (utty_offset_t)2u;
+}
+
+static utty_offset_t utty_shadow__getcharblock(utty_offset_t ofs,UTTY_ALPHA_CHAR *chptr,unsigned int count) {
+    memcpy(chptr,utty_shadow.back+_shadow_index(ofs),sizeof(UTTY_ALPHA_CHAR) * count);
+    return utty_offset_advance(ofs,count);
+}
+
+static utty_offset_t utty_shadow__setcharblock(utty_offset_t ofs,const UTTY_ALPHA_CHAR *chptr,unsigned int count) {
+    const unsigned int idx = _shadow_index(ofs);
+
+    if (count != 0u) {
+        memcpy(utty_shadow.back+idx,chptr,sizeof(UTTY_ALPHA_CHAR) * count);
+        _shadow_mark(idx,count);
+    }
+
+    return utty_offset_advance(ofs,count);
+}
+
+static void utty_shadow__scroll(utty_offset_t dofs,utty_offset_t sofs,uint8_t w,uint8_t h) {
+    const unsigned int didx = _shadow_index(dofs),sidx = _shadow_index(sofs);
+    const unsigned int dx = didx % utty_funcs.stride,dy = didx / utty_funcs.stride;
+    const unsigned int sx = sidx % utty_funcs.stride,sy = sidx / utty_funcs.stride;
+    unsigned int y,top,rows,n;
+    uint8_t up;
+
+    if (dofs == sofs || w == 0u || h == 0u) return;
+
+    _shadow_move(utty_shadow.back,didx,sidx,w,h);
+    for (y=0;y < h;y++) _shadow_mark(didx+(y*utty_funcs.stride),w);
+
+    if (dx != sx) return; /* not a vertical scroll, leave it to the diff */
+
+    up = (sy > dy) ? 1u : 0u;
+    n = up ? (sy - dy) : (dy - sy);
+    top = up ? dy : sy;
+    rows = h + n;
+
+    if (utty_shadow.sc_pending && utty_shadow.sc_up == up && utty_shadow.sc_x == dx && utty_shadow.sc_w == w &&
+        utty_shadow.sc_top == top && utty_shadow.sc_rows == rows) {
+        /* same region, same direction. once it has scrolled out completely stop counting */
+        if (utty_shadow.sc_n < rows) utty_shadow.sc_n += (uint8_t)n;
+        if (utty_shadow.sc_n > rows) utty_shadow.sc_n = (uint8_t)rows;
+        return;
+    }
+
+    _shadow_commit_scroll();
+    utty_shadow.sc_pending = 1;
+    utty_shadow.sc_up = up;
+    utty_shadow.sc_x = (uint8_t)dx;
+    utty_shadow.sc_w = w;
+    utty_shadow.sc_top = (uint8_t)top;
+    utty_shadow.sc_rows = (uint8_t)rows;
+    utty_shadow.sc_n = (uint8_t)n;
+}
+
+static void utty_shadow__fill(utty_offset_t ofs,unsigned int count,UTTY_ALPHA_CHAR ch) {
+    const unsigned int idx = _shadow_index(ofs);
+    unsigned int i;
+
+    if (count != 0u) {
+        for (i=0;i < count;i++) utty_shadow.back[idx+i] = ch;
+        _shadow_mark(idx,count);
+    }
+}
+
+void utty_shadow_flush(void) {
+    const UTTY_ALPHA_CHAR *b,*f;
+    unsigned int y,x,r,start,last,row;
+
+    if (!utty_shadow.enabled || utty_shadow.back == NULL) return;
+
+    _shadow_commit_scroll();
+
+    for (y=0;y < utty_funcs.h;y++) {
+        if (utty_shadow.dirty_l[y] > utty_shadow.dirty_r[y]) continue;
+
+        row = y * utty_funcs.stride;
+        b = utty_shadow.back + row;
+        f = utty_shadow.front + row;
+        r = utty_shadow.dirty_r[y];
+        x = utty_shadow.dirty_l[y];
+
+        while (x <= r) {
+            while (x <= r && b[x].raw == f[x].raw) x++;
+            if (x > r) break;
+
+            /* a run of changed cells, allowing short gaps of unchanged ones */
+            start = last = x++;
+            while (x <= r && (x - last) <= UTTY_SHADOW_RUN_GAP) {
+                if (b[x].raw != f[x].raw) last = x;
+                x++;
+            }
+
+            utty_shadow.dev.setcharblock(_shadow_offset(row+start),b+start,last + 1u - start);
+            memcpy(utty_shadow.front+row+start,b+start,sizeof(UTTY_ALPHA_CHAR) * (last + 1u - start));
+            x = last + 1u;
+        }
+
+        utty_shadow.dirty_l[y] = 0xFFu;
+        utty_shadow.dirty_r[y] = 0x00u;
+    }
+}
+
+/* must call after the driver init */
+int utty_shadow_enable(void) {
+    if (utty_shadow.enabled) return 1;
+
+    utty_shadow.dev = utty_funcs;
+    utty_funcs.update_from_screen = utty_shadow__update_from_screen;
+    utty_funcs.getchar = utty_shadow__getchar;
+    utty_funcs.setchar = utty_shadow__setchar;
+    utty_funcs.getcharblock = utty_shadow__getcharblock;
+    utty_funcs.setcharblock = utty_shadow__setcharblock;
+    utty_funcs.scroll = utty_shadow__scroll;
+    utty_funcs.fill = utty_shadow__fill;
+
+    utty_funcs.update_from_screen();
+    if (utty_shadow.back == NULL || utty_shadow.front == NULL || utty_shadow.dirty_l == NULL || utty_shadow.dirty_r == NULL) {
+        utty_shadow.enabled = 1;
+        utty_shadow_disable();
+        return 0;
+    }
+
+    utty_shadow.enabled = 1;
+    return 1;
+}
+
+/* flushes, then talks to the driver directly again */
+void utty_shadow_disable(void) {
+    if (!utty_shadow.enabled) return;
+
+    if (utty_shadow.back != NULL && utty_shadow.front != NULL && utty_shadow.dirty_l != NULL && utty_shadow.dirty_r != NULL)
+        utty_shadow_flush();
+
+    utty_funcs.update_from_screen = utty_shadow.dev.update_from_screen;
+    utty_funcs.getchar = utty_shadow.dev.getchar;
+    utty_funcs.setchar = utty_shadow.dev.setchar;
+    utty_funcs.getcharblock = utty_shadow.dev.getcharblock;
+    utty_funcs.setcharblock = utty_shadow.dev.setcharblock;
+    utty_funcs.scroll = utty_shadow.dev.scroll;
+    utty_funcs.fill = utty_shadow.dev.fill;
+
+    if (utty_shadow.back != NULL) free(utty_shadow.back);
+    if (utty_shadow.front != NULL) free(utty_shadow.front);
+    if (utty_shadow.dirty_l != NULL) free(utty_shadow.dirty_l);
+    if (utty_shadow.dirty_r != NULL) free(utty_shadow.dirty_r);
+    utty_shadow.back = utty_shadow.front = NULL;
+    utty_shadow.dirty_l = utty_shadow.dirty_r = NULL;
+    utty_shadow.cells = 0;
+    utty_shadow.enabled = 0;
+}
+
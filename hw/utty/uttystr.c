@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if !defined(LINUX)
 #include <hw/dos/dos.h>
+#endif
 #include <hw/utty/utty.h>
 
 unsigned int utty_string2ac(UTTY_ALPHA_CHAR *dst,unsigned int dst_max,const char **msgp,UTTY_ALPHA_CHAR refch) {
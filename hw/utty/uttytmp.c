@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if !defined(LINUX)
 #include <hw/dos/dos.h>
+#endif
 #include <hw/utty/utty.h>
 
 UTTY_ALPHA_CHAR utty_tmp[16];
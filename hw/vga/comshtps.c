@@ -20,6 +20,8 @@ int					cutregions = 0;
 struct vrl_animation_list_t		animlist[MAX_ANIMATION_LISTS];
 int					animlists = 0;
 
+int					sprite_source_keys = 0;
+
 static void chomp(char *line) {
 	char *s = line+strlen(line)-1;
 	while (s >= line && (*s == '\n' || *s == '\r')) *s-- = 0;
@@ -44,9 +46,27 @@ static void take_sprite_item(struct vrl_spritesheetentry_t *item) {
 					item->sprite_name);
 		}
 
-		if (item->w != 0 && item->h != 0)
+		if (!sprite_source_keys) {
+			// pcxsscut and vrl2vrs cut everything from the one -i image, with one -tc
+			if (item->source != NULL) {
+				fprintf(stderr,"WARNING for %s: src= is only supported by img2vrs, sprite skipped\n",
+					item->sprite_name);
+				free(item->source);
+				memset(item,0,sizeof(*item));
+				return;
+			}
+			if (item->has_transparent_color)
+				fprintf(stderr,"WARNING for %s: tc= is only supported by img2vrs, using the default transparency color\n",
+					item->sprite_name);
+		}
+
+		// a sprite with src= and no w,h is the whole image
+		if ((item->w != 0 && item->h != 0) || item->source != NULL)
 			cutregion[cutregions++] = *item;
 	}
+	else if (item->source != NULL) {
+		free(item->source);
+	}
 
 	memset(item,0,sizeof(*item));
 }
@@ -312,6 +332,19 @@ int parse_script_file(const char *path) {
 							// h=h
 							sprite_item.h = (uint16_t)strtoul(value,&value,0);
 						}
+						else if (!strcmp(name,"src")) {
+							// src=image.png (img2vrs only)
+							while (*value == ' ') value++;
+							d = value+strlen(value);
+							while (d > value && (d[-1] == ' ' || d[-1] == '\t')) *(--d) = 0;
+							if (sprite_item.source != NULL) free(sprite_item.source);
+							sprite_item.source = strdup(value);
+						}
+						else if (!strcmp(name,"tc")) {
+							// tc=index (img2vrs only)
+							sprite_item.transparent_color = (uint8_t)strtoul(value,&value,0);
+							sprite_item.has_transparent_color = 1;
+						}
 					}
 					else if (in_section == SECTION_ANIMATION) {
 						struct vrl_animation_frame_t *frame = &anim_item.animation_frame[anim_item.animation_frames];
@@ -7,6 +7,9 @@ struct vrl_spritesheetentry_t {
 	uint16_t		x,y,w,h;
 	uint16_t		sprite_id;
 	char			sprite_name[9];		// 8 chars + NUL
+	char*			source;			// src= image to cut from (img2vrs), NULL for the default image
+	uint8_t			transparent_color;	// tc= transparency color, if has_transparent_color
+	uint8_t			has_transparent_color;
 
 	uint32_t		fileoffset;		// when compiling
 };
@@ -39,5 +42,7 @@ extern int					cutregions;
 extern struct vrl_animation_list_t		animlist[MAX_ANIMATION_LISTS];
 extern int					animlists;
 
+extern int					sprite_source_keys;	// set by img2vrs before parsing, src= and tc= are for img2vrs only
+
 int parse_script_file(const char *path);
 
@@ -0,0 +1,977 @@
+/* WARNING: For host systems with libpng and pthreads only, not (yet) for DOS */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <ctype.h>
+#include <errno.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "vrl.h"
+#include "vrs.h"
+#include "pcxfmt.h"
+#include "comshtps.h"
+
+#include <png.h>            /* libpng */
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+/* worst case encoding of one column, same as out_strip[] in pcx2vrl */
+#define MAX_COLUMN_SIZE			((256*3)+16)
+
+struct src_image {
+	char*				path;
+	unsigned char*			pixels;			// 8bpp
+	unsigned int			stride,width,height;
+	unsigned char			palette[768];
+	unsigned char			has_palette;
+	unsigned char			has_image_tc;		// PNG tRNS entry with alpha == 0
+	unsigned char			image_tc;
+	unsigned char			default_tc;		// what pcx2vrl/png2vrl would use
+	int				failed;
+};
+
+struct sprite_job {
+	struct vrl_spritesheetentry_t*	cutreg;
+	struct src_image*		img;
+	unsigned int			x,y,w,h;
+	unsigned char			tc;
+	unsigned char*			data;			// encoded columns, back to back
+	unsigned int			data_len;
+	uint32_t*			colofs;			// start of each column in data[]
+	uint32_t*			fileofs;		// start of each column in the VRS, filled in by layout
+	uint32_t			tableofs;		// line offset table being written
+	int				failed;
+};
+
+struct out_buffer {
+	unsigned char*			p;
+	unsigned long			len,alloc;
+};
+
+/* column dedup hash, chained by index into the entry array */
+struct column_hash_entry {
+	uint32_t			hash;
+	uint32_t			fileofs;
+	uint32_t			len;
+	int				next;
+};
+
+static struct src_image*		images = NULL;
+static unsigned int			image_count = 0;
+
+static struct sprite_job*		jobs = NULL;
+static unsigned int			job_count = 0;
+
+static struct out_buffer		out;
+
+static struct column_hash_entry*	colhash = NULL;
+static unsigned int			colhash_count = 0;
+static unsigned long			colhash_bytes = 0;
+static int*				colhash_head = NULL;
+static unsigned int			colhash_mask = 0;
+
+static int				default_transparent_color = -1;
+
+static void help() {
+	fprintf(stderr,"IMG2VRS batch VRS sprite sheet compiler (C) 2016 Jonathan Campbell\n");
+	fprintf(stderr,"Converts every sprite in the sheet script from PCX/PNG to VRL and writes\n");
+	fprintf(stderr,"one VRS, with precomputed line offset tables, in one pass. Sprites may\n");
+	fprintf(stderr,"name their own image with src=<file> (and tc=<index>) in the script.\n");
+	fprintf(stderr,"A sprite with src= and no xy/wh is the whole image.\n");
+	fprintf(stderr,"\n");
+	fprintf(stderr,"img2vrs [options]\n");
+	fprintf(stderr,"  -hp <string>                 With -hc, prefix for sprite defines\n");
+	fprintf(stderr,"  -hc <filename>               Emit sprite names and IDs to C header\n");
+	fprintf(stderr,"  -s <filename>                Sheet script (sprites, sources, animations)\n");
+	fprintf(stderr,"  -i <filename>                Default PCX/PNG image for sprites without src=\n");
+	fprintf(stderr,"  -tc <index>                  Default transparency color\n");
+	fprintf(stderr,"  -p <filename>                Write palette of the first image to file\n");
+	fprintf(stderr,"  -o <filename>                Output VRS file\n");
+	fprintf(stderr,"  -j <n>                       Conversion threads (default one per CPU)\n");
+	fprintf(stderr,"  -dedup                       Store identical columns once (needs line offset tables)\n");
+	fprintf(stderr,"  -lo <16|32|both|none>        Line offset tables to embed (default both)\n");
+}
+
+/* ------------------------------ image loading ------------------------------ */
+
+static int load_pcx(struct src_image *img,unsigned char *raw,unsigned long rawsz) {
+	struct pcx_header *hdr = (struct pcx_header*)raw;
+	unsigned char *s,*d,*dfence,*end = raw + rawsz;
+	unsigned char b,run;
+
+	if (rawsz < (128+769)) {
+		fprintf(stderr,"%s: File is too small to be PCX\n",img->path);
+		return 0;
+	}
+	if (hdr->manufacturer != 0xA || hdr->encoding != 1 || hdr->bitsPerPlane != 8 ||
+		hdr->colorPlanes != 1 || hdr->Xmin >= hdr->Xmax || hdr->Ymin >= hdr->Ymax) {
+		fprintf(stderr,"%s: PCX format not supported\n",img->path);
+		return 0;
+	}
+
+	img->stride = hdr->bytesPerPlaneLine;
+	img->width = hdr->Xmax + 1 - hdr->Xmin;
+	img->height = hdr->Ymax + 1 - hdr->Ymin;
+	img->default_tc = 0;
+	if (img->stride < img->width) {
+		fprintf(stderr,"%s: PCX stride < width\n",img->path);
+		return 0;
+	}
+
+	s = raw + rawsz - 769;
+	if (*s == 0x0C) {
+		memcpy(img->palette,s+1,768);
+		img->has_palette = 1;
+		end = s;
+	}
+
+	img->pixels = malloc(img->stride * img->height);
+	if (img->pixels == NULL) {
+		fprintf(stderr,"%s: Cannot allocate decode buffer\n",img->path);
+		return 0;
+	}
+
+	d = img->pixels;
+	dfence = img->pixels + (img->stride * img->height);
+	s = raw + 128;
+	while (s < end && d < dfence) {
+		b = *s++;
+		if ((b & 0xC0) == 0xC0) {
+			run = b & 0x3F;
+			if (s >= end) break;
+			b = *s++;
+			while (run > 0) {
+				*d++ = b;
+				run--;
+				if (d >= dfence) break;
+			}
+		}
+		else {
+			*d++ = b;
+		}
+	}
+
+	return 1;
+}
+
+static int load_png(struct src_image *img) {
+	png_structp png_context = NULL;
+	png_infop png_context_info = NULL;
+	png_bytep* volatile rows = NULL;
+	png_uint_32 png_width = 0,png_height = 0;
+	int png_bit_depth = 0,png_color_type = 0;
+	unsigned int y;
+	FILE *fp;
+
+	fp = fopen(img->path,"rb");
+	if (fp == NULL) {
+		fprintf(stderr,"Cannot open source file '%s', %s\n",img->path,strerror(errno));
+		return 0;
+	}
+
+	png_context = png_create_read_struct(PNG_LIBPNG_VER_STRING,NULL/*error*/,NULL/*error fn*/,NULL/*warn fn*/);
+	if (png_context == NULL) {
+		fclose(fp);
+		return 0;
+	}
+	png_context_info = png_create_info_struct(png_context);
+	if (png_context_info == NULL || setjmp(png_jmpbuf(png_context))) {
+		fprintf(stderr,"%s: PNG decode error\n",img->path);
+		png_destroy_read_struct(&png_context,&png_context_info,NULL);
+		if (rows != NULL) free(rows);
+		fclose(fp);
+		return 0;
+	}
+
+	png_init_io(png_context,fp);
+	png_read_info(png_context,png_context_info);
+	png_get_IHDR(png_context,png_context_info,&png_width,&png_height,&png_bit_depth,&png_color_type,NULL,NULL,NULL);
+
+	if (png_color_type != PNG_COLOR_TYPE_PALETTE) {
+		fprintf(stderr,"%s: Input PNG not paletted\n",img->path);
+		png_error(png_context,"not paletted");
+	}
+	if (!(png_bit_depth == 4 || png_bit_depth == 8)) {
+		fprintf(stderr,"%s: Unsupported PNG bit depth %u\n",img->path,png_bit_depth);
+		png_error(png_context,"bit depth");
+	}
+
+	{
+		png_color* pal = NULL;
+		int pal_count = 0,i;
+
+		if (png_get_PLTE(png_context,png_context_info,&pal,&pal_count) != 0) {
+			memset(img->palette,0,768);
+			for (i=0;i < pal_count && i < 256;i++) {
+				img->palette[(i*3)+0] = pal[i].red;
+				img->palette[(i*3)+1] = pal[i].green;
+				img->palette[(i*3)+2] = pal[i].blue;
+			}
+			img->has_palette = 1;
+		}
+	}
+
+	/* we gotta preserve alpha transparency too */
+	{
+		png_color_16p trans_values = 0; /* throwaway value */
+		png_bytep trans = NULL;
+		int trans_count = 0,i;
+
+		if (png_get_tRNS(png_context,png_context_info,&trans,&trans_count,&trans_values) != 0) {
+			for (i=0;i < trans_count;i++) {
+				if (trans[i] == 0) {
+					img->image_tc = (unsigned char)i;
+					img->has_image_tc = 1;
+					break;
+				}
+			}
+		}
+	}
+
+	img->stride = img->width = png_width;
+	img->height = png_height;
+	img->default_tc = 0xFF;
+
+	img->pixels = malloc((png_width * png_height) + 4096);
+	rows = (png_bytep*)malloc(sizeof(png_bytep) * png_height);
+	if (img->pixels == NULL || rows == NULL)
+		png_error(png_context,"out of memory");
+
+	for (y=0;y < png_height;y++)
+		rows[y] = img->pixels + (y * png_width);
+
+	png_set_interlace_handling(png_context);
+	png_read_image(png_context,rows);
+
+	if (png_bit_depth == 4) { /* need to expand */
+		for (y=0;y < png_height;y++) {
+			unsigned int x = (png_width+1u) & (~1u);
+			unsigned char *d = rows[y] + x;
+			unsigned char *s = rows[y] + (x>>1u);
+			while (x != 0u) {
+				x -= 2u;
+				d -= 2u;
+				s--;
+				d[0] = s[0] >> 4u;
+				d[1] = s[0] & 0xFu;
+			}
+		}
+	}
+
+	png_destroy_read_struct(&png_context,&png_context_info,NULL);
+	free(rows);
+	fclose(fp);
+	return 1;
+}
+
+static void load_image(unsigned int i) {
+	static const unsigned char png_sig[8] = { 0x89,'P','N','G',0x0D,0x0A,0x1A,0x0A };
+	struct src_image *img = images + i;
+	unsigned char *raw;
+	unsigned long sz;
+	int fd;
+
+	fd = open(img->path,O_RDONLY|O_BINARY);
+	if (fd < 0) {
+		fprintf(stderr,"Cannot open source file '%s', %s\n",img->path,strerror(errno));
+		img->failed = 1;
+		return;
+	}
+	sz = (unsigned long)lseek(fd,0,SEEK_END);
+	raw = malloc(sz+1);
+	if (raw == NULL) {
+		fprintf(stderr,"Cannot malloc for source '%s'\n",img->path);
+		img->failed = 1;
+		close(fd);
+		return;
+	}
+	lseek(fd,0,SEEK_SET);
+	if ((unsigned long)read(fd,raw,sz) != sz) {
+		fprintf(stderr,"Cannot read '%s'\n",img->path);
+		img->failed = 1;
+	}
+	close(fd);
+
+	if (!img->failed) {
+		if (sz >= 8 && !memcmp(raw,png_sig,8))
+			img->failed = !load_png(img);
+		else
+			img->failed = !load_pcx(img,raw,sz);
+	}
+
+	free(raw);
+}
+
+static struct src_image *find_image(const char *path) {
+	unsigned int i;
+
+	for (i=0;i < image_count;i++) {
+		if (!strcmp(images[i].path,path))
+			return images + i;
+	}
+
+	images = realloc(images,sizeof(*images) * (image_count + 1));
+	if (images == NULL) {
+		fprintf(stderr,"Out of memory\n");
+		exit(1);
+	}
+	memset(images+image_count,0,sizeof(*images));
+	images[image_count].path = strdup(path);
+	return images + (image_count++);
+}
+
+/* ------------------------------ conversion ------------------------------ */
+
+/* encode one column of the sprite, exactly as pcx2vrl and png2vrl do */
+static unsigned int encode_column(unsigned char *out_strip,const unsigned char *s,const unsigned int stride,const unsigned int out_strip_height,const unsigned char transparent_color) {
+	unsigned int y = 0,runcount,skipcount;
+	unsigned char *d = out_strip;
+
+	while (y < out_strip_height) {
+		unsigned char *stripstart = d;
+		unsigned char color_run = 0;
+
+		d += 2; // patch bytes later
+		runcount = 0;
+		skipcount = 0;
+		while (y < out_strip_height && *s == transparent_color) {
+			y++;
+			s += stride;
+			if ((++skipcount) == 254) break;
+		}
+
+		// check: can we do a run length of one color?
+		if (y < out_strip_height && *s != transparent_color) {
+			unsigned char first_color = *s;
+			const unsigned char *scan_s = s;
+			unsigned int scan_y = y;
+
+			color_run = 1;
+			scan_s += stride;
+			scan_y++;
+			while (scan_y < out_strip_height) {
+				if (*scan_s != first_color) break;
+				scan_y++;
+				scan_s += stride;
+				if ((++color_run) == 126) break;
+			}
+
+			if (color_run < 3) color_run = 0;
+
+			if (color_run == 0) {
+				unsigned char ppixel = transparent_color,same_count = 0;
+
+				scan_s = s;
+				scan_y = y;
+				while (scan_y < out_strip_height && *scan_s != transparent_color) {
+					if (*scan_s == ppixel) {
+						if (same_count >= 4) {
+							d -= same_count;
+							scan_y -= same_count;
+							scan_s -= same_count * stride;
+							runcount -= same_count;
+							break;
+						}
+						same_count++;
+					}
+					else {
+						same_count=0;
+					}
+
+					scan_y++;
+					*d++ = ppixel = *scan_s;
+					scan_s += stride;
+					if ((++runcount) == 126) break;
+				}
+			}
+			else {
+				*d++ = first_color;
+				runcount = color_run;
+			}
+
+			y = scan_y;
+			s = scan_s;
+		}
+
+		if (runcount == 0 && y >= out_strip_height) {
+			/* avoid encoding strips with zero length just to skip to end of column */
+			d = stripstart;
+			break;
+		}
+
+		if (runcount == 0 && skipcount == 0) {
+			d = stripstart;
+		}
+		else {
+			// overwrite the first byte with run + skip count
+			if (color_run != 0) {
+				stripstart[0] = runcount + 0x80; // it's a run of one color
+				d = stripstart + 3; // it becomes <runcount+0x80> <skipcount> <color to repeat>
+			}
+			else {
+				stripstart[0] = runcount; // <runcount> <skipcount> [run]
+			}
+			stripstart[1] = skipcount;
+		}
+	}
+
+	// final byte
+	*d++ = 0xFF;
+	assert(d <= (out_strip + MAX_COLUMN_SIZE));
+	return (unsigned int)(d - out_strip);
+}
+
+static void convert_sprite(unsigned int i) {
+	struct sprite_job *job = jobs + i;
+	const struct src_image *img = job->img;
+	const unsigned char *src;
+	unsigned char *tmp;
+	unsigned int x;
+
+	job->colofs = malloc(sizeof(uint32_t) * job->w);
+	job->fileofs = malloc(sizeof(uint32_t) * job->w);
+	job->data = tmp = malloc(MAX_COLUMN_SIZE * job->w);
+	if (job->colofs == NULL || job->fileofs == NULL || tmp == NULL) {
+		fprintf(stderr,"Out of memory converting %s\n",job->cutreg->sprite_name);
+		job->failed = 1;
+		return;
+	}
+
+	src = img->pixels + job->x + (job->y * img->stride);
+	for (x=0;x < job->w;x++) {
+		job->colofs[x] = job->data_len;
+		job->data_len += encode_column(tmp + job->data_len,src + x,img->stride,job->h,job->tc);
+	}
+
+	/* shrink to fit, keeping the worst case buffer if that fails */
+	if ((tmp=realloc(job->data,job->data_len)) != NULL) job->data = tmp;
+}
+
+/* ------------------------------ thread pool ------------------------------ */
+
+static pthread_mutex_t			pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int			pool_next,pool_count;
+static void				(*pool_fn)(unsigned int i);
+
+static void *pool_worker(void *arg) {
+	unsigned int i;
+
+	(void)arg;
+	do {
+		pthread_mutex_lock(&pool_lock);
+		i = pool_next++;
+		pthread_mutex_unlock(&pool_lock);
+		if (i >= pool_count) break;
+
+		pool_fn(i);
+	} while (1);
+
+	return NULL;
+}
+
+/* run fn(0) .. fn(count-1) over the pool. results go into per-index slots, so order does not matter */
+static void parallel_for(unsigned int count,unsigned int threads,void (*fn)(unsigned int i)) {
+	pthread_t *tid;
+	unsigned int t,started = 0;
+
+	pool_next = 0;
+	pool_count = count;
+	pool_fn = fn;
+
+	if (threads > count) threads = count;
+	if (threads > 1) {
+		tid = malloc(sizeof(pthread_t) * (threads - 1));
+		if (tid != NULL) {
+			for (t=0;t < (threads - 1);t++) {
+				if (pthread_create(&tid[t],NULL,pool_worker,NULL) != 0) break;
+				started++;
+			}
+		}
+
+		pool_worker(NULL);
+
+		for (t=0;t < started;t++)
+			pthread_join(tid[t],NULL);
+		free(tid);
+	}
+	else {
+		pool_worker(NULL);
+	}
+}
+
+/* ------------------------------ output ------------------------------ */
+
+static unsigned long out_append(const void *p,unsigned long len) {
+	unsigned long ofs = out.len;
+
+	if ((out.len + len) > out.alloc) {
+		unsigned long na = out.alloc ? out.alloc : 65536UL;
+		while (na < (out.len + len)) na *= 2UL;
+		out.p = realloc(out.p,na);
+		if (out.p == NULL) {
+			fprintf(stderr,"Out of memory\n");
+			exit(1);
+		}
+		out.alloc = na;
+	}
+
+	memcpy(out.p + out.len,p,len);
+	out.len += len;
+	return ofs;
+}
+
+static void out_append_u16(const uint16_t v) {
+	out_append(&v,sizeof(v));
+}
+
+static void out_append_u32(const uint32_t v) {
+	out_append(&v,sizeof(v));
+}
+
+static uint32_t column_hash(const unsigned char *p,unsigned int len) {
+	uint32_t h = 2166136261UL; /* FNV-1a */
+
+	while (len-- > 0) {
+		h ^= *p++;
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+/* returns the file offset of an identical column already written, or writes this one */
+static uint32_t out_column_dedup(const unsigned char *p,unsigned int len) {
+	const uint32_t h = column_hash(p,len);
+	struct column_hash_entry *e;
+	int i;
+
+	for (i=colhash_head[h & colhash_mask];i >= 0;i=colhash[i].next) {
+		e = colhash + i;
+		if (e->hash == h && e->len == len && !memcmp(out.p + e->fileofs,p,len))
+			return e->fileofs;
+	}
+
+	e = colhash + colhash_count;
+	e->hash = h;
+	e->len = len;
+	e->fileofs = (uint32_t)out_append(p,len);
+	colhash_bytes += len;
+	e->next = colhash_head[h & colhash_mask];
+	colhash_head[h & colhash_mask] = (int)(colhash_count++);
+	return e->fileofs;
+}
+
+static void write_header_file(const char *hdr_file,const char *hdr_prefix,const char *scr_file) {
+	struct vrl_animation_frame_t *animframe;
+	struct vrl_spritesheetentry_t *cutreg;
+	struct vrl_animation_list_t *anim;
+	unsigned int cut,frame;
+	FILE *fp;
+
+	fp = fopen(hdr_file,"w");
+	if (fp == NULL) {
+		fprintf(stderr,"Failed to open -hc file\n");
+		exit(1);
+	}
+
+	fprintf(fp,"// header file for sprite sheet. AUTO GENERATED, do not edit\n");
+	fprintf(fp,"// \n");
+	fprintf(fp,"// sheet script: %s\n",scr_file);
+	fprintf(fp,"\n");
+
+	fprintf(fp,"// sprite sheet (sprite IDs)\n");
+	for (cut=0;cut < cutregions;cut++) {
+		cutreg = cutregion+cut;
+
+		fprintf(fp,"#define %s%s_sprite %uU\n",
+			hdr_prefix != NULL ? hdr_prefix : "",
+			cutreg->sprite_name,
+			cutreg->sprite_id);
+	}
+
+	fprintf(fp,"// animation list (animation IDs)\n");
+	for (cut=0;cut < animlists;cut++) {
+		anim = animlist+cut;
+
+		fprintf(fp,"#define %s%s_anim %uU /*",
+			hdr_prefix != NULL ? hdr_prefix : "",
+			anim->animation_name,
+			anim->animation_id);
+		fprintf(fp,"frames=%u ",
+			anim->animation_frames);
+		if (anim->animation_frames != 0) {
+			fprintf(fp,"[ ");
+			for (frame=0;frame < anim->animation_frames;frame++) {
+				animframe = anim->animation_frame + frame;
+				fprintf(fp,"%s@%u/event=%u/delay=%u ",animframe->sprite_name,animframe->sprite_id,
+					animframe->event_id,animframe->delay);
+			}
+			fprintf(fp,"]");
+		}
+		fprintf(fp," */\n");
+	}
+
+	fprintf(fp,"\n");
+	fprintf(fp,"// end list\n");
+	fclose(fp);
+}
+
+int main(int argc,char **argv) {
+	const char *scr_file = NULL,*hdr_file = NULL,*hdr_prefix = NULL,*dst_file = NULL,*src_file = NULL,*pal_file = NULL;
+	unsigned char want_lo16 = 1,want_lo32 = 1,dedup = 0;
+	unsigned long columns = 0,column_bytes = 0;
+	struct vrs_header vrshdr;
+	unsigned int cut,x;
+	long threads = 0;
+	const char *a;
+	int i,fd;
+
+	for (i=1;i < argc;) {
+		a = argv[i++];
+		if (*a == '-') {
+			do { a++; } while (*a == '-');
+
+			if (!strcmp(a,"h") || !strcmp(a,"help")) {
+				help();
+				return 1;
+			}
+			else if (!strcmp(a,"hp")) {
+				hdr_prefix = argv[i++];
+			}
+			else if (!strcmp(a,"hc")) {
+				hdr_file = argv[i++];
+			}
+			else if (!strcmp(a,"i")) {
+				src_file = argv[i++];
+			}
+			else if (!strcmp(a,"o")) {
+				dst_file = argv[i++];
+			}
+			else if (!strcmp(a,"p")) {
+				pal_file = argv[i++];
+			}
+			else if (!strcmp(a,"s")) {
+				scr_file = argv[i++];
+			}
+			else if (!strcmp(a,"tc")) {
+				default_transparent_color = (int)(strtoul(argv[i++],NULL,0) & 0xFFUL);
+			}
+			else if (!strcmp(a,"j")) {
+				threads = strtol(argv[i++],NULL,0);
+			}
+			else if (!strcmp(a,"dedup")) {
+				dedup = 1;
+			}
+			else if (!strcmp(a,"lo")) {
+				a = argv[i++];
+				if (a == NULL) a = "";
+				want_lo16 = (!strcmp(a,"16") || !strcmp(a,"both"));
+				want_lo32 = (!strcmp(a,"32") || !strcmp(a,"both"));
+				if (!want_lo16 && !want_lo32 && strcmp(a,"none")) {
+					fprintf(stderr,"-lo must be 16, 32, both or none\n");
+					return 1;
+				}
+			}
+			else {
+				fprintf(stderr,"Unknown switch '%s'. Use --help\n",a);
+				return 1;
+			}
+		}
+		else {
+			fprintf(stderr,"Unknown param %s\n",a);
+			return 1;
+		}
+	}
+
+	if (scr_file == NULL || dst_file == NULL) {
+		help();
+		return 1;
+	}
+
+	if (dedup && !want_lo16 && !want_lo32) {
+		fprintf(stderr,"-dedup sheets can only be drawn through line offset tables, -lo none not allowed\n");
+		return 1;
+	}
+
+	if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads <= 0) threads = 1;
+
+	/* read the script file, with the src= and tc= keys only this tool understands */
+	sprite_source_keys = 1;
+	if (!parse_script_file(scr_file)) {
+		fprintf(stderr,"Script file (-s) parse error\n");
+		return 1;
+	}
+
+	if (hdr_file != NULL)
+		write_header_file(hdr_file,hdr_prefix,scr_file);
+
+	if (cutregions == 0) {
+		fprintf(stderr,"No sprites in sheet script\n");
+		return 1;
+	}
+
+	/* collect the images, each is loaded once no matter how many sprites are cut from it */
+	jobs = calloc(cutregions,sizeof(*jobs));
+	if (jobs == NULL) {
+		fprintf(stderr,"Out of memory\n");
+		return 1;
+	}
+	if (src_file != NULL) find_image(src_file);
+	for (cut=0;cut < cutregions;cut++) {
+		struct vrl_spritesheetentry_t *cutreg = cutregion+cut;
+
+		if (cutreg->source == NULL && src_file == NULL) {
+			fprintf(stderr,"Sprite %s has no src= and no -i default image\n",cutreg->sprite_name);
+			return 1;
+		}
+
+		jobs[cut].cutreg = cutreg;
+		job_count++;
+	}
+	/* find_image() may move the array, resolve pointers after it has stopped growing */
+	for (cut=0;cut < cutregions;cut++) {
+		if (cutregion[cut].source != NULL) find_image(cutregion[cut].source);
+	}
+	for (cut=0;cut < cutregions;cut++)
+		jobs[cut].img = find_image(cutregion[cut].source != NULL ? cutregion[cut].source : src_file);
+
+	parallel_for(image_count,(unsigned int)threads,load_image);
+	for (i=0;i < (int)image_count;i++) {
+		if (images[i].failed) return 1;
+	}
+
+	if (pal_file != NULL) {
+		for (i=0;i < (int)image_count && !images[i].has_palette;i++);
+		if (i < (int)image_count) {
+			fd = open(pal_file,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644);
+			if (fd < 0) {
+				fprintf(stderr,"Cannot create file '%s', %s\n",pal_file,strerror(errno));
+				return 1;
+			}
+			write(fd,images[i].palette,768);
+			close(fd);
+		}
+	}
+
+	/* check the cut regions before handing them to the threads */
+	for (cut=0;cut < job_count;cut++) {
+		struct sprite_job *job = jobs + cut;
+		struct vrl_spritesheetentry_t *cutreg = job->cutreg;
+		const struct src_image *img = job->img;
+
+		if (cutreg->w == 0 && cutreg->h == 0) {
+			job->x = job->y = 0;
+			job->w = img->width;
+			job->h = img->height;
+		}
+		else {
+			job->x = cutreg->x;
+			job->y = cutreg->y;
+			job->w = cutreg->w;
+			job->h = cutreg->h;
+		}
+
+		if (job->w == 0 || job->h == 0) {
+			fprintf(stderr,"%s: cut region is NULL size\n",cutreg->sprite_name);
+			return 1;
+		}
+		if (job->x >= img->width || job->y >= img->height) {
+			fprintf(stderr,"%s: cut region x,y out of range (beyond %s width/height)\n",cutreg->sprite_name,img->path);
+			return 1;
+		}
+		if ((job->x+job->w) > img->width || (job->y+job->h) > img->height) {
+			fprintf(stderr,"%s: cut region w,h out of range ((x+w) > %s width or (y+h) > height)\n",cutreg->sprite_name,img->path);
+			return 1;
+		}
+		if (job->w >= 512 || job->h > 256) {
+			fprintf(stderr,"%s: sprite too big\n",cutreg->sprite_name);
+			return 1;
+		}
+		if (job->h > 255)
+			job->h = 255;
+
+		if (cutreg->has_transparent_color)
+			job->tc = cutreg->transparent_color;
+		else if (img->has_image_tc)
+			job->tc = img->image_tc;
+		else if (default_transparent_color >= 0)
+			job->tc = (unsigned char)default_transparent_color;
+		else
+			job->tc = img->default_tc;
+	}
+
+	parallel_for(job_count,(unsigned int)threads,convert_sprite);
+	for (cut=0;cut < job_count;cut++) {
+		if (jobs[cut].failed) return 1;
+		columns += jobs[cut].w;
+	}
+
+	if (dedup) {
+		for (colhash_mask=1024;colhash_mask < (columns * 2UL);) colhash_mask <<= 1U;
+		colhash_head = malloc(sizeof(int) * colhash_mask);
+		colhash = malloc(sizeof(*colhash) * columns);
+		if (colhash_head == NULL || colhash == NULL) {
+			fprintf(stderr,"Out of memory\n");
+			return 1;
+		}
+		memset(colhash_head,0xFF,sizeof(int) * colhash_mask); /* all -1 */
+		colhash_mask--;
+	}
+
+	/* layout is serial and in script order, so the output does not depend on -j */
+	memset(&vrshdr,0,sizeof(vrshdr));
+	memcpy(&vrshdr.vrs_sig,"VRS1",4);
+	out_append(&vrshdr,sizeof(vrshdr));
+
+	// write VRL sprites
+	for (cut=0;cut < job_count;cut++) {
+		struct sprite_job *job = jobs + cut;
+		struct vrl1_vgax_header hdr;
+
+		memset(&hdr,0,sizeof(hdr));
+		memcpy(hdr.vrl_sig,"VRL1",4); // Vertical Run Length v1
+		memcpy(hdr.fmt_sig,"VGAX",4); // VGA mode X
+		hdr.height = job->h;
+		hdr.width = job->w;
+		job->cutreg->fileoffset = (uint32_t)out_append(&hdr,sizeof(hdr));
+		column_bytes += job->data_len;
+
+		if (dedup) {
+			for (x=0;x < job->w;x++) {
+				const unsigned int len = (x+1 < job->w ? job->colofs[x+1] : job->data_len) - job->colofs[x];
+				job->fileofs[x] = out_column_dedup(job->data + job->colofs[x],len);
+			}
+		}
+		else {
+			const unsigned long base = out_append(job->data,job->data_len);
+			for (x=0;x < job->w;x++) job->fileofs[x] = (uint32_t)(base + job->colofs[x]);
+		}
+
+		free(job->data);
+		job->data = NULL;
+	}
+
+	// sprite offsets
+	vrshdr.offset_table[VRS_HEADER_OFFSET_VRS_LIST] = out.len;
+	for (cut=0;cut < cutregions;cut++)
+		out_append_u32(cutregion[cut].fileoffset);
+	out_append_u32(0);
+
+	// sprite IDs
+	vrshdr.offset_table[VRS_HEADER_OFFSET_SPRITE_ID_LIST] = out.len;
+	for (cut=0;cut < cutregions;cut++)
+		out_append_u16(cutregion[cut].sprite_id);
+	out_append_u16(0);
+
+	// sprite names, as vrl2vrs writes them
+	vrshdr.offset_table[VRS_HEADER_OFFSET_SPRITE_NAME_LIST] = out.len;
+	for (cut=0;cut < cutregions;cut++)
+		out_append(cutregion[cut].sprite_name,strlen(cutregion[cut].sprite_name)+1);
+	out_append("",1);
+
+	// write animation lists
+	for (cut=0;cut < animlists;cut++) {
+		struct vrs_animation_list_entry_t animstruct;
+		struct vrl_animation_frame_t *animframe;
+		struct vrl_animation_list_t *anim;
+		unsigned int frame;
+
+		anim = animlist+cut;
+		anim->fileoffset = out.len;
+
+		for (frame=0;frame < anim->animation_frames;frame++) {
+			animframe = anim->animation_frame + frame;
+			animstruct.sprite_id = animframe->sprite_id;
+			animstruct.event_id = animframe->event_id;
+			animstruct.delay = animframe->delay;
+			out_append(&animstruct,sizeof(animstruct));
+		}
+		memset(&animstruct,0,sizeof(animstruct));
+		out_append(&animstruct,sizeof(animstruct));
+	}
+	vrshdr.offset_table[VRS_HEADER_OFFSET_ANIMATION_LIST] = out.len;
+	for (cut=0;cut < animlists;cut++)
+		out_append_u32(animlist[cut].fileoffset);
+	out_append_u32(0);
+
+	// animation IDs
+	vrshdr.offset_table[VRS_HEADER_OFFSET_ANIMATION_ID_LIST] = out.len;
+	for (cut=0;cut < animlists;cut++)
+		out_append_u16(animlist[cut].animation_id);
+	out_append_u16(0);
+
+	// animation names
+	vrshdr.offset_table[VRS_HEADER_OFFSET_ANIMATION_NAME_LIST] = out.len;
+	for (cut=0;cut < animlists;cut++)
+		out_append(animlist[cut].animation_name,strlen(animlist[cut].animation_name)+1);
+	out_append("",1);
+
+	/* 16-bit tables can only point into the first 64KB. The tables come last, so if the sprite
+	 * data fits, so do the offsets */
+	if (want_lo16 && vrshdr.offset_table[VRS_HEADER_OFFSET_VRS_LIST] > 0xFFFFUL) {
+		fprintf(stderr,"WARNING: sprite data exceeds 64KB, 16-bit line offset tables omitted\n");
+		want_lo16 = 0;
+		if (dedup && !want_lo32) {
+			fprintf(stderr,"-dedup sheet has no usable line offset tables, use -lo 32\n");
+			return 1;
+		}
+	}
+
+	// line offset tables, then the list pointing at them, like the animation lists
+	if (want_lo16) {
+		for (cut=0;cut < job_count;cut++) {
+			jobs[cut].tableofs = out.len;
+			for (x=0;x < jobs[cut].w;x++) out_append_u16((uint16_t)jobs[cut].fileofs[x]);
+		}
+		vrshdr.offset_table[VRS_HEADER_OFFSET_LINEOFFS16_LIST] = out.len;
+		for (cut=0;cut < job_count;cut++)
+			out_append_u32(jobs[cut].tableofs);
+		out_append_u32(0);
+	}
+	if (want_lo32) {
+		for (cut=0;cut < job_count;cut++) {
+			jobs[cut].tableofs = out.len;
+			out_append(jobs[cut].fileofs,sizeof(uint32_t) * jobs[cut].w);
+		}
+		vrshdr.offset_table[VRS_HEADER_OFFSET_LINEOFFS32_LIST] = out.len;
+		for (cut=0;cut < job_count;cut++)
+			out_append_u32(jobs[cut].tableofs);
+		out_append_u32(0);
+	}
+
+	// update header
+	vrshdr.resident_size = out.len;
+	memcpy(out.p,&vrshdr,sizeof(vrshdr));
+
+	fd = open(dst_file,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644);
+	if (fd < 0) {
+		fprintf(stderr,"Unable to open dst file, %s\n",strerror(errno));
+		return 1;
+	}
+	if ((unsigned long)write(fd,out.p,out.len) != out.len) {
+		fprintf(stderr,"Error writing dst file\n");
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	printf("%u sprites from %u images, %lu columns",job_count,image_count,columns);
+	if (dedup)
+		printf(", %u unique, %lu of %lu column bytes stored",colhash_count,colhash_bytes,column_bytes);
+	printf(", %lu bytes\n",out.len);
+
+	// final warning for 16-bit segmented programs
+	if (out.len >= 65536UL)
+		fprintf(stderr,"WARNING: VRS file exceeds 64KB, may not be usable by 16-bit DOS programs\n");
+
+	return 0;
+}
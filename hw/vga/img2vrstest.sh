@@ -0,0 +1,79 @@
+#!/bin/bash
+#
+# Check img2vrs against pcxsscut + vrl2vrs on prussia.sht:
+#   - every sprite renders the same (vrlbench CRCs), with and without line offset tables
+#     and with -dedup, the C header and the palette are the same
+#   - the output does not depend on -j
+#   - a src= sprite is skipped by pcxsscut and vrl2vrs with a warning, and compiled by
+#     img2vrs
+# The encoders differ in how they write empty strips, so the VRS files themselves are not
+# compared with the reference, only how their sprites draw. Host build (make) first.
+
+VGA=`pwd`
+TMP=$VGA/img2vrstest.tmp
+SHT=$VGA/prussia.sht
+PCX=$VGA/prussia.pcx
+
+rm -Rf $TMP
+mkdir -p $TMP/ref || exit 1
+
+fail=0
+
+same_sprites() {
+    $VGA/vrlbench -mkgold $TMP/$1 >$TMP/$1.txt || { echo "FAIL: vrlbench $1"; fail=1; return; }
+    if ! cmp -s $TMP/$1.txt $TMP/ref.txt; then echo "FAIL: $1 sprites do not draw like the pcxsscut + vrl2vrs ones"; fail=1; fi
+}
+
+img2vrs() {
+    (cd $TMP && $VGA/img2vrs "$@" >/dev/null) || { echo "FAIL: img2vrs $*"; exit 1; }
+}
+
+# reference, the two step way
+(cd $TMP/ref && $VGA/pcxsscut -s $SHT -hc prussia.h -hp demoanim_prussia_ -i $PCX -p ref.pal -tc 0x84 -y >/dev/null 2>&1) || { echo "FAIL: pcxsscut"; exit 1; }
+(cd $TMP/ref && $VGA/vrl2vrs -s $SHT -hc ref.h -hp demoanim_prussia_ -o ../ref.vrs >/dev/null 2>&1) || { echo "FAIL: vrl2vrs"; exit 1; }
+$VGA/vrlbench -mkgold $TMP/ref.vrs >$TMP/ref.txt || exit 1
+
+# no line offset tables, sprites drawn with generated line offsets like the reference
+img2vrs -s $SHT -hc lonone.h -hp demoanim_prussia_ -i $PCX -p lonone.pal -tc 0x84 -lo none -j 1 -o lonone.vrs
+same_sprites lonone.vrs
+cmp -s $TMP/lonone.h $TMP/ref/ref.h || { echo "FAIL: C header differs from vrl2vrs"; fail=1; }
+cmp -s $TMP/lonone.pal $TMP/ref/ref.pal || { echo "FAIL: palette differs from pcxsscut"; fail=1; }
+echo "ok: same sprites as pcxsscut + vrl2vrs"
+
+# with line offset tables (vrlbench draws through the 32-bit ones), any -j
+for j in 1 2 4 16; do
+    img2vrs -s $SHT -i $PCX -tc 0x84 -j $j -o j$j.vrs
+    cmp -s $TMP/j$j.vrs $TMP/j1.vrs || { echo "FAIL: -j $j output differs from -j 1"; fail=1; }
+done
+same_sprites j1.vrs
+echo "ok: -j 1, 2, 4, 16 identical"
+
+# -dedup, any -j, smaller, drawn through the tables
+for j in 1 4 16; do
+    img2vrs -s $SHT -i $PCX -tc 0x84 -dedup -j $j -o dedup$j.vrs
+    cmp -s $TMP/dedup$j.vrs $TMP/dedup1.vrs || { echo "FAIL: -dedup -j $j output differs from -j 1"; fail=1; }
+done
+same_sprites dedup1.vrs
+if [ `stat -c %s $TMP/dedup1.vrs` -ge `stat -c %s $TMP/j1.vrs` ]; then echo "FAIL: -dedup did not make the sheet smaller"; fail=1; fi
+echo "ok: -dedup"
+
+# one more sprite with src=, the same rectangle as PRSBFCW0
+awk -v pcx="$PCX" '/^\*animation/ { print "+PRSXSRC0@250"; print "src=" pcx; print "xy=0,0"; print "wh=32,32"; print "" } { print }' $SHT >$TMP/src.sht
+mkdir -p $TMP/src || exit 1
+(cd $TMP/src && $VGA/pcxsscut -s $TMP/src.sht -i $PCX -tc 0x84 -y >/dev/null 2>$TMP/src/pcxsscut.log) || { echo "FAIL: pcxsscut with a src= sprite"; fail=1; }
+grep -q "PRSXSRC0: src= is only supported by img2vrs" $TMP/src/pcxsscut.log || { echo "FAIL: pcxsscut did not warn about src="; fail=1; }
+[ -e $TMP/src/PRSXSRC0.VRL ] && { echo "FAIL: pcxsscut cut the src= sprite from -i"; fail=1; }
+(cd $TMP/src && $VGA/vrl2vrs -s $TMP/src.sht -o ../srcref.vrs >/dev/null 2>&1) || { echo "FAIL: vrl2vrs with a src= sprite"; fail=1; }
+same_sprites srcref.vrs
+img2vrs -s $TMP/src.sht -i $PCX -tc 0x84 -o src.vrs
+$VGA/vrlbench -mkgold $TMP/src.vrs >$TMP/src.txt || { echo "FAIL: vrlbench src.vrs"; fail=1; }
+if ! diff -q <(grep -v "^PRSXSRC0 " $TMP/src.txt) $TMP/ref.txt >/dev/null ||
+    ! diff -q <(grep "^PRSXSRC0 " $TMP/src.txt | cut -d ' ' -f 2-) <(grep "^PRSBFCW0 " $TMP/ref.txt | cut -d ' ' -f 2-) >/dev/null; then
+    echo "FAIL: img2vrs src= sprite"; fail=1
+fi
+echo "ok: src= sprite"
+
+if [ $fail -ne 0 ]; then echo "FAILED"; exit 1; fi
+rm -Rf $TMP
+echo "PASS"
+exit 0
@@ -0,0 +1,259 @@
+/* WARNING: For host systems only, not for DOS. See vrl1host.h */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vrl.h"
+#include "vrl1host.h"
+
+int vrl1_host_fb_init(struct vrl1_host_fb *fb,unsigned int width,unsigned int height,unsigned char planar) {
+	memset(fb,0,sizeof(*fb));
+	if (width == 0 || height == 0) return -1;
+
+	fb->width = width;
+	fb->height = height;
+	fb->planar = planar ? 1 : 0;
+	if (fb->planar) {
+		fb->stride = (width + 3U) >> 2U;
+		fb->plane_size = (unsigned long)fb->stride * (unsigned long)height;
+		fb->mem = malloc(fb->plane_size * 4UL);
+	}
+	else {
+		fb->stride = width;
+		fb->mem = malloc((unsigned long)width * (unsigned long)height);
+	}
+
+	return (fb->mem != NULL) ? 0 : -1;
+}
+
+void vrl1_host_fb_free(struct vrl1_host_fb *fb) {
+	if (fb->mem != NULL) {
+		free(fb->mem);
+		fb->mem = NULL;
+	}
+}
+
+void vrl1_host_fb_clear(struct vrl1_host_fb *fb,unsigned char color) {
+	if (fb->planar)
+		memset(fb->mem,color,fb->plane_size * 4UL);
+	else
+		memset(fb->mem,color,(unsigned long)fb->stride * (unsigned long)fb->height);
+}
+
+void vrl1_host_fb_to_linear(const struct vrl1_host_fb *fb,unsigned char *dst) {
+	unsigned int x,y;
+
+	for (y=0;y < fb->height;y++) {
+		if (fb->planar) {
+			for (x=0;x < fb->width;x++)
+				*dst++ = fb->mem[((unsigned long)(x & 3U) * fb->plane_size) + ((unsigned long)y * fb->stride) + (x >> 2U)];
+		}
+		else {
+			memcpy(dst,fb->mem + ((unsigned long)y * fb->stride),fb->width);
+			dst += fb->width;
+		}
+	}
+}
+
+vrl1_vgax_offset_t *vrl1_host_genlineoffsets(struct vrl1_vgax_header *hdr,unsigned char *data,unsigned int datasz) {
+	unsigned int x = 0;
+	unsigned char run;
+	vrl1_vgax_offset_t *list;
+	unsigned char *fence = data + datasz,*s;
+
+	if (hdr->width == 0U)
+		return NULL;
+
+	list = calloc(hdr->width,sizeof(vrl1_vgax_offset_t));
+	if (list == NULL) return NULL;
+
+	s = data;
+	while (s < fence) {
+		list[x++] = (vrl1_vgax_offset_t)(s - data);
+		while (s < fence) {
+			run = *s++;
+			if (run == 0xFF) break;
+			s++; /* skip */
+
+			if (run&0x80)
+				s++;
+			else
+				s += run;
+		}
+
+		if (x >= hdr->width) break;
+	}
+
+	return list;
+}
+
+static inline unsigned char *vrl1_host_column(struct vrl1_host_fb *fb,unsigned int x,unsigned int y) {
+	if (fb->planar)
+		return fb->mem + ((unsigned long)(x & 3U) * fb->plane_size) + ((unsigned long)y * fb->stride) + (x >> 2U);
+
+	return fb->mem + ((unsigned long)y * fb->stride) + x;
+}
+
+/* one VRL column, same as draw_vrl1_vgax_modex_strip() but stops after 'rows' rows */
+static inline void vrl1_host_strip(unsigned char *draw,const unsigned char *s,const unsigned int pitch,unsigned int rows) {
+	unsigned char run,skip,b;
+	unsigned int n;
+
+	while ((run = *s++) != 0xFF) {
+		skip = *s++;
+		if (skip >= rows) return;
+		rows -= skip;
+		draw += skip * pitch;
+
+		if (run & 0x80) {
+			/* same color strip. next byte is the color to write */
+			n = run & 0x7FU;
+			b = *s++;
+			if (n > rows) n = rows;
+			rows -= n;
+			while (n-- > 0U) {
+				*draw = b;
+				draw += pitch;
+			}
+		}
+		else {
+			/* pixels to copy */
+			n = run;
+			if (n > rows) n = rows;
+			rows -= n;
+			s += run;
+			{
+				const unsigned char *c = s - run;
+				while (n-- > 0U) {
+					*draw = *c++;
+					draw += pitch;
+				}
+			}
+		}
+
+		if (rows == 0U) return;
+	}
+}
+
+/* same as draw_vrl1_vgax_modex_stripystretch(), stops after 'rows' rows */
+static inline void vrl1_host_stripystretch(unsigned char *draw,const unsigned char *s,const unsigned int pitch,unsigned int rows,const unsigned int ystep) {
+	unsigned char run,skip,b;
+	unsigned int fy=0,ym;
+
+	while ((run = *s++) != 0xFF) {
+		skip = *s++;
+		if (skip > 0) {
+			ym = (unsigned int)skip << 6U;
+			while (fy < ym) {
+				if (--rows == 0U) return;
+				draw += pitch;
+				fy += ystep;
+			}
+			fy -= ym;
+		}
+
+		if (run & 0x80) {
+			b = *s++;
+			ym = ((unsigned int)(run - 0x80)) << 6U;
+			while (fy < ym) {
+				*draw = b;
+				if (--rows == 0U) return;
+				draw += pitch;
+				fy += ystep;
+			}
+			fy -= ym;
+		}
+		else {
+			while (run > 0) {
+				while (fy < (1U << 6U)) {
+					*draw = *s;
+					if (--rows == 0U) return;
+					draw += pitch;
+					fy += ystep;
+				}
+				fy -= 1U << 6U;
+				run--;
+				s++;
+			}
+		}
+	}
+}
+
+void vrl1_host_draw(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz) {
+	unsigned int sx,rows;
+
+	(void)datasz;
+	if (y >= fb->height) return;
+	rows = fb->height - y;
+
+	for (sx=0;sx < hdr->width && (x+sx) < fb->width;sx++)
+		vrl1_host_strip(vrl1_host_column(fb,x+sx,y),data + lineoffs[sx],fb->stride,rows);
+}
+
+/* same as draw_vrl1_vgax_modexclip_hflip() in the codenamesunfish3d game: columns right to left */
+void vrl1_host_draw_hflip(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz) {
+	unsigned int sx,rows;
+
+	(void)datasz;
+	if (y >= fb->height) return;
+	rows = fb->height - y;
+
+	for (sx=0;sx < hdr->width && (x+sx) < fb->width;sx++)
+		vrl1_host_strip(vrl1_host_column(fb,x+sx,y),data + lineoffs[hdr->width-sx-1U],fb->stride,rows);
+}
+
+void vrl1_host_drawstretch(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,unsigned int xstep,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz) {
+	const unsigned int xmax = hdr->width << 6U;
+	unsigned int fx=0,rows;
+
+	(void)datasz;
+	if (y >= fb->height || xstep == 0U) return;
+	rows = fb->height - y;
+
+	while (fx < xmax && x < fb->width) {
+		vrl1_host_strip(vrl1_host_column(fb,x,y),data + lineoffs[fx >> 6U],fb->stride,rows);
+		fx += xstep;
+		x++;
+	}
+}
+
+void vrl1_host_drawystretch(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,unsigned int xstep,unsigned int ystep,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz) {
+	const unsigned int xmax = hdr->width << 6U;
+	unsigned int fx=0,rows;
+
+	(void)datasz;
+	if (y >= fb->height || xstep == 0U || ystep == 0U) return;
+	rows = fb->height - y;
+
+	while (fx < xmax && x < fb->width) {
+		vrl1_host_stripystretch(vrl1_host_column(fb,x,y),data + lineoffs[fx >> 6U],fb->stride,rows,ystep);
+		fx += xstep;
+		x++;
+	}
+}
+
+void vrl1_host_draw_cost(struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned long *rd,unsigned long *wr) {
+	const unsigned char *s;
+	unsigned char run;
+	unsigned int sx;
+
+	*rd = *wr = 0;
+	for (sx=0;sx < hdr->width;sx++) {
+		s = data + lineoffs[sx];
+		while ((run = *s++) != 0xFF) {
+			s++; /* skip */
+			if (run & 0x80) {
+				*wr += run & 0x7FU;
+				s++;
+			}
+			else {
+				*wr += run;
+				s += run;
+			}
+		}
+
+		*rd += (unsigned long)(s - (data + lineoffs[sx]));
+	}
+}
@@ -0,0 +1,43 @@
+
+#ifndef __DOSLIB_HW_VGA_VRL1HOST_H
+#define __DOSLIB_HW_VGA_VRL1HOST_H
+
+/* Host (Linux) VRL1 renderer. Same column walk as draw_vrl1_vgax_modex() and the stretch
+ * variants, but into a memory framebuffer instead of VGA RAM, so the VRL format and the
+ * draw paths can be tested and profiled without hardware.
+ *
+ * A planar framebuffer is laid out like unchained VGA (Mode X): 4 planes of plane_size bytes,
+ * pixel (x,y) in plane (x & 3) at offset (y * stride) + (x >> 2). A linear framebuffer is
+ * plain 8bpp, pixel (x,y) at (y * stride) + x.
+ *
+ * Unlike the VGA versions, drawing is clipped to the right and bottom edge of the framebuffer.
+ * The VGA code relies on vga_draw_stride_limit for the right edge and does not clip at the bottom. */
+
+#include "vrl.h"
+
+struct vrl1_host_fb {
+	unsigned char*		mem;
+	unsigned long		plane_size;		// planar only, 0 if linear
+	unsigned int		width,height;		// in pixels
+	unsigned int		stride;			// bytes per row (per plane, if planar)
+	unsigned char		planar;
+};
+
+int vrl1_host_fb_init(struct vrl1_host_fb *fb,unsigned int width,unsigned int height,unsigned char planar);
+void vrl1_host_fb_free(struct vrl1_host_fb *fb);
+void vrl1_host_fb_clear(struct vrl1_host_fb *fb,unsigned char color);
+void vrl1_host_fb_to_linear(const struct vrl1_host_fb *fb,unsigned char *dst/*width*height*/);
+
+/* portable copy of vrl1_vgax_genlineoffsets() (vrl1xlof.c needs the DOS headers) */
+vrl1_vgax_offset_t *vrl1_host_genlineoffsets(struct vrl1_vgax_header *hdr,unsigned char *data,unsigned int datasz);
+
+void vrl1_host_draw(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz);
+void vrl1_host_draw_hflip(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz);
+void vrl1_host_drawstretch(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,unsigned int xstep/*10.6 fixed pt*/,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz);
+void vrl1_host_drawystretch(struct vrl1_host_fb *fb,unsigned int x,unsigned int y,unsigned int xstep/*10.6 fixed pt*/,unsigned int ystep/*10.6 fixed pt*/,struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned int datasz);
+
+/* how much memory one unclipped vrl1_host_draw() reads (VRL bytes) and writes (pixels) */
+void vrl1_host_draw_cost(struct vrl1_vgax_header *hdr,vrl1_vgax_offset_t *lineoffs,unsigned char *data,unsigned long *rd,unsigned long *wr);
+
+#endif //__DOSLIB_HW_VGA_VRL1HOST_H
+
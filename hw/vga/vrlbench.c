@@ -0,0 +1,441 @@
+/* VRL host renderer benchmark and golden image test.
+ *
+ * WARNING: For host systems only, not for DOS */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "vrl.h"
+#include "vrs.h"
+#include "vrl1host.h"
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+/* VRS sheets are read whole, they can be larger than one sprite */
+#define VRS_MAX_SIZE		(0x1000000UL)
+
+#define FB_WIDTH		320
+#define FB_HEIGHT		240
+
+struct draw_case {
+	const char*		name;
+	unsigned int		xstep,ystep;	/* 10.6 fixed pt, 64 = 1:1. ystep == 0 means draw_vrl1_vgax_modexstretch() */
+};
+
+static const struct draw_case cases[] = {
+	{ "draw",		64,	0	},	/* xstep 64 without ystep is plain draw */
+	{ "xstretch2",		32,	0	},
+	{ "xshrink2",		128,	0	},
+	{ "ystretch2",		32,	32	},
+	{ "yshrink2",		128,	128	},
+	{ NULL,			0,	0	}
+};
+
+/* one sprite. a .VRL file, or one sprite of a .VRS sheet, which shares the sheet's buffer */
+struct vrl_file {
+	const char*			path;
+	char				name[64];		/* file name, or sprite name within a VRS */
+	unsigned char*			buffer;
+	unsigned int			bufsz;
+	struct vrl1_vgax_header*	hdr;
+	vrl1_vgax_offset_t*		lineoffs;
+	unsigned char*			data;			/* lineoffs are relative to this */
+	unsigned int			datasz;
+};
+
+static uint32_t crc32_table[256];
+
+static void crc32_init(void) {
+	uint32_t c;
+	unsigned int i,j;
+
+	for (i=0;i < 256;i++) {
+		c = i;
+		for (j=0;j < 8;j++) c = (c & 1) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+		crc32_table[i] = c;
+	}
+}
+
+static uint32_t crc32_buf(const unsigned char *p,unsigned long len) {
+	uint32_t c = 0xFFFFFFFFUL;
+
+	while (len-- > 0) c = crc32_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFFUL;
+}
+
+static double now_sec(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static const char *basename_of(const char *p) {
+	const char *s = strrchr(p,'/');
+	return s != NULL ? s+1 : p;
+}
+
+static uint32_t rd32(const unsigned char *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static unsigned char *read_file(const char *path,unsigned int *sz) {
+	unsigned char *buf;
+	long l;
+	int fd;
+
+	fd = open(path,O_RDONLY|O_BINARY);
+	if (fd < 0) {
+		fprintf(stderr,"Cannot open %s, %s\n",path,strerror(errno));
+		return NULL;
+	}
+	l = (long)lseek(fd,0,SEEK_END);
+	if (l < (long)sizeof(struct vrl1_vgax_header) || l > (long)VRS_MAX_SIZE) {
+		fprintf(stderr,"%s: bad size\n",path);
+		close(fd);
+		return NULL;
+	}
+	buf = malloc((size_t)l);
+	if (buf == NULL) {
+		close(fd);
+		return NULL;
+	}
+	lseek(fd,0,SEEK_SET);
+	if (read(fd,buf,(size_t)l) != (int)l) {
+		fprintf(stderr,"%s: read error\n",path);
+		free(buf);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	*sz = (unsigned int)l;
+	return buf;
+}
+
+static struct vrl_file *add_vrl_file(struct vrl_file **v,unsigned int *count,const char *path,unsigned char *buf,unsigned int sz) {
+	struct vrl_file *n = realloc(*v,sizeof(**v) * (*count + 1u));
+
+	if (n == NULL) return NULL;
+	*v = n;
+	n += (*count)++;
+
+	memset(n,0,sizeof(*n));
+	n->path = path;
+	n->buffer = buf;
+	n->bufsz = sz;
+	return n;
+}
+
+static int load_vrl(struct vrl_file **vl,unsigned int *count,const char *path,unsigned char *buf,unsigned int sz) {
+	struct vrl_file *v;
+
+	if (sz > (unsigned int)VRL_MAX_SIZE) {
+		fprintf(stderr,"%s: bad size\n",path);
+		return 0;
+	}
+	if ((v=add_vrl_file(vl,count,path,buf,sz)) == NULL)
+		return 0;
+
+	snprintf(v->name,sizeof(v->name),"%s",basename_of(path));
+	v->hdr = (struct vrl1_vgax_header*)v->buffer;
+	if (memcmp(v->hdr->vrl_sig,"VRL1",4) || memcmp(v->hdr->fmt_sig,"VGAX",4)) {
+		fprintf(stderr,"%s: not a VRL1 VGAX sprite\n",path);
+		return 0;
+	}
+
+	v->data = v->buffer+sizeof(*v->hdr);
+	v->datasz = v->bufsz-sizeof(*v->hdr);
+	v->lineoffs = vrl1_host_genlineoffsets(v->hdr,v->data,v->datasz);
+	if (v->lineoffs == NULL) {
+		fprintf(stderr,"%s: cannot generate line offsets\n",path);
+		return 0;
+	}
+
+	return 1;
+}
+
+/* every sprite in a VRS, named by the sheet's sprite names. Drawn through the sheet's 32-bit
+ * line offset tables if it has them (img2vrs), which -dedup sheets need, else each sprite's
+ * line offsets are generated like for a .VRL file */
+static int load_vrs(struct vrl_file **vl,unsigned int *count,const char *path,unsigned char *buf,unsigned int sz) {
+	const struct vrs_header *vrshdr = (const struct vrs_header*)buf;
+	uint32_t list,names,lo32,ofs,tofs;
+	struct vrl_file *v;
+	unsigned int i,x;
+
+	if (sz < sizeof(*vrshdr)) {
+		fprintf(stderr,"%s: bad size\n",path);
+		return 0;
+	}
+
+	list = vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST];
+	names = vrshdr->offset_table[VRS_HEADER_OFFSET_SPRITE_NAME_LIST];
+	lo32 = vrshdr->offset_table[VRS_HEADER_OFFSET_LINEOFFS32_LIST];
+
+	for (i=0;;i++) {
+		if (list == 0 || ((unsigned long)list + (i * 4ul) + 4ul) > sz) {
+			fprintf(stderr,"%s: VRS list out of range\n",path);
+			return 0;
+		}
+		if ((ofs=rd32(buf+list+(i*4u))) == 0)
+			break;
+		if (((unsigned long)ofs + sizeof(struct vrl1_vgax_header)) > sz) {
+			fprintf(stderr,"%s: sprite %u out of range\n",path,i);
+			return 0;
+		}
+		if ((v=add_vrl_file(vl,count,path,buf,sz)) == NULL)
+			return 0;
+
+		/* sprite names are C strings back to back, in the same order, ending with an empty one */
+		if (names != 0 && names < sz && buf[names] != 0 && memchr(buf+names,0,sz-names) != NULL) {
+			snprintf(v->name,sizeof(v->name),"%s",(const char*)(buf+names));
+			names += (uint32_t)strlen((const char*)(buf+names)) + 1u;
+		}
+		else {
+			snprintf(v->name,sizeof(v->name),"%s:%u",basename_of(path),i);
+			names = 0;
+		}
+
+		v->hdr = (struct vrl1_vgax_header*)(buf+ofs);
+		if (memcmp(v->hdr->vrl_sig,"VRL1",4) || memcmp(v->hdr->fmt_sig,"VGAX",4)) {
+			fprintf(stderr,"%s: %s is not a VRL1 VGAX sprite\n",path,v->name);
+			return 0;
+		}
+
+		if (lo32 != 0) {
+			if (((unsigned long)lo32 + (i * 4ul) + 4ul) > sz || (tofs=rd32(buf+lo32+(i*4u))) == 0 ||
+				((unsigned long)tofs + (v->hdr->width * 4ul)) > sz) {
+				fprintf(stderr,"%s: %s line offset table out of range\n",path,v->name);
+				return 0;
+			}
+
+			/* copied out, the tables in the file are not aligned */
+			v->lineoffs = malloc(sizeof(vrl1_vgax_offset_t) * (v->hdr->width + 1u));
+			if (v->lineoffs == NULL) return 0;
+			for (x=0;x < v->hdr->width;x++) {
+				v->lineoffs[x] = (vrl1_vgax_offset_t)rd32(buf+tofs+(x*4u));
+				if (v->lineoffs[x] >= sz) {
+					fprintf(stderr,"%s: %s column %u out of range\n",path,v->name,x);
+					return 0;
+				}
+			}
+
+			v->data = buf;
+			v->datasz = sz;
+		}
+		else {
+			v->data = buf+ofs+sizeof(*v->hdr);
+			v->datasz = sz-ofs-sizeof(*v->hdr);
+			v->lineoffs = vrl1_host_genlineoffsets(v->hdr,v->data,v->datasz);
+			if (v->lineoffs == NULL) {
+				fprintf(stderr,"%s: %s: cannot generate line offsets\n",path,v->name);
+				return 0;
+			}
+		}
+	}
+
+	if (i == 0) {
+		fprintf(stderr,"%s: no sprites\n",path);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int load_file(struct vrl_file **v,unsigned int *count,const char *path) {
+	unsigned int sz;
+	unsigned char *buf;
+
+	if ((buf=read_file(path,&sz)) == NULL)
+		return 0;
+
+	if (!memcmp(buf,"VRS1",4))
+		return load_vrs(v,count,path,buf,sz);
+
+	return load_vrl(v,count,path,buf,sz);
+}
+
+static void draw_one(struct vrl1_host_fb *fb,struct vrl_file *v,const struct draw_case *dc,unsigned int x,unsigned int y) {
+	unsigned char *data = v->data;
+	unsigned int datasz = v->datasz;
+
+	if (dc->ystep != 0)
+		vrl1_host_drawystretch(fb,x,y,dc->xstep,dc->ystep,v->hdr,v->lineoffs,data,datasz);
+	else if (dc->xstep != 64)
+		vrl1_host_drawstretch(fb,x,y,dc->xstep,v->hdr,v->lineoffs,data,datasz);
+	else
+		vrl1_host_draw(fb,x,y,v->hdr,v->lineoffs,data,datasz);
+}
+
+/* render at an x that is not a multiple of 4 so the plane rotation is exercised, planar and
+ * linear must agree, the CRC of the picture is the golden value */
+static int golden_crc(struct vrl_file *v,const struct draw_case *dc,uint32_t *crc) {
+	static unsigned char lin[2][FB_WIDTH*FB_HEIGHT];
+	struct vrl1_host_fb fb;
+	unsigned int p;
+
+	for (p=0;p < 2;p++) {
+		if (vrl1_host_fb_init(&fb,FB_WIDTH,FB_HEIGHT,(unsigned char)p) < 0) return 0;
+		vrl1_host_fb_clear(&fb,0x55);
+		draw_one(&fb,v,dc,3,5);
+		vrl1_host_fb_to_linear(&fb,lin[p]);
+		vrl1_host_fb_free(&fb);
+	}
+
+	if (memcmp(lin[0],lin[1],sizeof(lin[0]))) {
+		fprintf(stderr,"%s %s: planar and linear rendering differ\n",v->path,dc->name);
+		return 0;
+	}
+
+	*crc = crc32_buf(lin[0],sizeof(lin[0]));
+	return 1;
+}
+
+static int run_golden(struct vrl_file *v,unsigned int count,const char *gold_file,int make) {
+	char line[256],name[128],cname[64];
+	unsigned int i,checked=0,failed=0;
+	const struct draw_case *dc;
+	unsigned long want;
+	uint32_t crc;
+	FILE *fp;
+
+	if (make) {
+		for (i=0;i < count;i++) {
+			for (dc=cases;dc->name != NULL;dc++) {
+				if (!golden_crc(v+i,dc,&crc)) return 1;
+				printf("%s %s %08lx\n",v[i].name,dc->name,(unsigned long)crc);
+			}
+		}
+		return 0;
+	}
+
+	fp = fopen(gold_file,"r");
+	if (fp == NULL) {
+		fprintf(stderr,"Cannot open %s\n",gold_file);
+		return 1;
+	}
+	while (fgets(line,sizeof(line),fp) != NULL) {
+		if (line[0] == '#' || sscanf(line,"%127s %63s %lx",name,cname,&want) != 3) continue;
+
+		for (i=0;i < count && strcmp(v[i].name,name);i++);
+		for (dc=cases;dc->name != NULL && strcmp(dc->name,cname);dc++);
+		if (i >= count || dc->name == NULL) continue;
+
+		checked++;
+		if (!golden_crc(v+i,dc,&crc) || crc != (uint32_t)want) {
+			fprintf(stderr,"FAIL: %s %s: got %08lx want %08lx\n",name,cname,(unsigned long)crc,want);
+			failed++;
+		}
+	}
+	fclose(fp);
+
+	printf("%u golden images checked, %u failed\n",checked,failed);
+	return (failed != 0 || checked == 0) ? 1 : 0;
+}
+
+static void run_bench(struct vrl_file *v,unsigned int count,double duration) {
+	const struct draw_case *dc;
+	struct vrl1_host_fb fb;
+	unsigned long rd,wr,n;
+	unsigned int i,p,x,y;
+	double t0,t;
+
+	for (i=0;i < count;i++) {
+		/* bytes of VRL read and pixels stored by one unclipped 1:1 draw */
+		vrl1_host_draw_cost(v[i].hdr,v[i].lineoffs,v[i].data,&rd,&wr);
+		printf("%s: %u x %u, %lu bytes read, %lu pixels written per draw\n",v[i].name,
+			v[i].hdr->width,v[i].hdr->height,rd,wr);
+
+		for (dc=cases;dc->name != NULL;dc++) {
+			for (p=0;p < 2;p++) {
+				/* big enough that the sample sprites are never clipped */
+				if (vrl1_host_fb_init(&fb,1024,768,(unsigned char)p) < 0) return;
+				vrl1_host_fb_clear(&fb,0);
+
+				n = 0;
+				t0 = now_sec();
+				do {
+					for (x=0;x < 64;x++) {
+						y = (x * 7U) & 63U;
+						draw_one(&fb,v+i,dc,x,y);
+					}
+					n += 64;
+				} while ((t=(now_sec() - t0)) < duration);
+
+				printf("    %-10s %-7s %10.0f sprites/sec",dc->name,p ? "planar" : "linear",(double)n / t);
+				if (dc == cases) printf(" %8.1f MB/s touched",((double)n * (double)(rd + wr)) / (t * 1000000.0));
+				printf("\n");
+
+				vrl1_host_fb_free(&fb);
+			}
+		}
+	}
+}
+
+static void help() {
+	fprintf(stderr,"VRLBENCH host VRL renderer benchmark/test (C) 2016 Jonathan Campbell\n");
+	fprintf(stderr,"\n");
+	fprintf(stderr,"vrlbench [options] <file.vrl|file.vrs> [...]\n");
+	fprintf(stderr,"Every sprite of a .vrs is taken, by sprite name\n");
+	fprintf(stderr,"  -test <filename>             Compare rendering against golden CRC list\n");
+	fprintf(stderr,"  -mkgold                      Print golden CRC list to stdout\n");
+	fprintf(stderr,"  -t <seconds>                 Benchmark time per case (default 0.25)\n");
+}
+
+int main(int argc,char **argv) {
+	const char *gold_file = NULL;
+	struct vrl_file *v = NULL;
+	double duration = 0.25;
+	unsigned int count = 0;
+	int i,make_gold = 0;
+	const char *a;
+
+	for (i=1;i < argc;) {
+		a = argv[i++];
+		if (*a == '-') {
+			do { a++; } while (*a == '-');
+
+			if (!strcmp(a,"h") || !strcmp(a,"help")) {
+				help();
+				return 1;
+			}
+			else if (!strcmp(a,"test")) {
+				gold_file = argv[i++];
+			}
+			else if (!strcmp(a,"mkgold")) {
+				make_gold = 1;
+			}
+			else if (!strcmp(a,"t")) {
+				duration = atof(argv[i++]);
+			}
+			else {
+				fprintf(stderr,"Unknown switch '%s'. Use --help\n",a);
+				return 1;
+			}
+		}
+		else {
+			if (!load_file(&v,&count,a)) return 1;
+		}
+	}
+
+	if (count == 0) {
+		help();
+		return 1;
+	}
+
+	crc32_init();
+	if (gold_file != NULL || make_gold)
+		return run_golden(v,count,gold_file,make_gold);
+
+	run_bench(v,count,duration);
+	return 0;
+}
@@ -95,6 +95,16 @@ enum vrs_header_offset_type_t { // offset table indexes
 
 	VRS_HEADER_OFFSET_ANIMATION_ID_LIST=4,		// offset points to array of animation IDs (16-bit). one entry per animation. Array ends at first zero entry.
 
-	VRS_HEADER_OFFSET_ANIMATION_NAME_LIST=5		// offset points to array of animation name offsets (32-bit). Array ends at first zero entry. Offset points to ASCIIZ string. OPTIONAL.
+	VRS_HEADER_OFFSET_ANIMATION_NAME_LIST=5,	// offset points to array of animation name offsets (32-bit). Array ends at first zero entry. Offset points to ASCIIZ string. OPTIONAL.
+
+	VRS_HEADER_OFFSET_LINEOFFS16_LIST=6,		// offset points to array of line offset table offsets (32-bit), one per VRL sprite in the same order as the VRS list. Array ends at first zero entry. OPTIONAL.
+							//     Each table is hdr->width 16-bit entries, the offset of each column of the sprite relative to the START OF THE VRS FILE.
+							//     Pass the table as lineoffs and the base of the VRS blob as data to the draw functions instead of calling
+							//     vrl1_vgax_genlineoffsets() at load time. Used by 16-bit DOS builds where vrl1_vgax_offset_t is 16-bit.
+
+	VRS_HEADER_OFFSET_LINEOFFS32_LIST=7		// same as VRS_HEADER_OFFSET_LINEOFFS16_LIST, with 32-bit table entries. Used by 32-bit DOS builds. OPTIONAL.
+							//     NOTE: Sheets compiled by img2vrs with -dedup share identical columns between sprites. The VRL data following
+							//     each sprite header then omits columns already stored elsewhere in the file, so such sheets MUST be drawn
+							//     through the line offset tables. vrl1_vgax_genlineoffsets() on the sprite alone will not work.
 };
 
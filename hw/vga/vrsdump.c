@@ -22,6 +22,63 @@ unsigned char		*fence = NULL;
 
 struct vrs_header	*vrshdr = NULL;
 
+/* check the precomputed line offset tables against the VRS list: one table per sprite,
+ * hdr->width entries each, every entry pointing at column data within the file */
+static void check_lineoffs(const char *what,unsigned long offs,unsigned int entsz,unsigned long sz) {
+	uint32_t *vrl_list,*lst,*fnc = (uint32_t*)(fence + 1 - sizeof(uint32_t));
+	struct vrl1_vgax_header *vrl1;
+	unsigned int tables=0,bad=0,x;
+	unsigned long to,co;
+
+	if ((offs+4UL) > sz) {
+		printf("*%s line offset list offset out range!\n",what);
+		return;
+	}
+	if ((unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST] == 0UL ||
+		((unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST]+4UL) > sz) {
+		printf("*%s line offset tables without VRS list\n",what);
+		return;
+	}
+
+	lst = (uint32_t*)(buffer + offs);
+	vrl_list = (uint32_t*)(buffer + vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST]);
+	do {
+		if (lst >= fnc || vrl_list >= fnc) {
+			printf("*ERROR list overflow\n");
+			break;
+		}
+		if (*lst == 0 || *vrl_list == 0) {
+			if (*lst != *vrl_list) printf("*ERROR %s line offset list and VRS list differ in length\n",what);
+			break;
+		}
+		if ((*vrl_list) >= (sz - 16UL)) {
+			bad++;
+		}
+		else {
+			vrl1 = (struct vrl1_vgax_header*)(buffer + *vrl_list);
+			to = *lst;
+			if ((to + ((unsigned long)vrl1->width * entsz)) > sz) {
+				bad++;
+			}
+			else {
+				for (x=0;x < vrl1->width;x++) {
+					if (entsz == 2) co = ((uint16_t*)(buffer + to))[x];
+					else co = ((uint32_t*)(buffer + to))[x];
+					if (co >= sz) { bad++; break; }
+				}
+			}
+		}
+
+		tables++;
+		lst++;
+		vrl_list++;
+	} while (1);
+
+	printf("*%s line offset tables: %u",what,tables);
+	if (bad != 0) printf(" *ERROR %u out of bounds",bad);
+	printf("\n");
+}
+
 int main(int argc,char **argv) {
 	unsigned long sz,offs;
 	unsigned int entry;
@@ -78,6 +135,8 @@ int main(int argc,char **argv) {
 	printf("    Offset of anim list:    %lu\n",(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_ANIMATION_LIST]);
 	printf("    Offset of anim IDs:     %lu\n",(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_ANIMATION_ID_LIST]);
 	printf("    Offset of anim names:   %lu\n",(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_ANIMATION_NAME_LIST]);
+	printf("    Offset of lineoffs16:   %lu\n",(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_LINEOFFS16_LIST]);
+	printf("    Offset of lineoffs32:   %lu\n",(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_LINEOFFS32_LIST]);
 
 	if ((offs=(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST]) != 0UL) {
 		if ((offs+4UL) <= sz) {
@@ -285,6 +344,11 @@ int main(int argc,char **argv) {
 		}
 	}
 
+	if ((offs=(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_LINEOFFS16_LIST]) != 0UL)
+		check_lineoffs("16-bit",offs,2,sz);
+	if ((offs=(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_LINEOFFS32_LIST]) != 0UL)
+		check_lineoffs("32-bit",offs,4,sz);
+
 	if ((offs=(unsigned long)vrshdr->offset_table[VRS_HEADER_OFFSET_VRS_LIST]) != 0UL && (offs+4UL) <= sz) {
 		uint32_t *vrl_list_end = (uint32_t*)(fence - 1 + sizeof(uint32_t));
 		char *namelist_fence = NULL,*namelist_scan = NULL;
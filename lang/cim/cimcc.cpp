@@ -1,9 +1,14 @@
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
 
 #include <vector>
 #include <string>
@@ -91,6 +96,71 @@ namespace CIMCC {
 		uint32_t		pchar = 0;
 	};
 
+	/* Per translation unit arena for AST nodes and token strings.
+	 *
+	 * Memory is carved out of large blocks instead of one new/delete per node or string.
+	 * AST nodes deleted while parsing go on a free list for reuse, token strings are never
+	 * freed one by one. Everything is released at once by clear() or when the arena (the
+	 * compiler that owns it) is destroyed, so tokens and AST nodes must not outlive it. */
+	struct arena_t {
+		static constexpr size_t	block_size = 64u * 1024u;
+		static constexpr size_t	align = alignof(long double);
+
+		std::vector<unsigned char*>	blocks;
+		unsigned char*		ptr = NULL;
+		size_t			left = 0;
+		void*			node_free = NULL; /* free list of AST nodes */
+
+		/* statistics */
+		size_t			nodes = 0; /* AST nodes allocated, including reuse */
+		size_t			bytes = 0;
+
+		void *alloc(size_t sz) {
+			sz = (sz + align - 1u) & (~(align - 1u));
+			if (sz > left) {
+				/* large requests get a block of their own, the current block stays in use */
+				if (sz > (block_size / 4u)) {
+					unsigned char *b = new(std::nothrow) unsigned char[sz];
+					if (b == NULL) throw std::bad_alloc();
+					blocks.push_back(b);
+					bytes += sz;
+					return b;
+				}
+
+				ptr = new(std::nothrow) unsigned char[block_size];
+				if (ptr == NULL) throw std::bad_alloc();
+				blocks.push_back(ptr);
+				left = block_size;
+			}
+
+			unsigned char *r = ptr;
+			ptr += sz;
+			left -= sz;
+			bytes += sz;
+			return r;
+		}
+
+		char *strdup(const char *s,const size_t len) {
+			char *r = (char*)alloc(len+1u); /* string + NUL */
+			memcpy(r,s,len);
+			r[len] = 0;
+			return r;
+		}
+
+		void clear(void) {
+			for (auto i=blocks.begin();i!=blocks.end();i++) delete[] *i;
+			blocks.clear();
+			node_free = NULL;
+			ptr = NULL;
+			left = 0;
+		}
+
+		arena_t() { }
+		arena_t(const arena_t &) = delete;
+		arena_t &operator=(const arena_t &) = delete;
+		~arena_t() { clear(); }
+	};
+
 	struct context_t {
 		std::string		source_name;
 		unsigned char*		ptr = NULL;
@@ -130,6 +200,7 @@ namespace CIMCC {
 		unsigned char*		end = NULL; /* last valid byte (and where more is loaded) */
 		size_t			buffer_size = 0; /* allocated buffer size */
 		bool			ownership = false;
+		bool			mapped = false; /* buffer is the whole file, memory mapped */
 
 		bool is_alloc(void) const {
 			return buffer != NULL;
@@ -157,10 +228,33 @@ namespace CIMCC {
 			return true;
 		}
 
+		/* Whole file mode: the buffer is the file itself, mapped read-only, and is never
+		 * refilled or flushed. An empty file gets a normal buffer that stays empty. */
+		bool map(int fd) {
+			struct stat st;
+			void *p;
+
+			if (buffer != NULL) return false;
+			if (fstat(fd,&st) < 0 || !S_ISREG(st.st_mode)) return false;
+			if (st.st_size == 0) return alloc();
+
+			p = mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if (p == MAP_FAILED) return false;
+			madvise(p,(size_t)st.st_size,MADV_SEQUENTIAL);
+
+			buffer = read = (unsigned char*)p;
+			buffer_size = (size_t)st.st_size;
+			end = buffer + buffer_size;
+			mapped = true;
+			return true;
+		}
+
 		void free(void) {
-			if (buffer && ownership) delete[] buffer;
+			if (buffer && mapped) munmap(buffer,buffer_size);
+			else if (buffer && ownership) delete[] buffer;
 			buffer = read = end = NULL;
 			ownership = false;
+			mapped = false;
 			buffer_size = 0;
 		}
 
@@ -173,7 +267,7 @@ namespace CIMCC {
 		}
 
 		void flush(size_t keep=0/*how much to keep prior to read ptr*/) {
-			if (buffer) {
+			if (buffer && !mapped) {
 				assert(sanity_check());
 
 				/* it is hard to flush if the caller asks to keep too much */
@@ -198,7 +292,7 @@ namespace CIMCC {
 		}
 
 		void lazy_flush(size_t keep=0) {
-			if (size_t(fence() - end) < (buffer_size / 2u))
+			if (!mapped && size_t(fence() - end) < (buffer_size / 2u))
 				flush(keep);
 		}
 
@@ -405,13 +499,11 @@ namespace CIMCC {
 
 		void on_pre_move(void) { /* our var is about to be replaced by a new var on std::move */
 			length = 0;
-			if (name) delete[] name;
-			name = NULL;
+			name = NULL; /* allocated from the compiler arena, not freed here */
 		}
 
 		void on_delete(void) {
 			length = 0;
-			if (name) delete[] name;
 			name = NULL;
 		}
 
@@ -454,13 +546,11 @@ namespace CIMCC {
 
 		void on_pre_move(void) { /* our var is about to be replaced by a new var on std::move */
 			length = 0;
-			if (data) free(data);
-			data = NULL;
+			data = NULL; /* allocated from the compiler arena, not freed here */
 		}
 
 		void on_delete(void) {
 			length = 0;
-			if (data) free(data);
 			data = NULL;
 		}
 	};
@@ -665,6 +755,40 @@ namespace CIMCC {
 		ast_node_op_t			op = ast_node_op_t::none;
 		struct token_t			tv;
 
+		/* nodes are allocated from the compiler arena with new(arena) ast_node_t. the arena
+		 * they came from is kept just in front of the node, so delete can put the node back
+		 * on that arena's free list. */
+		static constexpr size_t		arena_hdr = arena_t::align;
+
+		static void *operator new(size_t sz,arena_t &a) {
+			unsigned char *p;
+
+			assert(sz == sizeof(ast_node_t));
+			if (a.node_free != NULL) {
+				p = (unsigned char*)a.node_free;
+				a.node_free = *((void**)p);
+			}
+			else {
+				p = (unsigned char*)a.alloc(arena_hdr + sz) + arena_hdr;
+				*((arena_t**)(p - arena_hdr)) = &a;
+			}
+
+			a.nodes++;
+			return p;
+		}
+
+		static void operator delete(void *p) {
+			if (p != NULL) {
+				arena_t *a = *((arena_t**)((unsigned char*)p - arena_hdr));
+				*((void**)p) = a->node_free;
+				a->node_free = p;
+			}
+		}
+
+		static void operator delete(void *p,arena_t &) { /* constructor threw */
+			operator delete(p);
+		}
+
 		bool unlink_child(void) {
 			if (child) {
 				struct ast_node_t *dm = child;
@@ -738,6 +862,12 @@ namespace CIMCC {
 			return pb_ctx.alloc(sz);
 		}
 
+		/* read the whole source through a read-only memory map instead of the refill callback */
+		bool map_source_file(int fd) {
+			pb.free();
+			return pb.map(fd);
+		}
+
 		void free_source_ctx(void) {
 			pb_ctx.free();
 		}
@@ -822,7 +952,9 @@ namespace CIMCC {
 		}
 
 		void refill(void);
+		size_t lex(void);
 		bool compile(void);
+		bool begin_source(void);
 		void free_ast(void);
 		void whitespace(void);
 		void gtok(token_t &t);
@@ -882,6 +1014,7 @@ namespace CIMCC {
 		static constexpr unsigned int FN_EXPR_ANONYMOUS = (1u << 1u);
 
 		ast_node_t*		root_node = NULL;
+		arena_t			arena; /* AST nodes and token strings of this translation unit */
 
 		static constexpr size_t tok_buf_size = 32;
 		static constexpr size_t tok_buf_threshhold = 16;
@@ -990,7 +1123,7 @@ namespace CIMCC {
 
 		if (t.type == token_type_t::intval || t.type == token_type_t::floatval || t.type == token_type_t::characterliteral) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::constant;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -998,63 +1131,63 @@ namespace CIMCC {
 		}
 		else if (tok_bufpeek(0).type == token_type_t::poundsign && tok_bufpeek(1).type == token_type_t::identifier) {
 			if (tok_bufpeek(1).v.identifier.strcmp("define")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_define;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("undef")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_undef;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("defined")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_defined;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("defval")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_defval;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("warning")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_warning;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("error")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_error;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("type")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_type;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("include")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_include;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
 				return true;
 			}
 			else if (tok_bufpeek(1).v.identifier.strcmp("deftype")) {
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::r_pound_deftype;
 				pchnode->tv = std::move(tok_bufpeek(0));
 				tok_bufdiscard(2);
@@ -1076,7 +1209,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::stringliteral) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::constant;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1086,10 +1219,10 @@ namespace CIMCC {
 			 * strcat(strcat(strcat("c" "d") "b") "a") */
 			while (tok_bufpeek().type == token_type_t::stringliteral) {
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::strcat;
 				pchnode->child = sav_p;
-				sav_p->next = new ast_node_t;
+				sav_p->next = new(arena) ast_node_t;
 				sav_p->next->op = ast_node_op_t::constant;
 				sav_p->next->tv = std::move(tok_bufpeek());
 				tok_bufdiscard();
@@ -1099,7 +1232,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_const) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_const;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1108,7 +1241,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_constexpr) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_constexpr;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1117,7 +1250,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_compileexpr) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_compileexpr;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1126,7 +1259,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_sizeof) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_sizeof;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1135,7 +1268,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_offsetof) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_offsetof;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1144,7 +1277,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_static_assert) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_static_assert;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1153,7 +1286,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_size_t) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_size_t;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1162,7 +1295,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_ssize_t) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_ssize_t;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1171,7 +1304,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_static) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_static;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1180,7 +1313,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_extern) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_extern;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1189,7 +1322,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_auto) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_auto;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1198,7 +1331,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_signed) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_signed;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1207,7 +1340,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_unsigned) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_unsigned;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1216,7 +1349,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_long) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_long;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1225,7 +1358,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_int) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_int;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1234,7 +1367,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_bool) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_bool;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1243,7 +1376,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_true) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_true;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1252,7 +1385,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_false) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_false;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1261,7 +1394,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_near) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_near;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1270,7 +1403,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_far) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_far;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1279,7 +1412,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_huge) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_huge;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1288,7 +1421,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_float) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_float;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1297,7 +1430,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_this) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_this;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1306,7 +1439,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_void) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_void;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1315,7 +1448,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_char) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_char;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1324,7 +1457,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::ellipsis) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::ellipsis;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1333,7 +1466,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_volatile) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_volatile;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1342,7 +1475,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::identifier) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::identifier;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1351,7 +1484,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::r_typeof) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_typeof;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1369,7 +1502,7 @@ namespace CIMCC {
 		}
 		else if (t.type == token_type_t::dblleftsquarebracket) {
 			assert(pchnode == NULL);
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::i_attributes;
 			pchnode->tv = std::move(t);
 			tok_bufdiscard();
@@ -1381,14 +1514,14 @@ namespace CIMCC {
 				if (tok_bufpeek(0).type == token_type_t::r_using && tok_bufpeek(1).type == token_type_t::identifier) {
 					ast_node_t **sn;
 
-					(*n) = new ast_node_t;
+					(*n) = new(arena) ast_node_t;
 					(*n)->op = ast_node_op_t::r_using;
 					(*n)->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
 					sn = &((*n)->child);
 					n = &((*n)->next);
 
-					(*sn) = new ast_node_t;
+					(*sn) = new(arena) ast_node_t;
 					(*sn)->op = ast_node_op_t::r_namespace;
 					sn = &((*sn)->next);
 
@@ -1425,7 +1558,7 @@ namespace CIMCC {
 			 *  \
 			 *   +-- [expression] */
 
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::subexpression;
 			if (!expression(pchnode->child))
 				return false;
@@ -1477,7 +1610,7 @@ namespace CIMCC {
 			 *   +-- [expression]
 			 */
 
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::i_array;
 
 			if (tok_bufpeek().type == token_type_t::closecurly) {
@@ -1509,7 +1642,7 @@ namespace CIMCC {
 			return true;
 		}
 		else if (t.type == token_type_t::r_fn) { /* anonymous function */
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::r_fn;
 			pchnode->tv = std::move(tok_bufpeek());
 			tok_bufdiscard();
@@ -1524,7 +1657,7 @@ namespace CIMCC {
 				if (!let_datatype_expression(t)) return false;
 				assert(t != NULL);
 
-				(*n) = new ast_node_t;
+				(*n) = new(arena) ast_node_t;
 				(*n)->op = ast_node_op_t::i_datatype;
 				(*n)->child = t;
 				n = &((*n)->next);
@@ -1550,7 +1683,7 @@ namespace CIMCC {
 		 *  \             \
 		 *   +--- [expr]   +--- [expr] */
 #define NLEX assignment_expression
-		pchnode = new ast_node_t;
+		pchnode = new(arena) ast_node_t;
 		pchnode->op = ast_node_op_t::argument;
 		{
 			ast_node_t **n = &(pchnode->child);
@@ -1570,7 +1703,7 @@ namespace CIMCC {
 		while (tok_bufpeek().type == token_type_t::comma) { /* , comma operator */
 			tok_bufdiscard(); /* eat it */
 
-			nb->next = new ast_node_t; nb = nb->next;
+			nb->next = new(arena) ast_node_t; nb = nb->next;
 			nb->op = ast_node_op_t::argument;
 			{
 				ast_node_t **n = &(nb->child);
@@ -1593,9 +1726,9 @@ namespace CIMCC {
 	bool compiler::argument_expression_funccall(ast_node_t* &pchnode) {
 #define NLEX assignment_expression
 		if (tok_bufpeek(0).type == token_type_t::identifier && tok_bufpeek(1).type == token_type_t::colon) {
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::argument;
-			pchnode->child = new ast_node_t;
+			pchnode->child = new(arena) ast_node_t;
 			pchnode->child->op = ast_node_op_t::named_parameter;
 			if (!primary_expression(pchnode->child->child))
 				return false;
@@ -1607,7 +1740,7 @@ namespace CIMCC {
 				return false;
 		}
 		else {
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::argument;
 			if (!NLEX(pchnode->child))
 				return false;
@@ -1649,7 +1782,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::scopeoperator;
 				pchnode->child = sav_p;
 
@@ -1707,7 +1840,7 @@ namespace CIMCC {
 
 	bool compiler::let_datatype_expression(ast_node_t* &tnode) {
 #define NLEX cpp_scope_expression
-		tnode = new ast_node_t;
+		tnode = new(arena) ast_node_t;
 		tnode->op = ast_node_op_t::identifier_list;
 
 		ast_node_t **n = &(tnode->child);
@@ -1731,7 +1864,7 @@ namespace CIMCC {
 	}
 
 	bool compiler::split_identifiers_expression(ast_node_t* &tnode,ast_node_t* &inode) {
-		tnode = new ast_node_t;
+		tnode = new(arena) ast_node_t;
 		tnode->op = ast_node_op_t::identifier_list;
 
 		ast_node_t **n = &(tnode->child);
@@ -1809,14 +1942,14 @@ namespace CIMCC {
 				if (tok_bufpeek().type == token_type_t::star) {
 					tok_bufdiscard();
 					assert(*d == NULL);
-					(*d) = new ast_node_t;
+					(*d) = new(arena) ast_node_t;
 					(*d)->op = ast_node_op_t::dereference;
 					d = &((*d)->child);
 				}
 				else if (tok_bufpeek().type == token_type_t::ampersand) {
 					tok_bufdiscard();
 					assert(*d == NULL);
-					(*d) = new ast_node_t;
+					(*d) = new(arena) ast_node_t;
 					(*d)->op = ast_node_op_t::addressof;
 					d = &((*d)->child);
 				}
@@ -1824,12 +1957,12 @@ namespace CIMCC {
 					tok_bufdiscard();
 
 					assert(*d == NULL);
-					(*d) = new ast_node_t;
+					(*d) = new(arena) ast_node_t;
 					(*d)->op = ast_node_op_t::addressof;
 					d = &((*d)->child);
 
 					assert(*d == NULL);
-					(*d) = new ast_node_t;
+					(*d) = new(arena) ast_node_t;
 					(*d)->op = ast_node_op_t::addressof;
 					d = &((*d)->child);
 				}
@@ -1854,7 +1987,7 @@ namespace CIMCC {
 				else if (tok_bufpeek().type == token_type_t::r_fn && (flags & TYPE_AND_IDENT_FL_ALLOW_FN)) {
 					tok_bufdiscard();
 					assert(*d == NULL);
-					(*d) = new ast_node_t;
+					(*d) = new(arena) ast_node_t;
 					(*d)->op = ast_node_op_t::r_fn;
 					d = &((*d)->child);
 					retv |= TYPE_AND_IDENT_RT_FN;
@@ -1900,7 +2033,7 @@ namespace CIMCC {
 			/* NTS: ->next is used to chain this identifier to another operand i.e. + or -, use ->child */
 			if (tok_bufpeek().type == token_type_t::identifier || tok_bufpeek().type == token_type_t::poundsign || is_reserved_identifier(tok_bufpeek().type)) {
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::identifier_list;
 				pchnode->child = sav_p;
 
@@ -1930,7 +2063,7 @@ namespace CIMCC {
 				 *   +-- [expression] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::postincrement;
 				pchnode->child = sav_p;
 			}
@@ -1942,7 +2075,7 @@ namespace CIMCC {
 				 *   +-- [expression] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::postdecrement;
 				pchnode->child = sav_p;
 			}
@@ -1954,7 +2087,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::structaccess;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next)) // TODO: should be IDENTIFIER only
@@ -1968,7 +2101,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::structptraccess;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next)) // TODO: should be IDENTIFIER only
@@ -1982,7 +2115,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [subscript expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::arraysubscript;
 				pchnode->child = sav_p;
 				if (!expression(sav_p->next))
@@ -2004,7 +2137,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [argument] -> [argument] -> [argument] ... */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::functioncall;
 				pchnode->child = sav_p;
 
@@ -2047,9 +2180,9 @@ namespace CIMCC {
 					 *         \
 					 *          +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::addressof;
-					pchnode->child = new ast_node_t;
+					pchnode->child = new(arena) ast_node_t;
 					pchnode->child->op = ast_node_op_t::addressof;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child->child);
@@ -2059,7 +2192,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::addressof;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2069,7 +2202,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::dereference;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2079,7 +2212,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::predecrement;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2089,7 +2222,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::preincrement;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2099,7 +2232,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::negate;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2109,7 +2242,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::unaryplus;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2119,7 +2252,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::logicalnot;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2129,7 +2262,7 @@ namespace CIMCC {
 					 *  \
 					 *   +--- expression */
 					assert(pchnode == NULL);
-					pchnode = new ast_node_t;
+					pchnode = new(arena) ast_node_t;
 					pchnode->op = ast_node_op_t::binarynot;
 					pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 					return unary_expression(pchnode->child);
@@ -2156,7 +2289,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::multiply;
 				pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 				pchnode->child = sav_p;
@@ -2169,7 +2302,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::divide;
 				pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 				pchnode->child = sav_p;
@@ -2182,7 +2315,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::modulo;
 				pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 				pchnode->child = sav_p;
@@ -2213,7 +2346,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::add;
 				pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 				pchnode->child = sav_p;
@@ -2226,7 +2359,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::subtract;
 				pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 				pchnode->child = sav_p;
@@ -2256,7 +2389,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::leftshift;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2270,7 +2403,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::rightshift;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2299,7 +2432,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::lessthan;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2313,7 +2446,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::greaterthan;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2327,7 +2460,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::lessthanorequal;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2341,7 +2474,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::greaterthanorequal;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2370,7 +2503,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::equals;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2384,7 +2517,7 @@ namespace CIMCC {
 				 *   +-- [left expr] -> [right expr] */
 
 				ast_node_t *sav_p = pchnode;
-				pchnode = new ast_node_t;
+				pchnode = new(arena) ast_node_t;
 				pchnode->op = ast_node_op_t::notequals;
 				pchnode->child = sav_p;
 				if (!NLEX(sav_p->next))
@@ -2412,7 +2545,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::binary_and;
 			pchnode->child = sav_p;
 			if (!NLEX(sav_p->next))
@@ -2436,7 +2569,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::binary_xor;
 			pchnode->child = sav_p;
 			if (!NLEX(sav_p->next))
@@ -2460,7 +2593,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::binary_or;
 			pchnode->child = sav_p;
 			if (!NLEX(sav_p->next))
@@ -2484,7 +2617,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::logical_and;
 			pchnode->child = sav_p;
 			if (!NLEX(sav_p->next))
@@ -2508,7 +2641,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::logical_or;
 			pchnode->child = sav_p;
 			if (!NLEX(sav_p->next))
@@ -2532,7 +2665,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [middle expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::ternary;
 			pchnode->child = sav_p;
 			if (!expression(sav_p->next))
@@ -2567,7 +2700,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assign;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2579,7 +2712,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignadd;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2591,7 +2724,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignsubtract;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2603,7 +2736,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignmultiply;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2615,7 +2748,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assigndivide;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2627,7 +2760,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignmodulo;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2639,7 +2772,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignand;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2651,7 +2784,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignxor;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2663,7 +2796,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignor;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2675,7 +2808,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignleftshift;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2687,7 +2820,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::assignrightshift;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2709,7 +2842,7 @@ namespace CIMCC {
 			 *   +-- [left expr] -> [right expr] */
 
 			ast_node_t *sav_p = pchnode;
-			pchnode = new ast_node_t;
+			pchnode = new(arena) ast_node_t;
 			pchnode->op = ast_node_op_t::comma;
 			pchnode->tv = std::move(tok_bufpeek(0)); tok_bufdiscard(); /* eat it */
 			pchnode->child = sav_p;
@@ -2729,7 +2862,7 @@ namespace CIMCC {
 					return false;
 			}
 
-			(*inode_next) = new ast_node_t;
+			(*inode_next) = new(arena) ast_node_t;
 			(*inode_next)->op = ast_node_op_t::i_anonymous;
 			inode_next = &((*inode_next)->next);
 		}
@@ -2800,14 +2933,14 @@ namespace CIMCC {
 		 *
 		 * "*" serves as a way to specify that past this point, parameters must be referenced by name, not position, just as in Python */
 		if (tok_bufpeek().type == token_type_t::ellipsis) {
-			inode = new ast_node_t;
+			inode = new(arena) ast_node_t;
 			inode->op = ast_node_op_t::ellipsis;
 			inode->tv = std::move(tok_bufpeek(0));
 			tok_bufdiscard();
 			return true;
 		}
 		else if (tok_bufpeek().type == token_type_t::star) {
-			inode = new ast_node_t;
+			inode = new(arena) ast_node_t;
 			inode->op = ast_node_op_t::named_arg_required_boundary;
 			inode->tv = std::move(tok_bufpeek(0));
 			tok_bufdiscard();
@@ -2844,7 +2977,7 @@ namespace CIMCC {
 		if (tok_bufpeek().type == token_type_t::leftsquarebracket) {
 			tok_bufdiscard(); /* eat it */
 
-			ast_node_t *a = new ast_node_t;
+			ast_node_t *a = new(arena) ast_node_t;
 			a->op = ast_node_op_t::arraysubscript;
 
 			/* allow [] i.e. for function parameters */
@@ -2870,7 +3003,7 @@ namespace CIMCC {
 		else if (tok_bufpeek().type == token_type_t::equal) {
 			tok_bufdiscard(); /* eat it */
 
-			enode = new ast_node_t;
+			enode = new(arena) ast_node_t;
 			enode->op = ast_node_op_t::assign;
 			if (!assignment_expression(enode->child))
 				return false;
@@ -2911,7 +3044,7 @@ namespace CIMCC {
 	}
 
 	bool compiler::if_statement(ast_node_t* &apnode) {
-		apnode = new ast_node_t;
+		apnode = new(arena) ast_node_t;
 		apnode->op = ast_node_op_t::r_if;
 		apnode->tv = std::move(tok_bufpeek()); //assumed to be the "if" token!
 		tok_bufdiscard();
@@ -2937,7 +3070,7 @@ namespace CIMCC {
 		assert(n->next == NULL);
 
 		if (tok_bufpeek().type == token_type_t::r_else) {
-			n->next = new ast_node_t;
+			n->next = new(arena) ast_node_t;
 			n->next->op = ast_node_op_t::r_else;
 			n->next->tv = std::move(tok_bufpeek());
 			tok_bufdiscard();
@@ -2964,11 +3097,11 @@ namespace CIMCC {
 			}
 			else {
 				if (apnode) {
-					apnode->next = new ast_node_t;
+					apnode->next = new(arena) ast_node_t;
 					apnode = apnode->next;
 				}
 				else {
-					rnode = apnode = new ast_node_t;
+					rnode = apnode = new(arena) ast_node_t;
 				}
 				apnode->op = ast_node_op_t::statement;
 				apnode->tv.position = tok_bufpeek(0).position;
@@ -2976,7 +3109,7 @@ namespace CIMCC {
 				while (tok_bufpeek(0).type == token_type_t::identifier && tok_bufpeek(1).type == token_type_t::colon) { /* label: ... */
 					apnode->op = ast_node_op_t::label;
 					apnode->tv.position = tok_bufpeek(0).position;
-					apnode->next = new ast_node_t;
+					apnode->next = new(arena) ast_node_t;
 					apnode = apnode->next;
 					apnode->op = ast_node_op_t::statement;
 					tok_bufdiscard(2);
@@ -2984,7 +3117,7 @@ namespace CIMCC {
 
 				if (tok_bufpeek(0).type == token_type_t::poundsign) {
 					if (tok_bufpeek(1).type == token_type_t::r_if) {
-						apnode->child = new ast_node_t;
+						apnode->child = new(arena) ast_node_t;
 						apnode->child->op = ast_node_op_t::r_pound_if;
 						apnode->child->tv = std::move(tok_bufpeek(0));
 						tok_bufdiscard(2);
@@ -3026,21 +3159,21 @@ namespace CIMCC {
 					ast_node_t **n = &(apnode->child);
 
 					assert(*n == NULL);
-					(*n) = new ast_node_t;
+					(*n) = new(arena) ast_node_t;
 					(*n)->op = ast_node_op_t::r_namespace;
 					(*n)->tv = std::move(tok_bufpeek());
 					tok_bufdiscard(); /* eat the namespace */
 					n = &((*n)->child);
 
 					if (tok_bufpeek().type == token_type_t::identifier) {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::identifier;
 						(*n)->tv = std::move(tok_bufpeek());
 						tok_bufdiscard();
 						n = &((*n)->next);
 					}
 					else {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_anonymous;
 						n = &((*n)->next);
 					}
@@ -3058,7 +3191,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_return) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_return;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3078,7 +3211,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_break) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_break;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3093,7 +3226,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_continue) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_continue;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3108,7 +3241,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_struct || tok_bufpeek().type == token_type_t::r_union) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					if (tok_bufpeek().type == token_type_t::r_union)
 						apnode->child->op = ast_node_op_t::r_union;
 					else
@@ -3124,7 +3257,7 @@ namespace CIMCC {
 						while (1) {
 							if (is_reserved_identifier(tok_bufpeek().type) || tok_bufpeek().type == token_type_t::dblleftsquarebracket || tok_bufpeek().type == token_type_t::poundsign) {
 								if (sn == NULL) {
-									(*n) = new ast_node_t;
+									(*n) = new(arena) ast_node_t;
 									(*n)->op = ast_node_op_t::identifier_list;
 									sn = &((*n)->child);
 									n = &((*n)->next);
@@ -3146,7 +3279,7 @@ namespace CIMCC {
 						assert(*n == NULL);
 					}
 					else {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_anonymous;
 						n = &((*n)->next);
 						assert(*n == NULL);
@@ -3164,7 +3297,7 @@ namespace CIMCC {
 					if (tok_bufpeek().type == token_type_t::identifier) {
 						/* then the first variable */
 						{
-							(*n) = new ast_node_t;
+							(*n) = new(arena) ast_node_t;
 							(*n)->op = ast_node_op_t::r_let;
 
 							ast_node_t *i=NULL,*e=NULL;
@@ -3182,7 +3315,7 @@ namespace CIMCC {
 						}
 
 						while (tok_bufpeek().type == token_type_t::comma) {
-							(*n) = new ast_node_t;
+							(*n) = new(arena) ast_node_t;
 							(*n)->op = ast_node_op_t::r_let;
 
 							ast_node_t *i=NULL,*e=NULL;
@@ -3212,7 +3345,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_fn) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_fn;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3227,7 +3360,7 @@ namespace CIMCC {
 						if (!let_datatype_expression(t)) return false;
 						assert(t != NULL);
 
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_datatype;
 						(*n)->child = t;
 						n = &((*n)->next);
@@ -3258,25 +3391,25 @@ namespace CIMCC {
 
 					assert(*n == NULL);
 
-					(*n) = new ast_node_t;
+					(*n) = new(arena) ast_node_t;
 					(*n)->op = ast_node_op_t::r_using;
 					tok_bufdiscard(); /* eat using */
 					n = &((*n)->child);
 
-					(*n) = new ast_node_t;
+					(*n) = new(arena) ast_node_t;
 					(*n)->op = ast_node_op_t::r_namespace;
 					tok_bufdiscard(); /* eat namespace */
 					n = &((*n)->next);
 
 					if (tok_bufpeek().type == token_type_t::identifier) {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::identifier;
 						(*n)->tv = std::move(tok_bufpeek());
 						tok_bufdiscard();
 						n = &((*n)->next);
 					}
 					else {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_anonymous;
 						n = &((*n)->next);
 					}
@@ -3290,7 +3423,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_typedef) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_typedef;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3304,7 +3437,7 @@ namespace CIMCC {
 						if (!let_datatype_expression(t)) return false;
 						assert(t != NULL);
 
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_datatype;
 						(*n)->child = t;
 						n = &((*n)->next);
@@ -3312,7 +3445,7 @@ namespace CIMCC {
 
 					/* then the first variable */
 					{
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::r_let;
 
 						ast_node_t *i=NULL,*e=NULL;
@@ -3330,7 +3463,7 @@ namespace CIMCC {
 					}
 
 					while (tok_bufpeek().type == token_type_t::comma) {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::r_let;
 
 						ast_node_t *i=NULL,*e=NULL;
@@ -3359,7 +3492,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_asm || tok_bufpeek().type == token_type_t::r__asm || tok_bufpeek().type == token_type_t::r___asm || tok_bufpeek().type == token_type_t::r___asm__) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_asm;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3368,7 +3501,7 @@ namespace CIMCC {
 
 					while (1) {
 						if (tok_bufpeek().type == token_type_t::r_volatile) {
-							(*n) = new ast_node_t;
+							(*n) = new(arena) ast_node_t;
 							(*n)->op = ast_node_op_t::r_volatile;
 							(*n)->tv = std::move(tok_bufpeek());
 							tok_bufdiscard();
@@ -3408,7 +3541,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_let) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::i_compound_let;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3422,7 +3555,7 @@ namespace CIMCC {
 						if (!let_datatype_expression(t)) return false;
 						assert(t != NULL);
 
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::i_datatype;
 						(*n)->child = t;
 						n = &((*n)->next);
@@ -3430,7 +3563,7 @@ namespace CIMCC {
 
 					/* then the first variable */
 					{
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::r_let;
 
 						ast_node_t *i=NULL,*e=NULL;
@@ -3447,7 +3580,7 @@ namespace CIMCC {
 					}
 
 					while (tok_bufpeek().type == token_type_t::comma) {
-						(*n) = new ast_node_t;
+						(*n) = new(arena) ast_node_t;
 						(*n)->op = ast_node_op_t::r_let;
 
 						ast_node_t *i=NULL,*e=NULL;
@@ -3475,7 +3608,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_for) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_for;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3487,7 +3620,7 @@ namespace CIMCC {
 					tok_bufdiscard();
 
 					if (tok_bufpeek().type == token_type_t::semicolon) {
-						nn->next = new ast_node_t;
+						nn->next = new(arena) ast_node_t;
 						nn->next->op = ast_node_op_t::none;
 					}
 					else {
@@ -3501,7 +3634,7 @@ namespace CIMCC {
 					tok_bufdiscard();
 
 					if (tok_bufpeek().type == token_type_t::semicolon) {
-						nn->next = new ast_node_t;
+						nn->next = new(arena) ast_node_t;
 						nn->next->op = ast_node_op_t::none;
 					}
 					else {
@@ -3515,7 +3648,7 @@ namespace CIMCC {
 					tok_bufdiscard();
 
 					if (tok_bufpeek().type == token_type_t::closeparen) {
-						nn->next = new ast_node_t;
+						nn->next = new(arena) ast_node_t;
 						nn->next->op = ast_node_op_t::none;
 					}
 					else {
@@ -3534,7 +3667,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_do) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_do;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3562,7 +3695,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_while) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_while;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3584,7 +3717,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_switch) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_switch;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3619,7 +3752,7 @@ namespace CIMCC {
 
 						while (1) {
 							if (tok_bufpeek().type == token_type_t::r_case) { /* case conditionalexpression : statement */
-								nl->next = new ast_node_t;
+								nl->next = new(arena) ast_node_t;
 								nl->next->op = ast_node_op_t::r_case;
 								nl->next->tv = std::move(tok_bufpeek());
 								tok_bufdiscard();
@@ -3635,13 +3768,13 @@ namespace CIMCC {
 								casefirst = casenode = nl->child;
 							}
 							else if (tok_bufpeek().type == token_type_t::r_default) { /* default : statement */
-								nl->next = new ast_node_t;
+								nl->next = new(arena) ast_node_t;
 								nl->next->op = ast_node_op_t::r_case;
 								nl->next->tv = std::move(tok_bufpeek());
 								tok_bufdiscard();
 								nl = nl->next;
 
-								nl->child = new ast_node_t;
+								nl->child = new(arena) ast_node_t;
 								nl->child->op = ast_node_op_t::r_default;
 
 								if (tok_bufpeek().type != token_type_t::colon)
@@ -3681,7 +3814,7 @@ namespace CIMCC {
 				}
 				else if (tok_bufpeek().type == token_type_t::r_goto) {
 					assert(apnode->child == NULL);
-					apnode->child = new ast_node_t;
+					apnode->child = new(arena) ast_node_t;
 					apnode->child->op = ast_node_op_t::r_goto;
 					apnode->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3690,7 +3823,7 @@ namespace CIMCC {
 					if (tok_bufpeek().type != token_type_t::identifier)
 						return false;
 
-					apnode->child->child = new ast_node_t;
+					apnode->child->child = new(arena) ast_node_t;
 					apnode->child->child->op = ast_node_op_t::identifier;
 					apnode->child->child->tv = std::move(tok_bufpeek());
 					tok_bufdiscard();
@@ -3725,16 +3858,14 @@ namespace CIMCC {
 	}
 
 	void compiler::free_ast(void) {
-		root_node->free_nodes();
-		delete root_node;
+		/* every node and token string is in the arena, there is no need to walk the tree.
+		 * any tokens still buffered point into the arena too. */
 		root_node = NULL;
+		tok_buf_clear();
+		arena.clear();
 	}
 
-	bool compiler::compile(void) {
-		ast_node_t *apnode = NULL,*rnode = NULL;
-		bool ok = true;
-		token_t tok;
-
+	bool compiler::begin_source(void) {
 		if (!pb.is_alloc()) {
 			if (!pb.alloc(4096))
 				return false;
@@ -3749,6 +3880,33 @@ namespace CIMCC {
 			(*tok_snamelist).push_back(std::move(t));
 		}
 		tok_pos.first_line();
+		return true;
+	}
+
+	size_t compiler::lex(void) {
+		size_t count = 0;
+		token_t t;
+
+		if (!begin_source())
+			return 0;
+
+		do {
+			gtok(t);
+			if (t.type == token_type_t::eof) break;
+			count++;
+		} while (1);
+
+		return count;
+	}
+
+	bool compiler::compile(void) {
+		ast_node_t *apnode = NULL,*rnode = NULL;
+		bool ok = true;
+		token_t tok;
+
+		if (!begin_source())
+			return false;
+
 		tok_buf_refill();
 		while (!tok_buf_empty()) {
 			if (!statement(rnode,apnode)) {
@@ -3914,7 +4072,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size() * sizeof(uint16_t);
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == (tmp.size() * sizeof(uint16_t)));
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -3952,7 +4110,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size() * sizeof(uint32_t);
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == (tmp.size() * sizeof(uint32_t)));
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -3999,7 +4157,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size();
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == tmp.size());
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -4045,7 +4203,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size() * sizeof(uint16_t);
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == (tmp.size() * sizeof(uint16_t)));
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -4071,7 +4229,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size() * sizeof(uint32_t);
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == (tmp.size() * sizeof(uint32_t)));
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -4109,7 +4267,7 @@ namespace CIMCC {
 			t.v.chrstrlit.length = tmp.size();
 			if (t.v.chrstrlit.length != 0) {
 				assert(t.v.chrstrlit.length == tmp.size());
-				t.v.chrstrlit.data = malloc(t.v.chrstrlit.length);
+				t.v.chrstrlit.data = arena.alloc(t.v.chrstrlit.length);
 				memcpy(t.v.chrstrlit.data,tmp.data(),t.v.chrstrlit.length);
 			}
 			else {
@@ -4377,9 +4535,7 @@ namespace CIMCC {
 			t.type = token_type_t::identifier;
 			t.v.identifier.length = identlen;
 			assert(t.v.identifier.length != 0);
-			t.v.identifier.name = new char[t.v.identifier.length+1]; /* string + NUL */
-			memcpy(t.v.identifier.name,start,t.v.identifier.length);
-			t.v.identifier.name[t.v.identifier.length] = 0;
+			t.v.identifier.name = arena.strdup((const char*)start,t.v.identifier.length);
 		}
 	}
 
@@ -4611,9 +4767,10 @@ namespace CIMCC {
 		 * aren't actually writing numbers.
 		 * The only other way that less than 1024
 		 * could be available is if we're reading
-		 * near or at EOF.*/
+		 * near or at EOF. A memory mapped buffer
+		 * already holds the whole file. */
 		pb.lazy_flush();
-		assert(size_t(pb.fence() - pb.read) >= (pb.buffer_size / 2u)); /* lazy_flush() did it's job? */
+		assert(pb.mapped || size_t(pb.fence() - pb.read) >= (pb.buffer_size / 2u)); /* lazy_flush() did it's job? */
 		refill();
 	}
 
@@ -5785,25 +5942,146 @@ static int refill_fdio(unsigned char *at,size_t sz,void *context,size_t context_
 	return read(ctx->fd,at,sz);
 }
 
+static double monotonic_time(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return double(ts.tv_sec) + (double(ts.tv_nsec) / 1000000000.0);
+}
+
+static bool open_source(CIMCC::compiler &cc,src_ctx &fdctx,const char *path,const bool use_mmap) {
+	fdctx.fd = open(path,O_RDONLY);
+	if (fdctx.fd < 0) {
+		fprintf(stderr,"Failed to open file\n");
+		return false;
+	}
+	cc.set_source_name(path);
+
+	if (use_mmap) {
+		if (!cc.map_source_file(fdctx.fd)) {
+			fprintf(stderr,"Failed to map file\n");
+			return false;
+		}
+
+		fdctx.close(); /* the mapping stays */
+	}
+	else {
+		cc.set_source_cb(refill_fdio);
+		cc.set_source_ctx(&fdctx,sizeof(fdctx));
+	}
+
+	return true;
+}
+
+/* lexer and parser throughput, to keep an eye on regressions */
+static int bench(const char *path,const bool use_mmap,const unsigned int passes) {
+	double lex_time = 0,parse_time = 0,t;
+	size_t tokens = 0,nodes = 0,arena_bytes = 0;
+	unsigned long long bytes = 0;
+	struct stat st;
+
+	if (stat(path,&st) < 0) {
+		fprintf(stderr,"Failed to stat file\n");
+		return 1;
+	}
+
+	for (unsigned int pass=0;pass < passes;pass++) {
+		{
+			CIMCC::compiler cc;
+			src_ctx fdctx;
+
+			if (!open_source(cc,fdctx,path,use_mmap))
+				return 1;
+
+			t = monotonic_time();
+			tokens += cc.lex();
+			lex_time += monotonic_time() - t;
+		}
+
+		{
+			CIMCC::compiler cc;
+			src_ctx fdctx;
+
+			if (!open_source(cc,fdctx,path,use_mmap))
+				return 1;
+
+			t = monotonic_time();
+			if (!cc.compile())
+				return 1;
+
+			nodes += cc.arena.nodes;
+			arena_bytes = cc.arena.bytes;
+			cc.free_ast();
+			parse_time += monotonic_time() - t;
+		}
+
+		bytes += (unsigned long long)st.st_size;
+	}
+
+	if (lex_time <= 0) lex_time = 1e-9;
+	if (parse_time <= 0) parse_time = 1e-9;
+
+	printf("%s: %u passes, %llu bytes, %s\n",path,passes,bytes,use_mmap ? "mmap" : "read");
+	printf("  lex:   %8.3f MB/s %12.0f tokens/s (%zu tokens/pass)\n",
+		(double(bytes) / 1048576.0) / lex_time,double(tokens) / lex_time,tokens / passes);
+	printf("  parse: %8.3f MB/s %12.0f nodes/s  (%zu nodes/pass, %zu arena bytes)\n",
+		(double(bytes) / 1048576.0) / parse_time,double(nodes) / parse_time,nodes / passes,arena_bytes);
+	return 0;
+}
+
+static void help(void) {
+	fprintf(stderr,"cimcc [options] <file>\n");
+	fprintf(stderr,"  --mmap        Read the whole file through a memory map\n");
+	fprintf(stderr,"  --bench <n>   Lex and parse the file n times and report throughput\n");
+}
+
 int main(int argc,char **argv) {
-	if (argc < 2) {
+	unsigned int bench_passes = 0;
+	const char *path = NULL;
+	bool use_mmap = false;
+	int i;
+
+	for (i=1;i < argc;i++) {
+		const char *a = argv[i];
+
+		if (!strcmp(a,"--mmap")) {
+			use_mmap = true;
+		}
+		else if (!strcmp(a,"--bench")) {
+			if ((i+1) >= argc) {
+				help();
+				return 1;
+			}
+			bench_passes = (unsigned int)strtoul(argv[++i],NULL,0);
+			if (bench_passes == 0) {
+				help();
+				return 1;
+			}
+		}
+		else if (*a == '-' || path != NULL) {
+			help();
+			return 1;
+		}
+		else {
+			path = a;
+		}
+	}
+
+	if (path == NULL) {
 		fprintf(stderr,"Specify file\n");
 		return 1;
 	}
 
+	if (bench_passes != 0)
+		return bench(path,use_mmap,bench_passes);
+
 	{
 		CIMCC::token_source_name_list_t toksnames;
 		CIMCC::compiler cc;
 		src_ctx fdctx;
 
-		fdctx.fd = open(argv[1],O_RDONLY);
-		if (fdctx.fd < 0) {
-			fprintf(stderr,"Failed to open file\n");
+		if (!open_source(cc,fdctx,path,use_mmap))
 			return 1;
-		}
-		cc.set_source_name(argv[1]);
-		cc.set_source_cb(refill_fdio);
-		cc.set_source_ctx(&fdctx,sizeof(fdctx));
 		cc.set_source_name_list(&toksnames);
 
 		cc.compile();
@@ -5815,4 +6093,3 @@ int main(int argc,char **argv) {
 
 	return 0;
 }
-
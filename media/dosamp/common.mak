@@ -34,9 +34,9 @@ all: $(OMFSEGDG) exe
 exe: $(DOSAMP_EXE) .symbolic
 
 !ifdef DOSAMP_EXE
-DOSAMP_EXE_DEPS = $(SUBDIR)$(HPS)dosamp.obj $(SUBDIR)$(HPS)ts8254.obj $(SUBDIR)$(HPS)tsrdtsc.obj $(SUBDIR)$(HPS)tsrdtsc2.obj $(SUBDIR)$(HPS)fsref.obj $(SUBDIR)$(HPS)fsalloc.obj $(SUBDIR)$(HPS)fssrcfd.obj $(SUBDIR)$(HPS)cvip816.obj $(SUBDIR)$(HPS)cvip168.obj $(SUBDIR)$(HPS)cvipsm8.obj $(SUBDIR)$(HPS)cvipsm16.obj $(SUBDIR)$(HPS)cvipsm.obj $(SUBDIR)$(HPS)cvipms16.obj $(SUBDIR)$(HPS)cvipms8.obj $(SUBDIR)$(HPS)cvipms.obj $(SUBDIR)$(HPS)cvrdbuf.obj $(SUBDIR)$(HPS)cvrdbfrs.obj $(SUBDIR)$(HPS)cvrdbfrf.obj $(SUBDIR)$(HPS)cvrdbfrb.obj $(SUBDIR)$(HPS)trkrbase.obj $(SUBDIR)$(HPS)tmpbuf.obj $(SUBDIR)$(HPS)resample.obj $(SUBDIR)$(HPS)snirq.obj $(SUBDIR)$(HPS)sndcard.obj $(SUBDIR)$(HPS)sc_sb.obj $(SUBDIR)$(HPS)termios.obj $(SUBDIR)$(HPS)cstr.obj $(SUBDIR)$(HPS)fs.obj $(SUBDIR)$(HPS)pof_gofn.obj $(SUBDIR)$(HPS)pof_tty.obj $(SUBDIR)$(HPS)shdropls.obj $(SUBDIR)$(HPS)shdropwn.obj $(SUBDIR)$(HPS)isadma.obj
+DOSAMP_EXE_DEPS = $(SUBDIR)$(HPS)dosamp.obj $(SUBDIR)$(HPS)ts8254.obj $(SUBDIR)$(HPS)tsrdtsc.obj $(SUBDIR)$(HPS)tsrdtsc2.obj $(SUBDIR)$(HPS)fsref.obj $(SUBDIR)$(HPS)fsalloc.obj $(SUBDIR)$(HPS)fssrcfd.obj $(SUBDIR)$(HPS)cvip816.obj $(SUBDIR)$(HPS)cvip168.obj $(SUBDIR)$(HPS)cvipsm8.obj $(SUBDIR)$(HPS)cvipsm16.obj $(SUBDIR)$(HPS)cvipsm.obj $(SUBDIR)$(HPS)cvipms16.obj $(SUBDIR)$(HPS)cvipms8.obj $(SUBDIR)$(HPS)cvipms.obj $(SUBDIR)$(HPS)cvrdbuf.obj $(SUBDIR)$(HPS)cvrdbfrs.obj $(SUBDIR)$(HPS)cvrdbfrf.obj $(SUBDIR)$(HPS)cvrdbfrb.obj $(SUBDIR)$(HPS)cvrdbfrp.obj $(SUBDIR)$(HPS)trkrbase.obj $(SUBDIR)$(HPS)tmpbuf.obj $(SUBDIR)$(HPS)resample.obj $(SUBDIR)$(HPS)snirq.obj $(SUBDIR)$(HPS)sndcard.obj $(SUBDIR)$(HPS)sc_sb.obj $(SUBDIR)$(HPS)termios.obj $(SUBDIR)$(HPS)cstr.obj $(SUBDIR)$(HPS)fs.obj $(SUBDIR)$(HPS)pof_gofn.obj $(SUBDIR)$(HPS)pof_tty.obj $(SUBDIR)$(HPS)shdropls.obj $(SUBDIR)$(HPS)shdropwn.obj $(SUBDIR)$(HPS)isadma.obj
 
-DOSAMP_EXE_WLINK = file $(SUBDIR)$(HPS)dosamp.obj file $(SUBDIR)$(HPS)ts8254.obj file $(SUBDIR)$(HPS)tsrdtsc.obj file $(SUBDIR)$(HPS)tsrdtsc2.obj file $(SUBDIR)$(HPS)fsref.obj file $(SUBDIR)$(HPS)fsalloc.obj file $(SUBDIR)$(HPS)fssrcfd.obj file $(SUBDIR)$(HPS)cvip816.obj file $(SUBDIR)$(HPS)cvip168.obj file $(SUBDIR)$(HPS)cvipsm8.obj file $(SUBDIR)$(HPS)cvipsm16.obj file $(SUBDIR)$(HPS)cvipsm.obj file $(SUBDIR)$(HPS)cvipms16.obj file $(SUBDIR)$(HPS)cvipms8.obj file $(SUBDIR)$(HPS)cvipms.obj file $(SUBDIR)$(HPS)cvrdbuf.obj file $(SUBDIR)$(HPS)cvrdbfrs.obj file $(SUBDIR)$(HPS)cvrdbfrf.obj file $(SUBDIR)$(HPS)cvrdbfrb.obj file $(SUBDIR)$(HPS)trkrbase.obj file $(SUBDIR)$(HPS)tmpbuf.obj file $(SUBDIR)$(HPS)resample.obj file $(SUBDIR)$(HPS)snirq.obj file $(SUBDIR)$(HPS)sndcard.obj file $(SUBDIR)$(HPS)sc_sb.obj file $(SUBDIR)$(HPS)termios.obj file $(SUBDIR)$(HPS)cstr.obj file $(SUBDIR)$(HPS)fs.obj file $(SUBDIR)$(HPS)pof_gofn.obj file $(SUBDIR)$(HPS)pof_tty.obj file $(SUBDIR)$(HPS)shdropls.obj file $(SUBDIR)$(HPS)shdropwn.obj file $(SUBDIR)$(HPS)isadma.obj
+DOSAMP_EXE_WLINK = file $(SUBDIR)$(HPS)dosamp.obj file $(SUBDIR)$(HPS)ts8254.obj file $(SUBDIR)$(HPS)tsrdtsc.obj file $(SUBDIR)$(HPS)tsrdtsc2.obj file $(SUBDIR)$(HPS)fsref.obj file $(SUBDIR)$(HPS)fsalloc.obj file $(SUBDIR)$(HPS)fssrcfd.obj file $(SUBDIR)$(HPS)cvip816.obj file $(SUBDIR)$(HPS)cvip168.obj file $(SUBDIR)$(HPS)cvipsm8.obj file $(SUBDIR)$(HPS)cvipsm16.obj file $(SUBDIR)$(HPS)cvipsm.obj file $(SUBDIR)$(HPS)cvipms16.obj file $(SUBDIR)$(HPS)cvipms8.obj file $(SUBDIR)$(HPS)cvipms.obj file $(SUBDIR)$(HPS)cvrdbuf.obj file $(SUBDIR)$(HPS)cvrdbfrs.obj file $(SUBDIR)$(HPS)cvrdbfrf.obj file $(SUBDIR)$(HPS)cvrdbfrb.obj file $(SUBDIR)$(HPS)cvrdbfrp.obj file $(SUBDIR)$(HPS)trkrbase.obj file $(SUBDIR)$(HPS)tmpbuf.obj file $(SUBDIR)$(HPS)resample.obj file $(SUBDIR)$(HPS)snirq.obj file $(SUBDIR)$(HPS)sndcard.obj file $(SUBDIR)$(HPS)sc_sb.obj file $(SUBDIR)$(HPS)termios.obj file $(SUBDIR)$(HPS)cstr.obj file $(SUBDIR)$(HPS)fs.obj file $(SUBDIR)$(HPS)pof_gofn.obj file $(SUBDIR)$(HPS)pof_tty.obj file $(SUBDIR)$(HPS)shdropls.obj file $(SUBDIR)$(HPS)shdropwn.obj file $(SUBDIR)$(HPS)isadma.obj
 
 ! ifdef TARGET_WINDOWS
 # Windows target.
@@ -10,3 +10,32 @@ uint32_t convert_ip_mono2stereo(uint32_t samples,void dosamp_FAR * const proc_bu
 uint32_t convert_ip_mono2stereo_u8(uint32_t samples,void dosamp_FAR * const proc_buf,const uint32_t buf_max);
 uint32_t convert_ip_mono2stereo_s16(uint32_t samples,void dosamp_FAR * const proc_buf,const uint32_t buf_max);
 
+/* SSE2/AVX2 versions of the in-place converters (Linux host builds on x86).
+ * The converters above use them automatically when the CPU has them, chosen at
+ * runtime by CPUID. Set cvip_simd_level to CVIP_SIMD_NONE to force the plain C path. */
+#if defined(LINUX) && (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+# define CVIP_SIMD
+
+enum {
+    CVIP_SIMD_NONE=0,
+    CVIP_SIMD_SSE2,
+    CVIP_SIMD_AVX2
+};
+
+extern int cvip_simd_level; /* < 0 if not probed yet */
+
+int cvip_simd_probe(void);
+
+static inline int cvip_simd(void) {
+    if (cvip_simd_level < 0) cvip_simd_probe();
+    return cvip_simd_level;
+}
+
+void cvip_simd_8_to_16(void * const proc_buf,const uint32_t total_samples);
+void cvip_simd_16_to_8(void * const proc_buf,const uint32_t total_samples);
+void cvip_simd_stereo2mono_u8(void * const proc_buf,const uint32_t samples);
+void cvip_simd_stereo2mono_s16(void * const proc_buf,const uint32_t samples);
+void cvip_simd_mono2stereo_u8(void * const proc_buf,const uint32_t samples);
+void cvip_simd_mono2stereo_s16(void * const proc_buf,const uint32_t samples);
+#endif
+
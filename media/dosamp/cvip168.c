@@ -41,6 +41,11 @@ l1:     lodsw               ; AX = 16-bit sample
         pop     ds
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_16_to_8(proc_buf,total_samples);
+    else
+# endif
     {
         int16_t dosamp_FAR * sp = (int16_t dosamp_FAR *)proc_buf;
         uint32_t i = total_samples;
@@ -52,6 +52,11 @@ l1:     lodsb
         cld
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_8_to_16(proc_buf,total_samples);
+    else
+# endif
     {
         int16_t dosamp_FAR * buf = (int16_t dosamp_FAR *)proc_buf + total_samples - 1;
         uint8_t dosamp_FAR * sp = (uint8_t dosamp_FAR *)proc_buf + total_samples - 1;
@@ -45,6 +45,11 @@ l1:     lodsw
         cld
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_mono2stereo_s16(proc_buf,samples);
+    else
+# endif
     {
         /* in-place mono to stereo conversion (up to proc_buf_len)
          * from file_codec channels (1) to play_codec channels (2).
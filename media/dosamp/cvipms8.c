@@ -48,6 +48,11 @@ l1:     lodsb
         cld
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_mono2stereo_u8(proc_buf,samples);
+    else
+# endif
     {
         /* in-place mono to stereo conversion (up to proc_buf_len)
          * from file_codec channels (1) to play_codec channels (2).
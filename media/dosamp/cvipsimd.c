@@ -0,0 +1,383 @@
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "dosamp.h"
+#include "cvip.h"
+
+#if defined(CVIP_SIMD)
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* SSE2 and AVX2 in-place sample converters.
+ *
+ * These give the same results, bit for bit, as the C loops in cvip*.c, and follow the same
+ * in-place rules: conversions that shrink the data run front to back, conversions that grow
+ * the data run back to front, and a vector is always loaded before anything overlapping it
+ * is stored. Leftover samples that do not fill a vector are done one at a time, at the end
+ * of the buffer going forward or at the start of the buffer going backward.
+ *
+ * Each function is compiled for its instruction set with the GCC target attribute, so the
+ * rest of the program does not need -msse2 or -mavx2. */
+
+int cvip_simd_level = -1;
+
+/* CPUID, the same way hw/cpu cpu_cpuid() returns it */
+struct cvip_cpuid_result {
+    uint32_t            eax,ebx,ecx,edx;
+};
+
+static int cvip_cpuid(const uint32_t idx,const uint32_t sub,struct cvip_cpuid_result *r) {
+    if (__get_cpuid_max(0,NULL) < idx)
+        return 0;
+
+    __cpuid_count(idx,sub,r->eax,r->ebx,r->ecx,r->edx);
+    return 1;
+}
+
+int cvip_simd_probe(void) {
+    struct cvip_cpuid_result r;
+
+    cvip_simd_level = CVIP_SIMD_NONE;
+
+    if (!cvip_cpuid(1,0,&r))
+        return cvip_simd_level;
+
+    if (r.edx & (1UL << 26UL)) /* SSE2 */
+        cvip_simd_level = CVIP_SIMD_SSE2;
+    else
+        return cvip_simd_level;
+
+    /* AVX2 needs the OS to save YMM state too (OSXSAVE, then XCR0 bits 1 and 2) */
+    if ((r.ecx & (1UL << 27UL)) && (r.ecx & (1UL << 28UL))) { /* OSXSAVE, AVX */
+        uint32_t xcr0_lo,xcr0_hi;
+
+        __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+        (void)xcr0_hi;
+
+        if ((xcr0_lo & 6UL) == 6UL && cvip_cpuid(7,0,&r) && (r.ebx & (1UL << 5UL))) /* AVX2 */
+            cvip_simd_level = CVIP_SIMD_AVX2;
+    }
+
+    return cvip_simd_level;
+}
+
+/* ---------------------------------------------------------------- 16-bit to 8-bit */
+
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_16_to_8(uint8_t *d,const uint32_t n) {
+    const __m128i x80 = _mm_set1_epi8((char)0x80);
+    uint32_t i = 0;
+
+    for (;(i+16UL) <= n;i += 16UL) {
+        __m128i a = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(d+(i*2UL))),8);
+        __m128i b = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(d+(i*2UL)+16UL)),8);
+        _mm_storeu_si128((__m128i*)(d+i),_mm_xor_si128(_mm_packus_epi16(a,b),x80));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_16_to_8(uint8_t *d,const uint32_t n) {
+    const __m256i x80 = _mm256_set1_epi8((char)0x80);
+    uint32_t i = 0;
+
+    for (;(i+32UL) <= n;i += 32UL) {
+        __m256i a = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(d+(i*2UL))),8);
+        __m256i b = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(d+(i*2UL)+32UL)),8);
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi16(a,b),0xD8); /* pack works per 128-bit lane */
+        _mm256_storeu_si256((__m256i*)(d+i),_mm256_xor_si256(p,x80));
+    }
+
+    return i;
+}
+
+void cvip_simd_16_to_8(void * const proc_buf,const uint32_t total_samples) {
+    uint8_t *buf = (uint8_t*)proc_buf;
+    const int16_t *sp;
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_16_to_8(buf,total_samples);
+    else
+        i = cvip_sse2_16_to_8(buf,total_samples);
+
+    for (sp=(const int16_t*)proc_buf+i;i < total_samples;i++)
+        buf[i] = (uint8_t)((((uint16_t)(*sp++)) ^ 0x8000) >> 8U);
+}
+
+/* ---------------------------------------------------------------- 8-bit to 16-bit */
+
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_8_to_16(uint8_t *d,const uint32_t n) {
+    const __m128i x80 = _mm_set1_epi8((char)0x80);
+    const __m128i z = _mm_setzero_si128();
+    uint32_t i = n;
+
+    while (i >= 16UL) {
+        i -= 16UL;
+        {
+            __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(d+i)),x80);
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)),_mm_unpacklo_epi8(z,s));
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)+16UL),_mm_unpackhi_epi8(z,s));
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_8_to_16(uint8_t *d,const uint32_t n) {
+    const __m256i x80 = _mm256_set1_epi8((char)0x80);
+    const __m256i z = _mm256_setzero_si256();
+    uint32_t i = n;
+
+    while (i >= 32UL) {
+        i -= 32UL;
+        {
+            __m256i s = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(d+i)),x80);
+            __m256i lo = _mm256_unpacklo_epi8(z,s),hi = _mm256_unpackhi_epi8(z,s); /* per 128-bit lane */
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)),_mm256_permute2x128_si256(lo,hi,0x20));
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)+32UL),_mm256_permute2x128_si256(lo,hi,0x31));
+        }
+    }
+
+    return i;
+}
+
+void cvip_simd_8_to_16(void * const proc_buf,const uint32_t total_samples) {
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_8_to_16((uint8_t*)proc_buf,total_samples);
+    else
+        i = cvip_sse2_8_to_16((uint8_t*)proc_buf,total_samples);
+
+    {
+        int16_t *buf = (int16_t*)proc_buf + i - 1;
+        uint8_t *sp = (uint8_t*)proc_buf + i - 1;
+
+        while (i-- != 0UL)
+            *buf-- = (int16_t)(((uint16_t)((*sp--) ^ 0x80U)) << 8U);
+    }
+}
+
+/* ---------------------------------------------------------------- stereo to mono, 8-bit */
+
+/* (L + R + 1) >> 1 is exactly what PAVGB computes */
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_stereo2mono_u8(uint8_t *d,const uint32_t n) {
+    const __m128i lomask = _mm_set1_epi16(0x00FF);
+    uint32_t i = 0;
+
+    for (;(i+16UL) <= n;i += 16UL) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(d+(i*2UL)));
+        __m128i b = _mm_loadu_si128((const __m128i*)(d+(i*2UL)+16UL));
+        a = _mm_and_si128(_mm_avg_epu8(a,_mm_srli_epi16(a,8)),lomask);
+        b = _mm_and_si128(_mm_avg_epu8(b,_mm_srli_epi16(b,8)),lomask);
+        _mm_storeu_si128((__m128i*)(d+i),_mm_packus_epi16(a,b));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_stereo2mono_u8(uint8_t *d,const uint32_t n) {
+    const __m256i lomask = _mm256_set1_epi16(0x00FF);
+    uint32_t i = 0;
+
+    for (;(i+32UL) <= n;i += 32UL) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(d+(i*2UL)));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(d+(i*2UL)+32UL));
+        a = _mm256_and_si256(_mm256_avg_epu8(a,_mm256_srli_epi16(a,8)),lomask);
+        b = _mm256_and_si256(_mm256_avg_epu8(b,_mm256_srli_epi16(b,8)),lomask);
+        _mm256_storeu_si256((__m256i*)(d+i),_mm256_permute4x64_epi64(_mm256_packus_epi16(a,b),0xD8));
+    }
+
+    return i;
+}
+
+void cvip_simd_stereo2mono_u8(void * const proc_buf,const uint32_t samples) {
+    uint8_t *buf = (uint8_t*)proc_buf;
+    const uint8_t *sp;
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_stereo2mono_u8(buf,samples);
+    else
+        i = cvip_sse2_stereo2mono_u8(buf,samples);
+
+    for (sp=buf+(i*2UL);i < samples;i++,sp += 2)
+        buf[i] = (uint8_t)(((unsigned int)sp[0] + (unsigned int)sp[1] + 1U) >> 1U);
+}
+
+/* ---------------------------------------------------------------- stereo to mono, 16-bit */
+
+/* (L + R + 1) >> 1, signed. Biasing both by 0x8000 makes them unsigned, PAVGW then gives
+ * ((L + R + 1) >> 1) + 0x8000 exactly. The 32-bit lanes holding a L/R pair are sign extended
+ * and packed back down to 16 bits without saturating, then the bias is removed once. */
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_stereo2mono_s16(int16_t *d,const uint32_t n) {
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    uint32_t i = 0;
+
+    for (;(i+8UL) <= n;i += 8UL) {
+        __m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(d+(i*2UL))),bias);
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(d+(i*2UL)+8UL)),bias);
+        a = _mm_avg_epu16(a,_mm_srli_epi32(a,16));
+        b = _mm_avg_epu16(b,_mm_srli_epi32(b,16));
+        a = _mm_srai_epi32(_mm_slli_epi32(a,16),16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b,16),16);
+        _mm_storeu_si128((__m128i*)(d+i),_mm_xor_si128(_mm_packs_epi32(a,b),bias));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_stereo2mono_s16(int16_t *d,const uint32_t n) {
+    const __m256i bias = _mm256_set1_epi16((short)0x8000);
+    uint32_t i = 0;
+
+    for (;(i+16UL) <= n;i += 16UL) {
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(d+(i*2UL))),bias);
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(d+(i*2UL)+16UL)),bias);
+        a = _mm256_avg_epu16(a,_mm256_srli_epi32(a,16));
+        b = _mm256_avg_epu16(b,_mm256_srli_epi32(b,16));
+        a = _mm256_srai_epi32(_mm256_slli_epi32(a,16),16);
+        b = _mm256_srai_epi32(_mm256_slli_epi32(b,16),16);
+        _mm256_storeu_si256((__m256i*)(d+i),_mm256_xor_si256(_mm256_permute4x64_epi64(_mm256_packs_epi32(a,b),0xD8),bias));
+    }
+
+    return i;
+}
+
+void cvip_simd_stereo2mono_s16(void * const proc_buf,const uint32_t samples) {
+    int16_t *buf = (int16_t*)proc_buf;
+    const int16_t *sp;
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_stereo2mono_s16(buf,samples);
+    else
+        i = cvip_sse2_stereo2mono_s16(buf,samples);
+
+    for (sp=buf+(i*2UL);i < samples;i++,sp += 2)
+        buf[i] = (int16_t)(((long)sp[0] + (long)sp[1] + 1) >> 1);
+}
+
+/* ---------------------------------------------------------------- mono to stereo, 8-bit */
+
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_mono2stereo_u8(uint8_t *d,const uint32_t n) {
+    uint32_t i = n;
+
+    while (i >= 16UL) {
+        i -= 16UL;
+        {
+            __m128i s = _mm_loadu_si128((const __m128i*)(d+i));
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)),_mm_unpacklo_epi8(s,s));
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)+16UL),_mm_unpackhi_epi8(s,s));
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_mono2stereo_u8(uint8_t *d,const uint32_t n) {
+    uint32_t i = n;
+
+    while (i >= 32UL) {
+        i -= 32UL;
+        {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(d+i));
+            __m256i lo = _mm256_unpacklo_epi8(s,s),hi = _mm256_unpackhi_epi8(s,s);
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)),_mm256_permute2x128_si256(lo,hi,0x20));
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)+32UL),_mm256_permute2x128_si256(lo,hi,0x31));
+        }
+    }
+
+    return i;
+}
+
+void cvip_simd_mono2stereo_u8(void * const proc_buf,const uint32_t samples) {
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_mono2stereo_u8((uint8_t*)proc_buf,samples);
+    else
+        i = cvip_sse2_mono2stereo_u8((uint8_t*)proc_buf,samples);
+
+    {
+        uint8_t *buf = (uint8_t*)proc_buf + (i * 2UL) - 1;
+        uint8_t *sp = (uint8_t*)proc_buf + i - 1;
+
+        while (i-- != 0UL) {
+            *buf-- = *sp;
+            *buf-- = *sp;
+            sp--;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------- mono to stereo, 16-bit */
+
+__attribute__((target("sse2")))
+static uint32_t cvip_sse2_mono2stereo_s16(int16_t *d,const uint32_t n) {
+    uint32_t i = n;
+
+    while (i >= 8UL) {
+        i -= 8UL;
+        {
+            __m128i s = _mm_loadu_si128((const __m128i*)(d+i));
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)),_mm_unpacklo_epi16(s,s));
+            _mm_storeu_si128((__m128i*)(d+(i*2UL)+8UL),_mm_unpackhi_epi16(s,s));
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t cvip_avx2_mono2stereo_s16(int16_t *d,const uint32_t n) {
+    uint32_t i = n;
+
+    while (i >= 16UL) {
+        i -= 16UL;
+        {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(d+i));
+            __m256i lo = _mm256_unpacklo_epi16(s,s),hi = _mm256_unpackhi_epi16(s,s);
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)),_mm256_permute2x128_si256(lo,hi,0x20));
+            _mm256_storeu_si256((__m256i*)(d+(i*2UL)+16UL),_mm256_permute2x128_si256(lo,hi,0x31));
+        }
+    }
+
+    return i;
+}
+
+void cvip_simd_mono2stereo_s16(void * const proc_buf,const uint32_t samples) {
+    uint32_t i;
+
+    if (cvip_simd() >= CVIP_SIMD_AVX2)
+        i = cvip_avx2_mono2stereo_s16((int16_t*)proc_buf,samples);
+    else
+        i = cvip_sse2_mono2stereo_s16((int16_t*)proc_buf,samples);
+
+    {
+        int16_t *buf = (int16_t*)proc_buf + (i * 2UL) - 1;
+        int16_t *sp = (int16_t*)proc_buf + i - 1;
+
+        while (i-- != 0UL) {
+            *buf-- = *sp;
+            *buf-- = *sp;
+            sp--;
+        }
+    }
+}
+
+#endif /* CVIP_SIMD */
+
@@ -41,6 +41,11 @@ l1:     lodsw               ; BX = one sample >> 1
         pop     ds
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_stereo2mono_s16(proc_buf,samples);
+    else
+# endif
     {
         int16_t dosamp_FAR * sp = buf;
         uint32_t i = samples;
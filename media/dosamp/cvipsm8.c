@@ -40,6 +40,11 @@ l1:     lodsw               ; AX = two samples
         pop     ds
     }
 #else
+# if defined(CVIP_SIMD)
+    if (cvip_simd() != CVIP_SIMD_NONE)
+        cvip_simd_stereo2mono_u8(proc_buf,samples);
+    else
+# endif
     {
         uint8_t dosamp_FAR * sp = buf;
         uint32_t i = samples;
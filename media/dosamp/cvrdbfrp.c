@@ -0,0 +1,71 @@
+
+#if defined(TARGET_WINDOWS)
+# include <windows.h>
+#endif
+
+#if TARGET_MSDOS == 16
+# include <dos.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <assert.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#include "dosamp.h"
+#include "cvrdbuf.h"
+#include "dosptrnm.h"
+#include "resample.h"
+
+#if defined(RESAMPLE_SINC)
+
+/* one output sample: history window (oldest first) times one phase of the table, Q15 */
+#if defined(__GNUC__) && defined(__SSE2__)
+static inline int32_t resample_sinc_dot(const int16_t *h,const int16_t *c) {
+    __m128i acc = _mm_setzero_si128();
+    unsigned int k;
+
+    for (k=0;k < resample_sinc_taps;k += 8)
+        acc = _mm_add_epi32(acc,_mm_madd_epi16(_mm_loadu_si128((const __m128i*)(h+k)),_mm_loadu_si128((const __m128i*)(c+k))));
+
+    acc = _mm_add_epi32(acc,_mm_shuffle_epi32(acc,_MM_SHUFFLE(1,0,3,2)));
+    acc = _mm_add_epi32(acc,_mm_shuffle_epi32(acc,_MM_SHUFFLE(2,3,0,1)));
+    return (int32_t)_mm_cvtsi128_si32(acc);
+}
+#else
+static inline int32_t resample_sinc_dot(const int16_t *h,const int16_t *c) {
+    register unsigned int k;
+    int32_t acc = 0;
+
+    for (k=0;k < resample_sinc_taps;k++)
+        acc += (int32_t)h[k] * (int32_t)c[k];
+
+    return acc;
+}
+#endif
+
+static inline int16_t resample_sinc_clip(int32_t acc) {
+    acc = (acc + 0x4000L) >> 15L;
+    if (acc > 32767L) return 32767;
+    if (acc < -32768L) return -32768;
+    return (int16_t)acc;
+}
+
+uint32_t convert_rdbuf_resample_sinc_to_16_mono(int16_t dosamp_FAR *dst,uint32_t samples) {
+#define sample_channels 1
+#include "rsrdbtmp.h"
+}
+
+uint32_t convert_rdbuf_resample_sinc_to_16_stereo(int16_t dosamp_FAR *dst,uint32_t samples) {
+#define sample_channels 2
+#include "rsrdbtmp.h"
+}
+
+#endif /* RESAMPLE_SINC */
+
@@ -28,3 +28,6 @@ uint32_t convert_rdbuf_resample_best_to_8_stereo(uint8_t dosamp_FAR *dst,uint32_
 uint32_t convert_rdbuf_resample_best_to_16_mono(int16_t dosamp_FAR *dst,uint32_t samples);
 uint32_t convert_rdbuf_resample_best_to_16_stereo(int16_t dosamp_FAR *dst,uint32_t samples);
 
+/* only in builds with RESAMPLE_SINC */
+uint32_t convert_rdbuf_resample_sinc_to_16_mono(int16_t dosamp_FAR *dst,uint32_t samples);
+uint32_t convert_rdbuf_resample_sinc_to_16_stereo(int16_t dosamp_FAR *dst,uint32_t samples);
@@ -110,6 +110,7 @@ static unsigned long                            prefer_rate = 0;
 static unsigned char                            prefer_channels = 0;
 static unsigned char                            prefer_bits = 0;
 static unsigned char                            prefer_no_clamp = 0;
+static unsigned int                             prefer_ring_ms = 0;
 static signed char                              opt_round = -1;
 
 /* DOSAMP debug state */
@@ -388,7 +389,15 @@ static void load_audio_convert(uint32_t howmuch/*in bytes*/) {
                         dop = convert_rdbuf_resample_to_8_mono((uint8_t dosamp_FAR*)ptr,bsz);
                 }
             }
-            else if (resample_state.resample_mode == resample_best) {
+#if defined(RESAMPLE_SINC)
+            else if (resample_state.resample_mode == resample_sinc && play_codec.bits_per_sample > 8) {
+                if (play_codec.number_of_channels == 2)
+                    dop = convert_rdbuf_resample_sinc_to_16_stereo((int16_t dosamp_FAR*)ptr,bsz / 4UL);
+                else
+                    dop = convert_rdbuf_resample_sinc_to_16_mono((int16_t dosamp_FAR*)ptr,bsz / 2UL);
+            }
+#endif
+            else if (resample_state.resample_mode >= resample_best) { /* includes 8-bit output in sinc mode */
                 if (play_codec.bits_per_sample > 8) {
                     if (play_codec.number_of_channels == 2)
                         dop = convert_rdbuf_resample_best_to_16_stereo((int16_t dosamp_FAR*)ptr,bsz / 4UL);
@@ -761,6 +770,10 @@ static int begin_play() {
         goto error_out;
 #endif
 
+    /* software ring size, for drivers that feed the device from a thread. might fail, don't care. */
+    if (prefer_ring_ms != 0)
+        soundcard->ioctl(soundcard,soundcard_ioctl_set_ring_size_ms,NULL,NULL,(int)prefer_ring_ms);
+
     /* prepare the sound card (buffer, DMA, etc.) */
     if (soundcard->ioctl(soundcard,soundcard_ioctl_prepare_play,NULL,NULL,0) < 0)
         goto error_out;
@@ -870,6 +883,11 @@ static int parse_argv(int argc,char **argv) {
             else if (!strcmp(a,"nc")) {
                 prefer_no_clamp = 1;
             }
+            else if (!strcmp(a,"ring")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                prefer_ring_ms = (unsigned int)atoi(a);
+            }
             else {
                 return 0;
             }
@@ -992,6 +1010,8 @@ void display_idle_buffer(void) {
     signed long apos = -1;
     signed long buffersz = -1;
     signed long irq_counter = -1;
+    signed long ring_fill = -1;
+    signed long underruns = -1;
 
     /* FIXME: Our output drivers divide by zero when no format given. */
     if (wav_source == NULL) return;
@@ -1008,6 +1028,10 @@ void display_idle_buffer(void) {
             apos = (signed long)bufsz;
         if (soundcard->ioctl(soundcard,soundcard_ioctl_get_buffer_play_position,&bufsz,&sz,0) >= 0)
             pos = (signed long)bufsz;
+        if (soundcard->ioctl(soundcard,soundcard_ioctl_get_ring_fill,&bufsz,&sz,0) >= 0)
+            ring_fill = (signed long)bufsz;
+        if (soundcard->ioctl(soundcard,soundcard_ioctl_get_underrun_count,&bufsz,&sz,0) >= 0)
+            underruns = (signed long)bufsz;
     }
 
     printf("\x0D");
@@ -1022,6 +1046,9 @@ void display_idle_buffer(void) {
             (unsigned long)soundcard->wav_state.play_counter,
             (unsigned long)irq_counter);
 
+    if (ring_fill >= 0)
+        printf("/rf=%6ld/ur=%ld",ring_fill,underruns);
+
     fflush(stdout);
 }
 
@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <ctype.h>
 #include <fcntl.h>
+#include <math.h>
 #ifndef LINUX
 #include <dos.h>
 #endif
@@ -54,6 +55,50 @@
 unsigned char                               resample_on = 0;
 struct resampler_state_t                    resample_state;
 
+#if defined(RESAMPLE_SINC)
+/* Blackman windowed sinc, one row per phase. Row p interpolates at fraction p/phases between
+ * taps (taps/2)-1 and taps/2 of the history window. The cutoff follows the lower of the two rates,
+ * a bit under Nyquist so the transition band fits in the short window. Each row is normalized to
+ * exactly 1.0 in Q15 so that DC passes through unchanged. */
+void resampler_sinc_table_init(struct resampler_state_t *r,unsigned long d_rate,unsigned long s_rate) {
+    const double pi = 3.14159265358979323846;
+    double h[resample_sinc_taps];
+    unsigned int p,k,mk;
+    double fc,x,sum;
+    long isum;
+
+    fc = 0.45;
+    if (d_rate < s_rate)
+        fc = (fc * (double)d_rate) / (double)s_rate;
+
+    for (p=0;p < resample_sinc_phases;p++) {
+        sum = 0;
+        for (k=0;k < resample_sinc_taps;k++) {
+            x = (double)k - (double)((resample_sinc_taps / 2) - 1) - ((double)p / resample_sinc_phases);
+
+            if (x == 0)
+                h[k] = 2.0 * fc;
+            else
+                h[k] = sin(2.0 * pi * fc * x) / (pi * x);
+
+            h[k] *= 0.42 + (0.5 * cos((2.0 * pi * x) / resample_sinc_taps)) + (0.08 * cos((4.0 * pi * x) / resample_sinc_taps));
+            sum += h[k];
+        }
+
+        isum = 0;
+        mk = 0;
+        for (k=0;k < resample_sinc_taps;k++) {
+            r->sinc_table[p][k] = (int16_t)floor(((h[k] * 32768.0) / sum) + 0.5);
+            isum += r->sinc_table[p][k];
+            if (r->sinc_table[p][k] > r->sinc_table[p][mk]) mk = k;
+        }
+
+        /* rounding error goes to the center tap */
+        r->sinc_table[p][mk] += (int16_t)(32768L - isum);
+    }
+}
+#endif
+
 void resampler_state_reset(struct resampler_state_t *r) {
     r->frac = 0;
     r->init = 0;
@@ -89,7 +134,8 @@ int resampler_init(struct resampler_state_t *r,struct wav_cbr_t * const d,const
     else {
         resample_on = 1;
 
-        if (r->resample_mode == resample_best) {
+        /* sinc mode only does 16-bit output, 8-bit output falls back to best */
+        if (r->resample_mode >= resample_best) {
             unsigned long m;
 
             if (d->sample_rate >= s->sample_rate)
@@ -100,6 +146,10 @@ int resampler_init(struct resampler_state_t *r,struct wav_cbr_t * const d,const
             if (m > 255UL) m = 255UL;
             r->f_best = (uint8_t)m;
         }
+#if defined(RESAMPLE_SINC)
+        if (r->resample_mode == resample_sinc)
+            resampler_sinc_table_init(r,d->sample_rate,s->sample_rate);
+#endif
     }
 
     {
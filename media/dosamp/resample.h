@@ -21,11 +21,25 @@ typedef unsigned long                   resample_whole_count_element_t; /* whole
 
 #define resample_max_channels           (2)
 
+/* polyphase windowed-sinc resampler. 16-bit builds don't have the memory or the CPU time for it.
+ * The table is resample_sinc_phases rows of resample_sinc_taps Q15 coefficients, one row for each
+ * fractional position between two input samples. */
+#if TARGET_MSDOS != 16
+# define RESAMPLE_SINC
+# define resample_sinc_taps_shift       (4)
+# define resample_sinc_taps             (1 << resample_sinc_taps_shift)
+# define resample_sinc_phases_shift     (8)
+# define resample_sinc_phases           (1 << resample_sinc_phases_shift)
+#endif
+
 /* resampler mode */
 enum {
     resample_fast=0,                    /* fast (nearest neighbor) */
     resample_good,                      /* good (linear interpolate) */
     resample_best,                      /* best (linear + lowpass) */
+#if defined(RESAMPLE_SINC)
+    resample_sinc,                      /* polyphase windowed sinc, 16-bit output only */
+#endif
 
     resample_MAX
 };
@@ -40,6 +54,12 @@ struct resampler_state_t {
     uint8_t                             resample_mode;
     uint8_t                             f_best; /* best filter, averaging */
     unsigned int                        init:1;
+#if defined(RESAMPLE_SINC)
+    /* history is stored twice (h[i] and h[i+taps]) so that the newest taps are always contiguous */
+    unsigned int                        sinc_pos;
+    int16_t                             sinc_hist[resample_max_channels][resample_sinc_taps*2];
+    int16_t                             sinc_table[resample_sinc_phases][resample_sinc_taps];
+#endif
 };
 
 extern struct resampler_state_t         resample_state;
@@ -57,6 +77,27 @@ static inline int resample_interpolate_generic(const unsigned int channel) {
     return (int)tmp;
 }
 
+#if defined(RESAMPLE_SINC)
+static inline void resample_sinc_advance(void) {
+    resample_state.sinc_pos = (resample_state.sinc_pos + 1u) & (resample_sinc_taps - 1u);
+}
+
+static inline void resample_sinc_push(const unsigned int channel,const int16_t s) {
+    resample_state.sinc_hist[channel][resample_state.sinc_pos] = s;
+    resample_state.sinc_hist[channel][resample_state.sinc_pos+resample_sinc_taps] = s;
+}
+
+static inline const int16_t *resample_sinc_window(const unsigned int channel) {
+    return &resample_state.sinc_hist[channel][resample_state.sinc_pos+1];
+}
+
+static inline const int16_t *resample_sinc_phase(void) {
+    return resample_state.sinc_table[(unsigned int)(resample_state.frac >> (resample_100_shift - resample_sinc_phases_shift)) & (resample_sinc_phases - 1)];
+}
+
+void resampler_sinc_table_init(struct resampler_state_t *r,unsigned long d_rate,unsigned long s_rate);
+#endif
+
 void resampler_state_reset(struct resampler_state_t *r);
 int resampler_init(struct resampler_state_t *r,struct wav_cbr_t * const d,const struct wav_cbr_t * const s);
 
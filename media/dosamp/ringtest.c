@@ -0,0 +1,101 @@
+
+/* Linux host test for the sound card software ring (sc_ring.c).
+ *
+ * The main thread produces a counting byte pattern through both write() and mmap_write()
+ * in random sized pieces while a feeder thread drains it at random, the way the OSS/ALSA
+ * feeder threads do. Every byte has to come out once, in order. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "wavefmt.h"
+#include "dosamp.h"
+#include "sndcard.h"
+
+#define RINGTEST_BYTES                  (64UL << 20UL)
+
+static struct soundcard_ring_t          ring;
+static volatile unsigned long           ringtest_errors = 0;
+static unsigned long                    ringtest_consumed = 0;
+
+static void *ringtest_feeder(void *arg) {
+    unsigned int seed = 5678;
+    const unsigned char *p;
+    uint32_t len,i;
+
+    (void)arg;
+
+    while (soundcard_ring_running(&ring) || soundcard_ring_fill(&ring) != 0) {
+        p = soundcard_ring_peek(&ring,&len);
+        if (len == 0) {
+            usleep(50);
+            continue;
+        }
+
+        /* take a random part of it, like a device that only has room for some */
+        len = (uint32_t)(rand_r(&seed) % len) + 1;
+        len -= len % ring.block;
+        if (len == 0) continue;
+
+        for (i=0;i < len;i++) {
+            if (p[i] != (unsigned char)((ringtest_consumed + i) * 7UL))
+                ringtest_errors++;
+        }
+
+        ringtest_consumed += len;
+        soundcard_ring_consume(&ring,len);
+    }
+
+    return NULL;
+}
+
+int main() {
+    unsigned char tmp[8192];
+    unsigned long produced = 0;
+    struct wav_cbr_t fmt;
+    unsigned int seed = 1234;
+    uint32_t want,got,i;
+    unsigned char *p;
+
+    memset(&fmt,0,sizeof(fmt));
+    fmt.sample_rate = 44100;
+    fmt.number_of_channels = 2;
+    fmt.bits_per_sample = 16;
+    fmt.bytes_per_block = 4;
+    fmt.samples_per_block = 1;
+
+    ring.want_ms = 20;
+    if (soundcard_ring_alloc(&ring,&fmt) < 0) return 1;
+    printf("Ring: %lu bytes\n",(unsigned long)ring.size);
+
+    if (soundcard_ring_start(&ring,ringtest_feeder,NULL) < 0) return 1;
+
+    while (produced < RINGTEST_BYTES) {
+        want = (uint32_t)(rand_r(&seed) % sizeof(tmp)) + 1;
+        if (want > (RINGTEST_BYTES - produced)) want = RINGTEST_BYTES - produced;
+
+        if (rand_r(&seed) & 1) {
+            p = soundcard_ring_mmap_write(&ring,&got,want);
+            if (p == NULL) continue;
+            for (i=0;i < got;i++) p[i] = (unsigned char)((produced + i) * 7UL);
+        }
+        else {
+            for (i=0;i < want;i++) tmp[i] = (unsigned char)((produced + i) * 7UL);
+            got = soundcard_ring_write(&ring,tmp,want);
+        }
+
+        produced += got;
+    }
+
+    soundcard_ring_publish(&ring);
+    soundcard_ring_stop(&ring);
+
+    printf("Produced %lu, consumed %lu, errors %lu\n",produced,ringtest_consumed,ringtest_errors);
+    soundcard_ring_free(&ring);
+
+    return (ringtest_errors != 0 || ringtest_consumed != produced) ? 1 : 0;
+}
+
@@ -0,0 +1,142 @@
+
+/* Linux host benchmark for the resamplers.
+ *
+ * Feeds a few seconds of 16-bit stereo and mono audio through each resampler mode straight from
+ * memory and reports the CPU time it takes per second of output audio. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "wavefmt.h"
+#include "dosamp.h"
+#include "resample.h"
+#include "cvrdbuf.h"
+
+struct convert_rdbuf_t                  convert_rdbuf = {NULL,0,0,0};
+
+typedef uint32_t (*rsbench_func_t)(int16_t *dst,uint32_t samples);
+
+struct rsbench_mode {
+    const char*                         name;
+    uint8_t                             mode;
+    rsbench_func_t                      mono;
+    rsbench_func_t                      stereo;
+};
+
+static const struct rsbench_mode rsbench_modes[] = {
+    { "fast",   resample_fast,  convert_rdbuf_resample_fast_to_16_mono,     convert_rdbuf_resample_fast_to_16_stereo },
+    { "good",   resample_good,  convert_rdbuf_resample_to_16_mono,          convert_rdbuf_resample_to_16_stereo },
+    { "best",   resample_best,  convert_rdbuf_resample_best_to_16_mono,     convert_rdbuf_resample_best_to_16_stereo },
+#if defined(RESAMPLE_SINC)
+    { "sinc",   resample_sinc,  convert_rdbuf_resample_sinc_to_16_mono,     convert_rdbuf_resample_sinc_to_16_stereo },
+#endif
+    { NULL,     0,              NULL,                                       NULL }
+};
+
+static const unsigned long rsbench_rates[][2] = {
+    { 44100,    48000 },
+    { 22050,    44100 },
+    { 0,        0 }
+};
+
+#define RSBENCH_SECONDS                 (10)
+
+static int16_t                          rsbench_out[4096 * resample_max_channels];
+
+static double cpu_time(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/* run the whole input through once, return output sample frames */
+static unsigned long rsbench_run(const struct rsbench_mode *m,struct wav_cbr_t *d,struct wav_cbr_t *s,unsigned char *in,unsigned int in_len) {
+    const uint32_t out_frames = 4096;
+    unsigned long total = 0;
+    uint32_t r;
+
+    resample_state.resample_mode = m->mode;
+    if (resampler_init(&resample_state,d,s) < 0) return 0;
+    resampler_state_reset(&resample_state);
+
+    convert_rdbuf.buffer = in;
+    convert_rdbuf.size = convert_rdbuf.len = in_len;
+    convert_rdbuf.pos = 0;
+
+    do {
+        if (d->number_of_channels == 2)
+            r = m->stereo(rsbench_out,out_frames);
+        else
+            r = m->mono(rsbench_out,out_frames);
+
+        total += r;
+    } while (r == out_frames);
+
+    return total;
+}
+
+int main() {
+    const struct rsbench_mode *m;
+    struct wav_cbr_t s,d;
+    unsigned int ri,ch;
+
+    printf("CPU ms per second of output audio, 16-bit\n");
+    printf("%-22s %-7s","rate","chans");
+    for (m=rsbench_modes;m->name != NULL;m++) printf(" %8s",m->name);
+    printf("\n");
+
+    for (ri=0;rsbench_rates[ri][0] != 0;ri++) {
+        for (ch=1;ch <= 2;ch++) {
+            const unsigned long frames = rsbench_rates[ri][0] * RSBENCH_SECONDS;
+            unsigned char *in;
+            int16_t *p;
+            unsigned long i;
+
+            memset(&s,0,sizeof(s));
+            s.sample_rate = rsbench_rates[ri][0];
+            s.number_of_channels = ch;
+            s.bits_per_sample = 16;
+            s.bytes_per_block = 2 * ch;
+            s.samples_per_block = 1;
+            d = s;
+            d.sample_rate = rsbench_rates[ri][1];
+
+            if ((in = malloc(frames * s.bytes_per_block)) == NULL) return 1;
+
+            /* a sweep plus a little noise so that no mode gets a trivially predictable input */
+            p = (int16_t*)in;
+            srand(1234);
+            for (i=0;i < frames;i++) {
+                const double t = (double)i / s.sample_rate;
+                const double v = sin(2.0 * 3.14159265358979323846 * (100.0 + (1000.0 * t)) * t) * 24000.0;
+
+                p[i*ch] = (int16_t)(v + (rand() % 512) - 256);
+                if (ch == 2) p[(i*ch)+1] = (int16_t)(-v + (rand() % 512) - 256);
+            }
+
+            printf("%6lu -> %-12lu %-7u",(unsigned long)s.sample_rate,(unsigned long)d.sample_rate,ch);
+            for (m=rsbench_modes;m->name != NULL;m++) {
+                unsigned long out;
+                double t;
+
+                t = cpu_time();
+                out = rsbench_run(m,&d,&s,in,frames * s.bytes_per_block);
+                t = cpu_time() - t;
+
+                printf(" %8.3f",out != 0 ? (t * 1000.0) / ((double)out / d.sample_rate) : 0.0);
+            }
+            printf("\n");
+
+            free(in);
+        }
+    }
+
+    convert_rdbuf.buffer = NULL;
+    return 0;
+}
+
@@ -0,0 +1,41 @@
+#define bytes_per_sample (sizeof(int16_t) * sample_channels)
+
+#define LOAD() { { register unsigned int i; resample_sinc_advance(); for (i=0;i < sample_channels;i++) resample_sinc_push(i,src[i]); }; convert_rdbuf.pos += bytes_per_sample; src += sample_channels; }
+
+#define INTERPOLATE() { { register unsigned int i; const int16_t *c = resample_sinc_phase(); for (i=0;i < sample_channels;i++) dst[i] = resample_sinc_clip(resample_sinc_dot(resample_sinc_window(i),c)); }; dst += sample_channels; samples--; r++; }
+
+    /* NTS: Open Watcom is smart enough to turn for (i=0;i < constant;i++) into unrolled loop for small values of constant. Good! This code relies on it! */
+
+    int16_t dosamp_FAR *src = (int16_t dosamp_FAR*)dosamp_ptr_add_normalize(convert_rdbuf.buffer,convert_rdbuf.pos);
+    uint32_t r = 0;
+
+    if (resample_state.init == 0) {
+        if ((convert_rdbuf.pos+bytes_per_sample+bytes_per_sample) > convert_rdbuf.len) return r;
+        memset(resample_state.sinc_hist,0,sizeof(resample_state.sinc_hist));
+        resample_state.sinc_pos = 0;
+        resample_state.frac += resample_100;
+        resample_state.init = 1;
+    }
+
+    /* take in whatever input the next output needs, then run output samples until the next input is due */
+    while (samples > 0) {
+        while (resample_state.frac >= resample_100) {
+            if ((convert_rdbuf.pos+bytes_per_sample) > convert_rdbuf.len) return r;
+            resample_state.frac -= resample_100;
+
+            LOAD();
+        }
+
+        do {
+            INTERPOLATE();
+
+            resample_state.frac += resample_state.step;
+        } while (samples > 0 && resample_state.frac < resample_100);
+    }
+
+    return r;
+
+#undef LOAD
+#undef INTERPOLATE
+#undef sample_channels
+#undef bytes_per_sample
@@ -61,6 +61,61 @@ static unsigned char                alsa_probed = 0;
 
 static int dosamp_FAR alsa_poll(soundcard_t sc);
 
+/* feeder thread: moves audio from the ring to ALSA so that the main loop never waits on the device.
+ * once started, only this thread touches the PCM handle until alsa_stop_playback() joins it. */
+static void *alsa_feeder(void *arg) {
+    soundcard_t sc = (soundcard_t)arg;
+    struct soundcard_ring_t *r = &sc->p.alsa.ring;
+    snd_pcm_sframes_t w,avail,delay;
+    const unsigned char *p;
+    unsigned char dry = 0;
+    uint32_t len;
+
+    while (soundcard_ring_running(r)) {
+        p = soundcard_ring_peek(r,&len);
+        len /= r->block;
+
+        if (len == 0) {
+            /* ring is empty. if the device has also run out, the main loop isn't keeping up */
+            avail = delay = 0;
+            snd_pcm_avail_delay(sc->p.alsa.handle, &avail, &delay);
+            soundcard_ring_store(&r->dev_delay,(uint32_t)(delay > 0 ? delay : 0) * r->block);
+
+            if (delay <= 0 && snd_pcm_state(sc->p.alsa.handle) != SND_PCM_STATE_PREPARED) {
+                if (!dry) soundcard_ring_store(&r->ring_empty,r->ring_empty + 1);
+                dry = 1;
+            }
+
+            usleep(2000);
+            continue;
+        }
+
+        w = snd_pcm_writei(sc->p.alsa.handle, p, len);
+        if (w == -EAGAIN) {
+            snd_pcm_wait(sc->p.alsa.handle, 20);
+        }
+        else if (w == -EPIPE) {
+            /* underrun */
+            soundcard_ring_store(&r->underruns,r->underruns + 1);
+            snd_pcm_prepare(sc->p.alsa.handle);
+        }
+        else if (w < 0) {
+            if (snd_pcm_recover(sc->p.alsa.handle, (int)w, 1) < 0)
+                usleep(2000);
+        }
+        else {
+            soundcard_ring_consume(r,(uint32_t)w * r->block);
+            dry = 0;
+
+            delay = 0;
+            snd_pcm_delay(sc->p.alsa.handle, &delay);
+            soundcard_ring_store(&r->dev_delay,(uint32_t)(delay > 0 ? delay : 0) * r->block);
+        }
+    }
+
+    return NULL;
+}
+
 /* this depends on keeping the "play delay" up to date */
 static uint32_t dosamp_FAR alsa_can_write(soundcard_t sc) { /* in bytes */
     snd_pcm_sframes_t avail=0,delay=0;
@@ -68,6 +123,9 @@ static uint32_t dosamp_FAR alsa_can_write(soundcard_t sc) { /* in bytes */
 
     if (sc->p.alsa.handle == NULL) return 0;
 
+    if (sc->p.alsa.ring.buffer != NULL)
+        return soundcard_ring_space(&sc->p.alsa.ring);
+
     r = snd_pcm_avail_delay(sc->p.alsa.handle, &avail, &delay);
     if (r == -EPIPE) {
         /* ALSA underrun. Try again. */
@@ -87,18 +145,21 @@ static uint32_t dosamp_FAR alsa_can_write(soundcard_t sc) { /* in bytes */
  * Without this, upon underrun, the written audio may not be heard until the play
  * pointer has gone through the entire buffer again. */
 static int dosamp_FAR alsa_clamp_if_behind(soundcard_t sc,uint32_t ahead_in_bytes) {
-    (void)sc;
     (void)ahead_in_bytes;
 
+    /* the caller is done filling what mmap_write() returned */
+    soundcard_ring_publish(&sc->p.alsa.ring);
     return 0;
 }
 
+/* mmap write into the ring. the feeder thread gets it on the next call into the driver */
 static unsigned char dosamp_FAR * dosamp_FAR alsa_mmap_write(soundcard_t sc,uint32_t dosamp_FAR * const howmuch,uint32_t want) {
-    (void)sc;
-    (void)howmuch;
-    (void)want;
+    unsigned char *p;
 
-    return NULL;
+    p = soundcard_ring_mmap_write(&sc->p.alsa.ring,howmuch,want);
+    if (p != NULL) sc->wav_state.write_counter += *howmuch;
+
+    return p;
 }
 
 /* non-mmap write (much like OSS or ALSA in Linux where you do not have direct access to the hardware buffer) */
@@ -110,6 +171,13 @@ static unsigned int dosamp_FAR alsa_buffer_write(soundcard_t sc,const unsigned c
     /* ALSA can only represent in "frames" not bytes */
     if (len < sc->cur_codec.bytes_per_block) return 0;
 
+    if (sc->p.alsa.ring.buffer != NULL) {
+        r = (int)soundcard_ring_write(&sc->p.alsa.ring,buf,len);
+        sc->wav_state.write_counter += r;
+        alsa_poll(sc);
+        return r;
+    }
+
     r = snd_pcm_writei(sc->p.alsa.handle, buf, len / sc->cur_codec.bytes_per_block);
     if (r == -EPIPE) {
         /* underrun */
@@ -160,6 +228,8 @@ fail:
 static int dosamp_FAR alsa_close(soundcard_t sc) {
     if (!sc->wav_state.is_open) return 0;
 
+    soundcard_ring_free(&sc->p.alsa.ring);
+
     if (sc->p.alsa.param != NULL) {
         snd_pcm_hw_params_free(sc->p.alsa.param);
         sc->p.alsa.param = NULL;
@@ -178,10 +248,19 @@ static int dosamp_FAR alsa_poll(soundcard_t sc) {
 
     if (sc->p.alsa.handle == NULL) return 0;
 
-    snd_pcm_avail_delay(sc->p.alsa.handle, &avail, &delay);
-    sc->wav_state.play_delay = delay;
-    delay *= sc->cur_codec.bytes_per_block;
-    sc->wav_state.play_delay_bytes = delay;
+    if (sc->p.alsa.ring.buffer != NULL) {
+        /* audio still in the ring hasn't reached the device yet, count it as delay */
+        soundcard_ring_publish(&sc->p.alsa.ring);
+        delay = soundcard_ring_fill(&sc->p.alsa.ring) + soundcard_ring_load(&sc->p.alsa.ring.dev_delay);
+        sc->wav_state.play_delay_bytes = delay;
+        sc->wav_state.play_delay = delay / sc->cur_codec.bytes_per_block;
+    }
+    else {
+        snd_pcm_avail_delay(sc->p.alsa.handle, &avail, &delay);
+        sc->wav_state.play_delay = delay;
+        delay *= sc->cur_codec.bytes_per_block;
+        sc->wav_state.play_delay_bytes = delay;
+    }
 
     sc->wav_state.play_counter_prev = sc->wav_state.play_counter;
 
@@ -215,6 +294,13 @@ static int alsa_prepare_play(soundcard_t sc) {
     sc->wav_state.play_counter = 0;
     sc->wav_state.write_counter = 0;
 
+    if (soundcard_ring_alloc(&sc->p.alsa.ring,&sc->cur_codec) < 0)
+        return -1;
+
+    /* the ring is filled before playback starts, let ALSA start on its own when it has data */
+    snd_pcm_drop(sc->p.alsa.handle);
+    snd_pcm_prepare(sc->p.alsa.handle);
+
     sc->wav_state.prepared = 1;
     return 0;
 }
@@ -223,6 +309,7 @@ static int alsa_unprepare_play(soundcard_t sc) {
     if (sc->wav_state.playing) return -1;
 
     if (sc->wav_state.prepared) {
+        soundcard_ring_free(&sc->p.alsa.ring);
         sc->wav_state.prepared = 0;
     }
 
@@ -245,14 +332,13 @@ static int alsa_start_playback(soundcard_t sc) {
     if (!sc->wav_state.prepared) return -1;
     if (sc->wav_state.playing) return 0;
 
-    sc->wav_state.play_counter = 0;
-    sc->wav_state.write_counter = 0;
+    /* counters were zeroed by prepare, and the preroll already sitting in the ring counts */
     sc->wav_state.play_counter_prev = 0;
 
-    if (sc->p.alsa.handle != NULL)
-        snd_pcm_drop(sc->p.alsa.handle);
+    soundcard_ring_publish(&sc->p.alsa.ring);
+    if (soundcard_ring_start(&sc->p.alsa.ring,alsa_feeder,(void*)sc) < 0)
+        return -1;
 
-    snd_pcm_prepare(sc->p.alsa.handle);
     sc->wav_state.playing = 1;
     return 0;
 }
@@ -260,6 +346,10 @@ static int alsa_start_playback(soundcard_t sc) {
 static int alsa_stop_playback(soundcard_t sc) {
     if (!sc->wav_state.playing) return 0;
 
+    /* the feeder thread has to be gone before we touch the PCM handle again */
+    soundcard_ring_stop(&sc->p.alsa.ring);
+    soundcard_ring_reset(&sc->p.alsa.ring);
+
     if (sc->p.alsa.handle != NULL)
         snd_pcm_drop(sc->p.alsa.handle);
 
@@ -387,8 +477,6 @@ static int alsa_get_card_detail(soundcard_t sc,void dosamp_FAR *data,unsigned in
 }
 
 static int dosamp_FAR alsa_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR *data,unsigned int dosamp_FAR * len,int ival) {
-    (void)ival;
-
     switch (cmd) {
         case soundcard_ioctl_get_card_name:
             return alsa_get_card_name(sc,data,len);
@@ -421,6 +509,12 @@ static int dosamp_FAR alsa_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR
             if (*len < sizeof(uint32_t)) return -1;
             if ((*((uint32_t dosamp_FAR*)data) = alsa_play_buffer_size(sc)) == 0) return -1;
             } return 0;
+        case soundcard_ioctl_get_ring_size:
+        case soundcard_ioctl_get_ring_fill:
+        case soundcard_ioctl_set_ring_size_ms:
+        case soundcard_ioctl_get_underrun_count:
+        case soundcard_ioctl_get_ring_empty_count:
+            return soundcard_ring_ioctl(&sc->p.alsa.ring,cmd,data,len,ival);
     }
 
     return -1;
@@ -428,7 +522,7 @@ static int dosamp_FAR alsa_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR
 
 struct soundcard alsa_soundcard_template = {
     .driver =                                   soundcard_alsa,
-    .capabilities =                             0,
+    .capabilities =                             soundcard_caps_mmap_write,
     .requirements =                             0,
     .can_write =                                alsa_can_write,
     .open =                                     alsa_open,
@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <sys/soundcard.h>
+#include <poll.h>
 #include <endian.h>
 #endif
 #ifndef LINUX
@@ -69,12 +70,68 @@ static int oss_get_path(char *dst,size_t dst_max,unsigned int i) {
     return 0;
 }
 
+/* feeder thread: moves audio from the ring to the DSP so that the main loop never waits on the device.
+ * the fd stays non-blocking, poll() does the waiting. */
+static void *oss_feeder(void *arg) {
+    soundcard_t sc = (soundcard_t)arg;
+    struct soundcard_ring_t *r = &sc->p.oss.ring;
+    unsigned char started = 0,dry = 0;
+    const unsigned char *p;
+    struct pollfd pfd;
+    uint32_t len;
+    int w,delay;
+
+    while (soundcard_ring_running(r)) {
+        delay = 0;
+        if (ioctl(sc->p.oss.fd,SNDCTL_DSP_GETODELAY,&delay) < 0) delay = 0;
+        soundcard_ring_store(&r->dev_delay,(uint32_t)(delay > 0 ? delay : 0));
+
+        p = soundcard_ring_peek(r,&len);
+        len -= len % r->block;
+
+        /* OSS has no xrun state, an empty DSP after playback started is the underrun */
+        if (started && delay <= 0) {
+            if (!dry) {
+                soundcard_ring_store(&r->underruns,r->underruns + 1);
+                if (len == 0) soundcard_ring_store(&r->ring_empty,r->ring_empty + 1);
+            }
+            dry = 1;
+        }
+
+        if (len == 0) {
+            usleep(2000);
+            continue;
+        }
+
+        w = write(sc->p.oss.fd,p,len);
+        if (w > 0) {
+            soundcard_ring_consume(r,(uint32_t)w);
+            started = 1;
+            dry = 0;
+        }
+        else if (w < 0 && errno == EAGAIN) {
+            pfd.fd = sc->p.oss.fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            poll(&pfd,1,20);
+        }
+        else {
+            usleep(2000);
+        }
+    }
+
+    return NULL;
+}
+
 /* this depends on keeping the "play delay" up to date */
 static uint32_t dosamp_FAR oss_can_write(soundcard_t sc) { /* in bytes */
     audio_buf_info ai;
 
     if (sc->p.oss.fd < 0) return 0;
 
+    if (sc->p.oss.ring.buffer != NULL)
+        return soundcard_ring_space(&sc->p.oss.ring);
+
     memset(&ai,0,sizeof(ai));
     if (ioctl(sc->p.oss.fd,SNDCTL_DSP_GETOSPACE,&ai) >= 0)
         return ai.bytes;
@@ -91,18 +148,21 @@ static uint32_t dosamp_FAR oss_can_write(soundcard_t sc) { /* in bytes */
  * Without this, upon underrun, the written audio may not be heard until the play
  * pointer has gone through the entire buffer again. */
 static int dosamp_FAR oss_clamp_if_behind(soundcard_t sc,uint32_t ahead_in_bytes) {
-    (void)sc;
     (void)ahead_in_bytes;
 
+    /* the caller is done filling what mmap_write() returned */
+    soundcard_ring_publish(&sc->p.oss.ring);
     return 0;
 }
 
+/* mmap write into the ring. the feeder thread gets it on the next call into the driver */
 static unsigned char dosamp_FAR * dosamp_FAR oss_mmap_write(soundcard_t sc,uint32_t dosamp_FAR * const howmuch,uint32_t want) {
-    (void)sc;
-    (void)howmuch;
-    (void)want;
+    unsigned char *p;
 
-    return NULL;
+    p = soundcard_ring_mmap_write(&sc->p.oss.ring,howmuch,want);
+    if (p != NULL) sc->wav_state.write_counter += *howmuch;
+
+    return p;
 }
 
 static int dosamp_FAR oss_poll(soundcard_t sc);
@@ -113,7 +173,11 @@ static unsigned int dosamp_FAR oss_buffer_write(soundcard_t sc,const unsigned ch
 
     if (sc->p.oss.fd < 0) return 0;
 
-    w = write(sc->p.oss.fd,buf,len);
+    if (sc->p.oss.ring.buffer != NULL)
+        w = (int)soundcard_ring_write(&sc->p.oss.ring,buf,len);
+    else
+        w = write(sc->p.oss.fd,buf,len);
+
     if (w <= 0) return 0;
 
     sc->wav_state.write_counter += (uint64_t)w;
@@ -143,6 +207,8 @@ static int dosamp_FAR oss_open(soundcard_t sc) {
 static int dosamp_FAR oss_close(soundcard_t sc) {
     if (!sc->wav_state.is_open) return 0;
 
+    soundcard_ring_free(&sc->p.oss.ring);
+
     if (sc->p.oss.fd >= 0) {
         close(sc->p.oss.fd);
         sc->p.oss.fd = -1;
@@ -158,6 +224,8 @@ static int dosamp_FAR oss_poll(soundcard_t sc) {
 
     if (sc->p.oss.fd < 0) return 0;
 
+    soundcard_ring_publish(&sc->p.oss.ring);
+
     /* WARNING: OSS considers the sound card's FIFO as part of the delay */
     memset(&ci,0,sizeof(ci));
     ioctl(sc->p.oss.fd,SNDCTL_DSP_GETOPTR,&ci);
@@ -196,6 +264,9 @@ static int oss_prepare_play(soundcard_t sc) {
     sc->wav_state.play_counter = 0;
     sc->wav_state.write_counter = 0;
 
+    if (soundcard_ring_alloc(&sc->p.oss.ring,&sc->cur_codec) < 0)
+        return -1;
+
     sc->wav_state.prepared = 1;
     return 0;
 }
@@ -204,6 +275,7 @@ static int oss_unprepare_play(soundcard_t sc) {
     if (sc->wav_state.playing) return -1;
 
     if (sc->wav_state.prepared) {
+        soundcard_ring_free(&sc->p.oss.ring);
         sc->wav_state.prepared = 0;
     }
 
@@ -238,8 +310,7 @@ static int oss_start_playback(soundcard_t sc) {
     if (!sc->wav_state.prepared) return -1;
     if (sc->wav_state.playing) return 0;
 
-    sc->wav_state.play_counter = 0;
-    sc->wav_state.write_counter = 0;
+    /* counters were zeroed by prepare, and the preroll already sitting in the ring counts */
     sc->wav_state.play_counter_prev = 0;
 
     {
@@ -252,6 +323,10 @@ static int oss_start_playback(soundcard_t sc) {
         sc->p.oss.oss_p_pcount = ci.bytes;
     }
 
+    soundcard_ring_publish(&sc->p.oss.ring);
+    if (soundcard_ring_start(&sc->p.oss.ring,oss_feeder,(void*)sc) < 0)
+        return -1;
+
     sc->wav_state.playing = 1;
     return 0;
 }
@@ -259,6 +334,10 @@ static int oss_start_playback(soundcard_t sc) {
 static int oss_stop_playback(soundcard_t sc) {
     if (!sc->wav_state.playing) return 0;
 
+    /* the feeder thread has to be gone before the reset, or it would just keep writing */
+    soundcard_ring_stop(&sc->p.oss.ring);
+    soundcard_ring_reset(&sc->p.oss.ring);
+
     ioctl(sc->p.oss.fd,SNDCTL_DSP_RESET,NULL); /* STOP! */
 
     sc->wav_state.playing = 0;
@@ -345,8 +424,6 @@ static int oss_get_card_detail(soundcard_t sc,void dosamp_FAR *data,unsigned int
 }
 
 static int dosamp_FAR oss_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR *data,unsigned int dosamp_FAR * len,int ival) {
-    (void)ival;
-
     switch (cmd) {
         case soundcard_ioctl_get_card_name:
             return oss_get_card_name(sc,data,len);
@@ -379,6 +456,12 @@ static int dosamp_FAR oss_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR
             if (*len < sizeof(uint32_t)) return -1;
             if ((*((uint32_t dosamp_FAR*)data) = oss_play_buffer_size(sc)) == 0) return -1;
             } return 0;
+        case soundcard_ioctl_get_ring_size:
+        case soundcard_ioctl_get_ring_fill:
+        case soundcard_ioctl_set_ring_size_ms:
+        case soundcard_ioctl_get_underrun_count:
+        case soundcard_ioctl_get_ring_empty_count:
+            return soundcard_ring_ioctl(&sc->p.oss.ring,cmd,data,len,ival);
     }
 
     return -1;
@@ -386,7 +469,7 @@ static int dosamp_FAR oss_ioctl(soundcard_t sc,unsigned int cmd,void dosamp_FAR
 
 struct soundcard oss_soundcard_template = {
     .driver =                                   soundcard_oss,
-    .capabilities =                             0,
+    .capabilities =                             soundcard_caps_mmap_write,
     .requirements =                             0,
     .can_write =                                oss_can_write,
     .open =                                     oss_open,
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "wavefmt.h"
+#include "dosamp.h"
+#include "sndcard.h"
+
+#if defined(HAS_SC_RING)
+
+int soundcard_ring_alloc(struct soundcard_ring_t *r,const struct wav_cbr_t *fmt) {
+    uint32_t want,sz;
+
+    soundcard_ring_free(r);
+
+    if (fmt->sample_rate == 0 || fmt->bytes_per_block == 0)
+        return -1;
+    if (r->want_ms == 0)
+        r->want_ms = SC_RING_DEFAULT_MS;
+
+    want = (uint32_t)(((uint64_t)fmt->sample_rate * (uint64_t)fmt->bytes_per_block * (uint64_t)r->want_ms) / 1000ULL);
+    for (sz=4096;sz < want && sz < (1UL << 28UL);) sz <<= 1UL;
+
+    r->buffer = malloc(sz);
+    if (r->buffer == NULL)
+        return -1;
+
+    /* a sample frame must never straddle the wrap around, so the usable size is block aligned.
+     * 3-byte frames don't exist here, 1/2/4 byte frames always divide a power of 2 */
+    r->block = fmt->bytes_per_block;
+    r->size = sz;
+    r->mask = sz - 1UL;
+    assert((sz % r->block) == 0);
+
+    soundcard_ring_reset(r);
+    return 0;
+}
+
+void soundcard_ring_free(struct soundcard_ring_t *r) {
+    soundcard_ring_stop(r);
+
+    if (r->buffer != NULL) {
+        free(r->buffer);
+        r->buffer = NULL;
+    }
+
+    r->size = r->mask = 0;
+}
+
+/* only while the feeder thread is stopped */
+void soundcard_ring_reset(struct soundcard_ring_t *r) {
+    assert(!r->thread_running);
+
+    r->head = r->tail = r->pending = 0;
+    r->underruns = r->ring_empty = r->dev_delay = 0;
+}
+
+/* make what mmap_write() handed out visible to the feeder thread.
+ * mmap_write() callers fill the buffer AFTER the call, so this happens on the next call instead. */
+void soundcard_ring_publish(struct soundcard_ring_t *r) {
+    if (r->pending != 0) {
+        soundcard_ring_store(&r->head,r->head + r->pending);
+        r->pending = 0;
+    }
+}
+
+unsigned int soundcard_ring_write(struct soundcard_ring_t *r,const unsigned char *buf,unsigned int len) {
+    uint32_t space,o,chunk;
+
+    if (r->buffer == NULL) return 0;
+
+    soundcard_ring_publish(r);
+
+    space = soundcard_ring_space(r);
+    if (len > space) len = space;
+    len -= len % r->block;
+    if (len == 0) return 0;
+
+    o = r->head & r->mask;
+    chunk = r->size - o;
+    if (chunk > len) chunk = len;
+
+    memcpy(r->buffer+o,buf,chunk);
+    if (chunk < len) memcpy(r->buffer,buf+chunk,len-chunk);
+
+    soundcard_ring_store(&r->head,r->head + len);
+    return len;
+}
+
+unsigned char *soundcard_ring_mmap_write(struct soundcard_ring_t *r,uint32_t * const howmuch,uint32_t want) {
+    uint32_t space,o;
+
+    *howmuch = 0;
+    if (r->buffer == NULL) return NULL;
+
+    soundcard_ring_publish(r);
+
+    space = soundcard_ring_space(r);
+    o = r->head & r->mask;
+
+    /* contiguous only, the caller comes back for the part after the wrap around */
+    if (space > (r->size - o)) space = r->size - o;
+    if (want > space) want = space;
+    want -= want % r->block;
+    if (want == 0) return NULL;
+
+    r->pending = want;
+    *howmuch = want;
+    return r->buffer + o;
+}
+
+/* feeder side: contiguous bytes ready to go to the device */
+const unsigned char *soundcard_ring_peek(struct soundcard_ring_t *r,uint32_t * const len) {
+    const uint32_t tail = r->tail;
+    uint32_t avail,o;
+
+    avail = soundcard_ring_load(&r->head) - tail;
+    o = tail & r->mask;
+    if (avail > (r->size - o)) avail = r->size - o;
+
+    *len = avail;
+    return r->buffer + o;
+}
+
+void soundcard_ring_consume(struct soundcard_ring_t *r,const uint32_t len) {
+    soundcard_ring_store(&r->tail,r->tail + len);
+}
+
+int soundcard_ring_start(struct soundcard_ring_t *r,void *(*feeder)(void*),void *arg) {
+    if (r->buffer == NULL) return -1;
+    if (r->thread_running) return 0;
+
+    soundcard_ring_store(&r->run,1);
+    if (pthread_create(&r->thread,NULL,feeder,arg) != 0) {
+        r->run = 0;
+        return -1;
+    }
+
+    r->thread_running = 1;
+    return 0;
+}
+
+void soundcard_ring_stop(struct soundcard_ring_t *r) {
+    if (!r->thread_running) return;
+
+    soundcard_ring_store(&r->run,0);
+    pthread_join(r->thread,NULL);
+    r->thread_running = 0;
+}
+
+int soundcard_ring_running(struct soundcard_ring_t *r) {
+    return (int)soundcard_ring_load(&r->run);
+}
+
+/* the ring related ioctls, common to the drivers that use a ring */
+int soundcard_ring_ioctl(struct soundcard_ring_t *r,unsigned int cmd,void *data,unsigned int * len,int ival) {
+    uint32_t v;
+
+    switch (cmd) {
+        case soundcard_ioctl_set_ring_size_ms:
+            if (ival <= 0 || ival > 10000) return -1;
+            r->want_ms = (uint32_t)ival;
+            return 0;
+        case soundcard_ioctl_get_ring_size:
+            v = r->size;
+            break;
+        case soundcard_ioctl_get_ring_fill:
+            if (r->buffer == NULL) return -1;
+            v = soundcard_ring_fill(r) + r->pending;
+            break;
+        case soundcard_ioctl_get_underrun_count:
+            v = soundcard_ring_load(&r->underruns);
+            break;
+        case soundcard_ioctl_get_ring_empty_count:
+            v = soundcard_ring_load(&r->ring_empty);
+            break;
+        default:
+            return -1;
+    }
+
+    if (data == NULL || len == NULL) return -1;
+    if (*len < sizeof(uint32_t)) return -1;
+    *((uint32_t*)data) = v;
+    return 0;
+}
+
+#endif /* HAS_SC_RING */
+
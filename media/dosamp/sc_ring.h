@@ -0,0 +1,68 @@
+
+/* Software ring between dosamp and a blocking sound API (Linux OSS/ALSA).
+ *
+ * Single producer (the main loop, through write() or mmap_write()) and single consumer
+ * (a feeder thread that pushes the ring to the device). head and tail are free running
+ * byte counters, each written by only one side, so no lock is needed. The size is a power
+ * of two so that (counter & mask) is the buffer offset. */
+
+#if defined(LINUX)
+# define HAS_SC_RING
+#endif
+
+#if defined(HAS_SC_RING)
+# include <pthread.h>
+
+#define SC_RING_DEFAULT_MS                      (250)
+
+struct soundcard_ring_t {
+    unsigned char*                              buffer;
+    uint32_t                                    size;           /* power of 2, in bytes */
+    uint32_t                                    mask;
+    uint32_t                                    block;          /* bytes per sample frame */
+    uint32_t                                    want_ms;        /* requested size in milliseconds */
+    uint32_t                                    head;           /* bytes published by producer */
+    uint32_t                                    tail;           /* bytes consumed by the feeder thread */
+    uint32_t                                    pending;        /* handed out by mmap_write, not yet published */
+    uint32_t                                    underruns;      /* device ran dry (ALSA xrun, OSS underrun) */
+    uint32_t                                    ring_empty;     /* feeder found the ring empty while the device wanted more */
+    uint32_t                                    dev_delay;      /* bytes queued in the device, as last seen by the feeder */
+    uint32_t                                    run;            /* feeder thread keeps going while nonzero */
+    unsigned int                                thread_running:1;
+    pthread_t                                   thread;
+};
+
+static inline uint32_t soundcard_ring_load(const uint32_t *p) {
+    return __atomic_load_n(p,__ATOMIC_ACQUIRE);
+}
+
+static inline void soundcard_ring_store(uint32_t *p,const uint32_t v) {
+    __atomic_store_n(p,v,__ATOMIC_RELEASE);
+}
+
+/* bytes waiting for the feeder thread */
+static inline uint32_t soundcard_ring_fill(struct soundcard_ring_t *r) {
+    return soundcard_ring_load(&r->head) - soundcard_ring_load(&r->tail);
+}
+
+/* bytes the producer can write without overwriting unplayed audio */
+static inline uint32_t soundcard_ring_space(struct soundcard_ring_t *r) {
+    uint32_t s = r->size - soundcard_ring_fill(r) - r->pending;
+    return s - (s % r->block);
+}
+
+int soundcard_ring_alloc(struct soundcard_ring_t *r,const struct wav_cbr_t *fmt);
+void soundcard_ring_free(struct soundcard_ring_t *r);
+void soundcard_ring_reset(struct soundcard_ring_t *r);
+void soundcard_ring_publish(struct soundcard_ring_t *r);
+unsigned int soundcard_ring_write(struct soundcard_ring_t *r,const unsigned char *buf,unsigned int len);
+unsigned char *soundcard_ring_mmap_write(struct soundcard_ring_t *r,uint32_t * const howmuch,uint32_t want);
+const unsigned char *soundcard_ring_peek(struct soundcard_ring_t *r,uint32_t * const len);
+void soundcard_ring_consume(struct soundcard_ring_t *r,const uint32_t len);
+int soundcard_ring_start(struct soundcard_ring_t *r,void *(*feeder)(void*),void *arg);
+void soundcard_ring_stop(struct soundcard_ring_t *r);
+int soundcard_ring_running(struct soundcard_ring_t *r);
+int soundcard_ring_ioctl(struct soundcard_ring_t *r,unsigned int cmd,void *data,unsigned int * len,int ival);
+
+#endif /* HAS_SC_RING */
+
@@ -22,12 +22,15 @@ struct soundcard_priv_soundblaster_t {
     unsigned int                                rate_rounding:1;
 };
 
+#include "sc_ring.h"
+
 #if defined(HAS_OSS)
 struct soundcard_priv_oss_t {
     uint8_t                                     index;          /* /dev/dsp, /dev/dsp1, /dev/dsp2, etc... */
     int                                         fd;
     uint32_t                                    buffer_size;
     unsigned int                                oss_p_pcount;
+    struct soundcard_ring_t                     ring;
 };
 #endif
 
@@ -38,6 +41,7 @@ struct soundcard_priv_alsa_t {
     snd_pcm_t*                                  handle;
     char*                                       device;
     uint32_t                                    buffer_size;
+    struct soundcard_ring_t                     ring;
 };
 #endif
 
@@ -170,6 +174,11 @@ struct soundcard {
 #define soundcard_ioctl_get_buffer_size                     0x5BB0U /* get playback buffer size */
 #define soundcard_ioctl_get_buffer_write_position           0x5BB1U /* get write position within buffer */
 #define soundcard_ioctl_get_buffer_play_position            0x5BB2U /* get play position within buffer (e.g. ISA DMA pointer) */
+#define soundcard_ioctl_get_ring_size                       0x5BB3U /* get size of the driver's software ring, if it feeds the device from one (Linux OSS/ALSA) */
+#define soundcard_ioctl_get_ring_fill                       0x5BB4U /* get bytes waiting in the software ring */
+#define soundcard_ioctl_set_ring_size_ms                    0x5BB5U /* set software ring size in milliseconds (ival), takes effect on prepare */
+#define soundcard_ioctl_get_underrun_count                  0x5BB6U /* get count of device underruns since playback started */
+#define soundcard_ioctl_get_ring_empty_count                0x5BB7U /* get count of times the software ring ran dry while the device wanted more */
 #define soundcard_ioctl_set_play_format                     0x5BF0U /* set play format. specify wav_cbr_t which will be modifed to supported format, or -1 if not support */
 #define soundcard_ioctl_get_card_name                       0x5BD0U /* get text string, of the card (as known by the driver) ex. "Sound Blaster" */
 #define soundcard_ioctl_get_card_detail                     0x5BD1U /* get text string, of details the driver wants to show the user ex. "at 220h IRQ 7 DMA 1 HDMA 5" */
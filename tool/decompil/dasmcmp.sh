@@ -0,0 +1,41 @@
+#!/bin/bash
+# Compare the output of two wledasm/wnedasm builds, i.e. one from before the
+# label hash / fixup map / -j changes and the current one, both linked with
+# the real minx86dec.
+#
+# The relocation progress lines are left out, the old LE second pass printed
+# one per page where the new one prints one per object. Everything else must
+# be byte-identical, with the new build at -j 1 and at -j <jobs>. -j is
+# limited by DASM_PAR_MAX_THREADS (dasmpar.h), raise it in the new build to
+# check -j > 1.
+#
+# usage: ./dasmcmp.sh <old binary> <new binary> <jobs> <LE/NE files...>
+old="$1"
+new="$2"
+jobs="$3"
+shift 3
+
+if [ ! -x "$old" -o ! -x "$new" -o -z "$jobs" ]; then
+    echo "usage: $0 <old binary> <new binary> <jobs> <files...>"
+    exit 1
+fi
+
+tmp=`mktemp -d` || exit 1
+trap 'rm -Rf "$tmp"' EXIT
+
+fail=0
+for f in "$@"; do
+    "$old" -i "$f" 2>/dev/null | grep -v '^\* Load\(ing\|ed [0-9]*\) relocations' >"$tmp/old.txt"
+    for j in 1 $jobs; do
+        "$new" -j $j -i "$f" 2>/dev/null | grep -v '^\* Load\(ing\|ed [0-9]*\) relocations' >"$tmp/new.txt"
+        if cmp -s "$tmp/old.txt" "$tmp/new.txt"; then
+            echo "same: $f -j $j (`wc -l <"$tmp/new.txt"` lines)"
+        else
+            echo "DIFFERS: $f -j $j"
+            diff "$tmp/old.txt" "$tmp/new.txt" | head -20
+            fail=1
+        fi
+    done
+done
+
+exit $fail
@@ -0,0 +1,184 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(LINUX)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "dasmpar.h"
+
+static void dasm_par_run_inline(struct dasm_par_job *job,const struct dasm_par_funcs *f) {
+    f->run(job,stdout);
+    job->done = 1;
+}
+
+#if defined(LINUX)
+struct dasm_par_pool {
+    struct dasm_par_job*            jobs;
+    size_t                          count;
+    size_t                          next;           // next job to hand out
+    const struct dasm_par_funcs*    f;
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  job_done;
+};
+
+static void *dasm_par_worker(void *arg) {
+    struct dasm_par_pool *pool = (struct dasm_par_pool*)arg;
+    struct dasm_par_job *job;
+    int fail = 0;
+    FILE *out;
+
+    if (pool->f->thread_init != NULL && pool->f->thread_init() != 0)
+        fail = 1;
+
+    do {
+        pthread_mutex_lock(&pool->lock);
+        job = (pool->next < pool->count) ? (pool->jobs + (pool->next++)) : NULL;
+        pthread_mutex_unlock(&pool->lock);
+        if (job == NULL) break;
+
+        out = fail ? NULL : open_memstream(&job->out,&job->out_len);
+        if (out != NULL) {
+            pool->f->run(job,out);
+            fclose(out);
+        }
+        else {
+            fprintf(stderr,"Disassembler thread cannot start job\n");
+            job->status = -1;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        job->done = 1;
+        pthread_cond_broadcast(&pool->job_done);
+        pthread_mutex_unlock(&pool->lock);
+    } while (1);
+
+    if (pool->f->thread_free != NULL)
+        pool->f->thread_free();
+
+    return NULL;
+}
+
+unsigned int dasm_par_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (unsigned int)n : 1U;
+}
+
+double dasm_par_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+int dasm_par_run(struct dasm_par_job *jobs,size_t count,unsigned int threads,const struct dasm_par_funcs *f) {
+    struct dasm_par_pool pool;
+    pthread_t *tids;
+    unsigned int t,started = 0;
+    int ret = 0;
+    size_t i;
+
+    if (threads > count) threads = (unsigned int)count;
+
+    if (threads <= 1) {
+        for (i=0;i < count;i++) {
+            dasm_par_run_inline(jobs+i,f);
+            if (jobs[i].status != 0) return -1;
+        }
+
+        return 0;
+    }
+
+    memset(&pool,0,sizeof(pool));
+    pool.jobs = jobs;
+    pool.count = count;
+    pool.f = f;
+    pthread_mutex_init(&pool.lock,NULL);
+    pthread_cond_init(&pool.job_done,NULL);
+
+    tids = malloc(sizeof(pthread_t) * threads);
+    if (tids != NULL) {
+        for (t=0;t < threads;t++) {
+            if (pthread_create(&tids[t],NULL,dasm_par_worker,&pool) != 0) break;
+            started++;
+        }
+    }
+
+    if (started == 0) {
+        /* no threads, do it the slow way */
+        if (tids != NULL) free(tids);
+        pthread_cond_destroy(&pool.job_done);
+        pthread_mutex_destroy(&pool.lock);
+        for (i=0;i < count;i++) {
+            dasm_par_run_inline(jobs+i,f);
+            if (jobs[i].status != 0) return -1;
+        }
+
+        return 0;
+    }
+
+    /* write the output in job order as the jobs finish */
+    fflush(stdout);
+    for (i=0;i < count;i++) {
+        pthread_mutex_lock(&pool.lock);
+        while (!jobs[i].done) pthread_cond_wait(&pool.job_done,&pool.lock);
+        pthread_mutex_unlock(&pool.lock);
+
+        if (jobs[i].out != NULL && jobs[i].out_len != 0)
+            fwrite(jobs[i].out,jobs[i].out_len,1,stdout);
+        if (jobs[i].out != NULL) {
+            free(jobs[i].out);
+            jobs[i].out = NULL;
+        }
+
+        if (jobs[i].status != 0) {
+            /* stop handing out jobs, the single threaded version would have stopped here */
+            pthread_mutex_lock(&pool.lock);
+            pool.next = count;
+            pthread_mutex_unlock(&pool.lock);
+            ret = -1;
+            break;
+        }
+    }
+
+    for (t=0;t < started;t++)
+        pthread_join(tids[t],NULL);
+
+    for (i=0;i < count;i++) {
+        if (jobs[i].out != NULL) {
+            free(jobs[i].out);
+            jobs[i].out = NULL;
+        }
+    }
+
+    free(tids);
+    pthread_cond_destroy(&pool.job_done);
+    pthread_mutex_destroy(&pool.lock);
+    return ret;
+}
+#else
+unsigned int dasm_par_cpu_count(void) {
+    return 1U;
+}
+
+double dasm_par_seconds(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int dasm_par_run(struct dasm_par_job *jobs,size_t count,unsigned int threads,const struct dasm_par_funcs *f) {
+    size_t i;
+
+    (void)threads;
+    for (i=0;i < count;i++) {
+        dasm_par_run_inline(jobs+i,f);
+        if (jobs[i].status != 0) return -1;
+    }
+
+    return 0;
+}
+#endif
+
@@ -0,0 +1,61 @@
+
+#ifndef __DOSLIB_TOOL_DECOMPIL_DASMPAR_H
+#define __DOSLIB_TOOL_DECOMPIL_DASMPAR_H
+
+/* Parallel second pass for the LE/NE disassemblers.
+ *
+ * The first pass (label discovery) stays single threaded. The second pass is split into
+ * jobs (objects, segments, or label delimited ranges of an object) that each decode with
+ * their own decoder state, buffer and file handle. Each job prints into its own memory
+ * stream and the text is written to stdout in job order, so the output is the same as a
+ * single threaded run.
+ *
+ * Decoder state that the jobs touch must be declared DASM_TLS. Threads are Linux host only,
+ * elsewhere (or with 1 thread) the jobs run one after the other straight to stdout.
+ *
+ * This also assumes minx86dec keeps all of its state in the minx86dec_state/instruction
+ * structs the caller passes in, and has no mutable globals of its own. That has NOT been
+ * checked against the real minx86dec (the submodule is not in every checkout), only against
+ * a stand-in decoder, so -j > 1 is unverified until someone runs it under ThreadSanitizer
+ * with the real decoder and compares the output to -j 1 (dasmcmp.sh). Until then -j is
+ * limited to DASM_PAR_MAX_THREADS and the jobs run one after the other. */
+
+#include <stdio.h>
+
+/* raise once -j > 1 has been checked against the real minx86dec, see above */
+#define DASM_PAR_MAX_THREADS        1u
+
+#if defined(LINUX)
+# define DASM_TLS __thread
+#else
+# define DASM_TLS
+#endif
+
+struct dasm_par_job {
+    void*                   user;           // tool specific job description
+    char*                   out;            // text printed by the job (threaded mode)
+    size_t                  out_len;
+    unsigned long           insn_count;     // instructions decoded, for -bench
+    int                     status;         // nonzero if the job failed, output stops there
+    unsigned char           done;
+};
+
+typedef void (*dasm_par_job_fn)(struct dasm_par_job *job,FILE *out);
+
+struct dasm_par_funcs {
+    dasm_par_job_fn         run;
+    int                   (*thread_init)(void);    // per worker thread, i.e. open private file handle. nonzero on failure
+    void                  (*thread_free)(void);
+};
+
+/* returns 0 if all jobs ran, -1 if a job failed (its output and everything before it is written) */
+int dasm_par_run(struct dasm_par_job *jobs,size_t count,unsigned int threads,const struct dasm_par_funcs *f);
+
+/* number of CPUs, for the default thread count */
+unsigned int dasm_par_cpu_count(void);
+
+/* wall clock in seconds for -bench. clock() counts the CPU time of all threads */
+double dasm_par_seconds(void);
+
+#endif //__DOSLIB_TOOL_DECOMPIL_DASMPAR_H
+
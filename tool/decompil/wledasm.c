@@ -883,6 +883,8 @@ const char *vxd_service_to_name(const uint16_t vid,const uint16_t sid) {
 #include <hw/dos/exelehdr.h>
 #include <hw/dos/exelepar.h>
 
+#include "dasmpar.h"
+
 #ifndef O_BINARY
 #define O_BINARY 0
 #endif
@@ -954,33 +956,44 @@ void dec_label_set_name(struct dec_label *l,const char *s) {
 struct dec_label*               dec_label = NULL;
 size_t                          dec_label_count = 0;
 size_t                          dec_label_alloc = 0;
-unsigned long                   dec_ofs;
-uint16_t                        dec_cs;
-
-char                            name_tmp[255+1];
-
-uint8_t                         dec_buffer[512];
-uint8_t*                        dec_read;
-uint8_t*                        dec_end;
-char                            arg_c[101];
-struct minx86dec_state          dec_st;
-struct minx86dec_instruction    dec_i;
-minx86_read_ptr_t               iptr;
-uint16_t                        entry_cs,entry_ip;
-uint16_t                        start_cs,start_ip;
-uint32_t                        start_decom,end_decom,entry_ofs;
-uint32_t                        current_offset;
+unsigned int*                   dec_label_hash = NULL;          // dec_label[] index + 1, 0 if slot is empty
+size_t                          dec_label_hash_size = 0;        // power of 2, at least twice dec_label_alloc
+size_t                          dec_label_hashed = 0;           // dec_label[0...dec_label_hashed-1] are in the hash
+DASM_TLS unsigned long          dec_ofs;
+DASM_TLS uint16_t               dec_cs;
+
+DASM_TLS char                   name_tmp[255+1];
+
+DASM_TLS uint8_t                dec_buffer[512];
+DASM_TLS uint8_t*               dec_read;
+DASM_TLS uint8_t*               dec_end;
+DASM_TLS char                   arg_c[101];
+DASM_TLS struct minx86dec_state dec_st;
+DASM_TLS struct minx86dec_instruction dec_i;
+DASM_TLS minx86_read_ptr_t      iptr;
+DASM_TLS uint16_t               entry_cs,entry_ip;
+DASM_TLS uint16_t               start_cs,start_ip;
+DASM_TLS uint32_t               start_decom,end_decom,entry_ofs;
+DASM_TLS uint32_t               current_offset;
 unsigned char                   is_vxd = 0;
 
 struct exe_dos_header           exehdr;
 
 uint32_t                        load_base = 0x00400000;
 
+unsigned char                   bench_mode = 0;
+DASM_TLS unsigned long          bench_insn_count = 0;
+
 char*                           sym_file = NULL;
 char*                           label_file = NULL;
 
 char*                           src_file = NULL;
-int                             src_fd = -1;
+DASM_TLS int                    src_fd = -1;
+DASM_TLS FILE*                  dec_out = NULL;         // second pass output, per job
+
+unsigned int                    dasm_threads = 1;       // second pass threads, -j
+
+struct le_header_parseinfo      le_parser;
 
 void dec_free_labels() {
     unsigned int i=0;
@@ -996,6 +1009,11 @@ void dec_free_labels() {
 
     free(dec_label);
     dec_label = NULL;
+
+    if (dec_label_hash != NULL) {
+        free(dec_label_hash);
+        dec_label_hash = NULL;
+    }
 }
 
 uint32_t current_offset_minus_buffer() {
@@ -1019,6 +1037,8 @@ void help() {
     fprintf(stderr,"    -lf <file>       Text file to define labels\n");
     fprintf(stderr,"    -sym <file>      Module symbols file\n");
     fprintf(stderr,"    -b <a>           Load base\n");
+    fprintf(stderr,"    -bench           Report disassembly speed to stderr\n");
+    fprintf(stderr,"    -j <n>           Second pass threads (0 = one per CPU, default 1). Limited to 1 for now, see dasmpar.h\n");
 }
 
 void print_entry_table_locate_name_by_ordinal(const struct exe_ne_header_name_entry_table * const nonresnames,const struct exe_ne_header_name_entry_table *resnames,const unsigned int ordinal) {
@@ -1072,6 +1092,19 @@ int parse_argv(int argc,char **argv) {
                 sym_file = argv[i++];
                 if (sym_file == NULL) return 1;
             }
+            else if (!strcmp(a,"bench")) {
+                bench_mode = 1;
+            }
+            else if (!strcmp(a,"j")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                dasm_threads = (unsigned int)strtoul(a,NULL,0);
+                if (dasm_threads == 0) dasm_threads = dasm_par_cpu_count();
+                if (dasm_threads > DASM_PAR_MAX_THREADS) {
+                    fprintf(stderr,"-j %u: limited to %u, see dasmpar.h\n",dasm_threads,DASM_PAR_MAX_THREADS);
+                    dasm_threads = DASM_PAR_MAX_THREADS;
+                }
+            }
             else if (!strcmp(a,"h") || !strcmp(a,"help")) {
                 help();
                 return 1;
@@ -1180,12 +1213,55 @@ void dec_label_xlate_32flat_always(struct dec_label *l,struct le_header_parseinf
     }
 }
 
+/* Labels are hashed by seg:off so that dec_find_label() does not have to scan every label for
+ * every branch target. Callers fill in seg_v:ofs_v (and translate to 32-bit flat) AFTER
+ * dec_label_malloc(), so new labels are added to the hash lazily by the next lookup. Code that
+ * changes seg_v:ofs_v of an existing label or reorders dec_label[] must call dec_label_hash_reset(). */
+void dec_label_hash_reset() {
+    if (dec_label_hash != NULL)
+        memset(dec_label_hash,0,sizeof(*dec_label_hash) * dec_label_hash_size);
+
+    dec_label_hashed = 0;
+}
+
+static size_t dec_label_hash_slot(const uint16_t so,const uint32_t oo) {
+    uint32_t h = (oo ^ ((uint32_t)so << 16UL)) * (uint32_t)0x9E3779B1UL;
+
+    return (size_t)(h ^ (h >> 15UL)) & (dec_label_hash_size - 1);
+}
+
 struct dec_label *dec_find_label(const uint16_t so,const uint32_t oo) {
     unsigned int i=0;
 
     if (dec_label == NULL)
         return NULL;
 
+    if (dec_label_hash != NULL) {
+        size_t h;
+
+        /* NTS: duplicate seg:off labels go further down the probe sequence in the order
+         *      they were added, so the lookup still returns the first one like the linear scan did */
+        while (dec_label_hashed < dec_label_count) {
+            struct dec_label *l = dec_label + dec_label_hashed;
+
+            h = dec_label_hash_slot(l->seg_v,l->ofs_v);
+            while (dec_label_hash[h] != 0) h = (h + 1) & (dec_label_hash_size - 1);
+            dec_label_hash[h] = (unsigned int)(++dec_label_hashed);
+        }
+
+        h = dec_label_hash_slot(so,oo);
+        while ((i=dec_label_hash[h]) != 0) {
+            struct dec_label *l = dec_label + i - 1;
+
+            if (l->seg_v == so && l->ofs_v == oo)
+                return l;
+
+            h = (h + 1) & (dec_label_hash_size - 1);
+        }
+
+        return NULL;
+    }
+
     while (i < dec_label_count) {
         struct dec_label *l = dec_label + i;
 
@@ -1244,108 +1320,557 @@ void dec_label_sort() {
         return;
 
     qsort(dec_label,dec_label_count,sizeof(*dec_label),dec_label_qsortcb);
+    dec_label_hash_reset();
 }
 
-struct fixup_tracking_window_ent {
+struct fixup_map_ent {
     uint32_t                                    fixup_rec_page;     // page it belongs to
     uint32_t                                    fixup_rec_index;    // index within page record array
     uint32_t                                    linear_address;     // linear memory address that relocation is applied to
 };
 
+// 32-bit offset fixups of one object, from the per-page fixup record tables, sorted by linear address.
+// built once per object before the second pass, read only from then on. each
+// disassembly job walks it with its own read index starting at fixup_map_lower_bound().
 // table:
-//    0 <= read <= length <= alloc
-struct fixup_tracking_window {
-    struct fixup_tracking_window_ent*           table;
-    size_t                                      read;
+//    0 <= length <= alloc
+struct fixup_map {
+    struct fixup_map_ent*                       table;
     size_t                                      length;
     size_t                                      alloc;
 };
 
-void fixup_tracking_window_init(struct fixup_tracking_window *w) {
-    memset(w,0,sizeof(*w));
+void fixup_map_init(struct fixup_map *m) {
+    memset(m,0,sizeof(*m));
 }
 
-void fixup_tracking_window_free(struct fixup_tracking_window *w) {
-    if (w->table) free(w->table);
-    w->table = NULL;
-    w->length = 0;
-    w->alloc = 0;
-    w->read = 0;
+void fixup_map_free(struct fixup_map *m) {
+    if (m->table) free(m->table);
+    m->table = NULL;
+    m->length = 0;
+    m->alloc = 0;
 }
 
-void fixup_tracking_window_flush(struct fixup_tracking_window *w) {
-    size_t mc;
+struct fixup_map_ent *fixup_map_alloc_entry(struct fixup_map *m) {
+    if (m->length >= m->alloc) {
+        size_t na = m->alloc + 2048;
+        void *np;
 
-    if (w->table == NULL) return;
-    if (w->read == 0) return;
-    if (w->read >= w->length) return;
+        np = realloc((void*)(m->table),na * sizeof(struct fixup_map_ent));
+        if (np == NULL) return NULL;
+        m->table = (struct fixup_map_ent*)np;
+        m->alloc = na;
+    }
 
-    mc = w->length - w->read;
-    memmove(w->table,w->table + w->read,mc * sizeof(struct fixup_tracking_window_ent));
-    w->length = mc;
-    w->read = 0;
+    return m->table + (m->length++);
 }
 
-void fixup_tracking_window_lazy_flush(struct fixup_tracking_window *w) {
-    if (w->read >= (w->alloc / 2))
-        fixup_tracking_window_flush(w);
+int fixup_map_sort(const void *a,const void *b) {
+    const struct fixup_map_ent *fa =
+        (const struct fixup_map_ent *)a;
+    const struct fixup_map_ent *fb =
+        (const struct fixup_map_ent *)b;
+
+    if (fa->linear_address < fb->linear_address)
+        return -1;
+    if (fa->linear_address > fb->linear_address)
+        return 1;
+
+    /* keep records in file order if they hit the same address */
+    if (fa->fixup_rec_page < fb->fixup_rec_page)
+        return -1;
+    if (fa->fixup_rec_page > fb->fixup_rec_page)
+        return 1;
+    if (fa->fixup_rec_index < fb->fixup_rec_index)
+        return -1;
+    if (fa->fixup_rec_index > fb->fixup_rec_index)
+        return 1;
+
+    return 0;
 }
 
-void fixup_tracking_window_alloc(struct fixup_tracking_window *w) {
-    if (w->table == NULL) {
-        w->alloc = 2048;
-        w->table = malloc(w->alloc * sizeof(struct fixup_tracking_window_ent));
-        if (w->table == NULL) return;
-        w->length = 0;
-        w->read = 0;
+void fixup_map_add(struct fixup_map *m,uint32_t page,size_t ti,uint32_t srclinoff) {
+    struct fixup_map_ent *fixent = fixup_map_alloc_entry(m);
+
+    if (fixent) {
+        fixent->fixup_rec_page = page;
+        fixent->fixup_rec_index = ti;
+        fixent->linear_address = srclinoff;
+    }
+    else {
+        printf("! unable to alloc reloc tracking\n");
     }
 }
 
-struct fixup_tracking_window_ent *fixup_tracking_window_alloc_entry(struct fixup_tracking_window *w) {
-    size_t entry;
+/* collect the 32-bit offset fixups in the pages of object #(i+1) */
+void fixup_map_build(struct fixup_map *m,struct le_header_parseinfo *p,unsigned int i) {
+    struct exe_le_header_object_table_entry *ent = p->le_object_table + i;
+    struct le_header_fixup_record_table *frtable;
+    unsigned int srcoff_count,srcoff_i;
+    unsigned char flags,src;
+    uint32_t page,pagelinoff;
+    unsigned char *raw;
+    uint16_t srcoff;
+    size_t ti;
+
+    fixup_map_free(m);
+    if (p->le_fixup_records.table == NULL)
+        return;
+
+    for (page=ent->page_map_index;page < (ent->page_map_index + ent->page_map_entries);page++) {
+        if (page == 0 || page > p->le_header.number_of_memory_pages)
+            continue;
+
+        frtable = p->le_fixup_records.table + page - 1;
+        if (frtable->table == NULL || frtable->length == 0)
+            continue;
+
+        pagelinoff = (page - (uint32_t)ent->page_map_index) * (uint32_t)p->le_header.memory_page_size;
+
+        for (ti=0;ti < frtable->length;ti++) {
+            raw = le_header_fixup_record_table_get_raw_entry(frtable,ti);
+
+            // caller ensures the record is long enough
+            src = *raw++;
+            flags = *raw++;
+
+            if (src & 0xC0)
+                continue;
+
+            if (src & 0x20) {
+                srcoff_count = *raw++; //number of source offsets. object follows, then array of srcoff
+                srcoff = 0;
+            }
+            else {
+                srcoff_count = 1;
+                srcoff = *((int16_t*)raw); raw += 2;
+            }
+
+            if ((flags&3) != 0) // internal reference only
+                continue;
+            if ((src&0xF) != 0x7) // must be 32-bit offset fixup
+                continue;
+
+            if (flags&0x40) {
+                raw += 2; /* tobject = *((uint16_t*)raw); */
+            }
+            else {
+                raw++; /* tobject = *raw++; */
+            }
+
+            if (flags&0x10) { // 32-bit target offset
+                raw += 4; /* trgoff = *((uint32_t*)raw); */
+            }
+            else { // 16-bit target offset
+                raw += 2; /* trgoff = *((uint16_t*)raw); */
+            }
+
+            // what is the relocation relative to the struct we just read?
+            if (src & 0x20) {
+                for (srcoff_i=0;srcoff_i < srcoff_count;srcoff_i++) {
+                    srcoff = *((int16_t*)raw); raw += 2;
+                    fixup_map_add(m,page,ti,p->le_object_table_loaded_linear[i] + pagelinoff + (uint32_t)srcoff);
+                }
+            }
+            else {
+                fixup_map_add(m,page,ti,p->le_object_table_loaded_linear[i] + pagelinoff + (uint32_t)srcoff);
+            }
+        }
+    }
+
+    if (m->length != 0)
+        qsort(m->table,m->length,sizeof(*(m->table)),fixup_map_sort);
+}
+
+/* index of the first fixup at or after linear address 'addr' */
+size_t fixup_map_lower_bound(const struct fixup_map *m,uint32_t addr) {
+    size_t lo = 0,hi = m->length,mid;
+
+    while (lo < hi) {
+        mid = lo + ((hi - lo) >> (size_t)1);
+        if (m->table[mid].linear_address < addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* second pass: one job is one executable object. label_first/label_stop allow a label
+ * delimited range of one, which is not used yet: when an instruction runs over a label the
+ * decoder continues from where that instruction ended, so a range started at a label would
+ * not always decode the way the whole object does. */
+struct le_dasm_job {
+    unsigned int                                object;         // object index (0-based)
+    unsigned int                                label_first;    // range starts at this label, unless first
+    unsigned int                                label_stop;     // next range starts at this label (dec_label_count if none)
+    unsigned char                               first;          // first range of the object
+};
+
+struct fixup_map*                               le_fixup_maps = NULL;   // one per object
+
+int le_dasm_thread_init(void) {
+    src_fd = open(src_file,O_RDONLY|O_BINARY);
+    return (src_fd < 0) ? -1 : 0;
+}
+
+void le_dasm_thread_free(void) {
+    if (src_fd >= 0) {
+        close(src_fd);
+        src_fd = -1;
+    }
+}
+
+void le_dasm_job(struct dasm_par_job *pj,FILE *out) {
+    const struct le_dasm_job *job = (const struct le_dasm_job*)(pj->user);
+    const unsigned int i = job->object;
+    struct exe_le_header_object_table_entry *ent = le_parser.le_object_table + i;
+    const struct fixup_map *fixup_map = le_fixup_maps + i;
+    const unsigned long insn_start = bench_insn_count;
+    struct fixup_map_ent *fixent;
+    struct le_vmap_trackio io;
+    struct dec_label *label;
+    unsigned int labeli;
+    size_t fixup_read;
+    uint32_t start;
+    size_t inslen;
+
+    dec_out = out;
+
+    if (job->first) {
+        fprintf(dec_out,"* LE object #%u (%u-bit)\n",
+            i + 1,
+            (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) ? 32 : 16);
+        if (!(ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_EXECUTABLE)) {
+            fprintf(dec_out,"    Ignoring data object\n");
+            return;
+        }
+    }
+
+    if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT)
+        start = le_parser.le_object_table_loaded_linear[i];
+    else
+        start = 0;
+
+    if (!job->first)
+        start = dec_label[job->label_first].ofs_v;
 
-    if (w->table == NULL) {
-        fixup_tracking_window_alloc(w);
-        if (w->table == NULL) return NULL;
+    if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
+        if (!le_segofs_to_trackio(&io,0/*flat*/,start,&le_parser))
+            return;
+    }
+    else {
+        if (!le_segofs_to_trackio(&io,i + 1,start,&le_parser))
+            return;
     }
 
-    if (w->length >= w->alloc) {
-        fixup_tracking_window_flush(w);
-        if (w->length >= w->alloc) return NULL;
+    if (job->first && fixup_map->length != 0)
+        fprintf(dec_out,"* Loaded %lu relocations for object #%u\n",(unsigned long)fixup_map->length,i + 1);
+
+    reset_buffer();
+    labeli = job->first ? 0 : job->label_first;
+    dec_ofs = 0;
+    entry_ip = 0;
+    start_decom = 0;
+    end_decom = ent->virtual_segment_size;
+    current_offset = start;
+
+    if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
+        end_decom += le_parser.le_object_table_loaded_linear[i];
+        dec_cs = le_parser.le_object_flat_32bit;
     }
     else {
-        fixup_tracking_window_lazy_flush(w);
+        dec_cs = i + 1;
     }
 
-    entry = w->length++;
-    return w->table + entry;
-}
+    fixup_read = fixup_map_lower_bound(fixup_map,start);
 
-int fixup_window_sort(const void *a,const void *b) {
-    const struct fixup_tracking_window_ent *fa =
-        (const struct fixup_tracking_window_ent *)a;
-    const struct fixup_tracking_window_ent *fb =
-        (const struct fixup_tracking_window_ent *)b;
+    entry_cs = dec_cs;
+    dec_read = dec_end = dec_buffer;
+    refill(&io,&le_parser);
+    minx86dec_init_state(&dec_st);
+    dec_st.data32 = dec_st.addr32 =
+        (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) ? 1 : 0;
+
+    do {
+        uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer();
+        uint32_t ip = ofs + entry_ip - dec_ofs;
+        unsigned char dosek = 0,stop = 0;
+        uint32_t label_ip = 0;
+        unsigned int c;
+
+        while (labeli < dec_label_count) {
+            label = dec_label + labeli;
+            if (label->seg_v != dec_cs) {
+                labeli++;
+                continue;
+            }
 
-    if (fa->linear_address < fb->linear_address)
-        return -1;
-    if (fa->linear_address > fb->linear_address)
-        return 1;
+            if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
+                if (label->ofs_v < le_parser.le_object_table_loaded_linear[i]) {
+                    labeli++;
+                    continue;
+                }
+            }
+
+            if (ip < label->ofs_v)
+                break;
+            /* next range starts here */
+            if (labeli == job->label_stop) {
+                stop = 1;
+                break;
+            }
+
+            labeli++;
+            label_ip = label->ofs_v;
+
+            fprintf(dec_out,"Label '%s' at %04lx:%04lx\n",
+                    label->name ? label->name : "",
+                    (unsigned long)label->seg_v,
+                    (unsigned long)label->ofs_v);
+
+            label = dec_label + labeli;
+            dosek = 1;
+        }
+
+        if (stop)
+            break;
+
+        if (dosek) {
+            ip = label_ip;
+            reset_buffer();
+            current_offset = ofs;
+            if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
+                if (!le_segofs_to_trackio(&io,0/*flat*/,ip,&le_parser))
+                    break;
+            }
+            else {
+                if (!le_segofs_to_trackio(&io,i + 1,ip,&le_parser))
+                    break;
+            }
+        }
+
+        if (!refill(&io,&le_parser)) break;
+
+        minx86dec_set_buffer(&dec_st,dec_read,(int)(dec_end - dec_read));
+        minx86dec_init_instruction(&dec_i);
+        dec_st.ip_value = ip;
+        minx86dec_decodeall(&dec_st,&dec_i);
+        bench_insn_count++;
+        assert(dec_i.end >= dec_read);
+        assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
+        inslen = (size_t)(dec_i.end - dec_i.start);
+
+        /* fixup tracking */
+        while (fixup_map->table != NULL && fixup_read < fixup_map->length) {
+            fixent = fixup_map->table + fixup_read;
+            if (dec_st.ip_value < fixent->linear_address) break;
+            fixup_read++;
+        }
+
+        if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT)
+            fprintf(dec_out,"%04lX:%08lX  ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value);
+        else
+            fprintf(dec_out,"%04lX:%04lX      ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value);
+
+        {
+            unsigned char *e = dec_i.end;
+
+            // INT 20h VXDCALL
+            if (is_vxd && dec_i.opcode == MXOP_INT && dec_i.argc == 1 &&
+                dec_i.argv[0].regtype == MX86_RT_IMM && dec_i.argv[0].value == 0x20)
+                e += 2+2;
+
+            for (c=0,iptr=dec_i.start;iptr != e;c++)
+                fprintf(dec_out,"%02X ",*iptr++);
+        }
+
+        if (dec_i.rep != MX86_REP_NONE) {
+            for (;c < 6;c++)
+                fprintf(dec_out,"   ");
+
+            switch (dec_i.rep) {
+                case MX86_REPE:
+                    fprintf(dec_out,"REP   ");
+                    break;
+                case MX86_REPNE:
+                    fprintf(dec_out,"REPNE ");
+                    break;
+                default:
+                    break;
+            };
+        }
+        else {
+            for (;c < 8;c++)
+                fprintf(dec_out,"   ");
+        }
+
+        // Special instruction:
+        //   Windows VXDs use INT 20h followed by two WORDs to call other VXDs.
+        if (is_vxd && dec_i.opcode == MXOP_INT && dec_i.argc == 1 &&
+            dec_i.argv[0].regtype == MX86_RT_IMM && dec_i.argv[0].value == 0x20) {
+            // INT 20h WORD, WORD
+            // the decompiler should have set the instruction pointer at the first WORD now.
+            uint16_t vxd_device,vxd_service;
+
+            vxd_service = *((uint16_t*)dec_i.end); dec_i.end += 2;
+            vxd_device = *((uint16_t*)dec_i.end); dec_i.end += 2;
+
+            // bit 15 of the service indicates a jmp, not call
+            if (vxd_service & 0x8000) {
+                fprintf(dec_out,"VxDJmp   Device=0x%04X '%s' Service=0x%04X '%s'",
+                    vxd_device,
+                    vxd_device_to_name(vxd_device),
+                    vxd_service & 0x7FFF,
+                    vxd_service_to_name(vxd_device,vxd_service & 0x7FFF));
+            }
+            else {
+                fprintf(dec_out,"VxDCall  Device=0x%04X '%s' Service=0x%04X '%s'",
+                    vxd_device,
+                    vxd_device_to_name(vxd_device),
+                    vxd_service,
+                    vxd_service_to_name(vxd_device,vxd_service));
+            }
+        }
+        else {
+            fprintf(dec_out,"%-8s ",opcode_string[dec_i.opcode]);
+
+            for (c=0;c < (unsigned int)dec_i.argc;) {
+                minx86dec_regprint(&dec_i.argv[c],arg_c);
+                fprintf(dec_out,"%s",arg_c);
+                if (++c < (unsigned int)dec_i.argc) fprintf(dec_out,",");
+            }
+        }
+        if (dec_i.lock) fprintf(dec_out,"  ; LOCK#");
+        fprintf(dec_out,"\n");
+
+        dec_read = dec_i.end;
+
+        if (fixup_map->table != NULL && fixup_read < fixup_map->length) {
+            fixent = fixup_map->table + fixup_read;
+            if (fixent->linear_address >= dec_st.ip_value &&
+                fixent->linear_address < (dec_st.ip_value + inslen)) {
+                struct le_header_fixup_record_table *frtable;
+                unsigned char flags,src;
+                unsigned char *raw;
+
+                assert(fixent->fixup_rec_page > 0);
+                assert(fixent->fixup_rec_page <= le_parser.le_header.number_of_memory_pages);
+                frtable = le_parser.le_fixup_records.table + fixent->fixup_rec_page - 1;
+                raw = le_header_fixup_record_table_get_raw_entry(frtable,fixent->fixup_rec_index);
+
+                fprintf(dec_out,"             ^ Relocation at 0x%08lx (+%u bytes from start of instruction)\n",
+                        (unsigned long)fixent->linear_address,
+                        (unsigned int)(fixent->linear_address - dec_st.ip_value));
+
+                if (raw != NULL) {
+                    src = *raw++;
+                    flags = *raw++;
+
+                    fprintf(dec_out,"                Source type:            0x%02X ",src);
+                    switch (src&0xF) {
+                        case 0x2:
+                            fprintf(dec_out,"16-bit selector fixup (16 bits)");
+                            break;
+                        case 0x7:
+                            fprintf(dec_out,"32-bit offset fixup (32 bits)");
+                            break;
+                        case 0x8:
+                            fprintf(dec_out,"32-bit self-relative offset fixup (32 bits)");
+                            break;
+                        default:
+                            fprintf(dec_out,"Unknown");
+                            continue;
+                    };
+                    if (src & 0x10)
+                        fprintf(dec_out," Fix-up to alias");
+                    fprintf(dec_out,"\n");
+
+                    fprintf(dec_out,"                Source flags:           0x%02X ",flags);
+                    switch (flags&3) {
+                        case 0x0:
+                            fprintf(dec_out,"Internal reference");
+                            break;
+                        case 0x1:
+                            fprintf(dec_out,"Imported reference by ordinal");
+                            break;
+                        case 0x2:
+                            fprintf(dec_out,"Imported reference by name");
+                            break;
+                        case 0x3:
+                            fprintf(dec_out,"Internal reference via entry table");
+                            break;
+                    };
+                    if (flags&4) fprintf(dec_out," ADDITIVE");
+                    if (flags&8) fprintf(dec_out," \"Internal chaining fixup\"");
+                    if (flags&0x10) fprintf(dec_out," \"32-bit target offset\"");
+                    if (flags&0x20) fprintf(dec_out," \"32-bit additive fixup value\"");
+                    if (flags&0x40) fprintf(dec_out," \"16-bit object number/module ordinal\"");
+                    if (flags&0x80) fprintf(dec_out," \"8-bit ordinal\"");
+                    fprintf(dec_out,"\n");
+
+                    if (src & 0x20)
+                        raw++; //number of source offsets. object follows, then array of srcoff
+                    else
+                        raw += 2; //srcoff
+
+                    if ((flags&3) == 0) { // internal reference
+                        uint32_t trglinoff;
+                        uint16_t tobject;
+                        uint32_t trgoff;
+
+                        if (flags&0x40) {
+                            tobject = *((uint16_t*)raw); raw += 2;
+                        }
+                        else {
+                            tobject = *raw++;
+                        }
+
+                        fprintf(dec_out,"                Target object:          #%u\n",(unsigned int)tobject);
+                        if ((src&0xF) != 0x2) { /* not 16-bit selector fixup */
+                            if (flags&0x10) { // 32-bit target offset
+                                trgoff = *((uint32_t*)raw); raw += 4;
+                            }
+                            else { // 16-bit target offset
+                                trgoff = *((uint16_t*)raw); raw += 2;
+                            }
+
+                            // for this computation, we need to convert target object:offset to linear address
+                            if (tobject != 0 && tobject <= le_parser.le_header.object_table_entries)
+                                trglinoff = le_parser.le_object_table_loaded_linear[tobject - 1] + trgoff;
+                            else
+                                trglinoff = 0;
+
+                            fprintf(dec_out,"                Target offset:          linear=0x%08lX offset=0x%08lX\n",
+                                (unsigned long)trglinoff,(unsigned long)trgoff);
+                        }
+                    }
+                }
+            }
+        }
+    } while(1);
 
-    return 0;;
+    pj->insn_count = bench_insn_count - insn_start;
+}
+
+void bench_report(const double t0) {
+    double t = dasm_par_seconds() - t0;
+
+    fprintf(stderr,"%s: %lu instructions in %.3f sec",src_file,bench_insn_count,t);
+    if (t > 0) fprintf(stderr,", %.0f instructions/sec",(double)bench_insn_count / t);
+    fprintf(stderr,"\n");
 }
 
 int main(int argc,char **argv) {
-    struct fixup_tracking_window fixup_window;
-    struct le_header_parseinfo le_parser;
     struct exe_le_header le_header;
     struct le_vmap_trackio io;
     uint32_t le_header_offset;
+    double bench_t0;
     struct dec_label *label;
-    unsigned int labeli;
     uint32_t file_size;
 
-    fixup_tracking_window_init(&fixup_window);
+    dec_out = stdout;
     assert(sizeof(le_parser.le_header) == EXE_HEADER_LE_HEADER_SIZE);
     le_header_parseinfo_init(&le_parser);
     memset(&exehdr,0,sizeof(exehdr));
@@ -1353,6 +1878,8 @@ int main(int argc,char **argv) {
     if (parse_argv(argc,argv))
         return 1;
 
+    bench_t0 = dasm_par_seconds();
+
     assert(sizeof(exehdr) == 0x1C);
 
 #if defined(TARGET_MSDOS) && TARGET_MSDOS == 16
@@ -1368,6 +1895,12 @@ int main(int argc,char **argv) {
     }
     memset(dec_label,0,sizeof(*dec_label) * dec_label_alloc);
 
+    /* if this fails, dec_find_label() scans the labels like it used to */
+    dec_label_hash_size = 64;
+    while (dec_label_hash_size < (dec_label_alloc * 2))
+        dec_label_hash_size *= 2;
+    dec_label_hash = calloc(dec_label_hash_size,sizeof(*dec_label_hash));
+
     if (src_file == NULL) {
         fprintf(stderr,"No source file specified\n");
         return 1;
@@ -1626,6 +2159,7 @@ int main(int argc,char **argv) {
                 label->seg_v = ~0;
                 label->ofs_v = ~0;
                 dec_label_set_name(label,"VXD DDB entry point");
+                dec_label_hash_reset();
             }
 
             if (le_segofs_to_trackio(&io,object,offset,&le_parser)) {
@@ -1823,6 +2357,7 @@ int main(int argc,char **argv) {
                 minx86dec_init_instruction(&dec_i);
                 dec_st.ip_value = ip;
                 minx86dec_decodeall(&dec_st,&dec_i);
+                bench_insn_count++;
                 assert(dec_i.end >= dec_read);
                 assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
 
@@ -1971,444 +2506,69 @@ int main(int argc,char **argv) {
 
     /* second pass decompiler */
     if (le_parser.le_object_table != NULL) {
+        const unsigned int count = le_parser.le_header.object_table_entries;
         struct exe_le_header_object_table_entry *ent;
-        struct fixup_tracking_window_ent *fixent;
-        uint32_t page_base;
+        struct le_dasm_job *jobs = NULL;
+        struct dasm_par_job *pjobs = NULL;
+        size_t jobs_count = 0,jobs_alloc;
         unsigned int i;
-        uint32_t page;
-        size_t inslen;
+        size_t li;
 
-        for (i=0;i < le_parser.le_header.object_table_entries;i++) {
+        le_fixup_maps = calloc(count ? count : 1,sizeof(*le_fixup_maps));
+        jobs_alloc = count;
+        jobs = calloc(jobs_alloc ? jobs_alloc : 1,sizeof(*jobs));
+        if (le_fixup_maps == NULL || jobs == NULL) {
+            fprintf(stderr,"Failed to alloc second pass jobs\n");
+            return 1;
+        }
+
+        for (i=0;i < count;i++) {
             ent = le_parser.le_object_table + i;
 
-            fixup_tracking_window_free(&fixup_window);
+            jobs[jobs_count].object = i;
+            jobs[jobs_count].first = 1;
+            jobs[jobs_count].label_stop = (unsigned int)dec_label_count;
+            jobs_count++;
 
-            printf("* LE object #%u (%u-bit)\n",
-                i + 1,
-                (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) ? 32 : 16);
-            if (!(ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_EXECUTABLE)) {
-                printf("    Ignoring data object\n");
+            if (!(ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_EXECUTABLE))
                 continue;
-            }
-
-            if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
-                if (!le_segofs_to_trackio(&io,0/*flat*/,le_parser.le_object_table_loaded_linear[i],&le_parser))
-                    continue;
-            }
-            else {
-                if (!le_segofs_to_trackio(&io,i + 1,0,&le_parser))
-                    continue;
-            }
-
-            reset_buffer();
-            labeli = 0;
-            dec_ofs = 0;
-            entry_ip = 0;
-            start_decom = 0;
-            page = ent->page_map_index;
-            end_decom = ent->virtual_segment_size;
-
-            if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
-                current_offset = le_parser.le_object_table_loaded_linear[i];
-                end_decom += le_parser.le_object_table_loaded_linear[i];
-                page_base = le_parser.le_object_table_loaded_linear[i];
-                dec_cs = le_parser.le_object_flat_32bit;
-            }
-            else {
-                current_offset = 0;
-                dec_cs = i + 1;
-                page_base = 0;
-            }
-
-            entry_cs = dec_cs;
-            dec_read = dec_end = dec_buffer;
-            refill(&io,&le_parser);
-            minx86dec_init_state(&dec_st);
-            dec_st.data32 = dec_st.addr32 =
-                (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) ? 1 : 0;
-
-            do {
-                uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer();
-                uint32_t ip = ofs + entry_ip - dec_ofs;
-                unsigned char dosek = 0;
-                uint32_t label_ip = 0;
-                unsigned int c;
-
-                while (labeli < dec_label_count) {
-                    label = dec_label + labeli;
-                    if (label->seg_v != dec_cs) {
-                        labeli++;
-                        continue;
-                    }
-
-                    if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
-                        if (label->ofs_v < le_parser.le_object_table_loaded_linear[i]) {
-                            labeli++;
-                            continue;
-                        }
-                    }
-
-                    if (ip < label->ofs_v)
-                        break;
-
-                    labeli++;
-                    label_ip = label->ofs_v;
-
-                    printf("Label '%s' at %04lx:%04lx\n",
-                            label->name ? label->name : "",
-                            (unsigned long)label->seg_v,
-                            (unsigned long)label->ofs_v);
-
-                    label = dec_label + labeli;
-                    dosek = 1;
-                }
-
-                if (dosek) {
-                    ip = label_ip;
-                    reset_buffer();
-                    current_offset = ofs;
-                    if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT) {
-                        if (!le_segofs_to_trackio(&io,0/*flat*/,ip,&le_parser))
-                            break;
-                    }
-                    else {
-                        if (!le_segofs_to_trackio(&io,i + 1,ip,&le_parser))
-                            break;
-                    }
-                }
-
-                if (!refill(&io,&le_parser)) break;
-
-                /* track page.
-                 * load new entries slightly ahead (16 bytes) because
-                 * relocations that span pages reach backwards into the prior page.
-                 * since we only read forward, we can free older relocations from memory
-                 * when we load new ones. */
-                if (le_parser.le_fixup_records.table != NULL) {
-                    uint32_t pob = ip + (uint32_t)16 - page_base;
-                    uint32_t po = (pob / (uint32_t)le_parser.le_header.memory_page_size) + ent->page_map_index;
-                    struct le_header_fixup_record_table *frtable;
-                    unsigned int srcoff_count,srcoff_i;
-                    unsigned char flags,src;
-                    uint32_t srclinoff;
-                    unsigned char *raw;
-                    uint16_t srcoff;
-                    uint8_t chk=0;
-                    size_t ti;
-
-                    /* setup */
-
-                    /* free old entries */
-                    fixup_tracking_window_lazy_flush(&fixup_window);
-
-                    /* load new entries */
-                    while (page <= po) {
-                        uint32_t pagelinoff =
-                            ((uint32_t)page - (uint32_t)ent->page_map_index) * (uint32_t)le_parser.le_header.memory_page_size;
-
-                        if (page != 0 && page <= le_parser.le_header.number_of_memory_pages) {
-                            frtable = le_parser.le_fixup_records.table + page - 1;
-                            if (frtable->table != NULL && frtable->length != 0) {
-                                printf("* Loading relocations for page #%u\n",page);
-
-                                chk = 1;
-                                for (ti=0;ti < frtable->length;ti++) {
-                                    raw = le_header_fixup_record_table_get_raw_entry(frtable,ti);
-
-                                    // caller ensures the record is long enough
-                                    src = *raw++;
-                                    flags = *raw++;
-
-                                    if (src & 0xC0)
-                                        continue;
-
-                                    if (src & 0x20) {
-                                        srcoff_count = *raw++; //number of source offsets. object follows, then array of srcoff
-                                    }
-                                    else {
-                                        srcoff_count = 1;
-                                        srcoff = *((int16_t*)raw); raw += 2;
-                                    }
-
-                                    if ((flags&3) == 0) { // internal reference
-                                        if (flags&0x40) {
-                                            raw += 2; /* tobject = *((uint16_t*)raw); */
-                                        }
-                                        else {
-                                            raw++; /* tobject = *raw++; */
-                                        }
-
-                                        if ((src&0xF) != 0x2) { /* not 16-bit selector fixup */
-                                            if (flags&0x10) { // 32-bit target offset
-                                                raw += 4; /* trgoff = *((uint32_t*)raw); */
-                                            }
-                                            else { // 16-bit target offset
-                                                raw += 2; /* trgoff = *((uint16_t*)raw); */
-                                            }
-                                        }
-
-                                        if (src & 0x20) {
-                                            for (srcoff_i=0;srcoff_i < srcoff_count;srcoff_i++) {
-                                                srcoff = *((int16_t*)raw); raw += 2;
-
-                                                if ((src&0xF) == 0x7) { // must be 32-bit offset fixup
-                                                    // what is the relocation relative to the struct we just read?
-                                                    srclinoff =
-                                                        le_parser.le_object_table_loaded_linear[i] + pagelinoff + (uint32_t)srcoff;
-                                                    fixent =
-                                                        fixup_tracking_window_alloc_entry(&fixup_window);
-                                                    if (fixent) {
-                                                        fixent->fixup_rec_page = page;
-                                                        fixent->fixup_rec_index = ti;
-                                                        fixent->linear_address = srclinoff;
-                                                    }
-                                                    else {
-                                                        printf("! unable to alloc reloc tracking\n");
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        else {
-                                            if ((src&0xF) == 0x7) { // must be 32-bit offset fixup
-                                                // what is the relocation relative to the struct we just read?
-                                                srclinoff =
-                                                    le_parser.le_object_table_loaded_linear[i] + pagelinoff + (uint32_t)srcoff;
-                                                fixent =
-                                                    fixup_tracking_window_alloc_entry(&fixup_window);
-                                                if (fixent) {
-                                                    fixent->fixup_rec_page = page;
-                                                    fixent->fixup_rec_index = ti;
-                                                    fixent->linear_address = srclinoff;
-                                                }
-                                                else {
-                                                    printf("! unable to alloc reloc tracking\n");
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        page++;
-                    }
-
-                    if (chk) {
-                        /* sort entries (past read pointer) so code below can read entry-by-entry.
-                         * ONLY sort the entries yet to be read, not the ones already read. */
-                        assert(fixup_window.table != NULL);
-                        assert(fixup_window.read <= fixup_window.length);
-                        if (fixup_window.read < fixup_window.length) {
-                            qsort(fixup_window.table+fixup_window.read,
-                                  fixup_window.length-fixup_window.read,
-                                  sizeof(*(fixup_window.table)),fixup_window_sort);
-                        }
-                    }
-                }
-
-                minx86dec_set_buffer(&dec_st,dec_read,(int)(dec_end - dec_read));
-                minx86dec_init_instruction(&dec_i);
-                dec_st.ip_value = ip;
-                minx86dec_decodeall(&dec_st,&dec_i);
-                assert(dec_i.end >= dec_read);
-                assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
-                inslen = (size_t)(dec_i.end - dec_i.start);
-
-                /* fixup tracking */
-                while (fixup_window.table != NULL && fixup_window.read < fixup_window.length) {
-                    fixent = fixup_window.table + fixup_window.read;
-                    if (dec_st.ip_value < fixent->linear_address) break;
-                    fixup_window.read++;
-                }
-
-                if (ent->object_flags & LE_HEADER_OBJECT_TABLE_ENTRY_FLAGS_386_BIG_DEFAULT)
-                    printf("%04lX:%08lX  ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value);
-                else
-                    printf("%04lX:%04lX      ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value);
 
-                {
-                    unsigned char *e = dec_i.end;
-
-                    // INT 20h VXDCALL
-                    if (is_vxd && dec_i.opcode == MXOP_INT && dec_i.argc == 1 &&
-                        dec_i.argv[0].regtype == MX86_RT_IMM && dec_i.argv[0].value == 0x20)
-                        e += 2+2;
-
-                    for (c=0,iptr=dec_i.start;iptr != e;c++)
-                        printf("%02X ",*iptr++);
-                }
-
-                if (dec_i.rep != MX86_REP_NONE) {
-                    for (;c < 6;c++)
-                        printf("   ");
-
-                    switch (dec_i.rep) {
-                        case MX86_REPE:
-                            printf("REP   ");
-                            break;
-                        case MX86_REPNE:
-                            printf("REPNE ");
-                            break;
-                        default:
-                            break;
-                    };
-                }
-                else {
-                    for (;c < 8;c++)
-                        printf("   ");
-                }
-
-                // Special instruction:
-                //   Windows VXDs use INT 20h followed by two WORDs to call other VXDs.
-                if (is_vxd && dec_i.opcode == MXOP_INT && dec_i.argc == 1 &&
-                    dec_i.argv[0].regtype == MX86_RT_IMM && dec_i.argv[0].value == 0x20) {
-                    // INT 20h WORD, WORD
-                    // the decompiler should have set the instruction pointer at the first WORD now.
-                    uint16_t vxd_device,vxd_service;
-
-                    vxd_service = *((uint16_t*)dec_i.end); dec_i.end += 2;
-                    vxd_device = *((uint16_t*)dec_i.end); dec_i.end += 2;
-
-                    // bit 15 of the service indicates a jmp, not call
-                    if (vxd_service & 0x8000) {
-                        printf("VxDJmp   Device=0x%04X '%s' Service=0x%04X '%s'",
-                            vxd_device,
-                            vxd_device_to_name(vxd_device),
-                            vxd_service & 0x7FFF,
-                            vxd_service_to_name(vxd_device,vxd_service & 0x7FFF));
-                    }
-                    else {
-                        printf("VxDCall  Device=0x%04X '%s' Service=0x%04X '%s'",
-                            vxd_device,
-                            vxd_device_to_name(vxd_device),
-                            vxd_service,
-                            vxd_service_to_name(vxd_device,vxd_service));
-                    }
-                }
-                else {
-                    printf("%-8s ",opcode_string[dec_i.opcode]);
-
-                    for (c=0;c < (unsigned int)dec_i.argc;) {
-                        minx86dec_regprint(&dec_i.argv[c],arg_c);
-                        printf("%s",arg_c);
-                        if (++c < (unsigned int)dec_i.argc) printf(",");
-                    }
-                }
-                if (dec_i.lock) printf("  ; LOCK#");
-                printf("\n");
-
-                dec_read = dec_i.end;
-
-                if (fixup_window.table != NULL && fixup_window.read < fixup_window.length) {
-                    fixent = fixup_window.table + fixup_window.read;
-                    if (fixent->linear_address >= dec_st.ip_value &&
-                        fixent->linear_address < (dec_st.ip_value + inslen)) {
-                        struct le_header_fixup_record_table *frtable;
-                        unsigned char flags,src;
-                        unsigned char *raw;
-
-                        assert(fixent->fixup_rec_page > 0);
-                        assert(fixent->fixup_rec_page <= le_parser.le_header.number_of_memory_pages);
-                        frtable = le_parser.le_fixup_records.table + fixent->fixup_rec_page - 1;
-                        raw = le_header_fixup_record_table_get_raw_entry(frtable,fixent->fixup_rec_index);
-
-                        printf("             ^ Relocation at 0x%08lx (+%u bytes from start of instruction)\n",
-                                (unsigned long)fixent->linear_address,
-                                (unsigned int)(fixent->linear_address - dec_st.ip_value));
-
-                        if (raw != NULL) {
-                            src = *raw++;
-                            flags = *raw++;
-
-                            printf("                Source type:            0x%02X ",src);
-                            switch (src&0xF) {
-                                case 0x2:
-                                    printf("16-bit selector fixup (16 bits)");
-                                    break;
-                                case 0x7:
-                                    printf("32-bit offset fixup (32 bits)");
-                                    break;
-                                case 0x8:
-                                    printf("32-bit self-relative offset fixup (32 bits)");
-                                    break;
-                                default:
-                                    printf("Unknown");
-                                    continue;
-                            };
-                            if (src & 0x10)
-                                printf(" Fix-up to alias");
-                            printf("\n");
-
-                            printf("                Source flags:           0x%02X ",flags);
-                            switch (flags&3) {
-                                case 0x0:
-                                    printf("Internal reference");
-                                    break;
-                                case 0x1:
-                                    printf("Imported reference by ordinal");
-                                    break;
-                                case 0x2:
-                                    printf("Imported reference by name");
-                                    break;
-                                case 0x3:
-                                    printf("Internal reference via entry table");
-                                    break;
-                            };
-                            if (flags&4) printf(" ADDITIVE");
-                            if (flags&8) printf(" \"Internal chaining fixup\"");
-                            if (flags&0x10) printf(" \"32-bit target offset\"");
-                            if (flags&0x20) printf(" \"32-bit additive fixup value\"");
-                            if (flags&0x40) printf(" \"16-bit object number/module ordinal\"");
-                            if (flags&0x80) printf(" \"8-bit ordinal\"");
-                            printf("\n");
-
-                            if (src & 0x20)
-                                raw++; //number of source offsets. object follows, then array of srcoff
-                            else
-                                raw += 2; //srcoff
-
-                            if ((flags&3) == 0) { // internal reference
-                                uint32_t trglinoff;
-                                uint16_t tobject;
-                                uint32_t trgoff;
+            fixup_map_build(le_fixup_maps + i,&le_parser,i);
+        }
 
-                                if (flags&0x40) {
-                                    tobject = *((uint16_t*)raw); raw += 2;
-                                }
-                                else {
-                                    tobject = *raw++;
-                                }
+        pjobs = calloc(jobs_count ? jobs_count : 1,sizeof(*pjobs));
+        if (pjobs == NULL) {
+            fprintf(stderr,"Failed to alloc second pass jobs\n");
+            return 1;
+        }
+        for (li=0;li < jobs_count;li++)
+            pjobs[li].user = jobs + li;
 
-                                printf("                Target object:          #%u\n",(unsigned int)tobject);
-                                if ((src&0xF) != 0x2) { /* not 16-bit selector fixup */
-                                    if (flags&0x10) { // 32-bit target offset
-                                        trgoff = *((uint32_t*)raw); raw += 4;
-                                    }
-                                    else { // 16-bit target offset
-                                        trgoff = *((uint16_t*)raw); raw += 2;
-                                    }
+        {
+            struct dasm_par_funcs f;
 
-                                    // for this computation, we need to convert target object:offset to linear address
-                                    if (tobject != 0 && tobject <= le_parser.le_header.object_table_entries)
-                                        trglinoff = le_parser.le_object_table_loaded_linear[tobject - 1] + trgoff;
-                                    else
-                                        trglinoff = 0;
+            f.run = le_dasm_job;
+            f.thread_init = le_dasm_thread_init;
+            f.thread_free = le_dasm_thread_free;
+            dasm_par_run(pjobs,jobs_count,dasm_threads,&f);
+        }
 
-                                    printf("                Target offset:          linear=0x%08lX offset=0x%08lX\n",
-                                        (unsigned long)trglinoff,(unsigned long)trgoff);
-                                }
-                            }
-                        }
-                    }
-                }
-            } while(1);
+        bench_insn_count = 0;
+        for (li=0;li < jobs_count;li++)
+            bench_insn_count += pjobs[li].insn_count;
 
-            fixup_tracking_window_free(&fixup_window);
-        }
+        for (i=0;i < count;i++)
+            fixup_map_free(le_fixup_maps + i);
+        free(le_fixup_maps);
+        le_fixup_maps = NULL;
+        free(pjobs);
+        free(jobs);
     }
 
-    fixup_tracking_window_free(&fixup_window);
     le_header_parseinfo_free(&le_parser);
+    if (bench_mode)
+        bench_report(bench_t0);
+
     dec_free_labels();
     close(src_fd);
     return 0;
@@ -41,6 +41,8 @@
 #include <hw/dos/exenehdr.h>
 #include <hw/dos/exenepar.h>
 
+#include "dasmpar.h"
+
 #ifndef O_BINARY
 #define O_BINARY 0
 #endif
@@ -111,22 +113,25 @@ void dec_label_set_name(struct dec_label *l,const char *s) {
 struct dec_label*               dec_label = NULL;
 size_t                          dec_label_count = 0;
 size_t                          dec_label_alloc = 0;
-unsigned long                   dec_ofs;
-uint16_t                        dec_cs;
-
-char                            name_tmp[255+1];
-
-uint8_t                         dec_buffer[512];
-uint8_t*                        dec_read;
-uint8_t*                        dec_end;
-char                            arg_c[101];
-struct minx86dec_state          dec_st;
-struct minx86dec_instruction    dec_i;
-minx86_read_ptr_t               iptr;
-uint16_t                        entry_cs,entry_ip;
-uint16_t                        start_cs,start_ip;
-uint32_t                        start_decom,end_decom,entry_ofs;
-uint32_t                        current_offset;
+unsigned int*                   dec_label_hash = NULL;          // dec_label[] index + 1, 0 if slot is empty
+size_t                          dec_label_hash_size = 0;        // power of 2, at least twice dec_label_alloc
+size_t                          dec_label_hashed = 0;           // dec_label[0...dec_label_hashed-1] are in the hash
+DASM_TLS unsigned long          dec_ofs;
+DASM_TLS uint16_t               dec_cs;
+
+DASM_TLS char                   name_tmp[255+1];
+
+DASM_TLS uint8_t                dec_buffer[512];
+DASM_TLS uint8_t*               dec_read;
+DASM_TLS uint8_t*               dec_end;
+DASM_TLS char                   arg_c[101];
+DASM_TLS struct minx86dec_state dec_st;
+DASM_TLS struct minx86dec_instruction dec_i;
+DASM_TLS minx86_read_ptr_t      iptr;
+DASM_TLS uint16_t               entry_cs,entry_ip;
+DASM_TLS uint16_t               start_cs,start_ip;
+DASM_TLS uint32_t               start_decom,end_decom,entry_ofs;
+DASM_TLS uint32_t               current_offset;
 
 struct exe_dos_header           exehdr;
 
@@ -134,7 +139,23 @@ char*                           sym_file = NULL;
 char*                           label_file = NULL;
 
 char*                           src_file = NULL;
-int                             src_fd = -1;
+DASM_TLS int                    src_fd = -1;
+
+unsigned char                   bench_mode = 0;
+DASM_TLS unsigned long          bench_insn_count = 0;
+
+DASM_TLS FILE*                  dec_out = NULL;         // second pass output, per job
+
+unsigned int                    dasm_threads = 1;       // second pass threads, -j
+struct dasm_par_job*            ne_dasm_jobs = NULL;    // one per segment
+
+struct exe_ne_header_segment_reloc_table*   ne_segment_relocs = NULL;
+struct exe_ne_header_imported_name_table    ne_imported_name_table;
+struct exe_ne_header_entry_table_table      ne_entry_table;
+struct exe_ne_header_name_entry_table       ne_nonresname;
+struct exe_ne_header_name_entry_table       ne_resname;
+struct exe_ne_header_segment_table          ne_segments;
+struct mod_symbols_list                     mod_syms;
 
 void dec_free_labels() {
     unsigned int i=0;
@@ -150,6 +171,11 @@ void dec_free_labels() {
 
     free(dec_label);
     dec_label = NULL;
+
+    if (dec_label_hash != NULL) {
+        free(dec_label_hash);
+        dec_label_hash = NULL;
+    }
 }
 
 uint32_t current_offset_minus_buffer() {
@@ -172,6 +198,8 @@ void help() {
     fprintf(stderr,"    -i <file>        File to decompile\n");
     fprintf(stderr,"    -lf <file>       Text file to define labels\n");
     fprintf(stderr,"    -sym <file>      Module symbols file\n");
+    fprintf(stderr,"    -bench           Report disassembly speed to stderr\n");
+    fprintf(stderr,"    -j <n>           Second pass threads (0 = one per CPU, default 1). Limited to 1 for now, see dasmpar.h\n");
 }
 
 int parse_argv(int argc,char **argv) {
@@ -196,6 +224,19 @@ int parse_argv(int argc,char **argv) {
                 sym_file = argv[i++];
                 if (sym_file == NULL) return 1;
             }
+            else if (!strcmp(a,"bench")) {
+                bench_mode = 1;
+            }
+            else if (!strcmp(a,"j")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                dasm_threads = (unsigned int)strtoul(a,NULL,0);
+                if (dasm_threads == 0) dasm_threads = dasm_par_cpu_count();
+                if (dasm_threads > DASM_PAR_MAX_THREADS) {
+                    fprintf(stderr,"-j %u: limited to %u, see dasmpar.h\n",dasm_threads,DASM_PAR_MAX_THREADS);
+                    dasm_threads = DASM_PAR_MAX_THREADS;
+                }
+            }
             else if (!strcmp(a,"h") || !strcmp(a,"help")) {
                 help();
                 return 1;
@@ -262,12 +303,54 @@ int refill() {
     return (dec_read < dec_end);
 }
 
+/* Labels are hashed by seg:off so that dec_find_label() does not have to scan every label for
+ * every branch target. Callers fill in seg_v:ofs_v AFTER dec_label_malloc(), so new labels are
+ * added to the hash lazily by the next lookup. dec_label_sort() resets the hash. */
+void dec_label_hash_reset() {
+    if (dec_label_hash != NULL)
+        memset(dec_label_hash,0,sizeof(*dec_label_hash) * dec_label_hash_size);
+
+    dec_label_hashed = 0;
+}
+
+static size_t dec_label_hash_slot(const uint16_t so,const uint16_t oo) {
+    uint32_t h = (((uint32_t)so << 16UL) | (uint32_t)oo) * (uint32_t)0x9E3779B1UL;
+
+    return (size_t)(h ^ (h >> 15UL)) & (dec_label_hash_size - 1);
+}
+
 struct dec_label *dec_find_label(const uint16_t so,const uint16_t oo) {
     unsigned int i=0;
 
     if (dec_label == NULL)
         return NULL;
 
+    if (dec_label_hash != NULL) {
+        size_t h;
+
+        /* NTS: duplicate seg:off labels go further down the probe sequence in the order
+         *      they were added, so the lookup still returns the first one like the linear scan did */
+        while (dec_label_hashed < dec_label_count) {
+            struct dec_label *l = dec_label + dec_label_hashed;
+
+            h = dec_label_hash_slot(l->seg_v,l->ofs_v);
+            while (dec_label_hash[h] != 0) h = (h + 1) & (dec_label_hash_size - 1);
+            dec_label_hash[h] = (unsigned int)(++dec_label_hashed);
+        }
+
+        h = dec_label_hash_slot(so,oo);
+        while ((i=dec_label_hash[h]) != 0) {
+            struct dec_label *l = dec_label + i - 1;
+
+            if (l->seg_v == so && l->ofs_v == oo)
+                return l;
+
+            h = (h + 1) & (dec_label_hash_size - 1);
+        }
+
+        return NULL;
+    }
+
     while (i < dec_label_count) {
         struct dec_label *l = dec_label + i;
 
@@ -321,11 +404,28 @@ int ne_segment_relocs_table_qsort(const void *a,const void *b) {
     return 0;
 }
 
+/* relocation table must be sorted by seg_offset (ne_segment_relocs_table_qsort).
+ * returns the index of the first relocation at or after ofs. */
+unsigned int ne_segment_relocs_table_lower_bound(const struct exe_ne_header_segment_reloc_table *reloc,const uint16_t ofs) {
+    unsigned int lo = 0,hi = reloc->length,mid;
+
+    while (lo < hi) {
+        mid = lo + ((hi - lo) >> 1U);
+        if (reloc->table[mid].r.seg_offset < ofs)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
 void dec_label_sort() {
     if (dec_label == NULL || dec_label_count == 0)
         return;
 
     qsort(dec_label,dec_label_count,sizeof(*dec_label),dec_label_qsortcb);
+    dec_label_hash_reset();
 }
 
 const char *mod_symbols_list_lookup(
@@ -491,10 +591,10 @@ void print_relocation_farptr(
                 get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),ne_nonresname,ne_resname,relocent->movintref.entry_ordinal);
 
                 if (name_tmp[0] != 0)
-                    printf("entry %s ordinal #%d",
+                    fprintf(dec_out,"entry %s ordinal #%d",
                             name_tmp,relocent->movintref.entry_ordinal);
                 else
-                    printf("entry ordinal #%d",
+                    fprintf(dec_out,"entry ordinal #%d",
                             relocent->movintref.entry_ordinal);
 
                 /* ordinal is 1-based */
@@ -507,7 +607,7 @@ void print_relocation_farptr(
                             struct exe_ne_header_entry_table_movable_segment_entry *ment =
                                 (struct exe_ne_header_entry_table_movable_segment_entry*)rawd;
 
-                            printf(" -- segment #%d -- 0x%04x : 0x%04x",
+                            fprintf(dec_out," -- segment #%d -- 0x%04x : 0x%04x",
                                     ment->segid,
                                     ment->segid,
                                     ment->seg_offs);
@@ -517,7 +617,7 @@ void print_relocation_farptr(
                             struct exe_ne_header_entry_table_fixed_segment_entry *fent =
                                 (struct exe_ne_header_entry_table_fixed_segment_entry*)rawd;
 
-                            printf(" -- segment #%d -- 0x%04x : 0x%04x",
+                            fprintf(dec_out," -- segment #%d -- 0x%04x : 0x%04x",
                                     ent->segment_id,
                                     ent->segment_id,
                                     fent->v.seg_offs);
@@ -526,14 +626,14 @@ void print_relocation_farptr(
                 }
             }
             else {
-                printf("segment #%d : 0x%04X",
+                fprintf(dec_out,"segment #%d : 0x%04X",
                         relocent->intref.segment_index,
                         relocent->intref.seg_offset);
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("module reference #%d '%s', ordinal %d",
+            fprintf(dec_out,"module reference #%d '%s', ordinal %d",
                     relocent->ordinal.module_reference_index,name_tmp,
                     relocent->ordinal.ordinal);
             {
@@ -541,20 +641,20 @@ void print_relocation_farptr(
                     mod_syms,
                     relocent->ordinal.module_reference_index,
                     relocent->ordinal.ordinal);
-                if (sym != NULL) printf(" '%s'",sym);
+                if (sym != NULL) fprintf(dec_out," '%s'",sym);
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("module reference #%d '%s', imp name offset %d",
+            fprintf(dec_out,"module reference #%d '%s', imp name offset %d",
                     relocent->name.module_reference_index,name_tmp,
                     relocent->name.imported_name_offset);
 
             ne_imported_name_table_entry_get_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->name.imported_name_offset);
-            if (name_tmp[0] != 0) printf(" '%s'",name_tmp);
+            if (name_tmp[0] != 0) fprintf(dec_out," '%s'",name_tmp);
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-            printf("OSFIXUP type=0x%04x",
+            fprintf(dec_out,"OSFIXUP type=0x%04x",
                     relocent->osfixup.fixup);
             break;
     }
@@ -574,10 +674,10 @@ void print_relocation_segment(
                 get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),ne_nonresname,ne_resname,relocent->movintref.entry_ordinal);
 
                 if (name_tmp[0] != 0)
-                    printf("segment of entry %s ordinal #%d",
+                    fprintf(dec_out,"segment of entry %s ordinal #%d",
                             name_tmp,relocent->movintref.entry_ordinal);
                 else
-                    printf("segment of entry ordinal #%d",
+                    fprintf(dec_out,"segment of entry ordinal #%d",
                             relocent->movintref.entry_ordinal);
 
                 /* ordinal is 1-based */
@@ -590,13 +690,13 @@ void print_relocation_segment(
                             struct exe_ne_header_entry_table_movable_segment_entry *ment =
                                 (struct exe_ne_header_entry_table_movable_segment_entry*)rawd;
 
-                            printf(" -- segment #%d -- 0x%04x",
+                            fprintf(dec_out," -- segment #%d -- 0x%04x",
                                     ment->segid,
                                     ment->segid);
                         }
                         else {
                             /* NTS: raw_entry() function guarantees that the data available is large enough to hold this struct */
-                            printf(" -- segment #%d -- 0x%04x",
+                            fprintf(dec_out," -- segment #%d -- 0x%04x",
                                     ent->segment_id,
                                     ent->segment_id);
                         }
@@ -604,14 +704,14 @@ void print_relocation_segment(
                 }
             }
             else {
-                printf("segment #%d=0x%04X",
+                fprintf(dec_out,"segment #%d=0x%04X",
                         relocent->intref.segment_index,
                         relocent->intref.segment_index);
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("segment of module reference #%d '%s', ordinal %d",
+            fprintf(dec_out,"segment of module reference #%d '%s', ordinal %d",
                     relocent->ordinal.module_reference_index,name_tmp,
                     relocent->ordinal.ordinal);
             {
@@ -619,17 +719,17 @@ void print_relocation_segment(
                     mod_syms,
                     relocent->ordinal.module_reference_index,
                     relocent->ordinal.ordinal);
-                if (sym != NULL) printf(" '%s'",sym);
+                if (sym != NULL) fprintf(dec_out," '%s'",sym);
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("segment of module reference #%d '%s', imp name offset %d",
+            fprintf(dec_out,"segment of module reference #%d '%s', imp name offset %d",
                     relocent->name.module_reference_index,name_tmp,
                     relocent->name.imported_name_offset);
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-            printf("segment of OSFIXUP type=0x%04x ???",
+            fprintf(dec_out,"segment of OSFIXUP type=0x%04x ???",
                     relocent->osfixup.fixup);
             break;
     }
@@ -649,10 +749,10 @@ void print_relocation_offset(
                 get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),ne_nonresname,ne_resname,relocent->movintref.entry_ordinal);
 
                 if (name_tmp[0] != 0)
-                    printf("offset of entry %s ordinal #%d",
+                    fprintf(dec_out,"offset of entry %s ordinal #%d",
                             name_tmp,relocent->movintref.entry_ordinal);
                 else
-                    printf("offset of entry ordinal #%d",
+                    fprintf(dec_out,"offset of entry ordinal #%d",
                             relocent->movintref.entry_ordinal);
 
                 /* ordinal is 1-based */
@@ -665,7 +765,7 @@ void print_relocation_offset(
                             struct exe_ne_header_entry_table_movable_segment_entry *ment =
                                 (struct exe_ne_header_entry_table_movable_segment_entry*)rawd;
 
-                            printf(" -- 0x%04x",
+                            fprintf(dec_out," -- 0x%04x",
                                     ment->seg_offs);
                         }
                         else {
@@ -673,19 +773,19 @@ void print_relocation_offset(
                             struct exe_ne_header_entry_table_fixed_segment_entry *fent =
                                 (struct exe_ne_header_entry_table_fixed_segment_entry*)rawd;
 
-                            printf(" -- 0x%04x",
+                            fprintf(dec_out," -- 0x%04x",
                                     fent->v.seg_offs);
                         }
                     }
                 }
             }
             else {
-                printf("NOTIMPL");
+                fprintf(dec_out,"NOTIMPL");
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("offset of module reference #%d '%s', ordinal %d",
+            fprintf(dec_out,"offset of module reference #%d '%s', ordinal %d",
                     relocent->ordinal.module_reference_index,name_tmp,
                     relocent->ordinal.ordinal);
             {
@@ -693,41 +793,608 @@ void print_relocation_offset(
                     mod_syms,
                     relocent->ordinal.module_reference_index,
                     relocent->ordinal.ordinal);
-                if (sym != NULL) printf(" '%s'",sym);
+                if (sym != NULL) fprintf(dec_out," '%s'",sym);
             }
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
             ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),ne_imported_name_table,relocent->ordinal.module_reference_index);
-            printf("offset of module reference #%d '%s', imp name offset %d",
+            fprintf(dec_out,"offset of module reference #%d '%s', imp name offset %d",
                     relocent->name.module_reference_index,name_tmp,
                     relocent->name.imported_name_offset);
             break;
         case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-            printf("offset of OSFIXUP type=0x%04x ???",
+            fprintf(dec_out,"offset of OSFIXUP type=0x%04x ???",
                     relocent->osfixup.fixup);
             break;
     }
 }
 
+/* second pass: one job per segment */
+int ne_dasm_thread_init(void) {
+    src_fd = open(src_file,O_RDONLY|O_BINARY);
+    return (src_fd < 0) ? -1 : 0;
+}
+
+void ne_dasm_thread_free(void) {
+    if (src_fd >= 0) {
+        close(src_fd);
+        src_fd = -1;
+    }
+}
+
+void ne_dasm_job(struct dasm_par_job *pj,FILE *out) {
+    const unsigned int segmenti = (unsigned int)(pj - ne_dasm_jobs);
+    const unsigned long insn_start = bench_insn_count;
+    struct dec_label *label;
+    unsigned int reloci;
+    unsigned int labeli;
+    int c;
+
+    dec_out = out;
+
+    const struct exe_ne_header_segment_entry *segent = ne_segments.table + segmenti;
+    uint32_t segment_ofs = (uint32_t)segent->offset_in_segments << (uint32_t)ne_segments.sector_shift;
+    struct exe_ne_header_segment_reloc_table *reloc;
+    uint32_t segment_sz;
+
+    if (segent->offset_in_segments == 0)
+        return;
+
+    segment_sz =
+        (segent->length == 0 ? 0x10000UL : segent->length);
+    dec_cs = segmenti + 1;
+    dec_ofs = 0;
+
+    if ((uint32_t)lseek(src_fd,segment_ofs,SEEK_SET) != segment_ofs) {
+        pj->status = -1;
+        return;
+    }
+
+    fprintf(dec_out,"* NE segment #%d (0x%lx bytes @0x%lx)\n",
+        segmenti + 1,(unsigned long)segment_sz,(unsigned long)segment_ofs);
+
+    labeli = 0;
+    reloci = 0;
+    entry_ip = 0;
+    reset_buffer();
+    entry_cs = dec_cs;
+    current_offset = segment_ofs;
+    end_decom = segment_ofs + segment_sz;
+    minx86dec_init_state(&dec_st);
+    dec_read = dec_end = dec_buffer;
+    dec_st.data32 = dec_st.addr32 = 0;
+
+    if (ne_segment_relocs)
+        reloc = &ne_segment_relocs[segmenti];
+    else
+        reloc = NULL;
+
+    if (segent->flags & EXE_NE_HEADER_SEGMENT_ENTRY_FLAGS_DATA) {
+        unsigned int col = 0;
+
+        do {
+            uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer() - segment_ofs;
+            uint32_t ip = ofs + entry_ip - dec_ofs;
+
+            while (labeli < dec_label_count) {
+                label = dec_label + labeli;
+                if (label->seg_v != dec_cs) {
+                    labeli++;
+                    continue;
+                }
+                if (ip < label->ofs_v)
+                    break;
+
+                labeli++;
+                ip = label->ofs_v;
+                dec_cs = label->seg_v;
+                ofs = segment_ofs + ip;
+
+                if (col != 0) {
+                    fprintf(dec_out,"\n");
+                    col = 0;
+                }
+
+                fprintf(dec_out,"Label '%s' at %04lx:%04lx @0x%08lx\n",
+                        label->name ? label->name : "",
+                        (unsigned long)label->seg_v,
+                        (unsigned long)label->ofs_v,
+                        (unsigned long)ofs);
+
+                label = dec_label + labeli;
+            }
+
+            if (!refill()) break;
+
+            if (reloc) {
+                while (reloci < reloc->length && reloc->table[reloci].r.seg_offset < ip)
+                    reloci++;
+            }
+
+            /* if any part of the instruction is affected by EXE relocations, say so */
+            if (reloc && reloci < reloc->length) {
+                const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
+                const uint32_t o = relocent->r.seg_offset;
+
+                if (o == ip) {
+                    if (col != 0) {
+                        fprintf(dec_out,"\n");
+                        col = 0;
+                    }
+                    fprintf(dec_out,"%04lX:%04lX @0x%08lX ",
+                            (unsigned long)dec_cs,
+                            (unsigned long)ip,
+                            (unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
+
+                    fprintf(dec_out," <--- EXE relocation ");
+
+                    switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
+                            fprintf(dec_out,"Internal ref");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
+                            fprintf(dec_out,"Import by ordinal");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
+                            fprintf(dec_out,"Import by name");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
+                            fprintf(dec_out,"OSFIXUP");
+                            break;
+                    }
+                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)
+                        fprintf(dec_out," (ADDITIVE)");
+                    fprintf(dec_out," ");
+
+                    switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET_LOBYTE:
+                            fprintf(dec_out,"addr=OFFSET_LOBYTE");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
+                            fprintf(dec_out,"addr=SEGMENT");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
+                            fprintf(dec_out,"addr=FAR_POINTER(16:16)");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
+                            fprintf(dec_out,"addr=OFFSET");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR48_POINTER:
+                            fprintf(dec_out,"addr=FAR_POINTER(16:32)");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET32:
+                            fprintf(dec_out,"addr=OFFSET32");
+                            break;
+                        default:
+                            fprintf(dec_out,"addr=0x%02x",relocent->r.reloc_address_type);
+                            break;
+                    }
+                    fprintf(dec_out,"\n");
+
+                    switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
+                            if (relocent->intref.segment_index == 0xFF) {
+                                get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),&ne_nonresname,&ne_resname,relocent->movintref.entry_ordinal);
+
+                                fprintf(dec_out,"                    Refers to movable segment, entry ordinal #%d",
+                                        relocent->movintref.entry_ordinal);
+                                if (name_tmp[0] != 0)
+                                    fprintf(dec_out," '%s'",name_tmp);
+                                fprintf(dec_out,"\n");
+                            }
+                            else {
+                                fprintf(dec_out,"                    Refers to segment #%d : 0x%04x\n",
+                                        relocent->intref.segment_index,
+                                        relocent->intref.seg_offset);
+                            }
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
+                            ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
+                            fprintf(dec_out,"                    Refers to module reference #%d '%s', ordinal %d",
+                                    relocent->ordinal.module_reference_index,name_tmp,
+                                    relocent->ordinal.ordinal);
+                            {
+                                const char *sym = mod_symbols_list_lookup(
+                                    &mod_syms,
+                                    relocent->ordinal.module_reference_index,
+                                    relocent->ordinal.ordinal);
+                                if (sym != NULL) fprintf(dec_out," '%s'",sym);
+                            }
+                            fprintf(dec_out,"\n");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
+                            ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
+                            fprintf(dec_out,"                    Refers to module reference #%d '%s', imp name offset %d",
+                                    relocent->name.module_reference_index,name_tmp,
+                                    relocent->name.imported_name_offset);
+
+                            ne_imported_name_table_entry_get_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->name.imported_name_offset);
+                            fprintf(dec_out," '%s'\n",
+                                    name_tmp);
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
+                            fprintf(dec_out,"                    OSFIXUP type=0x%04x\n",
+                                    relocent->osfixup.fixup);
+                            break;
+                    }
+
+                    col = 0;
+                    fprintf(dec_out,"                    at +%u bytes (%04x:%04x)\n",
+                            (unsigned int)(o - ip),
+                            (unsigned int)dec_cs,
+                            (unsigned int)dec_st.ip_value + (unsigned int)(o - ip));
+                }
+            }
+
+            if (col == 0) {
+                fprintf(dec_out,"%04lX:%04lX @0x%08lX ",
+                    (unsigned long)dec_cs,
+                    (unsigned long)ip,
+                    (unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
+            }
+
+            while (col < ((unsigned int)(ip & 0xF))) {
+                fprintf(dec_out,"   ");
+                col++;
+            }
+
+            assert(dec_read < dec_end);
+            fprintf(dec_out,"%02X ",*dec_read++);
+            col++;
+
+            if (col >= 16) {
+                fprintf(dec_out,"\n");
+                col = 0;
+            }
+        } while(1);
+
+        if (col != 0) {
+            fprintf(dec_out,"\n");
+            col = 0;
+        }
+    }
+    else {
+        do {
+            uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer() - segment_ofs;
+            uint32_t ip = ofs + entry_ip - dec_ofs;
+            unsigned char reloc_ann = 0;
+            unsigned char dosek = 0;
+            size_t inslen;
+
+            while (labeli < dec_label_count) {
+                label = dec_label + labeli;
+                if (label->seg_v != dec_cs) {
+                    labeli++;
+                    continue;
+                }
+                if (ip < label->ofs_v)
+                    break;
+
+                labeli++;
+                ip = label->ofs_v;
+                dec_cs = label->seg_v;
+                ofs = segment_ofs + ip;
+
+                fprintf(dec_out,"Label '%s' at %04lx:%04lx @0x%08lx\n",
+                        label->name ? label->name : "",
+                        (unsigned long)label->seg_v,
+                        (unsigned long)label->ofs_v,
+                        (unsigned long)ofs);
+
+                label = dec_label + labeli;
+                dosek = 1;
+            }
+
+            if (dosek) {
+                reset_buffer();
+                current_offset = ofs;
+                if ((uint32_t)lseek(src_fd,current_offset,SEEK_SET) != current_offset) {
+                    pj->status = -1;
+                    break;
+                }
+            }
+
+            if (!refill()) break;
+
+            minx86dec_set_buffer(&dec_st,dec_read,(int)(dec_end - dec_read));
+            minx86dec_init_instruction(&dec_i);
+            dec_st.ip_value = ip;
+            minx86dec_decodeall(&dec_st,&dec_i);
+            bench_insn_count++;
+            assert(dec_i.end >= dec_read);
+            assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
+            inslen = (size_t)(dec_i.end - dec_i.start);
+
+            if (reloc) {
+                while (reloci < reloc->length && reloc->table[reloci].r.seg_offset < ip)
+                    reloci++;
+            }
+
+            fprintf(dec_out,"%04lX:%04lX @0x%08lX ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value,(unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
+            for (c=0,iptr=dec_i.start;iptr != dec_i.end;c++)
+                fprintf(dec_out,"%02X ",*iptr++);
+
+            if (dec_i.rep != MX86_REP_NONE) {
+                for (;c < 6;c++)
+                    fprintf(dec_out,"   ");
+
+                switch (dec_i.rep) {
+                    case MX86_REPE:
+                        fprintf(dec_out,"REP   ");
+                        break;
+                    case MX86_REPNE:
+                        fprintf(dec_out,"REPNE ");
+                        break;
+                    default:
+                        break;
+                };
+            }
+            else {
+                for (;c < 8;c++)
+                    fprintf(dec_out,"   ");
+            }
+            fprintf(dec_out,"%-8s ",opcode_string[dec_i.opcode]);
+
+            if (reloc && reloci < reloc->length) {
+                const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
+                const uint32_t o = relocent->r.seg_offset;
+
+                if (o >= ip && o < (ip + inslen)) {
+                    if ((dec_i.opcode == MXOP_JMP_FAR || dec_i.opcode == MXOP_CALL_FAR) && dec_i.argc == 1 &&
+                        dec_i.argv[0].segment == MX86_SEG_IMM && dec_i.argv[0].regtype == MX86_RT_IMM) {
+
+                        switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
+                                if (o == (ip + 1 + 2)) { // CALL/JMP FAR segment relocation affecting segment portion
+                                    fprintf(dec_out,"<");
+                                    print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
+                                        fprintf(dec_out," + 0x%04x>:0x%04x",
+                                            (unsigned int)dec_i.argv[0].segval,
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+                                    else {
+                                        fprintf(dec_out,">:0x%04x",
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+
+                                    reloc_ann = 1;
+                                }
+                                break;
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
+                                if (o == (ip + 1)) {
+                                    if (!(relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)) {
+                                        fprintf(dec_out,"<");
+                                        print_relocation_farptr(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                        fprintf(dec_out,">");
+                                    }
+
+                                    reloc_ann = 1;
+                                }
+                                break;
+                        };
+                    }
+                    if ((dec_i.opcode == MXOP_PUSH) && dec_i.argc == 1 &&
+                        dec_i.argv[0].regtype == MX86_RT_IMM) {
+
+                        switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
+                                {
+                                    fprintf(dec_out,"<");
+                                    print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
+                                        fprintf(dec_out," + 0x%04x>",
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+                                    else {
+                                        fprintf(dec_out,">");
+                                    }
+                                }
+                                break;
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
+                                {
+                                    fprintf(dec_out,"<");
+                                    print_relocation_offset(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
+                                        fprintf(dec_out," + 0x%04x>",
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+                                    else {
+                                        fprintf(dec_out,">");
+                                    }
+                                }
+                                break;
+                        };
+
+                        reloc_ann = 1;
+                    }
+                    if ((dec_i.opcode == MXOP_MOV || dec_i.opcode == MXOP_ADD || dec_i.opcode == MXOP_SUB ||
+                         dec_i.opcode == MXOP_CMP || dec_i.opcode == MXOP_XOR) && dec_i.argc == 2 &&
+                        dec_i.argv[1].regtype == MX86_RT_IMM) {
+
+                        for (c=0;c < 1;) {
+                            minx86dec_regprint(&dec_i.argv[c],arg_c);
+                            fprintf(dec_out,"%s",arg_c);
+                            if (++c < dec_i.argc) fprintf(dec_out,",");
+                        }
+
+                        switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
+                                {
+                                    fprintf(dec_out,"<");
+                                    print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
+                                        fprintf(dec_out," + 0x%04x>",
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+                                    else {
+                                        fprintf(dec_out,">");
+                                    }
+                                }
+                                break;
+                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
+                                {
+                                    fprintf(dec_out,"<");
+                                    print_relocation_offset(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
+                                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
+                                        fprintf(dec_out," + 0x%04x>",
+                                            (unsigned int)dec_i.argv[0].value);
+                                    }
+                                    else {
+                                        fprintf(dec_out,">");
+                                    }
+                                }
+                                break;
+                        };
+
+                        reloc_ann = 1;
+                    }
+                }
+            }
+
+            if (!reloc_ann) {
+                for (c=0;c < dec_i.argc;) {
+                    minx86dec_regprint(&dec_i.argv[c],arg_c);
+                    fprintf(dec_out,"%s",arg_c);
+                    if (++c < dec_i.argc) fprintf(dec_out,",");
+                }
+            }
+            if (dec_i.lock) fprintf(dec_out,"  ; LOCK#");
+            fprintf(dec_out,"\n");
+
+            /* if any part of the instruction is affected by EXE relocations, say so */
+            if (reloc && reloci < reloc->length) {
+                const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
+                const uint32_t o = relocent->r.seg_offset;
+
+                if (o >= ip && o < (ip + inslen)) {
+                    fprintf(dec_out,"             ^ EXE relocation ");
+
+                    switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
+                            fprintf(dec_out,"Internal ref");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
+                            fprintf(dec_out,"Import by ordinal");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
+                            fprintf(dec_out,"Import by name");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
+                            fprintf(dec_out,"OSFIXUP");
+                            break;
+                    }
+                    if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)
+                        fprintf(dec_out," (ADDITIVE)");
+                    fprintf(dec_out," ");
+
+                    switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET_LOBYTE:
+                            fprintf(dec_out,"addr=OFFSET_LOBYTE");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
+                            fprintf(dec_out,"addr=SEGMENT");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
+                            fprintf(dec_out,"addr=FAR_POINTER(16:16)");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
+                            fprintf(dec_out,"addr=OFFSET");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR48_POINTER:
+                            fprintf(dec_out,"addr=FAR_POINTER(16:32)");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET32:
+                            fprintf(dec_out,"addr=OFFSET32");
+                            break;
+                        default:
+                            fprintf(dec_out,"addr=0x%02x",relocent->r.reloc_address_type);
+                            break;
+                    }
+                    fprintf(dec_out,"\n");
+
+                    switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
+                            if (relocent->intref.segment_index == 0xFF) {
+                                get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),&ne_nonresname,&ne_resname,relocent->movintref.entry_ordinal);
+
+                                fprintf(dec_out,"                    Refers to movable segment, entry ordinal #%d",
+                                        relocent->movintref.entry_ordinal);
+                                if (name_tmp[0] != 0)
+                                    fprintf(dec_out," '%s'",name_tmp);
+                                fprintf(dec_out,"\n");
+                            }
+                            else {
+                                fprintf(dec_out,"                    Refers to segment #%d : 0x%04x\n",
+                                        relocent->intref.segment_index,
+                                        relocent->intref.seg_offset);
+                            }
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
+                            ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
+                            fprintf(dec_out,"                    Refers to module reference #%d '%s', ordinal %d",
+                                    relocent->ordinal.module_reference_index,name_tmp,
+                                    relocent->ordinal.ordinal);
+                            {
+                                const char *sym = mod_symbols_list_lookup(
+                                    &mod_syms,
+                                    relocent->ordinal.module_reference_index,
+                                    relocent->ordinal.ordinal);
+                                if (sym != NULL) fprintf(dec_out," '%s'",sym);
+                            }
+                            fprintf(dec_out,"\n");
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
+                            ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
+                            fprintf(dec_out,"                    Refers to module reference #%d '%s', imp name offset %d",
+                                    relocent->name.module_reference_index,name_tmp,
+                                    relocent->name.imported_name_offset);
+
+                            ne_imported_name_table_entry_get_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->name.imported_name_offset);
+                            fprintf(dec_out," '%s'\n",
+                                    name_tmp);
+                            break;
+                        case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
+                            fprintf(dec_out,"                    OSFIXUP type=0x%04x\n",
+                                    relocent->osfixup.fixup);
+                            break;
+                    }
+
+                    fprintf(dec_out,"                    at +%u bytes (%04x:%04x)\n",
+                            (unsigned int)(o - ip),
+                            (unsigned int)dec_cs,
+                            (unsigned int)dec_st.ip_value + (unsigned int)(o - ip));
+                }
+            }
+
+            dec_read = dec_i.end;
+        } while(1);
+    }
+
+    pj->insn_count = bench_insn_count - insn_start;
+}
+
+void bench_report(const double t0) {
+    double t = dasm_par_seconds() - t0;
+
+    fprintf(stderr,"%s: %lu instructions in %.3f sec",src_file,bench_insn_count,t);
+    if (t > 0) fprintf(stderr,", %.0f instructions/sec",(double)bench_insn_count / t);
+    fprintf(stderr,"\n");
+}
+
 int main(int argc,char **argv) {
-    struct exe_ne_header_segment_reloc_table *ne_segment_relocs = NULL;
-    struct exe_ne_header_imported_name_table ne_imported_name_table;
-    struct exe_ne_header_entry_table_table ne_entry_table;
-    struct exe_ne_header_name_entry_table ne_nonresname;
     struct exe_ne_header_resource_table_t ne_resources;
-    struct exe_ne_header_name_entry_table ne_resname;
-    struct exe_ne_header_segment_table ne_segments;
-    struct mod_symbols_list mod_syms;
     struct exe_ne_header ne_header;
     uint32_t ne_header_offset;
+    double bench_t0;
     struct dec_label *label;
     unsigned int segmenti;
     unsigned int reloci;
-    unsigned int labeli;
     uint32_t file_size;
     int c;
 
     assert(sizeof(ne_header) == 0x40);
+    dec_out = stdout;
     memset(&exehdr,0,sizeof(exehdr));
     memset(&mod_syms,0,sizeof(mod_syms));
     exe_ne_header_segment_table_init(&ne_segments);
@@ -740,6 +1407,8 @@ int main(int argc,char **argv) {
     if (parse_argv(argc,argv))
         return 1;
 
+    bench_t0 = dasm_par_seconds();
+
     dec_label_alloc = 4096;
     dec_label_count = 0;
     dec_label = malloc(sizeof(*dec_label) * dec_label_alloc);
@@ -749,6 +1418,12 @@ int main(int argc,char **argv) {
     }
     memset(dec_label,0,sizeof(*dec_label) * dec_label_alloc);
 
+    /* if this fails, dec_find_label() scans the labels like it used to */
+    dec_label_hash_size = 64;
+    while (dec_label_hash_size < (dec_label_alloc * 2))
+        dec_label_hash_size *= 2;
+    dec_label_hash = calloc(dec_label_hash_size,sizeof(*dec_label_hash));
+
     src_fd = open(src_file,O_RDONLY|O_BINARY);
     if (src_fd < 0) {
         fprintf(stderr,"Unable to open %s, %s\n",src_file,strerror(errno));
@@ -1251,7 +1926,7 @@ int main(int argc,char **argv) {
 
             if (ne_segment_relocs[i].length != 0)
                 qsort(ne_segment_relocs[i].table,ne_segment_relocs[i].length,
-                    sizeof(const union exe_ne_header_segment_relocation_entry *),
+                    sizeof(*(ne_segment_relocs[i].table)),
                     ne_segment_relocs_table_qsort);
 
             print_segment_reloc_table(&ne_segment_relocs[i],&ne_imported_name_table,&mod_syms);
@@ -1368,6 +2043,10 @@ int main(int argc,char **argv) {
                 else
                     reloc = NULL;
 
+                /* skip straight to the relocations at the label instead of scanning up from the start of the segment */
+                if (reloc)
+                    reloci = ne_segment_relocs_table_lower_bound(reloc,(uint16_t)label->ofs_v);
+
                 if (segent->flags & EXE_NE_HEADER_SEGMENT_ENTRY_FLAGS_DATA) {
                 }
                 else {
@@ -1382,6 +2061,7 @@ int main(int argc,char **argv) {
                         minx86dec_init_instruction(&dec_i);
                         dec_st.ip_value = ip;
                         minx86dec_decodeall(&dec_st,&dec_i);
+                        bench_insn_count++;
                         assert(dec_i.end >= dec_read);
                         assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
                         inslen = (size_t)(dec_i.end - dec_i.start);
@@ -1520,541 +2200,28 @@ int main(int argc,char **argv) {
     dec_label_sort();
 
     /* second pass: decompilation */
-    for (segmenti=0;segmenti < ne_segments.length;segmenti++) {
-        const struct exe_ne_header_segment_entry *segent = ne_segments.table + segmenti;
-        uint32_t segment_ofs = (uint32_t)segent->offset_in_segments << (uint32_t)ne_segments.sector_shift;
-        struct exe_ne_header_segment_reloc_table *reloc;
-        uint32_t segment_sz;
-
-        if (segent->offset_in_segments == 0)
-            continue;
+    ne_dasm_jobs = calloc(ne_segments.length ? ne_segments.length : 1,sizeof(*ne_dasm_jobs));
+    if (ne_dasm_jobs == NULL) {
+        fprintf(stderr,"Failed to alloc second pass jobs\n");
+        return 1;
+    }
 
-        segment_sz =
-            (segent->length == 0 ? 0x10000UL : segent->length);
-        dec_cs = segmenti + 1;
-        dec_ofs = 0;
+    {
+        struct dasm_par_funcs f;
 
-        if ((uint32_t)lseek(src_fd,segment_ofs,SEEK_SET) != segment_ofs)
+        f.run = ne_dasm_job;
+        f.thread_init = ne_dasm_thread_init;
+        f.thread_free = ne_dasm_thread_free;
+        if (dasm_par_run(ne_dasm_jobs,ne_segments.length,dasm_threads,&f) != 0)
             return 1;
+    }
 
-        printf("* NE segment #%d (0x%lx bytes @0x%lx)\n",
-            segmenti + 1,(unsigned long)segment_sz,(unsigned long)segment_ofs);
-
-        labeli = 0;
-        reloci = 0;
-        entry_ip = 0;
-        reset_buffer();
-        entry_cs = dec_cs;
-        current_offset = segment_ofs;
-        end_decom = segment_ofs + segment_sz;
-        minx86dec_init_state(&dec_st);
-        dec_read = dec_end = dec_buffer;
-        dec_st.data32 = dec_st.addr32 = 0;
-
-        if (ne_segment_relocs)
-            reloc = &ne_segment_relocs[segmenti];
-        else
-            reloc = NULL;
-
-        if (segent->flags & EXE_NE_HEADER_SEGMENT_ENTRY_FLAGS_DATA) {
-            unsigned int col = 0;
-
-            do {
-                uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer() - segment_ofs;
-                uint32_t ip = ofs + entry_ip - dec_ofs;
-
-                while (labeli < dec_label_count) {
-                    label = dec_label + labeli;
-                    if (label->seg_v != dec_cs) {
-                        labeli++;
-                        continue;
-                    }
-                    if (ip < label->ofs_v)
-                        break;
-
-                    labeli++;
-                    ip = label->ofs_v;
-                    dec_cs = label->seg_v;
-                    ofs = segment_ofs + ip;
-
-                    if (col != 0) {
-                        printf("\n");
-                        col = 0;
-                    }
-
-                    printf("Label '%s' at %04lx:%04lx @0x%08lx\n",
-                            label->name ? label->name : "",
-                            (unsigned long)label->seg_v,
-                            (unsigned long)label->ofs_v,
-                            (unsigned long)ofs);
-
-                    label = dec_label + labeli;
-                }
-
-                if (!refill()) break;
-
-                if (reloc) {
-                    while (reloci < reloc->length && reloc->table[reloci].r.seg_offset < ip)
-                        reloci++;
-                }
-
-                /* if any part of the instruction is affected by EXE relocations, say so */
-                if (reloc && reloci < reloc->length) {
-                    const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
-                    const uint32_t o = relocent->r.seg_offset;
-
-                    if (o == ip) {
-                        if (col != 0) {
-                            printf("\n");
-                            col = 0;
-                        }
-                        printf("%04lX:%04lX @0x%08lX ",
-                                (unsigned long)dec_cs,
-                                (unsigned long)ip,
-                                (unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
-
-                        printf(" <--- EXE relocation ");
-
-                        switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
-                                printf("Internal ref");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
-                                printf("Import by ordinal");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
-                                printf("Import by name");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-                                printf("OSFIXUP");
-                                break;
-                        }
-                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)
-                            printf(" (ADDITIVE)");
-                        printf(" ");
-
-                        switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET_LOBYTE:
-                                printf("addr=OFFSET_LOBYTE");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
-                                printf("addr=SEGMENT");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
-                                printf("addr=FAR_POINTER(16:16)");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
-                                printf("addr=OFFSET");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR48_POINTER:
-                                printf("addr=FAR_POINTER(16:32)");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET32:
-                                printf("addr=OFFSET32");
-                                break;
-                            default:
-                                printf("addr=0x%02x",relocent->r.reloc_address_type);
-                                break;
-                        }
-                        printf("\n");
-
-                        switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
-                                if (relocent->intref.segment_index == 0xFF) {
-                                    get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),&ne_nonresname,&ne_resname,relocent->movintref.entry_ordinal);
-
-                                    printf("                    Refers to movable segment, entry ordinal #%d",
-                                            relocent->movintref.entry_ordinal);
-                                    if (name_tmp[0] != 0)
-                                        printf(" '%s'",name_tmp);
-                                    printf("\n");
-                                }
-                                else {
-                                    printf("                    Refers to segment #%d : 0x%04x\n",
-                                            relocent->intref.segment_index,
-                                            relocent->intref.seg_offset);
-                                }
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
-                                ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
-                                printf("                    Refers to module reference #%d '%s', ordinal %d",
-                                        relocent->ordinal.module_reference_index,name_tmp,
-                                        relocent->ordinal.ordinal);
-                                {
-                                    const char *sym = mod_symbols_list_lookup(
-                                        &mod_syms,
-                                        relocent->ordinal.module_reference_index,
-                                        relocent->ordinal.ordinal);
-                                    if (sym != NULL) printf(" '%s'",sym);
-                                }
-                                printf("\n");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
-                                ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
-                                printf("                    Refers to module reference #%d '%s', imp name offset %d",
-                                        relocent->name.module_reference_index,name_tmp,
-                                        relocent->name.imported_name_offset);
-
-                                ne_imported_name_table_entry_get_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->name.imported_name_offset);
-                                printf(" '%s'\n",
-                                        name_tmp);
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-                                printf("                    OSFIXUP type=0x%04x\n",
-                                        relocent->osfixup.fixup);
-                                break;
-                        }
-
-                        col = 0;
-                        printf("                    at +%u bytes (%04x:%04x)\n",
-                                (unsigned int)(o - ip),
-                                (unsigned int)dec_cs,
-                                (unsigned int)dec_st.ip_value + (unsigned int)(o - ip));
-                    }
-                }
-
-                if (col == 0) {
-                    printf("%04lX:%04lX @0x%08lX ",
-                        (unsigned long)dec_cs,
-                        (unsigned long)ip,
-                        (unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
-                }
-
-                while (col < ((unsigned int)(ip & 0xF))) {
-                    printf("   ");
-                    col++;
-                }
-
-                assert(dec_read < dec_end);
-                printf("%02X ",*dec_read++);
-                col++;
-
-                if (col >= 16) {
-                    printf("\n");
-                    col = 0;
-                }
-            } while(1);
-
-            if (col != 0) {
-                printf("\n");
-                col = 0;
-            }
-        }
-        else {
-            do {
-                uint32_t ofs = (uint32_t)(dec_read - dec_buffer) + current_offset_minus_buffer() - segment_ofs;
-                uint32_t ip = ofs + entry_ip - dec_ofs;
-                unsigned char reloc_ann = 0;
-                unsigned char dosek = 0;
-                size_t inslen;
-
-                while (labeli < dec_label_count) {
-                    label = dec_label + labeli;
-                    if (label->seg_v != dec_cs) {
-                        labeli++;
-                        continue;
-                    }
-                    if (ip < label->ofs_v)
-                        break;
-
-                    labeli++;
-                    ip = label->ofs_v;
-                    dec_cs = label->seg_v;
-                    ofs = segment_ofs + ip;
-
-                    printf("Label '%s' at %04lx:%04lx @0x%08lx\n",
-                            label->name ? label->name : "",
-                            (unsigned long)label->seg_v,
-                            (unsigned long)label->ofs_v,
-                            (unsigned long)ofs);
-
-                    label = dec_label + labeli;
-                    dosek = 1;
-                }
-
-                if (dosek) {
-                    reset_buffer();
-                    current_offset = ofs;
-                    if ((uint32_t)lseek(src_fd,current_offset,SEEK_SET) != current_offset)
-                        return 1;
-                }
-
-                if (!refill()) break;
-
-                minx86dec_set_buffer(&dec_st,dec_read,(int)(dec_end - dec_read));
-                minx86dec_init_instruction(&dec_i);
-                dec_st.ip_value = ip;
-                minx86dec_decodeall(&dec_st,&dec_i);
-                assert(dec_i.end >= dec_read);
-                assert(dec_i.end <= (dec_buffer+sizeof(dec_buffer)));
-                inslen = (size_t)(dec_i.end - dec_i.start);
-
-                if (reloc) {
-                    while (reloci < reloc->length && reloc->table[reloci].r.seg_offset < ip)
-                        reloci++;
-                }
-
-                printf("%04lX:%04lX @0x%08lX ",(unsigned long)dec_cs,(unsigned long)dec_st.ip_value,(unsigned long)(dec_read - dec_buffer) + current_offset_minus_buffer());
-                for (c=0,iptr=dec_i.start;iptr != dec_i.end;c++)
-                    printf("%02X ",*iptr++);
-
-                if (dec_i.rep != MX86_REP_NONE) {
-                    for (;c < 6;c++)
-                        printf("   ");
-
-                    switch (dec_i.rep) {
-                        case MX86_REPE:
-                            printf("REP   ");
-                            break;
-                        case MX86_REPNE:
-                            printf("REPNE ");
-                            break;
-                        default:
-                            break;
-                    };
-                }
-                else {
-                    for (;c < 8;c++)
-                        printf("   ");
-                }
-                printf("%-8s ",opcode_string[dec_i.opcode]);
-
-                if (reloc && reloci < reloc->length) {
-                    const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
-                    const uint32_t o = relocent->r.seg_offset;
-
-                    if (o >= ip && o < (ip + inslen)) {
-                        if ((dec_i.opcode == MXOP_JMP_FAR || dec_i.opcode == MXOP_CALL_FAR) && dec_i.argc == 1 &&
-                            dec_i.argv[0].segment == MX86_SEG_IMM && dec_i.argv[0].regtype == MX86_RT_IMM) {
-
-                            switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
-                                    if (o == (ip + 1 + 2)) { // CALL/JMP FAR segment relocation affecting segment portion
-                                        printf("<");
-                                        print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
-                                            printf(" + 0x%04x>:0x%04x",
-                                                (unsigned int)dec_i.argv[0].segval,
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-                                        else {
-                                            printf(">:0x%04x",
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-
-                                        reloc_ann = 1;
-                                    }
-                                    break;
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
-                                    if (o == (ip + 1)) {
-                                        if (!(relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)) {
-                                            printf("<");
-                                            print_relocation_farptr(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                            printf(">");
-                                        }
-
-                                        reloc_ann = 1;
-                                    }
-                                    break;
-                            };
-                        }
-                        if ((dec_i.opcode == MXOP_PUSH) && dec_i.argc == 1 &&
-                            dec_i.argv[0].regtype == MX86_RT_IMM) {
-
-                            switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
-                                    {
-                                        printf("<");
-                                        print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
-                                            printf(" + 0x%04x>",
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-                                        else {
-                                            printf(">");
-                                        }
-                                    }
-                                    break;
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
-                                    {
-                                        printf("<");
-                                        print_relocation_offset(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
-                                            printf(" + 0x%04x>",
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-                                        else {
-                                            printf(">");
-                                        }
-                                    }
-                                    break;
-                            };
-
-                            reloc_ann = 1;
-                        }
-                        if ((dec_i.opcode == MXOP_MOV || dec_i.opcode == MXOP_ADD || dec_i.opcode == MXOP_SUB ||
-                             dec_i.opcode == MXOP_CMP || dec_i.opcode == MXOP_XOR) && dec_i.argc == 2 &&
-                            dec_i.argv[1].regtype == MX86_RT_IMM) {
-
-                            for (c=0;c < 1;) {
-                                minx86dec_regprint(&dec_i.argv[c],arg_c);
-                                printf("%s",arg_c);
-                                if (++c < dec_i.argc) printf(",");
-                            }
-
-                            switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
-                                    {
-                                        printf("<");
-                                        print_relocation_segment(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
-                                            printf(" + 0x%04x>",
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-                                        else {
-                                            printf(">");
-                                        }
-                                    }
-                                    break;
-                                case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
-                                    {
-                                        printf("<");
-                                        print_relocation_offset(&ne_imported_name_table,&ne_entry_table,&ne_nonresname,&ne_resname,relocent,&mod_syms);
-                                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE) {
-                                            printf(" + 0x%04x>",
-                                                (unsigned int)dec_i.argv[0].value);
-                                        }
-                                        else {
-                                            printf(">");
-                                        }
-                                    }
-                                    break;
-                            };
-
-                            reloc_ann = 1;
-                        }
-                    }
-                }
-
-                if (!reloc_ann) {
-                    for (c=0;c < dec_i.argc;) {
-                        minx86dec_regprint(&dec_i.argv[c],arg_c);
-                        printf("%s",arg_c);
-                        if (++c < dec_i.argc) printf(",");
-                    }
-                }
-                if (dec_i.lock) printf("  ; LOCK#");
-                printf("\n");
-
-                /* if any part of the instruction is affected by EXE relocations, say so */
-                if (reloc && reloci < reloc->length) {
-                    const union exe_ne_header_segment_relocation_entry *relocent = reloc->table + reloci;
-                    const uint32_t o = relocent->r.seg_offset;
-
-                    if (o >= ip && o < (ip + inslen)) {
-                        printf("             ^ EXE relocation ");
-
-                        switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
-                                printf("Internal ref");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
-                                printf("Import by ordinal");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
-                                printf("Import by name");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-                                printf("OSFIXUP");
-                                break;
-                        }
-                        if (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_ADDITIVE)
-                            printf(" (ADDITIVE)");
-                        printf(" ");
-
-                        switch (relocent->r.reloc_address_type&EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET_LOBYTE:
-                                printf("addr=OFFSET_LOBYTE");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_SEGMENT:
-                                printf("addr=SEGMENT");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR_POINTER:
-                                printf("addr=FAR_POINTER(16:16)");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET:
-                                printf("addr=OFFSET");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_FAR48_POINTER:
-                                printf("addr=FAR_POINTER(16:32)");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_ADDR_TYPE_OFFSET32:
-                                printf("addr=OFFSET32");
-                                break;
-                            default:
-                                printf("addr=0x%02x",relocent->r.reloc_address_type);
-                                break;
-                        }
-                        printf("\n");
-
-                        switch (relocent->r.reloc_type&EXE_NE_HEADER_SEGMENT_RELOC_TYPE_MASK) {
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_INTERNAL_REFERENCE:
-                                if (relocent->intref.segment_index == 0xFF) {
-                                    get_entry_name_by_ordinal(name_tmp,sizeof(name_tmp),&ne_nonresname,&ne_resname,relocent->movintref.entry_ordinal);
-
-                                    printf("                    Refers to movable segment, entry ordinal #%d",
-                                            relocent->movintref.entry_ordinal);
-                                    if (name_tmp[0] != 0)
-                                        printf(" '%s'",name_tmp);
-                                    printf("\n");
-                                }
-                                else {
-                                    printf("                    Refers to segment #%d : 0x%04x\n",
-                                            relocent->intref.segment_index,
-                                            relocent->intref.seg_offset);
-                                }
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_ORDINAL:
-                                ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
-                                printf("                    Refers to module reference #%d '%s', ordinal %d",
-                                        relocent->ordinal.module_reference_index,name_tmp,
-                                        relocent->ordinal.ordinal);
-                                {
-                                    const char *sym = mod_symbols_list_lookup(
-                                        &mod_syms,
-                                        relocent->ordinal.module_reference_index,
-                                        relocent->ordinal.ordinal);
-                                    if (sym != NULL) printf(" '%s'",sym);
-                                }
-                                printf("\n");
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_IMPORTED_NAME:
-                                ne_imported_name_table_entry_get_module_ref_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->ordinal.module_reference_index);
-                                printf("                    Refers to module reference #%d '%s', imp name offset %d",
-                                        relocent->name.module_reference_index,name_tmp,
-                                        relocent->name.imported_name_offset);
-
-                                ne_imported_name_table_entry_get_name(name_tmp,sizeof(name_tmp),&ne_imported_name_table,relocent->name.imported_name_offset);
-                                printf(" '%s'\n",
-                                        name_tmp);
-                                break;
-                            case EXE_NE_HEADER_SEGMENT_RELOC_TYPE_OSFIXUP:
-                                printf("                    OSFIXUP type=0x%04x\n",
-                                        relocent->osfixup.fixup);
-                                break;
-                        }
-
-                        printf("                    at +%u bytes (%04x:%04x)\n",
-                                (unsigned int)(o - ip),
-                                (unsigned int)dec_cs,
-                                (unsigned int)dec_st.ip_value + (unsigned int)(o - ip));
-                    }
-                }
+    bench_insn_count = 0;
+    for (segmenti=0;segmenti < ne_segments.length;segmenti++)
+        bench_insn_count += ne_dasm_jobs[segmenti].insn_count;
 
-                dec_read = dec_i.end;
-            } while(1);
-        }
-    }
+    free(ne_dasm_jobs);
+    ne_dasm_jobs = NULL;
 
     if (ne_segment_relocs) {
         unsigned int i;
@@ -2072,6 +2239,9 @@ int main(int argc,char **argv) {
     exe_ne_header_name_entry_table_free(&ne_resname);
     exe_ne_header_resource_table_free(&ne_resources);
     exe_ne_header_segment_table_free(&ne_segments);
+    if (bench_mode)
+        bench_report(bench_t0);
+
     dec_free_labels();
     close(src_fd);
 	return 0;
@@ -0,0 +1,37 @@
+#!/bin/bash
+#
+# Time the symbol lookup: link a symbol-heavy synthetic input (100 modules x 500
+# publics, 500 EXTDEF fixups each, so 50k symbols and 50k fixups) with lnkdos16 and
+# with lnkdos16-linear, which is the same linker built with -DLINK_SYMBOL_LINEAR to
+# look symbols up with the old linear scan instead of the hashed symbol table.
+# Both must write the same EXE. Linux host build (make bench) first.
+
+LNKDOS16=linux-host/lnkdos16
+LNKDOS16_LINEAR=linux-host/lnkdos16-linear
+OMFSYN=linux-host/omfsyn
+TMP=linux-host/bench
+
+MODULES=100
+SYMS=500
+EXTS=500
+
+rm -Rf $TMP
+mkdir -p $TMP || exit 1
+
+$OMFSYN -o $TMP/s -m $MODULES -s $SYMS -e $EXTS || exit 1
+
+objs=""
+for ((i=0;i < MODULES;i++)); do
+    objs="$objs -i $TMP/s`printf %05u $i`.obj"
+done
+
+echo "$MODULES modules, $((MODULES * SYMS)) symbols, $((MODULES * EXTS)) fixups"
+
+echo "hashed symbol table:"
+time $LNKDOS16 $objs -of exe -o $TMP/hash.exe >/dev/null 2>&1 || { echo "FAIL: link"; exit 1; }
+
+echo "linear lookup:"
+time $LNKDOS16_LINEAR $objs -of exe -o $TMP/linear.exe >/dev/null 2>&1 || { echo "FAIL: link (linear)"; exit 1; }
+
+if ! cmp -s $TMP/hash.exe $TMP/linear.exe; then echo "FAIL: EXE differs between the two lookups"; exit 1; fi
+exit 0
@@ -0,0 +1,93 @@
+#!/bin/bash
+#
+# Check incremental linking (-inc) against a full link of the same inputs:
+#   - changing only the LEDATA of one object patches the output, and the EXE
+#     and map are identical to a full link
+#   - an object whose segment grows, on the same command line, changes the layout
+#     and falls back to a full link
+#   - swapping two objects changes the layout and falls back to a full link
+#   - a re-run with nothing changed exits without writing anything
+# Linux host build (make) first.
+
+LNKDOS16=linux-host/lnkdos16
+OMFSYN=linux-host/omfsyn
+TMP=linux-host/inctest
+
+MODULES=100
+
+rm -Rf $TMP
+mkdir -p $TMP/w || exit 1
+
+# a = the objects, b = the same objects with different LEDATA bytes,
+# c = the same publics with one more external reference (a longer segment)
+$OMFSYN -o $TMP/a -m $MODULES -s 50 -e 50 || exit 1
+$OMFSYN -o $TMP/b -m $MODULES -s 50 -e 50 -d 1 || exit 1
+$OMFSYN -o $TMP/c -m $MODULES -s 50 -e 51 || exit 1
+cp $TMP/a*.obj $TMP/w/ || exit 1
+
+objs=""
+for ((i=0;i < MODULES;i++)); do
+    objs="$objs -i $TMP/w/a`printf %05u $i`.obj"
+done
+
+fail=0
+
+# link incrementally into inc.exe, and fully into full.exe. Both must be the same
+inc_link() {
+    $LNKDOS16 -v -inc $TMP/inc.state $1 -of exe -o $TMP/inc.exe -map $TMP/inc.map >/dev/null 2>$TMP/inc.log || { echo "FAIL: incremental link"; exit 1; }
+}
+
+full_link() {
+    $LNKDOS16 $1 -of exe -o $TMP/full.exe -map $TMP/full.map >/dev/null 2>&1 || { echo "FAIL: full link"; exit 1; }
+}
+
+same_as_full() {
+    if ! cmp -s $TMP/inc.exe $TMP/full.exe; then echo "FAIL: $1, EXE differs from a full link"; fail=1; fi
+    if ! cmp -s $TMP/inc.map $TMP/full.map; then echo "FAIL: $1, map differs from a full link"; fail=1; fi
+}
+
+inc_link "$objs"
+grep -q "Incremental link: full link" $TMP/inc.log || { echo "FAIL: first link was not a full link"; fail=1; }
+full_link "$objs"
+same_as_full "first link"
+cp $TMP/inc.exe $TMP/first.exe || exit 1
+
+# LEDATA-only change: layout unchanged, only the changed module is fixed up and rewritten
+cp $TMP/b00042.obj $TMP/w/a00042.obj || exit 1
+inc_link "$objs"
+grep -q "Incremental link: layout unchanged" $TMP/inc.log || { echo "FAIL: LEDATA-only change did not take the incremental path"; fail=1; }
+full_link "$objs"
+same_as_full "LEDATA-only change"
+cmp -s $TMP/inc.exe $TMP/first.exe && { echo "FAIL: LEDATA-only change did not change the EXE"; fail=1; }
+echo "ok: LEDATA-only change"
+
+# nothing changed: must not write the output, map or link state again
+touch -d '2000-01-01' $TMP/inc.exe $TMP/inc.map $TMP/inc.state || exit 1
+inc_link "$objs"
+grep -q "is up to date" $TMP/inc.log || { echo "FAIL: re-run with no changes did not stop early"; fail=1; }
+if [ -n "`find $TMP/inc.exe $TMP/inc.map $TMP/inc.state -newer $TMP/w/a00000.obj`" ]; then
+    echo "FAIL: re-run with no changes rewrote its output"; fail=1
+fi
+echo "ok: no change"
+
+# segment layout change, same command line: full link, same as a clean link
+cp $TMP/c00057.obj $TMP/w/a00057.obj || exit 1
+inc_link "$objs"
+grep -q "Incremental link: full link" $TMP/inc.log || { echo "FAIL: segment layout change did not fall back to a full link"; fail=1; }
+rm -f $TMP/full.exe $TMP/full.map
+full_link "$objs"
+same_as_full "segment layout change"
+cmp -s $TMP/inc.exe $TMP/first.exe && { echo "FAIL: segment layout change did not change the EXE"; fail=1; }
+echo "ok: segment layout change"
+
+# two objects swapped: different layout, full link
+swapped=`echo "$objs" | sed -e 's/a00010\.obj/SWAP/' -e 's/a00011\.obj/a00010.obj/' -e 's/SWAP/a00011.obj/'`
+inc_link "$swapped"
+grep -q "Incremental link: full link" $TMP/inc.log || { echo "FAIL: swapped objects did not fall back to a full link"; fail=1; }
+full_link "$swapped"
+same_as_full "swapped objects"
+echo "ok: swapped objects"
+
+if [ $fail -ne 0 ]; then echo "FAILED"; exit 1; fi
+echo "PASS"
+exit 0
@@ -0,0 +1,181 @@
+#!/usr/bin/python3
+#
+# Write an OMF .LIB the way Microsoft LIB lays it out, to test the linker against a
+# library that was not written by omfsyn:
+#
+#   - page size 16, the LIBHEAD record is one page long
+#   - LIBHEAD flags 0 (not case sensitive) unless -cs is given
+#   - a "MODULE!" dictionary entry for each module, besides its public symbols
+#   - a prime number of dictionary blocks
+#   - LIBHEAD and LIBEND with a zero (not checked) checksum
+#
+# -upper writes the dictionary names in upper case, like librarians that fold case do,
+# while the modules themselves keep their mixed case names.
+#
+# No Microsoft or Watcom librarian was available to write these, see libtest.sh.
+#
+# usage: mslib.py [-cs] [-upper] -o out.lib in.obj ...
+import struct
+import sys
+
+out_lib = None
+case_sensitive = False
+upper = False
+in_obj = [ ]
+
+it = iter(sys.argv)
+next(it) # skip argv[0]
+
+try:
+    while True:
+        x = next(it)
+        if x == "-o":
+            out_lib = str(next(it))
+        elif x == "-cs":
+            case_sensitive = True
+        elif x == "-upper":
+            upper = True
+        elif x[0] == "-":
+            raise Exception("Unknown param")
+        else:
+            in_obj.append(str(x))
+except StopIteration:
+    True
+
+if out_lib == None or len(in_obj) == 0:
+    raise Exception("usage: mslib.py [-cs] [-upper] -o out.lib in.obj ...")
+
+PAGE_SIZE = 16
+BLOCK_SIZE = 512
+BUCKETS = 37
+
+def omf_index(d,i):
+    if d[i] & 0x80:
+        return (((d[i] & 0x7F) << 8) + d[i+1],i+2)
+    return (d[i],i+1)
+
+# module name from THEADR without the extension, and the names from PUBDEF
+def obj_names(data):
+    modname = None
+    publics = [ ]
+    i = 0
+    while i < len(data):
+        rectype = data[i]
+        reclen = struct.unpack("<H",data[i+1:i+3])[0]
+        d = data[i+3:i+3+reclen-1]
+        i += 3 + reclen
+        if rectype == 0x80:
+            modname = d[1:1+d[0]].decode("ascii").split(".")[0]
+        elif rectype == 0x90 or rectype == 0x91:
+            j = omf_index(d,0)[1]
+            seg,j = omf_index(d,j)
+            if seg == 0:
+                j += 2
+            while j < len(d):
+                n = d[j]
+                publics.append(d[j+1:j+1+n].decode("ascii"))
+                j += 1 + n + (4 if rectype == 0x91 else 2)
+                j = omf_index(d,j)[1]
+    return (modname,publics)
+
+def rol(v):
+    return ((v << 2) | (v >> 14)) & 0xFFFF
+
+def ror(v):
+    return ((v >> 2) | (v << 14)) & 0xFFFF
+
+# dictionary hash, from the OMF specification
+def dict_hash(name,blocks):
+    n = len(name)
+    block_x = n | 0x20
+    bucket_d = n | 0x20
+    block_d = 0
+    bucket_x = 0
+    front = 0
+    back = n
+    count = n
+    while True:
+        back -= 1
+        c = name[back] | 0x20
+        bucket_x = ror(bucket_x) ^ c
+        block_d = rol(block_d) ^ c
+        count -= 1
+        if count == 0:
+            break
+        c = name[front] | 0x20
+        front += 1
+        block_x = rol(block_x) ^ c
+        bucket_d = ror(bucket_d) ^ c
+    block_d %= blocks
+    bucket_d %= BUCKETS
+    return (block_x % blocks,block_d if block_d != 0 else 1,bucket_x % BUCKETS,bucket_d if bucket_d != 0 else 1)
+
+def dict_add(dic,blocks,name,page):
+    block,block_d,bucket,bucket_d = dict_hash(name,blocks)
+    for b in range(blocks):
+        blk = dic[block]
+        free = blk[BUCKETS] * 2
+        if free == 0:
+            free = BUCKETS + 1
+        if blk[BUCKETS] != 0xFF and free + 1 + len(name) + 2 <= BLOCK_SIZE:
+            k = bucket
+            for t in range(BUCKETS):
+                if blk[k] == 0:
+                    blk[k] = free // 2
+                    blk[free] = len(name)
+                    blk[free+1:free+1+len(name)] = name
+                    blk[free+1+len(name):free+3+len(name)] = struct.pack("<H",page)
+                    free = (free + 1 + len(name) + 2 + 1) & ~1
+                    blk[BUCKETS] = 0xFF if free >= BLOCK_SIZE - 2 else free // 2
+                    return True
+                k = (k + bucket_d) % BUCKETS
+            blk[BUCKETS] = 0xFF
+        block = (block + block_d) % blocks
+    return False
+
+def is_prime(n):
+    return n >= 2 and all(n % d for d in range(2,int(n ** 0.5) + 1))
+
+def record(rectype,d):
+    return struct.pack("<BH",rectype,len(d) + 1) + d + b"\x00"
+
+def pad(out):
+    out += b"\x00" * ((PAGE_SIZE - (len(out) % PAGE_SIZE)) % PAGE_SIZE)
+
+out = bytearray(record(0xF0,b"\x00" * (PAGE_SIZE - 4)))
+names = [ ]
+for path in in_obj:
+    data = open(path,"rb").read()
+    pad(out)
+    page = len(out) // PAGE_SIZE
+    modname,publics = obj_names(data)
+    names.append((modname + "!",page))
+    for p in publics:
+        names.append((p,page))
+    out += data
+
+# LIBEND, padded so that the dictionary starts on a block boundary
+pad(out)
+dict_ofs = (len(out) + 4 + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1)
+out += record(0xF1,b"\x00" * (dict_ofs - len(out) - 4))
+
+blocks = 2
+while True:
+    if is_prime(blocks):
+        dic = [ bytearray(BLOCK_SIZE) for b in range(blocks) ]
+        ok = True
+        for name,page in names:
+            if upper:
+                name = name.upper()
+            if not dict_add(dic,blocks,name.encode("ascii"),page):
+                ok = False
+                break
+        if ok:
+            break
+    blocks += 1
+
+for blk in dic:
+    out += blk
+
+out[0:3+4+2+1] = struct.pack("<BHIHB",0xF0,PAGE_SIZE - 3,dict_ofs,blocks,1 if case_sensitive else 0)
+open(out_lib,"wb").write(out)
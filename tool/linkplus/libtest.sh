@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Link one object against a large synthetic .LIB of independent module groups,
+# once with dictionary-driven loading and once with -libfull, and check that only
+# the modules of the needed group were loaded. Linux host build (make) first.
+
+LNKDOS16=linux-host/lnkdos16
+OMFSYN=linux-host/omfsyn
+TMP=linux-host/libtest
+
+MODULES=800
+MODGROUPS=16
+
+rm -Rf $TMP
+mkdir -p $TMP || exit 1
+
+$OMFSYN -o $TMP/s -m $MODULES -s 50 -e 50 -g $MODGROUPS -l $TMP/syn.lib || exit 1
+
+$LNKDOS16 -i $TMP/s00000.obj -i $TMP/syn.lib -of exe -o $TMP/sel.exe -map $TMP/sel.map || exit 1
+$LNKDOS16 -libfull -i $TMP/s00000.obj -i $TMP/syn.lib -of exe -o $TMP/full.exe -map $TMP/full.map || exit 1
+
+sel=`grep -E "^  [0-9]+ from '$TMP/syn.lib'$" $TMP/sel.map | awk '{ print $1 }'`
+full=`grep -E "^  [0-9]+ from '$TMP/syn.lib'$" $TMP/full.map | awk '{ print $1 }'`
+
+# module 0 is the object file, the rest of its group is in the library
+want=$(( (MODULES / MODGROUPS) - 1 ))
+
+echo "Library modules loaded: $sel of $full (full scan), expected $want"
+
+if [ x"$full" != x"$(( MODULES - 1 ))" ]; then
+    echo "FAIL: full scan did not load every library module"
+    exit 1
+fi
+if [ x"$sel" != x"$want" ]; then
+    echo "FAIL: dictionary loading did not load exactly the needed modules"
+    exit 1
+fi
+
+# Libraries laid out like Microsoft LIB writes them (libfix/mslib.py): page size 16, not case
+# sensitive, module name entries in the dictionary. Modules 1-5 of "omfsyn -m 6 -s 10 -e 10 -g 2",
+# module 0 needs 2 and 4. mslup.lib has the dictionary names in upper case, which only a case
+# insensitive lookup finds. mslupcs.lib is the same with the case sensitive flag set, it must not.
+$OMFSYN -o $TMP/f -m 6 -s 10 -e 10 -g 2 || exit 1
+$LNKDOS16 -i $TMP/f00000.obj -i $TMP/f00002.obj -i $TMP/f00004.obj -of exe -o $TMP/fobj.exe >/dev/null 2>&1 || exit 1
+
+for lib in msl mslup; do
+    $LNKDOS16 -i $TMP/f00000.obj -i libfix/$lib.lib -of exe -o $TMP/$lib.exe -map $TMP/$lib.map >/dev/null 2>&1 || { echo "FAIL: link with libfix/$lib.lib"; exit 1; }
+    n=`grep -E "^  [0-9]+ from 'libfix/$lib.lib'$" $TMP/$lib.map | awk '{ print $1 }'`
+    if [ x"$n" != x"2" ]; then
+        echo "FAIL: libfix/$lib.lib, $n modules loaded, expected 2"
+        exit 1
+    fi
+    if ! cmp -s $TMP/fobj.exe $TMP/$lib.exe; then
+        echo "FAIL: libfix/$lib.lib, EXE differs from linking the objects"
+        exit 1
+    fi
+    echo "libfix/$lib.lib: ok"
+done
+
+if $LNKDOS16 -i $TMP/f00000.obj -i libfix/mslupcs.lib -of exe -o $TMP/mslupcs.exe >/dev/null 2>&1; then
+    echo "FAIL: libfix/mslupcs.lib, case sensitive dictionary matched names of another case"
+    exit 1
+fi
+echo "libfix/mslupcs.lib: ok"
+
+echo "PASS"
+exit 0
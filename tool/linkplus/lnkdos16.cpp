@@ -20,7 +20,14 @@ extern "C" {
 using namespace std;
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <string>
 
@@ -53,6 +60,128 @@ enum {
 
 //================================== PROGRAM ================================
 
+/* Arena for link objects (segments, fragments, symbols, relocations) and fragment images.
+ *
+ * These are created by the thousand while reading input files and all of them live until
+ * the linker exits, so nothing is ever given back: an allocation is a pointer bump within
+ * a large block instead of a malloc/free pair per object. shared_ptr objects come from
+ * allocate_shared() with link_arena_allocator, which puts the object and its reference
+ * count in one arena allocation. Input files are read in parallel, so each thread bumps
+ * its own block. Blocks are released when the process exits. */
+static const size_t                     link_arena_block_size = 1024u * 1024u;
+
+struct link_arena_stats_t {
+    atomic<size_t>                      allocs;         /* allocations made from the arena */
+    atomic<size_t>                      bytes;          /* bytes handed out */
+    atomic<size_t>                      blocks;         /* blocks malloc()'d */
+
+    link_arena_stats_t() : allocs(0), bytes(0), blocks(0) { }
+};
+
+static link_arena_stats_t               link_arena_stats;
+static mutex                            link_arena_lock;
+static vector<unsigned char*>           link_arena_blocks;  /* every block, kept reachable */
+
+static thread_local unsigned char*      link_arena_ptr = NULL;
+static thread_local size_t              link_arena_left = 0;
+
+static unsigned char *link_arena_new_block(const size_t sz) {
+    unsigned char *b = (unsigned char*)malloc(sz);
+
+    if (b == NULL)
+        throw bad_alloc();
+
+    {
+        lock_guard<mutex> lock(link_arena_lock);
+        link_arena_blocks.push_back(b);
+    }
+
+    link_arena_stats.blocks++;
+    return b;
+}
+
+void *link_arena_alloc(const size_t sz,const size_t align) {
+    size_t pad = (align - ((uintptr_t)link_arena_ptr & (align - 1u))) & (align - 1u);
+    unsigned char *r;
+
+    link_arena_stats.allocs++;
+    link_arena_stats.bytes += sz;
+
+    if (link_arena_ptr == NULL || (pad + sz) > link_arena_left) {
+        /* large images get a block of their own, and the current block stays in use */
+        if ((sz + align) > (link_arena_block_size / 4u)) {
+            r = link_arena_new_block(sz + align);
+            return r + ((align - ((uintptr_t)r & (align - 1u))) & (align - 1u));
+        }
+
+        link_arena_ptr = link_arena_new_block(link_arena_block_size);
+        link_arena_left = link_arena_block_size;
+        pad = (align - ((uintptr_t)link_arena_ptr & (align - 1u))) & (align - 1u);
+    }
+
+    r = link_arena_ptr + pad;
+    link_arena_ptr += pad + sz;
+    link_arena_left -= pad + sz;
+    return r;
+}
+
+template <class T> struct link_arena_allocator {
+    typedef T                           value_type;
+
+    link_arena_allocator() { }
+    template <class U> link_arena_allocator(const link_arena_allocator<U> &) { }
+
+    T *allocate(const size_t n) {
+        return (T*)link_arena_alloc(n * sizeof(T),alignof(T));
+    }
+    void deallocate(T *,size_t) {
+        /* never given back */
+    }
+
+    template <class U> bool operator==(const link_arena_allocator<U> &) const { return true; }
+    template <class U> bool operator!=(const link_arena_allocator<U> &) const { return false; }
+};
+
+template <class T> shared_ptr<T> link_arena_new(void) {
+    return allocate_shared<T>(link_arena_allocator<T>());
+}
+
+/* in memory image of a fragment, in the arena. images are sized once the SEGDEF is known
+ * and are zero filled like vector::resize(). a module's images end up next to each other
+ * in the arena, in the order the module defines its segments. */
+struct fragment_image {
+    unsigned char*                      base = NULL;
+    size_t                              length = 0;
+    size_t                              alloc = 0;
+
+    size_t size(void) const {
+        return length;
+    }
+    bool empty(void) const {
+        return length == 0;
+    }
+    unsigned char &operator[](const size_t i) {
+        return base[i];
+    }
+    const unsigned char &operator[](const size_t i) const {
+        return base[i];
+    }
+    void resize(const size_t n) {
+        if (n > alloc) {
+            unsigned char *p = (unsigned char*)link_arena_alloc(n,16);
+
+            if (length != 0) memcpy(p,base,length);
+            base = p;
+            alloc = n;
+        }
+        if (n > length)
+            memset(base+length,0,n-length);
+
+        length = n;
+    }
+};
+
+
 /* <file ref> <module index ref>
  *
  * for .obj files, file ref is an index and module index ref is zero.
@@ -109,6 +238,189 @@ struct entrypoint {
     }
 };
 
+struct input_module;
+
+typedef shared_ptr<input_module>        in_fileModuleRef;
+
+static const in_fileModuleRef           in_fileModuleRefUndef = nullptr;
+
+typedef shared_ptr<input_file>          in_fileRef;             /* ref file */
+
+static const in_fileRef                 in_fileRefUndef = nullptr;
+
+struct link_symbol {
+    string                              name;               /* symbol name, raw */
+    shared_ptr<struct link_segdef>      segref;             /* belongs to segdef */
+    string                              groupdef;           /* belongs to groupdef (not used except for display) */
+    segmentOffset                       offset;             /* offset within fragment */
+    fragmentRef                         fragment;           /* which fragment it belongs to */
+    in_fileRef                          in_file;            /* from which file */
+    in_fileModuleRef                    in_module;          /* from which module */
+    unsigned int                        is_local:1;         /* is local symbol */
+
+    link_symbol() : offset(0), fragment(fragmentRefUndef), in_file(in_fileRefUndef), in_module(in_fileModuleRefUndef), is_local(0) { }
+};
+
+/* Symbol table with a hashed name index.
+ *
+ * The index has a global scope (name) and a local scope (file, module, name) so that
+ * symbol lookups during PUBDEF processing and FIXUPP resolution take constant time
+ * instead of walking every symbol. Callers fill in the symbol fields after add(), so
+ * new symbols are indexed lazily on the next lookup once in_file/in_module/is_local
+ * are known. When more than one symbol matches, the one added first wins, which is
+ * what the linear scan this replaces did.
+ *
+ * Building with -DLINK_SYMBOL_LINEAR makes find() use that linear scan again, so that
+ * "make bench" can time one against the other. */
+struct link_symbol_table {
+    vector< shared_ptr<struct link_symbol> >        symbols;    /* all symbols. may be sorted for the map file */
+
+    shared_ptr<struct link_symbol> add(const shared_ptr<struct link_symbol> &sym) {
+        symbols.push_back(sym);
+        pending.push_back(sym);
+        return sym;
+    }
+
+    shared_ptr<struct link_symbol> find(const char *name,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
+#if defined(LINK_SYMBOL_LINEAR)
+        for (size_t i=0;i < symbols.size();i++) {
+            const shared_ptr<struct link_symbol> &sym = symbols[i];
+
+            if (sym->is_local) {
+                /* ignore local symbols unless file/module scope is given */
+                if (in_file != in_fileRefUndef && sym->in_file != in_file)
+                    continue;
+                if (in_module != in_fileModuleRefUndef && sym->in_module != in_module)
+                    continue;
+            }
+
+            if (sym->name == name)
+                return sym;
+        }
+
+        return NULL;
+#else
+        const entry *best = NULL;
+        const string n(name);
+
+        index_pending();
+
+        {
+            auto gi = global_index.find(n);
+            if (gi != global_index.end() && !gi->second.empty())
+                best = &gi->second.front();
+        }
+
+        if (in_file != in_fileRefUndef && in_module != in_fileModuleRefUndef) {
+            auto li = scoped_index.find(scope_key(in_file.get(),in_module.get(),n));
+            if (li != scoped_index.end() && !li->second.empty()) {
+                if (best == NULL || li->second.front().serial < best->serial)
+                    best = &li->second.front();
+            }
+        }
+        else {
+            /* partial or no scope: any local symbol matching the scope given */
+            auto li = local_index.find(n);
+            if (li != local_index.end()) {
+                for (auto ei=li->second.begin();ei!=li->second.end();ei++) {
+                    const struct link_symbol *sym = ei->sym.get();
+
+                    if (best != NULL && ei->serial > best->serial)
+                        break;
+                    if (in_file != in_fileRefUndef && sym->in_file != in_file)
+                        continue;
+                    if (in_module != in_fileModuleRefUndef && sym->in_module != in_module)
+                        continue;
+
+                    best = &(*ei);
+                    break;
+                }
+            }
+        }
+
+        if (best != NULL)
+            return best->sym;
+
+        return NULL;
+#endif
+    }
+
+    void clear(void) {
+        symbols.clear();
+        pending.clear();
+        global_index.clear();
+        local_index.clear();
+        scoped_index.clear();
+        next_serial = 0;
+    }
+
+    size_t size(void) const {
+        return symbols.size();
+    }
+private:
+    struct entry {
+        size_t                                      serial;     /* order added to the table */
+        shared_ptr<struct link_symbol>              sym;
+    };
+
+    struct scope_key {
+        const struct input_file*                    in_file;
+        const struct input_module*                  in_module;
+        string                                      name;
+
+        scope_key(const struct input_file *f,const struct input_module *m,const string &n) : in_file(f), in_module(m), name(n) { }
+
+        bool operator==(const scope_key &o) const {
+            return in_file == o.in_file && in_module == o.in_module && name == o.name;
+        }
+    };
+
+    struct scope_key_hash {
+        size_t operator()(const scope_key &k) const {
+            size_t h = hash<string>()(k.name);
+            h ^= hash<const void*>()(k.in_file) + 0x9E3779B9u + (h << 6u) + (h >> 2u);
+            h ^= hash<const void*>()(k.in_module) + 0x9E3779B9u + (h << 6u) + (h >> 2u);
+            return h;
+        }
+    };
+
+    void index_pending(void) {
+        for (auto pi=pending.begin();pi!=pending.end();pi++) {
+            entry ent;
+
+            ent.serial = next_serial++;
+            ent.sym = *pi;
+
+            if (ent.sym->is_local) {
+                local_index[ent.sym->name].push_back(ent);
+                scoped_index[scope_key(ent.sym->in_file.get(),ent.sym->in_module.get(),ent.sym->name)].push_back(ent);
+            }
+            else {
+                global_index[ent.sym->name].push_back(ent);
+            }
+        }
+
+        pending.clear();
+    }
+
+    vector< shared_ptr<struct link_symbol> >        pending;    /* added, but not yet indexed */
+    unordered_map< string, vector<entry> >          global_index;
+    unordered_map< string, vector<entry> >          local_index;
+    unordered_map< scope_key, vector<entry>, scope_key_hash > scoped_index;
+    size_t                                          next_serial = 0;
+};
+
+shared_ptr<struct link_symbol> new_link_symbol(link_symbol_table &link_symbols,const char *name) {
+    shared_ptr<struct link_symbol> sym = link_arena_new<struct link_symbol>();
+    link_symbols.add( sym );
+    sym->name = name;
+    return sym;
+}
+
+shared_ptr<struct link_symbol> find_link_symbol(link_symbol_table &link_symbols,const char *name,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
+    return link_symbols.find(name,in_file,in_module);
+}
+
 struct input_module {
     size_t                              index = ~((size_t)(0u));
     string                              name;
@@ -117,7 +429,7 @@ struct input_module {
     struct omf_context_t*               omf_state = NULL;
 
     vector< shared_ptr<struct link_segdef> > link_segments;
-    vector< shared_ptr<struct link_symbol> > link_symbols;
+    link_symbol_table                   link_symbols;
     entrypoint                          entry_point;
 
     ~input_module() {
@@ -128,14 +440,12 @@ struct input_module {
     }
 };
 
-typedef shared_ptr<input_module>        in_fileModuleRef;
-
-static const in_fileModuleRef           in_fileModuleRefUndef = nullptr;
-
 struct input_file {
     string                              path;
     vector< shared_ptr<input_module> >  modules;
     int                                 segment_group;
+    bool                                is_library;
+    bool                                changed;        /* contents differ from the incremental link state (-inc) */
 
     enum special_t {
         SPEC_NONE=0,
@@ -145,13 +455,9 @@ struct input_file {
 
     enum special_t                      special;
 
-    input_file() : segment_group(-1), special(SPEC_NONE) { }
+    input_file() : segment_group(-1), is_library(false), changed(true), special(SPEC_NONE) { }
 };
 
-typedef shared_ptr<input_file>          in_fileRef;             /* ref file */
-
-static const in_fileRef                 in_fileRefUndef = nullptr;
-
 shared_ptr<input_file>                  in_fileRefPadding;
 shared_ptr<input_file>                  in_fileRefInternal;
 
@@ -164,12 +470,15 @@ struct cmdoptions {
     unsigned int                        verbose:1;
     unsigned int                        prefer_flat:1;
     unsigned int                        def_segsym:1;
+    unsigned int                        lib_full_scan:1;
 
     unsigned int                        output_format;
     unsigned int                        output_format_variant;
 
     int                                 next_segment_group;
 
+    unsigned int                        jobs;           /* threads for reading input files */
+
     segmentSize                         want_stack_size;
 
     segmentBase                         image_base_segment_reloc_adjust;/* segment value to add to relocation entries in order to work with relocation fixup code (COMREL) */
@@ -180,12 +489,13 @@ struct cmdoptions {
     string                              hex_output;
     string                              out_file;
     string                              map_file;
+    string                              inc_file;       /* incremental link state file */
 
     vector< shared_ptr<input_file> >    in_file;
     vector<segment_group>               segment_groups;
 
-    cmdoptions() : do_dosseg(true), verbose(false), prefer_flat(false), def_segsym(false), output_format(OFMT_COM),
-                   output_format_variant(OFMTVAR_NONE), next_segment_group(-1), want_stack_size(4096),
+    cmdoptions() : do_dosseg(true), verbose(false), prefer_flat(false), def_segsym(false), lib_full_scan(false), output_format(OFMT_COM),
+                   output_format_variant(OFMTVAR_NONE), next_segment_group(-1), jobs(0), want_stack_size(4096),
                    image_base_segment_reloc_adjust(segmentBaseUndef), image_base_segment(segmentBaseUndef),
                    image_base_offset(segmentOffsetUndef), dosdrv_header_symbol("_dosdrv_header") { }
 
@@ -205,7 +515,8 @@ struct cmdoptions {
 
 static cmdoptions                       cmdoptions;
 
-static int                              current_segment_group = -1;
+/* segment group of the file being read. per thread, input files are read in parallel */
+static thread_local int                 current_segment_group = -1;
 
 const char *get_in_file(const in_fileRef idx) {
     if (idx != in_fileRefUndef) {
@@ -289,7 +600,7 @@ struct exe_relocation {
 };
 
 shared_ptr<struct exe_relocation> new_exe_relocation(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table) {
-    shared_ptr<struct exe_relocation> r(new struct exe_relocation);
+    shared_ptr<struct exe_relocation> r = link_arena_new<struct exe_relocation>();
     exe_relocation_table.push_back(r);
     return r;
 }
@@ -298,45 +609,6 @@ void free_exe_relocations(vector< shared_ptr<struct exe_relocation> > &exe_reloc
     exe_relocation_table.clear();
 }
 
-struct link_symbol {
-    string                              name;               /* symbol name, raw */
-    shared_ptr<struct link_segdef>      segref;             /* belongs to segdef */
-    string                              groupdef;           /* belongs to groupdef (not used except for display) */
-    segmentOffset                       offset;             /* offset within fragment */
-    fragmentRef                         fragment;           /* which fragment it belongs to */
-    in_fileRef                          in_file;            /* from which file */
-    in_fileModuleRef                    in_module;          /* from which module */
-    unsigned int                        is_local:1;         /* is local symbol */
-
-    link_symbol() : offset(0), fragment(fragmentRefUndef), in_file(in_fileRefUndef), in_module(in_fileModuleRefUndef), is_local(0) { }
-};
-
-shared_ptr<struct link_symbol> new_link_symbol(vector< shared_ptr<struct link_symbol> > &link_symbols,const char *name) {
-    shared_ptr<struct link_symbol> sym(new struct link_symbol);
-    link_symbols.push_back( sym );
-    sym->name = name;
-    return sym;
-}
-
-shared_ptr<struct link_symbol> find_link_symbol(vector< shared_ptr<struct link_symbol> > &link_symbols,const char *name,const in_fileRef in_file,const in_fileModuleRef in_module) {
-    for (size_t i=0;i < link_symbols.size();i++) {
-        shared_ptr<struct link_symbol> sym = link_symbols[i];
-
-        if (sym->is_local) {
-            /* ignore local symbols unless file/module scope is given */
-            if (in_file != in_fileRefUndef && sym->in_file != in_file)
-                continue;
-            if (in_module != in_fileModuleRefUndef && sym->in_module != in_module)
-                continue;
-        }
-
-        if (sym->name == name)
-            return link_symbols[i];
-    }
-
-    return NULL;
-}
-
 struct seg_fragment {
     in_fileRef                          in_file;            /* fragment comes from file */
     in_fileModuleRef                    in_module;          /* fragment comes from this module index */
@@ -347,7 +619,7 @@ struct seg_fragment {
     struct omf_segdef_attr_t            attr;               /* fragment attributes */
     string                              name;               /* name of fragment */
 
-    vector<unsigned char>               image;              /* in memory image of segment during construction */
+    fragment_image                      image;              /* in memory image of segment during construction */
 
     seg_fragment() : in_file(in_fileRefUndef), in_module(in_fileModuleRefUndef), from_segment_index(segmentIndexUndef),
                      offset(segmentOffsetUndef), fragment_length(segmentSizeUndef), fragment_alignment(byteAlignMask), attr({0,0,{0}}) { }
@@ -610,13 +882,13 @@ void owlink_stack_bss_arrange(vector< shared_ptr<struct link_segdef> > &link_seg
 }
 
 shared_ptr<struct seg_fragment> alloc_link_segment_fragment(struct link_segdef *sg) {
-    shared_ptr<struct seg_fragment> frag(new struct seg_fragment);
+    shared_ptr<struct seg_fragment> frag = link_arena_new<struct seg_fragment>();
     sg->fragments.push_back(frag);
     return frag;
 }
 
 shared_ptr<struct seg_fragment> alloc_link_segment_fragment(struct link_segdef *sg,size_t &index) {
-    shared_ptr<struct seg_fragment> frag(new struct seg_fragment);
+    shared_ptr<struct seg_fragment> frag = link_arena_new<struct seg_fragment>();
     index = sg->fragments.size();
     sg->fragments.push_back(frag);
     return frag;
@@ -746,7 +1018,7 @@ bool link_segments_qsort_by_fileofs(const shared_ptr<struct link_segdef> &sa,con
     return sa->file_offset < sb->file_offset;
 }
 
-void dump_link_symbols(vector< shared_ptr<struct link_symbol> > &link_symbols) {
+void dump_link_symbols(link_symbol_table &link_symbols) {
     unsigned int i,pass=0,passes=1;
 
     if (map_fp != NULL)
@@ -762,10 +1034,10 @@ void dump_link_symbols(vector< shared_ptr<struct link_symbol> > &link_symbols) {
         }
 
         if (cmdoptions.verbose || map_fp != NULL)
-            sort(link_symbols.begin(), link_symbols.end(), pass == 0 ? link_symbol_qsort_cmp_by_name : link_symbol_qsort_cmp);
+            sort(link_symbols.symbols.begin(), link_symbols.symbols.end(), pass == 0 ? link_symbol_qsort_cmp_by_name : link_symbol_qsort_cmp);
 
         while (i < link_symbols.size()) {
-            shared_ptr<struct link_symbol> sym = link_symbols[i++];
+            shared_ptr<struct link_symbol> sym = link_symbols.symbols[i++];
 
             if (cmdoptions.verbose) {
                 fprintf(stderr,"symbol[%u]: name='%s' group='%s' seg='%s' offset=0x%lx frag=%p file='%s' module=%u local=%u\n",
@@ -1035,7 +1307,7 @@ shared_ptr<struct link_segdef> find_link_segment_by_grpdef(vector< shared_ptr<st
     size_t i=0;
 
     while (i < link_segments.size()) {
-        shared_ptr<struct link_segdef> sg = link_segments[i++];
+        const auto &sg = link_segments[i++];
         if (sg->groupname == name) return sg;
     }
 
@@ -1046,7 +1318,7 @@ shared_ptr<struct link_segdef> find_link_segment_by_class(vector< shared_ptr<str
     size_t i=0;
 
     while (i < link_segments.size()) {
-        shared_ptr<struct link_segdef> sg = link_segments[i++];
+        const auto &sg = link_segments[i++];
         if (sg->classname == name) return sg;
     }
 
@@ -1058,14 +1330,14 @@ shared_ptr<struct link_segdef> find_link_segment_by_class_last(vector< shared_pt
     size_t i=0;
 
     while (i < link_segments.size()) {
-        shared_ptr<struct link_segdef> sg = link_segments[i++];
+        const auto &sg = link_segments[i++];
         if (sg->classname == name) ret = sg;
     }
 
     return ret;
 }
 
-fragmentRef find_link_segment_by_file_module(const struct link_segdef * const sg,const in_fileRef in_file,const in_fileModuleRef in_module) {
+fragmentRef find_link_segment_by_file_module(const struct link_segdef * const sg,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
     for (auto i=sg->fragments.begin();i != sg->fragments.end();i++) {
         const struct seg_fragment *f = (*i).get();
 
@@ -1076,7 +1348,7 @@ fragmentRef find_link_segment_by_file_module(const struct link_segdef * const sg
     return fragmentRefUndef;
 }
 
-fragmentRef find_link_segment_by_file_module_and_segment_index(const struct link_segdef * const sg,const in_fileRef in_file,const in_fileModuleRef in_module,const segmentIndex TargetDatum) {
+fragmentRef find_link_segment_by_file_module_and_segment_index(const struct link_segdef * const sg,const in_fileRef &in_file,const in_fileModuleRef &in_module,const segmentIndex TargetDatum) {
     for (auto i=sg->fragments.begin();i != sg->fragments.end();i++) {
         const struct seg_fragment *f = (*i).get();
 
@@ -1091,31 +1363,31 @@ fragmentRef find_link_segment_by_file_module_and_segment_index(const struct link
  * Presumably segdefs are sorted such that segment groups increment sequentially
  * given a specific name. */
 shared_ptr<struct link_segdef> find_link_segment(vector< shared_ptr<struct link_segdef> > &link_segments,const char *name) {
-    shared_ptr<struct link_segdef> sg,rsg;
+    const shared_ptr<struct link_segdef> *rsg = NULL;
     size_t i=0;
 
     while (i < link_segments.size()) {
-        sg = link_segments[i++];
+        const auto &sg = link_segments[i++];
         if (sg->name == name) {
-            rsg = sg;
+            rsg = &sg;
 
             if (sg->segment_group >= current_segment_group)
                 break;
         }
     }
 
-    return rsg;
+    return rsg != NULL ? *rsg : nullptr;
 }
 
 shared_ptr<struct link_segdef> new_link_segment(vector< shared_ptr<struct link_segdef> > &link_segments,const char *name) {
-    shared_ptr<struct link_segdef> sg(new struct link_segdef);
+    shared_ptr<struct link_segdef> sg = link_arena_new<struct link_segdef>();
     link_segments.push_back(sg);
     sg->name = name;
     return sg;
 }
 
 shared_ptr<struct link_segdef> new_link_segment_begin(vector< shared_ptr<struct link_segdef> > &link_segments,const char *name) {
-    shared_ptr<struct link_segdef> sg(new struct link_segdef);
+    shared_ptr<struct link_segdef> sg = link_arena_new<struct link_segdef>();
     link_segments.insert(link_segments.begin(), sg );
     sg->name = name;
     return sg;
@@ -1165,7 +1437,7 @@ int ledata_add(vector< shared_ptr<struct link_segdef> > &link_segments,struct om
     return 0;
 }
 
-int fixupp_get(vector< shared_ptr<struct link_symbol> > &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned long *fseg,unsigned long *fofs,shared_ptr<struct link_segdef> *sdef,const struct omf_fixupp_t *ent,unsigned int method,unsigned int index,in_fileRef in_file,in_fileModuleRef in_module) {
+int fixupp_get(link_symbol_table &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned long *fseg,unsigned long *fofs,shared_ptr<struct link_segdef> *sdef,const struct omf_fixupp_t *ent,unsigned int method,unsigned int index,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
     *fseg = *fofs = ~0UL;
     *sdef = NULL;
     (void)ent;
@@ -1236,7 +1508,7 @@ int fixupp_get(vector< shared_ptr<struct link_symbol> > &link_symbols,vector< sh
     return 0;
 }
 
-int apply_FIXUPP(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,vector< shared_ptr<struct link_symbol> > &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,in_fileRef in_file,in_fileModuleRef in_module,unsigned int pass) {
+int apply_FIXUPP(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,link_symbol_table &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,const in_fileRef &in_file,const in_fileModuleRef &in_module,unsigned int pass) {
     shared_ptr<struct link_segdef> frame_sdef;
     shared_ptr<struct link_segdef> targ_sdef;
     const struct omf_segdef_t *cur_segdef;
@@ -1538,7 +1810,7 @@ int grpdef_add(vector< shared_ptr<struct link_segdef> > &link_segments,struct om
     return 0;
 }
 
-int pubdef_add(vector< shared_ptr<struct link_symbol> > &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned int tag,in_fileRef in_file,in_fileModuleRef in_module) {
+int pubdef_add(link_symbol_table &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned int tag,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
     const unsigned char is_local = (tag == OMF_RECTYPE_LPUBDEF) || (tag == OMF_RECTYPE_LPUBDEF32);
     unsigned int first = 0;
 
@@ -1602,7 +1874,7 @@ int pubdef_add(vector< shared_ptr<struct link_symbol> > &link_symbols,vector< sh
     return 0;
 }
 
-int segdef_add(vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned int first,in_fileRef in_file,in_fileModuleRef in_module) {
+int segdef_add(vector< shared_ptr<struct link_segdef> > &link_segments,struct omf_context_t *omf_state,unsigned int first,const in_fileRef &in_file,const in_fileModuleRef &in_module) {
     while (first < omf_state->SEGDEFs.omf_SEGDEFS_count) {
         struct omf_segdef_t *sg = &omf_state->SEGDEFs.omf_SEGDEFS[first++];
         const char *classname = omf_lnames_context_get_name_safe(&omf_state->LNAMEs,sg->class_name_index);
@@ -1670,6 +1942,9 @@ int segdef_add(vector< shared_ptr<struct link_segdef> > &link_segments,struct om
 static void help(void) {
     fprintf(stderr,"lnkdos16 [options]\n");
     fprintf(stderr,"  -i <file>    OMF file to link\n");
+    fprintf(stderr,"  -inc <file>  Incremental link, keeping link state in <file>\n");
+    fprintf(stderr,"  -libfull     Load every module of a .LIB, not just the ones needed\n");
+    fprintf(stderr,"  -j <n>       Read input files with n threads (default: one per CPU)\n");
     fprintf(stderr,"  -o <file>    Output file\n");
     fprintf(stderr,"  -map <file>  Map/report file\n");
     fprintf(stderr,"  -of <fmt>    Output format (COM, EXE, COMREL)\n");
@@ -2019,10 +2294,14 @@ int parse_MODEND(vector< shared_ptr<struct link_segdef> > &link_segments,struct
     return 0;
 }
 
-int apply_relocation_fixup(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,vector< shared_ptr<struct link_symbol> > &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments) {
+/* if changed_only, only the modules of files that changed since the last incremental link are fixed up */
+int apply_relocation_fixup(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,link_symbol_table &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments,const bool changed_only) {
     for (auto fi=cmdoptions.in_file.begin();fi!=cmdoptions.in_file.end();fi++) {
         auto in_file = *fi;
 
+        if (changed_only && !in_file->changed)
+            continue;
+
         current_segment_group = in_file->segment_group;
         for (auto mi=in_file->modules.begin();mi!=in_file->modules.end();mi++) {
             auto in_mod = *mi;
@@ -2036,7 +2315,7 @@ int apply_relocation_fixup(vector< shared_ptr<struct exe_relocation> > &exe_relo
     return 0;
 }
 
-int compute_exe_relocations(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,vector< shared_ptr<struct link_symbol> > &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments) {
+int compute_exe_relocations(vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,link_symbol_table &link_symbols,vector< shared_ptr<struct link_segdef> > &link_segments) {
     for (auto fi=cmdoptions.in_file.begin();fi!=cmdoptions.in_file.end();fi++) {
         auto in_file = *fi;
 
@@ -2095,96 +2374,982 @@ void ensure_minimum_stack(vector< shared_ptr<struct link_segdef> > &link_segment
     }
 }
 
-int main(int argc,char **argv) {
-    entrypoint entry_point;
-    vector< shared_ptr<struct link_segdef> > link_segments;
-    vector< shared_ptr<struct link_symbol> > link_symbols;
-    vector< shared_ptr<struct exe_relocation> > exe_relocation_table;
-    unsigned char diddump = 0;
-    int i,fd,ret;
-    char *a;
+/* read the records of one module, from the current read position up to and including MODEND,
+ * into current_in_file_module. returns 0 when the module is complete, 1 if reading stopped
+ * early on a read error, and -1 on a fatal error. */
+int omf_read_module(struct omf_context_t *omf_state,int fd,in_fileRef current_in_file,in_fileModuleRef current_in_file_module) {
+    int ret;
 
-    in_fileRefPadding.reset(new input_file);
-    in_fileRefPadding->path = "<padding>";
-    in_fileRefPadding->special = input_file::SPEC_PADDING;
+    do {
+        if (omf_context_is_mapped(omf_state))
+            ret = omf_context_read_map(omf_state);
+        else
+            ret = omf_context_read_fd(omf_state,fd);
 
-    in_fileRefInternal.reset(new input_file);
-    in_fileRefInternal->path = "<internal>";
-    in_fileRefInternal->special = input_file::SPEC_INTERNAL;
+        if (ret == 0) {
+            if (omf_state->THEADR != NULL) {
+                const char *s = omf_state->THEADR;
+                const char *scan = s;
+                while (scan[0] != 0 && scan[1] != 0) {
+                    if (*scan == '\\' || *scan == '/')
+                        s = scan+1;
 
-    for (i=1;i < argc;) {
-        a = argv[i++];
+                    scan++;
+                }
 
-        if (*a == '-') {
-            do { a++; } while (*a == '-');
+                current_in_file_module->name = s;
+            }
+            if (grpdef_add(current_in_file_module->link_segments, omf_state))
+                return -1;
+            if (pubdef_add(current_in_file_module->link_symbols, current_in_file_module->link_segments, omf_state, omf_state->record.rectype, current_in_file, current_in_file_module))
+                return -1;
 
-            if (!strcmp(a,"i")) {
-                char *s = argv[i++];
-                if (s == NULL) return 1;
+            assert(current_in_file_module->omf_state == NULL);
+            if ((current_in_file_module->omf_state=omf_context_create()) == NULL) {
+                fprintf(stderr,"Failed to init OMF parsing state\n");
+                return -1;
+            }
 
-                shared_ptr<input_file> ent(new input_file);
+            /* transfer ownership to new OMF object by swapping valid pointers with NULL pointers in new struct */
+            swap(current_in_file_module->omf_state->LNAMEs,         omf_state->LNAMEs);
+            swap(current_in_file_module->omf_state->SEGDEFs,        omf_state->SEGDEFs);
+            swap(current_in_file_module->omf_state->GRPDEFs,        omf_state->GRPDEFs);
+            swap(current_in_file_module->omf_state->EXTDEFs,        omf_state->EXTDEFs);
+            swap(current_in_file_module->omf_state->PUBDEFs,        omf_state->PUBDEFs);
+            swap(current_in_file_module->omf_state->FIXUPPs,        omf_state->FIXUPPs);
 
-                ent->path = s; /* constructs std::string from char* */
-                ent->segment_group = cmdoptions.next_segment_group;
+            omf_context_clear_for_module(omf_state);
 
-                cmdoptions.in_file.push_back(ent);
-            }
-            else if (!strcmp(a,"hsym")) {
-                a = argv[i++];
-                if (a == NULL) return 1;
-                cmdoptions.dosdrv_header_symbol = a;
-            }
-            else if (!strcmp(a,"segsym")) {
-                cmdoptions.def_segsym = 1;
-            }
-            else if (!strcmp(a,"pflat")) {
-                cmdoptions.prefer_flat = 1;
-            }
-            else if (!strncmp(a,"stack",5)) {
-                a += 5;
-                if (!isxdigit(*a)) return 1;
-                cmdoptions.want_stack_size = strtoul(a,NULL,16);
-            }
-            else if (!strncmp(a,"com",3)) {
-                a += 3;
-                if (!isxdigit(*a)) return 1;
-                cmdoptions.image_base_offset = strtoul(a,NULL,16);
-            }
-            else if (!strcmp(a,"hex")) {
-                a = argv[i++];
-                if (a == NULL) return 1;
-                cmdoptions.hex_output = a;
-            }
-            else if (!strcmp(a,"of")) {
-                a = argv[i++];
-                if (a == NULL) return 1;
+            return 0;
+        }
+        else if (ret < 0) {
+            fprintf(stderr,"Error: %s\n",strerror(errno));
+            if (omf_state->last_error != NULL) fprintf(stderr,"Details: %s\n",omf_state->last_error);
+            return 1;
+        }
 
-                if (!strcmp(a,"com"))
-                    cmdoptions.output_format = OFMT_COM;
-                else if (!strcmp(a,"comrel")) {
-                    cmdoptions.output_format = OFMT_COM;
-                    cmdoptions.output_format_variant = OFMTVAR_COMREL;
+        switch (omf_state->record.rectype) {
+            case OMF_RECTYPE_THEADR:/*0x80*/
+                if (omf_context_parse_THEADR(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing THEADR\n");
+                    return -1;
                 }
-                else if (!strcmp(a,"exe"))
-                    cmdoptions.output_format = OFMT_EXE;
-                else if (!strcmp(a,"dosdrv"))
-                    cmdoptions.output_format = OFMT_DOSDRV;
-                else if (!strcmp(a,"dosdrvrel")) {
-                    cmdoptions.output_format = OFMT_DOSDRV;
-                    cmdoptions.output_format_variant = OFMTVAR_COMREL;
+                break;
+            case OMF_RECTYPE_EXTDEF:/*0x8C*/
+            case OMF_RECTYPE_LEXTDEF:/*0xB4*/
+            case OMF_RECTYPE_LEXTDEF32:/*0xB5*/
+                if (omf_context_parse_EXTDEF(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing EXTDEF\n");
+                    return -1;
                 }
-                else if (!strcmp(a,"dosdrvexe"))
-                    cmdoptions.output_format = OFMT_DOSDRVEXE;
-                else {
-                    fprintf(stderr,"Unknown format\n");
-                    return 1;
+                break;
+            case OMF_RECTYPE_PUBDEF:/*0x90*/
+            case OMF_RECTYPE_PUBDEF32:/*0x91*/
+            case OMF_RECTYPE_LPUBDEF:/*0xB6*/
+            case OMF_RECTYPE_LPUBDEF32:/*0xB7*/
+                if (omf_context_parse_PUBDEF(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing PUBDEF\n");
+                    return -1;
                 }
-            }
-            else if (!strcmp(a,"map")) {
-                char *s = argv[i++];
-                if (s == NULL) return 1;
-                cmdoptions.map_file = s;
-            }
+                break;
+            case OMF_RECTYPE_LNAMES:/*0x96*/
+                if (omf_context_parse_LNAMES(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing LNAMES\n");
+                    return -1;
+                }
+                break;
+            case OMF_RECTYPE_SEGDEF:/*0x98*/
+            case OMF_RECTYPE_SEGDEF32:/*0x99*/
+                {
+                    int p_count = omf_state->SEGDEFs.omf_SEGDEFS_count;
+                    int first_new_segdef;
+
+                    if ((first_new_segdef=omf_context_parse_SEGDEF(omf_state,&omf_state->record)) < 0) {
+                        fprintf(stderr,"Error parsing SEGDEF\n");
+                        return -1;
+                    }
+
+                    if (omf_state->flags.verbose)
+                        dump_SEGDEF(stdout,omf_state,(unsigned int)first_new_segdef);
+
+                    if (segdef_add(current_in_file_module->link_segments, omf_state, p_count, current_in_file, current_in_file_module))
+                        return -1;
+                } break;
+            case OMF_RECTYPE_GRPDEF:/*0x9A*/
+            case OMF_RECTYPE_GRPDEF32:/*0x9B*/
+                if (omf_context_parse_GRPDEF(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing GRPDEF\n");
+                    return -1;
+                }
+                break;
+            case OMF_RECTYPE_FIXUPP:/*0x9C*/
+            case OMF_RECTYPE_FIXUPP32:/*0x9D*/
+                if (omf_context_parse_FIXUPP(omf_state,&omf_state->record) < 0) {
+                    fprintf(stderr,"Error parsing FIXUPP\n");
+                    return -1;
+                }
+                break;
+            case OMF_RECTYPE_LEDATA:/*0xA0*/
+            case OMF_RECTYPE_LEDATA32:/*0xA1*/
+                {
+                    struct omf_ledata_info_t info;
+
+                    if (omf_context_parse_LEDATA(omf_state,&info,&omf_state->record) < 0) {
+                        fprintf(stderr,"Error parsing LEDATA\n");
+                        return -1;
+                    }
+
+                    if (omf_state->flags.verbose)
+                        dump_LEDATA(stdout,omf_state,&info);
+
+                    if (ledata_add(current_in_file_module->link_segments, omf_state, &info))
+                        return -1;
+                } break;
+            case OMF_RECTYPE_MODEND:/*0x8A*/
+            case OMF_RECTYPE_MODEND32:/*0x8B*/
+                if (parse_MODEND(current_in_file_module->link_segments, omf_state, current_in_file, current_in_file_module, current_in_file_module->entry_point))
+                    return -1;
+                break;
+            default:
+                break;
+        }
+    } while (1);
+}
+
+/* Run func(job,worker) for jobs 0 to count-1 on up to cmdoptions.jobs threads.
+ * Jobs are handed out in order. After a job fails no new jobs are started.
+ * Returns 0 if all jobs returned 0, else the result of the lowest numbered failed job. */
+int parallel_jobs(const size_t count,const function<int(size_t,unsigned int)> &func) {
+    const unsigned int workers = (unsigned int)min((size_t)max(cmdoptions.jobs,1u),count);
+    vector<int> result(count,0);
+    atomic<size_t> next(0);
+    atomic<bool> stop(false);
+
+    auto worker = [&](unsigned int w) {
+        size_t j;
+
+        while (!stop && (j=next++) < count) {
+            if ((result[j]=func(j,w)) != 0)
+                stop = true;
+        }
+    };
+
+    if (workers > 1) {
+        vector<thread> threads;
+
+        for (unsigned int w=1;w < workers;w++)
+            threads.push_back(thread(worker,w));
+
+        worker(0);
+
+        for (auto ti=threads.begin();ti!=threads.end();ti++)
+            ti->join();
+    }
+    else {
+        worker(0);
+    }
+
+    for (size_t j=0;j < count;j++) {
+        if (result[j] != 0)
+            return result[j];
+    }
+
+    return 0;
+}
+
+/* open an input file and prepare an OMF context to read it */
+int open_input_file(const in_fileRef &in_file,int &fd,struct omf_context_t* &omf_state) {
+    fd = open(in_file->path.c_str(),O_RDONLY|O_BINARY);
+    if (fd < 0) {
+        fprintf(stderr,"Failed to open input file %s\n",strerror(errno));
+        return -1;
+    }
+
+    // prepare parsing
+    if ((omf_state=omf_context_create()) == NULL) {
+        fprintf(stderr,"Failed to init OMF parsing state\n");
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+    omf_state->flags.verbose = (cmdoptions.verbose > 0);
+
+    omf_context_begin_file(omf_state);
+
+    /* read records straight out of a memory map where the host supports it, else read() them */
+    if (omf_context_map_fd(omf_state,fd) < 0 && cmdoptions.verbose)
+        fprintf(stderr,"Not memory mapping %s, %s\n",in_file->path.c_str(),strerror(errno));
+
+    return 0;
+}
+
+/* read every module of an OBJ file, or of a .LIB with -libfull, into current_in_file.
+ * closes fd and destroys omf_state when done. returns 0 on success, -1 on error. */
+int load_input_file(in_fileRef current_in_file,int fd,struct omf_context_t *omf_state) {
+    in_fileModuleRef current_in_file_module;
+    unsigned char diddump = 0;
+    int ret;
+
+    current_segment_group = current_in_file->segment_group;
+
+    /* start a new module */
+    current_in_file_module.reset(new input_module);
+    current_in_file_module->file = current_in_file;
+    current_in_file_module->index = current_in_file->modules.size();
+    current_in_file->modules.push_back(current_in_file_module);
+
+    do {
+        ret = omf_read_module(omf_state,fd,current_in_file,current_in_file_module);
+        if (ret < 0) {
+            omf_context_clear(omf_state);
+            omf_context_destroy(omf_state);
+            close(fd);
+            current_segment_group = -1;
+            return -1;
+        }
+
+        /* the page after the last .LIB module holds LIBEND, not another module */
+        if (ret == 0 && omf_state->record.rectype == OMF_RECTYPE_LIBEND &&
+            current_in_file_module->link_segments.empty() && current_in_file_module->link_symbols.size() == 0) {
+            current_in_file->modules.pop_back();
+            break;
+        }
+
+        if (ret == 0 && omf_record_is_modend(&omf_state->record)) {
+            if (!diddump && cmdoptions.verbose) {
+                my_dumpstate(omf_state);
+                diddump = 1;
+            }
+
+            if (cmdoptions.verbose)
+                printf("----- next module -----\n");
+
+            if (omf_context_is_mapped(omf_state))
+                ret = omf_context_next_lib_module_map(omf_state);
+            else
+                ret = omf_context_next_lib_module_fd(omf_state,fd);
+
+            if (ret < 0) {
+                printf("Unable to advance to next .LIB module, %s\n",strerror(errno));
+                if (omf_state->last_error != NULL) fprintf(stderr,"Details: %s\n",omf_state->last_error);
+            }
+            else if (ret > 0) {
+                /* start a new module */
+                current_in_file_module.reset(new input_module);
+                current_in_file_module->file = current_in_file;
+                current_in_file_module->index = current_in_file->modules.size();
+                current_in_file->modules.push_back(current_in_file_module);
+
+                omf_context_begin_module(omf_state);
+                diddump = 0;
+                continue;
+            }
+        }
+
+        break;
+    } while (1);
+
+    if (!diddump && cmdoptions.verbose) {
+        my_dumpstate(omf_state);
+        diddump = 1;
+    }
+
+    current_in_file->is_library = (omf_state->library_block_size != 0);
+
+    omf_context_clear(omf_state);
+    omf_state = omf_context_destroy(omf_state);
+
+    close(fd);
+    current_segment_group = -1;
+
+    if (current_in_file->modules.size() == 1) {
+        for (auto mi=current_in_file->modules.begin();mi!=current_in_file->modules.end();mi++)
+            (*mi)->index = ~((size_t)(0u));
+    }
+
+    return 0;
+}
+
+/* .LIB file being searched through its dictionary.
+ *
+ * Unless -libfull is given, modules are only loaded from a library when they define a
+ * symbol that is still unresolved, repeating until no more modules are needed. The file
+ * stays open while resolving. Loaded modules are kept in file order so that the link
+ * output does not depend on the order symbols were resolved in.
+ *
+ * If LIBHEAD does not have the case sensitive flag, the dictionary is searched without regard
+ * to case like the librarian intended. Resolving symbols against the modules loaded that way is
+ * still case sensitive, as it is for every other module. */
+struct input_library {
+    in_fileRef                          file;
+    int                                 fd = -1;
+    struct omf_context_t*               omf_state = NULL;
+    bool                                case_sensitive = true;  /* LIBHEAD flag */
+    unordered_map<string,unsigned long> dictionary;         /* public symbol (see dict_key) -> module file offset */
+    unordered_map<unsigned long,vector<string> > module_symbols; /* module file offset -> its symbols in the dictionary */
+    map<unsigned long,in_fileModuleRef> loaded;             /* module file offset -> module */
+
+    ~input_library() {
+        close_file();
+    }
+
+    /* dictionary key for a symbol name, upper case if the library is not case sensitive */
+    string dict_key(const char *name,size_t len) const {
+        string r(name,len);
+
+        if (!case_sensitive) {
+            for (size_t i=0;i < r.length();i++)
+                r[i] = (char)toupper((unsigned char)r[i]);
+        }
+
+        return r;
+    }
+
+    unordered_map<string,unsigned long>::const_iterator find_symbol(const string &name) const {
+        if (case_sensitive)
+            return dictionary.find(name);
+
+        return dictionary.find(dict_key(name.c_str(),name.length()));
+    }
+
+    void close_file(void) {
+        if (omf_state != NULL) {
+            omf_context_clear(omf_state);
+            omf_state = omf_context_destroy(omf_state);
+        }
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+};
+
+/* if the file just opened in lib.omf_state is a .LIB, read its dictionary and return 1.
+ * if not, rewind to the start and return 0. -1 on error. */
+int lib_dictionary_load(input_library &lib) {
+    struct omf_context_t *omf_state = lib.omf_state;
+    const unsigned char *dict;
+    vector<unsigned char> dict_read;
+    struct omf_lib_dict_entry_t ent;
+    struct omf_libhead_t libhead;
+    unsigned int blk,bucket;
+    size_t dict_size;
+    int ret;
+
+    if (omf_context_is_mapped(omf_state))
+        ret = omf_context_read_map(omf_state);
+    else
+        ret = omf_context_read_fd(omf_state,lib.fd);
+
+    if (ret <= 0 || omf_state->record.rectype != OMF_RECTYPE_LIBHEAD) {
+        /* not a library, start over */
+        omf_context_begin_file(omf_state);
+        if (omf_context_is_mapped(omf_state))
+            ret = omf_context_seek_lib_module_map(omf_state,0);
+        else
+            ret = omf_context_seek_lib_module_fd(omf_state,lib.fd,0);
+
+        return (ret < 0) ? -1 : 0;
+    }
+
+    if (omf_lib_parse_LIBHEAD(&libhead,&omf_state->record) < 0 || libhead.dict_blocks == 0) {
+        fprintf(stderr,"Library %s has no dictionary\n",lib.file->path.c_str());
+        return -1;
+    }
+
+    lib.case_sensitive = (libhead.flags & OMF_LIBHEAD_FLAG_CASE_SENSITIVE) != 0;
+
+    dict_size = (size_t)libhead.dict_blocks * OMF_LIB_DICT_BLOCK_SIZE;
+    if (omf_context_is_mapped(omf_state)) {
+        if (libhead.dict_offset > omf_state->map_size || dict_size > (omf_state->map_size - libhead.dict_offset)) {
+            fprintf(stderr,"Library %s dictionary out of range\n",lib.file->path.c_str());
+            return -1;
+        }
+
+        dict = omf_state->map_base + libhead.dict_offset;
+    }
+    else {
+        dict_read.resize(dict_size);
+        if (lseek(lib.fd,(off_t)libhead.dict_offset,SEEK_SET) != (off_t)libhead.dict_offset ||
+            (size_t)read(lib.fd,&dict_read[0],dict_size) != dict_size) {
+            fprintf(stderr,"Library %s dictionary read error\n",lib.file->path.c_str());
+            return -1;
+        }
+
+        dict = &dict_read[0];
+    }
+
+    for (blk=0;blk < libhead.dict_blocks;blk++) {
+        const unsigned char *block = dict + ((size_t)blk * OMF_LIB_DICT_BLOCK_SIZE);
+
+        for (bucket=0;bucket < OMF_LIB_DICT_BUCKETS;bucket++) {
+            ret = omf_lib_dict_get_entry(&ent,block,bucket);
+            if (ret < 0) {
+                fprintf(stderr,"Library %s dictionary is corrupt\n",lib.file->path.c_str());
+                return -1;
+            }
+            if (ret == 0)
+                continue;
+
+            /* module names end in '!', they are not symbols */
+            if (ent.name_len == 0 || ent.name[ent.name_len-1] == '!')
+                continue;
+
+            /* a symbol only has one entry, but keep the first in case of a broken dictionary */
+            {
+                auto ins = lib.dictionary.insert(make_pair(lib.dict_key(ent.name,ent.name_len),(unsigned long)ent.page * libhead.page_size));
+                if (ins.second)
+                    lib.module_symbols[ins.first->second].push_back(string(ent.name,ent.name_len));
+            }
+        }
+    }
+
+    if (cmdoptions.verbose)
+        printf("Library %s: %u symbols in dictionary, page size %u, case %s\n",
+                lib.file->path.c_str(),(unsigned int)lib.dictionary.size(),libhead.page_size,
+                lib.case_sensitive ? "sensitive" : "insensitive");
+
+    return 1;
+}
+
+/* note the public symbols a module defines, and queue the external symbols it needs */
+void lib_scan_module(const in_fileModuleRef &in_mod,unordered_set<string> &defined,unordered_set<string> &queued,vector<string> &pending) {
+    for (auto si=in_mod->link_symbols.symbols.begin();si!=in_mod->link_symbols.symbols.end();si++) {
+        if (!(*si)->is_local)
+            defined.insert((*si)->name);
+    }
+
+    if (in_mod->omf_state != NULL) {
+        const struct omf_extdefs_context_t *extdefs = &in_mod->omf_state->EXTDEFs;
+        unsigned int i;
+
+        for (i=omf_extdefs_context_get_lowest_index(extdefs);i <= omf_extdefs_context_get_highest_index(extdefs);i++) {
+            const struct omf_extdef_t *ext = omf_extdefs_context_get_extdef(extdefs,i);
+
+            if (ext == NULL || ext->name_string == NULL || ext->type != OMF_EXTDEF_TYPE_GLOBAL)
+                continue;
+
+            if (queued.insert(ext->name_string).second)
+                pending.push_back(ext->name_string);
+        }
+    }
+}
+
+/* one open handle on a library, so that modules can be read from it in parallel */
+struct lib_reader {
+    int                                 fd = -1;
+    struct omf_context_t*               omf_state = NULL;
+
+    ~lib_reader() {
+        if (omf_state != NULL) {
+            omf_context_clear(omf_state);
+            omf_state = omf_context_destroy(omf_state);
+        }
+        if (fd >= 0)
+            close(fd);
+    }
+};
+
+int open_input_file(const in_fileRef &in_file,int &fd,struct omf_context_t* &omf_state);
+
+/* load the library module at file offset ofs, reading it with the given handle */
+int lib_load_module(const input_library &lib,int fd,struct omf_context_t *omf_state,unsigned long ofs,in_fileModuleRef &in_mod) {
+    int ret;
+
+    if (omf_context_is_mapped(omf_state))
+        ret = omf_context_seek_lib_module_map(omf_state,ofs);
+    else
+        ret = omf_context_seek_lib_module_fd(omf_state,fd,ofs);
+
+    if (ret < 0) {
+        fprintf(stderr,"Library %s: cannot seek to module at 0x%lx\n",lib.file->path.c_str(),ofs);
+        return -1;
+    }
+
+    omf_context_begin_module(omf_state);
+
+    in_mod.reset(new input_module);
+    in_mod->file = lib.file;
+
+    current_segment_group = lib.file->segment_group;
+    ret = omf_read_module(omf_state,fd,lib.file,in_mod);
+    current_segment_group = -1;
+
+    if (ret != 0 || !omf_record_is_modend(&omf_state->record)) {
+        fprintf(stderr,"Library %s: failed to read module at 0x%lx\n",lib.file->path.c_str(),ofs);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* pull in library modules until every external symbol that any library can satisfy is defined.
+ * like other OMF linkers, libraries are searched in command line order for each symbol. */
+int lib_resolve(vector< shared_ptr<input_library> > &libraries) {
+    unordered_set<string> defined,queued;
+    vector<string> pending;
+
+    for (auto fi=cmdoptions.in_file.begin();fi!=cmdoptions.in_file.end();fi++) {
+        if ((*fi)->is_library) continue;
+
+        for (auto mi=(*fi)->modules.begin();mi!=(*fi)->modules.end();mi++)
+            lib_scan_module(*mi,defined,queued,pending);
+    }
+
+    /* Resolve in rounds: pick every module the pending symbols need, read them in parallel, then
+     * queue what they reference. A module's symbols are taken from the dictionary as soon as it is
+     * picked, so the modules picked and the order of the queue are the same as if each module was
+     * read the moment it was needed. */
+    struct lib_job {
+        size_t                          lib_index;
+        unsigned long                   ofs;
+        in_fileModuleRef                in_mod;
+    };
+
+    vector< vector<lib_reader> > readers(max(cmdoptions.jobs,1u));
+    size_t pi = 0;
+
+    while (pi < pending.size()) {
+        const size_t round_end = pending.size();
+        vector<lib_job> jobs;
+
+        for (;pi < round_end;pi++) {
+            const string &name = pending[pi];
+
+            if (defined.find(name) != defined.end())
+                continue;
+
+            for (size_t li=0;li < libraries.size();li++) {
+                input_library &lib = *libraries[li];
+                auto di = lib.find_symbol(name);
+
+                if (di == lib.dictionary.end())
+                    continue;
+
+                if (lib.loaded.find(di->second) == lib.loaded.end()) {
+                    lib_job job;
+
+                    if (cmdoptions.verbose)
+                        printf("Library %s: loading module at 0x%lx for %s\n",lib.file->path.c_str(),di->second,name.c_str());
+
+                    job.lib_index = li;
+                    job.ofs = di->second;
+                    jobs.push_back(job);
+                    lib.loaded[job.ofs] = in_fileModuleRefUndef;
+
+                    auto ms = lib.module_symbols.find(job.ofs);
+                    if (ms != lib.module_symbols.end()) {
+                        for (auto si=ms->second.begin();si!=ms->second.end();si++)
+                            defined.insert(*si);
+                    }
+                }
+
+                break;
+            }
+        }
+
+        if (parallel_jobs(jobs.size(),[&](size_t j,unsigned int worker) -> int {
+            const input_library &lib = *libraries[jobs[j].lib_index];
+            int fd = lib.fd;
+            struct omf_context_t *omf_state = lib.omf_state;
+
+            /* the first worker uses the handle the dictionary was read with, others open their own */
+            if (worker != 0) {
+                vector<lib_reader> &wr = readers[worker];
+
+                if (wr.size() < libraries.size())
+                    wr.resize(libraries.size());
+
+                lib_reader &r = wr[jobs[j].lib_index];
+                if (r.omf_state == NULL && open_input_file(lib.file,r.fd,r.omf_state))
+                    return -1;
+
+                fd = r.fd;
+                omf_state = r.omf_state;
+            }
+
+            return lib_load_module(lib,fd,omf_state,jobs[j].ofs,jobs[j].in_mod);
+        }))
+            return -1;
+
+        for (auto ji=jobs.begin();ji!=jobs.end();ji++) {
+            libraries[ji->lib_index]->loaded[ji->ofs] = ji->in_mod;
+            lib_scan_module(ji->in_mod,defined,queued,pending);
+        }
+    }
+
+    for (auto li=libraries.begin();li!=libraries.end();li++) {
+        input_library &lib = **li;
+
+        for (auto mi=lib.loaded.begin();mi!=lib.loaded.end();mi++) {
+            mi->second->index = lib.file->modules.size();
+            lib.file->modules.push_back(mi->second);
+        }
+
+        if (lib.file->modules.size() == 1)
+            lib.file->modules[0]->index = ~((size_t)(0u));
+
+        lib.loaded.clear();
+        lib.close_file();
+    }
+
+    return 0;
+}
+
+/* Incremental linking (-inc <file>).
+ *
+ * The link state file records, for the last successful link, a hash of the options, the
+ * size and content hash of every input file, a hash of the layout (segments, fragments,
+ * symbols, relocations and entry point) and the size and hash of the output file.
+ *
+ * - If the options, every input and the output file are unchanged, there is nothing to do.
+ * - If some inputs changed but the layout comes out the same, fixups are applied only to
+ *   the modules of the changed files, and only their fragments and the ones the linker
+ *   generates are rewritten in place in the existing output file.
+ * - Anything else is a full link.
+ *
+ * Input files are still read every time. The layout cannot be known without them, and
+ * reading them (mapped, in parallel) costs about as much as reading back a saved copy. */
+#define LINK_STATE_VERSION              "lnkdos16-state 1"
+
+struct link_state_file {
+    uint64_t                            size = 0;
+    uint64_t                            hash = 0;
+
+    bool operator==(const link_state_file &o) const {
+        return size == o.size && hash == o.hash;
+    }
+    bool operator!=(const link_state_file &o) const {
+        return !(*this == o);
+    }
+};
+
+struct link_state {
+    uint64_t                            options_hash = 0;
+    uint64_t                            layout_hash = 0;
+    link_state_file                     output;
+    map<string,link_state_file>         files;          /* input path -> size, hash */
+};
+
+/* 64-bit FNV-1a */
+static const uint64_t                   fnv1a64_init = 0xCBF29CE484222325ull;
+
+static inline uint64_t fnv1a64(uint64_t h,const void *p,size_t len) {
+    const unsigned char *b = (const unsigned char*)p;
+
+    while (len-- != 0) {
+        h ^= *b++;
+        h *= 0x100000001B3ull;
+    }
+
+    return h;
+}
+
+static inline uint64_t fnv1a64(uint64_t h,const string &s) {
+    return fnv1a64(h,s.c_str(),s.length()+1u/*include NUL so "ab","c" != "a","bc"*/);
+}
+
+static inline uint64_t fnv1a64(uint64_t h,const uint64_t v) {
+    unsigned char tmp[8];
+    unsigned int i;
+
+    for (i=0;i < 8;i++) tmp[i] = (unsigned char)(v >> (i * 8u));
+    return fnv1a64(h,tmp,sizeof(tmp));
+}
+
+int link_state_hash_file(const char *path,link_state_file &st) {
+    unsigned char tmp[16384];
+    ssize_t rd;
+    int fd;
+
+    st.size = 0;
+    st.hash = fnv1a64_init;
+
+    fd = open(path,O_RDONLY|O_BINARY);
+    if (fd < 0)
+        return -1;
+
+    while ((rd=read(fd,tmp,sizeof(tmp))) > 0) {
+        st.hash = fnv1a64(st.hash,tmp,(size_t)rd);
+        st.size += (uint64_t)rd;
+    }
+
+    close(fd);
+    return (rd < 0) ? -1 : 0;
+}
+
+/* everything on the command line that affects the output. -inc, -j and -v do not */
+uint64_t link_state_options_hash(int argc,char **argv) {
+    uint64_t h = fnv1a64_init;
+    const char *a;
+    int i;
+
+    for (i=1;i < argc;i++) {
+        a = argv[i];
+
+        if (*a == '-') {
+            do { a++; } while (*a == '-');
+
+            if (!strcmp(a,"inc") || !strcmp(a,"j")) {
+                i++;
+                continue;
+            }
+            else if (!strcmp(a,"v")) {
+                continue;
+            }
+        }
+
+        h = fnv1a64(h,string(argv[i]));
+    }
+
+    return h;
+}
+
+static uint64_t link_state_hash_fragment(uint64_t h,const shared_ptr<struct seg_fragment> &frag) {
+    if (frag == nullptr)
+        return fnv1a64(h,(uint64_t)0);
+
+    h = fnv1a64(h,string(get_in_file(frag->in_file)));
+    h = fnv1a64(h,(uint64_t)(frag->in_module != nullptr ? frag->in_module->index : ~((size_t)(0u))));
+    h = fnv1a64(h,(uint64_t)frag->offset);
+    h = fnv1a64(h,(uint64_t)frag->fragment_length);
+    return h;
+}
+
+/* hash of where everything ends up. if this matches the last link, then the fixups of
+ * unchanged modules resolve to the same values as before */
+uint64_t link_state_layout_hash(const vector< shared_ptr<struct link_segdef> > &link_segments,const link_symbol_table &link_symbols,const vector< shared_ptr<struct exe_relocation> > &exe_relocation_table,const entrypoint &entry_point) {
+    uint64_t h = fnv1a64_init;
+
+    for (auto si=link_segments.begin();si!=link_segments.end();si++) {
+        const auto &sd = *si;
+
+        h = fnv1a64(h,sd->name);
+        h = fnv1a64(h,sd->classname);
+        h = fnv1a64(h,sd->groupname);
+        h = fnv1a64(h,(uint64_t)sd->linear_offset);
+        h = fnv1a64(h,(uint64_t)sd->segment_offset);
+        h = fnv1a64(h,(uint64_t)sd->segment_length);
+        h = fnv1a64(h,(uint64_t)sd->segment_relative);
+        h = fnv1a64(h,(uint64_t)sd->segment_reloc_adj);
+        h = fnv1a64(h,(uint64_t)((sd->noemit ? 1u : 0u) | (sd->header ? 2u : 0u)));
+        h = fnv1a64(h,(uint64_t)sd->fragments.size());
+        for (auto fi=sd->fragments.begin();fi!=sd->fragments.end();fi++)
+            h = link_state_hash_fragment(h,*fi);
+    }
+
+    for (auto si=link_symbols.symbols.begin();si!=link_symbols.symbols.end();si++) {
+        const auto &sym = *si;
+
+        h = fnv1a64(h,sym->name);
+        h = fnv1a64(h,sym->segref != nullptr ? sym->segref->name : string());
+        h = link_state_hash_fragment(h,sym->fragment);
+        h = fnv1a64(h,(uint64_t)sym->offset);
+    }
+
+    for (auto ri=exe_relocation_table.begin();ri!=exe_relocation_table.end();ri++) {
+        const auto &rel = *ri;
+
+        h = fnv1a64(h,rel->segref != nullptr ? rel->segref->name : string());
+        h = link_state_hash_fragment(h,rel->fragment);
+        h = fnv1a64(h,(uint64_t)rel->offset);
+    }
+
+    h = fnv1a64(h,entry_point.seg_link_target != nullptr ? entry_point.seg_link_target->name : string());
+    h = fnv1a64(h,entry_point.seg_link_frame != nullptr ? entry_point.seg_link_frame->name : string());
+    h = link_state_hash_fragment(h,entry_point.seg_link_target_fragment);
+    h = fnv1a64(h,(uint64_t)entry_point.seg_ofs);
+    return h;
+}
+
+/* returns 0 if read, -1 if missing or not a link state file */
+int link_state_read(link_state &st,const char *path) {
+    unsigned long long a,b;
+    char line[4096];
+    char *p,*e;
+    FILE *fp;
+    int ret = -1;
+
+    st = link_state();
+
+    fp = fopen(path,"r");
+    if (fp == NULL)
+        return -1;
+
+    if (fgets(line,sizeof(line),fp) == NULL || strncmp(line,LINK_STATE_VERSION "\n",sizeof(LINK_STATE_VERSION)) != 0)
+        goto done;
+
+    while (fgets(line,sizeof(line),fp) != NULL) {
+        if ((e=strchr(line,'\n')) != NULL) *e = 0;
+
+        if (!strncmp(line,"options ",8)) {
+            st.options_hash = strtoull(line+8,NULL,16);
+        }
+        else if (!strncmp(line,"layout ",7)) {
+            st.layout_hash = strtoull(line+7,NULL,16);
+        }
+        else if (!strncmp(line,"output ",7)) {
+            st.output.size = strtoull(line+7,&p,10);
+            st.output.hash = strtoull(p,NULL,16);
+        }
+        else if (!strncmp(line,"file ",5)) {
+            a = strtoull(line+5,&p,10);
+            b = strtoull(p,&p,16);
+            if (*p++ != ' ' || *p == 0)
+                goto done;
+
+            link_state_file &f = st.files[string(p)];
+            f.size = a;
+            f.hash = b;
+        }
+        else {
+            goto done;
+        }
+    }
+
+    ret = 0;
+done:
+    fclose(fp);
+    return ret;
+}
+
+int link_state_write(const link_state &st,const char *path) {
+    FILE *fp;
+
+    fp = fopen(path,"w");
+    if (fp == NULL)
+        return -1;
+
+    fprintf(fp,"%s\n",LINK_STATE_VERSION);
+    fprintf(fp,"options %016llx\n",(unsigned long long)st.options_hash);
+    fprintf(fp,"layout %016llx\n",(unsigned long long)st.layout_hash);
+    fprintf(fp,"output %llu %016llx\n",(unsigned long long)st.output.size,(unsigned long long)st.output.hash);
+    for (auto fi=st.files.begin();fi!=st.files.end();fi++)
+        fprintf(fp,"file %llu %016llx %s\n",(unsigned long long)fi->second.size,(unsigned long long)fi->second.hash,fi->first.c_str());
+
+    if (ferror(fp)) {
+        fclose(fp);
+        return -1;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* fragments that must be rewritten when patching the output of the last link */
+static inline bool link_state_fragment_dirty(const struct link_segdef *sd,const struct seg_fragment *frag) {
+    if (sd->header || frag->in_file == nullptr)
+        return true;
+
+    return frag->in_file->special != input_file::SPEC_NONE || frag->in_file->changed;
+}
+
+int main(int argc,char **argv) {
+    entrypoint entry_point;
+    vector< shared_ptr<struct link_segdef> > link_segments;
+    link_symbol_table link_symbols;
+    vector< shared_ptr<struct exe_relocation> > exe_relocation_table;
+    link_state inc_state,new_state;
+    bool inc_output_ok = false;
+    bool inc_patch = false;
+    int i,ret;
+    char *a;
+
+    in_fileRefPadding.reset(new input_file);
+    in_fileRefPadding->path = "<padding>";
+    in_fileRefPadding->special = input_file::SPEC_PADDING;
+
+    in_fileRefInternal.reset(new input_file);
+    in_fileRefInternal->path = "<internal>";
+    in_fileRefInternal->special = input_file::SPEC_INTERNAL;
+
+    for (i=1;i < argc;) {
+        a = argv[i++];
+
+        if (*a == '-') {
+            do { a++; } while (*a == '-');
+
+            if (!strcmp(a,"i")) {
+                char *s = argv[i++];
+                if (s == NULL) return 1;
+
+                shared_ptr<input_file> ent(new input_file);
+
+                ent->path = s; /* constructs std::string from char* */
+                ent->segment_group = cmdoptions.next_segment_group;
+
+                cmdoptions.in_file.push_back(ent);
+            }
+            else if (!strcmp(a,"inc")) {
+                char *s = argv[i++];
+                if (s == NULL) return 1;
+                cmdoptions.inc_file = s;
+            }
+            else if (!strcmp(a,"j")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                cmdoptions.jobs = strtoul(a,NULL,0);
+                if (cmdoptions.jobs == 0) return 1;
+            }
+            else if (!strcmp(a,"libfull")) {
+                cmdoptions.lib_full_scan = 1;
+            }
+            else if (!strcmp(a,"hsym")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                cmdoptions.dosdrv_header_symbol = a;
+            }
+            else if (!strcmp(a,"segsym")) {
+                cmdoptions.def_segsym = 1;
+            }
+            else if (!strcmp(a,"pflat")) {
+                cmdoptions.prefer_flat = 1;
+            }
+            else if (!strncmp(a,"stack",5)) {
+                a += 5;
+                if (!isxdigit(*a)) return 1;
+                cmdoptions.want_stack_size = strtoul(a,NULL,16);
+            }
+            else if (!strncmp(a,"com",3)) {
+                a += 3;
+                if (!isxdigit(*a)) return 1;
+                cmdoptions.image_base_offset = strtoul(a,NULL,16);
+            }
+            else if (!strcmp(a,"hex")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                cmdoptions.hex_output = a;
+            }
+            else if (!strcmp(a,"of")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+
+                if (!strcmp(a,"com"))
+                    cmdoptions.output_format = OFMT_COM;
+                else if (!strcmp(a,"comrel")) {
+                    cmdoptions.output_format = OFMT_COM;
+                    cmdoptions.output_format_variant = OFMTVAR_COMREL;
+                }
+                else if (!strcmp(a,"exe"))
+                    cmdoptions.output_format = OFMT_EXE;
+                else if (!strcmp(a,"dosdrv"))
+                    cmdoptions.output_format = OFMT_DOSDRV;
+                else if (!strcmp(a,"dosdrvrel")) {
+                    cmdoptions.output_format = OFMT_DOSDRV;
+                    cmdoptions.output_format_variant = OFMTVAR_COMREL;
+                }
+                else if (!strcmp(a,"dosdrvexe"))
+                    cmdoptions.output_format = OFMT_DOSDRVEXE;
+                else {
+                    fprintf(stderr,"Unknown format\n");
+                    return 1;
+                }
+            }
+            else if (!strcmp(a,"map")) {
+                char *s = argv[i++];
+                if (s == NULL) return 1;
+                cmdoptions.map_file = s;
+            }
             else if (!strcmp(a,"o")) {
                 char *s = argv[i++];
                 if (s == NULL) return 1;
@@ -2228,6 +3393,14 @@ int main(int argc,char **argv) {
         }
     }
 
+    if (cmdoptions.jobs == 0) {
+        /* verbose output from several threads at once would be unreadable */
+        if (cmdoptions.verbose)
+            cmdoptions.jobs = 1;
+        else
+            cmdoptions.jobs = max(thread::hardware_concurrency(),1u);
+    }
+
     if (cmdoptions.image_base_offset == segmentOffsetUndef) {
         if (cmdoptions.output_format == OFMT_COM) {
             cmdoptions.image_base_offset = 0x100;
@@ -2263,6 +3436,55 @@ int main(int argc,char **argv) {
         }
     }
 
+    /* incremental link: which input files changed, and is there anything to do at all? */
+    if (!cmdoptions.inc_file.empty() && !cmdoptions.in_file.empty() && !cmdoptions.out_file.empty()) {
+        vector<link_state_file> in_hash(cmdoptions.in_file.size());
+        bool prev_ok,up_to_date;
+
+        new_state.options_hash = link_state_options_hash(argc,argv);
+        prev_ok = link_state_read(inc_state,cmdoptions.inc_file.c_str()) == 0 && inc_state.options_hash == new_state.options_hash;
+
+        if (parallel_jobs(cmdoptions.in_file.size(),[&](size_t j,unsigned int worker) -> int {
+            (void)worker;
+            if (link_state_hash_file(cmdoptions.in_file[j]->path.c_str(),in_hash[j])) {
+                fprintf(stderr,"Unable to read %s, %s\n",cmdoptions.in_file[j]->path.c_str(),strerror(errno));
+                return -1;
+            }
+
+            return 0;
+        }))
+            return 1;
+
+        for (size_t j=0;j < cmdoptions.in_file.size();j++) {
+            in_fileRef in_file = cmdoptions.in_file[j];
+            auto pi = inc_state.files.find(in_file->path);
+
+            new_state.files[in_file->path] = in_hash[j];
+            in_file->changed = !prev_ok || pi == inc_state.files.end() || pi->second != in_hash[j];
+        }
+
+        /* patching the output of the last link needs that output, untouched */
+        if (prev_ok) {
+            link_state_file out;
+
+            inc_output_ok = link_state_hash_file(cmdoptions.out_file.c_str(),out) == 0 && out == inc_state.output;
+        }
+
+        up_to_date = inc_output_ok && new_state.files.size() == inc_state.files.size() &&
+            (cmdoptions.map_file.empty() || access(cmdoptions.map_file.c_str(),F_OK) == 0);
+        for (auto fi=cmdoptions.in_file.begin();up_to_date && fi!=cmdoptions.in_file.end();fi++) {
+            if ((*fi)->changed)
+                up_to_date = false;
+        }
+
+        if (up_to_date) {
+            if (cmdoptions.verbose)
+                fprintf(stderr,"%s is up to date\n",cmdoptions.out_file.c_str());
+
+            return 0;
+        }
+    }
+
     if (!cmdoptions.map_file.empty()) {
         map_fp = fopen(cmdoptions.map_file.c_str(),"w");
         if (map_fp == NULL) return 1;
@@ -2281,212 +3503,78 @@ int main(int argc,char **argv) {
 
     /* loads the OBJ files into memory */
     {
-        struct omf_context_t* omf_state = NULL;
+        vector< shared_ptr<input_library> > libraries;
+
+        vector<in_fileRef> obj_files;
 
         for (size_t in_file=0;in_file < cmdoptions.in_file.size();in_file++) {
             in_fileRef current_in_file = cmdoptions.in_file[in_file];
-            in_fileModuleRef current_in_file_module;
 
             assert(current_in_file != nullptr);
             assert(!current_in_file->path.empty());
             assert(current_in_file->special == input_file::SPEC_NONE);
 
-            fd = open(current_in_file->path.c_str(),O_RDONLY|O_BINARY);
-            if (fd < 0) {
-                fprintf(stderr,"Failed to open input file %s\n",strerror(errno));
-                return 1;
-            }
-
-            // prepare parsing
-            if ((omf_state=omf_context_create()) == NULL) {
-                fprintf(stderr,"Failed to init OMF parsing state\n");
-                return 1;
-            }
-            omf_state->flags.verbose = (cmdoptions.verbose > 0);
-
-            diddump = 0;
-            omf_context_begin_file(omf_state);
-            current_segment_group = current_in_file->segment_group;
-
-            /* start a new module */
-            current_in_file_module.reset(new input_module);
-            current_in_file_module->file = current_in_file;
-            current_in_file_module->index = current_in_file->modules.size();
-            current_in_file->modules.push_back(current_in_file_module);
-
-            do {
-                ret = omf_context_read_fd(omf_state,fd);
-                if (ret == 0) {
-                    if (omf_state->THEADR != NULL) {
-                        const char *s = omf_state->THEADR;
-                        const char *scan = s;
-                        while (scan[0] != 0 && scan[1] != 0) {
-                            if (*scan == '\\' || *scan == '/')
-                                s = scan+1;
-
-                            scan++;
-                        }
-
-                        current_in_file_module->name = s;
-                    }
-                    if (grpdef_add(current_in_file_module->link_segments, omf_state))
-                        return 1;
-                    if (pubdef_add(current_in_file_module->link_symbols, current_in_file_module->link_segments, omf_state, omf_state->record.rectype, current_in_file, current_in_file_module))
-                        return 1;
-
-                    assert(current_in_file_module->omf_state == NULL);
-                    if ((current_in_file_module->omf_state=omf_context_create()) == NULL) {
-                        fprintf(stderr,"Failed to init OMF parsing state\n");
-                        return 1;
-                    }
-
-                    /* transfer ownership to new OMF object by swapping valid pointers with NULL pointers in new struct */
-                    swap(current_in_file_module->omf_state->LNAMEs,         omf_state->LNAMEs);
-                    swap(current_in_file_module->omf_state->SEGDEFs,        omf_state->SEGDEFs);
-                    swap(current_in_file_module->omf_state->GRPDEFs,        omf_state->GRPDEFs);
-                    swap(current_in_file_module->omf_state->EXTDEFs,        omf_state->EXTDEFs);
-                    swap(current_in_file_module->omf_state->PUBDEFs,        omf_state->PUBDEFs);
-                    swap(current_in_file_module->omf_state->FIXUPPs,        omf_state->FIXUPPs);
+            /* a .LIB with a dictionary is kept open, its modules are loaded later only as needed */
+            if (!cmdoptions.lib_full_scan) {
+                shared_ptr<input_library> lib(new input_library);
 
-                    omf_context_clear_for_module(omf_state);
+                lib->file = current_in_file;
+                if (open_input_file(current_in_file,lib->fd,lib->omf_state))
+                    return 1;
 
-                    if (omf_record_is_modend(&omf_state->record)) {
-                        if (!diddump && cmdoptions.verbose) {
-                            my_dumpstate(omf_state);
-                            diddump = 1;
-                        }
+                ret = lib_dictionary_load(*lib);
+                if (ret < 0)
+                    return 1;
 
-                        if (cmdoptions.verbose)
-                            printf("----- next module -----\n");
+                if (ret > 0) {
+                    current_in_file->is_library = true;
+                    libraries.push_back(lib);
+                    continue;
+                }
+            }
 
-                        ret = omf_context_next_lib_module_fd(omf_state,fd);
-                        if (ret < 0) {
-                            printf("Unable to advance to next .LIB module, %s\n",strerror(errno));
-                            if (omf_state->last_error != NULL) fprintf(stderr,"Details: %s\n",omf_state->last_error);
-                        }
-                        else if (ret > 0) {
-                            /* start a new module */
-                            current_in_file_module.reset(new input_module);
-                            current_in_file_module->file = current_in_file;
-                            current_in_file_module->index = current_in_file->modules.size();
-                            current_in_file->modules.push_back(current_in_file_module);
-
-                            omf_context_begin_module(omf_state);
-                            diddump = 0;
-                            continue;
-                        }
-                    }
+            obj_files.push_back(current_in_file);
+        }
 
-                    break;
-                }
-                else if (ret < 0) {
-                    fprintf(stderr,"Error: %s\n",strerror(errno));
-                    if (omf_state->last_error != NULL) fprintf(stderr,"Details: %s\n",omf_state->last_error);
-                    break;
-                }
+        /* read the object files in parallel. each file fills in only its own modules,
+         * and everything after this walks files and modules in command line order, so
+         * the result does not depend on which thread finished first. */
+        if (parallel_jobs(obj_files.size(),[&](size_t j,unsigned int worker) -> int {
+            struct omf_context_t *omf_state = NULL;
+            int fd = -1;
 
-                switch (omf_state->record.rectype) {
-                    case OMF_RECTYPE_THEADR:/*0x80*/
-                        if (omf_context_parse_THEADR(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing THEADR\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_EXTDEF:/*0x8C*/
-                    case OMF_RECTYPE_LEXTDEF:/*0xB4*/
-                    case OMF_RECTYPE_LEXTDEF32:/*0xB5*/
-                        if (omf_context_parse_EXTDEF(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing EXTDEF\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_PUBDEF:/*0x90*/
-                    case OMF_RECTYPE_PUBDEF32:/*0x91*/
-                    case OMF_RECTYPE_LPUBDEF:/*0xB6*/
-                    case OMF_RECTYPE_LPUBDEF32:/*0xB7*/
-                        if (omf_context_parse_PUBDEF(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing PUBDEF\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_LNAMES:/*0x96*/
-                        if (omf_context_parse_LNAMES(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing LNAMES\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_SEGDEF:/*0x98*/
-                    case OMF_RECTYPE_SEGDEF32:/*0x99*/
-                        {
-                            int p_count = omf_state->SEGDEFs.omf_SEGDEFS_count;
-                            int first_new_segdef;
+            (void)worker;
+            if (open_input_file(obj_files[j],fd,omf_state))
+                return -1;
 
-                            if ((first_new_segdef=omf_context_parse_SEGDEF(omf_state,&omf_state->record)) < 0) {
-                                fprintf(stderr,"Error parsing SEGDEF\n");
-                                return 1;
-                            }
+            return load_input_file(obj_files[j],fd,omf_state);
+        }))
+            return 1;
 
-                            if (omf_state->flags.verbose)
-                                dump_SEGDEF(stdout,omf_state,(unsigned int)first_new_segdef);
+        if (!libraries.empty()) {
+            if (lib_resolve(libraries))
+                return 1;
 
-                            if (segdef_add(current_in_file_module->link_segments, omf_state, p_count, current_in_file, current_in_file_module))
-                                return 1;
-                        } break;
-                    case OMF_RECTYPE_GRPDEF:/*0x9A*/
-                    case OMF_RECTYPE_GRPDEF32:/*0x9B*/
-                        if (omf_context_parse_GRPDEF(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing GRPDEF\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_FIXUPP:/*0x9C*/
-                    case OMF_RECTYPE_FIXUPP32:/*0x9D*/
-                        if (omf_context_parse_FIXUPP(omf_state,&omf_state->record) < 0) {
-                            fprintf(stderr,"Error parsing FIXUPP\n");
-                            return 1;
-                        }
-                        break;
-                    case OMF_RECTYPE_LEDATA:/*0xA0*/
-                    case OMF_RECTYPE_LEDATA32:/*0xA1*/
-                        {
-                            struct omf_ledata_info_t info;
+            libraries.clear();
+        }
 
-                            if (omf_context_parse_LEDATA(omf_state,&info,&omf_state->record) < 0) {
-                                fprintf(stderr,"Error parsing LEDATA\n");
-                                return 1;
-                            }
+        if (map_fp != NULL) {
+            bool any = false;
 
-                            if (omf_state->flags.verbose)
-                                dump_LEDATA(stdout,omf_state,&info);
+            for (auto fi=cmdoptions.in_file.begin();fi!=cmdoptions.in_file.end();fi++) {
+                if (!(*fi)->is_library) continue;
 
-                            if (ledata_add(current_in_file_module->link_segments, omf_state, &info))
-                                return 1;
-                        } break;
-                    case OMF_RECTYPE_MODEND:/*0x8A*/
-                    case OMF_RECTYPE_MODEND32:/*0x8B*/
-                        if (parse_MODEND(current_in_file_module->link_segments, omf_state, current_in_file, current_in_file_module, current_in_file_module->entry_point))
-                            return 1;
-                        break;
-                    default:
-                        break;
+                if (!any) {
+                    fprintf(map_fp,"Library modules loaded:\n");
+                    fprintf(map_fp,"---------------------------------------\n");
+                    any = true;
                 }
-            } while (1);
 
-            if (!diddump && cmdoptions.verbose) {
-                my_dumpstate(omf_state);
-                diddump = 1;
+                fprintf(map_fp,"  %u from '%s'\n",(unsigned int)(*fi)->modules.size(),(*fi)->path.c_str());
             }
 
-            omf_context_clear(omf_state);
-            omf_state = omf_context_destroy(omf_state);
-
-            close(fd);
-            current_segment_group = -1;
-
-            if (current_in_file->modules.size() == 1) {
-                for (auto mi=current_in_file->modules.begin();mi!=current_in_file->modules.end();mi++)
-                    (*mi)->index = ~((size_t)(0u));
-            }
+            if (any)
+                fprintf(map_fp,"\n");
         }
     }
 
@@ -2540,7 +3628,7 @@ int main(int argc,char **argv) {
         for (auto mi=in_file->modules.begin();mi!=in_file->modules.end();mi++) {
             auto in_mod = *mi;
 
-            for (auto si=in_mod->link_symbols.begin();si!=in_mod->link_symbols.end();si++) {
+            for (auto si=in_mod->link_symbols.symbols.begin();si!=in_mod->link_symbols.symbols.end();si++) {
                 auto in_sym = *si;
                 current_segment_group = in_sym->segref->segment_group;
 
@@ -2548,7 +3636,7 @@ int main(int argc,char **argv) {
                 in_sym->segref = find_link_segment(link_segments,in_sym->segref->name.c_str());
                 assert(in_sym->segref != nullptr);
 
-                link_symbols.push_back(in_sym);
+                link_symbols.add(in_sym);
 
                 in_sym.reset();
             }
@@ -3177,8 +4265,19 @@ int main(int argc,char **argv) {
         }
     }
 
+    /* incremental link: if the layout did not change, only the changed files need fixups */
+    if (!cmdoptions.inc_file.empty()) {
+        new_state.layout_hash = link_state_layout_hash(link_segments,link_symbols,exe_relocation_table,entry_point);
+
+        /* DOSDRV copies fixed up words out of the driver header, which may belong to an unchanged module */
+        inc_patch = inc_output_ok && new_state.layout_hash == inc_state.layout_hash && cmdoptions.output_format != OFMT_DOSDRV;
+
+        if (cmdoptions.verbose)
+            fprintf(stderr,"Incremental link: %s\n",inc_patch ? "layout unchanged, updating changed files only" : "full link");
+    }
+
     /* apply relocations (second symbol pass) */
-    if (apply_relocation_fixup(exe_relocation_table,link_symbols,link_segments))
+    if (apply_relocation_fixup(exe_relocation_table,link_symbols,link_segments,inc_patch))
         return 1;
 
     sort(link_segments.begin(), link_segments.end(), link_segments_qsort_by_linofs);
@@ -3187,7 +4286,7 @@ int main(int argc,char **argv) {
     dump_link_symbols(link_symbols);
     dump_link_segments(link_segments,DUMPLS_LINEAR);
 
-    sort(link_symbols.begin(), link_symbols.end(), link_symbol_qsort_cmp);
+    sort(link_symbols.symbols.begin(), link_symbols.symbols.end(), link_symbol_qsort_cmp);
 
     /* decide file offsets */
     {
@@ -3600,7 +4699,11 @@ int main(int argc,char **argv) {
     {
         int fd;
 
-        fd = open(cmdoptions.out_file.c_str(),O_RDWR|O_BINARY|O_CREAT|O_TRUNC,0644);
+        if (inc_patch)
+            fd = open(cmdoptions.out_file.c_str(),O_RDWR|O_BINARY);
+        else
+            fd = open(cmdoptions.out_file.c_str(),O_RDWR|O_BINARY|O_CREAT|O_TRUNC,0644);
+
         if (fd < 0) {
             fprintf(stderr,"Unable to open output file\n");
             return 1;
@@ -3626,6 +4729,21 @@ int main(int argc,char **argv) {
                         fprintf(stderr,"Fragment overlap error\n");
                         return 1;
                     }
+
+                    if (inc_patch) {
+                        /* same layout as the last link, the gaps and unchanged fragments are already there */
+                        if (!link_state_fragment_dirty(sd.get(),frag.get())) {
+                            cur_offset = file_ofs + frag->fragment_length;
+                            continue;
+                        }
+
+                        if (lseek(fd,(off_t)file_ofs,SEEK_SET) != (off_t)file_ofs) {
+                            fprintf(stderr,"Seek error\n");
+                            return 1;
+                        }
+
+                        cur_offset = file_ofs;
+                    }
                     else if (file_ofs > cur_offset) {
                         fileOffset gapsize = file_ofs - cur_offset;
                         if (gapsize > (fileOffset)(1024*1024)) {
@@ -3668,6 +4786,14 @@ int main(int argc,char **argv) {
         close(fd);
     }
 
+    if (!cmdoptions.inc_file.empty()) {
+        if (link_state_hash_file(cmdoptions.out_file.c_str(),new_state.output) ||
+            link_state_write(new_state,cmdoptions.inc_file.c_str())) {
+            fprintf(stderr,"Unable to write link state %s\n",cmdoptions.inc_file.c_str());
+            return 1;
+        }
+    }
+
     if (map_fp != NULL) {
         fprintf(map_fp,"\n");
         fprintf(map_fp,"Entry point:\n");
@@ -3709,7 +4835,7 @@ int main(int argc,char **argv) {
 
             fprintf(map_fp,"\n");
 
-            for (auto i=link_symbols.begin();i!=link_symbols.end();i++) {
+            for (auto i=link_symbols.symbols.begin();i!=link_symbols.symbols.end();i++) {
                 auto cur_sym = *i;
 
                 if (cur_sym->name == "$$ENTRYPOINT") continue;
@@ -3752,6 +4878,10 @@ int main(int argc,char **argv) {
         map_fp = NULL;
     }
 
+    if (cmdoptions.verbose)
+        fprintf(stderr,"Arena: %lu allocations, %lu bytes in %lu blocks\n",
+            (unsigned long)link_arena_stats.allocs,(unsigned long)link_arena_stats.bytes,(unsigned long)link_arena_stats.blocks);
+
     /* avoid shared_ptr cyclic reference leaks, clear out state now */
     for (auto fi=cmdoptions.in_file.begin();fi!=cmdoptions.in_file.end();fi++) {
         auto in_file = *fi;
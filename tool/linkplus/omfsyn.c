@@ -0,0 +1,475 @@
+
+/* Synthetic OMF object generator, for benchmarking the linker.
+ *
+ * Writes a set of 16-bit OMF object files, each with one code segment, a number of
+ * public symbols, and a number of external references (with FIXUPPs) to public
+ * symbols of other modules. The result links as an EXE (-of exe) and exercises the
+ * symbol lookup and fixup paths of the linker in proportion to the symbol count.
+ *
+ * With -g, modules are split into independent groups that only reference each other
+ * (module m is in group m % groups). With -l, module 0 is written as an object file
+ * and all others into an OMF library with a dictionary, so that linking module 0
+ * against the library should only pull in the rest of group 0. */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+
+#include <fmt/omf/omf.h>
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+//================================== PROGRAM ================================
+
+static char*                            out_prefix = NULL;
+static unsigned int                     modules = 100;
+static unsigned int                     syms_per_module = 500;
+static unsigned int                     exts_per_module = 500;
+static unsigned int                     groups = 1;
+static unsigned int                     data_add = 0;
+static char*                            out_lib = NULL;
+
+/* each public symbol is one word of data, followed by one word per external reference */
+#define LEDATA_CHUNK                    1000u
+
+/* library modules are aligned to this */
+#define LIB_PAGE_SIZE                   512u
+
+static void help(void) {
+    fprintf(stderr,"omfsyn [options]\n");
+    fprintf(stderr,"  -o <prefix>  Output prefix (writes <prefix>NNNNN.obj)\n");
+    fprintf(stderr,"  -m <n>       Number of modules (default 100)\n");
+    fprintf(stderr,"  -s <n>       Public symbols per module (default 500)\n");
+    fprintf(stderr,"  -e <n>       External references per module (default 500)\n");
+    fprintf(stderr,"  -g <n>       Independent groups of modules (default 1)\n");
+    fprintf(stderr,"  -l <file>    Write modules 1 and up into this .LIB instead\n");
+    fprintf(stderr,"  -d <n>       Add n to every LEDATA byte, same records otherwise (default 0)\n");
+}
+
+static int parse_argv(int argc,char **argv) {
+    int i;
+    char *a;
+
+    for (i=1;i < argc;) {
+        a = argv[i++];
+
+        if (*a == '-') {
+            do { a++; } while (*a == '-');
+
+            if (!strcmp(a,"o")) {
+                if ((out_prefix = argv[i++]) == NULL) return -1;
+            }
+            else if (!strcmp(a,"m")) {
+                if ((a = argv[i++]) == NULL) return -1;
+                modules = strtoul(a,NULL,0);
+            }
+            else if (!strcmp(a,"s")) {
+                if ((a = argv[i++]) == NULL) return -1;
+                syms_per_module = strtoul(a,NULL,0);
+            }
+            else if (!strcmp(a,"e")) {
+                if ((a = argv[i++]) == NULL) return -1;
+                exts_per_module = strtoul(a,NULL,0);
+            }
+            else if (!strcmp(a,"g")) {
+                if ((a = argv[i++]) == NULL) return -1;
+                groups = strtoul(a,NULL,0);
+            }
+            else if (!strcmp(a,"l")) {
+                if ((out_lib = argv[i++]) == NULL) return -1;
+            }
+            else if (!strcmp(a,"d")) {
+                if ((a = argv[i++]) == NULL) return -1;
+                data_add = strtoul(a,NULL,0);
+            }
+            else {
+                help();
+                return -1;
+            }
+        }
+        else {
+            fprintf(stderr,"Unexpected arg %s\n",a);
+            return -1;
+        }
+    }
+
+    if (out_prefix == NULL || modules == 0 || syms_per_module == 0 || groups == 0 || groups > modules) {
+        help();
+        return -1;
+    }
+
+    /* EXTDEF indexes and data offsets must fit the 16-bit OMF encoding and a 64KB segment */
+    if (exts_per_module > 0x7FFFu || ((syms_per_module + exts_per_module) * 2ul) > 0xFFF0ul) {
+        fprintf(stderr,"Too many symbols per module\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void sym_name(char *dst,unsigned int module,unsigned int sym) {
+    sprintf(dst,"_syn%05u_%05u",module,sym);
+}
+
+static int flush_record(int fd,struct omf_record_t *rec) {
+    omf_record_write_update_reclen(rec);
+    omf_record_write_update_checksum(rec);
+    if (omf_context_record_write_fd(fd,rec) < 0)
+        return -1;
+
+    omf_record_clear(rec);
+    return 0;
+}
+
+static int write_lenstr(struct omf_record_t *rec,const char *s) {
+    const size_t l = strlen(s);
+    size_t i;
+
+    if (omf_record_write_byte(rec,(unsigned char)l) < 0) return -1;
+    for (i=0;i < l;i++) {
+        if (omf_record_write_byte(rec,(unsigned char)s[i]) < 0) return -1;
+    }
+
+    return 0;
+}
+
+/* true if another name of this length fits before the record gets too big */
+static int record_room(const struct omf_record_t *rec,size_t need) {
+    return (rec->recpos + need) < 1000u;
+}
+
+/* number of modules in the group module m belongs to */
+static unsigned int group_size(unsigned int m) {
+    const unsigned int g = m % groups;
+
+    return (modules - g + groups - 1u) / groups;
+}
+
+/* module referenced by external i of module m: one of the other modules of its group */
+static unsigned int ext_target(unsigned int m,unsigned int i) {
+    const unsigned int gm = group_size(m);
+    const unsigned int li = m / groups;
+
+    return (((li + 1u + (i % (gm - 1u))) % gm) * groups) + (m % groups);
+}
+
+static int write_module(unsigned int module,int fd,struct omf_record_t *rec) {
+    const unsigned long seglen = (syms_per_module + exts_per_module) * 2ul;
+    const unsigned char has_ext = (group_size(module) > 1u);
+    char segname[32],name[64];
+    unsigned long ofs;
+    unsigned int i;
+
+    sprintf(segname,"SYN%05u_TEXT",module);
+
+    /* THEADR */
+    omf_record_clear(rec);
+    rec->rectype = OMF_RECTYPE_THEADR;
+    sprintf(name,"syn%05u.c",module);
+    write_lenstr(rec,name);
+    if (flush_record(fd,rec)) return -1;
+
+    /* LNAMES: 1="" 2=segment 3=class.
+     * Each module gets its own class so the EXE layout gives each segment its own frame. */
+    rec->rectype = OMF_RECTYPE_LNAMES;
+    write_lenstr(rec,"");
+    write_lenstr(rec,segname);
+    sprintf(name,"SYN%05u",module);
+    write_lenstr(rec,name);
+    if (flush_record(fd,rec)) return -1;
+
+    /* SEGDEF 1: byte aligned, public, 16-bit */
+    rec->rectype = OMF_RECTYPE_SEGDEF;
+    omf_record_write_byte(rec,(OMF_SEGDEF_RELOC_BYTE << 5) | (OMF_SEGDEF_COMBINE_PUBLIC << 2));
+    omf_record_write_word(rec,(unsigned short)seglen);
+    omf_record_write_index(rec,2);
+    omf_record_write_index(rec,3);
+    omf_record_write_index(rec,1);
+    if (flush_record(fd,rec)) return -1;
+
+    /* EXTDEF: references to symbols in the other modules */
+    if (has_ext) {
+        rec->rectype = OMF_RECTYPE_EXTDEF;
+        for (i=0;i < exts_per_module;i++) {
+            sym_name(name,ext_target(module,i),(i * 7u) % syms_per_module);
+            if (!record_room(rec,strlen(name) + 2u)) {
+                if (flush_record(fd,rec)) return -1;
+                rec->rectype = OMF_RECTYPE_EXTDEF;
+            }
+
+            write_lenstr(rec,name);
+            omf_record_write_index(rec,0);
+        }
+        if (rec->recpos != 0 && flush_record(fd,rec)) return -1;
+    }
+
+    /* PUBDEF: one per word in the segment */
+    rec->rectype = OMF_RECTYPE_PUBDEF;
+    omf_record_write_index(rec,0);
+    omf_record_write_index(rec,1);
+    for (i=0;i < syms_per_module;i++) {
+        sym_name(name,module,i);
+        if (!record_room(rec,strlen(name) + 4u)) {
+            if (flush_record(fd,rec)) return -1;
+            rec->rectype = OMF_RECTYPE_PUBDEF;
+            omf_record_write_index(rec,0);
+            omf_record_write_index(rec,1);
+        }
+
+        write_lenstr(rec,name);
+        omf_record_write_word(rec,(unsigned short)(i * 2u));
+        omf_record_write_index(rec,0);
+    }
+    if (flush_record(fd,rec)) return -1;
+
+    /* LEDATA + FIXUPP */
+    for (ofs=0;ofs < seglen;ofs += LEDATA_CHUNK) {
+        unsigned long len = seglen - ofs;
+        unsigned long j;
+
+        if (len > LEDATA_CHUNK) len = LEDATA_CHUNK;
+
+        rec->rectype = OMF_RECTYPE_LEDATA;
+        omf_record_write_index(rec,1);
+        omf_record_write_word(rec,(unsigned short)ofs);
+        for (j=0;j < len;j++)
+            omf_record_write_byte(rec,(unsigned char)((ofs + j) * 0x1Du + module + data_add));
+        if (flush_record(fd,rec)) return -1;
+
+        /* 16-bit offset fixups, segment relative, frame = target, target = EXTDEF */
+        rec->rectype = OMF_RECTYPE_FIXUPP;
+        for (j=0;j < len;j += 2u) {
+            const unsigned long w = (ofs + j) / 2ul;
+
+            if (w < syms_per_module || !has_ext) continue;
+
+            omf_record_write_byte(rec,0x80 + 0x40 + (OMF_FIXUPP_LOCATION_16BIT_OFFSET << 2) + ((j >> 8) & 3));
+            omf_record_write_byte(rec,j & 0xFF);
+            omf_record_write_byte(rec,(OMF_FIXUPP_FRAME_METHOD_TARGET << 4) + 0x04 + OMF_FIXUPP_TARGET_METHOD_EXTDEF);
+            omf_record_write_index(rec,(unsigned short)(w - syms_per_module + 1ul));
+        }
+        if (rec->recpos != 0 && flush_record(fd,rec)) return -1;
+        omf_record_clear(rec);
+    }
+
+    /* MODEND, the first module carries the entry point */
+    rec->rectype = OMF_RECTYPE_MODEND;
+    if (module == 0) {
+        omf_record_write_byte(rec,0xC0);
+        omf_record_write_byte(rec,0x00);
+        omf_record_write_index(rec,1);
+        omf_record_write_index(rec,1);
+        omf_record_write_word(rec,0);
+    }
+    else {
+        omf_record_write_byte(rec,0x00);
+    }
+    if (flush_record(fd,rec)) return -1;
+
+    return 0;
+}
+
+static int write_obj(unsigned int module,struct omf_record_t *rec) {
+    char path[512];
+    int fd;
+
+    sprintf(path,"%s%05u.obj",out_prefix,module);
+
+    fd = open(path,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644);
+    if (fd < 0) {
+        fprintf(stderr,"Unable to create %s, %s\n",path,strerror(errno));
+        return -1;
+    }
+
+    if (write_module(module,fd,rec)) {
+        fprintf(stderr,"Write error, %s\n",path);
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
+/* pad the file with zeros up to a multiple of align */
+static int pad_to(int fd,unsigned long align) {
+    static const unsigned char zero[OMF_LIB_DICT_BLOCK_SIZE] = {0};
+    off_t pos = lseek(fd,0,SEEK_CUR);
+    size_t pad;
+
+    if (pos < 0) return -1;
+    pad = (size_t)((align - ((unsigned long)pos % align)) % align);
+    while (pad > 0) {
+        const size_t todo = pad > sizeof(zero) ? sizeof(zero) : pad;
+        if ((size_t)write(fd,zero,todo) != todo) return -1;
+        pad -= todo;
+    }
+
+    return 0;
+}
+
+static int is_prime(unsigned int n) {
+    unsigned int d;
+
+    if (n < 2) return 0;
+    for (d=2;d*d <= n;d++) {
+        if ((n % d) == 0) return 0;
+    }
+
+    return 1;
+}
+
+/* build the library dictionary of all public symbols, trying larger (prime) sizes until everything fits */
+static unsigned char *build_dictionary(const unsigned int *pages,unsigned int *blocks) {
+    unsigned long total = 0;
+    unsigned char *dict;
+    unsigned int m,i,b;
+    char name[64];
+
+    for (m=1;m < modules;m++)
+        total += syms_per_module * (unsigned long)(1u + strlen("_syn00000_00000") + 2u + 1u);
+
+    b = (unsigned int)((total / (OMF_LIB_DICT_BLOCK_SIZE - OMF_LIB_DICT_BUCKETS - 1u)) + 1u);
+    do {
+        while (!is_prime(b)) b++;
+
+        dict = calloc(b,OMF_LIB_DICT_BLOCK_SIZE);
+        if (dict == NULL) return NULL;
+
+        for (m=1;m < modules;m++) {
+            for (i=0;i < syms_per_module;i++) {
+                struct omf_lib_dict_hash_t h;
+                unsigned int tries;
+                size_t l;
+
+                sym_name(name,m,i);
+                l = strlen(name);
+                omf_lib_dict_hash(&h,name,(unsigned int)l,b);
+                for (tries=0;tries < b;tries++) {
+                    if (omf_lib_dict_block_add(dict + ((size_t)h.block * OMF_LIB_DICT_BLOCK_SIZE),&h,name,(unsigned int)l,pages[m]) > 0)
+                        break;
+
+                    h.block = (h.block + h.block_delta) % b;
+                }
+
+                if (tries == b) goto retry;
+            }
+        }
+
+        *blocks = b;
+        return dict;
+retry:
+        free(dict);
+        b = b + (b / 2u) + 1u;
+    } while (1);
+}
+
+static int write_lib(struct omf_record_t *rec) {
+    unsigned int *pages = NULL;
+    unsigned char *dict = NULL;
+    unsigned int dict_blocks = 0;
+    unsigned long dict_ofs;
+    unsigned int m;
+    off_t pos;
+    int fd;
+
+    fd = open(out_lib,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644);
+    if (fd < 0) {
+        fprintf(stderr,"Unable to create %s, %s\n",out_lib,strerror(errno));
+        return -1;
+    }
+
+    pages = calloc(modules,sizeof(*pages));
+    if (pages == NULL) goto fail;
+
+    /* LIBHEAD, filled in when the dictionary is written. The record length sets the page size. */
+    omf_record_clear(rec);
+    rec->rectype = OMF_RECTYPE_LIBHEAD;
+    while (rec->recpos < (LIB_PAGE_SIZE - 3u - 1u))
+        omf_record_write_byte(rec,0);
+    if (flush_record(fd,rec)) goto fail;
+
+    for (m=1;m < modules;m++) {
+        if (pad_to(fd,LIB_PAGE_SIZE)) goto fail;
+        if ((pos = lseek(fd,0,SEEK_CUR)) < 0) goto fail;
+        if (((unsigned long)pos / LIB_PAGE_SIZE) > 0xFFFFul) {
+            fprintf(stderr,"Library too large\n");
+            goto fail;
+        }
+
+        pages[m] = (unsigned int)((unsigned long)pos / LIB_PAGE_SIZE);
+        if (write_module(m,fd,rec)) goto fail;
+    }
+
+    /* LIBEND, page aligned like a module, padded so that the dictionary starts on a block boundary */
+    if (pad_to(fd,LIB_PAGE_SIZE)) goto fail;
+    if ((pos = lseek(fd,0,SEEK_CUR)) < 0) goto fail;
+    rec->rectype = OMF_RECTYPE_LIBEND;
+    dict_ofs = (unsigned long)pos + 3u + 1u;
+    dict_ofs = (dict_ofs + OMF_LIB_DICT_BLOCK_SIZE - 1u) & ~((unsigned long)OMF_LIB_DICT_BLOCK_SIZE - 1u);
+    while (((unsigned long)pos + 3u + rec->recpos + 1u) < dict_ofs)
+        omf_record_write_byte(rec,0);
+    if (flush_record(fd,rec)) goto fail;
+
+    if ((dict = build_dictionary(pages,&dict_blocks)) == NULL) goto fail;
+    if ((size_t)write(fd,dict,(size_t)dict_blocks * OMF_LIB_DICT_BLOCK_SIZE) != ((size_t)dict_blocks * OMF_LIB_DICT_BLOCK_SIZE)) goto fail;
+
+    /* now fill in LIBHEAD */
+    if (lseek(fd,0,SEEK_SET) != 0) goto fail;
+    rec->rectype = OMF_RECTYPE_LIBHEAD;
+    omf_record_write_dword(rec,dict_ofs);
+    omf_record_write_word(rec,(unsigned short)dict_blocks);
+    omf_record_write_byte(rec,OMF_LIBHEAD_FLAG_CASE_SENSITIVE);
+    while (rec->recpos < (LIB_PAGE_SIZE - 3u - 1u))
+        omf_record_write_byte(rec,0);
+    if (flush_record(fd,rec)) goto fail;
+
+    free(dict);
+    free(pages);
+    close(fd);
+    return 0;
+fail:
+    fprintf(stderr,"Write error, %s\n",out_lib);
+    if (dict) free(dict);
+    if (pages) free(pages);
+    close(fd);
+    return -1;
+}
+
+int main(int argc,char **argv) {
+    struct omf_record_t rec;
+    unsigned int m;
+
+    if (parse_argv(argc,argv))
+        return 1;
+
+    omf_record_init(&rec);
+    if (omf_record_data_alloc(&rec,0) < 0) {
+        fprintf(stderr,"Out of memory\n");
+        return 1;
+    }
+
+    if (out_lib != NULL) {
+        if (write_obj(0,&rec) || write_lib(&rec))
+            return 1;
+    }
+    else {
+        for (m=0;m < modules;m++) {
+            if (write_obj(m,&rec))
+                return 1;
+        }
+    }
+
+    omf_record_free(&rec);
+    return 0;
+}
+
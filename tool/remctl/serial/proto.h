@@ -1,4 +1,7 @@
 
+#ifndef __DOSLIB_TOOL_REMCTL_SERIAL_PROTO_H
+#define __DOSLIB_TOOL_REMCTL_SERIAL_PROTO_H
+
 #pragma pack(push,1)
 /* this is loosely based on Kermit, but not the same protocol */
 struct remctl_serial_packet_header {
@@ -17,12 +20,37 @@ struct remctl_serial_packet {
 
 #define REMCTL_SERIAL_MARK      0x01
 
+/* Windowed mode (see winproto.h).
+ *
+ * Stop and wait (the default) sends one packet, waits for the reply, and checks data with the 8-bit sum
+ * in chksum. Windowed mode is entered with REMCTL_SERIAL_TYPE_NEGOTIATE and lets the client have up to
+ * 'window' requests in flight. The server answers every request with the request's sequence number.
+ *
+ * In windowed mode the packet is followed by a CRC-16 (CCITT, init 0xFFFF, low byte first) of length,
+ * sequence, type and data. chksum then only covers the header (length+sequence+type+chksum == 0 mod 256),
+ * so a damaged length byte is caught before waiting for the data. Packets with sequence 0xFF are always
+ * stop and wait packets and switch the server back to stop and wait mode. */
+#define REMCTL_SERIAL_WIN_MAX           8           /* max window, power of 2 that divides the 128 sequence numbers */
+#define REMCTL_SERIAL_WIN_MAX_LENGTH    254         /* max data length in windowed mode, CRC-16 follows the data */
+#define REMCTL_SERIAL_WIN_VERSION       1
+
+/* REMCTL_SERIAL_TYPE_NEGOTIATE: data[0] = version, data[1] = window (0 = stop and wait), data[2] = flags.
+ * the reply has the same layout with what the server accepted. */
+#define REMCTL_SERIAL_WIN_FLAG_PACK     0x01        /* REMCTL_SERIAL_TYPE_PACKED payloads allowed */
+
+/* OR'd into the type of a FILE_WRITE request or a MEMREAD reply: the bulk data is PackBits compressed.
+ * the command specific bytes before the data (2 for FILE_WRITE, 5 for MEMREAD) are not, and still
+ * hold the uncompressed length. only sent in windowed mode with REMCTL_SERIAL_WIN_FLAG_PACK. */
+#define REMCTL_SERIAL_TYPE_PACKED       0x80
+
 enum {
     REMCTL_SERIAL_TYPE_DOS=0x44,        /* MS-DOS specific */
     REMCTL_SERIAL_TYPE_ERROR=0x45,
     REMCTL_SERIAL_TYPE_FILE=0x46,       /* file I/O specific */
     REMCTL_SERIAL_TYPE_HALT=0x48,       /* halt/un-halt system */
     REMCTL_SERIAL_TYPE_INPORT=0x49,     /* input from port */
+    REMCTL_SERIAL_TYPE_NAK=0x4B,        /* windowed mode: server asks for request 'sequence' again */
+    REMCTL_SERIAL_TYPE_NEGOTIATE=0x4E,  /* enter/leave windowed mode */
     REMCTL_SERIAL_TYPE_OUTPORT=0x4F,    /* output to port */
     REMCTL_SERIAL_TYPE_MEMREAD=0x52,    /* read from memory */
     REMCTL_SERIAL_TYPE_PING=0x50,
@@ -56,3 +84,5 @@ enum {
     REMCTL_SERIAL_TYPE_FILE_SEEK=0x7B               /* seek file pointer */
 };
 
+#endif //__DOSLIB_TOOL_REMCTL_SERIAL_PROTO_H
+
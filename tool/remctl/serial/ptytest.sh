@@ -0,0 +1,71 @@
+#!/bin/bash
+#
+# Test remctlclient against remsrvhost over a pseudo terminal: upload, download and memdump in
+# stop and wait and windowed mode, with a simulated line, then windowed mode with lost and damaged
+# packets. Every transfer must come back identical.
+#
+#   ./ptytest.sh [baud] [latency ms]
+make || exit 1
+
+baud=${1:-115200}
+lat=${2:-2}
+tmp=`mktemp -d` || exit 1
+mkdir $tmp/root || exit 1
+client=linux-host/remctlclient
+server=linux-host/remsrvhost
+srv_pid=
+fail=0
+
+# half random, half zeros so -pack has something to do
+head -c 32768 /dev/urandom >$tmp/src.bin
+head -c 32768 /dev/zero >>$tmp/src.bin
+
+start_server() {
+    $server -root $tmp/root -b $baud -lat $lat $* >$tmp/pts &
+    srv_pid=$!
+    while [ ! -s $tmp/pts ]; do sleep 0.1; done
+    pts=`cat $tmp/pts`
+}
+
+stop_server() {
+    kill $srv_pid
+    wait $srv_pid 2>/dev/null
+    rm -f $tmp/pts
+}
+
+run() {
+    local what="$1" ; shift
+    local t0=`date +%s%N`
+    if ! timeout 300 $client -s $pts "$@" >$tmp/log 2>&1; then
+        echo "FAIL: $what"; cat $tmp/log; fail=1; return 1
+    fi
+    local t1=`date +%s%N`
+    printf "%-40s %6u ms\n" "$what" $(((t1-t0)/1000000))
+}
+
+check() {
+    if ! cmp -s $1 $2; then echo "FAIL: $1 and $2 differ"; fail=1; fi
+}
+
+start_server
+for mode in "-win 0" "-win 4" "-win 8" "-win 8 -pack"; do
+    run "upload $mode" $mode -c upload -mstr 'C:\TEST.BIN' -i $tmp/src.bin && check $tmp/src.bin $tmp/root/test.bin
+    run "download $mode" $mode -c download -mstr 'C:\TEST.BIN' -o $tmp/dl.bin && check $tmp/src.bin $tmp/dl.bin
+    rm -f $tmp/dl.bin $tmp/root/test.bin
+    run "memdump $mode" $mode -c memdump -maddr 0xF000 -msz 32768 -o $tmp/mem.bin
+    if [ -f $tmp/mem0.bin ]; then check $tmp/mem0.bin $tmp/mem.bin; else mv $tmp/mem.bin $tmp/mem0.bin; fi
+done
+stop_server
+
+start_server -drop 13 -corrupt 17
+for mode in "-win 4" "-win 8 -pack"; do
+    run "upload $mode, faults" $mode -c upload -mstr 'C:\TEST.BIN' -i $tmp/src.bin && check $tmp/src.bin $tmp/root/test.bin
+    run "download $mode, faults" $mode -c download -mstr 'C:\TEST.BIN' -o $tmp/dl.bin && check $tmp/src.bin $tmp/dl.bin
+    rm -f $tmp/dl.bin $tmp/root/test.bin
+    run "memdump $mode, faults" $mode -c memdump -maddr 0xF000 -msz 32768 -o $tmp/mem.bin && check $tmp/mem0.bin $tmp/mem.bin
+done
+stop_server
+
+rm -Rf $tmp
+if [ $fail != 0 ]; then echo "FAILED"; exit 1; fi
+echo "All OK"
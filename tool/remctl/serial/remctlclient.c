@@ -22,8 +22,10 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <time.h>
+#include <poll.h>
 
 #include "proto.h"
+#include "winproto.h"
 
 #ifndef O_BINARY
 #define O_BINARY (0)
@@ -46,6 +48,8 @@ static char*            memstr = NULL;
 static char*            input_file = NULL;
 static char*            output_file = NULL;
 static unsigned char    enterkey = 0;
+static int              win_size = 4;           /* window to ask for, 0 = stop and wait only */
+static int              win_pack = 0;
 
 static int              conn_fd = -1;
 
@@ -69,6 +73,8 @@ static void help(void) {
     fprintf(stderr,"  -data <n>         data value\n");
     fprintf(stderr,"  -o <file>         Output file\n");
     fprintf(stderr,"  -i <file>         Input file\n");
+    fprintf(stderr,"  -win <n>          Window for upload/download/memdump (0-%u, default 4, 0=stop and wait)\n",REMCTL_SERIAL_WIN_MAX);
+    fprintf(stderr,"  -pack             Compress upload/memdump data in windowed mode\n");
     fprintf(stderr,"\n");
     fprintf(stderr,"Commands are:\n");
     fprintf(stderr,"   ping             Ping the server (test connection)\n");
@@ -202,6 +208,16 @@ static int parse_argv(int argc,char **argv) {
             else if (!strcmp(a,"d")) {
                 debug = 1;
             }
+            else if (!strcmp(a,"win")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                win_size = atoi(a);
+                if (win_size < 0) win_size = 0;
+                else if (win_size > REMCTL_SERIAL_WIN_MAX) win_size = REMCTL_SERIAL_WIN_MAX;
+            }
+            else if (!strcmp(a,"pack")) {
+                win_pack = 1;
+            }
             else {
                 fprintf(stderr,"Unknown switch %s\n",a);
                 return 1;
@@ -221,8 +237,9 @@ static int parse_argv(int argc,char **argv) {
 
     if (serial_tty != NULL) {
         /* Motherboard RS-232 ports are usually /dev/ttyS0, /dev/ttyS1, etc.
-         * USB RS-232 ports are usually /dev/ttyUSB0, /dev/ttyUSB1, etc. */
-        if (!strncmp(serial_tty,"/dev/tty",8)) {
+         * USB RS-232 ports are usually /dev/ttyUSB0, /dev/ttyUSB1, etc.
+         * Pseudo terminals (a VM's serial port, remsrvhost) are /dev/pts/N */
+        if (!strncmp(serial_tty,"/dev/tty",8) || !strncmp(serial_tty,"/dev/pts/",9)) {
             /* good */
         }
         else {
@@ -569,6 +586,556 @@ int do_recv_packet(struct remctl_serial_packet * const pkt) {
     return 0;
 }
 
+/* windowed mode (see winproto.h). up to win_window requests are in flight, each one is kept in a
+ * slot until its reply comes back so that a lost request or reply can be resent on its own. */
+#define WIN_RETRIES             20
+#define WIN_FILE_CHUNK          252         /* FILE_READ/FILE_WRITE bytes per windowed packet, 2+252 = REMCTL_SERIAL_WIN_MAX_LENGTH */
+
+enum {
+    WIN_SLOT_FREE=0,
+    WIN_SLOT_SENT,
+    WIN_SLOT_DONE
+};
+
+struct win_slot {
+    struct remctl_serial_packet     req;
+    struct remctl_serial_packet     rsp;
+    unsigned char                   state;
+    unsigned char                   retries;
+    unsigned char                   fast;           // resent because a later reply came first
+    double                          sent;           // when req was last sent
+    unsigned int                    user;           // caller's note, i.e. byte count of the request
+};
+
+static struct win_slot              win_slots[REMCTL_SERIAL_WIN_MAX];
+static unsigned char                win_window = 0;     // negotiated window, 0 = stop and wait
+static unsigned char                win_flags = 0;      // negotiated REMCTL_SERIAL_WIN_FLAG_*
+static unsigned char                win_next = 0;       // sequence number of the next request
+static unsigned char                win_oldest = 0;     // sequence number of the oldest request in flight
+static unsigned int                 win_inflight = 0;
+static double                       win_rto = 1.0;      // retransmit timeout, seconds
+
+static struct remctl_serial_packet  win_rx;             // incoming frame assembly
+static unsigned int                 win_rx_write = 0;
+
+static double win_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/* leaving windowed mode: the NEGOTIATE reply can come after saved replies that the server resent because
+ * of our own resends. skip whole windowed packets, and anything else byte by byte, until the reply parses */
+static int win_recv_leave_reply(struct remctl_serial_packet * const pkt) {
+    const struct remctl_serial_packet_header *hdr;
+    const double timeout = win_now() + 5.0;
+    unsigned char buf[1024],sum;
+    unsigned int len = 0,i,j,need;
+    struct pollfd pfd;
+    int rd;
+
+    while (conn_fd >= 0 && win_now() < timeout) {
+        pfd.fd = conn_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd,1,10) <= 0)
+            continue;
+
+        rd = read(conn_fd,buf+len,sizeof(buf)-len);
+        if (rd <= 0) {
+            if (rd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                continue;
+
+            drop_connection();
+            return -1;
+        }
+        len += (unsigned int)rd;
+
+        i = 0;
+        while ((len - i) >= sizeof(*hdr)) {
+            hdr = (const struct remctl_serial_packet_header*)(buf+i);
+            need = sizeof(*hdr) + hdr->length;
+
+            if (hdr->mark != REMCTL_SERIAL_MARK) {
+                i++;
+            }
+            else if (hdr->type == REMCTL_SERIAL_TYPE_NEGOTIATE || hdr->type == REMCTL_SERIAL_TYPE_ERROR) {
+                if ((len - i) < need) break;
+
+                for (sum=hdr->chksum,j=sizeof(*hdr);j < need;j++) sum += buf[i+j];
+                if (sum == 0) {
+                    memcpy(pkt,buf+i,need);
+                    if (debug) {
+                        fprintf(stderr,"Received packet:\n");
+                        dump_packet(pkt);
+                    }
+
+                    cur_pkt_recv_seq = (pkt->hdr.sequence + 1) & 0x7F;
+                    return 0;
+                }
+
+                i++;
+            }
+            else if (remctl_win_header_ok(hdr)) {
+                need += 2;
+                if ((len - i) < need) break;
+                i += remctl_win_crc_ok((const struct remctl_serial_packet*)(buf+i)) ? need : 1;
+            }
+            else {
+                i++;
+            }
+        }
+
+        memmove(buf,buf+i,len-i);
+        len -= i;
+    }
+
+    return -1;
+}
+
+/* ask the server for windowed mode. returns the window the server accepted, 0 if stop and wait */
+int win_negotiate(const unsigned char window) {
+    const unsigned char leaving = win_window;
+
+    /* NEGOTIATE is always a stop and wait packet with sequence 0xFF, which also resets sequence numbering */
+    cur_pkt_seq = 0xFF;
+    remctl_serial_packet_begin(&cur_pkt,REMCTL_SERIAL_TYPE_NEGOTIATE);
+
+    cur_pkt.data[cur_pkt.hdr.length++] = REMCTL_SERIAL_WIN_VERSION;
+    cur_pkt.data[cur_pkt.hdr.length++] = window;
+    cur_pkt.data[cur_pkt.hdr.length++] = win_pack ? REMCTL_SERIAL_WIN_FLAG_PACK : 0;
+
+    remctl_serial_packet_end(&cur_pkt);
+
+    win_window = 0;
+    win_flags = 0;
+
+    if (do_send_packet(&cur_pkt) < 0) {
+        fprintf(stderr,"Failed to send packet\n");
+        return -1;
+    }
+
+    cur_pkt_recv_seq = 0xFF;
+    if ((leaving ? win_recv_leave_reply(&cur_pkt) : do_recv_packet(&cur_pkt)) < 0) {
+        fprintf(stderr,"Failed to recv packet\n");
+        return -1;
+    }
+
+    /* older servers answer with ERROR */
+    if (cur_pkt.hdr.type != REMCTL_SERIAL_TYPE_NEGOTIATE || cur_pkt.hdr.length < 3 ||
+        cur_pkt.data[0] != REMCTL_SERIAL_WIN_VERSION || cur_pkt.data[1] > REMCTL_SERIAL_WIN_MAX)
+        return 0;
+
+    win_window = cur_pkt.data[1];
+    win_flags = cur_pkt.data[2] & (win_pack ? REMCTL_SERIAL_WIN_FLAG_PACK : 0);
+    win_next = 0;
+    win_oldest = 0;
+    win_inflight = 0;
+    win_rx_write = 0;
+    memset(win_slots,0,sizeof(win_slots));
+
+    /* a full window of the largest packets both ways, plus turnaround */
+    win_rto = 0.5 + (2.0 * win_window * (sizeof(cur_pkt.hdr) + REMCTL_SERIAL_WIN_MAX_LENGTH + 2) * 10.0) / baud_rate;
+
+    if (debug)
+        fprintf(stderr,"Windowed mode: window=%u flags=0x%02x rto=%.3fs\n",win_window,win_flags,win_rto);
+
+    return win_window;
+}
+
+/* back to stop and wait. everything in flight must be complete */
+int win_end(void) {
+    if (win_window == 0)
+        return 0;
+
+    return win_negotiate(0) < 0 ? -1 : 0;
+}
+
+int win_can_send(void) {
+    return win_inflight < win_window;
+}
+
+static struct win_slot *win_slot_of(const unsigned char seq) {
+    return &win_slots[seq & (REMCTL_SERIAL_WIN_MAX - 1)];
+}
+
+static int win_send_slot(struct win_slot * const s) {
+    if (conn_fd < 0)
+        return -1;
+
+    if (debug) {
+        fprintf(stderr,"Sending windowed packet:\n");
+        dump_packet(&s->req);
+    }
+
+    if (write_persistent(conn_fd,&s->req,remctl_serial_frame_size(&s->req.hdr,1)) != (int)remctl_serial_frame_size(&s->req.hdr,1)) {
+        fprintf(stderr,"Send failed\n");
+        drop_connection();
+        return -1;
+    }
+
+    s->state = WIN_SLOT_SENT;
+    s->sent = win_now();
+    s->fast = 0;
+    return 0;
+}
+
+/* start the next request. fill in data and length, then win_packet_send() */
+struct remctl_serial_packet *win_packet_begin(const unsigned char type) {
+    struct win_slot *s = win_slot_of(win_next);
+
+    assert(win_can_send());
+    assert(s->state == WIN_SLOT_FREE);
+
+    s->req.hdr.mark = REMCTL_SERIAL_MARK;
+    s->req.hdr.length = 0;
+    s->req.hdr.sequence = win_next;
+    s->req.hdr.type = type;
+    return &s->req;
+}
+
+int win_packet_send(const unsigned int user) {
+    struct win_slot *s = win_slot_of(win_next);
+
+    assert(s->req.hdr.length <= REMCTL_SERIAL_WIN_MAX_LENGTH);
+    remctl_win_seal(&s->req);
+    s->retries = 0;
+    s->user = user;
+    win_next = (win_next + 1) & 0x7F;
+    win_inflight++;
+
+    return win_send_slot(s);
+}
+
+static void win_handle_frame(void) {
+    unsigned char d = (win_rx.hdr.sequence - win_oldest) & 0x7F;
+    struct win_slot *s = win_slot_of(win_rx.hdr.sequence);
+    unsigned char i;
+
+    if (debug) {
+        fprintf(stderr,"Received windowed packet:\n");
+        dump_packet(&win_rx);
+    }
+
+    if (win_rx.hdr.sequence > 0x7F || d >= win_inflight || s->req.hdr.sequence != win_rx.hdr.sequence)
+        return;
+
+    if (win_rx.hdr.type == REMCTL_SERIAL_TYPE_NAK) {
+        /* the server has later requests but not this one, don't wait for the timeout */
+        if (s->state == WIN_SLOT_SENT && s->retries < WIN_RETRIES) {
+            s->retries++;
+            win_send_slot(s);
+        }
+    }
+    else if (s->state == WIN_SLOT_SENT) {
+        memcpy(&s->rsp,&win_rx,sizeof(win_rx.hdr) + (size_t)win_rx.hdr.length);
+        s->state = WIN_SLOT_DONE;
+
+        /* the server replies in order, so the replies to earlier requests still waiting were lost.
+         * ask again now (the server resends the saved reply), once, after that it's up to the timeout */
+        for (i=0;i < d;i++) {
+            struct win_slot *e = win_slot_of((win_oldest + i) & 0x7F);
+
+            if (e->state == WIN_SLOT_SENT && !e->fast && e->retries < WIN_RETRIES) {
+                e->retries++;
+                if (win_send_slot(e) == 0) e->fast = 1;
+            }
+        }
+    }
+}
+
+/* take in whatever arrives within timeout, resend requests that timed out. -1 if the connection failed */
+int win_poll(const int timeout_ms) {
+    struct pollfd pfd;
+    unsigned int i;
+    double now;
+    int rd;
+
+    if (conn_fd < 0)
+        return -1;
+
+    pfd.fd = conn_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd,1,timeout_ms) > 0) {
+        do {
+            if (win_rx_write < sizeof(win_rx.hdr))
+                rd = read(conn_fd,(unsigned char*)(&win_rx) + win_rx_write,1);
+            else
+                rd = read(conn_fd,(unsigned char*)(&win_rx) + win_rx_write,remctl_serial_frame_size(&win_rx.hdr,1) - win_rx_write);
+
+            if (rd == 0) {
+                drop_connection();
+                return -1;
+            }
+            else if (rd < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+
+                drop_connection();
+                return -1;
+            }
+
+            if (win_rx_write == 0 && win_rx.hdr.mark != REMCTL_SERIAL_MARK)
+                continue;
+
+            win_rx_write += (unsigned int)rd;
+            if (win_rx_write == sizeof(win_rx.hdr) && !remctl_win_header_ok(&win_rx.hdr)) {
+                /* not in sync, look for the next mark */
+                win_rx_write = 0;
+                continue;
+            }
+
+            if (win_rx_write >= sizeof(win_rx.hdr) && win_rx_write >= remctl_serial_frame_size(&win_rx.hdr,1)) {
+                if (remctl_win_crc_ok(&win_rx))
+                    win_handle_frame();
+                else if (debug)
+                    fprintf(stderr,"Dropped packet with bad CRC\n");
+
+                win_rx_write = 0;
+            }
+        } while (1);
+    }
+
+    /* resend the oldest request still waiting if it timed out. the ones after it are most likely
+     * waiting at the server for this one, a missing one among them gets NAKed when the gap fills */
+    now = win_now();
+    for (i=0;i < win_inflight;i++) {
+        struct win_slot *s = win_slot_of((win_oldest + i) & 0x7F);
+
+        if (s->state != WIN_SLOT_SENT)
+            continue;
+
+        if ((now - s->sent) >= win_rto) {
+            if (++s->retries > WIN_RETRIES) {
+                fprintf(stderr,"No response after %u retries\n",WIN_RETRIES);
+                return -1;
+            }
+
+            if (debug)
+                fprintf(stderr,"Timeout, resending sequence %u\n",s->req.hdr.sequence);
+
+            if (win_send_slot(s) < 0)
+                return -1;
+        }
+
+        break;
+    }
+
+    return 0;
+}
+
+/* wait for the reply to the oldest request in flight. the pointer is valid until the next win_packet_begin() */
+const struct remctl_serial_packet *win_complete(unsigned int * const user) {
+    struct win_slot *s = win_slot_of(win_oldest);
+
+    if (win_inflight == 0)
+        return NULL;
+
+    while (s->state != WIN_SLOT_DONE) {
+        if (win_poll(10) < 0)
+            return NULL;
+    }
+
+    if (user != NULL)
+        *user = s->user;
+
+    s->state = WIN_SLOT_FREE;
+    win_oldest = (win_oldest + 1) & 0x7F;
+    win_inflight--;
+    return &s->rsp;
+}
+
+/* FILE request to the server and its windowed reply, checked */
+static int win_file_reply_ok(const struct remctl_serial_packet * const rsp,const unsigned char cmd) {
+    if (rsp == NULL) {
+        fprintf(stderr,"Failed to recv packet\n");
+        return 0;
+    }
+
+    if (rsp->hdr.type == REMCTL_SERIAL_TYPE_FILE && rsp->data[0] == REMCTL_SERIAL_TYPE_FILE_MSDOS_ERROR) {
+        fprintf(stderr,"MS-DOS returned an error\n");
+        return 0;
+    }
+
+    if (rsp->hdr.type != REMCTL_SERIAL_TYPE_FILE || rsp->hdr.length < 2 || rsp->data[0] != cmd) {
+        fprintf(stderr,"I/O failed\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* upload the rest of the open file ifd to the file open on the server. returns bytes written or -1 */
+long win_upload(const int ifd,const long file_size) {
+    const struct remctl_serial_packet *rsp;
+    struct remctl_serial_packet *pkt;
+    unsigned char tmp[WIN_FILE_CHUNK];
+    long count = 0,sent = 0;
+    unsigned int n,user;
+    time_t now,next = 0;
+    int rd;
+
+    while (count < file_size) {
+        /* keep the window full */
+        while (sent < file_size && win_can_send()) {
+            n = (file_size - sent) > WIN_FILE_CHUNK ? WIN_FILE_CHUNK : (unsigned int)(file_size - sent);
+            rd = read(ifd,tmp,n);
+            if (rd <= 0) return -1;
+
+            pkt = win_packet_begin(REMCTL_SERIAL_TYPE_FILE);
+            pkt->data[pkt->hdr.length++] = REMCTL_SERIAL_TYPE_FILE_WRITE;
+            pkt->data[pkt->hdr.length++] = (unsigned char)rd;
+
+            /* compress if the server takes it and it helps */
+            n = 0;
+            if (win_flags & REMCTL_SERIAL_WIN_FLAG_PACK)
+                n = remctl_pack(pkt->data+2,(unsigned int)rd - 1U,tmp,(unsigned int)rd);
+
+            if (n != 0) {
+                pkt->hdr.type |= REMCTL_SERIAL_TYPE_PACKED;
+                pkt->hdr.length += n;
+            }
+            else {
+                memcpy(pkt->data+2,tmp,(unsigned int)rd);
+                pkt->hdr.length += (unsigned int)rd;
+            }
+
+            if (win_packet_send((unsigned int)rd) < 0) return -1;
+            sent += rd;
+        }
+
+        rsp = win_complete(&user);
+        if (!win_file_reply_ok(rsp,REMCTL_SERIAL_TYPE_FILE_WRITE)) return -1;
+        if (rsp->data[1] != user) {
+            fprintf(stderr,"Remote end incomplete write\n");
+            return -1;
+        }
+        count += user;
+
+        now = time(NULL);
+        if (now >= next) {
+            next = now + 1;
+            printf("\x0D" "Uploading, %lu%% %lu / %lu... ",
+                (unsigned long)(((count >> 7UL) * 100UL) / ((file_size + 127UL) >> 7UL)),count,file_size);
+            fflush(stdout);
+        }
+    }
+
+    return count;
+}
+
+/* download file_size bytes of the file open on the server to ofd. returns bytes read or -1 */
+long win_download(const int ofd,const long file_size) {
+    const struct remctl_serial_packet *rsp;
+    struct remctl_serial_packet *pkt;
+    long count = 0,asked = 0;
+    unsigned int n,user;
+    time_t now,next = 0;
+
+    while (count < file_size) {
+        while (asked < file_size && win_can_send()) {
+            n = (file_size - asked) > WIN_FILE_CHUNK ? WIN_FILE_CHUNK : (unsigned int)(file_size - asked);
+
+            pkt = win_packet_begin(REMCTL_SERIAL_TYPE_FILE);
+            pkt->data[pkt->hdr.length++] = REMCTL_SERIAL_TYPE_FILE_READ;
+            pkt->data[pkt->hdr.length++] = (unsigned char)n;
+
+            if (win_packet_send(n) < 0) return -1;
+            asked += n;
+        }
+
+        rsp = win_complete(&user);
+        if (!win_file_reply_ok(rsp,REMCTL_SERIAL_TYPE_FILE_READ)) return -1;
+        if (rsp->data[1] != user || rsp->hdr.length < (2 + user)) {
+            fprintf(stderr,"Unexpected end of file\n");
+            return -1;
+        }
+
+        if (write(ofd,rsp->data+2,user) != (int)user) {
+            fprintf(stderr,"Local write failed\n");
+            return -1;
+        }
+        count += user;
+
+        now = time(NULL);
+        if (now >= next) {
+            next = now + 1;
+            printf("\x0D" "Download, %lu%% %lu / %lu... ",
+                (unsigned long)(((count >> 7UL) * 100UL) / ((file_size + 127UL) >> 7UL)),count,file_size);
+            fflush(stdout);
+        }
+    }
+
+    return count;
+}
+
+/* memdump: read sz bytes at addr to fd. returns 0 or -1 */
+int win_memdump(const int fd,unsigned long addr,long sz) {
+    const struct remctl_serial_packet *rsp;
+    struct remctl_serial_packet *pkt;
+    unsigned char tmp[192];
+    unsigned long raddr = addr;
+    unsigned int n,user;
+    long asked = 0;
+
+    while (sz > 0) {
+        while (asked < sz && win_can_send()) {
+            n = (sz - asked) > 192 ? 192 : (unsigned int)(sz - asked);
+
+            pkt = win_packet_begin(REMCTL_SERIAL_TYPE_MEMREAD);
+            pkt->data[pkt->hdr.length++] = (unsigned char)( addr & 0xFF);
+            pkt->data[pkt->hdr.length++] = (unsigned char)((addr >> 8UL) & 0xFF);
+            pkt->data[pkt->hdr.length++] = (unsigned char)((addr >> 16UL) & 0xFF);
+            pkt->data[pkt->hdr.length++] = (unsigned char)((addr >> 24UL) & 0xFF);
+            pkt->data[pkt->hdr.length++] = (unsigned char)n;
+
+            if (win_packet_send(n) < 0) return -1;
+            asked += n;
+            addr += n;
+        }
+
+        rsp = win_complete(&user);
+        if (rsp == NULL) {
+            fprintf(stderr,"Failed to recv packet\n");
+            return -1;
+        }
+
+        if ((rsp->hdr.type & ~REMCTL_SERIAL_TYPE_PACKED) != REMCTL_SERIAL_TYPE_MEMREAD || rsp->hdr.length < 5 || rsp->data[4] != user) {
+            fprintf(stderr,"Memory read failed\n");
+            return -1;
+        }
+
+        if (rsp->hdr.type & REMCTL_SERIAL_TYPE_PACKED) {
+            if (remctl_unpack(tmp,user,rsp->data+5,rsp->hdr.length - 5U) != (int)user) {
+                fprintf(stderr,"Malformed packed data\n");
+                return -1;
+            }
+        }
+        else {
+            if (rsp->hdr.length < (5 + user)) {
+                fprintf(stderr,"Memory read failed\n");
+                return -1;
+            }
+
+            memcpy(tmp,rsp->data+5,user);
+        }
+
+        printf("\x0D" "Reading 0x%08lX + %u bytes",raddr,user);
+        fflush(stdout);
+
+        if (write(fd,tmp,user) != (int)user)
+            return -1;
+
+        raddr += user;
+        asked -= user;
+        sz -= user;
+    }
+
+    return 0;
+}
+
 int do_ping(void) {
     remctl_serial_packet_begin(&cur_pkt,REMCTL_SERIAL_TYPE_PING);
 
@@ -1667,6 +2234,17 @@ int main(int argc,char **argv) {
         }
 
         addr = memaddr;
+        if (win_size > 0 && win_negotiate(win_size) > 0) {
+            i = win_memdump(fd,addr,memsz) < 0;
+            if (win_end() < 0 || i) {
+                fprintf(stderr,"\nMemory dump failed\n");
+                close(fd);
+                return 1;
+            }
+
+            memsz = 0;
+        }
+
         while (memsz > 0) {
             if (memsz > 192)
                 do_read = 192;
@@ -1915,6 +2493,12 @@ int main(int argc,char **argv) {
             return 1;
 
         count = 0L;
+        if (win_size > 0 && win_negotiate(win_size) > 0) {
+            count = win_upload(ifd,file_size);
+            if (win_end() < 0 || count < 0L)
+                return 1;
+        }
+
         while (count < file_size) {
             now = time(NULL);
             if (now >= next) {
@@ -2006,6 +2590,12 @@ int main(int argc,char **argv) {
         if (do_file_seek(&data,0,0/*SEEK_SET*/) < 0)
             return 1;
 
+        if (win_size > 0 && win_negotiate(win_size) > 0) {
+            count = win_download(ofd,file_size);
+            if (win_end() < 0 || count < 0L)
+                return 1;
+        }
+
         while (count < file_size) {
             now = time(NULL);
             if (now >= next) {
@@ -28,6 +28,7 @@
 #include <hw/flatreal/flatreal.h>
 
 #include "proto.h"
+#include "winproto.h"
 
 #ifdef TARGET_PC98
 static struct uart_8251 *uart = NULL;
@@ -46,6 +47,7 @@ static unsigned char inside_int28 = 0;                              // if within
 static unsigned short my_resident_psp = 0;                          // nonzero if resident TSR, else we're still running
 static unsigned short saved_psp = 0;                                // if switched, switch back
 static unsigned char stop_bits = 1;
+static unsigned char win_max = REMCTL_SERIAL_WIN_MAX;               // largest window the client may negotiate
 
 static int open_file_fd = -1;                                       // currently open file
 
@@ -58,12 +60,18 @@ static unsigned char far *InDOS_ptr = NULL;                         // MS-DOS In
 static unsigned char far *DOS_LOL = NULL;                           // MS-DOS List of Lists (not funny)
 
 static struct remctl_serial_packet      cur_pkt_in = {0};
-static unsigned char                    cur_pkt_in_write = 0;       // from 0 to < sizeof(cur_pkt_in)
+static unsigned int                     cur_pkt_in_write = 0;       // from 0 to < sizeof(cur_pkt_in)
 static unsigned char                    cur_pkt_in_seq = 0xFF;
 
 static struct remctl_serial_packet      cur_pkt_out = {0};
-static unsigned char                    cur_pkt_out_write = 0;      // from 0 to < sizeof(cur_pkt_out)
+static unsigned int                     cur_pkt_out_write = 0;      // from 0 to < sizeof(cur_pkt_out)
 static unsigned char                    cur_pkt_out_seq = 0xFF;
+static unsigned char                    cur_pkt_out_win = 0;        // cur_pkt_out is a windowed mode packet (has CRC-16)
+
+/* windowed mode. requests are assembled in win_asm and queued in win, cur_pkt_in holds the one being executed */
+static struct remctl_win_srv            win;
+static struct remctl_serial_packet      win_asm = {0};
+static struct remctl_serial_packet*     cur_pkt_asm = &cur_pkt_in;  // where incoming bytes go, cur_pkt_in or win_asm
 
 #ifdef TARGET_PC98
 void pc98_uart_irq_update(void) {
@@ -86,6 +94,7 @@ void pc98_uart_irq_update(void) {
 void process_input(void);
 void process_output(void);
 void do_process_output(void);
+void win_pump(void);
 
 int uart_waiting_read = 0;
 int uart_waiting_write = 0;
@@ -382,6 +391,7 @@ void begin_output_packet(const unsigned char type) {
     cur_pkt_out.hdr.sequence = cur_pkt_out_seq;
     cur_pkt_out.hdr.type = type;
     cur_pkt_out.hdr.chksum = 0;
+    cur_pkt_out_win = 0;
 
     if (cur_pkt_out_seq == 0xFF)
         cur_pkt_out_seq = 0;
@@ -1268,6 +1278,14 @@ void handle_packet(void) {
 
             end_output_packet();
             break;
+        case REMCTL_SERIAL_TYPE_NEGOTIATE:
+            begin_output_packet(REMCTL_SERIAL_TYPE_NEGOTIATE);
+            cur_pkt_out.hdr.length = remctl_win_srv_negotiate(&win,cur_pkt_in.data,cur_pkt_in.hdr.length,win_max,cur_pkt_out.data);
+            end_output_packet();
+
+            /* this reply goes out stop and wait, the next request is windowed */
+            cur_pkt_asm = win.window != 0 ? &win_asm : &cur_pkt_in;
+            break;
         default:
             begin_output_packet(REMCTL_SERIAL_TYPE_ERROR);
             cur_pkt_out_seq = 0xFF;
@@ -1300,7 +1318,80 @@ int inpkt_validate(void) {
     return 1;
 }
 
+/* windowed mode: execute the next request in sequence if it is here, and load the next packet to send */
+void win_pump(void) {
+    struct remctl_serial_packet *p;
+
+    if (win.window == 0 || in_packet_handling || has_output())
+        return;
+
+    in_packet_handling = 1;
+    p = remctl_win_srv_output(&win);
+    if (p == NULL && (p = remctl_win_srv_request(&win)) != NULL) {
+        if ((p->hdr.type & 0x7F) == REMCTL_SERIAL_TYPE_FILE && !safe_to_use_msdos_fs_io()) {
+            /* instead of MSDOS_IS_BUSY, hold the request until INT 28h or the timer comes around when DOS is idle */
+            p = NULL;
+        }
+        else {
+            if (remctl_win_srv_unpack_request(p,&cur_pkt_in) < 0 || cur_pkt_in.hdr.type == REMCTL_SERIAL_TYPE_NEGOTIATE) {
+                begin_output_packet(REMCTL_SERIAL_TYPE_ERROR);
+                end_output_packet();
+            }
+            else if (cur_pkt_in.hdr.type == REMCTL_SERIAL_TYPE_FILE && cur_pkt_in.data[0] == REMCTL_SERIAL_TYPE_FILE_FIND) {
+                /* FIND answers with a stream of packets, stop and wait only */
+                begin_output_packet(REMCTL_SERIAL_TYPE_FILE);
+                cur_pkt_out.data[0] = REMCTL_SERIAL_TYPE_FILE_MSDOS_ERROR;
+                cur_pkt_out.hdr.length = 1;
+                end_output_packet();
+            }
+            else {
+                handle_packet();
+            }
+
+            remctl_win_srv_reply(&win,&cur_pkt_out);
+            cur_pkt_out.hdr.mark = 0;
+            p = remctl_win_srv_output(&win);
+        }
+    }
+
+    if (p != NULL) {
+        memcpy(&cur_pkt_out,p,remctl_serial_frame_size(&(p->hdr),1));
+        cur_pkt_out_write = 0;
+        cur_pkt_out_win = 1;
+    }
+
+    in_packet_handling = 0;
+}
+
 int process_input_packet(void) {
+    if (cur_pkt_asm == &win_asm) {
+        /* reentrancy protection: win_pump() may be executing a request */
+        if (in_packet_handling)
+            return -1;
+
+        if (win_asm.hdr.sequence == 0xFF) {
+            /* stop and wait packet: leave windowed mode and handle it the normal way below */
+            memcpy(&cur_pkt_in,&win_asm,sizeof(win_asm.hdr) + (size_t)win_asm.hdr.length);
+            cur_pkt_in_write = sizeof(cur_pkt_in.hdr) + (unsigned int)cur_pkt_in.hdr.length;
+            cur_pkt_asm = &cur_pkt_in;
+            remctl_win_srv_reset(&win);
+        }
+        else {
+            /* damaged packets are dropped, the client resends after the NAK or its timeout */
+            if (remctl_win_crc_ok(&win_asm))
+                remctl_win_srv_receive(&win,&win_asm);
+
+            win_asm.hdr.mark = 0;
+            cur_pkt_in_write = 0;
+            win_pump();
+            process_output();
+#ifdef TARGET_PC98
+            pc98_uart_irq_update();
+#endif
+            return 0;
+        }
+    }
+
     /* we can't generate a new packet until the current output packet is finished sending */
     if (cur_pkt_out.hdr.mark == REMCTL_SERIAL_MARK)
         return -1;
@@ -1330,8 +1421,18 @@ int process_input_packet(void) {
     return 0;
 }
 
+/* nonzero once the packet being assembled is complete */
+static int inpkt_complete(void) {
+    if (cur_pkt_in_write < sizeof(cur_pkt_asm->hdr))
+        return 0;
+
+    return cur_pkt_in_write >= remctl_serial_frame_size(&(cur_pkt_asm->hdr),cur_pkt_asm == &win_asm);
+}
+
 void process_input(void) {
-    if (cur_pkt_in_write >= (sizeof(cur_pkt_in.hdr)+cur_pkt_in.hdr.length)) {
+    win_pump();
+
+    if (inpkt_complete()) {
         if (process_input_packet() < 0)
             return;
     }
@@ -1341,18 +1442,26 @@ void process_input(void) {
         if (!uart_8251_rxready(uart))
             break;
 
-        ((unsigned char*)(&cur_pkt_in))[cur_pkt_in_write] = uart_8251_read(uart);
+        ((unsigned char*)cur_pkt_asm)[cur_pkt_in_write] = uart_8251_read(uart);
 #else
         if (!uart_8250_can_read(uart))
             break;
 
-        ((unsigned char*)(&cur_pkt_in))[cur_pkt_in_write] = uart_8250_read(uart);
+        ((unsigned char*)cur_pkt_asm)[cur_pkt_in_write] = uart_8250_read(uart);
 #endif
 
-        if (cur_pkt_in_write == 0 && cur_pkt_in.hdr.mark != REMCTL_SERIAL_MARK)
+        if (cur_pkt_in_write == 0 && cur_pkt_asm->hdr.mark != REMCTL_SERIAL_MARK)
             continue;
 
-        if ((++cur_pkt_in_write) >= (sizeof(cur_pkt_in.hdr)+cur_pkt_in.hdr.length)) {
+        /* windowed mode: a bad header means we're not in sync, look for the next mark */
+        if ((++cur_pkt_in_write) == sizeof(cur_pkt_asm->hdr) && cur_pkt_asm == &win_asm &&
+            win_asm.hdr.sequence != 0xFF && !remctl_win_header_ok(&(win_asm.hdr))) {
+            win_asm.hdr.mark = 0;
+            cur_pkt_in_write = 0;
+            continue;
+        }
+
+        if (inpkt_complete()) {
             if (process_input_packet() < 0)
                 break;
         }
@@ -1364,6 +1473,7 @@ void process_output(void) {
     if (in_packet_handling)
         return;
 
+    win_pump();
     do_process_output();
 }
 
@@ -1388,10 +1498,14 @@ void do_process_output(void) {
 
         uart_8250_write(uart,((unsigned char*)(&cur_pkt_out))[cur_pkt_out_write]);
 #endif
-        if ((++cur_pkt_out_write) >= (sizeof(cur_pkt_out.hdr)+cur_pkt_out.hdr.length)) {
+        if ((++cur_pkt_out_write) >= remctl_serial_frame_size(&cur_pkt_out.hdr,cur_pkt_out_win)) {
             cur_pkt_out_write = 0;
             cur_pkt_out.hdr.mark = 0;
-            break;
+
+            /* windowed mode: keep the transmitter busy with the next reply */
+            win_pump();
+            if (!has_output())
+                break;
         }
     } while (1);
 }
@@ -1581,6 +1695,7 @@ void help(void) {
     fprintf(stderr,"                         (for slow machines use 8000-16000)\n");
     fprintf(stderr,"  -p <n>                 COM port (1 to 4)\n");
     fprintf(stderr,"  -tsr                   Immediately exit as a TSR\n");
+    fprintf(stderr,"  -win <n>               Max window for windowed transfers (0 to %u, default %u)\n",REMCTL_SERIAL_WIN_MAX,REMCTL_SERIAL_WIN_MAX);
 }
 
 int parse_argv(int argc,char **argv) {
@@ -1628,6 +1743,12 @@ int parse_argv(int argc,char **argv) {
                 if (a == NULL) return 1;
                 baud_rate = strtoul(a,NULL,0);
             }
+            else if (!strcmp(a,"win")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                win_max = (unsigned char)strtoul(a,NULL,0);
+                if (win_max > REMCTL_SERIAL_WIN_MAX) win_max = REMCTL_SERIAL_WIN_MAX;
+            }
             else {
                 fprintf(stderr,"Unknown switch %s\n",a);
                 return 1;
@@ -0,0 +1,663 @@
+/* Host stand-in for REMSRV, to test the serial protocol without a DOS machine.
+ *
+ * Serves a pseudo terminal (prints the /dev/pts/N path to give to remctlclient -s) or a serial port.
+ * Memory is a fake 1MB+64KB address space, files are under -root. Line speed, latency and damaged
+ * or lost packets can be simulated so that stop and wait and windowed mode can be compared.
+ *
+ * WARNING: For host systems only, not for DOS */
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <termios.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <poll.h>
+#include <time.h>
+
+#include "proto.h"
+#include "winproto.h"
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+#define MEM_SIZE                0x10FFF0UL  /* FFFF:FFFF + 1 */
+
+static char*            serial_tty = NULL;
+static const char*      root_dir = ".";
+static long             baud_rate = 0;          /* 0 = as fast as the pty goes */
+static double           latency = 0;            /* one way line latency, seconds */
+static unsigned char    win_max = REMCTL_SERIAL_WIN_MAX;
+static unsigned int     drop_every = 0;         /* lose every Nth windowed packet, each way */
+static unsigned int     corrupt_every = 0;      /* damage one byte of every Nth windowed packet, each way */
+static int              debug = 0;
+
+static int              conn_fd = -1;
+static int              slave_fd = -1;          /* pty slave kept open so the master survives client restarts */
+static unsigned char*   memory = NULL;
+static int              open_file_fd = -1;
+
+static struct remctl_serial_packet      cur_pkt_in;
+static unsigned int                     cur_pkt_in_write = 0;
+static unsigned char                    cur_pkt_in_seq = 0xFF;
+
+static struct remctl_serial_packet      cur_pkt_out;
+static unsigned char                    cur_pkt_out_seq = 0xFF;
+
+/* windowed mode, same as REMSRV */
+static struct remctl_win_srv            win;
+static struct remctl_serial_packet      win_asm;
+static struct remctl_serial_packet*     cur_pkt_asm = &cur_pkt_in;
+
+static unsigned long                    rx_frames = 0,tx_frames = 0;
+
+/* the simulated line. bytes in both directions are queued with the time they come out the other end */
+struct line_queue {
+    unsigned char       data[65536];
+    double              due[65536];
+    unsigned int        head,tail;
+    double              next;                   /* when the line is free for the next byte */
+};
+
+static struct line_queue rxq,txq;
+
+static void help(void) {
+    fprintf(stderr,"remsrvhost [options]\n");
+    fprintf(stderr,"Host stand-in for the REMSRV DOS remote control server.\n");
+    fprintf(stderr,"  -h --help         Show this help\n");
+    fprintf(stderr,"  -s <dev>          Serve on serial port device (default: new pseudo terminal)\n");
+    fprintf(stderr,"  -root <dir>       Directory that DOS paths refer to (default: current)\n");
+    fprintf(stderr,"  -b <rate>         Simulate line speed (10 bits per byte)\n");
+    fprintf(stderr,"  -lat <ms>         Simulate one way line latency\n");
+    fprintf(stderr,"  -win <n>          Max window for windowed mode (0 to %u)\n",REMCTL_SERIAL_WIN_MAX);
+    fprintf(stderr,"  -drop <n>         Lose every Nth windowed packet each way\n");
+    fprintf(stderr,"  -corrupt <n>      Damage every Nth windowed packet each way\n");
+    fprintf(stderr,"  -d                Debug (dump packets)\n");
+}
+
+static int parse_argv(int argc,char **argv) {
+    char *a;
+    int i=1;
+
+    while (i < argc) {
+        a = argv[i++];
+
+        if (*a == '-') {
+            do { a++; } while (*a == '-');
+
+            if (!strcmp(a,"h") || !strcmp(a,"help")) {
+                help();
+                return 1;
+            }
+            else if (!strcmp(a,"s")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                serial_tty = a;
+            }
+            else if (!strcmp(a,"root")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                root_dir = a;
+            }
+            else if (!strcmp(a,"b")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                baud_rate = strtol(a,NULL,0);
+            }
+            else if (!strcmp(a,"lat")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                latency = atof(a) / 1000.0;
+            }
+            else if (!strcmp(a,"win")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                win_max = (unsigned char)atoi(a);
+                if (win_max > REMCTL_SERIAL_WIN_MAX) win_max = REMCTL_SERIAL_WIN_MAX;
+            }
+            else if (!strcmp(a,"drop")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                drop_every = (unsigned int)atoi(a);
+            }
+            else if (!strcmp(a,"corrupt")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                corrupt_every = (unsigned int)atoi(a);
+            }
+            else if (!strcmp(a,"d")) {
+                debug = 1;
+            }
+            else {
+                fprintf(stderr,"Unknown switch %s\n",a);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr,"Unexpected argv\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static double byte_time(void) {
+    return baud_rate > 0 ? 10.0 / (double)baud_rate : 0;
+}
+
+static unsigned int line_queue_count(const struct line_queue * const q) {
+    return (q->tail - q->head) & 0xFFFFU;
+}
+
+static void line_queue_put(struct line_queue * const q,const unsigned char c,const double now) {
+    if (line_queue_count(q) >= 0xFFFFU) return;
+
+    if (q->next < now) q->next = now;
+    q->next += byte_time();
+    q->data[q->tail] = c;
+    q->due[q->tail] = q->next + latency;
+    q->tail = (q->tail + 1U) & 0xFFFFU;
+}
+
+static int line_queue_ready(const struct line_queue * const q,const double now) {
+    return q->head != q->tail && q->due[q->head] <= now;
+}
+
+static unsigned char line_queue_get(struct line_queue * const q) {
+    unsigned char c = q->data[q->head];
+
+    q->head = (q->head + 1U) & 0xFFFFU;
+    return c;
+}
+
+static void dump_packet(const char *what,const struct remctl_serial_packet * const pkt) {
+    unsigned int i;
+
+    fprintf(stderr,"%s: length=%u sequence=%u type=0x%02x('%c')",what,pkt->hdr.length,pkt->hdr.sequence,pkt->hdr.type,pkt->hdr.type & 0x7F);
+    for (i=0;i < pkt->hdr.length && i < 16;i++) fprintf(stderr," %02x",pkt->data[i]);
+    fprintf(stderr,"%s\n",pkt->hdr.length > 16 ? "..." : "");
+}
+
+/* nonzero if this windowed packet is to be lost or damaged on its way */
+static int fault_inject(struct remctl_serial_packet * const pkt,unsigned long * const frames) {
+    (*frames)++;
+
+    if (drop_every != 0 && (*frames % drop_every) == 0) {
+        if (debug) fprintf(stderr,"(dropped packet sequence %u)\n",pkt->hdr.sequence);
+        return 1;
+    }
+    if (corrupt_every != 0 && (*frames % corrupt_every) == (corrupt_every / 2U)) {
+        if (debug) fprintf(stderr,"(damaged packet sequence %u)\n",pkt->hdr.sequence);
+        if (pkt->hdr.length != 0)
+            pkt->data[*frames % pkt->hdr.length] ^= 0x10;
+        else
+            pkt->hdr.type ^= 0x10;
+    }
+
+    return 0;
+}
+
+static void send_frame(struct remctl_serial_packet *pkt,const int windowed) {
+    struct remctl_serial_packet tmp;
+    unsigned int i,sz;
+    double now;
+
+    if (debug) dump_packet("Send",pkt);
+
+    sz = remctl_serial_frame_size(&pkt->hdr,windowed);
+    memcpy(&tmp,pkt,sz);
+    if (windowed && fault_inject(&tmp,&tx_frames))
+        return;
+
+    now = now_sec();
+    for (i=0;i < sz;i++)
+        line_queue_put(&txq,((unsigned char*)(&tmp))[i],now);
+}
+
+static void begin_output_packet(const unsigned char type) {
+    cur_pkt_out.hdr.mark = REMCTL_SERIAL_MARK;
+    cur_pkt_out.hdr.length = 0;
+    cur_pkt_out.hdr.sequence = cur_pkt_out_seq;
+    cur_pkt_out.hdr.type = type;
+    cur_pkt_out.hdr.chksum = 0;
+
+    if (cur_pkt_out_seq == 0xFF)
+        cur_pkt_out_seq = 0;
+    else
+        cur_pkt_out_seq = (cur_pkt_out_seq + 1) & 0x7F;
+}
+
+static void end_output_packet(void) {
+    unsigned char sum = 0;
+    unsigned int i;
+
+    for (i=0;i < cur_pkt_out.hdr.length;i++)
+        sum += cur_pkt_out.data[i];
+
+    cur_pkt_out.hdr.chksum = 0x100 - sum;
+}
+
+static unsigned long le32(const unsigned char *p) {
+    return (unsigned long)p[0] + ((unsigned long)p[1] << 8UL) + ((unsigned long)p[2] << 16UL) + ((unsigned long)p[3] << 24UL);
+}
+
+/* C:\DIR\FILE.TXT -> <root>/dir/file.txt */
+static void dos_path_to_host(char *dst,const size_t dstmax,const unsigned char *src,const unsigned int len) {
+    size_t o;
+    unsigned int i = 0;
+
+    if (len >= 2 && src[1] == ':') i = 2;
+
+    o = (size_t)snprintf(dst,dstmax,"%s/",root_dir);
+    for (;i < len && src[i] != 0 && (o+1) < dstmax;i++) {
+        if (src[i] == '\\' || src[i] == '/') {
+            if (o != 0 && dst[o-1] == '/') continue;
+            dst[o++] = '/';
+        }
+        else {
+            dst[o++] = (char)tolower(src[i]);
+        }
+    }
+    dst[o] = 0;
+}
+
+static void file_error(void) {
+    cur_pkt_out.data[0] = REMCTL_SERIAL_TYPE_FILE_MSDOS_ERROR;
+    cur_pkt_out.hdr.length = 1;
+}
+
+static void do_file_command(void) {
+    char path[512];
+    off_t o;
+    int n;
+
+    switch (cur_pkt_in.data[0]) {
+        case REMCTL_SERIAL_TYPE_FILE_OPEN:
+        case REMCTL_SERIAL_TYPE_FILE_CREATE:
+            if (open_file_fd >= 0) {
+                close(open_file_fd);
+                open_file_fd = -1;
+            }
+
+            dos_path_to_host(path,sizeof(path),cur_pkt_in.data+1,cur_pkt_in.hdr.length-1);
+            if (cur_pkt_in.data[0] == REMCTL_SERIAL_TYPE_FILE_CREATE)
+                open_file_fd = open(path,O_RDWR|O_CREAT|O_TRUNC|O_BINARY,0644);
+            else
+                open_file_fd = open(path,O_RDWR|O_BINARY);
+
+            if (open_file_fd < 0) file_error();
+            break;
+        case REMCTL_SERIAL_TYPE_FILE_CLOSE:
+            if (open_file_fd >= 0) {
+                close(open_file_fd);
+                open_file_fd = -1;
+            }
+            else {
+                file_error();
+            }
+            break;
+        case REMCTL_SERIAL_TYPE_FILE_SEEK:
+            if (open_file_fd < 0 || cur_pkt_in.data[1] > 2) {
+                file_error();
+                break;
+            }
+
+            o = lseek(open_file_fd,(off_t)((long)le32(cur_pkt_in.data+2)),cur_pkt_in.data[1] == 2 ? SEEK_END : (cur_pkt_in.data[1] == 1 ? SEEK_CUR : SEEK_SET));
+            if (o < 0) {
+                file_error();
+                break;
+            }
+
+            cur_pkt_out.data[2] = (unsigned char)(o >> 0UL);
+            cur_pkt_out.data[3] = (unsigned char)(o >> 8UL);
+            cur_pkt_out.data[4] = (unsigned char)(o >> 16UL);
+            cur_pkt_out.data[5] = (unsigned char)(o >> 24UL);
+            cur_pkt_out.hdr.length = 6;
+            break;
+        case REMCTL_SERIAL_TYPE_FILE_READ:
+            n = open_file_fd >= 0 ? (int)read(open_file_fd,cur_pkt_out.data+2,cur_pkt_in.data[1] > 252 ? 252 : cur_pkt_in.data[1]) : -1;
+            if (n < 0) {
+                file_error();
+                break;
+            }
+
+            cur_pkt_out.data[1] = (unsigned char)n;
+            cur_pkt_out.hdr.length = 2 + n;
+            break;
+        case REMCTL_SERIAL_TYPE_FILE_WRITE:
+            n = open_file_fd >= 0 ? (int)write(open_file_fd,cur_pkt_in.data+2,cur_pkt_in.data[1]) : -1;
+            if (n < 0) {
+                file_error();
+                break;
+            }
+
+            cur_pkt_out.data[1] = (unsigned char)n;
+            cur_pkt_out.hdr.length = 2;
+            break;
+        case REMCTL_SERIAL_TYPE_FILE_TRUNCATE:
+            if (open_file_fd < 0 || (o=lseek(open_file_fd,0,SEEK_CUR)) < 0 || ftruncate(open_file_fd,o) < 0)
+                file_error();
+            break;
+        default:
+            file_error();
+            break;
+    }
+}
+
+static void handle_packet(void) {
+    unsigned long memaddr;
+    unsigned int i;
+
+    switch (cur_pkt_in.hdr.type) {
+        case REMCTL_SERIAL_TYPE_PING:
+            begin_output_packet(REMCTL_SERIAL_TYPE_PING);
+            memcpy(cur_pkt_out.data,"PING",4);
+            cur_pkt_out.hdr.length = 4;
+            end_output_packet();
+            break;
+        case REMCTL_SERIAL_TYPE_HALT:
+            begin_output_packet(REMCTL_SERIAL_TYPE_HALT);
+            cur_pkt_out.data[0] = cur_pkt_in.data[0];
+            cur_pkt_out.hdr.length = 1;
+            end_output_packet();
+            break;
+        case REMCTL_SERIAL_TYPE_MEMREAD:
+        case REMCTL_SERIAL_TYPE_MEMWRITE:
+            begin_output_packet(cur_pkt_in.hdr.type);
+            memcpy(cur_pkt_out.data,cur_pkt_in.data,8/*big enough*/);
+            cur_pkt_out.hdr.length = 5;
+
+            if (cur_pkt_in.data[4] != 0 && cur_pkt_in.data[4] <= 192) {
+                memaddr = le32(cur_pkt_in.data);
+
+                if (cur_pkt_in.hdr.type == REMCTL_SERIAL_TYPE_MEMREAD) {
+                    cur_pkt_out.hdr.length = 5 + (unsigned int)cur_pkt_in.data[4];
+                    for (i=0;i < cur_pkt_in.data[4];i++)
+                        cur_pkt_out.data[5+i] = (memaddr+i) < MEM_SIZE ? memory[memaddr+i] : 'F';
+                }
+                else {
+                    for (i=0;i < cur_pkt_in.data[4];i++) {
+                        if ((memaddr+i) < MEM_SIZE) memory[memaddr+i] = cur_pkt_in.data[5+i];
+                    }
+                }
+            }
+
+            end_output_packet();
+            break;
+        case REMCTL_SERIAL_TYPE_FILE:
+            begin_output_packet(REMCTL_SERIAL_TYPE_FILE);
+            memcpy(cur_pkt_out.data,cur_pkt_in.data,8/*big enough*/);
+            cur_pkt_out.hdr.length = 1;
+            do_file_command();
+            end_output_packet();
+            break;
+        case REMCTL_SERIAL_TYPE_NEGOTIATE:
+            begin_output_packet(REMCTL_SERIAL_TYPE_NEGOTIATE);
+            cur_pkt_out.hdr.length = remctl_win_srv_negotiate(&win,cur_pkt_in.data,cur_pkt_in.hdr.length,win_max,cur_pkt_out.data);
+            end_output_packet();
+
+            /* this reply goes out stop and wait, the next request is windowed */
+            cur_pkt_asm = win.window != 0 ? &win_asm : &cur_pkt_in;
+            if (debug) fprintf(stderr,"Window now %u flags 0x%02x\n",win.window,win.flags);
+            break;
+        default:
+            begin_output_packet(REMCTL_SERIAL_TYPE_ERROR);
+            cur_pkt_out_seq = 0xFF;
+            end_output_packet();
+            break;
+    }
+}
+
+static int inpkt_validate(void) {
+    unsigned char sum = cur_pkt_in.hdr.chksum;
+    unsigned int i;
+
+    for (i=0;i < cur_pkt_in.hdr.length;i++)
+        sum += cur_pkt_in.data[i];
+    if (sum != 0)
+        return 0;
+
+    if (cur_pkt_in.hdr.sequence == 0xFF)
+        cur_pkt_in_seq = cur_pkt_in.hdr.sequence;
+    else if (cur_pkt_in.hdr.sequence != cur_pkt_in_seq)
+        return 0;
+
+    cur_pkt_in_seq = (cur_pkt_in.hdr.sequence + 1) & 0x7F;
+    return 1;
+}
+
+/* windowed mode: execute requests in order as they become available, send NAKs and replies */
+static void win_pump(void) {
+    struct remctl_serial_packet *p;
+
+    while (win.window != 0) {
+        p = remctl_win_srv_output(&win);
+        if (p == NULL && (p = remctl_win_srv_request(&win)) != NULL) {
+            if (remctl_win_srv_unpack_request(p,&cur_pkt_in) < 0 || cur_pkt_in.hdr.type == REMCTL_SERIAL_TYPE_NEGOTIATE) {
+                begin_output_packet(REMCTL_SERIAL_TYPE_ERROR);
+                end_output_packet();
+            }
+            else {
+                if (debug) dump_packet("Execute",&cur_pkt_in);
+                handle_packet();
+            }
+
+            remctl_win_srv_reply(&win,&cur_pkt_out);
+            p = remctl_win_srv_output(&win);
+        }
+
+        if (p == NULL)
+            break;
+
+        send_frame(p,1);
+    }
+}
+
+static void process_input_packet(void) {
+    if (cur_pkt_asm == &win_asm) {
+        if (win_asm.hdr.sequence == 0xFF) {
+            /* stop and wait packet: leave windowed mode and handle it the normal way below */
+            memcpy(&cur_pkt_in,&win_asm,sizeof(win_asm.hdr) + (size_t)win_asm.hdr.length);
+            cur_pkt_asm = &cur_pkt_in;
+            remctl_win_srv_reset(&win);
+        }
+        else {
+            if (fault_inject(&win_asm,&rx_frames)) {
+                /* lost */
+            }
+            else if (remctl_win_crc_ok(&win_asm)) {
+                if (debug) dump_packet("Recv",&win_asm);
+                remctl_win_srv_receive(&win,&win_asm);
+            }
+            else if (debug) {
+                fprintf(stderr,"Dropped packet sequence %u, bad CRC\n",win_asm.hdr.sequence);
+            }
+
+            win_pump();
+            return;
+        }
+    }
+
+    if (debug) dump_packet("Recv",&cur_pkt_in);
+
+    if (inpkt_validate()) {
+        handle_packet();
+    }
+    else {
+        begin_output_packet(REMCTL_SERIAL_TYPE_ERROR);
+        cur_pkt_out_seq = 0xFF;
+        end_output_packet();
+    }
+
+    send_frame(&cur_pkt_out,0);
+}
+
+static void process_input_byte(const unsigned char c) {
+    ((unsigned char*)cur_pkt_asm)[cur_pkt_in_write] = c;
+    if (cur_pkt_in_write == 0 && cur_pkt_asm->hdr.mark != REMCTL_SERIAL_MARK)
+        return;
+
+    /* windowed mode: a bad header means we're not in sync, look for the next mark */
+    if ((++cur_pkt_in_write) == sizeof(cur_pkt_asm->hdr) && cur_pkt_asm == &win_asm &&
+        win_asm.hdr.sequence != 0xFF && !remctl_win_header_ok(&(win_asm.hdr))) {
+        cur_pkt_in_write = 0;
+        return;
+    }
+
+    if (cur_pkt_in_write >= sizeof(cur_pkt_asm->hdr) &&
+        cur_pkt_in_write >= remctl_serial_frame_size(&(cur_pkt_asm->hdr),cur_pkt_asm == &win_asm)) {
+        cur_pkt_in_write = 0;
+        process_input_packet();
+    }
+}
+
+static int open_line(void) {
+    struct termios tios;
+    int fd;
+
+    if (serial_tty != NULL) {
+        conn_fd = open(serial_tty,O_RDWR|O_NOCTTY);
+        if (conn_fd < 0) {
+            fprintf(stderr,"open() failed, %s\n",strerror(errno));
+            return -1;
+        }
+
+        if (tcgetattr(conn_fd,&tios) == 0) {
+            cfmakeraw(&tios);
+            tcsetattr(conn_fd,TCSANOW,&tios);
+        }
+    }
+    else {
+        conn_fd = posix_openpt(O_RDWR|O_NOCTTY);
+        if (conn_fd < 0 || grantpt(conn_fd) < 0 || unlockpt(conn_fd) < 0) {
+            fprintf(stderr,"Cannot create pseudo terminal, %s\n",strerror(errno));
+            return -1;
+        }
+
+        /* raw from the start, the client can be started any time */
+        fd = open(ptsname(conn_fd),O_RDWR|O_NOCTTY);
+        if (fd < 0 || tcgetattr(fd,&tios) < 0) {
+            fprintf(stderr,"Cannot open pseudo terminal slave, %s\n",strerror(errno));
+            return -1;
+        }
+        cfmakeraw(&tios);
+        tcsetattr(fd,TCSANOW,&tios);
+        slave_fd = fd;
+
+        printf("%s\n",ptsname(conn_fd));
+        fflush(stdout);
+    }
+
+    fcntl(conn_fd,F_SETFL,fcntl(conn_fd,F_GETFL) | O_NONBLOCK);
+    return 0;
+}
+
+static void init_memory(void) {
+    unsigned long a,r = 0x12345678UL;
+
+    memory = malloc(MEM_SIZE);
+    if (memory == NULL) return;
+
+    /* something like a real PC: long runs of zeros (free conventional memory), FFs (empty
+     * adapter ROM space), text, and random looking code/data in between */
+    for (a=0;a < MEM_SIZE;a++) {
+        r = (r * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+        switch ((a >> 12UL) & 7UL) {
+            case 0: case 1: case 2:
+                memory[a] = 0x00;
+                break;
+            case 3:
+                memory[a] = 0xFF;
+                break;
+            case 4:
+                memory[a] = "REMSRVHOST "[a % 11UL];
+                break;
+            default:
+                memory[a] = (unsigned char)(r >> 16UL);
+                break;
+        }
+    }
+}
+
+int main(int argc,char **argv) {
+    unsigned char tmp[4096];
+    struct pollfd pfd;
+    int i,rd,timeout;
+    double now;
+
+    if (parse_argv(argc,argv))
+        return 1;
+
+    init_memory();
+    if (memory == NULL)
+        return 1;
+
+    remctl_win_srv_reset(&win);
+    if (open_line() < 0)
+        return 1;
+
+    do {
+        now = now_sec();
+
+        /* whatever the line has delivered by now */
+        while (line_queue_ready(&rxq,now))
+            process_input_byte(line_queue_get(&rxq));
+
+        i = 0;
+        while (line_queue_ready(&txq,now) && i < (int)sizeof(tmp))
+            tmp[i++] = line_queue_get(&txq);
+        if (i > 0 && write(conn_fd,tmp,(size_t)i) != i) {
+            fprintf(stderr,"Write failed, %s\n",strerror(errno));
+            break;
+        }
+
+        /* sleep until the next byte is due, or input */
+        timeout = 100;
+        if (rxq.head != rxq.tail) {
+            rd = (int)((rxq.due[rxq.head] - now) * 1000.0);
+            if (timeout > rd) timeout = rd;
+        }
+        if (txq.head != txq.tail) {
+            rd = (int)((txq.due[txq.head] - now) * 1000.0);
+            if (timeout > rd) timeout = rd;
+        }
+        if (timeout < 0) timeout = 0;
+
+        pfd.fd = conn_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd,1,timeout) > 0 && (pfd.revents & POLLIN)) {
+            rd = (int)read(conn_fd,tmp,sizeof(tmp));
+            if (rd < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EIO) {
+                fprintf(stderr,"Read failed, %s\n",strerror(errno));
+                break;
+            }
+
+            now = now_sec();
+            for (i=0;i < rd;i++)
+                line_queue_put(&rxq,tmp[i],now);
+        }
+    } while (1);
+
+    if (slave_fd >= 0) close(slave_fd);
+    close(conn_fd);
+    return 0;
+}
@@ -0,0 +1,304 @@
+/* windowed mode of the remctl serial protocol. see winproto.h */
+
+#include <string.h>
+
+#include "winproto.h"
+
+/* CRC-16 CCITT (polynomial 0x1021), table driven so that the 8088 in the ISR can keep up at 115200 */
+static const unsigned short remctl_crc16_table[256] = {
+    0x0000,0x1021,0x2042,0x3063,0x4084,0x50A5,0x60C6,0x70E7,
+    0x8108,0x9129,0xA14A,0xB16B,0xC18C,0xD1AD,0xE1CE,0xF1EF,
+    0x1231,0x0210,0x3273,0x2252,0x52B5,0x4294,0x72F7,0x62D6,
+    0x9339,0x8318,0xB37B,0xA35A,0xD3BD,0xC39C,0xF3FF,0xE3DE,
+    0x2462,0x3443,0x0420,0x1401,0x64E6,0x74C7,0x44A4,0x5485,
+    0xA56A,0xB54B,0x8528,0x9509,0xE5EE,0xF5CF,0xC5AC,0xD58D,
+    0x3653,0x2672,0x1611,0x0630,0x76D7,0x66F6,0x5695,0x46B4,
+    0xB75B,0xA77A,0x9719,0x8738,0xF7DF,0xE7FE,0xD79D,0xC7BC,
+    0x48C4,0x58E5,0x6886,0x78A7,0x0840,0x1861,0x2802,0x3823,
+    0xC9CC,0xD9ED,0xE98E,0xF9AF,0x8948,0x9969,0xA90A,0xB92B,
+    0x5AF5,0x4AD4,0x7AB7,0x6A96,0x1A71,0x0A50,0x3A33,0x2A12,
+    0xDBFD,0xCBDC,0xFBBF,0xEB9E,0x9B79,0x8B58,0xBB3B,0xAB1A,
+    0x6CA6,0x7C87,0x4CE4,0x5CC5,0x2C22,0x3C03,0x0C60,0x1C41,
+    0xEDAE,0xFD8F,0xCDEC,0xDDCD,0xAD2A,0xBD0B,0x8D68,0x9D49,
+    0x7E97,0x6EB6,0x5ED5,0x4EF4,0x3E13,0x2E32,0x1E51,0x0E70,
+    0xFF9F,0xEFBE,0xDFDD,0xCFFC,0xBF1B,0xAF3A,0x9F59,0x8F78,
+    0x9188,0x81A9,0xB1CA,0xA1EB,0xD10C,0xC12D,0xF14E,0xE16F,
+    0x1080,0x00A1,0x30C2,0x20E3,0x5004,0x4025,0x7046,0x6067,
+    0x83B9,0x9398,0xA3FB,0xB3DA,0xC33D,0xD31C,0xE37F,0xF35E,
+    0x02B1,0x1290,0x22F3,0x32D2,0x4235,0x5214,0x6277,0x7256,
+    0xB5EA,0xA5CB,0x95A8,0x8589,0xF56E,0xE54F,0xD52C,0xC50D,
+    0x34E2,0x24C3,0x14A0,0x0481,0x7466,0x6447,0x5424,0x4405,
+    0xA7DB,0xB7FA,0x8799,0x97B8,0xE75F,0xF77E,0xC71D,0xD73C,
+    0x26D3,0x36F2,0x0691,0x16B0,0x6657,0x7676,0x4615,0x5634,
+    0xD94C,0xC96D,0xF90E,0xE92F,0x99C8,0x89E9,0xB98A,0xA9AB,
+    0x5844,0x4865,0x7806,0x6827,0x18C0,0x08E1,0x3882,0x28A3,
+    0xCB7D,0xDB5C,0xEB3F,0xFB1E,0x8BF9,0x9BD8,0xABBB,0xBB9A,
+    0x4A75,0x5A54,0x6A37,0x7A16,0x0AF1,0x1AD0,0x2AB3,0x3A92,
+    0xFD2E,0xED0F,0xDD6C,0xCD4D,0xBDAA,0xAD8B,0x9DE8,0x8DC9,
+    0x7C26,0x6C07,0x5C64,0x4C45,0x3CA2,0x2C83,0x1CE0,0x0CC1,
+    0xEF1F,0xFF3E,0xCF5D,0xDF7C,0xAF9B,0xBFBA,0x8FD9,0x9FF8,
+    0x6E17,0x7E36,0x4E55,0x5E74,0x2E93,0x3EB2,0x0ED1,0x1EF0
+};
+
+unsigned short remctl_crc16(unsigned short crc,const unsigned char *p,unsigned int len) {
+    while (len-- != 0U)
+        crc = (unsigned short)(crc << 8U) ^ remctl_crc16_table[(unsigned char)(crc >> 8U) ^ *p++];
+
+    return crc;
+}
+
+unsigned int remctl_serial_frame_size(const struct remctl_serial_packet_header * const hdr,const unsigned char window) {
+    unsigned int sz = sizeof(*hdr) + (unsigned int)hdr->length;
+
+    if (window != 0 && hdr->sequence != 0xFF)
+        sz += 2; /* CRC-16 */
+
+    return sz;
+}
+
+void remctl_win_seal(struct remctl_serial_packet * const pkt) {
+    unsigned short crc;
+
+    pkt->hdr.mark = REMCTL_SERIAL_MARK;
+    pkt->hdr.chksum = (unsigned char)(0x100U - ((pkt->hdr.length + pkt->hdr.sequence + pkt->hdr.type) & 0xFFU));
+
+    crc = remctl_crc16(0xFFFFU,&(pkt->hdr.length),3); /* length, sequence, type */
+    crc = remctl_crc16(crc,pkt->data,pkt->hdr.length);
+    pkt->data[pkt->hdr.length] = (unsigned char)(crc & 0xFFU);
+    pkt->data[pkt->hdr.length+1U] = (unsigned char)(crc >> 8U);
+}
+
+int remctl_win_header_ok(const struct remctl_serial_packet_header * const hdr) {
+    if (hdr->length > REMCTL_SERIAL_WIN_MAX_LENGTH)
+        return 0;
+    if (((hdr->length + hdr->sequence + hdr->type + hdr->chksum) & 0xFFU) != 0U)
+        return 0;
+
+    return 1;
+}
+
+int remctl_win_crc_ok(const struct remctl_serial_packet * const pkt) {
+    unsigned short crc;
+
+    if (!remctl_win_header_ok(&(pkt->hdr)))
+        return 0;
+
+    crc = remctl_crc16(0xFFFFU,&(pkt->hdr.length),3);
+    crc = remctl_crc16(crc,pkt->data,pkt->hdr.length);
+    return (pkt->data[pkt->hdr.length] == (unsigned char)(crc & 0xFFU) &&
+            pkt->data[pkt->hdr.length+1U] == (unsigned char)(crc >> 8U));
+}
+
+/* PackBits: control byte n = 0..127 copies n+1 literal bytes, n = 129..255 repeats the next byte
+ * 257-n times, 128 is unused. cheap to undo on an 8088, and memory is mostly runs of 00 or FF */
+unsigned int remctl_pack(unsigned char *dst,unsigned int dstmax,const unsigned char *src,unsigned int len) {
+    unsigned int i = 0,o = 0,run,lit;
+
+    while (i < len) {
+        run = 1;
+        while ((i+run) < len && run < 128U && src[i+run] == src[i]) run++;
+
+        if (run >= 3U) {
+            if ((o+2U) > dstmax) return 0;
+            dst[o++] = (unsigned char)(257U - run);
+            dst[o++] = src[i];
+            i += run;
+        }
+        else {
+            /* literal up to the next run of 3 or more */
+            lit = 0;
+            while ((i+lit) < len && lit < 128U) {
+                if ((i+lit+2U) < len && src[i+lit] == src[i+lit+1U] && src[i+lit] == src[i+lit+2U])
+                    break;
+                lit++;
+            }
+
+            if ((o+1U+lit) > dstmax) return 0;
+            dst[o++] = (unsigned char)(lit - 1U);
+            memcpy(dst+o,src+i,lit);
+            o += lit;
+            i += lit;
+        }
+    }
+
+    return o;
+}
+
+int remctl_unpack(unsigned char *dst,unsigned int dstmax,const unsigned char *src,unsigned int len) {
+    unsigned int i = 0,o = 0,n;
+    unsigned char c;
+
+    while (i < len) {
+        c = src[i++];
+        if (c < 128U) {
+            n = (unsigned int)c + 1U;
+            if ((i+n) > len || (o+n) > dstmax) return -1;
+            memcpy(dst+o,src+i,n);
+            i += n;
+            o += n;
+        }
+        else if (c > 128U) {
+            n = 257U - (unsigned int)c;
+            if (i >= len || (o+n) > dstmax) return -1;
+            memset(dst+o,src[i++],n);
+            o += n;
+        }
+    }
+
+    return (int)o;
+}
+
+void remctl_win_srv_reset(struct remctl_win_srv * const w) {
+    unsigned int i;
+
+    w->window = 0;
+    w->flags = 0;
+    w->expect = 0;
+    w->nak = 0xFF;
+    w->nak_sent = 0;
+    for (i=0;i < REMCTL_SERIAL_WIN_MAX;i++) {
+        w->rx_valid[i] = 0;
+        w->tx_valid[i] = 0;
+        w->tx_pending[i] = 0;
+    }
+}
+
+unsigned int remctl_win_srv_negotiate(struct remctl_win_srv * const w,const unsigned char *req,const unsigned int reqlen,const unsigned char max_window,unsigned char *reply) {
+    unsigned char window = 0,flags = 0;
+
+    remctl_win_srv_reset(w);
+
+    if (reqlen >= 3 && req[0] == REMCTL_SERIAL_WIN_VERSION) {
+        window = req[1];
+        if (window > max_window) window = max_window;
+        if (window > REMCTL_SERIAL_WIN_MAX) window = REMCTL_SERIAL_WIN_MAX;
+        if (window != 0) flags = req[2] & REMCTL_SERIAL_WIN_FLAG_PACK;
+    }
+
+    w->window = window;
+    w->flags = flags;
+
+    reply[0] = REMCTL_SERIAL_WIN_VERSION;
+    reply[1] = window;
+    reply[2] = flags;
+    return 3;
+}
+
+void remctl_win_srv_receive(struct remctl_win_srv * const w,const struct remctl_serial_packet * const pkt) {
+    const unsigned char d = (unsigned char)((pkt->hdr.sequence - w->expect) & 0x7FU);
+    const unsigned char slot = pkt->hdr.sequence & (REMCTL_SERIAL_WIN_MAX - 1U);
+
+    if (pkt->hdr.sequence > 0x7FU)
+        return;
+
+    if (d < w->window) {
+        /* in the window: keep it until its turn. if it's ahead of a gap, ask for the gap once */
+        if (!w->rx_valid[slot]) {
+            memcpy(&(w->rx[slot]),pkt,sizeof(pkt->hdr) + (size_t)pkt->hdr.length);
+            w->rx_valid[slot] = 1;
+        }
+
+        if (d != 0 && !w->nak_sent && !w->rx_valid[w->expect & (REMCTL_SERIAL_WIN_MAX - 1U)]) {
+            w->nak = w->expect;
+            w->nak_sent = 1;
+        }
+    }
+    else if (d >= (unsigned char)(0x80U - w->window)) {
+        /* already executed, the reply must have been lost. send it again */
+        if (w->tx_valid[slot] && w->tx[slot].hdr.sequence == pkt->hdr.sequence)
+            w->tx_pending[slot] = 1;
+    }
+}
+
+struct remctl_serial_packet *remctl_win_srv_request(struct remctl_win_srv * const w) {
+    const unsigned char slot = w->expect & (REMCTL_SERIAL_WIN_MAX - 1U);
+
+    if (w->window == 0 || !w->rx_valid[slot])
+        return NULL;
+
+    return &(w->rx[slot]);
+}
+
+int remctl_win_srv_unpack_request(const struct remctl_serial_packet * const req,struct remctl_serial_packet * const out) {
+    int n;
+
+    if (req->hdr.type == (REMCTL_SERIAL_TYPE_FILE|REMCTL_SERIAL_TYPE_PACKED)) {
+        if (req->hdr.length < 2 || req->data[0] != REMCTL_SERIAL_TYPE_FILE_WRITE)
+            return -1;
+
+        out->hdr = req->hdr;
+        out->hdr.type = REMCTL_SERIAL_TYPE_FILE;
+        out->data[0] = req->data[0];
+        out->data[1] = req->data[1];
+        n = remctl_unpack(out->data+2,(unsigned int)req->data[1],req->data+2,(unsigned int)req->hdr.length - 2U);
+        if (n != (int)req->data[1])
+            return -1;
+
+        out->hdr.length = (unsigned char)(2 + n);
+        return 0;
+    }
+    else if (req->hdr.type & REMCTL_SERIAL_TYPE_PACKED) {
+        return -1;
+    }
+
+    memcpy(out,req,sizeof(req->hdr) + (size_t)req->hdr.length);
+    return 0;
+}
+
+void remctl_win_srv_reply(struct remctl_win_srv * const w,const struct remctl_serial_packet * const reply) {
+    const unsigned char slot = w->expect & (REMCTL_SERIAL_WIN_MAX - 1U);
+    struct remctl_serial_packet * const t = &(w->tx[slot]);
+    unsigned int n = 0;
+
+    t->hdr = reply->hdr;
+    t->hdr.sequence = w->expect;
+
+    if (t->hdr.length > REMCTL_SERIAL_WIN_MAX_LENGTH)
+        t->hdr.length = REMCTL_SERIAL_WIN_MAX_LENGTH;
+
+    /* MEMREAD data is often runs of 00 or FF, pack it if that makes it smaller */
+    if ((w->flags & REMCTL_SERIAL_WIN_FLAG_PACK) && reply->hdr.type == REMCTL_SERIAL_TYPE_MEMREAD && t->hdr.length > 6)
+        n = remctl_pack(t->data+5,(unsigned int)t->hdr.length - 6U,reply->data+5,(unsigned int)t->hdr.length - 5U);
+
+    if (n != 0) {
+        memcpy(t->data,reply->data,5);
+        t->hdr.type |= REMCTL_SERIAL_TYPE_PACKED;
+        t->hdr.length = (unsigned char)(5 + n);
+    }
+    else {
+        memcpy(t->data,reply->data,t->hdr.length);
+    }
+
+    remctl_win_seal(t);
+    w->tx_valid[slot] = 1;
+    w->tx_pending[slot] = 1;
+    w->rx_valid[slot] = 0;
+
+    w->expect = (w->expect + 1U) & 0x7FU;
+    w->nak_sent = 0;
+}
+
+struct remctl_serial_packet *remctl_win_srv_output(struct remctl_win_srv * const w) {
+    unsigned char i,s,slot;
+
+    if (w->nak != 0xFF) {
+        w->ctl.hdr.length = 0;
+        w->ctl.hdr.sequence = w->nak;
+        w->ctl.hdr.type = REMCTL_SERIAL_TYPE_NAK;
+        remctl_win_seal(&(w->ctl));
+        w->nak = 0xFF;
+        return &(w->ctl);
+    }
+
+    /* oldest first */
+    for (i=w->window;i > 0;i--) {
+        s = (unsigned char)((w->expect - i) & 0x7FU);
+        slot = s & (REMCTL_SERIAL_WIN_MAX - 1U);
+        if (w->tx_valid[slot] && w->tx_pending[slot] && w->tx[slot].hdr.sequence == s) {
+            w->tx_pending[slot] = 0;
+            return &(w->tx[slot]);
+        }
+    }
+
+    return NULL;
+}
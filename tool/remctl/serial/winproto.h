@@ -0,0 +1,73 @@
+
+#ifndef __DOSLIB_TOOL_REMCTL_SERIAL_WINPROTO_H
+#define __DOSLIB_TOOL_REMCTL_SERIAL_WINPROTO_H
+
+/* Windowed mode of the remctl serial protocol, shared by the client, REMSRV and the Linux host
+ * server stand-in (remsrvhost). Framing is described in proto.h.
+ *
+ * The server side keeps a receive slot and a reply slot per sequence number in the window:
+ *
+ *   - requests can arrive out of order (a lost packet is resent later), they are held until every
+ *     earlier request is there and are executed strictly in sequence order.
+ *   - a request that arrives ahead of a gap gets a NAK for the missing sequence number, once,
+ *     so the client resends only that one instead of waiting for its timeout.
+ *   - the reply to every executed request is kept until the client moves its window past it.
+ *     a request that comes in again (the reply was lost) gets the saved reply resent, it is not
+ *     executed again. FILE_WRITE is not idempotent.
+ *
+ * Slot = sequence & (REMCTL_SERIAL_WIN_MAX - 1). */
+
+#include "proto.h"
+
+unsigned short remctl_crc16(unsigned short crc,const unsigned char *p,unsigned int len);
+
+/* on the wire size of a packet with this header. window != 0 if windowed mode */
+unsigned int remctl_serial_frame_size(const struct remctl_serial_packet_header * const hdr,const unsigned char window);
+
+/* windowed mode: fill in mark, header check and the CRC-16 after the data */
+void remctl_win_seal(struct remctl_serial_packet * const pkt);
+int remctl_win_header_ok(const struct remctl_serial_packet_header * const hdr);
+int remctl_win_crc_ok(const struct remctl_serial_packet * const pkt);
+
+/* PackBits. pack returns the packed length, or 0 if it does not fit in dstmax.
+ * unpack returns the unpacked length, or -1 if malformed or larger than dstmax */
+unsigned int remctl_pack(unsigned char *dst,unsigned int dstmax,const unsigned char *src,unsigned int len);
+int remctl_unpack(unsigned char *dst,unsigned int dstmax,const unsigned char *src,unsigned int len);
+
+struct remctl_win_srv {
+    unsigned char                   window;         // negotiated window, 0 = stop and wait
+    unsigned char                   flags;          // REMCTL_SERIAL_WIN_FLAG_*
+    unsigned char                   expect;         // sequence number of the next request to execute
+    unsigned char                   nak;            // sequence number to NAK, 0xFF if none
+    unsigned char                   nak_sent;       // NAK for 'expect' already sent
+    unsigned char                   rx_valid[REMCTL_SERIAL_WIN_MAX];
+    unsigned char                   tx_valid[REMCTL_SERIAL_WIN_MAX];
+    unsigned char                   tx_pending[REMCTL_SERIAL_WIN_MAX];
+    struct remctl_serial_packet     rx[REMCTL_SERIAL_WIN_MAX];
+    struct remctl_serial_packet     tx[REMCTL_SERIAL_WIN_MAX];
+    struct remctl_serial_packet     ctl;            // NAK
+};
+
+void remctl_win_srv_reset(struct remctl_win_srv * const w);
+
+/* handle REMCTL_SERIAL_TYPE_NEGOTIATE request data, write the reply data, return reply length.
+ * takes effect with the next packet: the reply itself still goes out in the old mode */
+unsigned int remctl_win_srv_negotiate(struct remctl_win_srv * const w,const unsigned char *req,const unsigned int reqlen,const unsigned char max_window,unsigned char *reply);
+
+/* a windowed packet came in and passed remctl_win_crc_ok() */
+void remctl_win_srv_receive(struct remctl_win_srv * const w,const struct remctl_serial_packet * const pkt);
+
+/* next request to execute, in order, NULL if it has not arrived yet */
+struct remctl_serial_packet *remctl_win_srv_request(struct remctl_win_srv * const w);
+
+/* copy the request to 'out' for execution, unpacking a packed FILE_WRITE. -1 if malformed */
+int remctl_win_srv_unpack_request(const struct remctl_serial_packet * const req,struct remctl_serial_packet * const out);
+
+/* the reply to the request from remctl_win_srv_request(). saves and queues it, moves on to the next request */
+void remctl_win_srv_reply(struct remctl_win_srv * const w,const struct remctl_serial_packet * const reply);
+
+/* next packet to transmit (NAK, resent reply, new reply), sealed. NULL if nothing to send */
+struct remctl_serial_packet *remctl_win_srv_output(struct remctl_win_srv * const w);
+
+#endif //__DOSLIB_TOOL_REMCTL_SERIAL_WINPROTO_H
+
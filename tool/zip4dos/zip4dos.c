@@ -23,6 +23,7 @@
 #include <limits.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "zlib.h"
 #include "iconv.h"
@@ -115,6 +116,9 @@ static void help(void) {
     fprintf(stderr,"  -oc <charset>            File names for target use this charset\n");
     fprintf(stderr,"  -t+                      Add trailing data descriptor\n");
     fprintf(stderr,"  -t-                      Don't write trailing descriptor\n");
+    fprintf(stderr,"  -j <n>                   Compress with n threads (default: one per CPU)\n");
+    fprintf(stderr,"  -dedup                   Compress files with identical content only once (not with -0)\n");
+    fprintf(stderr,"  -auto                    Store files that deflate would not shrink\n");
     fprintf(stderr,"\n");
     fprintf(stderr,"Spanning size can be specified in bytes, or with K, M, G, suffix.\n");
     fprintf(stderr,"With spanning, the zip file must have .zip suffix, which will be changed\n");
@@ -224,6 +228,15 @@ struct in_file {
     struct in_file*     next;
 
     _Bool               data_descriptor;/* write data descriptor after file */
+
+    unsigned char       method;         /* 0 = stored, 8 = deflate */
+    unsigned char       method_known;   /* -auto has decided, protected by zip_pool_lock */
+    unsigned char       method_failed;  /* -auto could not decide, the first block failed. protected by zip_pool_lock */
+    size_t              list_index;
+    struct in_file*     dup_of;         /* -dedup: same content as this earlier file */
+    unsigned int        dup_refs;       /* -dedup: later files with the same content */
+    unsigned char*      dup_data;       /* -dedup: compressed data kept for them */
+    unsigned long       compress_usec;  /* time the workers spent compressing it */
 } in_file;
 
 struct in_file *in_file_alloc(void) {
@@ -239,6 +252,7 @@ char *in_file_set_zip_name(struct in_file *f,char *s) {
 }
 
 void in_file_free(struct in_file *f) {
+    if (f->dup_data != NULL) free(f->dup_data);
     clear_string(&f->in_path);
     clear_string(&f->zip_name);
     memset(f,0,sizeof(*f));
@@ -726,115 +740,669 @@ int zip_store(struct pkzip_local_file_header_main *lfh,struct in_file *list) {
     return 0;
 }
 
-int zip_deflate(struct pkzip_local_file_header_main *lfh,struct in_file *list) {
-    size_t inbuffer_sz = 32768,outbuffer_sz = 32768;
-    char *inbuffer,*outbuffer;
-    unsigned long total = 0;
-    zipcrc_t crc32;
-    z_stream z;
-    int src_fd;
-    size_t wd;
-    int rd;
+/* Deflate runs on a pool of worker threads, each compressing one job into memory.
+ * A job is a whole file, or one block of a large file. The main thread is the only
+ * writer: it takes the finished jobs in file list order and writes them out through
+ * zip_write_and_span(), so spanning and the archive layout are the same as when
+ * compressing one file at a time.
+ *
+ * The blocks of a large file form one raw deflate stream. Every block but the last
+ * ends on a sync flush (byte aligned, not final), and every block but the first is
+ * primed with the 32KB of input in front of it, so the compression ratio hardly
+ * suffers. The block size does not depend on the thread count, so the archive is
+ * the same no matter how many threads made it. */
+#define ZIP_BLOCK_SIZE          (1UL << 20UL)   /* 1MB */
+#define ZIP_BLOCK_SPLIT         (ZIP_BLOCK_SIZE * 2UL) /* split files larger than this */
+#define ZIP_DICT_SIZE           (32768UL)
+
+/* -auto: deflate the first 64KB, store the file if that does not get below 98% */
+#define ZIP_TRIAL_SIZE          (65536UL)
+#define ZIP_TRIAL_PERCENT       (98UL)
+
+struct zip_job {
+    struct in_file*     file;
+    unsigned long       offset;         /* block offset within the file */
+    unsigned long       length;         /* block length */
+    unsigned char       last;           /* last block of the file, finish the deflate stream */
+    unsigned char       done;           /* worker is finished with it, protected by zip_pool_lock */
+    int                 result;         /* 0 if OK */
+    unsigned char*      out;            /* compressed data */
+    size_t              out_len;
+    uint32_t            crc32;          /* CRC of this block alone */
+};
+
+unsigned int            zip_jobs_threads = 0; /* -j, 0 = one per CPU */
+_Bool                   zip_auto_store = 0; /* -auto */
+_Bool                   zip_dedup = 0;      /* -dedup */
+
+struct zip_job*         zip_jobs = NULL;
+size_t                  zip_jobs_count = 0;
+size_t                  zip_jobs_next = 0;      /* next job a worker will take */
+size_t                  zip_jobs_written = 0;   /* jobs the writer is done with */
+size_t                  zip_jobs_window = 0;    /* how far the workers may run ahead of the writer */
+_Bool                   zip_jobs_abort = 0;
+
+pthread_mutex_t         zip_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t          zip_pool_job_done = PTHREAD_COND_INITIALIZER;
+pthread_cond_t          zip_pool_job_taken = PTHREAD_COND_INITIALIZER;
+pthread_t*              zip_pool_threads = NULL;
+unsigned int            zip_pool_thread_count = 0;
+
+/* -auto and -dedup statistics, protected by zip_pool_lock while the pool runs */
+struct zip_stats {
+    unsigned int        dup_files;
+    unsigned long       dup_bytes;      /* input bytes not compressed again */
+    unsigned long       dup_usec;       /* compression time the originals took */
+    unsigned long       hash_usec;      /* time spent finding duplicates */
+    unsigned int        stored_files;
+    unsigned long       stored_bytes;
+    unsigned long       stored_saved;   /* how much larger deflate would have been, from the trial */
+    unsigned long       stored_usec;    /* deflate time skipped, extrapolated from the trial */
+    unsigned long       trial_usec;     /* time spent on trials */
+} zip_stats;
+
+static unsigned long zip_usec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ((unsigned long)ts.tv_sec * 1000000UL) + ((unsigned long)ts.tv_nsec / 1000UL);
+}
 
-    crc32 = zipcrc_init();
+static int zip_pread_all(int fd,unsigned char *buf,size_t len,unsigned long ofs) {
+    ssize_t rd;
+
+    while (len > 0) {
+        rd = pread(fd,buf,len,(off_t)ofs);
+        if (rd <= 0) return -1;
+        buf += (size_t)rd;
+        len -= (size_t)rd;
+        ofs += (unsigned long)rd;
+    }
+
+    return 0;
+}
+
+/* deflate len bytes into out, which must hold deflateBound() + 16.
+ * returns the compressed length, or -1 */
+static long zip_deflate_buffer(unsigned char *out,size_t out_max,const unsigned char *dict,unsigned long dict_len,const unsigned char *in,unsigned long len,_Bool last) {
+    z_stream z;
+    int x;
 
     memset(&z,0,sizeof(z));
-    assert(list->in_path != NULL);
+    if (deflateInit2(&z,deflate_mode,Z_DEFLATED,-15/*window, raw*/,8/*memlevel*/,Z_DEFAULT_STRATEGY) != Z_OK) {
+        fprintf(stderr,"out of memory\n");
+        return -1;
+    }
 
-    lfh->uncompressed_size = list->file_size;
+    if (dict_len != 0 && deflateSetDictionary(&z,dict,dict_len) != Z_OK) {
+        fprintf(stderr,"deflateSetDictionary() error\n");
+        deflateEnd(&z);
+        return -1;
+    }
 
-    src_fd = open(list->in_path,O_RDONLY|O_BINARY);
+    z.next_in = (unsigned char*)in;
+    z.avail_in = len;
+    z.next_out = out;
+    z.avail_out = out_max;
+
+    x = deflate(&z,last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (last ? (x != Z_STREAM_END) : (x != Z_OK || z.avail_in != 0 || z.avail_out == 0)) {
+        fprintf(stderr,"deflate() error\n");
+        deflateEnd(&z);
+        return -1;
+    }
+
+    /* an unfinished stream is Z_DATA_ERROR here, which is expected */
+    x = deflateEnd(&z);
+    if (last && x != Z_OK)
+        fprintf(stderr,"deflateEnd() error\n");
+
+    return (long)(out_max - z.avail_out);
+}
+
+/* deflateBound() covers Z_FINISH, a sync flush adds an empty stored block on top of that */
+static size_t zip_deflate_bound(unsigned long len) {
+    return (size_t)compressBound(len) + 16;
+}
+
+/* -auto: decide between store and deflate from the start of the file.
+ * If the trial covered the whole file it is also the result, and is returned in job->out. */
+static int zip_job_trial(struct zip_job *job,const unsigned char *data) {
+    unsigned long t0 = zip_usec(),tl,el;
+    unsigned long len = job->length < ZIP_TRIAL_SIZE ? job->length : ZIP_TRIAL_SIZE;
+    const _Bool whole = (job->last && len == job->length);
+    size_t out_max = zip_deflate_bound(len);
+    unsigned char *out;
+    long r;
+
+    out = malloc(out_max);
+    if (out == NULL) {
+        fprintf(stderr,"out of memory\n");
+        return -1;
+    }
+
+    r = zip_deflate_buffer(out,out_max,NULL,0,data,len,whole);
+    if (r < 0) {
+        free(out);
+        return -1;
+    }
+
+    tl = zip_usec() - t0;
+
+    pthread_mutex_lock(&zip_pool_lock);
+    if (len != 0 && (unsigned long)r * 100UL >= len * ZIP_TRIAL_PERCENT) {
+        /* extrapolate to the whole file what deflate would have cost */
+        el = (unsigned long)(((double)r / len) * job->file->file_size);
+        job->file->method = 0;
+        zip_stats.stored_files++;
+        zip_stats.stored_bytes += job->file->file_size;
+        if (el > job->file->file_size) zip_stats.stored_saved += el - job->file->file_size;
+        zip_stats.stored_usec += (unsigned long)(((double)tl / len) * job->file->file_size);
+    }
+    if (!(whole && job->file->method == 8)) /* otherwise the trial was the real thing */
+        zip_stats.trial_usec += tl;
+    job->file->method_known = 1;
+    pthread_cond_broadcast(&zip_pool_job_done);
+    pthread_mutex_unlock(&zip_pool_lock);
+
+    if (whole && job->file->method == 8) {
+        job->out = out;
+        job->out_len = (size_t)r;
+    }
+    else {
+        free(out);
+    }
+
+    return 0;
+}
+
+int zip_job_deflate(struct zip_job *job) {
+    unsigned long dict_len = 0;
+    unsigned char *inbuffer;
+    size_t out_max;
+    int src_fd;
+    long r;
+
+    assert(job->file->in_path != NULL);
+
+    src_fd = open(job->file->in_path,O_RDONLY|O_BINARY);
     if (src_fd < 0) {
-        fprintf(stderr,"Cannot open %s, %s\n",list->in_path,strerror(errno));
+        fprintf(stderr,"Cannot open %s, %s\n",job->file->in_path,strerror(errno));
         return -1;
     }
 
-    outbuffer = malloc(outbuffer_sz);
-    inbuffer = malloc(inbuffer_sz);
-    if (inbuffer == NULL || outbuffer == NULL) {
+    if (job->offset != 0)
+        dict_len = (job->offset < ZIP_DICT_SIZE) ? job->offset : ZIP_DICT_SIZE;
+
+    inbuffer = malloc(dict_len + job->length + 1);
+    if (inbuffer == NULL) {
         fprintf(stderr,"out of memory\n");
         close(src_fd);
         return -1;
     }
 
-    if (deflateInit2(&z,deflate_mode,Z_DEFLATED,-15/*window, raw*/,8/*memlevel*/,Z_DEFAULT_STRATEGY) != Z_OK) {
-        fprintf(stderr,"out of memory\n");
+    if (zip_pread_all(src_fd,inbuffer,dict_len + job->length,job->offset - dict_len)) {
+        fprintf(stderr,"Cannot read %s, %s\n",job->file->in_path,strerror(errno));
         close(src_fd);
+        free(inbuffer);
         return -1;
     }
+    close(src_fd);
 
-    while ((rd=read(src_fd,inbuffer,inbuffer_sz)) > 0) {
-        crc32 = zipcrc_update(crc32,inbuffer,rd);
+    job->crc32 = zipcrc_finalize(zipcrc_update(zipcrc_init(),inbuffer + dict_len,job->length));
 
-        z.avail_in = rd;
-        z.next_in = (unsigned char*)inbuffer;
-        while (z.avail_in > 0) {
-            char *pin = (char*)z.next_in;
+    if (zip_auto_store) {
+        if (job->offset == 0) {
+            if (zip_job_trial(job,inbuffer)) {
+                free(inbuffer);
+                return -1;
+            }
+        }
+        else {
+            /* the first block was handed out before this one, and is deciding */
+            pthread_mutex_lock(&zip_pool_lock);
+            while (!job->file->method_known)
+                pthread_cond_wait(&zip_pool_job_done,&zip_pool_lock);
+            pthread_mutex_unlock(&zip_pool_lock);
+
+            if (job->file->method_failed) {
+                free(inbuffer);
+                return -1;
+            }
+        }
+    }
+
+    if (job->file->method == 0) {
+        if (dict_len != 0) memmove(inbuffer,inbuffer + dict_len,job->length);
+        job->out = inbuffer;
+        job->out_len = job->length;
+        return 0;
+    }
+
+    if (job->out != NULL) { /* the trial did it all */
+        free(inbuffer);
+        return 0;
+    }
+
+    out_max = zip_deflate_bound(job->length);
+    job->out = malloc(out_max);
+    if (job->out == NULL) {
+        fprintf(stderr,"out of memory\n");
+        free(inbuffer);
+        return -1;
+    }
+
+    r = zip_deflate_buffer(job->out,out_max,inbuffer,dict_len,inbuffer + dict_len,job->length,job->last);
+    free(inbuffer);
+    if (r < 0) return -1;
+
+    job->out_len = (size_t)r;
+    return 0;
+}
+
+static void *zip_pool_worker(void *arg) {
+    struct zip_job *job;
+    unsigned long t;
+
+    (void)arg;
+
+    pthread_mutex_lock(&zip_pool_lock);
+    while (1) {
+        while (!zip_jobs_abort && zip_jobs_next < zip_jobs_count && zip_jobs_next >= (zip_jobs_written + zip_jobs_window))
+            pthread_cond_wait(&zip_pool_job_taken,&zip_pool_lock);
+
+        if (zip_jobs_abort || zip_jobs_next >= zip_jobs_count)
+            break;
+
+        job = &zip_jobs[zip_jobs_next++];
+        pthread_mutex_unlock(&zip_pool_lock);
+
+        t = zip_usec();
+        job->result = zip_job_deflate(job);
+        t = zip_usec() - t;
+
+        pthread_mutex_lock(&zip_pool_lock);
+        job->file->compress_usec += t;
+        job->done = 1;
+        /* -auto: a first block that failed before the trial decided must not leave the
+         * writer and the other blocks of the file waiting for the decision */
+        if (job->result != 0 && job->offset == 0 && !job->file->method_known) {
+            job->file->method_failed = 1;
+            job->file->method_known = 1;
+        }
+        pthread_cond_broadcast(&zip_pool_job_done);
+    }
+    pthread_mutex_unlock(&zip_pool_lock);
+
+    return NULL;
+}
+
+static int zip_files_same(const struct in_file *a,const struct in_file *b) {
+    unsigned char *ba,*bb;
+    int fa,fb,same = 0;
+    ssize_t ra,rb;
+
+    fa = open(a->in_path,O_RDONLY|O_BINARY);
+    fb = open(b->in_path,O_RDONLY|O_BINARY);
+    ba = malloc(65536);
+    bb = malloc(65536);
+
+    if (fa >= 0 && fb >= 0 && ba != NULL && bb != NULL) {
+        do {
+            ra = read(fa,ba,65536);
+            rb = read(fb,bb,65536);
+            if (ra < 0 || ra != rb || memcmp(ba,bb,(size_t)ra) != 0) break;
+            if (ra == 0) same = 1;
+        } while (!same);
+    }
+
+    if (fa >= 0) close(fa);
+    if (fb >= 0) close(fb);
+    if (ba != NULL) free(ba);
+    if (bb != NULL) free(bb);
+    return same;
+}
+
+static int zip_file_crc(struct in_file *f) {
+    unsigned char *buf;
+    zipcrc_t crc32;
+    ssize_t rd;
+    int fd;
+
+    fd = open(f->in_path,O_RDONLY|O_BINARY);
+    if (fd < 0) {
+        fprintf(stderr,"Cannot open %s, %s\n",f->in_path,strerror(errno));
+        return -1;
+    }
+
+    buf = malloc(65536);
+    if (buf == NULL) {
+        fprintf(stderr,"out of memory\n");
+        close(fd);
+        return -1;
+    }
+
+    crc32 = zipcrc_init();
+    while ((rd=read(fd,buf,65536)) > 0)
+        crc32 = zipcrc_update(crc32,buf,(size_t)rd);
+
+    f->crc32 = zipcrc_finalize(crc32);
+    free(buf);
+    close(fd);
+    return 0;
+}
+
+static int zip_dedup_cmp(const void *a,const void *b) {
+    const struct in_file *fa = *((const struct in_file**)a);
+    const struct in_file *fb = *((const struct in_file**)b);
+
+    if (fa->file_size != fb->file_size) return (fa->file_size < fb->file_size) ? -1 : 1;
+    if (fa->crc32 != fb->crc32) return (fa->crc32 < fb->crc32) ? -1 : 1;
+    return (fa->list_index < fb->list_index) ? -1 : 1;
+}
+
+/* -dedup: point files with the same content as an earlier file at that file.
+ * Only files that share their size with another one are read, the CRC narrows it
+ * down further, and a byte compare makes sure. */
+int zip_dedup_scan(void) {
+    unsigned long t0 = zip_usec();
+    struct in_file **v,*list;
+    size_t count = 0,i,j,k;
+
+    for (list=file_list_head;list;list=list->next) {
+        if (!(list->attr & ATTR_DOS_DIR) && list->file_size != 0)
+            list->list_index = count++;
+    }
+
+    if (count < 2)
+        return 0;
+
+    v = malloc(count * sizeof(*v));
+    if (v == NULL) {
+        fprintf(stderr,"out of memory\n");
+        return -1;
+    }
+
+    i = 0;
+    for (list=file_list_head;list;list=list->next) {
+        if (!(list->attr & ATTR_DOS_DIR) && list->file_size != 0)
+            v[i++] = list;
+    }
 
-            z.next_out = (unsigned char*)outbuffer;
-            z.avail_out = outbuffer_sz;
+    qsort(v,count,sizeof(*v),zip_dedup_cmp); /* crc32 is still zero, this sorts by size */
 
-            if (deflate(&z,Z_NO_FLUSH) != Z_OK) {
-                fprintf(stderr,"deflate() error\n");
-                break;
+    for (i=0;i < count;i=j) {
+        for (j=i+1;j < count && v[j]->file_size == v[i]->file_size;j++);
+        if ((j-i) < 2) continue;
+
+        for (k=i;k < j;k++) {
+            if (zip_file_crc(v[k])) {
+                free(v);
+                return -1;
             }
+        }
+
+        /* within the same size, by CRC then list order, so the original comes first */
+        qsort(v+i,j-i,sizeof(*v),zip_dedup_cmp);
+
+        for (k=i+1;k < j;k++) {
+            size_t o;
 
-            assert((char*)z.next_out >= outbuffer);
-            assert((char*)z.next_out <= (outbuffer+outbuffer_sz));
-            wd = (size_t)((char*)z.next_out - (char*)outbuffer);
-            if (wd > 0) {
-                if ((size_t)zip_write_and_span(zip_fd,outbuffer,wd) != wd) {
-                    fprintf(stderr,"write error\n");
+            for (o=i;o < k;o++) {
+                if (v[o]->dup_of == NULL && v[o]->crc32 == v[k]->crc32 && zip_files_same(v[o],v[k])) {
+                    v[k]->dup_of = v[o];
+                    v[o]->dup_refs++;
                     break;
                 }
-
-                total += wd;
-            }
-            else if ((char*)z.next_in == pin) {
-                fprintf(stderr,"zlib locked up\n");
-                break;
             }
         }
     }
 
+    free(v);
+    zip_stats.hash_usec = zip_usec() - t0;
+    return 0;
+}
+
+/* one job per small file, one per block of a large file, in file list order */
+int zip_pool_build_jobs(void) {
+    struct in_file *list;
+    unsigned long o,l;
+    size_t count = 0;
+
+    for (list=file_list_head;list;list=list->next) {
+        if (list->attr & ATTR_DOS_DIR) continue;
+
+        list->method = 8;
+        list->method_known = !zip_auto_store;
+        if (list->dup_of != NULL) continue;
+
+        if (list->file_size > ZIP_BLOCK_SPLIT)
+            count += (list->file_size + ZIP_BLOCK_SIZE - 1UL) / ZIP_BLOCK_SIZE;
+        else
+            count++;
+    }
+
+    if (count == 0)
+        return 0;
+
+    zip_jobs = calloc(count,sizeof(struct zip_job));
+    if (zip_jobs == NULL) {
+        fprintf(stderr,"out of memory\n");
+        return -1;
+    }
+
+    for (list=file_list_head;list;list=list->next) {
+        if (list->attr & ATTR_DOS_DIR) continue;
+        if (list->dup_of != NULL) continue;
+
+        o = 0;
+        do {
+            if (list->file_size > ZIP_BLOCK_SPLIT)
+                l = (list->file_size - o) < ZIP_BLOCK_SIZE ? (list->file_size - o) : ZIP_BLOCK_SIZE;
+            else
+                l = list->file_size;
+
+            assert(zip_jobs_count < count);
+            zip_jobs[zip_jobs_count].file = list;
+            zip_jobs[zip_jobs_count].offset = o;
+            zip_jobs[zip_jobs_count].length = l;
+            o += l;
+            zip_jobs[zip_jobs_count].last = (o >= list->file_size);
+            zip_jobs_count++;
+        } while (o < list->file_size);
+    }
+
+    assert(zip_jobs_count == count);
+    return 0;
+}
+
+int zip_pool_start(void) {
+    unsigned int i,threads = zip_jobs_threads;
+
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (n > 0) ? (unsigned int)n : 1u;
+    }
+
+    if (zip_dedup && zip_dedup_scan())
+        return -1;
+    if (zip_pool_build_jobs())
+        return -1;
+    if (zip_jobs_count == 0)
+        return 0;
+
+    if ((size_t)threads > zip_jobs_count)
+        threads = (unsigned int)zip_jobs_count;
+
+    /* bounds memory use to a few blocks per thread */
+    zip_jobs_window = (size_t)threads * 4u;
+    zip_jobs_next = zip_jobs_written = 0;
+    zip_jobs_abort = 0;
+
+    zip_pool_threads = calloc(threads,sizeof(pthread_t));
+    if (zip_pool_threads == NULL) {
+        fprintf(stderr,"out of memory\n");
+        return -1;
+    }
+
+    for (i=0;i < threads;i++) {
+        if (pthread_create(&zip_pool_threads[i],NULL,zip_pool_worker,NULL) != 0) {
+            fprintf(stderr,"Cannot start compression thread\n");
+            break;
+        }
+    }
+
+    zip_pool_thread_count = i;
+    if (i == 0) return -1;
+
+    printf("Compressing with %u thread(s), %lu job(s)\n",zip_pool_thread_count,(unsigned long)zip_jobs_count);
+    return 0;
+}
+
+void zip_pool_stop(void) {
+    unsigned int i;
+    size_t j;
+
+    pthread_mutex_lock(&zip_pool_lock);
+    zip_jobs_abort = 1;
+    pthread_cond_broadcast(&zip_pool_job_taken);
+    pthread_mutex_unlock(&zip_pool_lock);
+
+    for (i=0;i < zip_pool_thread_count;i++)
+        pthread_join(zip_pool_threads[i],NULL);
+
+    for (j=0;j < zip_jobs_count;j++) {
+        if (zip_jobs[j].out != NULL) free(zip_jobs[j].out);
+    }
+
+    if (zip_pool_threads != NULL) free(zip_pool_threads);
+    if (zip_jobs != NULL) free(zip_jobs);
+    zip_pool_threads = NULL;
+    zip_pool_thread_count = 0;
+    zip_jobs = NULL;
+    zip_jobs_count = 0;
+}
+
+/* writer side: the compression method of a file, which -auto decides in a worker.
+ * returns -1 if the worker failed before it could decide */
+int zip_file_method(struct in_file *list) {
+    struct in_file *orig = list;
+
+    if (list->dup_of != NULL)
+        list = list->dup_of;
+
+    pthread_mutex_lock(&zip_pool_lock);
+    while (!list->method_known)
+        pthread_cond_wait(&zip_pool_job_done,&zip_pool_lock);
+    pthread_mutex_unlock(&zip_pool_lock);
+
+    if (list->method_failed)
+        return -1;
+
+    return (orig->method = list->method);
+}
+
+void zip_report_stats(void) {
+    if (zip_dedup) {
+        printf("Dedup: %u duplicate file(s), %lu bytes not compressed again, about %lums of compression saved, %lums spent finding them\n",
+            zip_stats.dup_files,zip_stats.dup_bytes,zip_stats.dup_usec / 1000UL,zip_stats.hash_usec / 1000UL);
+    }
+    if (zip_auto_store) {
+        printf("Auto: %u file(s) stored (%lu bytes), deflate would have added about %lu bytes and taken about %lums, %lums spent on trials\n",
+            zip_stats.stored_files,zip_stats.stored_bytes,zip_stats.stored_saved,zip_stats.stored_usec / 1000UL,zip_stats.trial_usec / 1000UL);
+    }
+}
+
+/* writer side: a file with the same content as an earlier one gets a copy of its data */
+int zip_deflate_dup(struct pkzip_local_file_header_main *lfh,struct in_file *list) {
+    struct in_file *orig = list->dup_of;
+
+    assert(orig->dup_refs > 0);
+    assert(orig->dup_data != NULL || orig->compressed_size == 0);
+
+    if (orig->compressed_size > 0) {
+        if ((unsigned long)zip_write_and_span(zip_fd,orig->dup_data,orig->compressed_size) != orig->compressed_size) {
+            fprintf(stderr,"write error\n");
+            return -1;
+        }
+    }
+
+    lfh->uncompressed_size = list->file_size;
+    lfh->crc32 = list->crc32 = orig->crc32;
+    list->compressed_size = lfh->compressed_size = orig->compressed_size;
+
+    zip_stats.dup_files++;
+    zip_stats.dup_bytes += list->file_size;
+    zip_stats.dup_usec += orig->compress_usec;
+
+    if (--orig->dup_refs == 0 && orig->dup_data != NULL) {
+        free(orig->dup_data);
+        orig->dup_data = NULL;
+    }
+
+    return 0;
+}
+
+/* writer side: wait for the jobs of this file in order and write them out */
+int zip_deflate(struct pkzip_local_file_header_main *lfh,struct in_file *list) {
+    unsigned long total = 0;
+    struct zip_job *job;
+    uLong crc32 = 0;
+
+    if (list->dup_of != NULL)
+        return zip_deflate_dup(lfh,list);
+
+    lfh->uncompressed_size = list->file_size;
+
     do {
-        int x;
+        if (zip_jobs_written >= zip_jobs_count) abort(); /* should not happen */
+        job = &zip_jobs[zip_jobs_written];
+        if (job->file != list) abort(); /* should not happen */
 
-        z.avail_in = 0;
-        z.next_in = (unsigned char*)inbuffer;
-        z.avail_out = outbuffer_sz;
-        z.next_out = (unsigned char*)outbuffer;
+        pthread_mutex_lock(&zip_pool_lock);
+        while (!job->done)
+            pthread_cond_wait(&zip_pool_job_done,&zip_pool_lock);
+        pthread_mutex_unlock(&zip_pool_lock);
 
-        x = deflate(&z,Z_FINISH);
+        if (job->result != 0)
+            return -1;
 
-        assert((char*)z.next_out >= outbuffer);
-        assert((char*)z.next_out <= (outbuffer+outbuffer_sz));
-        wd = (size_t)((char*)z.next_out - (char*)outbuffer);
-        if (wd > 0) {
-            if ((size_t)zip_write_and_span(zip_fd,outbuffer,wd) != wd) {
+        if (job->out_len > 0) {
+            if ((size_t)zip_write_and_span(zip_fd,job->out,job->out_len) != job->out_len) {
                 fprintf(stderr,"write error\n");
-                break;
+                return -1;
             }
 
-            total += wd;
-        }
+            /* keep a copy for the duplicates further down the list */
+            if (list->dup_refs > 0) {
+                unsigned char *n = realloc(list->dup_data,total + job->out_len);
+                if (n == NULL) {
+                    fprintf(stderr,"out of memory\n");
+                    return -1;
+                }
 
-        if (x == Z_STREAM_END)
-            break;
-        else if (x != Z_OK) {
-            fprintf(stderr,"zlib Z_FINISH error\n");
-            break;
+                memcpy(n + total,job->out,job->out_len);
+                list->dup_data = n;
+            }
         }
-    } while (1);
 
-    if (deflateEnd(&z) != Z_OK)
-        fprintf(stderr,"deflateEnd() error\n");
+        total += (unsigned long)job->out_len;
+        if (job->offset == 0)
+            crc32 = job->crc32;
+        else
+            crc32 = crc32_combine(crc32,job->crc32,(z_off_t)job->length);
 
-    lfh->crc32 = list->crc32 = zipcrc_finalize(crc32);
+        free(job->out);
+        job->out = NULL;
+
+        pthread_mutex_lock(&zip_pool_lock);
+        zip_jobs_written++;
+        pthread_cond_broadcast(&zip_pool_job_taken);
+        pthread_mutex_unlock(&zip_pool_lock);
+    } while (!job->last);
+
+    lfh->crc32 = list->crc32 = (uint32_t)crc32;
     list->compressed_size = lfh->compressed_size = total;
-    close(src_fd);
-    free(inbuffer);
-    free(outbuffer);
     return 0;
 }
 
@@ -930,6 +1498,18 @@ static int parse(int argc,char **argv) {
             else if (!strcmp(a,"t-")) {
                 trailing_data_descriptor = 0;
             }
+            else if (!strcmp(a,"dedup")) {
+                zip_dedup = 1;
+            }
+            else if (!strcmp(a,"auto")) {
+                zip_auto_store = 1;
+            }
+            else if (!strcmp(a,"j")) {
+                a = argv[i++];
+                if (a == NULL) return 1;
+                zip_jobs_threads = (unsigned int)strtoul(a,NULL,0);
+                if (zip_jobs_threads == 0) return 1;
+            }
             else if (isdigit(*a)) {
                 deflate_mode = (int)strtol(a,(char**)(&a),10);
                 if (deflate_mode < 0 || deflate_mode > 9) return 1;
@@ -1315,6 +1895,17 @@ static int parse(int argc,char **argv) {
         }
     }
 
+    /* stored files are not compressed, there is nothing for -dedup to skip */
+    if (deflate_mode == 0 && zip_dedup) {
+        fprintf(stderr,"Warning: -dedup has no effect with -0, ignored\n");
+        zip_dedup = 0;
+    }
+
+    if (deflate_mode > 0) {
+        if (zip_pool_start())
+            return 1;
+    }
+
     {
         struct pkzip_local_file_header_main lhdr;
         struct in_file *list;
@@ -1330,10 +1921,16 @@ static int parse(int argc,char **argv) {
             lhdr.version_needed_to_extract = 20;        /* PKZIP 2.0 or higher */
             lhdr.general_purpose_bit_flag = (0 << 1);   /* just lie and say that "normal" deflate was used */
 
-            if (deflate_mode > 0 && !(list->attr & ATTR_DOS_DIR))
-                lhdr.compression_method = 8; /* deflate */
-            else
+            if (deflate_mode > 0 && !(list->attr & ATTR_DOS_DIR)) {
+                int method = zip_file_method(list); /* deflate, or stored if -auto says so */
+                if (method < 0)
+                    return 1;
+
+                lhdr.compression_method = (uint16_t)method;
+            }
+            else {
                 lhdr.compression_method = 0; /* stored (no compression) */
+            }
 
             lhdr.last_mod_file_time = list->msdos_time;
             lhdr.last_mod_file_date = list->msdos_date;
@@ -1379,7 +1976,8 @@ static int parse(int argc,char **argv) {
 
             /* store, if a file */
             if (!(list->attr & ATTR_DOS_DIR)) {
-                if (lhdr.compression_method == 8) {
+                if (deflate_mode > 0) {
+                    /* the compression threads did it, either way */
                     if (zip_deflate(&lhdr,list))
                         return 1;
                 }
@@ -1439,6 +2037,9 @@ static int parse(int argc,char **argv) {
         }
     }
 
+    zip_pool_stop();
+    zip_report_stats();
+
     /* write central directory */
     {
         struct pkzip_central_directory_header_main chdr;
@@ -1483,7 +2084,7 @@ static int parse(int argc,char **argv) {
                 chdr.general_purpose_bit_flag |= (1 << 3);
 
             if (deflate_mode > 0 && !(list->attr & ATTR_DOS_DIR))
-                chdr.compression_method = 8; /* deflate */
+                chdr.compression_method = list->method; /* deflate, or stored if -auto says so */
             else
                 chdr.compression_method = 0; /* stored (no compression) */
 
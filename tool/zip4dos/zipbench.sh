@@ -0,0 +1,47 @@
+#!/bin/bash
+# Compression thread scaling benchmark for zip4dos.
+# Builds a synthetic tree of many small files plus a few large ones,
+# archives it with -j 1, 2, 4 ... up to the CPU count and checks that
+# every archive is byte-identical to the -j 1 one.
+#
+# usage: ./zipbench.sh [number of small files] [level]
+zip4dos=`pwd`/linux-host/zip4dos
+files=${1:-2000}
+level=${2:-6}
+cpus=`getconf _NPROCESSORS_ONLN`
+
+if [ ! -x "$zip4dos" ]; then echo "Build zip4dos first"; exit 1; fi
+
+tmp=`mktemp -d` || exit 1
+trap 'rm -Rf "$tmp"' EXIT
+
+echo "Generating $files files in $tmp"
+mkdir -p "$tmp/tree/big" || exit 1
+for ((i=0;i < files;i++)); do
+    d="$tmp/tree/d$((i / 100))"
+    [ -d "$d" ] || mkdir "$d" || exit 1
+    # base64 of random data: compresses to about 75%, similar work per byte as real data
+    head -c $(( (RANDOM * 7) % 65536 + 256 )) /dev/urandom | base64 >"$d/f$i.dat"
+done
+for i in 1 2 3 4; do
+    head -c $((6 * 1024 * 1024)) /dev/urandom | base64 >"$tmp/tree/big/b$i.dat"
+done
+echo "Input: `du -sk "$tmp/tree" | cut -f 1` KB"
+
+cd "$tmp" || exit 1
+base=
+j=1
+while true; do
+    s=`date +%s%N`
+    "$zip4dos" --zip "j$j.zip" -$level -j $j -r tree >/dev/null 2>&1 || { echo "zip4dos -j $j failed"; exit 1; }
+    e=`date +%s%N`
+    ms=$(( (e - s) / 1000000 ))
+    [ -n "$base" ] || base=$ms
+    if [ $j -gt 1 ]; then
+        cmp -s j1.zip "j$j.zip" || { echo "-j $j output differs from -j 1"; exit 1; }
+    fi
+    echo "-j $j: $ms ms, speedup $(( base * 100 / (ms > 0 ? ms : 1) ))%, `stat -c %s "j$j.zip"` bytes"
+    [ $j -ge $cpus ] && break
+    j=$((j * 2))
+    [ $j -gt $cpus ] && j=$cpus
+done
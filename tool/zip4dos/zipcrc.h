@@ -63,6 +63,21 @@ static inline zipcrc_t zipcrc_init(void)
 zipcrc_t zipcrc_update(zipcrc_t crc, const void *data, size_t data_len);
 
 
+/**
+ * The individual methods behind zipcrc_update(), for testing and benchmarks.
+ * They all give the same result as zipcrc_update().
+ * zipcrc_update_clmul() may only be called if zipcrc_have_clmul() is nonzero,
+ * and is only faster than slice-by-8 from ZIPCRC_CLMUL_MIN bytes on.
+ *****************************************************************************/
+#define ZIPCRC_CLMUL_MIN 64
+
+zipcrc_t zipcrc_update_table(zipcrc_t crc, const void *data, size_t data_len);
+zipcrc_t zipcrc_update_slice8(zipcrc_t crc, const void *data, size_t data_len);
+zipcrc_t zipcrc_update_clmul(zipcrc_t crc, const void *data, size_t data_len);
+int zipcrc_have_clmul(void);
+const char *zipcrc_method(void);
+
+
 /**
  * Calculate the final crc value.
  *
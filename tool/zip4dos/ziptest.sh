@@ -0,0 +1,71 @@
+#!/bin/bash
+# Self-test for zip4dos compression options.
+# Archives a small tree with duplicates, incompressible data and a file
+# large enough to be split into blocks, with each combination of -auto
+# and -dedup, and checks it with unzip -t and against -j 1. Then checks
+# that an input that goes away during a -auto run is an error, not a hang.
+#
+# usage: ./ziptest.sh
+zip4dos=`pwd`/linux-host/zip4dos
+
+if [ ! -x "$zip4dos" ]; then echo "Build zip4dos first"; exit 1; fi
+
+tmp=`mktemp -d` || exit 1
+trap 'rm -Rf "$tmp"' EXIT
+
+mkdir -p "$tmp/tree/a" "$tmp/tree/b" || exit 1
+for ((i=0;i < 40;i++)); do
+    head -c $(( (i * 997) % 20000 + 100 )) /dev/urandom | base64 >"$tmp/tree/a/f$i.txt"
+    cp "$tmp/tree/a/f$i.txt" "$tmp/tree/b/f$i.txt"
+done
+head -c 100000 /dev/urandom >"$tmp/tree/a/random.bin"
+head -c $((3 * 1024 * 1024)) /dev/urandom | base64 >"$tmp/tree/big.txt"
+: >"$tmp/tree/empty.txt"
+
+cd "$tmp" || exit 1
+fail=0
+for opts in "" "-auto" "-dedup" "-auto -dedup"; do
+    for j in 1 3; do
+        z="t$j${opts// /}.zip"
+        "$zip4dos" --zip "$z" -6 -j $j $opts -r tree >/dev/null 2>&1 || { echo "FAIL: zip4dos -j $j $opts"; fail=1; continue; }
+        unzip -tq "$z" >/dev/null 2>&1 || { echo "FAIL: unzip -t, -j $j $opts"; fail=1; }
+        if [ $j -gt 1 ]; then
+            cmp -s "t1${opts// /}.zip" "$z" || { echo "FAIL: -j $j $opts differs from -j 1"; fail=1; }
+        fi
+    done
+    echo "ok: ${opts:-default}"
+done
+
+# -dedup does nothing for stored archives, it must say so and not change the output
+"$zip4dos" --zip s.zip -0 -r tree >/dev/null 2>&1 || { echo "FAIL: zip4dos -0"; fail=1; }
+"$zip4dos" --zip sd.zip -0 -dedup -r tree 2>sd.err >/dev/null || { echo "FAIL: zip4dos -0 -dedup"; fail=1; }
+grep -q "no effect with -0" sd.err || { echo "FAIL: no warning for -0 -dedup"; fail=1; }
+cmp -s s.zip sd.zip || { echo "FAIL: -0 -dedup differs from -0"; fail=1; }
+echo "ok: -0 -dedup"
+
+# an input that cannot be opened once compression started. With -auto the other blocks of
+# that file and the writer wait for its first block, which must not leave them waiting forever.
+# zlast.bin is split into blocks and its jobs only start after most of big.txt has been written.
+head -c $((3 * 1024 * 1024)) /dev/urandom >zlast.bin
+rm -f gone.zip gone.out
+timeout 120 stdbuf -oL "$zip4dos" --zip gone.zip -9 -auto -j 1 tree/big.txt zlast.bin >gone.out 2>gone.err &
+pid=$!
+for ((i=0;i < 200;i++)); do
+    grep -q "^Compressing with" gone.out 2>/dev/null && break
+    sleep 0.05
+done
+rm -f zlast.bin
+wait $pid
+r=$?
+if [ $r -eq 124 ]; then
+    echo "FAIL: -auto with a missing input hangs"; fail=1
+elif [ $r -eq 0 ]; then
+    echo "FAIL: -auto with a missing input did not fail"; fail=1
+elif ! grep -q "Cannot open zlast.bin" gone.err; then
+    echo "FAIL: -auto with a missing input, file was not gone in time"; fail=1
+else
+    echo "ok: -auto with a missing input fails"
+fi
+
+if [ $fail -ne 0 ]; then echo "FAILED"; exit 1; fi
+echo "all tests passed"